@@ -38,7 +38,7 @@ uint8_t ly_vlog_hide_def;
 static pthread_once_t ly_err_once = PTHREAD_ONCE_INIT;
 static pthread_key_t ly_err_key;
 #ifdef __linux__
-struct ly_err ly_err_main = {LY_SUCCESS, LYVE_SUCCESS, 0, 0, 0, NULL, {0}, {0}, {0}, {0}};
+struct ly_err ly_err_main = {LY_SUCCESS, LYVE_SUCCESS, 0, 0, 0, NULL, NULL, NULL, NULL, {0}, {0}, {0}, {0}, {0}};
 #endif
 
 static void
@@ -55,6 +55,12 @@ ly_err_free(void *ptr)
         free(i);
     }
     e->errlist = NULL;
+    e->postponed = NULL;
+    for (i = e->pool; i; i = next) {
+        next = i->next;
+        free(i);
+    }
+    e->pool = NULL;
 
 #ifdef __linux__
     /* in __linux__ we use static memory in the main thread,
@@ -105,20 +111,34 @@ ly_err_location(void)
 void
 ly_err_clean(int with_errno)
 {
+    struct ly_err *e = ly_err_location();
     struct ly_err_item *i, *next;
+    int count = 0;
 
-    i = ly_err_location()->errlist;
-    ly_err_location()->errlist = NULL;
+    for (i = e->pool; i; i = i->next) {
+        ++count;
+    }
+
+    i = e->errlist;
+    e->errlist = NULL;
+    e->postponed = NULL;
     for (; i; i = next) {
         next = i->next;
         free(i->msg);
         free(i->path);
-        free(i);
+        if (count < LY_ERR_POOL_SIZE) {
+            /* keep it for the next error, the postponed ones are cleaned often */
+            i->next = e->pool;
+            e->pool = i;
+            ++count;
+        } else {
+            free(i);
+        }
     }
 
     if (with_errno) {
-        ly_err_location()->no = LY_SUCCESS;
-        ly_err_location()->code = LYVE_SUCCESS;
+        e->no = LY_SUCCESS;
+        e->code = LYVE_SUCCESS;
     }
 }
 
@@ -155,6 +175,9 @@ ly_errmsg(void)
     if (!e) {
         return NULL;
     }
+    if (e->postponed) {
+        ly_err_format();
+    }
     return e->msg;
 }
 
@@ -167,6 +190,9 @@ ly_errpath(void)
     if (!e) {
         return NULL;
     }
+    if (e->postponed) {
+        ly_err_format();
+    }
     return &e->path[e->path_index];
 }
 
@@ -868,7 +894,8 @@ ly_new_node_validity(const struct lys_node *schema)
 {
     int validity;
 
-    validity = LYD_VAL_OK;
+    /* a new node is always a change for the incremental validation */
+    validity = LYD_VAL_CHANGED;
     switch (schema->nodetype) {
     case LYS_LEAF:
     case LYS_LEAFLIST:
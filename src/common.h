@@ -62,12 +62,29 @@ char *get_current_dir_name(void);
 
 #define LY_BUF_SIZE 1024
 #define LY_APPTAG_LEN 128
+#define LY_ERR_ARGS_COUNT 8  /* maximum number of arguments of a postponed error message */
+#define LY_ERR_ARGS_SIZE 256 /* size of the buffer for the string arguments of a postponed error message */
+#define LY_ERR_POOL_SIZE 8   /* maximum number of unused error items kept for reuse */
+union ly_err_arg {
+    long long num;
+    unsigned long long unum;
+    double real;
+    const void *ptr;
+    size_t str;              /* offset of the string copy in the args buffer */
+};
 struct ly_err_item {
     LY_ERR no;
     LY_VECODE code;
     char *msg;
     char *path;
     struct ly_err_item *next;
+
+    /* error logged while hidden, the message and the path are created from these only when needed */
+    const char *fmt;         /* message format, NULL if msg and path are already set */
+    int elem_type;           /* enum LY_VLOG_ELEM */
+    const void *elem;
+    union ly_err_arg args[LY_ERR_ARGS_COUNT];
+    char strs[LY_ERR_ARGS_SIZE];
 };
 struct ly_err {
     LY_ERR no;
@@ -76,6 +93,10 @@ struct ly_err {
     uint8_t buf_used;
     uint16_t path_index;
     struct ly_err_item *errlist; /* list of stored errors */
+    struct ly_err_item *postponed; /* first error in errlist whose message and path were not created yet */
+    struct ly_err_item *pool;    /* unused error items to be reused */
+    const struct lyd_node *inwhen; /* node with an unresolved when condition that stopped the last XPath evaluation */
+    struct lyd_val_stats stats;  /* evaluations of the data constraints, see lyd_validation_stats() */
     char msg[LY_BUF_SIZE];
     char path[LY_BUF_SIZE];
     char apptag[LY_APPTAG_LEN];
@@ -85,6 +106,18 @@ struct ly_err *ly_err_location(void);
 void ly_err_clean(int with_errno);
 void ly_err_repeat(void);
 
+/**
+ * @brief Create the messages and paths of the errors logged while the logging was hidden.
+ *
+ * Such errors (only those with LY_VLOG_LYD, LY_VLOG_NONE or LY_VLOG_PREV element) store just their arguments
+ * and a pointer to the data node they relate to (see ly_vlog()). The invariant is that this is called before
+ * any data node is freed or goes out of scope while such an error may still refer to it or to any of its
+ * descendants. The data trees are freed by lyd_free_r(), which calls it for every node, so only the nodes
+ * freed directly on parser errors and the dummy nodes allocated on stack must call it explicitly. Note that
+ * the path is created from the state of the data tree at the time this is called, not when the error was logged.
+ */
+void ly_err_format(void);
+
 /**
  * @brief libyang internal thread-specific buffer of LY_BUF_SIZE size
  *
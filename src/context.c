@@ -62,13 +62,83 @@ static struct internal_modules_s {
     {"ietf-yang-library", "2016-06-21", (const char*)ietf_yang_library_2016_06_21_yin, 1, LYS_IN_YIN}
 };
 
-API struct ly_ctx *
-ly_ctx_new(const char *search_dir)
+/* searched module name or namespace */
+struct ly_mod_key {
+    const char *str;
+    size_t len;
+};
+
+static int
+ly_ctx_mod_name_equal(void *val_searched, void *val_stored, void *UNUSED(cb_data))
+{
+    struct ly_mod_key *key = val_searched;
+    const char *name = ((struct lys_module *)val_stored)->name;
+
+    return !strncmp(name, key->str, key->len) && !name[key->len];
+}
+
+static int
+ly_ctx_mod_ns_equal(void *val_searched, void *val_stored, void *UNUSED(cb_data))
+{
+    struct ly_mod_key *key = val_searched;
+    const char *ns = ((struct lys_module *)val_stored)->ns;
+
+    return !strncmp(ns, key->str, key->len) && !ns[key->len];
+}
+
+static uint32_t
+ly_ctx_mod_hash(const char *str, size_t len)
+{
+    return dict_hash_multi(dict_hash_multi(0, str, len), NULL, 0);
+}
+
+int
+ly_ctx_mod_index_add(struct lys_module *module)
+{
+    struct ly_ctx *ctx = module->ctx;
+
+    if (lyht_insert(ctx->mod_index.names, module, ly_ctx_mod_hash(module->name, strlen(module->name)))) {
+        return EXIT_FAILURE;
+    }
+    if (lyht_insert(ctx->mod_index.nss, module, ly_ctx_mod_hash(module->ns, strlen(module->ns)))) {
+        lyht_remove(ctx->mod_index.names, module, ly_ctx_mod_hash(module->name, strlen(module->name)));
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+void
+ly_ctx_mod_index_remove(struct lys_module *module)
+{
+    struct ly_ctx *ctx = module->ctx;
+
+    lyht_remove(ctx->mod_index.names, module, ly_ctx_mod_hash(module->name, strlen(module->name)));
+    lyht_remove(ctx->mod_index.nss, module, ly_ctx_mod_hash(module->ns, strlen(module->ns)));
+}
+
+struct lys_module *
+ly_ctx_mod_index_next(const struct ly_ctx *ctx, const char *key, size_t len, int ns, const struct lys_module *prev)
+{
+    struct hash_table *ht = (ns ? ctx->mod_index.nss : ctx->mod_index.names);
+    struct ly_mod_key searched = {key, len};
+    void *match = (void *)prev;
+    uint32_t hash = ly_ctx_mod_hash(key, len);
+
+    if (prev ? lyht_find_next(ht, &searched, hash, &match) : lyht_find(ht, &searched, hash, &match)) {
+        return NULL;
+    }
+    return match;
+}
+
+/**
+ * @brief Create a context without any modules.
+ */
+static struct ly_ctx *
+ly_ctx_new_empty(const char *search_dir, int options)
 {
     struct ly_ctx *ctx;
-    struct lys_module *module;
     char *cwd;
-    int i;
 
     ctx = calloc(1, sizeof *ctx);
     if (!ctx) {
@@ -77,7 +147,10 @@ ly_ctx_new(const char *search_dir)
     }
 
     /* dictionary */
-    lydict_init(&ctx->dict);
+    if (lydict_init(&ctx->dict, options & LY_CTX_CONCURRENT_DICT)) {
+        free(ctx);
+        return NULL;
+    }
 
     /* plugins */
     lyext_load_plugins();
@@ -86,10 +159,20 @@ ly_ctx_new(const char *search_dir)
     ctx->models.list = calloc(16, sizeof *ctx->models.list);
     if (!ctx->models.list) {
         LOGMEM;
+        lydict_clean(&ctx->dict);
         free(ctx);
         return NULL;
     }
     ext_plugins_ref++;
+    pthread_mutex_init(&ctx->pos_index.lock, NULL);
+    pthread_mutex_init(&ctx->dep_index.lock, NULL);
+    ctx->mod_index.names = lyht_new(ly_ctx_mod_name_equal, NULL);
+    ctx->mod_index.nss = lyht_new(ly_ctx_mod_ns_equal, NULL);
+    if (!ctx->mod_index.names || !ctx->mod_index.nss) {
+        LOGMEM;
+        ly_ctx_destroy(ctx, NULL);
+        return NULL;
+    }
     ctx->models.used = 0;
     ctx->models.size = 16;
     if (search_dir) {
@@ -111,6 +194,24 @@ ly_ctx_new(const char *search_dir)
         free(cwd);
     }
     ctx->models.module_set_id = 1;
+    if (options & LY_CTX_SHARE_GROUPINGS) {
+        ctx->models.flags |= LY_CTX_SHAREDGRP;
+    }
+
+    return ctx;
+}
+
+API struct ly_ctx *
+ly_ctx_new_opts(const char *search_dir, int options)
+{
+    struct ly_ctx *ctx;
+    struct lys_module *module;
+    int i;
+
+    ctx = ly_ctx_new_empty(search_dir, options);
+    if (!ctx) {
+        return NULL;
+    }
 
     /* load internal modules */
     for (i = 0; i < LY_INTERNAL_MODULE_COUNT; i++) {
@@ -125,6 +226,12 @@ ly_ctx_new(const char *search_dir)
     return ctx;
 }
 
+API struct ly_ctx *
+ly_ctx_new(const char *search_dir)
+{
+    return ly_ctx_new_opts(search_dir, 0);
+}
+
 static struct ly_ctx *
 ly_ctx_new_yl_common(const char *search_dir, const char *input, LYD_FORMAT format,
                      struct lyd_node* (*parser_func)(struct ly_ctx*, const char*, LYD_FORMAT, int,...))
@@ -199,6 +306,7 @@ error:
     }
 
     /* cleanup */
+    free(features.set.g);
     if (yltree) {
         /* yang library data tree */
         lyd_free_withsiblings(yltree);
@@ -219,6 +327,119 @@ ly_ctx_new_ylmem(const char *search_dir, const char *data, LYD_FORMAT format)
     return ly_ctx_new_yl_common(search_dir, data, format, lyd_parse_mem);
 }
 
+API struct ly_ctx *
+ly_ctx_new_snapshot_mem(const char *search_dir, const char *data, size_t size, int options)
+{
+    struct ly_ctx *ctx;
+
+    if (!data) {
+        LOGERR(LY_EINVAL, "%s: Invalid parameter.", __func__);
+        return NULL;
+    }
+
+    ctx = ly_ctx_new_empty(search_dir, options);
+    if (!ctx) {
+        return NULL;
+    }
+
+    if (lys_snapshot_parse(ctx, data, size)) {
+        ly_ctx_destroy(ctx, NULL);
+        return NULL;
+    }
+
+    return ctx;
+}
+
+API struct ly_ctx *
+ly_ctx_new_snapshot_path(const char *search_dir, const char *path, int options)
+{
+    struct ly_ctx *ctx;
+    size_t length;
+    char *data;
+    int fd;
+
+    if (!path) {
+        LOGERR(LY_EINVAL, "%s: Invalid parameter.", __func__);
+        return NULL;
+    }
+
+    fd = open(path, O_RDONLY);
+    if (fd == -1) {
+        LOGERR(LY_ESYS, "Failed to open schema snapshot \"%s\" (%s).", path, strerror(errno));
+        return NULL;
+    }
+
+    data = lyp_mmap(fd, 0, &length);
+    close(fd);
+    if (data == MAP_FAILED) {
+        LOGERR(LY_ESYS, "Mapping file descriptor into memory failed (%s()).", __func__);
+        return NULL;
+    } else if (!data) {
+        LOGERR(LY_EINVAL, "Schema snapshot \"%s\" is empty.", path);
+        return NULL;
+    }
+
+    ctx = ly_ctx_new_snapshot_mem(search_dir, data, length, options);
+
+    lyp_munmap(data, length);
+    return ctx;
+}
+
+API int
+ly_ctx_print_snapshot_mem(const struct ly_ctx *ctx, char **strp, size_t *size)
+{
+    if (!ctx || !strp || !size) {
+        LOGERR(LY_EINVAL, "%s: Invalid parameter.", __func__);
+        return EXIT_FAILURE;
+    }
+
+    return lys_snapshot_print(ctx, strp, size);
+}
+
+API int
+ly_ctx_print_snapshot_path(const struct ly_ctx *ctx, const char *path)
+{
+    char *data;
+    size_t size, written = 0;
+    ssize_t r;
+    int fd, ret = EXIT_SUCCESS;
+
+    if (!ctx || !path) {
+        LOGERR(LY_EINVAL, "%s: Invalid parameter.", __func__);
+        return EXIT_FAILURE;
+    }
+
+    if (lys_snapshot_print(ctx, &data, &size)) {
+        return EXIT_FAILURE;
+    }
+
+    fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+    if (fd == -1) {
+        LOGERR(LY_ESYS, "Failed to open schema snapshot \"%s\" (%s).", path, strerror(errno));
+        free(data);
+        return EXIT_FAILURE;
+    }
+    while (written < size) {
+        r = write(fd, data + written, size - written);
+        if (r < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            LOGERR(LY_ESYS, "Failed to write schema snapshot \"%s\" (%s).", path, strerror(errno));
+            ret = EXIT_FAILURE;
+            break;
+        }
+        written += r;
+    }
+    if (close(fd) && !ret) {
+        LOGERR(LY_ESYS, "Failed to write schema snapshot \"%s\" (%s).", path, strerror(errno));
+        ret = EXIT_FAILURE;
+    }
+
+    free(data);
+    return ret;
+}
+
 API void
 ly_ctx_set_allimplemented(struct ly_ctx *ctx)
 {
@@ -239,6 +460,27 @@ ly_ctx_unset_allimplemented(struct ly_ctx *ctx)
     ctx->models.flags &= ~LY_CTX_ALLIMPLEMENTED;
 }
 
+API void
+ly_ctx_set_validation_threads(struct ly_ctx *ctx, unsigned int threads)
+{
+    if (!ctx) {
+        return;
+    }
+
+    ctx->valid_threads = threads > 1 ? threads : 1;
+}
+
+API unsigned int
+ly_ctx_get_validation_threads(const struct ly_ctx *ctx)
+{
+    if (!ctx) {
+        ly_errno = LY_EINVAL;
+        return 0;
+    }
+
+    return ctx->valid_threads ? ctx->valid_threads : 1;
+}
+
 API void
 ly_ctx_set_searchdir(struct ly_ctx *ctx, const char *search_dir)
 {
@@ -274,6 +516,7 @@ ly_ctx_set_searchdir(struct ly_ctx *ctx, const char *search_dir)
         }
         ctx->models.search_paths[index] = get_current_dir_name();
         ctx->models.search_paths[index + 1] = NULL;
+        lyp_search_index_clean(ctx);
 
         if (chdir(cwd)) {
             LOGWRN("Unable to return back to working directory \"%s\" (%s)",
@@ -307,6 +550,17 @@ ly_ctx_unset_searchdirs(struct ly_ctx *ctx)
     }
     free(ctx->models.search_paths);
     ctx->models.search_paths = NULL;
+    lyp_search_index_clean(ctx);
+}
+
+API void
+ly_ctx_refresh_searchdirs(struct ly_ctx *ctx)
+{
+    if (!ctx) {
+        return;
+    }
+
+    lyp_search_index_clean(ctx);
 }
 
 API void
@@ -333,6 +587,25 @@ ly_ctx_destroy(struct ly_ctx *ctx, void (*private_destructor)(const struct lys_n
     }
     free(ctx->models.list);
 
+    /* search directories index */
+    lyp_search_index_clean(ctx);
+
+    /* modules index */
+    if (ctx->mod_index.names) {
+        lyht_free(ctx->mod_index.names);
+    }
+    if (ctx->mod_index.nss) {
+        lyht_free(ctx->mod_index.nss);
+    }
+
+    /* schema nodes positions */
+    lys_pos_index_clean(ctx);
+    pthread_mutex_destroy(&ctx->pos_index.lock);
+
+    /* conditions dependencies */
+    lys_dep_index_clean(ctx);
+    pthread_mutex_destroy(&ctx->dep_index.lock);
+
     /* dictionary */
     lydict_clean(&ctx->dict);
 
@@ -427,48 +700,42 @@ ly_ctx_get_submodule(const struct ly_ctx *ctx, const char *module, const char *r
 }
 
 static const struct lys_module *
-ly_ctx_get_module_by(const struct ly_ctx *ctx, const char *key, int offset, const char *revision, int with_disabled)
+ly_ctx_get_module_by(const struct ly_ctx *ctx, const char *key, int ns, const char *revision, int with_disabled)
 {
-    int i;
-    struct lys_module *result = NULL;
+    struct lys_module *mod, *result = NULL;
+    size_t len;
 
     if (!ctx || !key) {
         ly_errno = LY_EINVAL;
         return NULL;
     }
 
-    for (i = 0; i < ctx->models.used; i++) {
-        if (!with_disabled && ctx->models.list[i]->disabled) {
+    len = strlen(key);
+    for (mod = ly_ctx_mod_index_next(ctx, key, len, ns, NULL); mod; mod = ly_ctx_mod_index_next(ctx, key, len, ns, mod)) {
+        if (!with_disabled && mod->disabled) {
             /* skip the disabled modules */
             continue;
         }
-        /* use offset to get address of the pointer to string (char**), remember that offset is in
-         * bytes, so we have to cast the pointer to the module to (char*), finally, we want to have
-         * string not the pointer to string
-         */
-        if (!ctx->models.list[i] || strcmp(key, *(char**)(((char*)ctx->models.list[i]) + offset))) {
-            continue;
-        }
 
         if (!revision) {
             /* compare revisons and remember the newest one */
             if (result) {
-                if (!ctx->models.list[i]->rev_size) {
+                if (!mod->rev_size) {
                     /* the current have no revision, keep the previous with some revision */
                     continue;
                 }
-                if (result->rev_size && strcmp(ctx->models.list[i]->rev[0].date, result->rev[0].date) < 0) {
+                if (result->rev_size && strcmp(mod->rev[0].date, result->rev[0].date) < 0) {
                     /* the previous found matching module has a newer revision */
                     continue;
                 }
             }
 
             /* remember the current match and search for newer version */
-            result = ctx->models.list[i];
+            result = mod;
         } else {
-            if (ctx->models.list[i]->rev_size && !strcmp(revision, ctx->models.list[i]->rev[0].date)) {
+            if (mod->rev_size && !strcmp(revision, mod->rev[0].date)) {
                 /* matching revision */
-                result = ctx->models.list[i];
+                result = mod;
                 break;
             }
         }
@@ -481,13 +748,13 @@ ly_ctx_get_module_by(const struct ly_ctx *ctx, const char *key, int offset, cons
 API const struct lys_module *
 ly_ctx_get_module_by_ns(const struct ly_ctx *ctx, const char *ns, const char *revision)
 {
-    return ly_ctx_get_module_by(ctx, ns, offsetof(struct lys_module, ns), revision, 0);
+    return ly_ctx_get_module_by(ctx, ns, 1, revision, 0);
 }
 
 API const struct lys_module *
 ly_ctx_get_module(const struct ly_ctx *ctx, const char *name, const char *revision)
 {
-    return ly_ctx_get_module_by(ctx, name, offsetof(struct lys_module, name), revision, 0);
+    return ly_ctx_get_module_by(ctx, name, 0, revision, 0);
 }
 
 API const struct lys_module *
@@ -641,7 +908,7 @@ ly_ctx_load_sub_module(struct ly_ctx *ctx, struct lys_module *module, const char
                 return NULL;
             } else {
                 /* get the newest revision from the context */
-                mod = ly_ctx_get_module_by(ctx, name, offsetof(struct lys_module, name), revision, 1);
+                mod = ly_ctx_get_module_by(ctx, name, 0, revision, 1);
                 if (mod && mod->disabled) {
                     /* enable the required module */
                     lys_set_enabled(mod);
@@ -1210,6 +1477,9 @@ imported:
     }
     ctx->models.used = o + 1;
     ctx->models.module_set_id++;
+    for (u = 0; u < mods->number; u++) {
+        ly_ctx_mod_index_remove((struct lys_module *)mods->set.g[u]);
+    }
 
     /* maintain backlinks (start with internal ietf-yang-library which have leafs as possible targets of leafrefs */
     ctx_modules_undo_backlinks(ctx, mods);
@@ -1235,6 +1505,7 @@ ly_ctx_clean(struct ly_ctx *ctx, void (*private_destructor)(const struct lys_nod
 
     /* models list */
     for (; ctx->models.used > LY_INTERNAL_MODULE_COUNT; ctx->models.used--) {
+        ly_ctx_mod_index_remove(ctx->models.list[ctx->models.used - 1]);
         /* remove the applied deviations and augments */
         lys_sub_module_remove_devs_augs(ctx->models.list[ctx->models.used - 1]);
         /* remove the module */
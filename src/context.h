@@ -15,7 +15,10 @@
 #ifndef LY_CONTEXT_H_
 #define LY_CONTEXT_H_
 
+#include <pthread.h>
+
 #include "dict_private.h"
+#include "hash_table.h"
 #include "tree_schema.h"
 #include "libyang.h"
 
@@ -36,14 +39,128 @@ struct ly_modules_list {
 
 #define LY_CTX_ALLIMPLEMENTED 0x01 /**< all modules are implemented despite they were loaded explicitly or implicitly
                                         via import statement */
+#define LY_CTX_SHAREDGRP      0x02 /**< uses in groupings share the nodes of their grouping, see #LY_CTX_SHARE_GROUPINGS */
+
+/**
+ * @brief Position of a schema node among the schema nodes of its data siblings.
+ */
+struct ly_pos_rec {
+    const struct lys_node *node;     /**< schema node */
+    uint32_t pos;                    /**< its position in the lys_getnext() order, starting from 1 */
+};
+
+/**
+ * @brief Positions of all the schema nodes that can be data siblings (children of a single data parent).
+ */
+struct ly_pos_group {
+    struct ly_pos_group *next;       /**< next group in the index */
+    struct ly_pos_rec *recs;         /**< positions of all the nodes */
+};
+
+/**
+ * @brief Index of schema node positions for O(1) ordering of data siblings.
+ *
+ * The positions of all the data nodes of the implemented modules are computed at once, when a position is first
+ * needed, and the whole index is dropped whenever the module set of the context changes. The index is built under
+ * the lock and published by an atomic store of ht after module_set_id, so once published, it is only read without
+ * the lock (the schemas must not be changed concurrently with working with the data anyway).
+ */
+struct ly_pos_index {
+    pthread_mutex_t lock;            /**< lock for building the index */
+    struct hash_table *ht;           /**< schema node -> struct ly_pos_rec, accessed atomically */
+    struct ly_pos_group *groups;     /**< all the allocated positions */
+    uint16_t module_set_id;          /**< module-set-id of the context when the index was created, accessed atomically */
+};
+
+#define LY_DEP_WHEN  0x01 /**< a when condition of the node (or its choice, case, uses or augment) depends on the data */
+#define LY_DEP_MUST  0x02 /**< a must condition of the node depends on the data */
+#define LY_DEP_VALUE 0x04 /**< the node value (instance-identifier or union with one) can refer to any data */
+
+/**
+ * @brief Conditions of a schema node depending on other data nodes.
+ */
+struct ly_dep_rec {
+    const struct lys_node *node;     /**< data schema node with the conditions */
+    const struct lys_node *scope;    /**< the node itself or its data parent whose single instance includes all
+                                          the data the conditions of the instances in it depend on, NULL if it is
+                                          the whole data tree */
+    struct ly_dep_rec *next;         /**< next record in the index */
+    uint8_t flags;                   /**< LY_DEP_* flags */
+};
+
+/**
+ * @brief All the conditions depending on instances of a schema node or any node in its subtree.
+ */
+struct ly_dep_entry {
+    const struct lys_node *node;     /**< data schema node, NULL for the conditions depending on any data */
+    struct ly_dep_entry *next;       /**< next entry in the index */
+    struct ly_dep_rec **recs;        /**< the dependent conditions */
+    uint32_t count;                  /**< number of the records */
+    uint32_t size;                   /**< allocated size of the records array */
+};
+
+/**
+ * @brief Index of the data dependencies of when and must conditions for the incremental validation.
+ *
+ * The dependencies are found by atomizing the conditions of all the data nodes of the implemented modules at once,
+ * when first needed, and the whole index is dropped whenever the module set of the context changes.
+ */
+struct ly_dep_index {
+    pthread_mutex_t lock;            /**< lock for concurrent data validation */
+    struct hash_table *ht;           /**< schema node -> struct ly_dep_entry */
+    struct ly_dep_entry *entries;    /**< all the entries except the global one */
+    struct ly_dep_rec *recs;         /**< all the records */
+    struct ly_dep_entry global;      /**< conditions depending on any data and all the values referring to any data */
+    uint16_t module_set_id;          /**< module-set-id of the context when the index was created */
+};
+
+/**
+ * @brief Index of the modules of a context by their names and namespaces.
+ *
+ * Unlike the other indexes, it is kept up-to-date whenever a module is added into or removed from the context,
+ * all the revisions (and also the disabled modules) are indexed.
+ */
+struct ly_mod_index {
+    struct hash_table *names;        /**< module name -> struct lys_module */
+    struct hash_table *nss;          /**< module namespace -> struct lys_module */
+};
+
+/**
+ * @brief YANG or YIN file found in the search directories.
+ */
+struct ly_search_file {
+    char *path;                      /**< path of the file */
+    const char *name;                /**< file name in the path, starting with the (sub)module name */
+    size_t name_len;                 /**< length of the (sub)module name (followed by '@' or the suffix) */
+    LYS_INFORMAT format;             /**< format according to the suffix */
+    struct ly_search_file *next;     /**< next file with the same (sub)module name, in the search order */
+};
+
+/**
+ * @brief Index of the files in the search directories (and the current working directory) of a context.
+ *
+ * The directories are explored when a (sub)module file is first searched for and again whenever the search
+ * directories or the working directory change or a (sub)module is not found in the index.
+ */
+struct ly_search_index {
+    struct hash_table *ht;           /**< (sub)module name -> first struct ly_search_file with the name */
+    struct ly_search_file *files;    /**< all the files, in the search order */
+    uint32_t count;                  /**< number of the files */
+    char *cwd;                       /**< working directory the index was built in */
+};
 
 struct ly_ctx {
     struct dict_table dict;
     struct ly_modules_list models;
+    struct ly_mod_index mod_index;
+    struct ly_search_index search_index;
     ly_module_imp_clb imp_clb;
     void *imp_clb_data;
     ly_module_data_clb data_clb;
     void *data_clb_data;
+    struct ly_pos_index pos_index;
+    struct ly_dep_index dep_index;
+    unsigned int valid_threads;      /**< number of threads evaluating must conditions, 0 or 1 for none */
 };
 
 #endif /* LY_CONTEXT_H_ */
@@ -21,44 +21,106 @@
 #include "context.h"
 #include "dict_private.h"
 
-void
-lydict_init(struct dict_table *dict)
+static void
+dict_table_init(struct dict_table *dict)
+{
+    /* the table itself is allocated with the first inserted string */
+    dict->recs = NULL;
+    dict->size = 0;
+    dict->recs_used = 0;
+    dict->recs_deleted = 0;
+    dict->old_recs = NULL;
+    dict->old_size = 0;
+    dict->old_used = 0;
+    dict->rehash_idx = 0;
+    dict->used = 0;
+    dict->stripes = NULL;
+    pthread_mutex_init(&dict->lock, NULL);
+}
+
+int
+lydict_init(struct dict_table *dict, int concurrent)
 {
+    int i;
+
     if (!dict) {
         ly_errno = LY_EINVAL;
+        return EXIT_FAILURE;
+    }
+
+    dict_table_init(dict);
+    if (concurrent) {
+        dict->stripes = malloc(DICT_STRIPES * sizeof *dict->stripes);
+        if (!dict->stripes) {
+            LOGMEM;
+            pthread_mutex_destroy(&dict->lock);
+            return EXIT_FAILURE;
+        }
+        for (i = 0; i < DICT_STRIPES; i++) {
+            dict_table_init(&dict->stripes[i]);
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
+
+static void
+dict_recs_free(struct dict_rec *recs, uint32_t size)
+{
+    uint32_t i;
+
+    if (!recs) {
         return;
     }
 
-    dict->hash_mask = DICT_SIZE - 1;
-    pthread_mutex_init(&dict->lock, NULL);
+    for (i = 0; i < size; i++) {
+        free(recs[i].value);
+    }
+    free(recs);
+}
+
+static void
+dict_table_clean(struct dict_table *dict)
+{
+    dict_recs_free(dict->recs, dict->size);
+    dict_recs_free(dict->old_recs, dict->old_size);
+    dict->recs = dict->old_recs = NULL;
+    dict->size = dict->old_size = 0;
+    dict->recs_used = dict->recs_deleted = dict->old_used = dict->used = 0;
+
+    pthread_mutex_destroy(&dict->lock);
 }
 
 void
 lydict_clean(struct dict_table *dict)
 {
     int i;
-    struct dict_rec *chain, *rec;
 
     if (!dict) {
         ly_errno = LY_EINVAL;
         return;
     }
 
-    for (i = 0; i < DICT_SIZE; i++) {
-        rec = &dict->recs[i];
-        chain = rec->next;
-
-        free(rec->value);
-        while (chain) {
-            rec = chain;
-            chain = rec->next;
-
-            free(rec->value);
-            free(rec);
+    if (dict->stripes) {
+        for (i = 0; i < DICT_STRIPES; i++) {
+            dict_table_clean(&dict->stripes[i]);
         }
+        free(dict->stripes);
+        dict->stripes = NULL;
     }
+    dict_table_clean(dict);
+}
 
-    pthread_mutex_destroy(&dict->lock);
+/**
+ * @brief Get the table holding the strings with the given hash.
+ */
+static struct dict_table *
+dict_get_table(struct ly_ctx *ctx, uint32_t hash)
+{
+    if (ctx->dict.stripes) {
+        return &ctx->dict.stripes[hash >> (32 - DICT_STRIPES_BITS)];
+    }
+    return &ctx->dict;
 }
 
 /*
@@ -109,181 +171,290 @@ dict_hash_multi(uint32_t hash, const char *key_part, size_t len)
     return hash;
 }
 
+/**
+ * @brief Find the record of the value in the table.
+ *
+ * @param[in] recs Hash table.
+ * @param[in] size Size of the table.
+ * @param[in] value Value to find.
+ * @param[in] len Length of the value.
+ * @param[in] hash Hash of the value.
+ * @param[in] ptr_match Whether to match the exact value pointer (removing) or the string content (inserting).
+ * Records with the maximal refcount are skipped in the latter case.
+ * @return Found record, NULL if not found.
+ */
+static struct dict_rec *
+dict_find(struct dict_rec *recs, uint32_t size, const char *value, uint32_t len, uint32_t hash, int ptr_match)
+{
+    uint32_t i, mask;
+    struct dict_rec *rec;
+
+    if (!recs) {
+        return NULL;
+    }
+
+    mask = size - 1;
+    for (i = hash & mask; recs[i].value || recs[i].deleted; i = (i + 1) & mask) {
+        rec = &recs[i];
+        if (!rec->value || (rec->hash != hash) || (rec->len != len)) {
+            continue;
+        }
+        if (ptr_match) {
+            if (rec->value == value) {
+                return rec;
+            }
+        } else if (!memcmp(rec->value, value, len) && (rec->refcount < DICT_REC_MAXCOUNT)) {
+            return rec;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Get a free (unused or deleted) record for a new value in the table, it must not be full.
+ */
+static struct dict_rec *
+dict_find_free(struct dict_rec *recs, uint32_t size, uint32_t hash)
+{
+    uint32_t i, mask;
+
+    mask = size - 1;
+    for (i = hash & mask; recs[i].value; i = (i + 1) & mask);
+
+    return &recs[i];
+}
+
+/**
+ * @brief Move a batch of records from the old table into the new one. Frees the old table
+ * when all its records are moved.
+ *
+ * @param[in] dict Dictionary with a rehash in progress.
+ * @param[in] count Maximal number of the old table records to process, 0 to finish the rehash.
+ */
+static void
+dict_rehash_step(struct dict_table *dict, uint32_t count)
+{
+    int all = !count;
+    struct dict_rec *old, *new;
+
+    while ((dict->rehash_idx < dict->old_size) && (all || count--)) {
+        old = &dict->old_recs[dict->rehash_idx++];
+        if (!old->value) {
+            continue;
+        }
+
+        new = dict_find_free(dict->recs, dict->size, old->hash);
+        if (new->deleted) {
+            dict->recs_deleted--;
+        }
+        memcpy(new, old, sizeof *new);
+        new->deleted = 0;
+        ++dict->recs_used;
+
+        /* keep the probing sequence in the old table unbroken */
+        old->value = NULL;
+        old->deleted = 1;
+        --dict->old_used;
+    }
+
+    if (dict->rehash_idx == dict->old_size) {
+        free(dict->old_recs);
+        dict->old_recs = NULL;
+        dict->old_size = 0;
+        dict->old_used = 0;
+        dict->rehash_idx = 0;
+    }
+}
+
+/**
+ * @brief Check the load of the table and start a rehash into a differently sized table if needed.
+ *
+ * The table grows when more than 70 % of the records are used or deleted, shrinks when
+ * less than 10 % of them hold a value and the new table is always sized to be at most 40 % full.
+ *
+ * @param[in] dict Dictionary to check.
+ * @return EXIT_SUCCESS on success, EXIT_FAILURE on memory allocation failure.
+ */
+static int
+dict_resize(struct dict_table *dict)
+{
+    uint64_t size;
+    struct dict_rec *recs;
+
+    if (!dict->recs) {
+        /* empty dictionary */
+        dict->recs = calloc(DICT_SIZE, sizeof *dict->recs);
+        if (!dict->recs) {
+            LOGMEM;
+            return EXIT_FAILURE;
+        }
+        dict->size = DICT_SIZE;
+        return EXIT_SUCCESS;
+    }
+
+    if (((uint64_t)dict->recs_used + dict->recs_deleted) * 10 < (uint64_t)dict->size * 7) {
+        if ((dict->size == DICT_SIZE) || ((uint64_t)dict->used * 10 >= dict->size) || dict->old_recs) {
+            /* no resize needed */
+            return EXIT_SUCCESS;
+        }
+    }
+
+    if (dict->old_recs) {
+        /* the previous rehash must be finished first */
+        dict_rehash_step(dict, 0);
+    }
+
+    for (size = DICT_SIZE; (uint64_t)dict->recs_used * 10 > size * 4; size <<= 1);
+    if (size > UINT32_MAX) {
+        LOGMEM;
+        return EXIT_FAILURE;
+    }
+
+    recs = calloc(size, sizeof *recs);
+    if (!recs) {
+        LOGMEM;
+        return EXIT_FAILURE;
+    }
+
+    LOGDBG(LY_LDGDICT, "resizing the dictionary from %u to %u records", dict->size, (uint32_t)size);
+
+    /* the current table becomes the old one, its records are moved by the next operations */
+    dict->old_recs = dict->recs;
+    dict->old_size = dict->size;
+    dict->old_used = dict->recs_used;
+    dict->rehash_idx = 0;
+
+    dict->recs = recs;
+    dict->size = size;
+    dict->recs_used = 0;
+    dict->recs_deleted = 0;
+
+    return EXIT_SUCCESS;
+}
+
 API void
 lydict_remove(struct ly_ctx *ctx, const char *value)
 {
     size_t len;
-    uint32_t index;
-    struct dict_rec *record, *prev = NULL;
+    uint32_t hash;
+    struct dict_rec *record;
+    struct dict_table *dict;
 
     if (!value || !ctx) {
         return;
     }
 
     len = strlen(value);
+    hash = dict_hash(value, len);
+    dict = dict_get_table(ctx, hash);
 
-    pthread_mutex_lock(&ctx->dict.lock);
+    pthread_mutex_lock(&dict->lock);
 
-    if (!ctx->dict.used) {
-        pthread_mutex_unlock(&ctx->dict.lock);
+    if (!dict->used) {
+        pthread_mutex_unlock(&dict->lock);
         return;
     }
 
-    index = dict_hash(value, len) & ctx->dict.hash_mask;
-    record = &ctx->dict.recs[index];
-
-    while (record && record->value != value) {
-        prev = record;
-        record = record->next;
+    record = dict_find(dict->recs, dict->size, value, len, hash, 1);
+    if (!record) {
+        record = dict_find(dict->old_recs, dict->old_size, value, len, hash, 1);
     }
 
     if (!record) {
         /* record not found */
-        pthread_mutex_unlock(&ctx->dict.lock);
+        pthread_mutex_unlock(&dict->lock);
         return;
     }
 
     record->refcount--;
     if (!record->refcount) {
         free(record->value);
-        if (record->next) {
-            if (prev) {
-                /* change in dynamically allocated chain */
-                prev->next = record->next;
-                free(record);
-            } else {
-                /* move dynamically allocated record into the static array */
-                prev = record->next;    /* temporary storage */
-                memcpy(record, record->next, sizeof *record);
-                free(prev);
-            }
-        } else if (prev) {
-            /* removing last record from the dynamically allocated chain */
-            prev->next = NULL;
-            free(record);
+        record->value = NULL;
+        record->deleted = 1;
+        if ((record >= dict->recs) && (record < dict->recs + dict->size)) {
+            dict->recs_used--;
+            dict->recs_deleted++;
         } else {
-            /* clean the static record content */
-            memset(record, 0, sizeof *record);
+            dict->old_used--;
+        }
+        dict->used--;
+
+        if (dict->old_recs) {
+            dict_rehash_step(dict, DICT_REHASH_STEP);
+        } else {
+            /* possibly shrink the table, failure does not matter */
+            dict_resize(dict);
         }
-        ctx->dict.used--;
     }
 
-    pthread_mutex_unlock(&ctx->dict.lock);
+    pthread_mutex_unlock(&dict->lock);
 }
 
 static char *
-dict_insert(struct ly_ctx *ctx, char *value, size_t len, int zerocopy)
+dict_insert(struct dict_table *dict, char *value, size_t len, uint32_t hash, int zerocopy)
 {
-    uint32_t index;
-    int match = 0;
-    struct dict_rec *record, *new;
-
-    index = dict_hash(value, len) & ctx->dict.hash_mask;
-    record = &ctx->dict.recs[index];
-
-    if (!record->value) {
-        /* first record with this hash */
-        if (zerocopy) {
-            record->value = value;
-        } else {
-            record->value = malloc((len + 1) * sizeof *record->value);
-            if (!record->value) {
-                LOGMEM;
-                return NULL;
-            }
-            memcpy(record->value, value, len);
-            record->value[len] = '\0';
-        }
-        record->refcount = 1;
-        if (len > DICT_REC_MAXLEN) {
-            record->len = 0;
-        } else {
-            record->len = len;
-        }
-        record->next = NULL;
+    struct dict_rec *record;
 
-        ctx->dict.used++;
-
-        LOGDBG(LY_LDGDICT, "inserting \"%s\"", record->value);
-        return record->value;
+    if (dict->old_recs) {
+        dict_rehash_step(dict, DICT_REHASH_STEP);
     }
 
-    /* collision, search if the value is already in dict */
-    while (record) {
-        if (record->len) {
-            /* for strings shorter than DICT_REC_MAXLEN we are able to speed up
-             * recognition of varying strings according to their lengths, and
-             * for strings with the same length it is safe to use faster memcmp()
-             * instead of strncmp() */
-            if ((record->len == len) && !memcmp(value, record->value, len)) {
-                match = 1;
-            }
-        } else {
-            if (!strncmp(value, record->value, len) && record->value[len] == '\0') {
-                match = 1;
-            }
-        }
-        if (match) {
-            /* record found */
-            if (record->refcount == DICT_REC_MAXCOUNT) {
-                LOGWRN("Refcount overflow detected, duplicating dictionary record");
-                break;
-            }
-            record->refcount++;
-
-            if (zerocopy) {
-                free(value);
-            }
-
-            LOGDBG(LY_LDGDICT, "inserting (refcount) \"%s\"", record->value);
-            return record->value;
-        }
+    /* search if the value is already in dict */
+    record = dict_find(dict->recs, dict->size, value, len, hash, 0);
+    if (!record) {
+        record = dict_find(dict->old_recs, dict->old_size, value, len, hash, 0);
+    }
+    if (record) {
+        /* record found */
+        record->refcount++;
 
-        if (!record->next) {
-            /* not present, add as a new record in chain */
-            break;
+        if (zerocopy) {
+            free(value);
         }
 
-        record = record->next;
+        LOGDBG(LY_LDGDICT, "inserting (refcount) \"%s\"", record->value);
+        return record->value;
     }
 
-    /* create new record and add it behind the last record */
-    new = malloc(sizeof *record);
-    if (!new) {
-        LOGMEM;
+    /* new record, make sure there is enough space for it */
+    if (dict_resize(dict)) {
         return NULL;
     }
+    record = dict_find_free(dict->recs, dict->size, hash);
+
     if (zerocopy) {
-        new->value = value;
+        record->value = value;
     } else {
-        new->value = malloc((len + 1) * sizeof *record->value);
-        if (!new->value) {
+        record->value = malloc((len + 1) * sizeof *record->value);
+        if (!record->value) {
             LOGMEM;
-            free(new);
             return NULL;
         }
-        memcpy(new->value, value, len);
-        new->value[len] = '\0';
+        memcpy(record->value, value, len);
+        record->value[len] = '\0';
     }
-    new->refcount = 1;
-    if (len > DICT_REC_MAXLEN) {
-        new->len = 0;
-    } else {
-        new->len = len;
+    if (record->deleted) {
+        record->deleted = 0;
+        dict->recs_deleted--;
     }
-    new->next = record->next; /* in case of refcount overflow, we are not at the end of chain */
-    record->next = new;
+    record->hash = hash;
+    record->len = len;
+    record->refcount = 1;
 
-    ctx->dict.used++;
+    dict->recs_used++;
+    dict->used++;
 
-    LOGDBG(LY_LDGDICT, "inserting \"%s\" with collision ", new->value);
-    return new->value;
+    LOGDBG(LY_LDGDICT, "inserting \"%s\"", record->value);
+    return record->value;
 }
 
 API const char *
 lydict_insert(struct ly_ctx *ctx, const char *value, size_t len)
 {
     const char *result;
+    uint32_t hash;
+    struct dict_table *dict;
 
     if (value && !len) {
         len = strlen(value);
@@ -293,9 +464,12 @@ lydict_insert(struct ly_ctx *ctx, const char *value, size_t len)
         return NULL;
     }
 
-    pthread_mutex_lock(&ctx->dict.lock);
-    result = dict_insert(ctx, (char *)value, len, 0);
-    pthread_mutex_unlock(&ctx->dict.lock);
+    hash = dict_hash(value, len);
+    dict = dict_get_table(ctx, hash);
+
+    pthread_mutex_lock(&dict->lock);
+    result = dict_insert(dict, (char *)value, len, hash, 0);
+    pthread_mutex_unlock(&dict->lock);
 
     return result;
 }
@@ -304,14 +478,21 @@ API const char *
 lydict_insert_zc(struct ly_ctx *ctx, char *value)
 {
     const char *result;
+    size_t len;
+    uint32_t hash;
+    struct dict_table *dict;
 
     if (!value) {
         return NULL;
     }
 
-    pthread_mutex_lock(&ctx->dict.lock);
-    result = dict_insert(ctx, value, strlen(value), 1);
-    pthread_mutex_unlock(&ctx->dict.lock);
+    len = strlen(value);
+    hash = dict_hash(value, len);
+    dict = dict_get_table(ctx, hash);
+
+    pthread_mutex_lock(&dict->lock);
+    result = dict_insert(dict, value, len, hash, 1);
+    pthread_mutex_unlock(&dict->lock);
 
     return result;
 }
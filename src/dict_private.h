@@ -21,41 +21,69 @@
 #include "dict.h"
 
 /**
- * size of the dictionary for each context
+ * initial (and minimal) size of the dictionary hash table, must be a power of 2
  */
 #define DICT_SIZE 1024
 
 /**
- * record of the dictionary
- * TODO: save the next pointer by different collision strategy, will need to
- * make dictionary size dynamic
+ * number of records of the old table moved into the new one by each dictionary operation
+ * during an incremental rehash
+ */
+#define DICT_REHASH_STEP 16
+
+/**
+ * number of independently locked tables (stripes) of a concurrent dictionary, each of them holding the strings
+ * from a separate range of hashes, must be a power of 2
+ */
+#define DICT_STRIPES 64
+#define DICT_STRIPES_BITS 6
+
+/**
+ * record of the dictionary (a slot of the open-addressing hash table)
  */
 struct dict_rec {
-    struct dict_rec *next;
-    char *value;
-    uint32_t refcount:22;
-    uint32_t len:10;
-#define DICT_REC_MAXCOUNT 0x003fffff
-#define DICT_REC_MAXLEN   0x000003ff
+    char *value;            /**< stored string, NULL for a free or deleted record */
+    uint32_t hash;          /**< full hash of the value */
+    uint32_t len;           /**< length of the value */
+    uint32_t refcount;      /**< number of references to the value */
+    uint8_t deleted;        /**< flag for a deleted record (tombstone), the probing must continue behind it */
+#define DICT_REC_MAXCOUNT UINT32_MAX
 };
 
 /**
  * dictionary to store repeating strings
- * TODO: make it variable size
+ *
+ * It is a hash table with open addressing (linear probing) growing (and shrinking) dynamically. To avoid
+ * stalling a single insert with rehashing the whole table, the records are moved from the old table into
+ * the new one incrementally by each dictionary operation (#DICT_REHASH_STEP records at a time).
+ *
+ * A concurrent dictionary (#LY_CTX_CONCURRENT_DICT) does not hold any records itself, the strings are stored
+ * in #DICT_STRIPES separate tables (with their own locks) selected by the highest bits of the string hash, so
+ * threads working with different strings do not serialize on a single lock.
  */
 struct dict_table {
-    struct dict_rec recs[DICT_SIZE];
-    int hash_mask;
-    uint32_t used;
+    struct dict_rec *recs;     /**< (new) hash table, all the new records are inserted here */
+    uint32_t size;             /**< size of the recs table, always a power of 2 */
+    uint32_t recs_used;        /**< number of valid records in the recs table */
+    uint32_t recs_deleted;     /**< number of deleted records in the recs table */
+    struct dict_rec *old_recs; /**< old hash table being rehashed into recs, NULL if no rehash is in progress */
+    uint32_t old_size;         /**< size of the old_recs table */
+    uint32_t old_used;         /**< number of valid records still in the old_recs table */
+    uint32_t rehash_idx;       /**< index of the next record of old_recs to be moved into recs */
+    uint32_t used;             /**< number of all the strings stored in the dictionary (in the stripe
+                                    in case of a concurrent dictionary) */
     pthread_mutex_t lock;
+    struct dict_table *stripes; /**< array of #DICT_STRIPES tables of a concurrent dictionary, NULL otherwise */
 };
 
 /**
  * @brief Initiate content (non-zero values) of the dictionary
  *
  * @param[in] dict Dictionary table to initiate
+ * @param[in] concurrent Whether to split the dictionary into separately locked stripes
+ * @return EXIT_SUCCESS on success, EXIT_FAILURE on error.
  */
-void lydict_init(struct dict_table *dict);
+int lydict_init(struct dict_table *dict, int concurrent);
 
 /**
  * @brief Cleanup the dictionary content
@@ -0,0 +1,191 @@
+/**
+ * @file hash_table.c
+ * @brief libyang generic hash table
+ *
+ * Copyright (c) 2017 CESNET, z.s.p.o.
+ *
+ * This source code is licensed under BSD 3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/BSD-3-Clause
+ */
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "common.h"
+#include "hash_table.h"
+
+struct hash_table *
+lyht_new(values_equal_cb val_equal, void *cb_data)
+{
+    struct hash_table *ht;
+
+    ht = calloc(1, sizeof *ht);
+    if (!ht) {
+        LOGMEM;
+        return NULL;
+    }
+    ht->val_equal = val_equal;
+    ht->cb_data = cb_data;
+
+    return ht;
+}
+
+void
+lyht_free(struct hash_table *ht)
+{
+    if (!ht) {
+        return;
+    }
+
+    free(ht->recs);
+    free(ht);
+}
+
+/**
+ * @brief Rehash all the records into a new table of the given size.
+ *
+ * @param[in] ht Hash table to resize.
+ * @param[in] size New size of the table, must be a power of 2 big enough for all the values.
+ * @return EXIT_SUCCESS on success, EXIT_FAILURE on memory allocation failure.
+ */
+static int
+lyht_rehash(struct hash_table *ht, uint32_t size)
+{
+    struct ht_rec *recs;
+    uint32_t i, j, mask;
+
+    recs = calloc(size, sizeof *recs);
+    if (!recs) {
+        LOGMEM;
+        return EXIT_FAILURE;
+    }
+
+    mask = size - 1;
+    for (i = 0; i < ht->size; ++i) {
+        if (!ht->recs[i].val) {
+            continue;
+        }
+        for (j = ht->recs[i].hash & mask; recs[j].val; j = (j + 1) & mask);
+        recs[j].val = ht->recs[i].val;
+        recs[j].hash = ht->recs[i].hash;
+    }
+
+    free(ht->recs);
+    ht->recs = recs;
+    ht->size = size;
+    ht->deleted = 0;
+
+    return EXIT_SUCCESS;
+}
+
+int
+lyht_find(struct hash_table *ht, void *val_searched, uint32_t hash, void **match_p)
+{
+    uint32_t i, mask;
+    struct ht_rec *rec;
+
+    if (!ht->recs) {
+        return EXIT_FAILURE;
+    }
+
+    mask = ht->size - 1;
+    for (i = hash & mask; ht->recs[i].val || ht->recs[i].deleted; i = (i + 1) & mask) {
+        rec = &ht->recs[i];
+        if (rec->val && (rec->hash == hash) && ht->val_equal(val_searched, rec->val, ht->cb_data)) {
+            if (match_p) {
+                *match_p = rec->val;
+            }
+            return EXIT_SUCCESS;
+        }
+    }
+
+    return EXIT_FAILURE;
+}
+
+int
+lyht_find_next(struct hash_table *ht, void *val_searched, uint32_t hash, void **match_p)
+{
+    uint32_t i, mask;
+    struct ht_rec *rec;
+    int found_prev = 0;
+
+    if (!ht->recs) {
+        return EXIT_FAILURE;
+    }
+
+    mask = ht->size - 1;
+    for (i = hash & mask; ht->recs[i].val || ht->recs[i].deleted; i = (i + 1) & mask) {
+        rec = &ht->recs[i];
+        if (!found_prev) {
+            /* skip all the records up to the previous match */
+            found_prev = (rec->val == *match_p);
+            continue;
+        }
+        if (rec->val && (rec->hash == hash) && ht->val_equal(val_searched, rec->val, ht->cb_data)) {
+            *match_p = rec->val;
+            return EXIT_SUCCESS;
+        }
+    }
+
+    return EXIT_FAILURE;
+}
+
+int
+lyht_insert(struct hash_table *ht, void *val, uint32_t hash)
+{
+    uint32_t i, mask, size;
+
+    assert(val);
+
+    /* keep at most 3/4 of the records used (or deleted) */
+    if (!ht->recs || ((uint64_t)(ht->used + ht->deleted + 1) * 4 > (uint64_t)ht->size * 3)) {
+        for (size = LYHT_MIN_SIZE; (uint64_t)(ht->used + 1) * 2 > size; size <<= 1);
+        if (lyht_rehash(ht, size)) {
+            return EXIT_FAILURE;
+        }
+    }
+
+    mask = ht->size - 1;
+    for (i = hash & mask; ht->recs[i].val; i = (i + 1) & mask);
+    if (ht->recs[i].deleted) {
+        ht->recs[i].deleted = 0;
+        --ht->deleted;
+    }
+    ht->recs[i].val = val;
+    ht->recs[i].hash = hash;
+    ++ht->used;
+
+    return EXIT_SUCCESS;
+}
+
+int
+lyht_remove(struct hash_table *ht, void *val, uint32_t hash)
+{
+    uint32_t i, mask;
+
+    if (!ht->recs) {
+        return EXIT_FAILURE;
+    }
+
+    mask = ht->size - 1;
+    for (i = hash & mask; ht->recs[i].val || ht->recs[i].deleted; i = (i + 1) & mask) {
+        if (ht->recs[i].val == val) {
+            ht->recs[i].val = NULL;
+            ht->recs[i].deleted = 1;
+            --ht->used;
+            ++ht->deleted;
+
+            /* shrink the table if it is mostly empty, failing to do so is not an error */
+            if ((ht->size > LYHT_MIN_SIZE) && ((uint64_t)ht->used * 8 < ht->size)) {
+                lyht_rehash(ht, ht->size >> 1);
+            }
+            return EXIT_SUCCESS;
+        }
+    }
+
+    return EXIT_FAILURE;
+}
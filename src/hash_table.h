@@ -0,0 +1,119 @@
+/**
+ * @file hash_table.h
+ * @brief libyang generic hash table
+ *
+ * Copyright (c) 2017 CESNET, z.s.p.o.
+ *
+ * This source code is licensed under BSD 3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/BSD-3-Clause
+ */
+
+#ifndef LY_HASH_TABLE_H_
+#define LY_HASH_TABLE_H_
+
+#include <stdint.h>
+
+/**
+ * initial (and minimal) size of a hash table, must be a power of 2
+ */
+#define LYHT_MIN_SIZE 16
+
+/**
+ * @brief Callback for checking whether a stored value matches the searched one.
+ *
+ * @param[in] val_searched Searched value as passed to lyht_find(), it does not need to be of the same type
+ * as the stored values (it can be a structure describing the value, for example).
+ * @param[in] val_stored Value stored in the hash table.
+ * @param[in] cb_data User callback data passed to lyht_new().
+ * @return non-zero if the values match, 0 otherwise.
+ */
+typedef int (*values_equal_cb)(void *val_searched, void *val_stored, void *cb_data);
+
+/**
+ * record of a hash table (a slot of the open-addressing table)
+ */
+struct ht_rec {
+    void *val;              /**< stored value (pointer), NULL for a free or deleted record */
+    uint32_t hash;          /**< hash of the value */
+    uint8_t deleted;        /**< flag for a deleted record (tombstone), the probing must continue behind it */
+};
+
+/**
+ * hash table of pointers to arbitrary values
+ *
+ * It uses open addressing with linear probing and grows (or shrinks) by rehashing all the records at once.
+ * Several values with the same hash (even equal values) can be stored, they are distinguished by their
+ * pointers when removing.
+ */
+struct hash_table {
+    struct ht_rec *recs;        /**< the table, allocated with the first inserted value */
+    uint32_t size;              /**< size of the recs table, always a power of 2 */
+    uint32_t used;              /**< number of stored values */
+    uint32_t deleted;           /**< number of deleted records */
+    values_equal_cb val_equal;  /**< callback for matching the searched values */
+    void *cb_data;              /**< user data for the callback */
+};
+
+/**
+ * @brief Create a new (empty) hash table.
+ *
+ * @param[in] val_equal Callback for matching the searched values.
+ * @param[in] cb_data User data for the callback.
+ * @return Created hash table, NULL on memory allocation failure.
+ */
+struct hash_table *lyht_new(values_equal_cb val_equal, void *cb_data);
+
+/**
+ * @brief Free a hash table, the stored values are not touched.
+ *
+ * @param[in] ht Hash table to free.
+ */
+void lyht_free(struct hash_table *ht);
+
+/**
+ * @brief Find a value in a hash table.
+ *
+ * @param[in] ht Hash table to search in.
+ * @param[in] val_searched Searched value passed to the values_equal_cb callback.
+ * @param[in] hash Hash of the searched value.
+ * @param[out] match_p Matching stored value, if found.
+ * @return EXIT_SUCCESS if a matching value was found, EXIT_FAILURE otherwise.
+ */
+int lyht_find(struct hash_table *ht, void *val_searched, uint32_t hash, void **match_p);
+
+/**
+ * @brief Find the next value matching the searched one in a hash table, for iterating over several matches.
+ *
+ * @param[in] ht Hash table to search in.
+ * @param[in] val_searched Searched value passed to the values_equal_cb callback.
+ * @param[in] hash Hash of the searched value.
+ * @param[in,out] match_p Previous matching stored value as returned by lyht_find() or lyht_find_next(), the next
+ * matching stored value on output, if found.
+ * @return EXIT_SUCCESS if another matching value was found, EXIT_FAILURE otherwise.
+ */
+int lyht_find_next(struct hash_table *ht, void *val_searched, uint32_t hash, void **match_p);
+
+/**
+ * @brief Insert a value into a hash table. It is not checked whether the value is already stored.
+ *
+ * @param[in] ht Hash table to insert into.
+ * @param[in] val Value to insert, must not be NULL.
+ * @param[in] hash Hash of the value.
+ * @return EXIT_SUCCESS on success, EXIT_FAILURE on memory allocation failure.
+ */
+int lyht_insert(struct hash_table *ht, void *val, uint32_t hash);
+
+/**
+ * @brief Remove a value (compared as a pointer) from a hash table.
+ *
+ * @param[in] ht Hash table to remove from.
+ * @param[in] val Value to remove.
+ * @param[in] hash Hash of the value, the same as used when inserting it.
+ * @return EXIT_SUCCESS on success, EXIT_FAILURE if the value was not found.
+ */
+int lyht_remove(struct hash_table *ht, void *val, uint32_t hash);
+
+#endif /* LY_HASH_TABLE_H_ */
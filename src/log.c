@@ -15,10 +15,13 @@
 #define _GNU_SOURCE
 #define _BSD_SOURCE
 #include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <limits.h>
 #include <string.h>
+#include <sys/types.h>
 
 #include "common.h"
 #include "tree_internal.h"
@@ -60,6 +63,45 @@ API void
     return ly_log_clb;
 }
 
+/* get a new error item, the caller fills the message and the path */
+static struct ly_err_item *
+log_err_item_new(struct ly_err *e)
+{
+    struct ly_err_item *eitem;
+
+    if (e->pool) {
+        eitem = e->pool;
+        e->pool = eitem->next;
+    } else {
+        eitem = malloc(sizeof *eitem);
+        if (!eitem) {
+            return NULL;
+        }
+    }
+    eitem->no = ly_errno;
+    eitem->code = ly_vecode;
+    eitem->msg = NULL;
+    eitem->path = NULL;
+    eitem->next = NULL;
+    eitem->fmt = NULL;
+
+    return eitem;
+}
+
+/* store error information into a list */
+static void
+log_err_item_add(struct ly_err *e, struct ly_err_item *eitem)
+{
+    struct ly_err_item *last;
+
+    if (!e->errlist) {
+        e->errlist = eitem;
+    } else {
+        for (last = e->errlist; last->next; last = last->next);
+        last->next = eitem;
+    }
+}
+
 static void
 log_vprintf(LY_LOG_LEVEL level, uint8_t hide, const char *format, const char *path, va_list args)
 {
@@ -67,6 +109,11 @@ log_vprintf(LY_LOG_LEVEL level, uint8_t hide, const char *format, const char *pa
     struct ly_err *e = ly_err_location();
     struct ly_err_item *eitem;
 
+    if ((level == LY_LLERR) && e && e->postponed) {
+        /* the previous errors need the current message and path buffers */
+        ly_err_format();
+    }
+
     if (&ly_errno == &ly_errno_int) {
         msg = "Internal logger error";
     } else if (!format) {
@@ -100,24 +147,13 @@ log_vprintf(LY_LOG_LEVEL level, uint8_t hide, const char *format, const char *pa
         /* if the error-app-tag should be set, do it after calling LOGVAL */
         e->apptag[0] = '\0';
 
-        /* store error information into a list */
-        if (!e->errlist) {
-            eitem = e->errlist = malloc(sizeof *eitem);
-        } else {
-            for (eitem = e->errlist; eitem->next; eitem = eitem->next);
-            eitem->next = malloc(sizeof *eitem->next);
-            eitem = eitem->next;
-        }
+        eitem = log_err_item_new(e);
         if (eitem) {
-            eitem->no = ly_errno;
-            eitem->code = ly_vecode;
             eitem->msg = strdup(msg);
             if (path) {
                 eitem->path = strdup(path);
-            } else {
-                eitem->path = NULL;
             }
-            eitem->next = NULL;
+            log_err_item_add(e, eitem);
         }
     }
 
@@ -419,6 +455,10 @@ void
 ly_vlog_hide(uint8_t hide)
 {
     (*ly_vlog_hide_location()) = hide;
+    if (!hide) {
+        /* the errors are going to be processed by the caller */
+        ly_err_format();
+    }
 }
 
 void
@@ -615,6 +655,356 @@ ly_vlog_build_path_reverse(enum LY_VLOG_ELEM elem_type, const void *elem, char *
     }
 }
 
+/* no copy of the string argument, it was NULL */
+#define LOG_ARG_STR_NULL ((size_t)-1)
+
+/**
+ * @brief Parse a single conversion specification of a printf-like format.
+ *
+ * @param[in] fmt Format right after the '%' character.
+ * @param[out] width_star Whether the width is given by an argument.
+ * @param[out] prec Precision, -1 if not specified, -2 if given by an argument.
+ * @param[out] length Length modifier (h, H for hh, l, q for ll, z, j, t), 0 if none.
+ * @param[out] conv Conversion character.
+ * @return Length of the specification, 0 if not supported.
+ */
+static size_t
+log_parse_spec(const char *fmt, int *width_star, int *prec, char *length, char *conv)
+{
+    const char *ptr = fmt;
+
+    *width_star = 0;
+    *prec = -1;
+    *length = 0;
+
+    ptr += strspn(ptr, "-+ #0");
+    if (*ptr == '*') {
+        *width_star = 1;
+        ++ptr;
+    } else {
+        ptr += strspn(ptr, "0123456789");
+    }
+    if (*ptr == '.') {
+        ++ptr;
+        if (*ptr == '*') {
+            *prec = -2;
+            ++ptr;
+        } else {
+            *prec = atoi(ptr);
+            ptr += strspn(ptr, "0123456789");
+        }
+    }
+    switch (*ptr) {
+    case 'h':
+    case 'l':
+        *length = *ptr;
+        ++ptr;
+        if (*ptr == *length) {
+            *length = (*length == 'h') ? 'H' : 'q';
+            ++ptr;
+        }
+        break;
+    case 'z':
+    case 'j':
+    case 't':
+        *length = *ptr;
+        ++ptr;
+        break;
+    }
+
+    *conv = *ptr;
+    if (!*conv || !strchr("diuoxXceEfFgGaAsp", *conv) || ((*length == 'l') && ((*conv == 'c') || (*conv == 's')))) {
+        /* wide characters or something not used in the library messages */
+        return 0;
+    }
+
+    return ptr + 1 - fmt;
+}
+
+/**
+ * @brief Store the arguments of an error message to be formatted later by log_format_msg().
+ *
+ * @param[in] eitem Error item to store into.
+ * @param[in] fmt Message format.
+ * @param[in] copy_fmt Whether to store a copy of the format, too.
+ * @param[in] ap Message arguments.
+ * @return 0 on success, non-zero if the message must be formatted right away.
+ */
+static int
+log_store_args(struct ly_err_item *eitem, const char *fmt, int copy_fmt, va_list ap)
+{
+    union ly_err_arg *arg = eitem->args;
+    size_t strs_used = 0, len;
+    int width_star, prec;
+    char length, conv;
+    const char *str;
+
+    if (copy_fmt) {
+        len = strlen(fmt) + 1;
+        if (len > LY_ERR_ARGS_SIZE) {
+            return 1;
+        }
+        memcpy(eitem->strs, fmt, len);
+        fmt = eitem->strs;
+        strs_used = len;
+    }
+    eitem->fmt = fmt;
+
+    while ((fmt = strchr(fmt, '%'))) {
+        ++fmt;
+        if (*fmt == '%') {
+            ++fmt;
+            continue;
+        }
+        len = log_parse_spec(fmt, &width_star, &prec, &length, &conv);
+        if (!len || (arg + width_star + (prec == -2) + 1 > eitem->args + LY_ERR_ARGS_COUNT)) {
+            return 1;
+        }
+        fmt += len;
+
+        if (width_star) {
+            (arg++)->num = va_arg(ap, int);
+        }
+        if (prec == -2) {
+            arg->num = va_arg(ap, int);
+            prec = (arg->num < 0) ? -1 : arg->num;
+            ++arg;
+        }
+
+        switch (conv) {
+        case 'd':
+        case 'i':
+        case 'c':
+            switch (length) {
+            case 'H':
+                arg->num = (signed char)va_arg(ap, int);
+                break;
+            case 'h':
+                arg->num = (short)va_arg(ap, int);
+                break;
+            case 'l':
+                arg->num = va_arg(ap, long);
+                break;
+            case 'q':
+                arg->num = va_arg(ap, long long);
+                break;
+            case 'z':
+                arg->num = va_arg(ap, ssize_t);
+                break;
+            case 'j':
+                arg->num = va_arg(ap, intmax_t);
+                break;
+            case 't':
+                arg->num = va_arg(ap, ptrdiff_t);
+                break;
+            default:
+                arg->num = va_arg(ap, int);
+                break;
+            }
+            break;
+        case 'u':
+        case 'o':
+        case 'x':
+        case 'X':
+            switch (length) {
+            case 'H':
+                arg->unum = (unsigned char)va_arg(ap, unsigned int);
+                break;
+            case 'h':
+                arg->unum = (unsigned short)va_arg(ap, unsigned int);
+                break;
+            case 'l':
+                arg->unum = va_arg(ap, unsigned long);
+                break;
+            case 'q':
+                arg->unum = va_arg(ap, unsigned long long);
+                break;
+            case 'z':
+                arg->unum = va_arg(ap, size_t);
+                break;
+            case 'j':
+                arg->unum = va_arg(ap, uintmax_t);
+                break;
+            case 't':
+                arg->unum = va_arg(ap, ptrdiff_t);
+                break;
+            default:
+                arg->unum = va_arg(ap, unsigned int);
+                break;
+            }
+            break;
+        case 's':
+            str = va_arg(ap, const char *);
+            if (!str) {
+                arg->str = LOG_ARG_STR_NULL;
+                break;
+            }
+            len = (prec > -1) ? strnlen(str, prec) : strlen(str);
+            if (strs_used + len + 1 > LY_ERR_ARGS_SIZE) {
+                return 1;
+            }
+            memcpy(eitem->strs + strs_used, str, len);
+            eitem->strs[strs_used + len] = '\0';
+            arg->str = strs_used;
+            strs_used += len + 1;
+            break;
+        case 'p':
+            arg->ptr = va_arg(ap, void *);
+            break;
+        default:
+            /* floating point */
+            arg->real = va_arg(ap, double);
+            break;
+        }
+        ++arg;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Format the message of a postponed error into the \p msg buffer.
+ */
+static void
+log_format_msg(struct ly_err_item *eitem, char *msg)
+{
+    const union ly_err_arg *arg = eitem->args;
+    const char *fmt = eitem->fmt, *ptr;
+    char spec[64], *sptr, length, conv;
+    size_t len, used = 0, size = LY_BUF_SIZE - 1;
+    int width_star, prec, r;
+
+    msg[0] = '\0';
+    while (*fmt && (used < size)) {
+        /* plain text */
+        ptr = strchr(fmt, '%');
+        len = ptr ? (size_t)(ptr - fmt) : strlen(fmt);
+        if (len || (ptr && (ptr[1] == '%'))) {
+            if (ptr && (ptr[1] == '%')) {
+                ++len;
+                ptr += 2;
+            }
+            if (len > size - used) {
+                len = size - used;
+            }
+            memcpy(msg + used, fmt, len);
+            used += len;
+            fmt = ptr ? ptr : fmt + strlen(fmt);
+            continue;
+        }
+
+        /* conversion, the stars are replaced with their values and the integers always printed as long long */
+        ++fmt;
+        len = log_parse_spec(fmt, &width_star, &prec, &length, &conv);
+        sptr = spec;
+        *(sptr++) = '%';
+        for (ptr = fmt; ptr < fmt + len - 1; ++ptr) {
+            if (*ptr == '*') {
+                if ((ptr[-1] == '.') && (arg->num < 0)) {
+                    /* negative precision means no precision */
+                    --sptr;
+                } else {
+                    sptr += sprintf(sptr, "%lld", arg->num);
+                }
+                ++arg;
+            } else if (!strchr("hlzjt", *ptr)) {
+                *(sptr++) = *ptr;
+            }
+        }
+        fmt += len;
+
+        switch (conv) {
+        case 'd':
+        case 'i':
+            sprintf(sptr, "ll%c", conv);
+            r = snprintf(msg + used, size + 1 - used, spec, arg->num);
+            break;
+        case 'u':
+        case 'o':
+        case 'x':
+        case 'X':
+            sprintf(sptr, "ll%c", conv);
+            r = snprintf(msg + used, size + 1 - used, spec, arg->unum);
+            break;
+        case 'c':
+            sprintf(sptr, "%c", conv);
+            r = snprintf(msg + used, size + 1 - used, spec, (int)arg->num);
+            break;
+        case 's':
+            sprintf(sptr, "%c", conv);
+            r = snprintf(msg + used, size + 1 - used, spec,
+                         (arg->str == LOG_ARG_STR_NULL) ? NULL : eitem->strs + arg->str);
+            break;
+        case 'p':
+            sprintf(sptr, "%c", conv);
+            r = snprintf(msg + used, size + 1 - used, spec, arg->ptr);
+            break;
+        default:
+            sprintf(sptr, "%c", conv);
+            r = snprintf(msg + used, size + 1 - used, spec, arg->real);
+            break;
+        }
+        ++arg;
+        if (r > 0) {
+            used += r;
+        }
+    }
+
+    if (used > size) {
+        used = size;
+    }
+    msg[used] = '\0';
+}
+
+void
+ly_err_format(void)
+{
+    struct ly_err *e = ly_err_location();
+    struct ly_err_item *eitem;
+    char *path;
+    uint16_t *index;
+
+    if (!e || !e->postponed) {
+        return;
+    }
+    eitem = e->postponed;
+    e->postponed = NULL;
+
+    /* in the order they were logged since they may refer to the previous path */
+    path = e->path;
+    index = &e->path_index;
+    for (; eitem; eitem = eitem->next) {
+        if (!eitem->fmt) {
+            /* logged while formatting (internal error) */
+            continue;
+        }
+
+        if (path_flag) {
+            if (eitem->elem_type == LY_VLOG_LYD) {
+                (*index) = LY_BUF_SIZE - 1;
+                path[(*index)] = '\0';
+                if (!eitem->elem) {
+                    path[--(*index)] = '/';
+                } else {
+                    ly_vlog_build_path_reverse(LY_VLOG_LYD, eitem->elem, path, index, 0);
+                }
+            } else if (eitem->elem_type == LY_VLOG_NONE) {
+                path[(*index)] = '\0';
+            }
+        }
+        if (!path_flag || !path[(*index)]) {
+            /* erase previous path */
+            (*index) = LY_BUF_SIZE - 1;
+            path[(*index)] = '\0';
+        }
+
+        log_format_msg(eitem, e->msg);
+        eitem->msg = strdup(e->msg);
+        eitem->path = path[(*index)] ? strdup(&path[(*index)]) : NULL;
+        eitem->fmt = NULL;
+    }
+}
+
 void
 ly_vlog(LY_ECODE code, enum LY_VLOG_ELEM elem_type, const void *elem, ...)
 {
@@ -622,6 +1012,9 @@ ly_vlog(LY_ECODE code, enum LY_VLOG_ELEM elem_type, const void *elem, ...)
     const char *fmt;
     char* path = NULL;
     uint16_t *index = NULL;
+    int r;
+    struct ly_err *e;
+    struct ly_err_item *eitem;
 
     ly_errno = LY_EVALID;
 
@@ -632,6 +1025,43 @@ ly_vlog(LY_ECODE code, enum LY_VLOG_ELEM elem_type, const void *elem, ...)
         ly_vecode = ecode2vecode[code];
     }
 
+    e = ly_err_location();
+    if (e && e->vlog_hide && (code != LYE_PATH)
+            && ((elem_type == LY_VLOG_LYD) || (elem_type == LY_VLOG_NONE) || (elem_type == LY_VLOG_PREV))
+            && (eitem = log_err_item_new(e))) {
+        /* the error is not printed and most probably cleaned right away (union types, speculative validation),
+         * so only store what is needed for creating the message and the path if anyone asks for them */
+        eitem->elem_type = elem_type;
+        eitem->elem = elem;
+
+        va_start(ap, elem);
+        if (code == LYE_SPEC) {
+            fmt = va_arg(ap, char *);
+            r = log_store_args(eitem, fmt, 1, ap);
+        } else {
+            r = log_store_args(eitem, ly_errs[code], 0, ap);
+        }
+        va_end(ap);
+
+        if (!r) {
+            /* if the error-app-tag should be set, do it after calling LOGVAL */
+            e->apptag[0] = '\0';
+            log_err_item_add(e, eitem);
+            if (!e->postponed) {
+                e->postponed = eitem;
+            }
+            return;
+        }
+
+        /* not possible to store, use the common way */
+        eitem->next = e->pool;
+        e->pool = eitem;
+    }
+
+    if (e && e->postponed) {
+        ly_err_format();
+    }
+
     if (!path_flag) {
         goto log;
     }
@@ -678,6 +1108,7 @@ ly_err_repeat(void)
     struct ly_err_item *i;
 
     if ((ly_log_level >= LY_LLERR) && !*ly_vlog_hide_location()) {
+        ly_err_format();
         for (i = ly_err_location()->errlist; i; i = i->next) {
             if (ly_log_clb) {
                 ly_log_clb(LY_LLERR, i->msg, i->path);
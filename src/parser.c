@@ -34,6 +34,7 @@
 #include "parser.h"
 #include "resolve.h"
 #include "tree_internal.h"
+#include "validation.h"
 #include "parser_yang.h"
 
 #define LYP_URANGE_LEN 19
@@ -232,6 +233,146 @@ lyp_check_options(int options)
     return x ? !(x && !(x & (x - 1))) : 0;
 }
 
+int
+lyp_data_parse_init(struct lyd_parse_state *state, struct ly_ctx *ctx, int options,
+                    const struct lyd_node *rpc_act, const struct lyd_node *data_tree)
+{
+    struct lyd_node *iter;
+
+    memset(state, 0, sizeof *state);
+    state->ctx = ctx;
+    state->options = options;
+    state->rpc_act = rpc_act;
+    state->data_tree = data_tree;
+
+    state->unres = calloc(1, sizeof *state->unres);
+    if (!state->unres) {
+        LOGMEM;
+        return EXIT_FAILURE;
+    }
+
+    /* create RPC/action reply part that is not in the parsed data */
+    if (options & LYD_OPT_RPCREPLY) {
+        if (rpc_act->schema->nodetype == LYS_RPC) {
+            /* RPC request */
+            state->reply_top = state->reply_parent = _lyd_new(NULL, rpc_act->schema, 0);
+        } else {
+            /* action request */
+            state->reply_top = lyd_dup(rpc_act, 1);
+            LY_TREE_DFS_BEGIN(state->reply_top, iter, state->reply_parent) {
+                if (state->reply_parent->schema->nodetype == LYS_ACTION) {
+                    break;
+                }
+                LY_TREE_DFS_END(state->reply_top, iter, state->reply_parent);
+            }
+            if (!state->reply_parent) {
+                LOGERR(LY_EINVAL, "%s: invalid variable parameter (const struct lyd_node *rpc_act).", __func__);
+                lyp_data_parse_clean(state);
+                return EXIT_FAILURE;
+            }
+            lyd_free_withsiblings(state->reply_parent->child);
+        }
+    }
+    state->next = state->reply_parent;
+
+    return EXIT_SUCCESS;
+}
+
+struct lyd_node *
+lyp_data_parse_finish(struct lyd_parse_state *state)
+{
+    struct lyd_node *result, *iter;
+    struct ly_set *set;
+    int i;
+
+    if (state->reply_top) {
+        state->result = state->reply_top;
+    }
+    result = state->result;
+
+    if ((state->options & LYD_OPT_RPCREPLY) && (state->rpc_act->schema->nodetype != LYS_RPC)) {
+        /* action reply */
+        state->act_notif = state->reply_parent;
+    } else if ((state->options & (LYD_OPT_RPC | LYD_OPT_NOTIF)) && !state->act_notif) {
+        ly_vecode = LYVE_INELEM;
+        LOGVAL(LYE_SPEC, LY_VLOG_LYD, result, "Missing %s node.", (state->options & LYD_OPT_RPC ? "action" : "notification"));
+        goto error;
+    }
+
+    /* check for uniquness of top-level lists/leaflists because
+     * only the inner instances were tested in lyv_data_content() */
+    set = ly_set_new();
+    LY_TREE_FOR(result, iter) {
+        if (!(iter->schema->nodetype & (LYS_LIST | LYS_LEAFLIST)) || !(iter->validity & LYD_VAL_UNIQUE)) {
+            continue;
+        }
+
+        /* check each list/leaflist only once */
+        i = set->number;
+        if (ly_set_add(set, iter->schema, 0) != i) {
+            /* already checked */
+            continue;
+        }
+
+        if (lyv_data_unique(iter, result)) {
+            ly_set_free(set);
+            goto error;
+        }
+    }
+    ly_set_free(set);
+
+    /* add default values, resolve unres and check for mandatory nodes in final tree */
+    if (lyd_defaults_add_unres(&state->result, state->options, state->ctx, state->data_tree, state->act_notif,
+                               state->unres)) {
+        goto error;
+    }
+    if (!(state->options & (LYD_OPT_TRUSTED | LYD_OPT_NOTIF_FILTER))
+            && lyd_check_mandatory_tree((state->act_notif ? state->act_notif : state->result), state->ctx,
+                                        state->options)) {
+        goto error;
+    }
+
+    /* the tree is no longer owned by the state */
+    result = state->result;
+    state->result = state->reply_top = NULL;
+    lyp_data_parse_clean(state);
+    return result;
+
+error:
+    lyp_data_parse_clean(state);
+    return NULL;
+}
+
+void
+lyp_data_parse_clean(struct lyd_parse_state *state)
+{
+    struct attr_cont *attrs;
+
+    if (state->reply_top) {
+        state->result = state->reply_top;
+    }
+    lyd_free_withsiblings(state->result);
+    state->result = state->last = state->reply_top = state->reply_parent = state->act_notif = state->next = NULL;
+
+    while (state->attrs) {
+        attrs = state->attrs;
+        state->attrs = attrs->next;
+
+        lyd_free_attr(state->ctx, NULL, attrs->attr, 1);
+        free(attrs);
+    }
+
+    lyxml_free(state->ctx, state->xmlact);
+    state->xmlact = NULL;
+
+    if (state->unres) {
+        free(state->unres->node);
+        free(state->unres->type);
+        free(state->unres);
+        state->unres = NULL;
+    }
+}
+
 void *
 lyp_mmap(int fd, size_t addsize, size_t *length)
 {
@@ -437,33 +578,118 @@ lys_read_import(struct ly_ctx *ctx, int fd, LYS_INFORMAT format, const char *rev
     return module;
 }
 
-/* if module is !NULL, then the function searches for submodule */
-struct lys_module *
-lyp_search_file(struct ly_ctx *ctx, struct lys_module *module, const char *name, const char *revision,
-                int implement, struct unres_schema *unres)
+/* searched (sub)module name */
+struct lyp_search_key {
+    const char *name;
+    size_t len;
+};
+
+static int
+lyp_search_file_equal(void *val_searched, void *val_stored, void *UNUSED(cb_data))
 {
-    size_t len, flen, match_len = 0, dir_len;
-    int fd, i;
-    char *wd, *wn = NULL;
+    struct lyp_search_key *key = val_searched;
+    struct ly_search_file *file = val_stored;
+
+    return (file->name_len == key->len) && !strncmp(file->name, key->name, key->len);
+}
+
+static uint32_t
+lyp_search_hash(const char *name, size_t len)
+{
+    return dict_hash_multi(dict_hash_multi(0, name, len), NULL, 0);
+}
+
+void
+lyp_search_index_clean(struct ly_ctx *ctx)
+{
+    struct ly_search_index *index = &ctx->search_index;
+    uint32_t u;
+
+    for (u = 0; u < index->count; ++u) {
+        free(index->files[u].path);
+    }
+    free(index->files);
+    if (index->ht) {
+        lyht_free(index->ht);
+    }
+    free(index->cwd);
+    memset(index, 0, sizeof *index);
+}
+
+/* adds a regular file into the index being built, takes the path */
+static int
+lyp_search_index_add(struct ly_search_index *index, uint32_t *size, char *path, size_t dir_len)
+{
+    struct ly_search_file *file;
+    const char *name, *rev;
+    size_t flen;
+    LYS_INFORMAT format;
+
+    /* get type according to filename suffix */
+    name = &path[dir_len + 1];
+    flen = strlen(name);
+    if ((flen > 4) && !strcmp(&name[flen - 4], ".yin")) {
+        format = LYS_IN_YIN;
+        flen -= 4;
+    } else if ((flen > 5) && !strcmp(&name[flen - 5], ".yang")) {
+        format = LYS_IN_YANG;
+        flen -= 5;
+    } else {
+        /* not supported suffix/file format */
+        free(path);
+        return EXIT_SUCCESS;
+    }
+
+    if (index->count == *size) {
+        *size = *size ? *size * 2 : 64;
+        file = realloc(index->files, *size * sizeof *index->files);
+        if (!file) {
+            LOGMEM;
+            free(path);
+            return EXIT_FAILURE;
+        }
+        index->files = file;
+    }
+
+    file = &index->files[index->count++];
+    file->path = path;
+    file->name = name;
+    rev = memchr(name, '@', flen);
+    file->name_len = rev ? (size_t)(rev - name) : flen;
+    file->format = format;
+    file->next = NULL;
+
+    return EXIT_SUCCESS;
+}
+
+/* explores the search directories and the current working directory, takes cwd */
+static int
+lyp_search_index_build(struct ly_ctx *ctx, char *cwd)
+{
+    struct ly_search_index *index = &ctx->search_index;
+    struct ly_search_file *file, *first;
+    struct lyp_search_key key;
+    size_t dir_len;
+    int i, ret = EXIT_FAILURE;
+    char *wd = NULL, *wn = NULL;
     DIR *dir = NULL;
-    struct dirent *file;
-    char *match_name = NULL, *dot, *rev, *filename;
-    LYS_INFORMAT format, match_format = 0;
-    struct lys_module *result = NULL;
-    unsigned int u;
+    struct dirent *d;
+    uint32_t u, size = 0, hash;
     struct ly_set *dirs;
     struct stat st;
 
+    lyp_search_index_clean(ctx);
+    index->cwd = cwd;
+
     /* start to fill the dir fifo with the context's search path (if set)
      * and the current working directory */
     dirs = ly_set_new();
     if (!dirs) {
         LOGMEM;
-        return NULL;
+        return EXIT_FAILURE;
     }
 
-    len = strlen(name);
-    wd = get_current_dir_name();
+    wd = strdup(cwd);
     if (!wd) {
         LOGMEM;
         goto cleanup;
@@ -483,7 +709,7 @@ lyp_search_file(struct ly_ctx *ctx, struct lys_module *module, const char *name,
     }
     wd = NULL;
 
-    /* start searching */
+    /* start exploring */
     while (dirs->number) {
         free(wd);
         free(wn); wn = NULL;
@@ -491,7 +717,7 @@ lyp_search_file(struct ly_ctx *ctx, struct lys_module *module, const char *name,
         dirs->number--;
         wd = (char *)dirs->set.g[dirs->number];
         dirs->set.g[dirs->number] = NULL;
-        LOGVRB("Searching for \"%s\" in %s.", name, wd);
+        LOGVRB("Searching for (sub)modules in %s.", wd);
 
         if (dir) {
             closedir(dir);
@@ -501,19 +727,19 @@ lyp_search_file(struct ly_ctx *ctx, struct lys_module *module, const char *name,
         if (!dir) {
             LOGWRN("Unable to open directory \"%s\" for searching (sub)modules (%s).", wd, strerror(errno));
         } else {
-            while ((file = readdir(dir))) {
-                if (!strcmp(".", file->d_name) || !strcmp("..", file->d_name)) {
+            while ((d = readdir(dir))) {
+                if (!strcmp(".", d->d_name) || !strcmp("..", d->d_name)) {
                     /* skip . and .. */
                     continue;
                 }
                 free(wn);
-                if (asprintf(&wn, "%s/%s", wd, file->d_name) == -1) {
+                if (asprintf(&wn, "%s/%s", wd, d->d_name) == -1) {
                     LOGMEM;
                     goto cleanup;
                 }
                 if (stat(wn, &st) == -1) {
                     LOGWRN("Unable to get information about \"%s\" file in \"%s\" when searching for (sub)modules (%s)",
-                           file->d_name, wd, strerror(errno));
+                           d->d_name, wd, strerror(errno));
                     continue;
                 }
                 if (S_ISDIR(st.st_mode) && dirs->number) {
@@ -531,71 +757,138 @@ lyp_search_file(struct ly_ctx *ctx, struct lys_module *module, const char *name,
                 }
 
                 /* here we know that the item is a file which can contain a module */
-                if (strncmp(name, file->d_name, len) ||
-                        (file->d_name[len] != '.' && file->d_name[len] != '@')) {
-                    /* different filename than the module we search for */
-                    continue;
+                if (lyp_search_index_add(index, &size, wn, dir_len)) {
+                    wn = NULL;
+                    goto cleanup;
                 }
+                wn = NULL;
+            }
+        }
+    }
 
-                /* get type according to filename suffix */
-                flen = strlen(file->d_name);
-                if (!strcmp(&file->d_name[flen - 4], ".yin")) {
-                    format = LYS_IN_YIN;
-                } else if (!strcmp(&file->d_name[flen - 5], ".yang")) {
-                    format = LYS_IN_YANG;
-                } else {
-                    /* not supportde suffix/file format */
-                    continue;
-                }
+    /* link the files of the same (sub)modules, keep the order */
+    index->ht = lyht_new(lyp_search_file_equal, NULL);
+    if (!index->ht) {
+        LOGMEM;
+        goto cleanup;
+    }
+    for (u = 0; u < index->count; ++u) {
+        file = &index->files[u];
+        key.name = file->name;
+        key.len = file->name_len;
+        hash = lyp_search_hash(key.name, key.len);
+        if (!lyht_find(index->ht, &key, hash, (void **)&first)) {
+            for (; first->next; first = first->next);
+            first->next = file;
+        } else if (lyht_insert(index->ht, file, hash)) {
+            goto cleanup;
+        }
+    }
+    ret = EXIT_SUCCESS;
 
-                if (revision) {
-                    /* we look for the specific revision, try to get it from the filename */
-                    if (file->d_name[len] == '@') {
-                        /* check revision from the filename */
-                        if (strncmp(revision, &file->d_name[len + 1], strlen(revision))) {
-                            /* another revision */
-                            continue;
-                        } else {
-                            /* exact revision */
-                            free(match_name);
-                            match_name = wn;
-                            wn = NULL;
-                            match_len = dir_len + 1 + len;
-                            match_format = format;
-                            goto matched;
-                        }
-                    } else {
-                        /* continue trying to find exact revision match, use this only if not found */
-                        free(match_name);
-                        match_name = wn;
-                        wn = NULL;
-                        match_len = dir_len + 1 +len;
-                        match_format = format;
-                        continue;
-                    }
-                } else {
-                    /* remember the revision and try to find the newest one */
-                    if (match_name) {
-                        if (file->d_name[len] != '@' || lyp_check_date(&file->d_name[len + 1])) {
-                            continue;
-                        } else if (match_name[match_len] == '@' &&
-                                (strncmp(&match_name[match_len + 1], &file->d_name[len + 1], LY_REV_SIZE - 1) >= 0)) {
-                            continue;
-                        }
-                        free(match_name);
-                    }
+cleanup:
+    free(wn);
+    free(wd);
+    if (dir) {
+        closedir(dir);
+    }
+    for (u = 0; u < dirs->number; u++) {
+        free(dirs->set.g[u]);
+    }
+    ly_set_free(dirs);
+    if (ret) {
+        lyp_search_index_clean(ctx);
+    }
 
-                    match_name = wn;
-                    wn = NULL;
-                    match_len = dir_len + 1 + len;
-                    match_format = format;
+    return ret;
+}
+
+/* if module is !NULL, then the function searches for submodule */
+struct lys_module *
+lyp_search_file(struct ly_ctx *ctx, struct lys_module *module, const char *name, const char *revision,
+                int implement, struct unres_schema *unres)
+{
+    size_t len;
+    int fd, rebuilt = 0;
+    char *cwd, *match_name = NULL, *dot, *rev, *filename;
+    struct ly_search_file *file, *match = NULL;
+    struct lyp_search_key key;
+    LYS_INFORMAT match_format;
+    struct lys_module *result = NULL;
+
+    len = strlen(name);
+    LOGVRB("Searching for \"%s\".", name);
+
+    /* (re)build the index of the search directories if needed */
+    cwd = get_current_dir_name();
+    if (!cwd) {
+        LOGMEM;
+        return NULL;
+    }
+    if (!ctx->search_index.ht || strcmp(ctx->search_index.cwd, cwd)) {
+        if (lyp_search_index_build(ctx, cwd)) {
+            return NULL;
+        }
+        rebuilt = 1;
+    } else {
+        free(cwd);
+    }
+
+    key.name = name;
+    key.len = len;
+search:
+    if (lyht_find(ctx->search_index.ht, &key, lyp_search_hash(name, len), (void **)&file)) {
+        file = NULL;
+    }
+    for (; file; file = file->next) {
+        if (revision) {
+            /* we look for the specific revision, try to get it from the filename */
+            if (file->name[len] == '@') {
+                /* check revision from the filename */
+                if (strncmp(revision, &file->name[len + 1], strlen(revision))) {
+                    /* another revision */
                     continue;
+                } else {
+                    /* exact revision */
+                    match = file;
+                    break;
                 }
+            } else {
+                /* continue trying to find exact revision match, use this only if not found */
+                match = file;
+                continue;
             }
+        } else {
+            /* remember the revision and try to find the newest one */
+            if (match) {
+                if (file->name[len] != '@' || lyp_check_date(&file->name[len + 1])) {
+                    continue;
+                } else if (match->name[len] == '@' &&
+                        (strncmp(&match->name[len + 1], &file->name[len + 1], LY_REV_SIZE - 1) >= 0)) {
+                    continue;
+                }
+            }
+
+            match = file;
+            continue;
         }
     }
 
-    if (!match_name) {
+    if (!match && !rebuilt) {
+        /* the file may have been added since the index was built */
+        cwd = get_current_dir_name();
+        if (!cwd) {
+            LOGMEM;
+            return NULL;
+        }
+        if (lyp_search_index_build(ctx, cwd)) {
+            return NULL;
+        }
+        rebuilt = 1;
+        goto search;
+    }
+
+    if (!match) {
         if (!module && !revision) {
             /* otherwise the module would be already taken from the context */
             result = (struct lys_module *)ly_ctx_get_module(ctx, name, revision);
@@ -606,7 +899,12 @@ lyp_search_file(struct ly_ctx *ctx, struct lys_module *module, const char *name,
         goto cleanup;
     }
 
-matched:
+    match_name = strdup(match->path);
+    if (!match_name) {
+        LOGMEM;
+        goto cleanup;
+    }
+    match_format = match->format;
     LOGVRB("Loading schema from \"%s\" file.", match_name);
 
     /* cut the format for now */
@@ -616,10 +914,9 @@ matched:
     /* check that the same file was not already loaded - it make sense only in case of loading the newest revision,
      * search also in disabled module - if the matching module is disabled, it will be enabled instead of loading it */
     if (!revision) {
-        for (i = 0; i < ctx->models.used; ++i) {
-            if (ctx->models.list[i]->filepath && !strcmp(name, ctx->models.list[i]->name)
-                    && !strncmp(match_name, ctx->models.list[i]->filepath, strlen(match_name))) {
-                result = ctx->models.list[i];
+        result = NULL;
+        while ((result = ly_ctx_mod_index_next(ctx, name, len, 0, result))) {
+            if (result->filepath && !strncmp(match_name, result->filepath, strlen(match_name))) {
                 if (implement && !result->implemented) {
                     /* make it implemented now */
                     if (lys_set_implemented(result)) {
@@ -683,17 +980,7 @@ matched:
     /* success */
 
 cleanup:
-    free(wn);
-    free(wd);
-    if (dir) {
-        closedir(dir);
-    }
     free(match_name);
-    for (u = 0; u < dirs->number; u++) {
-        free(dirs->set.g[u]);
-    }
-    ly_set_free(dirs);
-
     return result;
 }
 
@@ -900,6 +1187,7 @@ validate_pattern(const char *val_str, struct lys_type *type, struct lyd_node *no
 {
     int i, rc;
     pcre *precomp;
+    pcre_extra *study;
 
     assert(type->base == LY_TYPE_STRING);
 
@@ -912,12 +1200,21 @@ validate_pattern(const char *val_str, struct lys_type *type, struct lyd_node *no
     }
 
     for (i = 0; i < type->info.str.pat_count; ++i) {
-        if (lyp_check_pattern(&type->info.str.patterns[i].expr[1], &precomp)) {
+        if (type->info.str.patterns[i].pattern_compiled) {
+            /* use the patterns precompiled with the schema */
+            precomp = ((struct lyp_pattern *)type->info.str.patterns[i].pattern_compiled)->precomp;
+            study = ((struct lyp_pattern *)type->info.str.patterns[i].pattern_compiled)->study;
+        } else if (lyp_precompile_pattern(&type->info.str.patterns[i].expr[1], &precomp, &study)) {
             LOGINT;
             return EXIT_FAILURE;
         }
 
-        rc = pcre_exec(precomp, NULL, val_str, strlen(val_str), 0, 0, NULL, 0);
+        rc = pcre_exec(precomp, study, val_str, strlen(val_str), 0, 0, NULL, 0);
+        if (!type->info.str.patterns[i].pattern_compiled) {
+            pcre_free_study(study);
+            pcre_free(precomp);
+        }
+
         if ((rc && type->info.str.patterns[i].expr[0] == 0x06) || (!rc && type->info.str.patterns[i].expr[0] == 0x15)) {
             LOGVAL(LYE_NOCONSTR, LY_VLOG_LYD, node, val_str, &type->info.str.patterns[i].expr[1]);
             if (type->info.str.patterns[i].emsg) {
@@ -926,10 +1223,8 @@ validate_pattern(const char *val_str, struct lys_type *type, struct lyd_node *no
             if (type->info.str.patterns[i].eapptag) {
                 strncpy(((struct ly_err *)&ly_errno)->apptag, type->info.str.patterns[i].eapptag, LY_APPTAG_LEN - 1);
             }
-            free(precomp);
             return EXIT_FAILURE;
         }
-        free(precomp);
     }
 
     return EXIT_SUCCESS;
@@ -1180,12 +1475,107 @@ lyp_check_pattern(const char *pattern, pcre **pcre_precomp)
     if (pcre_precomp) {
         *pcre_precomp = precomp;
     } else {
-        free(precomp);
+        pcre_free(precomp);
     }
 
     return EXIT_SUCCESS;
 }
 
+/**
+ * @brief Compile and optimize (study) the pattern for repeated matching. Logs directly.
+ *
+ * @param[in] pattern Pattern to compile.
+ * @param[out] pcre_precomp Compiled PCRE pattern, free with pcre_free().
+ * @param[out] pcre_extra_data Optional additional data from studying the pattern (can be set to NULL even
+ * on success), free with pcre_free_study().
+ * @return EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ */
+int
+lyp_precompile_pattern(const char *pattern, pcre **pcre_precomp, pcre_extra **pcre_extra_data)
+{
+    const char *err_msg = NULL;
+
+    if (lyp_check_pattern(pattern, pcre_precomp)) {
+        return EXIT_FAILURE;
+    }
+
+#ifdef PCRE_STUDY_JIT_COMPILE
+    *pcre_extra_data = pcre_study(*pcre_precomp, PCRE_STUDY_JIT_COMPILE, &err_msg);
+#else
+    *pcre_extra_data = pcre_study(*pcre_precomp, 0, &err_msg);
+#endif
+    if (err_msg) {
+        /* the pattern is still usable, only not optimized */
+        LOGWRN("Studying pattern \"%s\" failed (%s).", pattern, err_msg);
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Precompile all the patterns of a string type and cache them in their restrictions
+ * (lys_restr#pattern_compiled) for the data validation. Does nothing if the type has no patterns or they are
+ * already precompiled. Logs directly.
+ *
+ * @param[in] type String type with the patterns.
+ * @return EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ */
+int
+lyp_precompile_type_patterns(struct lys_type *type)
+{
+    struct lyp_pattern *pat;
+    int i;
+
+    if (!type->info.str.pat_count || !type->info.str.patterns || type->info.str.patterns[0].pattern_compiled) {
+        return EXIT_SUCCESS;
+    }
+
+    for (i = 0; i < type->info.str.pat_count; ++i) {
+        pat = malloc(sizeof *pat);
+        if (!pat) {
+            LOGMEM;
+            lyp_free_type_patterns(type);
+            return EXIT_FAILURE;
+        }
+        if (lyp_precompile_pattern(&type->info.str.patterns[i].expr[1], &pat->precomp, &pat->study)) {
+            free(pat);
+            lyp_free_type_patterns(type);
+            return EXIT_FAILURE;
+        }
+        type->info.str.patterns[i].pattern_compiled = pat;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Free the precompiled patterns cached in a string type.
+ *
+ * @param[in] type String type with the precompiled patterns.
+ */
+void
+lyp_free_type_patterns(struct lys_type *type)
+{
+    struct lyp_pattern *pat;
+    int i;
+
+    if (!type->info.str.patterns) {
+        return;
+    }
+
+    for (i = 0; i < type->info.str.pat_count; ++i) {
+        pat = type->info.str.patterns[i].pattern_compiled;
+        if (!pat) {
+            /* the following ones were not precompiled either */
+            break;
+        }
+        pcre_free_study(pat->study);
+        pcre_free(pat->precomp);
+        free(pat);
+        type->info.str.patterns[i].pattern_compiled = NULL;
+    }
+}
+
 /**
  * @brief Change the value into its canonical form. In libyang, additionally to the RFC,
  * all identities have their module as a prefix in their canonical form.
@@ -3526,7 +3916,9 @@ int
 lyp_ctx_check_module(struct lys_module *module)
 {
     struct ly_ctx *ctx;
-    int i, match_i = -1, to_implement;
+    struct lys_module *mod, *match = NULL;
+    int i, to_implement;
+    size_t len;
     const char *last_rev = NULL;
 
     assert(module);
@@ -3540,56 +3932,62 @@ lyp_ctx_check_module(struct lys_module *module)
         }
     }
 
-    for (i = 0; i < ctx->models.used; i++) {
-        /* check name (name/revision) and namespace uniqueness */
-        if (!strcmp(ctx->models.list[i]->name, module->name)) {
-            if (to_implement) {
-                if (i == match_i) {
-                    continue;
-                }
-                LOGERR(LY_EINVAL, "Module \"%s\" in another revision already implemented.", ctx->models.list[i]->name);
-                return -1;
-            } else if (!ctx->models.list[i]->rev_size && module->rev_size) {
-                LOGERR(LY_EINVAL, "Module \"%s\" without revision already in context.", ctx->models.list[i]->name);
-                return -1;
-            } else if (ctx->models.list[i]->rev_size && !module->rev_size) {
-                LOGERR(LY_EINVAL, "Module \"%s\" with revision already in context.", ctx->models.list[i]->name);
-                return -1;
-            } else if ((!module->rev_size && !ctx->models.list[i]->rev_size)
-                    || !strcmp(ctx->models.list[i]->rev[0].date, last_rev)) {
-
-                LOGVRB("Module \"%s\" already in context.", ctx->models.list[i]->name);
+    /* check name (name/revision) uniqueness */
+    len = strlen(module->name);
+    mod = NULL;
+    while ((mod = ly_ctx_mod_index_next(ctx, module->name, len, 0, mod))) {
+        if (to_implement) {
+            if (mod == match) {
+                continue;
+            }
+            LOGERR(LY_EINVAL, "Module \"%s\" in another revision already implemented.", mod->name);
+            return -1;
+        } else if (!mod->rev_size && module->rev_size) {
+            LOGERR(LY_EINVAL, "Module \"%s\" without revision already in context.", mod->name);
+            return -1;
+        } else if (mod->rev_size && !module->rev_size) {
+            LOGERR(LY_EINVAL, "Module \"%s\" with revision already in context.", mod->name);
+            return -1;
+        } else if ((!module->rev_size && !mod->rev_size) || !strcmp(mod->rev[0].date, last_rev)) {
 
-                /* if disabled, enable first */
-                if (ctx->models.list[i]->disabled) {
-                    lys_set_enabled(ctx->models.list[i]);
-                }
+            LOGVRB("Module \"%s\" already in context.", mod->name);
 
-                to_implement = module->implemented;
-                match_i = i;
-                if (to_implement && !ctx->models.list[i]->implemented) {
-                    /* check first that it is okay to change it to implemented */
-                    i = -1;
-                    continue;
-                }
-                return 1;
+            /* if disabled, enable first */
+            if (mod->disabled) {
+                lys_set_enabled(mod);
+            }
 
-            } else if (module->implemented && ctx->models.list[i]->implemented) {
-                LOGERR(LY_EINVAL, "Module \"%s\" in another revision already implemented.", ctx->models.list[i]->name);
-                return -1;
+            to_implement = module->implemented;
+            match = mod;
+            if (to_implement && !mod->implemented) {
+                /* check first that it is okay to change it to implemented */
+                mod = NULL;
+                continue;
             }
-            /* else keep searching, for now the caller is just adding
-             * another revision of an already present schema
-             */
-        } else if (!strcmp(ctx->models.list[i]->ns, module->ns)) {
+            return 1;
+
+        } else if (module->implemented && mod->implemented) {
+            LOGERR(LY_EINVAL, "Module \"%s\" in another revision already implemented.", mod->name);
+            return -1;
+        }
+        /* else keep searching, for now the caller is just adding
+         * another revision of an already present schema
+         */
+    }
+
+    /* check namespace uniqueness */
+    len = strlen(module->ns);
+    mod = NULL;
+    while ((mod = ly_ctx_mod_index_next(ctx, module->ns, len, 1, mod))) {
+        if (strcmp(mod->name, module->name)) {
             LOGERR(LY_EINVAL, "Two different modules (\"%s\" and \"%s\") have the same namespace \"%s\".",
-                   ctx->models.list[i]->name, module->name, module->ns);
+                   mod->name, module->name, module->ns);
             return -1;
         }
     }
 
     if (to_implement) {
-        if (lys_set_implemented(ctx->models.list[match_i])) {
+        if (lys_set_implemented(match)) {
             return -1;
         }
         return 1;
@@ -3632,6 +4030,9 @@ lyp_ctx_add_module(struct lys_module *module)
         module->ctx->models.size *= 2;
         module->ctx->models.list = newlist;
     }
+    if (ly_ctx_mod_index_add(module)) {
+        return -1;
+    }
     module->ctx->models.list[module->ctx->models.used++] = module;
     module->ctx->models.module_set_id++;
 
@@ -31,11 +31,81 @@ struct lys_submodule *yin_read_submodule(struct lys_module *module, const char *
 
 /**@} yin */
 
+/**
+ * @brief Attributes of a JSON data node waiting for the node to be parsed.
+ */
+struct attr_cont {
+    struct attr_cont *next;
+    struct lyd_attr *attr;
+    struct lys_node *schema;
+    unsigned int index;    /** non-zero only in case of leaf-list */
+};
+
+/**
+ * @brief State of a data tree being parsed, it allows to parse the top-level nodes one by one as they are available.
+ */
+struct lyd_parse_state {
+    struct ly_ctx *ctx;
+    int options;
+    const struct lyd_node *rpc_act;   /**< request of the parsed RPC/action reply */
+    const struct lyd_node *data_tree; /**< additional data tree for RPC/action/notification validation */
+    struct unres_data *unres;
+    struct lyd_node *result;          /**< first parsed top-level node */
+    struct lyd_node *last;            /**< last parsed top-level node */
+    struct lyd_node *reply_parent;    /**< RPC/action node the reply nodes are connected to */
+    struct lyd_node *reply_top;       /**< top-level node of the RPC/action reply */
+    struct lyd_node *act_notif;       /**< parsed RPC/action/notification node */
+    struct lyxml_elem *xmlact;        /**< XML only - start tag of the action element */
+    struct attr_cont *attrs;          /**< JSON only - attributes of the top-level nodes */
+    struct lyd_node *next;            /**< JSON only - parent for the next top-level member */
+    int act_cont;                     /**< JSON only - 1 in yang:action object, -1 if there is none, 0 not known yet */
+    int done;                         /**< no more top-level nodes are supposed to be parsed */
+};
+
+/**
+ * @brief Prepare the state for parsing a (non-empty) data tree, create the RPC/action reply part not in the data.
+ *
+ * @param[out] state State to initiate.
+ * @param[in] ctx libyang context.
+ * @param[in] options Parser options.
+ * @param[in] rpc_act Request of the parsed RPC/action reply.
+ * @param[in] data_tree Data tree for RPC/action/notification validation.
+ * @return EXIT_SUCCESS on success, EXIT_FAILURE on error (the state is cleaned).
+ */
+int lyp_data_parse_init(struct lyd_parse_state *state, struct ly_ctx *ctx, int options,
+                        const struct lyd_node *rpc_act, const struct lyd_node *data_tree);
+
+/**
+ * @brief Finish parsing a data tree - check the top-level nodes, add default values and resolve unres.
+ * The state is cleaned in any case.
+ *
+ * @param[in] state State of the parsed data tree.
+ * @return Parsed data tree, NULL on error.
+ */
+struct lyd_node *lyp_data_parse_finish(struct lyd_parse_state *state);
+
+/**
+ * @brief Free all the parsed data and the state's internal structures.
+ *
+ * @param[in] state State to clean.
+ */
+void lyp_data_parse_clean(struct lyd_parse_state *state);
+
 /**
  * @defgroup xmldata XML data format support
  * @{
  */
-struct lyd_node *xml_read_data(struct ly_ctx *ctx, const char *data, int options);
+struct lyd_node *lyd_parse_xml_mem(struct ly_ctx *ctx, const char *data, int options, const struct lyd_node *rpc_act,
+                                   const struct lyd_node *data_tree);
+
+/**
+ * @brief Parse top-level elements of XML data (the action element is parsed with all its children).
+ *
+ * @param[in] state State of the parsed data tree.
+ * @param[in,out] data XML data, moved behind the parsed elements.
+ * @return EXIT_SUCCESS on success, EXIT_FAILURE on error.
+ */
+int lyd_parse_xml_roots(struct lyd_parse_state *state, const char **data);
 
 /**@} xmldata */
 
@@ -46,8 +116,45 @@ struct lyd_node *xml_read_data(struct ly_ctx *ctx, const char *data, int options
 struct lyd_node *lyd_parse_json(struct ly_ctx *ctx, const char *data, int options, const struct lyd_node *rpc_act,
                                 const struct lyd_node *data_tree);
 
+/**
+ * @brief Parse members of the top-level JSON object (the yang:action member is parsed with all its members).
+ *
+ * @param[in] state State of the parsed data tree.
+ * @param[in] data JSON data starting with the top-level begin-object or a value-separator.
+ * @return Length of the parsed data, 0 on error.
+ */
+unsigned int lyd_parse_json_members(struct lyd_parse_state *state, const char *data);
+
+/**
+ * @brief Finish parsing JSON data, lyp_data_parse_finish() with the JSON specific checks.
+ *
+ * @param[in] state State of the parsed data tree.
+ * @return Parsed data tree, NULL on error.
+ */
+struct lyd_node *lyd_parse_json_finish(struct lyd_parse_state *state);
+
 /**@} jsondata */
 
+/**
+ * @defgroup lybdata LYB data format support
+ * @{
+ */
+/**
+ * @brief Parse LYB data.
+ *
+ * @param[in] ctx Context of the data.
+ * @param[in] data LYB data.
+ * @param[in] len Length of \p data, 0 if not known and the length stored in the LYB header is trusted.
+ * @param[in] options Parser options.
+ * @param[in] rpc_act Request of the parsed RPC/action reply.
+ * @param[in] data_tree Data tree for RPC/action/notification validation.
+ * @return Parsed data tree, NULL on error or empty data.
+ */
+struct lyd_node *lyd_parse_lyb(struct ly_ctx *ctx, const char *data, size_t len, int options,
+                               const struct lyd_node *rpc_act, const struct lyd_node *data_tree);
+
+/**@} lybdata */
+
 /**
  * internal options values for schema parsers
  */
@@ -81,6 +188,13 @@ int lyp_yin_parse_subnode_ext(struct lys_module *mod, void *elem, LYEXT_PAR elem
 struct lys_module *lyp_search_file(struct ly_ctx *ctx, struct lys_module *module, const char *name,
                                    const char *revision, int implement, struct unres_schema *unres);
 
+/**
+ * @brief Free the index of the files in the search directories of a context, it is built again when needed.
+ *
+ * @param[in] ctx Context with the index.
+ */
+void lyp_search_index_clean(struct ly_ctx *ctx);
+
 struct lys_type *lyp_get_next_union_type(struct lys_type *type, struct lys_type *prev_type, int *found);
 
 /* return: 0 - ret set, ok; 1 - ret not set, no log, unknown meta; -1 - ret not set, log, fatal error */
@@ -96,6 +210,20 @@ int lyp_check_length_range(const char *expr, struct lys_type *type);
 
 int lyp_check_pattern(const char *pattern, pcre **pcre_precomp);
 
+int lyp_precompile_pattern(const char *pattern, pcre **pcre_precomp, pcre_extra **pcre_extra_data);
+
+/**
+ * @brief Precompiled pattern cached in lys_restr#pattern_compiled of a pattern restriction.
+ */
+struct lyp_pattern {
+    pcre *precomp;
+    pcre_extra *study;
+};
+
+int lyp_precompile_type_patterns(struct lys_type *type);
+
+void lyp_free_type_patterns(struct lys_type *type);
+
 int fill_yin_type(struct lys_module *module, struct lys_node *parent, struct lyxml_elem *yin, struct lys_type *type,
                   int tpdftype, struct unres_schema *unres);
 
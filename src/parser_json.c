@@ -529,6 +529,11 @@ repeat:
         return 0;
     }
 
+    if (leaf->parent) {
+        /* the value is known now */
+        lyd_insert_hash((struct lyd_node *)leaf);
+    }
+
     if (leaf->schema->nodetype == LYS_LEAFLIST) {
         /* repeat until end-array */
         len += skip_ws(&data[len]);
@@ -709,13 +714,6 @@ error:
     return 0;
 }
 
-struct attr_cont {
-    struct attr_cont *next;
-    struct lyd_attr *attr;
-    struct lys_node *schema;
-    unsigned int index;    /** non-zero only in case of leaf-list */
-};
-
 static int
 store_attrs(struct ly_ctx *ctx, struct attr_cont *attrs, struct lyd_node *first, int options)
 {
@@ -1060,6 +1058,10 @@ attr_repeat:
             first_sibling = result;
         }
     }
+    if (*parent) {
+        /* nodes with a value (leaf-list) or keys (list) are indexed only when complete */
+        lyd_insert_hash(result);
+    }
     result->validity = ly_new_node_validity(result->schema);
     if (resolve_applies_when(schema, 0, NULL)) {
         result->when_status = LYD_WHEN;
@@ -1227,6 +1229,9 @@ attr_repeat:
                 first_sibling->prev = new;
 
                 new->schema = list->schema;
+                if (new->parent) {
+                    lyd_insert_hash(new);
+                }
                 list = new;
             }
         } while (data[len] == ',');
@@ -1289,201 +1294,142 @@ error:
     return len;
 }
 
-struct lyd_node *
-lyd_parse_json(struct ly_ctx *ctx, const char *data, int options, const struct lyd_node *rpc_act,
-               const struct lyd_node *data_tree)
+unsigned int
+lyd_parse_json_members(struct lyd_parse_state *state, const char *data)
 {
-    struct lyd_node *result = NULL, *next, *iter, *reply_parent = NULL, *reply_top = NULL, *act_notif = NULL;
-    struct unres_data *unres = NULL;
+    struct lyd_node *iter;
     unsigned int len = 0, r;
-    int i, act_cont = 0;
-    struct attr_cont *attrs = NULL;
-    struct ly_set *set;
-
-    ly_err_clean(1);
-
-    if (!ctx || !data) {
-        LOGERR(LY_EINVAL, "%s: Invalid parameter.", __func__);
-        return NULL;
-    }
-
-    /* skip leading whitespaces */
-    len += skip_ws(&data[len]);
-
-    /* no data (or whitespaces only) are fine */
-    if (!data[len]) {
-        lyd_validate(&result, options, ctx);
-        return result;
-    }
 
-    /* expect top-level { */
-    if (data[len] != '{') {
-        LOGVAL(LYE_XML_INVAL, LY_VLOG_NONE, NULL, "JSON data (missing top level begin-object)");
-        return NULL;
-    }
-
-    unres = calloc(1, sizeof *unres);
-    if (!unres) {
-        LOGMEM;
-        return NULL;
-    }
-
-    /* create RPC/action reply part that is not in the parsed data */
-    if (rpc_act) {
-        assert(options & LYD_OPT_RPCREPLY);
-        if (rpc_act->schema->nodetype == LYS_RPC) {
-            /* RPC request */
-            reply_top = reply_parent = _lyd_new(NULL, rpc_act->schema, 0);
-        } else {
-            /* action request */
-            reply_top = lyd_dup(rpc_act, 1);
-            LY_TREE_DFS_BEGIN(reply_top, iter, reply_parent) {
-                if (reply_parent->schema->nodetype == LYS_ACTION) {
-                    break;
-                }
-                LY_TREE_DFS_END(reply_top, iter, reply_parent);
-            }
-            if (!reply_parent) {
-                LOGERR(LY_EINVAL, "%s: invalid variable parameter (const struct lyd_node *rpc_act).", __func__);
-                lyd_free_withsiblings(reply_top);
-                goto error;
-            }
-            lyd_free_withsiblings(reply_parent->child);
-        }
-    }
-
-    iter = NULL;
-    next = reply_parent;
     do {
         len++;
         len += skip_ws(&data[len]);
 
-        if (!act_cont) {
+        if (!state->act_cont) {
             if (!strncmp(&data[len], "\"yang:action\"", 13)) {
                 len += 13;
                 len += skip_ws(&data[len]);
                 if (data[len] != ':') {
                     LOGVAL(LYE_XML_INVAL, LY_VLOG_NONE, NULL, "JSON data (missing top-level begin-object)");
-                    lyd_free_withsiblings(reply_top);
-                    goto error;
+                    return 0;
                 }
                 ++len;
                 len += skip_ws(&data[len]);
                 if (data[len] != '{') {
                     LOGVAL(LYE_XML_INVAL, LY_VLOG_NONE, NULL, "JSON data (missing top level yang:action object)");
-                    lyd_free_withsiblings(reply_top);
-                    goto error;
+                    return 0;
                 }
                 ++len;
                 len += skip_ws(&data[len]);
 
-                act_cont = 1;
+                state->act_cont = 1;
             } else {
-                act_cont = -1;
+                state->act_cont = -1;
             }
         }
 
-        r = json_parse_data(ctx, &data[len], NULL, &next, result, iter, &attrs, options, unres, &act_notif);
+        r = json_parse_data(state->ctx, &data[len], NULL, &state->next, state->result, state->last, &state->attrs,
+                            state->options, state->unres, &state->act_notif);
         if (!r) {
-            lyd_free_withsiblings(reply_top);
-            goto error;
+            return 0;
         }
         len += r;
 
-        if (!result) {
-            for (iter = next; iter && iter->prev->next; iter = iter->prev);
-            result = iter;
+        if (!state->result) {
+            for (iter = state->next; iter && iter->prev->next; iter = iter->prev);
+            state->result = iter;
         }
-        if (next) {
-            iter = next;
+        if (state->next) {
+            state->last = state->next;
         }
-        next = NULL;
+        state->next = NULL;
     } while (data[len] == ',');
 
-    if (data[len] != '}') {
-        /* expecting end-object */
-        LOGVAL(LYE_XML_INVAL, LY_VLOG_NONE, NULL, "JSON data (missing top-level end-object)");
-        goto error;
-    }
-    len++;
-    len += skip_ws(&data[len]);
-
-    if (act_cont == 1) {
+    if (state->act_cont == 1) {
+        /* end of the yang:action object, only the top-level end-object can follow */
         if (data[len] != '}') {
             LOGVAL(LYE_XML_INVAL, LY_VLOG_NONE, NULL, "JSON data (missing top-level end-object)");
-            goto error;
+            return 0;
         }
         len++;
         len += skip_ws(&data[len]);
+        state->done = 1;
     }
 
+    return len;
+}
+
+struct lyd_node *
+lyd_parse_json_finish(struct lyd_parse_state *state)
+{
     /* store attributes */
-    if (store_attrs(ctx, attrs, result, options)) {
+    if (store_attrs(state->ctx, state->attrs, state->result, state->options)) {
+        /* the attributes were freed */
+        state->attrs = NULL;
         goto error;
     }
+    state->attrs = NULL;
 
-    if (reply_top) {
-        result = reply_top;
-    }
-
-    if (!result) {
+    if (!state->result && !state->reply_top) {
         LOGERR(LY_EVALID, "Model for the data to be linked with not found.");
         goto error;
     }
 
-    if ((options & LYD_OPT_RPCREPLY) && (rpc_act->schema->nodetype != LYS_RPC)) {
-        /* action reply */
-        act_notif = reply_parent;
-    } else if ((options & (LYD_OPT_RPC | LYD_OPT_NOTIF)) && !act_notif) {
-        ly_vecode = LYVE_INELEM;
-        LOGVAL(LYE_SPEC, LY_VLOG_LYD, result, "Missing %s node.", (options & LYD_OPT_RPC ? "action" : "notification"));
-        goto error;
+    return lyp_data_parse_finish(state);
+
+error:
+    lyp_data_parse_clean(state);
+    return NULL;
+}
+
+struct lyd_node *
+lyd_parse_json(struct ly_ctx *ctx, const char *data, int options, const struct lyd_node *rpc_act,
+               const struct lyd_node *data_tree)
+{
+    struct lyd_node *result = NULL;
+    struct lyd_parse_state state;
+    unsigned int len = 0, r;
+
+    ly_err_clean(1);
+
+    if (!ctx || !data) {
+        LOGERR(LY_EINVAL, "%s: Invalid parameter.", __func__);
+        return NULL;
     }
 
-    /* check for uniquness of top-level lists/leaflists because
-     * only the inner instances were tested in lyv_data_content() */
-    set = ly_set_new();
-    LY_TREE_FOR(result, iter) {
-        if (!(iter->schema->nodetype & (LYS_LIST | LYS_LEAFLIST)) || !(iter->validity & LYD_VAL_UNIQUE)) {
-            continue;
-        }
+    /* skip leading whitespaces */
+    len += skip_ws(&data[len]);
 
-        /* check each list/leaflist only once */
-        i = set->number;
-        if (ly_set_add(set, iter->schema, 0) != i) {
-            /* already checked */
-            continue;
-        }
+    /* no data (or whitespaces only) are fine */
+    if (!data[len]) {
+        lyd_validate(&result, options, ctx);
+        return result;
+    }
 
-        if (lyv_data_unique(iter, result)) {
-            ly_set_free(set);
-            goto error;
-        }
+    /* expect top-level { */
+    if (data[len] != '{') {
+        LOGVAL(LYE_XML_INVAL, LY_VLOG_NONE, NULL, "JSON data (missing top level begin-object)");
+        return NULL;
     }
-    ly_set_free(set);
 
-    /* add/validate default values, unres */
-    if (lyd_defaults_add_unres(&result, options, ctx, data_tree, act_notif, unres)) {
-        goto error;
+    if (lyp_data_parse_init(&state, ctx, options, rpc_act, data_tree)) {
+        return NULL;
     }
 
-    /* check for missing top level mandatory nodes */
-    if (!(options & (LYD_OPT_TRUSTED | LYD_OPT_NOTIF_FILTER))
-            && lyd_check_mandatory_tree((act_notif ? act_notif : result), ctx, options)) {
+    r = lyd_parse_json_members(&state, &data[len]);
+    if (!r) {
         goto error;
     }
+    len += r;
 
-    free(unres->node);
-    free(unres->type);
-    free(unres);
+    if (data[len] != '}') {
+        /* expecting end-object */
+        LOGVAL(LYE_XML_INVAL, LY_VLOG_NONE, NULL, "JSON data (missing top-level end-object)");
+        goto error;
+    }
 
-    return result;
+    return lyd_parse_json_finish(&state);
 
 error:
-    lyd_free_withsiblings(result);
-    free(unres->node);
-    free(unres->type);
-    free(unres);
-
+    lyp_data_parse_clean(&state);
     return NULL;
 }
@@ -0,0 +1,806 @@
+/**
+ * @file parser_lyb.c
+ * @brief LYB data parser for libyang
+ *
+ * Copyright (c) 2017 CESNET, z.s.p.o.
+ *
+ * This source code is licensed under BSD 3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/BSD-3-Clause
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "libyang.h"
+#include "common.h"
+#include "context.h"
+#include "parser.h"
+#include "resolve.h"
+#include "tree_internal.h"
+#include "validation.h"
+#include "xml_internal.h"
+
+/**
+ * @brief Data siblings of a schema parent from a module in the order of their indexes in LYB data.
+ */
+struct lyb_sibs {
+    struct lyb_sibs *next;
+    const struct lys_node *parent;
+    const struct lys_module *module;
+    const struct lys_node **nodes;
+    uint32_t count;
+};
+
+/**
+ * @brief State of the parsed LYB data.
+ */
+struct lyb_parse {
+    const char *data;
+    size_t len;                      /**< length of all the data */
+    size_t pos;                      /**< offset of the data not parsed yet */
+    struct lyd_parse_state *state;
+    const struct lys_module **mods;  /**< module table, NULL for the modules not available in the context */
+    uint32_t mod_count;
+    struct hash_table *sibs_ht;      /**< data siblings (struct lyb_sibs *) */
+    struct lyb_sibs *sibs;
+};
+
+static int
+lyb_read_invalid(void)
+{
+    LOGVAL(LYE_XML_INVAL, LY_VLOG_NONE, NULL, "LYB data (unexpected end)");
+    return EXIT_FAILURE;
+}
+
+static int
+lyb_read_num(struct lyb_parse *lp, uint64_t *num)
+{
+    int shift = 0;
+    uint8_t byte;
+
+    *num = 0;
+    do {
+        if ((lp->pos == lp->len) || (shift > 63)) {
+            return lyb_read_invalid();
+        }
+        byte = lp->data[lp->pos++];
+        *num |= (uint64_t)(byte & 0x7f) << shift;
+        shift += 7;
+    } while (byte & 0x80);
+
+    return EXIT_SUCCESS;
+}
+
+/* little endian value of the given size */
+static int
+lyb_read_fixed(struct lyb_parse *lp, uint64_t *num, int size)
+{
+    int i;
+
+    if (lp->len - lp->pos < (unsigned)size) {
+        return lyb_read_invalid();
+    }
+    *num = 0;
+    for (i = 0; i < size; ++i) {
+        *num |= (uint64_t)(uint8_t)lp->data[lp->pos++] << (8 * i);
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/* the string is not terminated, NULL if there is none */
+static int
+lyb_read_str(struct lyb_parse *lp, const char **str, size_t *len)
+{
+    uint64_t num;
+
+    if (lyb_read_num(lp, &num)) {
+        return EXIT_FAILURE;
+    }
+    if (!num) {
+        *str = NULL;
+        *len = 0;
+        return EXIT_SUCCESS;
+    }
+    if (num - 1 > lp->len - lp->pos) {
+        return lyb_read_invalid();
+    }
+
+    *str = &lp->data[lp->pos];
+    *len = num - 1;
+    lp->pos += *len;
+    return EXIT_SUCCESS;
+}
+
+/* the same as lyb_read_str(), but the string is duplicated */
+static int
+lyb_read_strdup(struct lyb_parse *lp, char **str)
+{
+    const char *ptr;
+    size_t len;
+
+    if (lyb_read_str(lp, &ptr, &len)) {
+        return EXIT_FAILURE;
+    }
+    if (!ptr) {
+        *str = NULL;
+        return EXIT_SUCCESS;
+    }
+
+    *str = strndup(ptr, len);
+    if (!*str) {
+        LOGMEM;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+static int
+lyb_sibs_equal(void *val_searched, void *val_stored, void *UNUSED(cb_data))
+{
+    struct lyb_sibs *searched = val_searched, *stored = val_stored;
+
+    return (searched->parent == stored->parent) && (searched->module == stored->module);
+}
+
+static uint32_t
+lyb_sibs_hash(const struct lys_node *parent, const struct lys_module *module)
+{
+    uint32_t hash;
+
+    hash = dict_hash_multi(0, (const char *)&parent, sizeof parent);
+    hash = dict_hash_multi(hash, (const char *)&module, sizeof module);
+    return dict_hash_multi(hash, NULL, 0);
+}
+
+/**
+ * @brief Find a schema node by its index among the data siblings from its module.
+ *
+ * @param[in] lp LYB parser state.
+ * @param[in] parent Schema node of the data parent, NULL for top-level nodes.
+ * @param[in] module Module of the node.
+ * @param[in] pos Index of the node.
+ * @param[out] node Found node, NULL if there is no such node.
+ * @return EXIT_SUCCESS on success, EXIT_FAILURE on error.
+ */
+static int
+lyb_schema_find(struct lyb_parse *lp, const struct lys_node *parent, const struct lys_module *module, uint64_t pos,
+                const struct lys_node **node)
+{
+    struct lyb_sibs key, *sibs;
+    const struct lys_node *iter;
+    uint32_t hash, count;
+
+    key.parent = parent;
+    key.module = module;
+    hash = lyb_sibs_hash(parent, module);
+    if (lyht_find(lp->sibs_ht, &key, hash, (void **)&sibs)) {
+        /* the first node of these siblings */
+        sibs = calloc(1, sizeof *sibs);
+        if (!sibs) {
+            LOGMEM;
+            return EXIT_FAILURE;
+        }
+        sibs->next = lp->sibs;
+        lp->sibs = sibs;
+        sibs->parent = parent;
+        sibs->module = module;
+
+        count = 0;
+        for (iter = NULL; (iter = lys_getnext(iter, parent, module, 0)); ) {
+            if (lys_node_module(iter) == module) {
+                ++count;
+            }
+        }
+        sibs->nodes = malloc(count * sizeof *sibs->nodes);
+        if (count && !sibs->nodes) {
+            LOGMEM;
+            return EXIT_FAILURE;
+        }
+        for (iter = NULL; (sibs->count < count) && (iter = lys_getnext(iter, parent, module, 0)); ) {
+            if (lys_node_module(iter) == module) {
+                sibs->nodes[sibs->count++] = iter;
+            }
+        }
+
+        if (lyht_insert(lp->sibs_ht, sibs, hash)) {
+            return EXIT_FAILURE;
+        }
+    }
+
+    *node = (pos < sibs->count) ? sibs->nodes[pos] : NULL;
+    return EXIT_SUCCESS;
+}
+
+static int
+lyb_parse_attrs(struct lyb_parse *lp, struct lyd_node *node)
+{
+    struct ly_ctx *ctx = lp->state->ctx;
+    struct lyd_attr *dattr, *last = NULL;
+    char *module_name = NULL, *name = NULL, *value = NULL;
+    uint64_t count;
+    int r, ret = EXIT_FAILURE;
+
+    if (lyb_read_num(lp, &count)) {
+        return EXIT_FAILURE;
+    }
+
+    for (; count; --count) {
+        if (lyb_read_strdup(lp, &module_name) || lyb_read_strdup(lp, &name) || lyb_read_strdup(lp, &value)) {
+            goto cleanup;
+        }
+        if (!module_name || !name) {
+            LOGVAL(LYE_XML_INVAL, LY_VLOG_LYD, node, "LYB data (attribute without a name)");
+            goto cleanup;
+        }
+
+        r = lyp_fill_attr(ctx, node, NULL, module_name, name, value, NULL, &dattr);
+        if (r == -1) {
+            goto cleanup;
+        } else if (r == 1) {
+            if (lp->state->options & LYD_OPT_STRICT) {
+                LOGVAL(LYE_INMETA, LY_VLOG_LYD, node, module_name, name, value);
+                goto cleanup;
+            }
+            LOGWRN("Unknown \"%s:%s\" metadata with value \"%s\", ignoring.", module_name, name, value);
+        } else {
+            if (last) {
+                last->next = dattr;
+            } else {
+                node->attr = dattr;
+            }
+            last = dattr;
+        }
+
+        free(module_name);
+        free(name);
+        free(value);
+        module_name = name = value = NULL;
+    }
+    ret = EXIT_SUCCESS;
+
+cleanup:
+    free(module_name);
+    free(name);
+    free(value);
+    return ret;
+}
+
+/**
+ * @brief Read the value of a leaf stored in its ::lyd_val form, it is not checked against the type restrictions
+ * again.
+ */
+static int
+lyb_parse_value(struct lyb_parse *lp, struct lyd_node_leaf_list *leaf)
+{
+    struct lys_type *type = &((struct lys_node_leaf *)leaf->schema)->type;
+    uint64_t num;
+    int i, j;
+
+    switch (type->base) {
+    case LY_TYPE_BINARY:
+        leaf->value.binary = leaf->value_str;
+        break;
+    case LY_TYPE_STRING:
+        leaf->value.string = leaf->value_str;
+        break;
+    case LY_TYPE_EMPTY:
+        break;
+    case LY_TYPE_BOOL:
+        if (lyb_read_fixed(lp, &num, 1)) {
+            return EXIT_FAILURE;
+        }
+        leaf->value.bln = num ? 1 : 0;
+        break;
+    case LY_TYPE_INT8:
+    case LY_TYPE_UINT8:
+        if (lyb_read_fixed(lp, &num, 1)) {
+            return EXIT_FAILURE;
+        }
+        leaf->value.uint8 = num;
+        break;
+    case LY_TYPE_INT16:
+    case LY_TYPE_UINT16:
+        if (lyb_read_fixed(lp, &num, 2)) {
+            return EXIT_FAILURE;
+        }
+        leaf->value.uint16 = num;
+        break;
+    case LY_TYPE_INT32:
+    case LY_TYPE_UINT32:
+        if (lyb_read_fixed(lp, &num, 4)) {
+            return EXIT_FAILURE;
+        }
+        leaf->value.uint32 = num;
+        break;
+    case LY_TYPE_INT64:
+    case LY_TYPE_UINT64:
+    case LY_TYPE_DEC64:
+        if (lyb_read_fixed(lp, &num, 8)) {
+            return EXIT_FAILURE;
+        }
+        leaf->value.uint64 = num;
+        break;
+    case LY_TYPE_ENUM:
+        for (; !type->info.enums.count; type = &type->der->type);
+        if (lyb_read_num(lp, &num)) {
+            return EXIT_FAILURE;
+        }
+        if (num >= (unsigned)type->info.enums.count) {
+            LOGVAL(LYE_XML_INVAL, LY_VLOG_LYD, leaf, "LYB data (enum out of range)");
+            return EXIT_FAILURE;
+        }
+        leaf->value.enm = &type->info.enums.enm[num];
+        break;
+    case LY_TYPE_BITS:
+        for (; !type->info.bits.count; type = &type->der->type);
+        leaf->value.bit = calloc(type->info.bits.count, sizeof *leaf->value.bit);
+        if (!leaf->value.bit) {
+            LOGMEM;
+            return EXIT_FAILURE;
+        }
+        leaf->value_type = LY_TYPE_BITS;
+        for (i = 0; i < type->info.bits.count; i += 8) {
+            if (lyb_read_fixed(lp, &num, 1)) {
+                return EXIT_FAILURE;
+            }
+            for (j = 0; (j < 8) && (i + j < type->info.bits.count); ++j) {
+                if (num & (1 << j)) {
+                    leaf->value.bit[i + j] = &type->info.bits.bit[i + j];
+                }
+            }
+        }
+        break;
+    default:
+        LOGVAL(LYE_XML_INVAL, LY_VLOG_LYD, leaf, "LYB data (value of an unexpected type)");
+        return EXIT_FAILURE;
+    }
+    leaf->value_type = type->base;
+
+    return EXIT_SUCCESS;
+}
+
+static int
+lyb_parse_anydata(struct lyb_parse *lp, struct lyd_node_anydata *any)
+{
+    struct ly_ctx *ctx = lp->state->ctx;
+    const char *str;
+    char *xml;
+    size_t len;
+    uint64_t value_type;
+
+    if (lyb_read_num(lp, &value_type) || lyb_read_str(lp, &str, &len)) {
+        return EXIT_FAILURE;
+    }
+
+    switch (value_type) {
+    case LYD_ANYDATA_CONSTSTRING:
+    case LYD_ANYDATA_SXML:
+    case LYD_ANYDATA_JSON:
+        any->value_type = value_type;
+        any->value.str = str ? lydict_insert(ctx, len ? str : "", len) : NULL;
+        break;
+    case LYD_ANYDATA_XML:
+        if (!str || !len) {
+            any->value_type = LYD_ANYDATA_CONSTSTRING;
+            any->value.str = NULL;
+            break;
+        }
+        xml = strndup(str, len);
+        if (!xml) {
+            LOGMEM;
+            return EXIT_FAILURE;
+        }
+        any->value_type = LYD_ANYDATA_XML;
+        any->value.xml = lyxml_parse_mem(ctx, xml, LYXML_PARSE_MULTIROOT);
+        free(xml);
+        if (!any->value.xml) {
+            return EXIT_FAILURE;
+        }
+        break;
+    default:
+        LOGVAL(LYE_XML_INVAL, LY_VLOG_LYD, any, "LYB data (unknown anydata value type)");
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Parse a data node with all its descendants and connect it as the last child of \p parent.
+ *
+ * @param[in] lp LYB parser state.
+ * @param[in] parent Parent of the node, the RPC/action of a reply for top-level nodes.
+ * @param[in] toplevel Whether the node is top-level.
+ * @return EXIT_SUCCESS on success (also if the node was skipped), EXIT_FAILURE on error.
+ */
+static int
+lyb_parse_node(struct lyb_parse *lp, struct lyd_node *parent, int toplevel)
+{
+    struct lyd_parse_state *state = lp->state;
+    struct ly_ctx *ctx = state->ctx;
+    struct unres_data *unres = state->unres;
+    int options = state->options;
+    struct lyd_node *node, *diter, **first;
+    struct lyd_node_leaf_list *leaf;
+    const struct lys_node *schema = NULL;
+    const char *str;
+    size_t end, len;
+    uint64_t num, flags;
+    int i, havechildren, editbits = 0, ret = EXIT_FAILURE;
+
+    /* the node header */
+    if (lyb_read_fixed(lp, &num, 4)) {
+        return EXIT_FAILURE;
+    }
+    if (num > lp->len - lp->pos) {
+        return lyb_read_invalid();
+    }
+    end = lp->pos + num;
+
+    if (lyb_read_num(lp, &num)) {
+        return EXIT_FAILURE;
+    }
+    if (num >= lp->mod_count) {
+        LOGVAL(LYE_XML_INVAL, (parent ? LY_VLOG_LYD : LY_VLOG_NONE), parent, "LYB data (unknown module index)");
+        return EXIT_FAILURE;
+    }
+    if (lyb_read_num(lp, &flags)) {
+        return EXIT_FAILURE;
+    }
+    if (lp->mods[num] && lyb_schema_find(lp, parent ? parent->schema : NULL, lp->mods[num], flags, &schema)) {
+        return EXIT_FAILURE;
+    }
+    if (toplevel) {
+        /* check the name of the node in case the data are not what is expected (such as an RPC reply) */
+        if (lyb_read_str(lp, &str, &len)) {
+            return EXIT_FAILURE;
+        }
+        if (schema && (!str || strncmp(schema->name, str, len) || schema->name[len])) {
+            schema = NULL;
+        }
+    }
+    if (!schema) {
+        if (options & LYD_OPT_STRICT) {
+            LOGVAL(LYE_XML_INVAL, (parent ? LY_VLOG_LYD : LY_VLOG_NONE), parent, "LYB data (unknown node)");
+            return EXIT_FAILURE;
+        }
+        /* skip the whole subtree */
+        lp->pos = end;
+        return EXIT_SUCCESS;
+    }
+
+    /* create the node structure */
+    switch (schema->nodetype) {
+    case LYS_CONTAINER:
+    case LYS_LIST:
+    case LYS_NOTIF:
+    case LYS_RPC:
+    case LYS_ACTION:
+        node = calloc(1, sizeof *node);
+        havechildren = 1;
+        break;
+    case LYS_LEAF:
+    case LYS_LEAFLIST:
+        node = calloc(1, sizeof(struct lyd_node_leaf_list));
+        havechildren = 0;
+        break;
+    case LYS_ANYXML:
+    case LYS_ANYDATA:
+        node = calloc(1, sizeof(struct lyd_node_anydata));
+        havechildren = 0;
+        break;
+    default:
+        LOGINT;
+        return EXIT_FAILURE;
+    }
+    if (!node) {
+        LOGMEM;
+        return EXIT_FAILURE;
+    }
+
+    /* the nodes are stored in the correct order (including list keys), so it is always inserted as the last one */
+    node->schema = (struct lys_node *)schema;
+    node->parent = parent;
+    first = parent ? &parent->child : &state->result;
+    if (*first) {
+        node->prev = (*first)->prev;
+        (*first)->prev->next = node;
+        (*first)->prev = node;
+    } else {
+        node->prev = node;
+        *first = node;
+    }
+    if (parent) {
+        /* nodes with a value (leaf-list) or keys (list) are indexed only when complete */
+        lyd_insert_hash(node);
+    }
+    node->validity = ly_new_node_validity(schema);
+    if (resolve_applies_when(schema, 0, NULL)) {
+        node->when_status = LYD_WHEN;
+    }
+
+    if (lyb_read_fixed(lp, &flags, 1)) {
+        goto error;
+    }
+    if (flags & LYB_NODE_DFLT) {
+        node->dflt = 1;
+    }
+
+    if (lyb_parse_attrs(lp, node)) {
+        goto error;
+    }
+    if ((options & LYD_OPT_EDIT) && lyp_check_edit_attr(ctx, node->attr, node, &editbits)) {
+        goto error;
+    }
+
+    /* type specific processing */
+    if (schema->nodetype & (LYS_LEAF | LYS_LEAFLIST)) {
+        leaf = (struct lyd_node_leaf_list *)node;
+        if (lyb_read_str(lp, &str, &len)) {
+            goto error;
+        }
+        leaf->value_str = str ? lydict_insert(ctx, len ? str : "", len) : NULL;
+
+        if (flags & LYB_NODE_NOVAL) {
+            leaf->value_type = LY_TYPE_ERR;
+        } else if (flags & LYB_NODE_STRVAL) {
+            if (!lyp_parse_value(&((struct lys_node_leaf *)schema)->type, &leaf->value_str, NULL, leaf, NULL, 1, 0)) {
+                goto error;
+            }
+        } else if (lyb_parse_value(lp, leaf)) {
+            goto error;
+        }
+    } else if (schema->nodetype & LYS_ANYDATA) {
+        if (lyb_parse_anydata(lp, (struct lyd_node_anydata *)node)) {
+            goto error;
+        }
+    } else if (schema->nodetype & (LYS_RPC | LYS_ACTION)) {
+        if (!(options & LYD_OPT_RPC) || state->act_notif) {
+            LOGVAL(LYE_INELEM, LY_VLOG_LYD, node, schema->name);
+            LOGVAL(LYE_SPEC, LY_VLOG_PREV, NULL, "Unexpected %s node \"%s\".",
+                   (schema->nodetype == LYS_RPC ? "rpc" : "action"), schema->name);
+            goto error;
+        }
+        state->act_notif = node;
+    } else if (schema->nodetype == LYS_NOTIF) {
+        if (!(options & LYD_OPT_NOTIF) || state->act_notif) {
+            LOGVAL(LYE_INELEM, LY_VLOG_LYD, node, schema->name);
+            LOGVAL(LYE_SPEC, LY_VLOG_PREV, NULL, "Unexpected notification node \"%s\".", schema->name);
+            goto error;
+        }
+        state->act_notif = node;
+    }
+
+    /* first part of validation checks */
+    if (lyv_data_context(node, options, unres)) {
+        goto error;
+    }
+
+    /* process children */
+    if (havechildren) {
+        while (lp->pos < end) {
+            if (lyb_parse_node(lp, node, 0)) {
+                goto error;
+            }
+        }
+    }
+    if (lp->pos != end) {
+        LOGVAL(LYE_XML_INVAL, LY_VLOG_LYD, node, "LYB data (subtree size mismatch)");
+        goto error;
+    }
+
+    /* if we have empty non-presence container, we keep it, but mark it as default */
+    if ((schema->nodetype == LYS_CONTAINER) && !node->child && !node->attr
+            && !((struct lys_node_container *)schema)->presence) {
+        node->dflt = 1;
+    }
+
+    /* rest of validation checks */
+    ly_err_clean(1);
+    if (lyv_data_content(node, options, unres) || lyv_multicases(node, NULL, (node->prev != node) ? first : NULL, 0, NULL)) {
+        if (ly_errno) {
+            goto error;
+        } else {
+            ret = EXIT_SUCCESS;
+            goto clear;
+        }
+    }
+
+    /* validation successful */
+    if (schema->nodetype & (LYS_LIST | LYS_LEAFLIST)) {
+        /* postpone checking when there will be all list/leaflist instances */
+        node->validity |= LYD_VAL_UNIQUE;
+    }
+
+    if (parent) {
+        /* the node is complete now */
+        lyd_insert_hash(node);
+    }
+
+    return EXIT_SUCCESS;
+
+error:
+    ret = EXIT_FAILURE;
+
+clear:
+    /* cleanup */
+    for (i = unres->count - 1; i >= 0; i--) {
+        /* remove unres items connected with the subtree being removed */
+        for (diter = unres->node[i]; diter && (diter != node); diter = diter->parent);
+        if (diter) {
+            unres_data_del(unres, i);
+        }
+    }
+    if (state->act_notif) {
+        for (diter = state->act_notif; diter && (diter != node); diter = diter->parent);
+        if (diter) {
+            state->act_notif = NULL;
+        }
+    }
+    if (!parent && (state->result == node)) {
+        state->result = node->next;
+    }
+    lyd_free(node);
+    lp->pos = end;
+
+    return ret;
+}
+
+static void
+lyb_parse_clean(struct lyb_parse *lp)
+{
+    struct lyb_sibs *sibs;
+
+    while ((sibs = lp->sibs)) {
+        lp->sibs = sibs->next;
+        free(sibs->nodes);
+        free(sibs);
+    }
+    lyht_free(lp->sibs_ht);
+    free(lp->mods);
+}
+
+/**
+ * @brief Parse the LYB header and the module table.
+ *
+ * @param[in] lp LYB parser state.
+ * @param[in] ctx Context of the parsed data.
+ * @param[in] len Length of the data, 0 if not known.
+ * @return EXIT_SUCCESS or EXIT_FAILURE.
+ */
+static int
+lyb_parse_header(struct lyb_parse *lp, struct ly_ctx *ctx, size_t len)
+{
+    char *name = NULL, *revision = NULL;
+    const struct lys_module *mod;
+    uint64_t num, i;
+
+    if (len && (len < LYB_HEADER_SIZE)) {
+        return lyb_read_invalid();
+    }
+    if (strncmp(lp->data, LYB_MAGIC, strlen(LYB_MAGIC)) || (lp->data[strlen(LYB_MAGIC)] != LYB_VERSION)) {
+        LOGVAL(LYE_XML_INVAL, LY_VLOG_NONE, NULL, "LYB data (unknown header)");
+        return EXIT_FAILURE;
+    }
+    lp->pos = LYB_HEADER_SIZE - 4;
+    lp->len = LYB_HEADER_SIZE;
+    if (lyb_read_fixed(lp, &num, 4)) {
+        return EXIT_FAILURE;
+    }
+    if ((num < LYB_HEADER_SIZE) || (len && (num > len))) {
+        /* the data are truncated */
+        return lyb_read_invalid();
+    }
+    lp->len = num;
+
+    if (lyb_read_num(lp, &num)) {
+        return EXIT_FAILURE;
+    }
+    if (num > lp->len - lp->pos) {
+        return lyb_read_invalid();
+    }
+    lp->mods = calloc(num, sizeof *lp->mods);
+    if (num && !lp->mods) {
+        LOGMEM;
+        return EXIT_FAILURE;
+    }
+    lp->mod_count = num;
+
+    for (i = 0; i < lp->mod_count; ++i) {
+        if (lyb_read_strdup(lp, &name) || lyb_read_strdup(lp, &revision)) {
+            free(name);
+            return EXIT_FAILURE;
+        }
+        if (!name) {
+            LOGVAL(LYE_XML_INVAL, LY_VLOG_NONE, NULL, "LYB data (module without a name)");
+            free(revision);
+            return EXIT_FAILURE;
+        }
+
+        /* the nodes of unknown modules are skipped (or refused in the strict mode) */
+        mod = ly_ctx_get_module(ctx, name, revision);
+        if (mod && mod->implemented && !mod->disabled) {
+            lp->mods[i] = mod;
+        }
+        free(name);
+        free(revision);
+        name = revision = NULL;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+struct lyd_node *
+lyd_parse_lyb(struct ly_ctx *ctx, const char *data, size_t len, int options, const struct lyd_node *rpc_act,
+              const struct lyd_node *data_tree)
+{
+    struct lyd_node *result = NULL;
+    struct lyd_parse_state state;
+    struct lyb_parse lp;
+
+    ly_err_clean(1);
+
+    if (!ctx || !data) {
+        LOGERR(LY_EINVAL, "%s: Invalid parameter.", __func__);
+        return NULL;
+    }
+
+    /* no data are fine */
+    if (!len && !data[0]) {
+        lyd_validate(&result, options, ctx);
+        return result;
+    }
+
+    memset(&lp, 0, sizeof lp);
+    lp.data = data;
+    if (lyb_parse_header(&lp, ctx, len)) {
+        lyb_parse_clean(&lp);
+        return NULL;
+    }
+
+    /* empty data tree */
+    if (lp.pos == lp.len) {
+        lyb_parse_clean(&lp);
+        lyd_validate(&result, options, ctx);
+        return result;
+    }
+
+    lp.sibs_ht = lyht_new(lyb_sibs_equal, NULL);
+    if (!lp.sibs_ht) {
+        lyb_parse_clean(&lp);
+        return NULL;
+    }
+    if (lyp_data_parse_init(&state, ctx, options, rpc_act, data_tree)) {
+        lyb_parse_clean(&lp);
+        return NULL;
+    }
+    lp.state = &state;
+
+    while (!state.done && (lp.pos < lp.len)) {
+        if (lyb_parse_node(&lp, state.reply_parent, 1)) {
+            goto error;
+        }
+        if (state.reply_parent) {
+            state.result = state.reply_parent->child;
+        }
+        state.last = state.result ? state.result->prev : NULL;
+
+        if (options & LYD_OPT_NOSIBLINGS) {
+            /* stop after the first processed root */
+            state.done = 1;
+        }
+    }
+
+    lyb_parse_clean(&lp);
+    return lyp_data_parse_finish(&state);
+
+error:
+    lyb_parse_clean(&lp);
+    lyp_data_parse_clean(&state);
+    return NULL;
+}
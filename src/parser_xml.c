@@ -73,6 +73,76 @@ xml_data_search_schemanode(struct lyxml_elem *xml, struct lys_node *start, int o
     return NULL;
 }
 
+/* does not log */
+static struct lys_node *
+xml_data_find_schema(struct ly_ctx *ctx, struct lyxml_elem *xml, struct lyd_node *parent, int options)
+{
+    const struct lys_module *mod = NULL;
+    struct lys_node *schema = NULL, *target;
+    struct lys_node_augment *aug;
+    int j;
+
+    if (!parent) {
+        mod = ly_ctx_get_module_by_ns(ctx, xml->ns->value, NULL);
+        if (ctx->data_clb) {
+            if (!mod) {
+                mod = ctx->data_clb(ctx, NULL, xml->ns->value, 0, ctx->data_clb_data);
+            } else if (!mod->implemented) {
+                mod = ctx->data_clb(ctx, mod->name, mod->ns, LY_MODCLB_NOT_IMPLEMENTED, ctx->data_clb_data);
+            }
+        }
+
+        /* get the proper schema node */
+        if (mod && mod->implemented && !mod->disabled) {
+            schema = xml_data_search_schemanode(xml, mod->data, options);
+            if (!schema) {
+                /* it still can be the specific case of this module containing an augment of another module
+                * top-level choice or top-level choice's case, bleh */
+                for (j = 0; j < mod->augment_size; ++j) {
+                    aug = &mod->augment[j];
+                    target = aug->target;
+                    if (target->nodetype & (LYS_CHOICE | LYS_CASE)) {
+                        /* 1) okay, the target is choice or case */
+                        while (target && (target->nodetype & (LYS_CHOICE | LYS_CASE | LYS_USES))) {
+                            target = lys_parent(target);
+                        }
+                        /* 2) now, the data node will be top-level, there are only non-data schema nodes */
+                        if (!target) {
+                            while ((schema = (struct lys_node *)lys_getnext(schema, (struct lys_node *)aug, NULL, 0))) {
+                                /* 3) alright, even the name matches, we found our schema node */
+                                if (ly_strequal(schema->name, xml->name, 1)) {
+                                    break;
+                                }
+                            }
+                        }
+                    }
+
+                    if (schema) {
+                        break;
+                    }
+                }
+            }
+        }
+    } else {
+        /* parsing some internal node, we start with parent's schema pointer */
+        schema = xml_data_search_schemanode(xml, parent->schema->child, options);
+
+        if (ctx->data_clb) {
+            if (schema && !lys_node_module(schema)->implemented) {
+                ctx->data_clb(ctx, lys_node_module(schema)->name, lys_node_module(schema)->ns,
+                              LY_MODCLB_NOT_IMPLEMENTED, ctx->data_clb_data);
+            } else if (!schema) {
+                if (ctx->data_clb(ctx, NULL, xml->ns->value, 0, ctx->data_clb_data)) {
+                    /* context was updated, so try to find the schema node again */
+                    schema = xml_data_search_schemanode(xml, parent->schema->child, options);
+                }
+            }
+        }
+    }
+
+    return schema;
+}
+
 /* logs directly */
 static int
 xml_get_value(struct lyd_node *node, struct lyxml_elem *xml, int editbits)
@@ -99,27 +169,124 @@ xml_get_value(struct lyd_node *node, struct lyxml_elem *xml, int editbits)
     return EXIT_SUCCESS;
 }
 
+static int xml_parse_data(struct ly_ctx *ctx, struct lyxml_elem *xml, struct lyd_node *parent,
+                          struct lyd_node *first_sibling, struct lyd_node *prev, int options, struct unres_data *unres,
+                          struct lyd_node **result, struct lyd_node **act_notif, const char **stream);
+
+/**
+ * @brief Parse the children of a data node directly from the XML content of its element.
+ *
+ * @param[in] ctx libyang context.
+ * @param[in] xml Element of \p parent, it does not hold any children, only the start tag was parsed.
+ * @param[in] parent Data node of \p xml.
+ * @param[in] options Parser options.
+ * @param[in] unres Unresolved data.
+ * @param[in,out] act_notif Parsed action or notification node.
+ * @param[in,out] stream XML data with the content of \p xml, moved after its end tag.
+ *
+ * @return 0 on success, 1 if the element has a mixed content and should be ignored, -1 on error.
+ */
+static int
+xml_parse_data_children(struct ly_ctx *ctx, struct lyxml_elem *xml, struct lyd_node *parent, int options,
+                        struct unres_data *unres, struct lyd_node **act_notif, const char **stream)
+{
+    struct lyxml_elem *child;
+    struct lyd_node *diter = NULL, *dlast = NULL;
+    unsigned int len;
+    int r, closed, text = 0, elems = 0, mixed = 0;
+
+    while ((r = lyxml_parse_elem_next(*stream, &len, xml)) > 0) {
+        *stream += len;
+        if (r == 2) {
+            text = 1;
+            if (elems) {
+                mixed = 1;
+            }
+            continue;
+        }
+
+        ++elems;
+        if (text) {
+            mixed = 1;
+        }
+        if (mixed) {
+            if (options & LYD_OPT_STRICT) {
+                LOGVAL(LYE_XML_INVAL, LY_VLOG_XML, xml, "XML element with mixed content");
+                return -1;
+            }
+
+            /* the whole element will be ignored, just skip the rest of its content */
+            child = lyxml_parse_elem(ctx, *stream, &len, xml, 0);
+            if (!child) {
+                return -1;
+            }
+            *stream += len;
+            lyxml_free(ctx, child);
+            continue;
+        }
+
+        child = lyxml_parse_elem_start(ctx, *stream, &len, xml, &closed);
+        if (!child) {
+            return -1;
+        }
+        *stream += len;
+
+        r = xml_parse_data(ctx, child, parent, parent->child, dlast, options, unres, &diter, act_notif,
+                           closed ? NULL : stream);
+        lyxml_free(ctx, child);
+        if (r) {
+            return -1;
+        }
+        if (diter && !diter->next) {
+            /* the child was parsed/created and it was placed as the last child. The child can be inserted
+             * out of order (not as the last one) in case it is a list's key present out of the correct order */
+            dlast = diter;
+        }
+    }
+    if (r) {
+        return -1;
+    }
+    *stream += len;
+
+    return mixed;
+}
+
 /* logs directly */
 static int
 xml_parse_data(struct ly_ctx *ctx, struct lyxml_elem *xml, struct lyd_node *parent, struct lyd_node *first_sibling,
                struct lyd_node *prev, int options, struct unres_data *unres, struct lyd_node **result,
-               struct lyd_node **act_notif)
+               struct lyd_node **act_notif, const char **stream)
 {
     const struct lys_module *mod = NULL;
     struct lyd_node *diter, *dlast;
-    struct lys_node *schema = NULL, *target;
-    struct lys_node_augment *aug;
+    struct lys_node *schema = NULL;
     struct lyd_attr *dattr, *dattr_iter;
     struct lyxml_attr *attr;
     struct lyxml_elem *child, *next;
-    int i, j, havechildren, r, editbits = 0, pos, filterflag = 0, found;
+    int i, havechildren, r, editbits = 0, pos, filterflag = 0, found, searched = 0;
     int ret = 0;
+    unsigned int len;
     const char *str = NULL;
 
     assert(xml);
     assert(result);
     *result = NULL;
 
+    if (stream) {
+        /* only the content of inner nodes is parsed directly into data nodes, the rest needs the XML tree */
+        if (xml->ns && xml->ns->value) {
+            schema = xml_data_find_schema(ctx, xml, parent, options);
+            searched = 1;
+        }
+        if (!schema || !(schema->nodetype & (LYS_CONTAINER | LYS_LIST | LYS_NOTIF | LYS_RPC | LYS_ACTION))) {
+            if (lyxml_parse_elem_content(ctx, *stream, &len, xml, 0)) {
+                return -1;
+            }
+            *stream += len;
+            stream = NULL;
+        }
+    }
+
     if (xml->flags & LYXML_ELEM_MIXED) {
         if (options & LYD_OPT_STRICT) {
             LOGVAL(LYE_XML_INVAL, LY_VLOG_XML, xml, "XML element with mixed content");
@@ -139,62 +306,8 @@ xml_parse_data(struct ly_ctx *ctx, struct lyxml_elem *xml, struct lyd_node *pare
     }
 
     /* find schema node */
-    if (!parent) {
-        mod = ly_ctx_get_module_by_ns(ctx, xml->ns->value, NULL);
-        if (ctx->data_clb) {
-            if (!mod) {
-                mod = ctx->data_clb(ctx, NULL, xml->ns->value, 0, ctx->data_clb_data);
-            } else if (!mod->implemented) {
-                mod = ctx->data_clb(ctx, mod->name, mod->ns, LY_MODCLB_NOT_IMPLEMENTED, ctx->data_clb_data);
-            }
-        }
-
-        /* get the proper schema node */
-        if (mod && mod->implemented && !mod->disabled) {
-            schema = xml_data_search_schemanode(xml, mod->data, options);
-            if (!schema) {
-                /* it still can be the specific case of this module containing an augment of another module
-                * top-level choice or top-level choice's case, bleh */
-                for (j = 0; j < mod->augment_size; ++j) {
-                    aug = &mod->augment[j];
-                    target = aug->target;
-                    if (target->nodetype & (LYS_CHOICE | LYS_CASE)) {
-                        /* 1) okay, the target is choice or case */
-                        while (target && (target->nodetype & (LYS_CHOICE | LYS_CASE | LYS_USES))) {
-                            target = lys_parent(target);
-                        }
-                        /* 2) now, the data node will be top-level, there are only non-data schema nodes */
-                        if (!target) {
-                            while ((schema = (struct lys_node *)lys_getnext(schema, (struct lys_node *)aug, NULL, 0))) {
-                                /* 3) alright, even the name matches, we found our schema node */
-                                if (ly_strequal(schema->name, xml->name, 1)) {
-                                    break;
-                                }
-                            }
-                        }
-                    }
-
-                    if (schema) {
-                        break;
-                    }
-                }
-            }
-        }
-    } else {
-        /* parsing some internal node, we start with parent's schema pointer */
-        schema = xml_data_search_schemanode(xml, parent->schema->child, options);
-
-        if (ctx->data_clb) {
-            if (schema && !lys_node_module(schema)->implemented) {
-                ctx->data_clb(ctx, lys_node_module(schema)->name, lys_node_module(schema)->ns,
-                              LY_MODCLB_NOT_IMPLEMENTED, ctx->data_clb_data);
-            } else if (!schema) {
-                if (ctx->data_clb(ctx, NULL, xml->ns->value, 0, ctx->data_clb_data)) {
-                    /* context was updated, so try to find the schema node again */
-                    schema = xml_data_search_schemanode(xml, parent->schema->child, options);
-                }
-            }
-        }
+    if (!searched) {
+        schema = xml_data_find_schema(ctx, xml, parent, options);
     }
 
     mod = lys_node_module(schema);
@@ -253,6 +366,7 @@ xml_parse_data(struct ly_ctx *ctx, struct lyxml_elem *xml, struct lyd_node *pare
                 LOGVAL(LYE_INORDER, LY_VLOG_LYD, *result, schema->name, diter->schema->name);
                 LOGVAL(LYE_SPEC, LY_VLOG_PREV, NULL, "Invalid position of the key \"%s\" in a list \"%s\".",
                        schema->name, parent->schema->name);
+                ly_err_format();
                 free(*result);
                 *result = NULL;
                 return -1;
@@ -288,6 +402,10 @@ xml_parse_data(struct ly_ctx *ctx, struct lyxml_elem *xml, struct lyd_node *pare
             first_sibling = *result;
         }
     }
+    if (parent) {
+        /* nodes with a value (leaf-list) or keys (list) are indexed only when complete */
+        lyd_insert_hash(*result);
+    }
     (*result)->validity = ly_new_node_validity((*result)->schema);
     if (resolve_applies_when(schema, 0, NULL)) {
         (*result)->when_status = LYD_WHEN;
@@ -477,10 +595,18 @@ attr_error:
     }
 
     /* process children */
-    if (havechildren && xml->child) {
+    if (havechildren && stream) {
+        r = xml_parse_data_children(ctx, xml, *result, options, unres, act_notif, stream);
+        if (r == -1) {
+            goto error;
+        } else if (r) {
+            /* mixed content */
+            goto clear;
+        }
+    } else if (havechildren && xml->child) {
         diter = dlast = NULL;
         LY_TREE_FOR_SAFE(xml->child, next, child) {
-            r = xml_parse_data(ctx, child, *result, (*result)->child, dlast, options, unres, &diter, act_notif);
+            r = xml_parse_data(ctx, child, *result, (*result)->child, dlast, options, unres, &diter, act_notif, NULL);
             if (r) {
                 goto error;
             } else if (options & LYD_OPT_DESTRUCT) {
@@ -517,6 +643,11 @@ attr_error:
         (*result)->validity |= LYD_VAL_UNIQUE;
     }
 
+    if (parent) {
+        /* the node is complete now */
+        lyd_insert_hash(*result);
+    }
+
     return ret;
 
 error:
@@ -525,27 +656,236 @@ error:
 clear:
     /* cleanup */
     for (i = unres->count - 1; i >= 0; i--) {
-        /* remove unres items connected with the node being removed */
-        if (unres->node[i] == *result) {
+        /* remove unres items connected with the subtree being removed */
+        for (diter = unres->node[i]; diter && (diter != *result); diter = diter->parent);
+        if (diter) {
             unres_data_del(unres, i);
         }
     }
+    if (*act_notif) {
+        for (diter = *act_notif; diter && (diter != *result); diter = diter->parent);
+        if (diter) {
+            *act_notif = NULL;
+        }
+    }
     lyd_free(*result);
     *result = NULL;
 
     return ret;
 }
 
+/**
+ * @brief Parse a top-level element of the data tree and connect it to the already parsed ones.
+ *
+ * @param[in] state State of the parsed data tree.
+ * @param[in] xml Element to parse (only its start tag in case of \p stream).
+ * @param[in,out] stream XML data to read the element's content from, NULL if the element is complete.
+ * @return EXIT_SUCCESS on success, EXIT_FAILURE on error.
+ */
+static int
+xml_parse_data_root(struct lyd_parse_state *state, struct lyxml_elem *xml, const char **stream)
+{
+    struct lyd_node *iter = NULL;
+
+    if (xml_parse_data(state->ctx, xml, state->reply_parent, state->result, state->last, state->options, state->unres,
+                       &iter, &state->act_notif, stream)) {
+        return EXIT_FAILURE;
+    }
+    if (iter) {
+        state->last = iter;
+    }
+    if (!state->result) {
+        state->result = iter;
+    }
+
+    if (state->options & LYD_OPT_NOSIBLINGS) {
+        /* stop after the first processed root */
+        state->done = 1;
+    }
+    return EXIT_SUCCESS;
+}
+
+int
+lyd_parse_xml_roots(struct lyd_parse_state *state, const char **data)
+{
+    int r, closed;
+    unsigned int len;
+    struct lyxml_elem *xmlelem;
+
+    /* no XML tree is built, only the start tags of the ancestors of the currently parsed element are kept */
+    while (!state->done) {
+        /* skip the XML declaration and anything else before the next element */
+        if (lyxml_parse_misc(*data, &len)) {
+            return EXIT_FAILURE;
+        }
+        (*data) += len;
+        if (!(*data)[0]) {
+            return EXIT_SUCCESS;
+        }
+
+        xmlelem = lyxml_parse_elem_start(state->ctx, *data, &len, NULL, &closed);
+        if (!xmlelem) {
+            return EXIT_FAILURE;
+        }
+        (*data) += len;
+
+        if (!state->result && (state->options & LYD_OPT_RPC) && !closed && xmlelem->ns
+                && !strcmp(xmlelem->name, "action") && !strcmp(xmlelem->ns->value, "urn:ietf:params:xml:ns:yang:1")) {
+            /* it's an action, not a simple RPC, parse its children */
+            state->xmlact = xmlelem;
+            state->done = 1;
+            while (1) {
+                r = lyxml_parse_elem_next(*data, &len, state->xmlact);
+                (*data) += len;
+                if (r == -1) {
+                    return EXIT_FAILURE;
+                } else if (r == 2) {
+                    continue;
+                } else if (!r) {
+                    /* end of the action element */
+                    break;
+                }
+
+                xmlelem = lyxml_parse_elem_start(state->ctx, *data, &len, state->xmlact, &closed);
+                if (!xmlelem) {
+                    return EXIT_FAILURE;
+                }
+                (*data) += len;
+
+                r = xml_parse_data_root(state, xmlelem, closed ? NULL : data);
+                lyxml_free(state->ctx, xmlelem);
+                if (r) {
+                    return EXIT_FAILURE;
+                } else if (state->options & LYD_OPT_NOSIBLINGS) {
+                    return EXIT_SUCCESS;
+                }
+            }
+            break;
+        }
+
+        r = xml_parse_data_root(state, xmlelem, closed ? NULL : data);
+        lyxml_free(state->ctx, xmlelem);
+        if (r) {
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (state->xmlact && !(state->options & LYD_OPT_NOSIBLINGS)) {
+        /* the action element is the only one, there can be just comments and PIs after it */
+        if (lyxml_parse_misc(*data, &len)) {
+            return EXIT_FAILURE;
+        }
+        (*data) += len;
+        if ((*data)[0]) {
+            LOGVAL(LYE_XML_INVAL, LY_VLOG_NONE, NULL, "element after the action element");
+            return EXIT_FAILURE;
+        }
+        return EXIT_SUCCESS;
+    }
+
+    while (is_xmlws((*data)[0])) {
+        ++(*data);
+    }
+    if ((*data)[0]) {
+        LOGWRN("There are some not parsed data:\n%s", *data);
+    }
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Parse data tree either from an XML tree or directly from XML data.
+ *
+ * @param[in] ctx libyang context.
+ * @param[in,out] root XML tree to parse, NULL if \p data are used.
+ * @param[in] data XML data to parse, used only if \p root is NULL.
+ * @param[in] options Parser options.
+ * @param[in] rpc_act Request of the parsed RPC/action reply.
+ * @param[in] data_tree Data tree for RPC/action/notification validation.
+ *
+ * @return Parsed data tree, NULL on error or if there is no data.
+ */
+static struct lyd_node *
+xml_parse_tree(struct ly_ctx *ctx, struct lyxml_elem **root, const char *data, int options,
+               const struct lyd_node *rpc_act, const struct lyd_node *data_tree)
+{
+    unsigned int len;
+    struct lyd_node *result = NULL;
+    struct lyxml_elem *xmlstart, *xmlelem, *xmlaux, *xmlfree = NULL;
+    struct lyd_parse_state state;
+
+    if (!root) {
+        /* skip the XML declaration and anything else before the first element */
+        if (lyxml_parse_misc(data, &len)) {
+            return NULL;
+        }
+        data += len;
+    }
+    if (root ? !(*root) : !data[0]) {
+        /* empty tree - no work is needed */
+        lyd_validate(&result, options, ctx);
+        return result;
+    }
+
+    if (lyp_data_parse_init(&state, ctx, options, rpc_act, data_tree)) {
+        return NULL;
+    }
+
+    if (root) {
+        if (!(options & LYD_OPT_NOSIBLINGS)) {
+            /* locate the first root to process */
+            if ((*root)->parent) {
+                xmlstart = (*root)->parent->child;
+            } else {
+                xmlstart = *root;
+                while(xmlstart->prev->next) {
+                    xmlstart = xmlstart->prev;
+                }
+            }
+        } else {
+            xmlstart = *root;
+        }
+
+        if ((options & LYD_OPT_RPC)
+                && !strcmp(xmlstart->name, "action") && !strcmp(xmlstart->ns->value, "urn:ietf:params:xml:ns:yang:1")) {
+            /* it's an action, not a simple RPC */
+            xmlstart = xmlstart->child;
+            if (options & LYD_OPT_DESTRUCT) {
+                /* free it later */
+                xmlfree = xmlstart->parent;
+            }
+        }
+
+        LY_TREE_FOR_SAFE(xmlstart, xmlaux, xmlelem) {
+            if (xml_parse_data_root(&state, xmlelem, NULL)) {
+                goto error;
+            } else if (options & LYD_OPT_DESTRUCT) {
+                lyxml_free(ctx, xmlelem);
+                *root = xmlaux;
+            }
+
+            if (state.done) {
+                break;
+            }
+        }
+    } else if (lyd_parse_xml_roots(&state, &data)) {
+        goto error;
+    }
+
+    lyxml_free(ctx, xmlfree);
+    return lyp_data_parse_finish(&state);
+
+error:
+    lyxml_free(ctx, xmlfree);
+    lyp_data_parse_clean(&state);
+    return NULL;
+}
+
 API struct lyd_node *
 lyd_parse_xml(struct ly_ctx *ctx, struct lyxml_elem **root, int options, ...)
 {
     va_list ap;
-    int r, i;
-    struct unres_data *unres = NULL;
     const struct lyd_node *rpc_act = NULL, *data_tree = NULL;
-    struct lyd_node *result = NULL, *iter, *last, *reply_parent = NULL, *reply_top = NULL, *act_notif = NULL;
-    struct lyxml_elem *xmlstart, *xmlelem, *xmlaux, *xmlfree = NULL;
-    struct ly_set *set;
+    struct lyd_node *iter, *result = NULL;
 
     ly_err_clean(1);
 
@@ -565,37 +905,12 @@ lyd_parse_xml(struct ly_ctx *ctx, struct lyxml_elem **root, int options, ...)
         return result;
     }
 
-    unres = calloc(1, sizeof *unres);
-    if (!unres) {
-        LOGMEM;
-        return NULL;
-    }
-
     va_start(ap, options);
     if (options & LYD_OPT_RPCREPLY) {
         rpc_act = va_arg(ap, const struct lyd_node *);
         if (!rpc_act || rpc_act->parent || !(rpc_act->schema->nodetype & (LYS_RPC | LYS_LIST | LYS_CONTAINER))) {
             LOGERR(LY_EINVAL, "%s: invalid variable parameter (const struct lyd_node *rpc_act).", __func__);
-            goto error;
-        }
-        if (rpc_act->schema->nodetype == LYS_RPC) {
-            /* RPC request */
-            reply_top = reply_parent = _lyd_new(NULL, rpc_act->schema, 0);
-        } else {
-            /* action request */
-            reply_top = lyd_dup(rpc_act, 1);
-            LY_TREE_DFS_BEGIN(reply_top, iter, reply_parent) {
-                if (reply_parent->schema->nodetype == LYS_ACTION) {
-                    break;
-                }
-                LY_TREE_DFS_END(reply_top, iter, reply_parent);
-            }
-            if (!reply_parent) {
-                LOGERR(LY_EINVAL, "%s: invalid variable parameter (const struct lyd_node *rpc_act).", __func__);
-                lyd_free_withsiblings(reply_top);
-                goto error;
-            }
-            lyd_free_withsiblings(reply_parent->child);
+            goto finish;
         }
     }
     if (options & (LYD_OPT_RPC | LYD_OPT_NOTIF | LYD_OPT_RPCREPLY)) {
@@ -605,7 +920,7 @@ lyd_parse_xml(struct ly_ctx *ctx, struct lyxml_elem **root, int options, ...)
                 if (iter->parent) {
                     /* a sibling is not top-level */
                     LOGERR(LY_EINVAL, "%s: invalid variable parameter (const struct lyd_node *data_tree).", __func__);
-                    goto error;
+                    goto finish;
                 }
             }
 
@@ -615,123 +930,23 @@ lyd_parse_xml(struct ly_ctx *ctx, struct lyxml_elem **root, int options, ...)
             /* LYD_OPT_NOSIBLINGS cannot be set in this case */
             if (options & LYD_OPT_NOSIBLINGS) {
                 LOGERR(LY_EINVAL, "%s: invalid parameter (variable arg const struct lyd_node *data_tree with LYD_OPT_NOSIBLINGS).", __func__);
-                goto error;
-            }
-        }
-    }
-
-    if (!(options & LYD_OPT_NOSIBLINGS)) {
-        /* locate the first root to process */
-        if ((*root)->parent) {
-            xmlstart = (*root)->parent->child;
-        } else {
-            xmlstart = *root;
-            while(xmlstart->prev->next) {
-                xmlstart = xmlstart->prev;
-            }
-        }
-    } else {
-        xmlstart = *root;
-    }
-
-    if ((options & LYD_OPT_RPC)
-            && !strcmp(xmlstart->name, "action") && !strcmp(xmlstart->ns->value, "urn:ietf:params:xml:ns:yang:1")) {
-        /* it's an action, not a simple RPC */
-        xmlstart = xmlstart->child;
-        if (options & LYD_OPT_DESTRUCT) {
-            /* free it later */
-            xmlfree = xmlstart->parent;
-        }
-    }
-
-    iter = last = NULL;
-    LY_TREE_FOR_SAFE(xmlstart, xmlaux, xmlelem) {
-        r = xml_parse_data(ctx, xmlelem, reply_parent, result, last, options, unres, &iter, &act_notif);
-        if (r) {
-            if (reply_top) {
-                result = reply_top;
+                goto finish;
             }
-            goto error;
-        } else if (options & LYD_OPT_DESTRUCT) {
-            lyxml_free(ctx, xmlelem);
-            *root = xmlaux;
-        }
-        if (iter) {
-            last = iter;
-        }
-        if (!result) {
-            result = iter;
-        }
-
-        if (options & LYD_OPT_NOSIBLINGS) {
-            /* stop after the first processed root */
-            break;
-        }
-    }
-
-    if (reply_top) {
-        result = reply_top;
-    }
-
-    if ((options & LYD_OPT_RPCREPLY) && (rpc_act->schema->nodetype != LYS_RPC)) {
-        /* action reply */
-        act_notif = reply_parent;
-    } else if ((options & (LYD_OPT_RPC | LYD_OPT_NOTIF)) && !act_notif) {
-        ly_vecode = LYVE_INELEM;
-        LOGVAL(LYE_SPEC, LY_VLOG_LYD, result, "Missing %s node.", (options & LYD_OPT_RPC ? "action" : "notification"));
-        goto error;
-    }
-
-    /* check for uniquness of top-level lists/leaflists because
-     * only the inner instances were tested in lyv_data_content() */
-    set = ly_set_new();
-    LY_TREE_FOR(result, iter) {
-        if (!(iter->schema->nodetype & (LYS_LIST | LYS_LEAFLIST)) || !(iter->validity & LYD_VAL_UNIQUE)) {
-            continue;
-        }
-
-        /* check each list/leaflist only once */
-        i = set->number;
-        if (ly_set_add(set, iter->schema, 0) != i) {
-            /* already checked */
-            continue;
-        }
-
-        if (lyv_data_unique(iter, result)) {
-            ly_set_free(set);
-            goto error;
         }
     }
-    ly_set_free(set);
 
-    /* add default values, resolve unres and check for mandatory nodes in final tree */
-    if (lyd_defaults_add_unres(&result, options, ctx, data_tree, act_notif, unres)) {
-        goto error;
-    }
-    if (!(options & (LYD_OPT_TRUSTED | LYD_OPT_NOTIF_FILTER))
-            && lyd_check_mandatory_tree((act_notif ? act_notif : result), ctx, options)) {
-        goto error;
-    }
+    result = xml_parse_tree(ctx, root, NULL, options, rpc_act, data_tree);
 
-    if (xmlfree) {
-        lyxml_free(ctx, xmlfree);
-    }
-    free(unres->node);
-    free(unres->type);
-    free(unres);
+finish:
     va_end(ap);
-
     return result;
+}
 
-error:
-    lyd_free_withsiblings(result);
-    if (xmlfree) {
-        lyxml_free(ctx, xmlfree);
-    }
-    free(unres->node);
-    free(unres->type);
-    free(unres);
-    va_end(ap);
+struct lyd_node *
+lyd_parse_xml_mem(struct ly_ctx *ctx, const char *data, int options, const struct lyd_node *rpc_act,
+                  const struct lyd_node *data_tree)
+{
+    ly_err_clean(1);
 
-    return NULL;
+    return xml_parse_tree(ctx, NULL, data, options, rpc_act, data_tree);
 }
@@ -728,6 +728,9 @@ yang_check_type(struct lys_module *module, struct lys_node *parent, struct yang_
                 LOGVAL(LYE_INARG, LY_VLOG_NONE, NULL, type->info.str.length->expr, "length");
                 goto error;
             }
+            if (lyp_precompile_type_patterns(type)) {
+                goto error;
+            }
         } else {
             LOGVAL(LYE_SPEC, LY_VLOG_NONE, NULL, "Invalid restriction in type \"%s\".", type->parent->name);
             goto error;
@@ -1415,6 +1415,11 @@ fill_yin_type(struct lys_module *module, struct lys_node *parent, struct lyxml_e
                 }
                 type->info.str.pat_count++;
             }
+
+            /* precompile the patterns for the data validation */
+            if (lyp_precompile_type_patterns(type)) {
+                goto error;
+            }
         }
         break;
 
@@ -2606,6 +2611,7 @@ fill_yin_deviation(struct lys_module *module, struct lyxml_elem *yin, struct lys
                 }
                 *trg_must = d->must;
                 d->must = &((*trg_must)[*trg_must_size]);
+                memset(d->must, 0, c_must * sizeof *d->must);
                 d->must_size = c_must;
             } else { /* LY_DEVIATE_DEL */
                 d->must = calloc(c_must, sizeof *d->must);
@@ -2734,6 +2740,7 @@ fill_yin_deviation(struct lys_module *module, struct lyxml_elem *yin, struct lys
                                 (*trg_must)[i].ref = (*trg_must)[*trg_must_size].ref;
                                 (*trg_must)[i].eapptag = (*trg_must)[*trg_must_size].eapptag;
                                 (*trg_must)[i].emsg = (*trg_must)[*trg_must_size].emsg;
+                                (*trg_must)[i].expr_compiled = (*trg_must)[*trg_must_size].expr_compiled;
                             }
                             if (!(*trg_must_size)) {
                                 free(*trg_must);
@@ -2744,6 +2751,7 @@ fill_yin_deviation(struct lys_module *module, struct lyxml_elem *yin, struct lys
                                 (*trg_must)[*trg_must_size].ref = NULL;
                                 (*trg_must)[*trg_must_size].eapptag = NULL;
                                 (*trg_must)[*trg_must_size].emsg = NULL;
+                                (*trg_must)[*trg_must_size].expr_compiled = NULL;
                             }
 
                             i = -1; /* set match flag */
@@ -12,7 +12,7 @@
  *     https://opensource.org/licenses/BSD-3-Clause
  */
 
-#define _GNU_SOURCE /* vasprintf(), vdprintf() */
+#include <errno.h>
 #include <stdarg.h>
 #include <stdio.h>
 #include <string.h>
@@ -73,99 +73,161 @@ nscmp(const struct lyd_node *node1, const struct lyd_node *node2)
     }
 }
 
+/**
+ * @brief Make sure there is enough space in the output buffer, it grows geometrically.
+ *
+ * @param[in] out Output with the buffer.
+ * @param[in] count Number of bytes to be added into the buffer (the terminating NULL byte is added automatically).
+ * @return 0 on success, -1 on memory allocation failure.
+ */
+static int
+ly_print_reserve(struct lyout *out, size_t count)
+{
+    char *aux;
+    size_t size;
+
+    if (out->buf_len + count + 1 <= out->buf_size) {
+        return 0;
+    }
+
+    for (size = out->buf_size ? out->buf_size : 256; size < out->buf_len + count + 1; size <<= 1);
+    aux = ly_realloc(out->buf, size);
+    if (!aux) {
+        out->buf = NULL;
+        out->buf_len = 0;
+        out->buf_size = 0;
+        LOGMEM;
+        return -1;
+    }
+    out->buf = aux;
+    out->buf_size = size;
+
+    return 0;
+}
+
+/**
+ * @brief Write the buffered data out (LYOUT_FD and LYOUT_CALLBACK outputs).
+ *
+ * @param[in] out Output to write.
+ * @return 0 on success, -1 on error (the buffered data are dropped).
+ */
+static int
+ly_print_write(struct lyout *out)
+{
+    size_t written = 0;
+    ssize_t r;
+
+    while (written < out->buf_len) {
+        if (out->type == LYOUT_FD) {
+            r = write(out->method.fd, &out->buf[written], out->buf_len - written);
+            if ((r == -1) && (errno == EINTR)) {
+                continue;
+            }
+        } else {
+            r = out->method.clb.f(out->method.clb.arg, &out->buf[written], out->buf_len - written);
+        }
+        if (r <= 0) {
+            out->buf_len = 0;
+            out->error = 1;
+            return -1;
+        }
+        written += r;
+    }
+    out->buf_len = 0;
+
+    return 0;
+}
+
 int
 ly_print(struct lyout *out, const char *format, ...)
 {
-    int count = 0;
-    char *msg = NULL, *aux;
+    int count;
     va_list ap;
 
-    va_start(ap, format);
-
-    switch(out->type) {
-    case LYOUT_FD:
-        count = vdprintf(out->method.fd, format, ap);
-        break;
-    case LYOUT_STREAM:
+    if (out->type == LYOUT_STREAM) {
+        va_start(ap, format);
         count = vfprintf(out->method.f, format, ap);
-        break;
-    case LYOUT_MEMORY:
-        count = vasprintf(&msg, format, ap);
-        if (out->method.mem.len + count + 1 > out->method.mem.size) {
-            aux = ly_realloc(out->method.mem.buf, out->method.mem.len + count + 1);
-            if (!aux) {
-                out->method.mem.buf = NULL;
-                out->method.mem.len = 0;
-                out->method.mem.size = 0;
-                LOGMEM;
-                va_end(ap);
-                return -1;
-            }
-            out->method.mem.buf = aux;
-            out->method.mem.size = out->method.mem.len + count + 1;
-        }
-        memcpy(&out->method.mem.buf[out->method.mem.len], msg, count);
-        out->method.mem.len += count;
-        out->method.mem.buf[out->method.mem.len] = '\0';
-        free(msg);
-        break;
-    case LYOUT_CALLBACK:
-        count = vasprintf(&msg, format, ap);
-        count = out->method.clb.f(out->method.clb.arg, msg, count);
-        free(msg);
-        break;
+        va_end(ap);
+        return count;
     }
 
+    /* format the data directly into the buffer, enlarge it and repeat if they do not fit */
+    va_start(ap, format);
+    count = vsnprintf(out->buf ? &out->buf[out->buf_len] : NULL, out->buf_size - out->buf_len, format, ap);
     va_end(ap);
+    if (count < 0) {
+        return -1;
+    }
+    if (out->buf_len + count + 1 > out->buf_size) {
+        if (ly_print_reserve(out, count)) {
+            return -1;
+        }
+        va_start(ap, format);
+        vsnprintf(&out->buf[out->buf_len], out->buf_size - out->buf_len, format, ap);
+        va_end(ap);
+    }
+    out->buf_len += count;
+
+    if ((out->type != LYOUT_MEMORY) && (out->buf_len >= LYOUT_BUF_FLUSH) && ly_print_write(out)) {
+        return -1;
+    }
     return count;
 }
 
-void
+int
 ly_print_flush(struct lyout *out)
 {
     switch (out->type) {
     case LYOUT_STREAM:
-        fflush(out->method.f);
+        if (fflush(out->method.f)) {
+            out->error = 1;
+            return -1;
+        }
         break;
     case LYOUT_FD:
-    case LYOUT_MEMORY:
     case LYOUT_CALLBACK:
+        return ly_print_write(out);
+    case LYOUT_MEMORY:
         /* nothing to do */
         break;
     }
+
+    return 0;
 }
 
 int
-ly_write(struct lyout *out, const char *buf, size_t count)
+ly_print_clean(struct lyout *out)
 {
-    char *aux;
+    if (out->type == LYOUT_MEMORY) {
+        return 0;
+    }
 
-    switch(out->type) {
-    case LYOUT_FD:
-        return write(out->method.fd, buf, count);
-    case LYOUT_STREAM:
+    ly_print_flush(out);
+    free(out->buf);
+    out->buf = NULL;
+    out->buf_len = out->buf_size = 0;
+
+    return out->error ? -1 : 0;
+}
+
+int
+ly_write(struct lyout *out, const char *buf, size_t count)
+{
+    if (out->type == LYOUT_STREAM) {
         return fwrite(buf, sizeof *buf, count, out->method.f);
-    case LYOUT_MEMORY:
-        if (out->method.mem.len + count + 1 > out->method.mem.size) {
-            aux = ly_realloc(out->method.mem.buf, out->method.mem.len + count + 1);
-            if (!aux) {
-                out->method.mem.buf = NULL;
-                out->method.mem.len = 0;
-                out->method.mem.size = 0;
-                LOGMEM;
-                return -1;
-            }
-            out->method.mem.buf = aux;
-            out->method.mem.size = out->method.mem.len + count + 1;
-        }
-        memcpy(&out->method.mem.buf[out->method.mem.len], buf, count + 1);
-        out->method.mem.len += count;
-        return count;
-    case LYOUT_CALLBACK:
-        return out->method.clb.f(out->method.clb.arg, buf, count);
     }
 
-    return 0;
+    if (ly_print_reserve(out, count)) {
+        return -1;
+    }
+    memcpy(&out->buf[out->buf_len], buf, count);
+    out->buf_len += count;
+    out->buf[out->buf_len] = '\0';
+
+    if ((out->type != LYOUT_MEMORY) && (out->buf_len >= LYOUT_BUF_FLUSH) && ly_print_write(out)) {
+        return -1;
+    }
+    return count;
 }
 
 static int
@@ -261,6 +323,10 @@ lys_print_(struct lyout *out, const struct lys_module *module, LYS_OUTFORMAT for
         break;
     }
 
+    if (ly_print_clean(out) && !ret) {
+        LOGERR(LY_ESYS, "Writing the printed output failed.");
+        ret = EXIT_FAILURE;
+    }
     return ret;
 }
 
@@ -274,6 +340,7 @@ lys_print_file(FILE *f, const struct lys_module *module, LYS_OUTFORMAT format, c
         return EXIT_FAILURE;
     }
 
+    memset(&out, 0, sizeof out);
     out.type = LYOUT_STREAM;
     out.method.f = f;
 
@@ -290,6 +357,7 @@ lys_print_fd(int fd, const struct lys_module *module, LYS_OUTFORMAT format, cons
         return EXIT_FAILURE;
     }
 
+    memset(&out, 0, sizeof out);
     out.type = LYOUT_FD;
     out.method.fd = fd;
 
@@ -307,14 +375,12 @@ lys_print_mem(char **strp, const struct lys_module *module, LYS_OUTFORMAT format
         return EXIT_FAILURE;
     }
 
+    memset(&out, 0, sizeof out);
     out.type = LYOUT_MEMORY;
-    out.method.mem.buf = NULL;
-    out.method.mem.len = 0;
-    out.method.mem.size = 0;
 
     r = lys_print_(&out, module, format, target_node);
 
-    *strp = out.method.mem.buf;
+    *strp = out.buf;
     return r;
 }
 
@@ -328,6 +394,7 @@ lys_print_clb(ssize_t (*writeclb)(void *arg, const void *buf, size_t count), voi
         return EXIT_FAILURE;
     }
 
+    memset(&out, 0, sizeof out);
     out.type = LYOUT_CALLBACK;
     out.method.clb.f = writeclb;
     out.method.clb.arg = arg;
@@ -338,23 +405,37 @@ lys_print_clb(ssize_t (*writeclb)(void *arg, const void *buf, size_t count), voi
 static int
 lyd_print_(struct lyout *out, const struct lyd_node *root, LYD_FORMAT format, int options)
 {
-    if (!root) {
+    int ret;
+
+    if (format == LYD_LYB) {
+        /* even an empty tree has the header */
+        ret = lyb_print_data(out, root, options);
+    } else if (!root) {
         /* no data to print, but even empty tree is valid */
         if (out->type == LYOUT_MEMORY || out->type == LYOUT_CALLBACK) {
             ly_print(out, "");
         }
-        return EXIT_SUCCESS;
+        ret = EXIT_SUCCESS;
+    } else {
+        switch (format) {
+        case LYD_XML:
+            ret = xml_print_data(out, root, options);
+            break;
+        case LYD_JSON:
+            ret = json_print_data(out, root, options);
+            break;
+        default:
+            LOGERR(LY_EINVAL, "Unknown output format.");
+            ret = EXIT_FAILURE;
+            break;
+        }
     }
 
-    switch (format) {
-    case LYD_XML:
-        return xml_print_data(out, root, options);
-    case LYD_JSON:
-        return json_print_data(out, root, options);
-    default:
-        LOGERR(LY_EINVAL, "Unknown output format.");
-        return EXIT_FAILURE;
+    if (ly_print_clean(out) && !ret) {
+        LOGERR(LY_ESYS, "Writing the printed output failed.");
+        ret = EXIT_FAILURE;
     }
+    return ret;
 }
 
 API int
@@ -367,6 +448,7 @@ lyd_print_file(FILE *f, const struct lyd_node *root, LYD_FORMAT format, int opti
         return EXIT_FAILURE;
     }
 
+    memset(&out, 0, sizeof out);
     out.type = LYOUT_STREAM;
     out.method.f = f;
 
@@ -383,6 +465,7 @@ lyd_print_fd(int fd, const struct lyd_node *root, LYD_FORMAT format, int options
         return EXIT_FAILURE;
     }
 
+    memset(&out, 0, sizeof out);
     out.type = LYOUT_FD;
     out.method.fd = fd;
 
@@ -400,14 +483,12 @@ lyd_print_mem(char **strp, const struct lyd_node *root, LYD_FORMAT format, int o
         return EXIT_FAILURE;
     }
 
+    memset(&out, 0, sizeof out);
     out.type = LYOUT_MEMORY;
-    out.method.mem.buf = NULL;
-    out.method.mem.len = 0;
-    out.method.mem.size = 0;
 
     r = lyd_print_(&out, root, format, options);
 
-    *strp = out.method.mem.buf;
+    *strp = out.buf;
     return r;
 }
 
@@ -422,6 +503,7 @@ lyd_print_clb(ssize_t (*writeclb)(void *arg, const void *buf, size_t count), voi
         return EXIT_FAILURE;
     }
 
+    memset(&out, 0, sizeof out);
     out.type = LYOUT_CALLBACK;
     out.method.clb.f = writeclb;
     out.method.clb.arg = arg;
@@ -26,21 +26,31 @@ typedef enum LYOUT_TYPE {
     LYOUT_CALLBACK     /**< print via provided callback */
 } LYOUT_TYPE;
 
+/**
+ * size of the printed data buffered for the file descriptor and callback outputs before they are written out
+ */
+#define LYOUT_BUF_FLUSH 8192
+
 struct lyout {
     LYOUT_TYPE type;
     union {
         int fd;
         FILE *f;
-        struct {
-            char *buf;
-            size_t len;
-            size_t size;
-        } mem;
         struct {
             ssize_t (*f)(void *arg, const void *buf, size_t count);
             void *arg;
         } clb;
     } method;
+
+    /* the data are formatted directly into this buffer (except for LYOUT_STREAM, which has its own buffering),
+     * for LYOUT_MEMORY it holds the whole output, for LYOUT_FD and LYOUT_CALLBACK it is flushed when it gets
+     * LYOUT_BUF_FLUSH bytes long */
+    char *buf;
+    size_t buf_len;
+    size_t buf_size;
+
+    /* writing the output failed, the rest of it is still formatted but the whole printing fails */
+    int error;
 };
 
 struct ext_substmt_info_s {
@@ -58,8 +68,15 @@ extern struct ext_substmt_info_s ext_substmt_info[];
  * @brief Generic printer, replacement for printf() / write() / etc
  */
 int ly_print(struct lyout *out, const char *format, ...);
-void ly_print_flush(struct lyout *out);
+int ly_print_flush(struct lyout *out);
 int ly_write(struct lyout *out, const char *buf, size_t count);
+
+/**
+ * @brief Flush the output and free its buffer, the buffer of LYOUT_MEMORY output is kept as it is the result.
+ *
+ * @return 0 on success, -1 if writing any part of the output failed.
+ */
+int ly_print_clean(struct lyout *out);
 /* module_name_or_prefix: 1 - print module names for foreign if-features, 0 - print import prefixes */
 int ly_print_iffeature(struct lyout *out, const struct lys_module *module, struct lys_iffeature *expr, int module_name_or_prefix);
 
@@ -70,6 +87,7 @@ int info_print_model(struct lyout *out, const struct lys_module *module, const c
 
 int json_print_data(struct lyout *out, const struct lyd_node *root, int options);
 int xml_print_data(struct lyout *out, const struct lyd_node *root, int options);
+int lyb_print_data(struct lyout *out, const struct lyd_node *root, int options);
 void xml_print_node(struct lyout *out, int level, const struct lyd_node *node, int toplevel, int options);
 
 /**
@@ -33,7 +33,7 @@ static void json_print_nodes(struct lyout *out, int level, const struct lyd_node
 static int
 json_print_string(struct lyout *out, const char *text)
 {
-    unsigned int i, n;
+    unsigned int i, n, len;
 
     if (!text) {
         return 0;
@@ -43,18 +43,22 @@ json_print_string(struct lyout *out, const char *text)
     for (i = n = 0; text[i]; i++) {
         if (text[i] >= 0 && text[i] < 0x20) {
             /* control character */
-            n += ly_print(out, "\\u%.4X");
+            n += ly_print(out, "\\u%.4X", text[i]);
         } else {
             switch (text[i]) {
             case '"':
-                n += ly_print(out, "\\\"");
+                n += ly_write(out, "\\\"", 2);
                 break;
             case '\\':
-                n += ly_print(out, "\\\\");
+                n += ly_write(out, "\\\\", 2);
                 break;
             default:
-                ly_write(out, &text[i], 1);
-                n++;
+                /* print all the characters not to be escaped at once */
+                for (len = 1; text[i + len] && ((text[i + len] < 0) || (text[i + len] >= 0x20))
+                        && (text[i + len] != '"') && (text[i + len] != '\\'); len++);
+                ly_write(out, &text[i], len);
+                n += len;
+                i += len - 1;
             }
         }
     }
@@ -104,7 +108,11 @@ json_print_attrs(struct lyout *out, int level, const struct lyd_node *node, cons
         case LY_TYPE_UINT16:
         case LY_TYPE_UINT32:
         case LY_TYPE_BOOL:
-            ly_print(out, "%s", attr->value_str[0] ? attr->value_str : "null");
+            if (attr->value_str[0]) {
+                ly_write(out, attr->value_str, strlen(attr->value_str));
+            } else {
+                ly_write(out, "null", 4);
+            }
             break;
 
         case LY_TYPE_IDENT:
@@ -121,12 +129,12 @@ json_print_attrs(struct lyout *out, int level, const struct lyd_node *node, cons
             break;
 
         case LY_TYPE_EMPTY:
-            ly_print(out, "[null]");
+            ly_write(out, "[null]", 6);
             break;
 
         default:
             /* error */
-            ly_print(out, "\"(!error!)\"");
+            ly_write(out, "\"(!error!)\"", 11);
         }
 
         ly_print(out, "%s%s", attr->next ? "," : "", (level ? "\n" : ""));
@@ -181,7 +189,11 @@ contentprint:
     case LY_TYPE_UINT16:
     case LY_TYPE_UINT32:
     case LY_TYPE_BOOL:
-        ly_print(out, "%s", leaf->value_str[0] ? leaf->value_str : "null");
+        if (leaf->value_str[0]) {
+            ly_write(out, leaf->value_str, strlen(leaf->value_str));
+        } else {
+            ly_write(out, "null", 4);
+        }
         break;
 
     case LY_TYPE_IDENT:
@@ -207,7 +219,7 @@ contentprint:
             type = lyd_leaf_type((struct lyd_node_leaf_list *)leaf);
             if (!type) {
                 /* error */
-                ly_print(out, "\"(!error!)\"");
+                ly_write(out, "\"(!error!)\"", 11);
                 return;
             }
             datatype = type->base;
@@ -217,12 +229,12 @@ contentprint:
         goto contentprint;
 
     case LY_TYPE_EMPTY:
-        ly_print(out, "[null]");
+        ly_write(out, "[null]", 6);
         break;
 
     default:
         /* error */
-        ly_print(out, "\"(!error!)\"");
+        ly_write(out, "\"(!error!)\"", 11);
     }
 
     /* print attributes as sibling leafs */
@@ -261,7 +273,7 @@ json_print_container(struct lyout *out, int level, const struct lyd_node *node,
         json_print_attrs(out, (level ? level + 1 : level), node, NULL);
         ly_print(out, "%*s}", LEVEL, INDENT);
         if (node->child) {
-            ly_print(out, ",%s", (level ? "\n" : ""));
+            ly_write(out, ",\n", level ? 2 : 1);
         }
     }
     json_print_nodes(out, level, node->child, 1, 0, options);
@@ -338,7 +350,7 @@ json_print_leaf_list(struct lyout *out, int level, const struct lyd_node *node,
         }
         for (list = list->next; list && list->schema != node->schema; list = list->next);
         if (list) {
-            ly_print(out, ",%s", (level ? "\n" : ""));
+            ly_write(out, ",\n", level ? 2 : 1);
         }
     }
 
@@ -372,7 +384,7 @@ json_print_leaf_list(struct lyout *out, int level, const struct lyd_node *node,
 
             for (list = list->next; list && list->schema != node->schema; list = list->next);
             if (list) {
-                ly_print(out, ",%s", (level ? "\n" : ""));
+                ly_write(out, ",\n", level ? 2 : 1);
             }
         }
         if (level) {
@@ -404,13 +416,13 @@ json_print_anyxml(struct lyout *out, int level, const struct lyd_node *node, int
     switch (any->value_type) {
     case LYD_ANYDATA_DATATREE:
         isobject = 1;
-        ly_print(out, level ? "{\n" : "{");
+        ly_write(out, "{\n", level ? 2 : 1);
         /* do not print any default values nor empty containers */
         json_print_nodes(out, level, any->value.tree, 1, 0,  LYP_WITHSIBLINGS | (options & ~LYP_NETCONF));
         break;
     case LYD_ANYDATA_JSON:
         isobject = 1;
-        ly_print(out, level ? "{\n" : "{");
+        ly_write(out, "{\n", level ? 2 : 1);
         if (any->value.str) {
             ly_print(out, "%*s%s%s", LEVEL, INDENT, any->value.str, level ? "\n" : "");
         }
@@ -426,7 +438,7 @@ json_print_anyxml(struct lyout *out, int level, const struct lyd_node *node, int
         if (any->value.str) {
             json_print_string(out, any->value.str);
         } else {
-            ly_print(out, "\"\"");
+            ly_write(out, "\"\"", 2);
         }
         break;
     default:
@@ -513,14 +525,14 @@ json_print_nodes(struct lyout *out, int level, const struct lyd_node *root, int
         case LYS_CONTAINER:
             if (node->prev->next) {
                 /* print the previous comma */
-                ly_print(out, ",%s", (level ? "\n" : ""));
+                ly_write(out, ",\n", level ? 2 : 1);
             }
             json_print_container(out, level, node, toplevel, options);
             break;
         case LYS_LEAF:
             if (node->prev->next) {
                 /* print the previous comma */
-                ly_print(out, ",%s", (level ? "\n" : ""));
+                ly_write(out, ",\n", level ? 2 : 1);
             }
             json_print_leaf(out, level, node, 0, toplevel, options);
             break;
@@ -539,7 +551,7 @@ json_print_nodes(struct lyout *out, int level, const struct lyd_node *root, int
             if (!iter->next) {
                 if (node->prev->next) {
                     /* print the previous comma */
-                    ly_print(out, ",%s", (level ? "\n" : ""));
+                    ly_write(out, ",\n", level ? 2 : 1);
                 }
 
                 /* print the list/leaflist */
@@ -549,14 +561,14 @@ json_print_nodes(struct lyout *out, int level, const struct lyd_node *root, int
         case LYS_ANYXML:
             if (node->prev->next) {
                 /* print the previous comma */
-                ly_print(out, ",%s", (level ? "\n" : ""));
+                ly_write(out, ",\n", level ? 2 : 1);
             }
             json_print_anyxml(out, level, node, toplevel, options);
             break;
         case LYS_ANYDATA:
             if (node->prev->next) {
                 /* print the previous comma */
-                ly_print(out, ",%s", (level ? "\n" : ""));
+                ly_write(out, ",\n", level ? 2 : 1);
             }
             json_print_anydata(out, level, node, toplevel, options);
             break;
@@ -570,7 +582,7 @@ json_print_nodes(struct lyout *out, int level, const struct lyd_node *root, int
         }
     }
     if (root && level) {
-        ly_print(out, "\n");
+        ly_write(out, "\n", 1);
     }
 }
 
@@ -608,7 +620,7 @@ json_print_data(struct lyout *out, const struct lyd_node *root, int options)
     }
 
     /* start */
-    ly_print(out, "{%s", (level ? "\n" : ""));
+    ly_write(out, "{\n", level ? 2 : 1);
 
     if (action_input) {
         ly_print(out, "%*s\"yang:action\":%s{%s", LEVEL, INDENT, (level ? " " : ""), (level ? "\n" : ""));
@@ -628,7 +640,7 @@ json_print_data(struct lyout *out, const struct lyd_node *root, int options)
     }
 
     /* end */
-    ly_print(out, "}%s", (level ? "\n" : ""));
+    ly_write(out, "}\n", level ? 2 : 1);
 
     ly_print_flush(out);
     return EXIT_SUCCESS;
@@ -0,0 +1,566 @@
+/**
+ * @file printer_lyb.c
+ * @brief LYB printer for libyang data structure
+ *
+ * Copyright (c) 2017 CESNET, z.s.p.o.
+ *
+ * This source code is licensed under BSD 3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/BSD-3-Clause
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "common.h"
+#include "context.h"
+#include "printer.h"
+#include "tree_data.h"
+#include "tree_internal.h"
+#include "xml_internal.h"
+
+/**
+ * @brief Index of a schema node among its data siblings from the same module.
+ */
+struct lyb_pos_rec {
+    const struct lys_node *node;
+    uint32_t pos;
+};
+
+/**
+ * @brief Records of all the data siblings from a module, allocated at once.
+ */
+struct lyb_pos_group {
+    struct lyb_pos_group *next;
+    struct lyb_pos_rec *recs;
+};
+
+/**
+ * @brief State of the printed LYB data, the nodes are printed into a buffer since the module table preceding them
+ * and the sizes of the subtrees are known only after printing them.
+ */
+struct lyb_print {
+    char *buf;
+    size_t len;
+    size_t size;
+    const struct lys_module **mods;  /**< module table */
+    uint32_t mod_count;
+    uint32_t mod_last;               /**< index of the last used module */
+    struct hash_table *pos_ht;       /**< schema node positions (struct lyb_pos_rec *) */
+    struct lyb_pos_group *groups;
+};
+
+static int
+lyb_reserve(struct lyb_print *lp, size_t count)
+{
+    char *aux;
+    size_t size;
+
+    if (lp->len + count <= lp->size) {
+        return EXIT_SUCCESS;
+    }
+
+    for (size = lp->size ? lp->size : 1024; size < lp->len + count; size <<= 1);
+    aux = ly_realloc(lp->buf, size);
+    if (!aux) {
+        lp->buf = NULL;
+        LOGMEM;
+        return EXIT_FAILURE;
+    }
+    lp->buf = aux;
+    lp->size = size;
+
+    return EXIT_SUCCESS;
+}
+
+static int
+lyb_write(struct lyb_print *lp, const void *data, size_t count)
+{
+    if (lyb_reserve(lp, count)) {
+        return EXIT_FAILURE;
+    }
+    memcpy(&lp->buf[lp->len], data, count);
+    lp->len += count;
+
+    return EXIT_SUCCESS;
+}
+
+static int
+lyb_write_num(struct lyb_print *lp, uint64_t num)
+{
+    if (lyb_reserve(lp, 10)) {
+        return EXIT_FAILURE;
+    }
+    while (num > 0x7f) {
+        lp->buf[lp->len++] = (char)((num & 0x7f) | 0x80);
+        num >>= 7;
+    }
+    lp->buf[lp->len++] = (char)num;
+
+    return EXIT_SUCCESS;
+}
+
+/* little endian value of the given size */
+static int
+lyb_write_fixed(struct lyb_print *lp, uint64_t num, int size)
+{
+    int i;
+
+    if (lyb_reserve(lp, size)) {
+        return EXIT_FAILURE;
+    }
+    for (i = 0; i < size; ++i) {
+        lp->buf[lp->len++] = (char)(num >> (8 * i));
+    }
+
+    return EXIT_SUCCESS;
+}
+
+static int
+lyb_write_str(struct lyb_print *lp, const char *str)
+{
+    size_t len;
+
+    if (!str) {
+        return lyb_write_num(lp, 0);
+    }
+
+    len = strlen(str);
+    if (lyb_write_num(lp, len + 1)) {
+        return EXIT_FAILURE;
+    }
+    return lyb_write(lp, str, len);
+}
+
+static int
+lyb_pos_equal(void *val_searched, void *val_stored, void *UNUSED(cb_data))
+{
+    return ((struct lyb_pos_rec *)val_stored)->node == val_searched;
+}
+
+static uint32_t
+lyb_pos_hash(const struct lys_node *node)
+{
+    return dict_hash_multi(dict_hash_multi(0, (const char *)&node, sizeof node), NULL, 0);
+}
+
+/**
+ * @brief Get the schema node whose data node is the parent of the \p node instances, RPC/action input and output
+ * are skipped so that the children of both can be found in the RPC/action data node.
+ */
+static const struct lys_node *
+lyb_schema_parent(const struct lys_node *node)
+{
+    do {
+        node = lys_parent(node);
+    } while (node && (node->nodetype & (LYS_CHOICE | LYS_CASE | LYS_USES | LYS_INPUT | LYS_OUTPUT)));
+
+    return node;
+}
+
+/**
+ * @brief Get the index of a schema node among its data siblings from the same module.
+ *
+ * @param[in] lp LYB printer state.
+ * @param[in] node Schema node.
+ * @param[out] pos Index of the node, starting from 0.
+ * @return EXIT_SUCCESS on success, EXIT_FAILURE on error.
+ */
+static int
+lyb_schema_pos(struct lyb_print *lp, const struct lys_node *node, uint32_t *pos)
+{
+    const struct lys_node *parent, *iter;
+    const struct lys_module *module;
+    struct lyb_pos_group *group;
+    struct lyb_pos_rec *rec;
+    uint32_t hash, count, i;
+
+    hash = lyb_pos_hash(node);
+    if (!lyht_find(lp->pos_ht, (void *)node, hash, (void **)&rec)) {
+        *pos = rec->pos;
+        return EXIT_SUCCESS;
+    }
+
+    /* index all the siblings at once */
+    parent = lyb_schema_parent(node);
+    module = lys_node_module(node);
+
+    count = 0;
+    for (iter = NULL; (iter = lys_getnext(iter, parent, module, 0)); ) {
+        if (lys_node_module(iter) == module) {
+            ++count;
+        }
+    }
+
+    group = malloc(sizeof *group);
+    if (!group) {
+        LOGMEM;
+        return EXIT_FAILURE;
+    }
+    group->recs = malloc(count * sizeof *group->recs);
+    if (count && !group->recs) {
+        LOGMEM;
+        free(group);
+        return EXIT_FAILURE;
+    }
+    group->next = lp->groups;
+    lp->groups = group;
+
+    for (i = 0, iter = NULL; (i < count) && (iter = lys_getnext(iter, parent, module, 0)); ) {
+        if (lys_node_module(iter) != module) {
+            continue;
+        }
+        group->recs[i].node = iter;
+        group->recs[i].pos = i;
+        if (lyht_insert(lp->pos_ht, &group->recs[i], lyb_pos_hash(iter))) {
+            return EXIT_FAILURE;
+        }
+        ++i;
+    }
+
+    if (lyht_find(lp->pos_ht, (void *)node, hash, (void **)&rec)) {
+        LOGERR(LY_EINT, "Schema node \"%s\" cannot be printed in LYB format.", node->name);
+        return EXIT_FAILURE;
+    }
+    *pos = rec->pos;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Get the index of a module in the module table, add it if not there yet.
+ */
+static int
+lyb_module_idx(struct lyb_print *lp, const struct lys_module *module, uint32_t *idx)
+{
+    const struct lys_module **mods;
+    uint32_t i;
+
+    if ((lp->mod_last < lp->mod_count) && (lp->mods[lp->mod_last] == module)) {
+        *idx = lp->mod_last;
+        return EXIT_SUCCESS;
+    }
+
+    for (i = 0; i < lp->mod_count; ++i) {
+        if (lp->mods[i] == module) {
+            break;
+        }
+    }
+    if (i == lp->mod_count) {
+        mods = ly_realloc(lp->mods, (lp->mod_count + 1) * sizeof *lp->mods);
+        if (!mods) {
+            lp->mods = NULL;
+            LOGMEM;
+            return EXIT_FAILURE;
+        }
+        lp->mods = mods;
+        lp->mods[lp->mod_count++] = module;
+    }
+
+    *idx = lp->mod_last = i;
+    return EXIT_SUCCESS;
+}
+
+static int
+lyb_print_attrs(struct lyb_print *lp, const struct lyd_node *node)
+{
+    const struct lyd_attr *attr;
+    uint32_t count = 0;
+
+    LY_TREE_FOR(node->attr, attr) {
+        ++count;
+    }
+    if (lyb_write_num(lp, count)) {
+        return EXIT_FAILURE;
+    }
+
+    LY_TREE_FOR(node->attr, attr) {
+        if (lyb_write_str(lp, lys_main_module(attr->annotation->module)->name) || lyb_write_str(lp, attr->name)
+                || lyb_write_str(lp, attr->value_str)) {
+            return EXIT_FAILURE;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Learn whether the value of a leaf has to be stored as the string only. Identities, instance-identifiers,
+ * leafrefs and unions refer to other schema or data nodes, so they are parsed again.
+ */
+static int
+lyb_value_strval(const struct lyd_node_leaf_list *leaf)
+{
+    LY_DATA_TYPE base = ((struct lys_node_leaf *)leaf->schema)->type.base;
+
+    switch (base) {
+    case LY_TYPE_IDENT:
+    case LY_TYPE_INST:
+    case LY_TYPE_LEAFREF:
+    case LY_TYPE_UNION:
+        return 1;
+    default:
+        return (leaf->value_type != base);
+    }
+}
+
+static int
+lyb_print_value(struct lyb_print *lp, const struct lyd_node_leaf_list *leaf)
+{
+    struct lys_type *type = &((struct lys_node_leaf *)leaf->schema)->type;
+    uint64_t bitmap;
+    int i, j;
+
+    switch (type->base) {
+    case LY_TYPE_BINARY:
+    case LY_TYPE_STRING:
+    case LY_TYPE_EMPTY:
+        /* the string is the value */
+        return EXIT_SUCCESS;
+    case LY_TYPE_BOOL:
+        return lyb_write_fixed(lp, leaf->value.bln ? 1 : 0, 1);
+    case LY_TYPE_INT8:
+    case LY_TYPE_UINT8:
+        return lyb_write_fixed(lp, leaf->value.uint8, 1);
+    case LY_TYPE_INT16:
+    case LY_TYPE_UINT16:
+        return lyb_write_fixed(lp, leaf->value.uint16, 2);
+    case LY_TYPE_INT32:
+    case LY_TYPE_UINT32:
+        return lyb_write_fixed(lp, leaf->value.uint32, 4);
+    case LY_TYPE_INT64:
+    case LY_TYPE_UINT64:
+    case LY_TYPE_DEC64:
+        return lyb_write_fixed(lp, leaf->value.uint64, 8);
+    case LY_TYPE_ENUM:
+        for (; !type->info.enums.count; type = &type->der->type);
+        return lyb_write_num(lp, leaf->value.enm - type->info.enums.enm);
+    case LY_TYPE_BITS:
+        for (; !type->info.bits.count; type = &type->der->type);
+        /* bitmap of the set bits, 8 bits in a byte */
+        for (i = 0; i < type->info.bits.count; i += 8) {
+            bitmap = 0;
+            for (j = 0; (j < 8) && (i + j < type->info.bits.count); ++j) {
+                if (leaf->value.bit[i + j]) {
+                    bitmap |= 1 << j;
+                }
+            }
+            if (lyb_write_fixed(lp, bitmap, 1)) {
+                return EXIT_FAILURE;
+            }
+        }
+        return EXIT_SUCCESS;
+    default:
+        LOGINT;
+        return EXIT_FAILURE;
+    }
+}
+
+static int
+lyb_print_anydata(struct lyb_print *lp, const struct lyd_node_anydata *any)
+{
+    char *str = NULL;
+    int ret;
+
+    switch (any->value_type) {
+    case LYD_ANYDATA_CONSTSTRING:
+    case LYD_ANYDATA_SXML:
+    case LYD_ANYDATA_JSON:
+        if (lyb_write_num(lp, any->value_type)) {
+            return EXIT_FAILURE;
+        }
+        return lyb_write_str(lp, any->value.str);
+    case LYD_ANYDATA_DATATREE:
+        /* serialized as XML, the same as in the XML printer */
+        if (lyd_print_mem(&str, any->value.tree, LYD_XML, LYP_WITHSIBLINGS)) {
+            return EXIT_FAILURE;
+        }
+        break;
+    case LYD_ANYDATA_XML:
+        if (lyxml_print_mem(&str, any->value.xml, LYXML_PRINT_SIBLINGS) < 0) {
+            return EXIT_FAILURE;
+        }
+        break;
+    default:
+        LOGINT;
+        return EXIT_FAILURE;
+    }
+
+    ret = lyb_write_num(lp, LYD_ANYDATA_XML) || lyb_write_str(lp, str);
+    free(str);
+    return ret ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+static int
+lyb_print_node(struct lyb_print *lp, const struct lyd_node *node, int toplevel, int options)
+{
+    const struct lyd_node_leaf_list *leaf;
+    const struct lyd_node *child;
+    size_t start;
+    uint32_t idx, pos;
+    uint8_t flags = 0;
+
+    if (!lyd_wd_toprint(node, options)) {
+        return EXIT_SUCCESS;
+    }
+
+    /* the size of the subtree is filled at the end */
+    start = lp->len;
+    if (lyb_write_fixed(lp, 0, 4)) {
+        return EXIT_FAILURE;
+    }
+
+    if (lyb_module_idx(lp, lys_node_module(node->schema), &idx) || lyb_write_num(lp, idx)
+            || lyb_schema_pos(lp, node->schema, &pos) || lyb_write_num(lp, pos)) {
+        return EXIT_FAILURE;
+    }
+    if (toplevel && lyb_write_str(lp, node->schema->name)) {
+        return EXIT_FAILURE;
+    }
+
+    if (node->dflt) {
+        flags |= LYB_NODE_DFLT;
+    }
+    leaf = (const struct lyd_node_leaf_list *)node;
+    if (node->schema->nodetype & (LYS_LEAF | LYS_LEAFLIST)) {
+        if (leaf->value_type == (uint16_t)LY_TYPE_ERR) {
+            flags |= LYB_NODE_NOVAL;
+        } else if (lyb_value_strval(leaf)) {
+            flags |= LYB_NODE_STRVAL;
+        }
+    }
+    if (lyb_write_fixed(lp, flags, 1) || lyb_print_attrs(lp, node)) {
+        return EXIT_FAILURE;
+    }
+
+    switch (node->schema->nodetype) {
+    case LYS_LEAF:
+    case LYS_LEAFLIST:
+        if (lyb_write_str(lp, leaf->value_str)) {
+            return EXIT_FAILURE;
+        }
+        if (!(flags & (LYB_NODE_NOVAL | LYB_NODE_STRVAL)) && lyb_print_value(lp, leaf)) {
+            return EXIT_FAILURE;
+        }
+        break;
+    case LYS_ANYXML:
+    case LYS_ANYDATA:
+        if (lyb_print_anydata(lp, (const struct lyd_node_anydata *)node)) {
+            return EXIT_FAILURE;
+        }
+        break;
+    default:
+        LY_TREE_FOR(node->child, child) {
+            if (lyb_print_node(lp, child, 0, options & ~(LYP_WITHSIBLINGS | LYP_NETCONF))) {
+                return EXIT_FAILURE;
+            }
+        }
+        break;
+    }
+
+    /* the size of the rest of the subtree */
+    idx = lp->len - start - 4;
+    for (pos = 0; pos < 4; ++pos) {
+        lp->buf[start + pos] = (char)(idx >> (8 * pos));
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Write the header and the module table of the printed nodes and then the nodes themselves.
+ */
+static int
+lyb_print_finish(struct lyout *out, struct lyb_print *lp)
+{
+    struct lyb_print head;
+    uint32_t i, total;
+    int ret = EXIT_FAILURE;
+
+    memset(&head, 0, sizeof head);
+    if (lyb_write(&head, LYB_MAGIC, strlen(LYB_MAGIC)) || lyb_write_fixed(&head, LYB_VERSION, 1)
+            || lyb_write_fixed(&head, 0, 4) || lyb_write_num(&head, lp->mod_count)) {
+        goto cleanup;
+    }
+    for (i = 0; i < lp->mod_count; ++i) {
+        if (lyb_write_str(&head, lp->mods[i]->name)
+                || lyb_write_str(&head, lp->mods[i]->rev_size ? lp->mods[i]->rev[0].date : NULL)) {
+            goto cleanup;
+        }
+    }
+
+    total = head.len + lp->len;
+    for (i = 0; i < 4; ++i) {
+        head.buf[LYB_HEADER_SIZE - 4 + i] = (char)(total >> (8 * i));
+    }
+
+    if ((ly_write(out, head.buf, head.len) < 0) || (lp->len && (ly_write(out, lp->buf, lp->len) < 0))) {
+        goto cleanup;
+    }
+    ret = EXIT_SUCCESS;
+
+cleanup:
+    free(head.buf);
+    return ret;
+}
+
+int
+lyb_print_data(struct lyout *out, const struct lyd_node *root, int options)
+{
+    const struct lyd_node *node = NULL, *next;
+    struct lys_node *parent;
+    struct lyb_print lp;
+    struct lyb_pos_group *group;
+    int ret = EXIT_FAILURE;
+
+    memset(&lp, 0, sizeof lp);
+    lp.pos_ht = lyht_new(lyb_pos_equal, NULL);
+    if (!lp.pos_ht) {
+        return EXIT_FAILURE;
+    }
+
+    if (root && (options & LYP_NETCONF)) {
+        /* rpc/action output - skip the RPC/action and its parents, the same as in the XML printer */
+        if (root->schema->nodetype != LYS_RPC) {
+            LY_TREE_DFS_BEGIN(root, next, node) {
+                if (node->schema->nodetype == LYS_ACTION) {
+                    break;
+                }
+                LY_TREE_DFS_END(root, next, node);
+            }
+        } else {
+            node = root;
+        }
+        if (node && node->child) {
+            for (parent = lys_parent(node->child->schema); parent && (parent->nodetype == LYS_USES); parent = lys_parent(parent));
+            if (parent && (parent->nodetype == LYS_OUTPUT)) {
+                root = node->child;
+            }
+        }
+    }
+
+    LY_TREE_FOR(root, node) {
+        if (lyb_print_node(&lp, node, 1, options)) {
+            goto cleanup;
+        }
+        if (!(options & LYP_WITHSIBLINGS)) {
+            break;
+        }
+    }
+
+    ret = lyb_print_finish(out, &lp);
+
+cleanup:
+    while ((group = lp.groups)) {
+        lp.groups = group->next;
+        free(group->recs);
+        free(group);
+    }
+    lyht_free(lp.pos_ht);
+    free(lp.mods);
+    free(lp.buf);
+    ly_print_flush(out);
+    return ret;
+}
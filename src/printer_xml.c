@@ -168,7 +168,7 @@ xml_print_attrs(struct lyout *out, const struct lyd_node *node, int options)
                 xml_expr = transform_json2xml(node->schema->module, attr->value_str, &prefs, &nss, &ns_count);
                 if (!xml_expr) {
                     /* error */
-                    ly_print(out, "\"(!error!)\"");
+                    ly_write(out, "\"(!error!)\"", 11);
                     return;
                 }
 
@@ -225,7 +225,7 @@ printinst:
                                           &prefs, &nss, &ns_count);
             if (!xml_expr) {
                 /* error */
-                ly_print(out, "(!error!)");
+                ly_write(out, "(!error!)", 9);
                 return;
             }
 
@@ -245,10 +245,10 @@ printinst:
 
         default:
             /* error */
-            ly_print(out, "(!error!)");
+            ly_write(out, "(!error!)", 9);
         }
 
-        ly_print(out, "\"");
+        ly_write(out, "\"", 1);
 
         if (xml_expr) {
             lydict_remove(node->schema->module->ctx, xml_expr);
@@ -300,9 +300,9 @@ printvalue:
     case LY_TYPE_UINT32:
     case LY_TYPE_UINT64:
         if (!leaf->value_str || !leaf->value_str[0]) {
-            ly_print(out, "/>");
+            ly_write(out, "/>", 2);
         } else {
-            ly_print(out, ">");
+            ly_write(out, ">", 1);
             lyxml_dump_text(out, leaf->value_str);
             ly_print(out, "</%s>", node->schema->name);
         }
@@ -310,7 +310,7 @@ printvalue:
 
     case LY_TYPE_IDENT:
         if (!leaf->value_str || !leaf->value_str[0]) {
-            ly_print(out, "/>");
+            ly_write(out, "/>", 2);
             break;
         }
         p = strchr(leaf->value_str, ':');
@@ -318,7 +318,7 @@ printvalue:
         len = p - leaf->value_str;
         mod_name = leaf->schema->module->name;
         if (!strncmp(leaf->value_str, mod_name, len) && !mod_name[len]) {
-            ly_print(out, ">");
+            ly_write(out, ">", 1);
             lyxml_dump_text(out, ++p);
             ly_print(out, "</%s>", node->schema->name);
         } else {
@@ -332,7 +332,7 @@ printvalue:
                                       &prefs, &nss, &ns_count);
         if (!xml_expr) {
             /* error */
-            ly_print(out, "\"(!error!)\"");
+            ly_write(out, "\"(!error!)\"", 11);
             return;
         }
 
@@ -343,11 +343,11 @@ printvalue:
         free(nss);
 
         if (xml_expr[0]) {
-            ly_print(out, ">");
+            ly_write(out, ">", 1);
             lyxml_dump_text(out, xml_expr);
             ly_print(out, "</%s>", node->schema->name);
         } else {
-            ly_print(out, "/>");
+            ly_write(out, "/>", 2);
         }
         lydict_remove(node->schema->module->ctx, xml_expr);
         break;
@@ -362,7 +362,7 @@ printvalue:
             type = lyd_leaf_type((struct lyd_node_leaf_list *)leaf);
             if (!type) {
                 /* error */
-                ly_print(out, "\"(!error!)\"");
+                ly_write(out, "\"(!error!)\"", 11);
                 return;
             }
             datatype = type->base;
@@ -372,16 +372,16 @@ printvalue:
         goto printvalue;
 
     case LY_TYPE_EMPTY:
-        ly_print(out, "/>");
+        ly_write(out, "/>", 2);
         break;
 
     default:
         /* error */
-        ly_print(out, "\"(!error!)\"");
+        ly_write(out, "\"(!error!)\"", 11);
     }
 
     if (level) {
-        ly_print(out, "\n");
+        ly_write(out, "\n", 1);
     }
 }
 
@@ -406,10 +406,10 @@ xml_print_container(struct lyout *out, int level, const struct lyd_node *node, i
     xml_print_attrs(out, node, options);
 
     if (!node->child) {
-        ly_print(out, "/>%s", level ? "\n" : "");
+        ly_write(out, "/>\n", level ? 3 : 2);
         return;
     }
-    ly_print(out, ">%s", level ? "\n" : "");
+    ly_write(out, ">\n", level ? 2 : 1);
 
     LY_TREE_FOR(node->child, child) {
         xml_print_node(out, level ? level + 1 : 0, child, 0, options);
@@ -440,10 +440,10 @@ xml_print_list(struct lyout *out, int level, const struct lyd_node *node, int is
         xml_print_attrs(out, node, options);
 
         if (!node->child) {
-            ly_print(out, "/>%s", level ? "\n" : "");
+            ly_write(out, "/>\n", level ? 3 : 2);
             return;
         }
-        ly_print(out, ">%s", level ? "\n" : "");
+        ly_write(out, ">\n", level ? 2 : 1);
 
         LY_TREE_FOR(node->child, child) {
             xml_print_node(out, level ? level + 1 : 0, child, 0, options);
@@ -478,10 +478,10 @@ xml_print_anydata(struct lyout *out, int level, const struct lyd_node *node, int
     xml_print_attrs(out, node, options);
     if (!(void*)any->value.tree || (any->value_type == LYD_ANYDATA_CONSTSTRING && !any->value.str[0])) {
         /* no content */
-        ly_print(out, "/>%s", level ? "\n" : "");
+        ly_write(out, "/>\n", level ? 3 : 2);
     } else {
         /* close opening tag ... */
-        ly_print(out, ">");
+        ly_write(out, ">", 1);
         /* ... and print anydata content */
         switch (any->value_type) {
         case LYD_ANYDATA_CONSTSTRING:
@@ -490,7 +490,7 @@ xml_print_anydata(struct lyout *out, int level, const struct lyd_node *node, int
         case LYD_ANYDATA_DATATREE:
             if (any->value.tree) {
                 if (level) {
-                    ly_print(out, "\n");
+                    ly_write(out, "\n", 1);
                 }
                 LY_TREE_FOR(any->value.tree, iter) {
                     xml_print_node(out, level ? level + 1 : 0, iter, 0, (options & ~(LYP_WITHSIBLINGS | LYP_NETCONF)));
@@ -505,7 +505,7 @@ xml_print_anydata(struct lyout *out, int level, const struct lyd_node *node, int
             break;
         case LYD_ANYDATA_SXML:
             /* print without escaping special characters */
-            ly_print(out, "%s", any->value.str);
+            ly_write(out, any->value.str, strlen(any->value.str));
             break;
         case LYD_ANYDATA_JSON:
             /* JSON format is not supported */
@@ -19,6 +19,7 @@
 #include <string.h>
 #include <ctype.h>
 #include <limits.h>
+#include <pthread.h>
 
 #include "libyang.h"
 #include "resolve.h"
@@ -28,6 +29,7 @@
 #include "parser_yang.h"
 #include "xml_internal.h"
 #include "dict_private.h"
+#include "hash_table.h"
 #include "tree_internal.h"
 #include "extensions.h"
 
@@ -2203,6 +2205,128 @@ check_parsed_values:
     return 0;
 }
 
+/**
+ * @brief Whether values of the type can be searched for in the children index. Identityref values are
+ * matched with an optional module prefix, so they (and the types that can hold them) must be compared sequentially.
+ */
+static int
+resolve_hash_type_allowed(const struct lys_type *type)
+{
+    switch (type->base) {
+    case LY_TYPE_IDENT:
+    case LY_TYPE_LEAFREF:
+    case LY_TYPE_UNION:
+        return 0;
+    default:
+        return 1;
+    }
+}
+
+/**
+ * @brief Try to find the data node identified by a single node-identifier (with predicates) using the children
+ * index of \p parent.
+ *
+ * @param[in] parent Parent of the searched node.
+ * @param[in] mod_name Module name of the node-identifier, NULL if not specified.
+ * @param[in] mod_name_len Length of \p mod_name.
+ * @param[in] prev_mod Module of the previous node-identifier (used if \p mod_name is not specified).
+ * @param[in] name Node name.
+ * @param[in] nam_len Length of \p name.
+ * @param[in] predicate Predicates of the node-identifier.
+ * @param[in] has_predicate Whether there are any predicates.
+ * @param[in] llist_value Expected leaf-list value if there is no predicate.
+ * @param[out] parsed Number of characters of \p predicate processed.
+ * @param[out] match Found node.
+ * @return 1 if found, 0 if there is no such node, -1 if the index cannot be used or the predicates are not
+ * understood, the siblings must be searched sequentially in that case.
+ */
+static int
+resolve_partial_json_data_hash(struct lyd_node *parent, const char *mod_name, int mod_name_len,
+                               const struct lys_module *prev_mod, const char *name, int nam_len, const char *predicate,
+                               int has_predicate, const char *llist_value, int *parsed, struct lyd_node **match)
+{
+    char mod_buf[256];
+    const char *values[256], *pred_name;
+    int val_lens[256], i, r, pred_name_len;
+    const struct lys_module *mod;
+    const struct lys_node *snode;
+    struct lys_node_list *slist;
+
+    *parsed = 0;
+    if (!parent || !parent->ht || !(parent->schema->nodetype & (LYS_CONTAINER | LYS_LIST))) {
+        return -1;
+    }
+
+    if (mod_name) {
+        if (mod_name_len > (signed)(sizeof mod_buf - 1)) {
+            return -1;
+        }
+        memcpy(mod_buf, mod_name, mod_name_len);
+        mod_buf[mod_name_len] = '\0';
+        mod = ly_ctx_get_module(parent->schema->module->ctx, mod_buf, NULL);
+        if (!mod) {
+            return -1;
+        }
+    } else {
+        mod = prev_mod;
+    }
+
+    /* find the schema node */
+    snode = NULL;
+    while ((snode = lys_getnext(snode, parent->schema, NULL, 0))) {
+        if ((lys_node_module(snode) == mod) && !strncmp(snode->name, name, nam_len) && !snode->name[nam_len]) {
+            break;
+        }
+    }
+    if (!snode) {
+        return -1;
+    }
+
+    switch (snode->nodetype) {
+    case LYS_LEAFLIST:
+        if (!resolve_hash_type_allowed(&((struct lys_node_leaflist *)snode)->type)) {
+            return -1;
+        }
+        if (has_predicate) {
+            r = parse_schema_json_predicate(predicate, &pred_name, &pred_name_len, &values[0], &val_lens[0], &has_predicate);
+            if ((r < 1) || (pred_name_len != 1) || (pred_name[0] != '.') || !values[0] || has_predicate) {
+                return -1;
+            }
+            *parsed = r;
+        } else {
+            values[0] = llist_value ? llist_value : "";
+            val_lens[0] = strlen(values[0]);
+        }
+        return lyd_find_hash(parent, snode, values, val_lens, match);
+    case LYS_LIST:
+        slist = (struct lys_node_list *)snode;
+        if (!has_predicate || !slist->keys_size) {
+            return -1;
+        }
+        for (i = 0; i < slist->keys_size; ++i) {
+            if (!has_predicate || !resolve_hash_type_allowed(&slist->keys[i]->type)) {
+                return -1;
+            }
+            r = parse_schema_json_predicate(predicate + *parsed, &pred_name, &pred_name_len, &values[i], &val_lens[i],
+                                            &has_predicate);
+            if ((r < 1) || !values[i] || strncmp(slist->keys[i]->name, pred_name, pred_name_len)
+                    || slist->keys[i]->name[pred_name_len]) {
+                return -1;
+            }
+            *parsed += r;
+        }
+        if (has_predicate) {
+            return -1;
+        }
+        return lyd_find_hash(parent, snode, values, val_lens, match);
+    default:
+        if (has_predicate) {
+            return -1;
+        }
+        return lyd_find_hash(parent, snode, NULL, NULL, match);
+    }
+}
+
 /**
  * @brief get the closest parent of the node (or the node itself) identified by the nodeid (path)
  *
@@ -2250,6 +2374,18 @@ resolve_partial_json_data_nodeid(const char *nodeid, const char *llist_value, st
     while (1) {
         list_instance_position = 0;
 
+        /* try the children index first */
+        ret = resolve_partial_json_data_hash(start ? start->parent : NULL, mod_name, mod_name_len, prev_mod, name,
+                                             nam_len, id, has_predicate, llist_value, &r, &sibling);
+        if (!ret) {
+            /* no match, return last match */
+            return last_match;
+        } else if (ret == 1) {
+            id += r;
+            last_parsed += r;
+            goto match;
+        }
+
         LY_TREE_FOR(start, sibling) {
             /* RPC/action data check, return simply invalid argument, because the data tree is invalid */
             if (lys_parent(sibling->schema)) {
@@ -2373,22 +2509,7 @@ resolve_partial_json_data_nodeid(const char *nodeid, const char *llist_value, st
                     last_parsed += r;
                 }
 
-                *parsed += last_parsed;
-
-                /* the result node? */
-                if (!id[0]) {
-                    return sibling;
-                }
-
-                /* move down the tree, if possible */
-                if (sibling->schema->nodetype & (LYS_LEAF | LYS_LEAFLIST | LYS_ANYDATA)) {
-                    LOGVAL(LYE_PATH_INCHAR, LY_VLOG_NONE, NULL, id[0], id);
-                    *parsed = -1;
-                    return NULL;
-                }
-                last_match = sibling;
-                prev_mod = lyd_node_module(sibling);
-                start = sibling->child;
+                /* match */
                 break;
             }
         }
@@ -2398,6 +2519,24 @@ resolve_partial_json_data_nodeid(const char *nodeid, const char *llist_value, st
             return last_match;
         }
 
+match:
+        *parsed += last_parsed;
+
+        /* the result node? */
+        if (!id[0]) {
+            return sibling;
+        }
+
+        /* move down the tree, if possible */
+        if (sibling->schema->nodetype & (LYS_LEAF | LYS_LEAFLIST | LYS_ANYDATA)) {
+            LOGVAL(LYE_PATH_INCHAR, LY_VLOG_NONE, NULL, id[0], id);
+            *parsed = -1;
+            return NULL;
+        }
+        last_match = sibling;
+        prev_mod = lyd_node_module(sibling);
+        start = sibling->child;
+
         if ((r = parse_schema_nodeid(id, &mod_name, &mod_name_len, &name, &nam_len, &is_relative, &has_predicate)) < 1) {
             LOGVAL(LYE_PATH_INCHAR, LY_VLOG_NONE, NULL, id[-r], &id[-r]);
             *parsed = -1;
@@ -3138,6 +3277,8 @@ check_default(struct lys_type *type, const char **value, struct lys_module *modu
     }
 
 finish:
+    /* the errors may refer to the dummy leaf */
+    ly_err_format();
     if (node.value_type == LY_TYPE_BITS) {
         free(node.value.bit);
     }
@@ -3252,6 +3393,13 @@ resolve_unique(struct lys_node *parent, const char *uniq_str_path, uint8_t *trg_
             }
             rc = -1;
         } else {
+            if (parent->module->ctx->models.flags & LY_CTX_SHAREDGRP) {
+                for (leaf = parent; leaf && leaf->nodetype != LYS_GROUPING; leaf = lys_parent(leaf));
+                if (leaf) {
+                    /* the target can be in a uses sharing its grouping, check it in the instantiated list */
+                    return EXIT_SUCCESS;
+                }
+            }
             LOGVAL(LYE_INARG, LY_VLOG_LYS, parent, uniq_str_path, "unique");
             LOGVAL(LYE_SPEC, LY_VLOG_PREV, NULL, "Target leaf not found.");
             rc = EXIT_FAILURE;
@@ -3574,6 +3722,203 @@ error:
     return rc;
 }
 
+/**
+ * @brief Try to resolve a leafref path node-identifier of a list with path predicates using the children
+ * index of \p parent. Does not log, the caller falls back to resolve_data_node() and
+ * resolve_path_predicate_data() if the index cannot be used.
+ *
+ * @param[in] pred Predicates of the node-identifier.
+ * @param[in] node Leafref data node.
+ * @param[in] prefix Prefix (module name) of the node-identifier, NULL if not specified.
+ * @param[in] pref_len Length of \p prefix.
+ * @param[in] name Name of the node-identifier.
+ * @param[in] nam_len Length of \p name.
+ * @param[in] start Data node to start the search from, used only to learn the default module.
+ * @param[in] parent Parent of the searched list instances.
+ * @param[out] match Found list instance, NULL if there is none.
+ * @param[out] parsed Number of characters of \p pred processed.
+ *
+ * @return 1 if the index was used, 0 if it cannot be used.
+ */
+static int
+resolve_path_predicate_data_hash(const char *pred, struct lyd_node *node, const char *prefix, int pref_len,
+                                 const char *name, int nam_len, struct lyd_node *start, struct lyd_node *parent,
+                                 struct lyd_node **match, int *parsed)
+{
+    char mod_buf[256];
+    const char *values[256], *path_key_expr, *source, *sour_pref, *dest, *dest_pref;
+    int val_lens[256], pke_len, sour_len, sour_pref_len, dest_len, dest_pref_len, pke_parsed;
+    int has_predicate, dest_parent_times, i, k, parsed_loc = 0;
+    struct unres_data dest_match;
+    struct lyd_node_leaf_list *leaf_dst[256], *leaf_src;
+    const struct lys_module *mod;
+    const struct lys_node *snode;
+    struct lys_node_list *slist;
+    struct lyd_node *dest_node;
+
+    if (!parent || !parent->ht || !(parent->schema->nodetype & (LYS_CONTAINER | LYS_LIST))) {
+        return 0;
+    }
+
+    if (prefix) {
+        if (pref_len > (signed)(sizeof mod_buf - 1)) {
+            return 0;
+        }
+        memcpy(mod_buf, prefix, pref_len);
+        mod_buf[pref_len] = '\0';
+        mod = ly_ctx_get_module(parent->schema->module->ctx, mod_buf, NULL);
+    } else {
+        mod = lyd_node_module(start);
+    }
+    if (!mod) {
+        return 0;
+    }
+
+    /* find the list schema node */
+    snode = NULL;
+    while ((snode = lys_getnext(snode, parent->schema, NULL, 0))) {
+        if ((lys_node_module(snode) == mod) && !strncmp(snode->name, name, nam_len) && !snode->name[nam_len]) {
+            break;
+        }
+    }
+    if (!snode || (snode->nodetype != LYS_LIST) || !((struct lys_node_list *)snode)->keys_size) {
+        return 0;
+    }
+    slist = (struct lys_node_list *)snode;
+    for (k = 0; k < slist->keys_size; ++k) {
+        if (!resolve_hash_type_allowed(&slist->keys[k]->type)) {
+            return 0;
+        }
+        values[k] = NULL;
+    }
+
+    /* learn the values of all the keys, every one of them must be compared exactly once */
+    do {
+        if ((i = parse_path_predicate(pred + parsed_loc, &sour_pref, &sour_pref_len, &source, &sour_len,
+                                      &path_key_expr, &pke_len, &has_predicate)) < 1) {
+            return 0;
+        }
+        parsed_loc += i;
+
+        for (k = 0; k < slist->keys_size; ++k) {
+            if (!strncmp(slist->keys[k]->name, source, sour_len) && !slist->keys[k]->name[sour_len]) {
+                break;
+            }
+        }
+        if ((k == slist->keys_size) || values[k]) {
+            return 0;
+        }
+
+        /* destination */
+        dest_node = node;
+        if ((i = parse_path_key_expr(path_key_expr, &dest_pref, &dest_pref_len, &dest, &dest_len,
+                                     &dest_parent_times)) < 1) {
+            return 0;
+        }
+        pke_parsed = i;
+        for (i = 0; i < dest_parent_times; ++i) {
+            dest_node = dest_node->parent;
+            if (!dest_node) {
+                return 0;
+            }
+        }
+        dest_match.count = 0;
+        dest_match.node = NULL;
+        while (1) {
+            if (resolve_data_node(dest_pref, dest_pref_len, dest, dest_len, dest_node, &dest_match)
+                    || (dest_match.count != 1)) {
+                free(dest_match.node);
+                return 0;
+            }
+            dest_node = dest_match.node[0];
+
+            if (pke_len == pke_parsed) {
+                break;
+            }
+            if ((i = parse_path_key_expr(path_key_expr + pke_parsed, &dest_pref, &dest_pref_len, &dest, &dest_len,
+                                         &dest_parent_times)) < 1) {
+                free(dest_match.node);
+                return 0;
+            }
+            pke_parsed += i;
+        }
+        free(dest_match.node);
+
+        leaf_dst[k] = (struct lyd_node_leaf_list *)dest_node;
+        while (leaf_dst[k] && leaf_dst[k]->value_type == LY_TYPE_LEAFREF) {
+            leaf_dst[k] = (struct lyd_node_leaf_list *)leaf_dst[k]->value.leafref;
+        }
+        if (!leaf_dst[k] || !(leaf_dst[k]->schema->nodetype & (LYS_LEAF | LYS_LEAFLIST))) {
+            return 0;
+        }
+        values[k] = leaf_dst[k]->value_str ? leaf_dst[k]->value_str : "";
+        val_lens[k] = strlen(values[k]);
+    } while (has_predicate);
+
+    for (k = 0; k < slist->keys_size; ++k) {
+        if (!values[k]) {
+            return 0;
+        }
+    }
+
+    if ((i = lyd_find_hash(parent, snode, values, val_lens, match)) == -1) {
+        return 0;
+    }
+    if (i) {
+        /* the values are equal, but the types must be as well */
+        for (k = 0; k < slist->keys_size; ++k) {
+            leaf_src = (struct lyd_node_leaf_list *)(*match)->child;
+            while (leaf_src && (leaf_src->schema != (struct lys_node *)slist->keys[k])) {
+                leaf_src = (struct lyd_node_leaf_list *)leaf_src->next;
+            }
+            if (!leaf_src || ((leaf_src->value_type & LY_DATA_TYPE_MASK) != (leaf_dst[k]->value_type & LY_DATA_TYPE_MASK))) {
+                *match = NULL;
+                break;
+            }
+        }
+    } else {
+        *match = NULL;
+    }
+
+    *parsed = parsed_loc;
+    return 1;
+}
+
+/**
+ * @brief Get the first data sibling the first node-identifier of a leafref path is searched among.
+ *
+ * @param[in] node Leafref data node.
+ * @param[in] parent_times Number of ".." at the beginning of the path, -1 for an absolute path.
+ * @return First data sibling.
+ */
+static struct lyd_node *
+resolve_path_arg_data_start(struct lyd_node *node, int parent_times)
+{
+    struct lyd_node *data;
+    int i;
+
+    if (parent_times > 0) {
+        data = node;
+        for (i = 1; i < parent_times; ++i) {
+            data = data->parent;
+        }
+    } else if (!parent_times) {
+        data = node->child;
+    } else {
+        /* absolute path */
+        for (data = node; data->parent; data = data->parent);
+    }
+
+    /* we may still be parsing it and the pointer is not correct yet */
+    if (data->prev) {
+        while (data->prev->next) {
+            data = data->prev;
+        }
+    }
+
+    return data;
+}
+
 /**
  * @brief Resolve a path (leafref) in JSON data context. Logs directly.
  *
@@ -3586,7 +3931,7 @@ error:
 static int
 resolve_path_arg_data(struct lyd_node *node, const char *path, struct unres_data *ret)
 {
-    struct lyd_node *data = NULL;
+    struct lyd_node *data = NULL, *match;
     const char *prefix, *name;
     int pref_len, nam_len, has_predicate, parent_times, i, parsed, rc;
     uint32_t j;
@@ -3607,24 +3952,31 @@ resolve_path_arg_data(struct lyd_node *node, const char *path, struct unres_data
         parsed += i;
 
         if (!ret->count) {
-            if (parent_times > 0) {
-                data = node;
-                for (i = 1; i < parent_times; ++i) {
-                    data = data->parent;
-                }
-            } else if (!parent_times) {
-                data = node->child;
-            } else {
-                /* absolute path */
-                for (data = node; data->parent; data = data->parent);
-            }
+            data = resolve_path_arg_data_start(node, parent_times);
+        }
+
+        /* list instance with predicates, try to find it directly */
+        if (has_predicate && (ret->count < 2)
+                && resolve_path_predicate_data_hash(path, node, prefix, pref_len, name, nam_len, data,
+                                                    ret->count ? ret->node[0] : data->parent, &match, &i)) {
+            path += i;
+            parsed += i;
 
-            /* we may still be parsing it and the pointer is not correct yet */
-            if (data->prev) {
-                while (data->prev->next) {
-                    data = data->prev;
+            if (!match) {
+                rc = EXIT_FAILURE;
+                goto error;
+            }
+            if (!ret->count) {
+                ret->node = malloc(sizeof *ret->node);
+                if (!ret->node) {
+                    LOGMEM;
+                    rc = -1;
+                    goto error;
                 }
+                ret->count = 1;
             }
+            ret->node[0] = match;
+            continue;
         }
 
         /* node identifier */
@@ -4672,6 +5024,16 @@ resolve_uses(struct lys_node_uses *uses, struct unres_schema *unres)
         return EXIT_SUCCESS;
     }
 
+    if ((ctx->models.flags & LY_CTX_SHAREDGRP) && !uses->refine_size && !uses->augment_size) {
+        for (parent = lys_parent((struct lys_node *)uses); parent && parent->nodetype != LYS_GROUPING;
+                parent = lys_parent(parent));
+        if (parent) {
+            /* uses in another grouping, the nodes are copied directly from its grouping when instantiated */
+            uses->flags |= LYS_SHAREDGRP;
+            return EXIT_SUCCESS;
+        }
+    }
+
     /* copy the data nodes from grouping into the uses context */
     LY_TREE_FOR(uses->grp->child, node_aux) {
         if (node_aux->nodetype & LYS_GROUPING) {
@@ -4871,6 +5233,7 @@ resolve_uses(struct lys_node_uses *uses, struct unres_schema *unres)
                 must[j].ref = lydict_insert(ctx, rfn->must[k].ref, 0);
                 must[j].eapptag = lydict_insert(ctx, rfn->must[k].eapptag, 0);
                 must[j].emsg = lydict_insert(ctx, rfn->must[k].emsg, 0);
+                must[j].expr_compiled = NULL;
             }
 
             *old_must = must;
@@ -5336,9 +5699,9 @@ resolve_identref(struct lys_type *type, const char *ident_name, struct lyd_node
         }
     } else {
         /* solving identityref in data - get the (implemented) module from the context */
-        u = 0;
-        while ((imod = (struct lys_module*)ly_ctx_get_module_iter(mod->ctx, &u))) {
-            if (imod->implemented && !strncmp(mod_name, imod->name, mod_name_len) && !imod->name[mod_name_len]) {
+        imod = NULL;
+        while ((imod = ly_ctx_mod_index_next(mod->ctx, mod_name, mod_name_len, 0, imod))) {
+            if (imod->implemented && !imod->disabled) {
                 break;
             }
         }
@@ -5656,7 +6019,7 @@ resolve_must(struct lyd_node *node, int inout_parent, int ignore_fail)
     }
 
     for (i = 0; i < must_size; ++i) {
-        if (lyxp_eval(must[i].expr, node, LYXP_NODE_ELEM, lyd_node_module(node), &set, LYXP_MUST)) {
+        if (lyxp_eval_cached(must[i].expr, &must[i].expr_compiled, node, LYXP_NODE_ELEM, lyd_node_module(node), &set, LYXP_MUST)) {
             return -1;
         }
 
@@ -5827,7 +6190,7 @@ resolve_when_unlink_nodes(struct lys_node *snode, struct lyd_node **node, struct
                      * so if this is the context node, we just use the next top-level node.
                      * Additionally, it can even happen that there are no top-level data nodes left,
                      * all were unlinked, so in this case we pass NULL as the context node/data tree,
-                     * lyxp_eval() can handle this special situation.
+                     * lyxp_eval_cached() can handle this special situation.
                      */
                     if (ctx_node_type == LYXP_NODE_ELEM) {
                         LOGINT;
@@ -5857,7 +6220,7 @@ resolve_when_unlink_nodes(struct lys_node *snode, struct lyd_node **node, struct
                 /* temporarily unlink the node */
                 lyd_unlink_internal(elem, 0);
                 if (*unlinked_nodes) {
-                    if (lyd_insert_after((*unlinked_nodes)->prev, elem)) {
+                    if (lyd_insert_nextto((*unlinked_nodes)->prev, elem, 0, 0)) {
                         LOGINT;
                         return -1;
                     }
@@ -6034,8 +6397,9 @@ resolve_when(struct lyd_node *node, int *result, int ignore_fail)
     if (!(node->schema->nodetype & (LYS_NOTIF | LYS_RPC | LYS_ACTION)) && (((struct lys_node_container *)node->schema)->when)) {
         /* make the node dummy for the evaluation */
         node->validity |= LYD_VAL_INUSE;
-        rc = lyxp_eval(((struct lys_node_container *)node->schema)->when->cond, node, LYXP_NODE_ELEM, lyd_node_module(node),
-                       &set, LYXP_WHEN);
+        rc = lyxp_eval_cached(((struct lys_node_container *)node->schema)->when->cond,
+                              &((struct lys_node_container *)node->schema)->when->cond_compiled, node, LYXP_NODE_ELEM,
+                              lyd_node_module(node), &set, LYXP_WHEN);
         node->validity &= ~LYD_VAL_INUSE;
         if (rc) {
             if (rc == 1) {
@@ -6083,8 +6447,9 @@ resolve_when(struct lyd_node *node, int *result, int ignore_fail)
                 goto cleanup;
             }
 
-            rc = lyxp_eval(((struct lys_node_uses *)sparent)->when->cond, ctx_node, ctx_node_type, lys_node_module(sparent),
-                           &set, LYXP_WHEN);
+            rc = lyxp_eval_cached(((struct lys_node_uses *)sparent)->when->cond,
+                                  &((struct lys_node_uses *)sparent)->when->cond_compiled, ctx_node, ctx_node_type,
+                                  lys_node_module(sparent), &set, LYXP_WHEN);
 
             if (unlinked_nodes && ctx_node) {
                 if (resolve_when_relink_nodes(ctx_node, unlinked_nodes, ctx_node_type)) {
@@ -6133,8 +6498,9 @@ check_augment:
                 goto cleanup;
             }
 
-            rc = lyxp_eval(((struct lys_node_augment *)sparent->parent)->when->cond, ctx_node, ctx_node_type,
-                           lys_node_module(sparent->parent), &set, LYXP_WHEN);
+            rc = lyxp_eval_cached(((struct lys_node_augment *)sparent->parent)->when->cond,
+                                  &((struct lys_node_augment *)sparent->parent)->when->cond_compiled, ctx_node,
+                                  ctx_node_type, lys_node_module(sparent->parent), &set, LYXP_WHEN);
 
             /* reconnect nodes, if ctx_node is NULL then all the nodes were unlinked, but linked together,
              * so the tree did not actually change and there is nothing for us to do
@@ -7279,6 +7645,85 @@ check_instid_ext_dep(const struct lys_node *sleaf, const char *json_instid)
     return 0;
 }
 
+/**
+ * @brief Try to find the data node identified by a single node-identifier of an instance-identifier (with all its
+ * predicates) using the children index of \p parent. Does not log, the caller falls back to resolve_data() and
+ * resolve_instid_predicate().
+ *
+ * @param[in] parent Parent of the searched node.
+ * @param[in] mod Module of the node-identifier.
+ * @param[in] name Node name.
+ * @param[in] nam_len Length of \p name.
+ * @param[in] pred Predicates of the node-identifier.
+ * @param[out] parsed Number of characters of \p pred processed.
+ * @param[out] match Found node.
+ * @return 1 if found, 0 if there is no such node, -1 if the index cannot be used or the predicates are not
+ * understood.
+ */
+static int
+resolve_instid_hash(struct lyd_node *parent, const struct lys_module *mod, const char *name, int nam_len,
+                    const char *pred, int *parsed, struct lyd_node **match)
+{
+    const char *values[256], *model, *pred_name;
+    int val_lens[256], i, r, mod_len, pred_name_len, has_predicate;
+    const struct lys_node *snode;
+    struct lys_node_list *slist;
+
+    *parsed = 0;
+    if (!parent || !parent->ht) {
+        return -1;
+    }
+
+    /* find the schema node */
+    snode = NULL;
+    while ((snode = lys_getnext(snode, parent->schema, NULL, 0))) {
+        if ((lys_node_module(snode) == mod) && !strncmp(snode->name, name, nam_len) && !snode->name[nam_len]) {
+            break;
+        }
+    }
+    if (!snode) {
+        return -1;
+    }
+
+    switch (snode->nodetype) {
+    case LYS_LEAFLIST:
+        r = parse_predicate(pred, NULL, NULL, &pred_name, &pred_name_len, &values[0], &val_lens[0], &has_predicate);
+        if ((r < 1) || (pred_name_len != 1) || (pred_name[0] != '.') || !values[0] || has_predicate) {
+            return -1;
+        }
+        *parsed = r;
+        break;
+    case LYS_LIST:
+        /* all the keys in the schema order */
+        slist = (struct lys_node_list *)snode;
+        if (!slist->keys_size) {
+            return -1;
+        }
+        has_predicate = 1;
+        for (i = 0; i < slist->keys_size; ++i) {
+            if (!has_predicate) {
+                return -1;
+            }
+            r = parse_predicate(pred + *parsed, &model, &mod_len, &pred_name, &pred_name_len, &values[i],
+                                &val_lens[i], &has_predicate);
+            if ((r < 1) || !values[i] || strncmp(snode->module->name, model, mod_len)
+                    || snode->module->name[mod_len] || strncmp(slist->keys[i]->name, pred_name, pred_name_len)
+                    || slist->keys[i]->name[pred_name_len]) {
+                return -1;
+            }
+            *parsed += r;
+        }
+        if (has_predicate) {
+            return -1;
+        }
+        break;
+    default:
+        return -1;
+    }
+
+    return lyd_find_hash(parent, snode, values, val_lens, match);
+}
+
 /**
  * @brief Resolve instance-identifier in JSON data format. Logs directly.
  *
@@ -7291,8 +7736,9 @@ check_instid_ext_dep(const struct lys_node *sleaf, const char *json_instid)
 static int
 resolve_instid(struct lyd_node *data, const char *path, int req_inst, struct lyd_node **ret)
 {
-    int i = 0, j;
+    int i = 0, j, r;
     const struct lys_module *mod;
+    struct lyd_node *node;
     struct ly_ctx *ctx = data->schema->module->ctx;
     const char *model, *name;
     char *str;
@@ -7337,13 +7783,25 @@ resolve_instid(struct lyd_node *data, const char *path, int req_inst, struct lyd
             break;
         }
 
-        if (resolve_data(mod, name, name_len, data, &node_match)) {
-            /* no instance exists */
-            break;
-        }
-
-        if (has_predicate) {
-            /* we have predicate, so the current results must be list or leaf-list */
+        if (has_predicate && (node_match.count == 1)
+                && ((r = resolve_instid_hash(node_match.node[0], mod, name, name_len, &path[i], &j, &node)) > -1)) {
+            i += j;
+            if (!r) {
+                /* no instance exists */
+                unres_data_del(&node_match, 0);
+                break;
+            }
+            node_match.node[0] = node;
+            continue;
+        }
+
+        if (resolve_data(mod, name, name_len, data, &node_match)) {
+            /* no instance exists */
+            break;
+        }
+
+        if (has_predicate) {
+            /* we have predicate, so the current results must be list or leaf-list */
             j = resolve_instid_predicate(&path[i], &node_match);
             if (j < 1) {
                 LOGVAL(LYE_INPRED, LY_VLOG_LYD, data, &path[i-j]);
@@ -7393,33 +7851,247 @@ error:
     return -1;
 }
 
+/**
+ * @brief All the targets of a leafref path (without predicates) searched from a single start node.
+ */
+struct lref_group {
+    const char *path;                /**< leafref path */
+    const struct lyd_node *start;    /**< first data sibling the path is searched from */
+    struct lref_target *targets;     /**< all the target nodes in the data order */
+    struct lref_group *next;         /**< next group in the index */
+};
+
+/**
+ * @brief Target node of a leafref path, found by its value.
+ */
+struct lref_target {
+    const struct lref_group *group;  /**< group of the target */
+    const char *value;               /**< canonical value of the target (dictionary string) */
+    struct lyd_node *node;           /**< target node */
+};
+
+/**
+ * @brief Index of leafref targets valid while no data nodes are added, removed or changed, so that many leafrefs
+ * with the same path do not collect and compare all the targets one by one.
+ */
+struct lref_index {
+    struct hash_table *groups;       /**< (path, start) -> struct lref_group */
+    struct hash_table *targets;      /**< (group, value) -> struct lref_target */
+    struct lref_group *list;         /**< all the groups */
+};
+
+static uint32_t
+lref_index_hash(const void *ptr1, const void *ptr2)
+{
+    return dict_hash_multi(dict_hash_multi(dict_hash_multi(0, (const char *)&ptr1, sizeof ptr1),
+                                           (const char *)&ptr2, sizeof ptr2), NULL, 0);
+}
+
+static int
+lref_group_equal(void *val_searched, void *val_stored, void *UNUSED(cb_data))
+{
+    struct lref_group *searched = val_searched, *stored = val_stored;
+
+    return (searched->path == stored->path) && (searched->start == stored->start);
+}
+
 static int
-resolve_leafref(struct lyd_node_leaf_list *leaf, const char *path, int req_inst, struct lyd_node **ret)
+lref_target_equal(void *val_searched, void *val_stored, void *UNUSED(cb_data))
+{
+    struct lref_target *searched = val_searched, *stored = val_stored;
+
+    return (searched->group == stored->group) && (searched->value == stored->value);
+}
+
+static struct lref_index *
+lref_index_new(void)
 {
+    struct lref_index *index;
+
+    index = calloc(1, sizeof *index);
+    if (!index) {
+        LOGMEM;
+        return NULL;
+    }
+    index->groups = lyht_new(lref_group_equal, NULL);
+    index->targets = lyht_new(lref_target_equal, NULL);
+    if (!index->groups || !index->targets) {
+        lyht_free(index->groups);
+        lyht_free(index->targets);
+        free(index);
+        return NULL;
+    }
+
+    return index;
+}
+
+static void
+lref_index_free(struct lref_index *index)
+{
+    struct lref_group *group;
+
+    if (!index) {
+        return;
+    }
+
+    while ((group = index->list)) {
+        index->list = group->next;
+        free(group->targets);
+        free(group);
+    }
+    lyht_free(index->groups);
+    lyht_free(index->targets);
+    free(index);
+}
+
+/**
+ * @brief Find the targets of a leafref path in the index, collect and add them if they are not there yet.
+ * Logs directly.
+ *
+ * @param[in] index Index to use.
+ * @param[in] leaf Leafref data node.
+ * @param[in] path Path of the leafref, without predicates.
+ * @param[in] start First data sibling the path is searched from.
+ * @param[out] group Group with the targets.
+ * @return EXIT_SUCCESS on success, -1 on error.
+ */
+static int
+lref_index_group(struct lref_index *index, struct lyd_node_leaf_list *leaf, const char *path,
+                 const struct lyd_node *start, struct lref_group **group)
+{
+    struct lref_group key;
     struct unres_data matches;
-    uint32_t i;
+    uint32_t hash, i;
 
-    /* init */
-    memset(&matches, 0, sizeof matches);
-    *ret = NULL;
+    key.path = path;
+    key.start = start;
+    hash = lref_index_hash(path, start);
+    if (!lyht_find(index->groups, &key, hash, (void **)group)) {
+        return EXIT_SUCCESS;
+    }
 
-    /* EXIT_FAILURE return keeps leaf->value.lefref NULL, handled later */
+    /* EXIT_FAILURE means there are no targets */
+    memset(&matches, 0, sizeof matches);
     if (resolve_path_arg_data((struct lyd_node *)leaf, path, &matches) == -1) {
         return -1;
     }
 
-    /* check that value matches */
+    *group = calloc(1, sizeof **group);
+    if (!*group) {
+        LOGMEM;
+        free(matches.node);
+        return -1;
+    }
+    (*group)->path = path;
+    (*group)->start = start;
+    (*group)->next = index->list;
+    index->list = *group;
+    if (matches.count) {
+        (*group)->targets = malloc(matches.count * sizeof *(*group)->targets);
+        if (!(*group)->targets) {
+            LOGMEM;
+            free(matches.node);
+            return -1;
+        }
+    }
+    if (lyht_insert(index->groups, *group, hash)) {
+        free(matches.node);
+        return -1;
+    }
+
+    /* the first of the targets with the same value is found, as if they were compared in order */
     for (i = 0; i < matches.count; ++i) {
-        /* not that the value is already in canonical form since the parsers does the conversion,
-         * so we can simply compare just the values */
-        if (ly_strequal(leaf->value_str, ((struct lyd_node_leaf_list *)matches.node[i])->value_str, 1)) {
-            /* we have the match */
-            *ret = matches.node[i];
-            break;
+        (*group)->targets[i].group = *group;
+        (*group)->targets[i].value = ((struct lyd_node_leaf_list *)matches.node[i])->value_str;
+        (*group)->targets[i].node = matches.node[i];
+        if (lyht_insert(index->targets, &(*group)->targets[i], lref_index_hash(*group, (*group)->targets[i].value))) {
+            free(matches.node);
+            return -1;
         }
     }
 
     free(matches.node);
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Find the target of a leafref using the leafref targets index.
+ *
+ * @param[in] index Index to use.
+ * @param[in] leaf Leafref data node.
+ * @param[in] path Path of the leafref.
+ * @param[out] ret Found target, NULL if there is none.
+ * @return EXIT_SUCCESS on success, EXIT_FAILURE if the index cannot be used for the path, -1 on error.
+ */
+static int
+resolve_leafref_index(struct lref_index *index, struct lyd_node_leaf_list *leaf, const char *path,
+                      struct lyd_node **ret)
+{
+    struct lref_group *group;
+    struct lref_target key, *target;
+    const char *ptr;
+    int parent_times;
+
+    if (strchr(path, '[')) {
+        /* the targets depend on the predicates */
+        return EXIT_FAILURE;
+    }
+
+    if (path[0] == '/') {
+        parent_times = -1;
+    } else {
+        for (parent_times = 0, ptr = path; !strncmp(ptr, "../", 3); ++parent_times, ptr += 3);
+        if (!parent_times) {
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (lref_index_group(index, leaf, path, resolve_path_arg_data_start((struct lyd_node *)leaf, parent_times), &group)) {
+        return -1;
+    }
+
+    key.group = group;
+    key.value = leaf->value_str;
+    if (!lyht_find(index->targets, &key, lref_index_hash(group, leaf->value_str), (void **)&target)) {
+        *ret = target->node;
+    }
+    return EXIT_SUCCESS;
+}
+
+static int
+resolve_leafref(struct lyd_node_leaf_list *leaf, const char *path, int req_inst, struct lref_index *index,
+                struct lyd_node **ret)
+{
+    struct unres_data matches;
+    uint32_t i;
+    int rc;
+
+    /* init */
+    memset(&matches, 0, sizeof matches);
+    *ret = NULL;
+
+    rc = index ? resolve_leafref_index(index, leaf, path, ret) : EXIT_FAILURE;
+    if (rc == -1) {
+        return -1;
+    } else if (rc) {
+        /* EXIT_FAILURE return keeps leaf->value.lefref NULL, handled later */
+        if (resolve_path_arg_data((struct lyd_node *)leaf, path, &matches) == -1) {
+            return -1;
+        }
+
+        /* check that value matches */
+        for (i = 0; i < matches.count; ++i) {
+            /* not that the value is already in canonical form since the parsers does the conversion,
+             * so we can simply compare just the values */
+            if (ly_strequal(leaf->value_str, ((struct lyd_node_leaf_list *)matches.node[i])->value_str, 1)) {
+                /* we have the match */
+                *ret = matches.node[i];
+                break;
+            }
+        }
+
+        free(matches.node);
+    }
 
     if (!*ret) {
         /* reference not found */
@@ -7475,7 +8147,7 @@ resolve_union(struct lyd_node_leaf_list *leaf, struct lys_type *type, int store,
                 req_inst = t->info.lref.req;
             }
 
-            if (!resolve_leafref(leaf, t->info.lref.path, req_inst, &ret)) {
+            if (!resolve_leafref(leaf, t->info.lref.path, req_inst, NULL, &ret)) {
                 if (store) {
                     if (ret && !(leaf->schema->flags & LYS_LEAFREF_DEP)) {
                         /* valid resolved */
@@ -7572,6 +8244,10 @@ resolve_union(struct lyd_node_leaf_list *leaf, struct lys_type *type, int store,
         if (resolved_type) {
             *resolved_type = t;
         }
+        if (store) {
+            /* the value may have been changed into its canonical form */
+            lyd_update_hash((struct lyd_node *)leaf);
+        }
     } else if (!ignore_fail || !type->info.uni.has_ptr_type) {
         /* not found and it is required */
         LOGVAL(LYE_INVAL, LY_VLOG_LYD, leaf, leaf->value_str ? leaf->value_str : "", leaf->schema->name);
@@ -7588,11 +8264,12 @@ resolve_union(struct lyd_node_leaf_list *leaf, struct lys_type *type, int store,
  * @param[in] node Data node to resolve.
  * @param[in] type Type of the unresolved item.
  * @param[in] ignore_fail 0 - no, 1 - yes, 2 - yes, but only for external dependencies.
+ * @param[in] lref_index Index of leafref targets to use, NULL if the data can be changed meanwhile.
  *
  * @return EXIT_SUCCESS on success, EXIT_FAILURE on forward reference, -1 on error.
  */
 int
-resolve_unres_data_item(struct lyd_node *node, enum UNRES_ITEM type, int ignore_fail)
+resolve_unres_data_item(struct lyd_node *node, enum UNRES_ITEM type, int ignore_fail, struct lref_index *lref_index)
 {
     int rc, req_inst, ext_dep;
     struct lyd_node_leaf_list *leaf;
@@ -7611,7 +8288,7 @@ resolve_unres_data_item(struct lyd_node *node, enum UNRES_ITEM type, int ignore_
         } else {
             req_inst = sleaf->type.info.lref.req;
         }
-        rc = resolve_leafref(leaf, sleaf->type.info.lref.path, req_inst, &ret);
+        rc = resolve_leafref(leaf, sleaf->type.info.lref.path, req_inst, lref_index, &ret);
         if (!rc) {
             if (ret && !(leaf->schema->flags & LYS_LEAFREF_DEP)) {
                 /* valid resolved */
@@ -7729,9 +8406,229 @@ unres_data_add(struct unres_data *unres, struct lyd_node *node, enum UNRES_ITEM
     return EXIT_SUCCESS;
 }
 
+/**
+ * @brief Scheduling state of an UNRES_WHEN item.
+ */
+struct when_wait {
+    struct lyd_node *node;  /**< node with the when condition, kept even when the item is changed by auto-delete */
+    uint32_t waiters;       /**< first item waiting for the when condition of the node (index + 1), 0 if none */
+    uint32_t next;          /**< next item waiting for the same node as this one (index + 1), 0 if none */
+};
+
+static uint32_t
+when_node_hash(const struct lyd_node *node)
+{
+    return dict_hash_multi(dict_hash_multi(0, (const char *)&node, sizeof node), NULL, 0);
+}
+
+static int
+when_wait_equal(void *val_searched, void *val_stored, void *UNUSED(cb_data))
+{
+    return ((struct when_wait *)val_stored)->node == val_searched;
+}
+
+static int
+when_node_equal(void *val_searched, void *val_stored, void *UNUSED(cb_data))
+{
+    return val_searched == val_stored;
+}
+
+/**
+ * @brief Check whether a data node is in a subtree unlinked by the auto-delete.
+ *
+ * @param[in] node Data node to check.
+ * @param[in] deleted Hash table of the unlinked subtree roots, NULL if there are none.
+ * @return non-zero if the node is going to be freed, 0 otherwise.
+ */
+static int
+when_node_deleted(const struct lyd_node *node, struct hash_table *deleted)
+{
+    void *match;
+
+    if (!deleted) {
+        return 0;
+    }
+    while (node->parent) {
+        node = node->parent;
+    }
+    return !lyht_find(deleted, (void *)node, when_node_hash(node), &match);
+}
+
+/**
+ * @brief Minimal number of must conditions evaluated by a thread at once.
+ */
+#define UNRES_MUST_PART_MIN 32
+
+/**
+ * @brief Must conditions of unres data items evaluated by several threads.
+ */
+struct unres_must_job {
+    struct unres_data *unres;   /**< unres data structure with the items */
+    uint32_t *items;            /**< indexes of the must items in their order */
+    uint32_t *parts;            /**< index of the first item of each part in items, parts[part_count] is the
+                                     number of the items */
+    uint32_t part_count;        /**< number of the parts */
+    uint32_t next_part;         /**< next part to be evaluated by any of the threads */
+    int ignore_fail;            /**< ignore_fail for resolve_unres_data_item() */
+    int *rc;                    /**< results of all the unres items (by their index) */
+};
+
+/* evaluate the parts of the job until there is none left, used by all the threads */
+static void *
+resolve_unres_must_parts(void *arg)
+{
+    struct unres_must_job *job = (struct unres_must_job *)arg;
+    uint32_t part, i, j;
+    uint8_t hide;
+
+    /* the errors are printed only by the validating thread afterwards */
+    hide = *ly_vlog_hide_location();
+    ly_vlog_hide(1);
+
+    while ((part = __atomic_fetch_add(&job->next_part, 1, __ATOMIC_RELAXED)) < job->part_count) {
+        for (i = job->parts[part]; i < job->parts[part + 1]; i++) {
+            j = job->items[i];
+            job->rc[j] = resolve_unres_data_item(job->unres->node[j], job->unres->type[j], job->ignore_fail, NULL);
+        }
+    }
+
+    ly_vlog_hide(hide);
+    return NULL;
+}
+
+/**
+ * @brief Resolve the remaining unres data items (values and must conditions) with the must conditions evaluated
+ * by several threads. The values can change the data, so they are resolved first (sequentially) and the must
+ * conditions, split into parts by their top-level subtrees, do not change anything. Logs directly, only the
+ * error of the first failed item in the unres order, the same as when resolving the items one by one.
+ *
+ * @param[in] unres Unres data structure to use, after when conditions and leafrefs were resolved.
+ * @param[in] ignore_fail ignore_fail for resolve_unres_data_item().
+ * @param[in] threads Number of threads to use including the calling one.
+ * @param[in,out] evals Number of the item evaluations.
+ *
+ * @return EXIT_SUCCESS on success, -1 on error, 1 if the items are not worth (or possible) evaluating in parallel.
+ */
+static int
+resolve_unres_data_parallel(struct unres_data *unres, int ignore_fail, unsigned int threads, uint32_t *evals)
+{
+    struct unres_must_job job;
+    pthread_t *tids = NULL;
+    const struct lyd_node *root, *prev_root = NULL;
+    uint32_t i, count, fail, part_size, started = 0;
+    int ret = -1;
+
+    for (i = count = 0; i < unres->count; i++) {
+        if ((unres->type[i] == UNRES_MUST) || (unres->type[i] == UNRES_MUST_INOUT)) {
+            count++;
+        }
+    }
+    if (count < 2 * UNRES_MUST_PART_MIN) {
+        return 1;
+    }
+
+    memset(&job, 0, sizeof job);
+    job.unres = unres;
+    job.ignore_fail = ignore_fail;
+    job.items = malloc(count * sizeof *job.items);
+    job.parts = malloc((count + 1) * sizeof *job.parts);
+    job.rc = calloc(unres->count, sizeof *job.rc);
+    tids = malloc((threads - 1) * sizeof *tids);
+    if (!job.items || !job.parts || !job.rc || !tids) {
+        /* resolve them one by one */
+        ret = 1;
+        goto cleanup;
+    }
+
+    /* values first, until the first error */
+    for (fail = 0; fail < unres->count; fail++) {
+        if ((unres->type[fail] == UNRES_RESOLVED) || (unres->type[fail] == UNRES_MUST)
+                || (unres->type[fail] == UNRES_MUST_INOUT)) {
+            continue;
+        }
+
+        (*evals)++;
+        if (resolve_unres_data_item(unres->node[fail], unres->type[fail], ignore_fail, NULL)) {
+            break;
+        }
+        unres->type[fail] = UNRES_RESOLVED;
+    }
+
+    /* split the must conditions preceding the failed value (if any), by their top-level subtrees and the parts
+     * of large subtrees, so that there are enough parts for all the threads */
+    part_size = count / (4 * threads);
+    if (part_size < UNRES_MUST_PART_MIN) {
+        part_size = UNRES_MUST_PART_MIN;
+    }
+    count = 0;
+    for (i = 0; i < fail; i++) {
+        if ((unres->type[i] != UNRES_MUST) && (unres->type[i] != UNRES_MUST_INOUT)) {
+            continue;
+        }
+
+        for (root = unres->node[i]; root->parent; root = root->parent);
+        if (!job.part_count || (root != prev_root) || (count - job.parts[job.part_count - 1] == part_size)) {
+            job.parts[job.part_count++] = count;
+            prev_root = root;
+        }
+        job.items[count++] = i;
+    }
+    job.parts[job.part_count] = count;
+
+    /* evaluate them, the calling thread as well */
+    for (started = 0; (started < threads - 1) && (started + 1 < job.part_count); started++) {
+        if (pthread_create(&tids[started], NULL, resolve_unres_must_parts, &job)) {
+            /* let the already started threads (or this one) evaluate all the parts */
+            break;
+        }
+    }
+    resolve_unres_must_parts(&job);
+    for (i = 0; i < started; i++) {
+        pthread_join(tids[i], NULL);
+    }
+    (*evals) += count;
+
+    /* the first failed item, the must conditions are in the unres order */
+    for (i = 0; i < count; i++) {
+        if (job.rc[job.items[i]]) {
+            fail = job.items[i];
+            break;
+        }
+    }
+    if (fail < unres->count) {
+        ly_err_clean(1);
+        ly_vlog_hide(0);
+        /* print only the error of this item */
+        resolve_unres_data_item(unres->node[fail], unres->type[fail], ignore_fail, NULL);
+        ly_vlog_hide(1);
+        goto cleanup;
+    }
+
+    for (i = 0; i < count; i++) {
+        unres->type[job.items[i]] = UNRES_RESOLVED;
+    }
+    ret = EXIT_SUCCESS;
+
+cleanup:
+    free(job.items);
+    free(job.parts);
+    free(job.rc);
+    free(tids);
+    return ret;
+}
+
 /**
  * @brief Resolve every unres data item in the structure. Logs directly.
  *
+ * When conditions are evaluated only after the when conditions of all the parents and of all the nodes the
+ * condition refers to. Every item waits for the first such node with a not yet resolved condition (as reported
+ * by XPath in ly_err::inwhen) and it is evaluated again only after that condition is resolved, so each item is
+ * evaluated only a few times regardless of the order of the items. The remaining items are all evaluated
+ * again only if the data tree was changed by the auto-delete meanwhile.
+ *
+ * The must conditions are evaluated by several threads if the context is set so by ly_ctx_set_validation_threads(),
+ * see resolve_unres_data_parallel(). The numbers of the evaluations are added to ly_err::stats.
+ *
  * If options includes LYD_OPT_TRUSTED, the data are considered trusted (when, must conditions are not expected,
  * unresolved leafrefs/instids are accepted).
  *
@@ -7746,9 +8643,16 @@ unres_data_add(struct unres_data *unres, struct lyd_node *node, enum UNRES_ITEM
 int
 resolve_unres_data(struct unres_data *unres, struct lyd_node **root, int options)
 {
-    uint32_t i, j, first, resolved, del_items, stmt_count;
-    int rc, progress, ignore_fail;
+    uint32_t i, j, resolved, swept, del_items, stmt_count, *queue = NULL, qhead, qlen;
+    uint32_t when_evals = 0, lref_evals = 0, other_evals = 0;
+    struct lyd_val_stats *stats;
+    unsigned int threads;
+    int rc, ignore_fail, ret = -1;
     struct lyd_node *parent;
+    const struct lyd_node *dep;
+    struct lref_index *lref_index = NULL;
+    struct when_wait *wait = NULL, *blocker;
+    struct hash_table *pending = NULL, *deleted = NULL;
 
     assert(root);
     assert(unres);
@@ -7756,6 +8660,7 @@ resolve_unres_data(struct unres_data *unres, struct lyd_node **root, int options
     if (!unres->count) {
         return EXIT_SUCCESS;
     }
+    threads = ly_ctx_get_validation_threads(unres->node[0]->schema->module->ctx);
 
     if (options & (LYD_OPT_TRUSTED | LYD_OPT_NOTIF_FILTER | LYD_OPT_GET | LYD_OPT_GETCONFIG | LYD_OPT_EDIT)) {
         ignore_fail = 1;
@@ -7768,123 +8673,179 @@ resolve_unres_data(struct unres_data *unres, struct lyd_node **root, int options
     LOGVRB("Resolving unresolved data nodes and their constraints...");
     ly_vlog_hide(1);
 
-    /* when-stmt first */
-    first = 1;
+    /* when-stmt first, every item is pending until resolved, queued or waiting for another when-stmt */
     stmt_count = 0;
+    for (i = 0; i < unres->count; i++) {
+        if (unres->type[i] == UNRES_WHEN) {
+            stmt_count++;
+        }
+    }
+    if (stmt_count) {
+        wait = calloc(unres->count, sizeof *wait);
+        queue = malloc(stmt_count * sizeof *queue);
+        pending = lyht_new(when_wait_equal, NULL);
+        if (!wait || !queue || !pending) {
+            LOGMEM;
+            goto cleanup;
+        }
+    }
+    qhead = 0;
+    qlen = 0;
+    for (i = 0; i < unres->count; i++) {
+        if (unres->type[i] != UNRES_WHEN) {
+            continue;
+        }
+        wait[i].node = unres->node[i];
+        if (lyht_insert(pending, &wait[i], when_node_hash(wait[i].node))) {
+            LOGMEM;
+            goto cleanup;
+        }
+        queue[qlen++] = i;
+    }
+
+    ly_err_clean(1);
     resolved = 0;
+    swept = 0;
     del_items = 0;
-    do {
-        ly_err_clean(1);
-        progress = 0;
-        for (i = 0; i < unres->count; i++) {
-            if (unres->type[i] != UNRES_WHEN) {
-                continue;
-            }
-            if (first) {
-                /* count when-stmt nodes in unres list */
-                stmt_count++;
+    while (resolved < stmt_count) {
+        if (!qlen) {
+            if (resolved == swept) {
+                /* no progress since all the remaining items were evaluated */
+                break;
             }
 
-            /* resolve when condition only when all parent when conditions are already resolved */
-            for (parent = unres->node[i]->parent;
-                 parent && LYD_WHEN_DONE(parent->when_status);
-                 parent = parent->parent) {
-                if (!parent->parent && (parent->when_status & LYD_WHEN_FALSE)) {
-                    /* the parent node was already unlinked, do not resolve this node,
-                     *  it will be removed anyway, so just mark it as resolved
-                     */
-                    unres->node[i]->when_status |= LYD_WHEN_FALSE;
-                    unres->type[i] = UNRES_RESOLVED;
-                    resolved++;
-                    break;
+            /* the data tree was changed by the auto-delete, the nodes that the items were waiting for
+             * may not be accessible anymore, so evaluate all the remaining items again */
+            swept = resolved;
+            ly_err_clean(1);
+            for (i = 0; i < unres->count; i++) {
+                if (unres->type[i] == UNRES_WHEN) {
+                    wait[i].waiters = 0;
+                    queue[(qhead + qlen++) % stmt_count] = i;
                 }
             }
-            if (parent) {
-                continue;
-            }
-
-            rc = resolve_unres_data_item(unres->node[i], unres->type[i], ignore_fail);
-            if (!rc) {
-                if (unres->node[i]->when_status & LYD_WHEN_FALSE) {
-                    if ((options & LYD_OPT_NOAUTODEL) && !unres->node[i]->dflt) {
-                        /* false when condition */
-                        ly_vlog_hide(0);
-                        ly_err_repeat();
-                        return -1;
-                    } /* follows else */
+            continue;
+        }
+        i = queue[qhead];
+        qhead = (qhead + 1) % stmt_count;
+        qlen--;
 
-                    /* auto-delete */
-                    LOGVRB("auto-delete node \"%s\" due to when condition (%s)", ly_errpath(),
-                           ((struct lys_node_leaf *)unres->node[i]->schema)->when->cond);
+        /* resolve when condition only when all parent when conditions are already resolved */
+        for (parent = unres->node[i]->parent;
+             parent && LYD_WHEN_DONE(parent->when_status);
+             parent = parent->parent);
+        if (parent) {
+            dep = parent;
+            goto wait_for;
+        }
 
-                    /* only unlink now, the subtree can contain another nodes stored in the unres list */
-                    /* if it has parent non-presence containers that would be empty, we should actually
-                     * remove the container
-                     */
-                    for (parent = unres->node[i];
-                            parent->parent && parent->parent->schema->nodetype == LYS_CONTAINER;
-                            parent = parent->parent) {
-                        if (((struct lys_node_container *)parent->parent->schema)->presence) {
-                            /* presence container */
-                            break;
-                        }
-                        if (parent->next || parent->prev != parent) {
-                            /* non empty (the child we are in and we are going to remove is not the only child) */
-                            break;
-                        }
-                    }
-                    unres->node[i] = parent;
+        if (when_node_deleted(unres->node[i], deleted)) {
+            /* the node was already unlinked, do not resolve it, it will be removed anyway,
+             * so just mark it as resolved
+             */
+            unres->node[i]->when_status |= LYD_WHEN_FALSE;
+            unres->type[i] = UNRES_RESOLVED;
+            goto resolved;
+        }
 
-                    if (*root && *root == unres->node[i]) {
-                        *root = (*root)->next;
-                    }
+        ly_err_location()->inwhen = NULL;
+        when_evals++;
+        rc = resolve_unres_data_item(unres->node[i], unres->type[i], ignore_fail, NULL);
+        if (rc == -1) {
+            ly_vlog_hide(0);
+            /* print only this last error */
+            resolve_unres_data_item(unres->node[i], unres->type[i], ignore_fail, NULL);
+            goto cleanup;
+        } else if (rc) {
+            /* forward reference */
+            dep = ly_err_location()->inwhen;
+            goto wait_for;
+        }
 
-                    lyd_unlink(unres->node[i]);
-                    unres->type[i] = UNRES_DELETE;
-                    del_items++;
+        if (unres->node[i]->when_status & LYD_WHEN_FALSE) {
+            if ((options & LYD_OPT_NOAUTODEL) && !unres->node[i]->dflt) {
+                /* false when condition */
+                ly_vlog_hide(0);
+                ly_err_repeat();
+                goto cleanup;
+            } /* follows else */
 
-                    /* update the rest of unres items */
-                    for (j = 0; j < unres->count; j++) {
-                        if (unres->type[j] == UNRES_RESOLVED || unres->type[j] == UNRES_DELETE) {
-                            continue;
-                        }
+            /* auto-delete */
+            LOGVRB("auto-delete node \"%s\" due to when condition (%s)", ly_errpath(),
+                   ((struct lys_node_leaf *)unres->node[i]->schema)->when->cond);
 
-                        /* test if the node is in subtree to be deleted */
-                        for (parent = unres->node[j]; parent; parent = parent->parent) {
-                            if (parent == unres->node[i]) {
-                                /* yes, it is */
-                                unres->type[j] = UNRES_RESOLVED;
-                                resolved++;
-                                break;
-                            }
-                        }
-                    }
-                } else {
-                    unres->type[i] = UNRES_RESOLVED;
+            /* only unlink now, the subtree can contain another nodes stored in the unres list */
+            /* if it has parent non-presence containers that would be empty, we should actually
+             * remove the container
+             */
+            for (parent = unres->node[i];
+                    parent->parent && parent->parent->schema->nodetype == LYS_CONTAINER;
+                    parent = parent->parent) {
+                if (((struct lys_node_container *)parent->parent->schema)->presence) {
+                    /* presence container */
+                    break;
                 }
-                ly_err_clean(1);
-                resolved++;
-                progress = 1;
-            } else if (rc == -1) {
-                ly_vlog_hide(0);
-                /* print only this last error */
-                resolve_unres_data_item(unres->node[i], unres->type[i], ignore_fail);
-                return -1;
-            } /* else forward reference */
+                if (parent->next || parent->prev != parent) {
+                    /* non empty (the child we are in and we are going to remove is not the only child) */
+                    break;
+                }
+            }
+            unres->node[i] = parent;
+
+            if (*root && *root == unres->node[i]) {
+                *root = (*root)->next;
+            }
+
+            lyd_unlink(unres->node[i]);
+            unres->type[i] = UNRES_DELETE;
+            del_items++;
+
+            /* the rest of unres items in the subtree are recognized by its root */
+            if ((!deleted && !(deleted = lyht_new(when_node_equal, NULL)))
+                    || lyht_insert(deleted, unres->node[i], when_node_hash(unres->node[i]))) {
+                LOGMEM;
+                goto cleanup;
+            }
+        } else {
+            unres->type[i] = UNRES_RESOLVED;
+        }
+        ly_err_clean(1);
+
+resolved:
+        resolved++;
+
+        /* queue all the items that were waiting for this one */
+        lyht_remove(pending, &wait[i], when_node_hash(wait[i].node));
+        for (j = wait[i].waiters; j; j = wait[j - 1].next) {
+            queue[(qhead + qlen++) % stmt_count] = j - 1;
         }
-        first = 0;
-    } while (progress && resolved < stmt_count);
+        wait[i].waiters = 0;
+        continue;
+
+wait_for:
+        if (dep && !lyht_find(pending, (void *)dep, when_node_hash(dep), (void **)&blocker)) {
+            wait[i].next = blocker->waiters;
+            blocker->waiters = i + 1;
+        } /* else it is evaluated again only if there is any progress */
+    }
 
     /* do we have some unresolved when-stmt? */
     if (stmt_count > resolved) {
         ly_vlog_hide(0);
         ly_err_repeat();
-        return -1;
+        goto cleanup;
     }
 
     for (i = 0; del_items && i < unres->count; i++) {
         /* we had some when-stmt resulted to false, so now we have to sanitize the unres list */
+        if (unres->type[i] == UNRES_RESOLVED) {
+            continue;
+        }
         if (unres->type[i] != UNRES_DELETE) {
+            if (when_node_deleted(unres->node[i], deleted)) {
+                /* the node is in a subtree to be deleted */
+                unres->type[i] = UNRES_RESOLVED;
+            }
             continue;
         }
         if (!unres->node[i]) {
@@ -7893,48 +8854,66 @@ resolve_unres_data(struct unres_data *unres, struct lyd_node **root, int options
             continue;
         }
 
-        /* really remove the complete subtree */
-        lyd_free(unres->node[i]);
+        /* really remove the complete subtree, unless the caller still needs it */
+        if (unres->unlinked) {
+            ly_set_add(unres->unlinked, unres->node[i], LY_SET_OPT_USEASLIST);
+        } else {
+            lyd_free(unres->node[i]);
+        }
         unres->type[i] = UNRES_RESOLVED;
         del_items--;
     }
 
-    /* now leafrefs */
-    first = 1;
+    /* now leafrefs, the data tree is not changed until all of them are resolved, so a missing target
+     * cannot appear meanwhile and every leafref is evaluated just once */
     stmt_count = 0;
     resolved = 0;
-    do {
-        progress = 0;
-        for (i = 0; i < unres->count; i++) {
-            if (unres->type[i] != UNRES_LEAFREF) {
-                continue;
-            }
-            if (first) {
-                /* count leafref nodes in unres list */
-                stmt_count++;
-            }
+    for (i = 0; i < unres->count; i++) {
+        if (unres->type[i] != UNRES_LEAFREF) {
+            continue;
+        }
+        stmt_count++;
 
-            rc = resolve_unres_data_item(unres->node[i], unres->type[i], ignore_fail);
-            if (!rc) {
-                unres->type[i] = UNRES_RESOLVED;
-                ly_err_clean(1);
-                resolved++;
-                progress = 1;
-            } else if (rc == -1) {
-                ly_vlog_hide(0);
-                /* print only this last error */
-                resolve_unres_data_item(unres->node[i], unres->type[i], ignore_fail);
-                return -1;
-            } /* else forward reference */
+        if (!lref_index && !(lref_index = lref_index_new())) {
+            ly_vlog_hide(0);
+            goto cleanup;
+        }
+
+        lref_evals++;
+        rc = resolve_unres_data_item(unres->node[i], unres->type[i], ignore_fail, lref_index);
+        if (!rc) {
+            unres->type[i] = UNRES_RESOLVED;
+            ly_err_clean(1);
+            resolved++;
+        } else if (rc == -1) {
+            ly_vlog_hide(0);
+            /* print only this last error */
+            resolve_unres_data_item(unres->node[i], unres->type[i], ignore_fail, NULL);
+            goto cleanup;
         }
-        first = 0;
-    } while (progress && resolved < stmt_count);
+    }
 
     /* do we have some unresolved leafrefs? */
     if (stmt_count > resolved) {
+        /* errors of the leafrefs preceding the last resolved one were cleaned, so print them all again */
+        ly_err_clean(1);
+        for (i = 0; i < unres->count; i++) {
+            if (unres->type[i] == UNRES_LEAFREF) {
+                resolve_unres_data_item(unres->node[i], unres->type[i], ignore_fail, lref_index);
+            }
+        }
         ly_vlog_hide(0);
         ly_err_repeat();
-        return -1;
+        goto cleanup;
+    }
+
+    if (threads > 1) {
+        /* rest, in parallel */
+        rc = resolve_unres_data_parallel(unres, ignore_fail, threads, &other_evals);
+        if (rc == -1) {
+            ly_vlog_hide(0);
+            goto cleanup;
+        }
     }
 
     ly_vlog_hide(0);
@@ -7946,16 +8925,31 @@ resolve_unres_data(struct unres_data *unres, struct lyd_node **root, int options
         }
         assert(!(options & LYD_OPT_TRUSTED) || ((unres->type[i] != UNRES_MUST) && (unres->type[i] != UNRES_MUST_INOUT)));
 
-        rc = resolve_unres_data_item(unres->node[i], unres->type[i], ignore_fail);
+        other_evals++;
+        rc = resolve_unres_data_item(unres->node[i], unres->type[i], ignore_fail, NULL);
         if (rc) {
             /* since when was already resolved, a forward reference is an error */
-            return -1;
+            goto cleanup;
         }
 
         unres->type[i] = UNRES_RESOLVED;
     }
 
-    LOGVRB("All data nodes and constraints resolved.");
+    LOGVRB("All data nodes and constraints resolved (%u when, %u leafref and %u other evaluations).",
+           when_evals, lref_evals, other_evals);
     unres->count = 0;
-    return EXIT_SUCCESS;
+    ret = EXIT_SUCCESS;
+
+cleanup:
+    stats = &ly_err_location()->stats;
+    stats->when += when_evals;
+    stats->leafref += lref_evals;
+    stats->other += other_evals;
+
+    lref_index_free(lref_index);
+    lyht_free(pending);
+    lyht_free(deleted);
+    free(wait);
+    free(queue);
+    return ret;
 }
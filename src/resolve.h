@@ -85,6 +85,8 @@ struct unres_list_uniq {
     uint8_t *trg_type;
 };
 
+struct lref_index;
+
 /**
  * @brief Unresolved items in DATA
  */
@@ -92,6 +94,7 @@ struct unres_data {
     struct lyd_node **node;
     enum UNRES_ITEM *type;
     uint32_t count;
+    struct ly_set *unlinked;    /* if set, the auto-deleted subtrees are only unlinked and added here */
 };
 
 /**
@@ -230,7 +233,7 @@ void unres_schema_free(struct lys_module *module, struct unres_schema **unres, i
 int resolve_union(struct lyd_node_leaf_list *leaf, struct lys_type *type, int store, int ignore_fail,
                   struct lys_type **resolved_type);
 
-int resolve_unres_data_item(struct lyd_node *dnode, enum UNRES_ITEM type, int ignore_fail);
+int resolve_unres_data_item(struct lyd_node *dnode, enum UNRES_ITEM type, int ignore_fail, struct lref_index *lref_index);
 
 int unres_data_addonly(struct unres_data *unres, struct lyd_node *node, enum UNRES_ITEM type);
 int unres_data_add(struct unres_data *unres, struct lyd_node *node, enum UNRES_ITEM type);
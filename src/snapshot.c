@@ -0,0 +1,2705 @@
+/**
+ * @file snapshot.c
+ * @brief Snapshots of the compiled schemas of a context for fast loading
+ *
+ * Copyright (c) 2017 CESNET, z.s.p.o.
+ *
+ * This source code is licensed under BSD 3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/BSD-3-Clause
+ */
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "libyang.h"
+#include "common.h"
+#include "context.h"
+#include "extensions.h"
+#include "parser.h"
+#include "resolve.h"
+#include "tree_internal.h"
+
+/**
+ * @brief Growing array of records of any size.
+ */
+struct snap_list {
+    void *items;
+    uint32_t count;
+    uint32_t size;
+};
+
+/**
+ * @brief Add a new (zeroed) record at the end of a list.
+ *
+ * @param[in] list List to add to.
+ * @param[in] item Size of the records.
+ * @param[in,out] err Error flag, nothing is added if it is set, it is set on failure.
+ * @return Pointer to the new record, NULL on error.
+ */
+static void *
+snap_list_add(struct snap_list *list, size_t item, int *err)
+{
+    void *items;
+    uint32_t size;
+
+    if (*err) {
+        return NULL;
+    }
+    if (list->count == list->size) {
+        size = list->size ? list->size * 2 : 64;
+        items = realloc(list->items, size * item);
+        if (!items) {
+            LOGMEM;
+            *err = 1;
+            return NULL;
+        }
+        list->items = items;
+        list->size = size;
+    }
+
+    items = (char *)list->items + list->count++ * item;
+    memset(items, 0, item);
+    return items;
+}
+
+/**
+ * @brief Get the size of the structure of a schema node.
+ */
+static size_t
+snap_node_size(LYS_NODE nodetype)
+{
+    switch (nodetype) {
+    case LYS_CONTAINER:
+        return sizeof(struct lys_node_container);
+    case LYS_CHOICE:
+        return sizeof(struct lys_node_choice);
+    case LYS_LEAF:
+        return sizeof(struct lys_node_leaf);
+    case LYS_LEAFLIST:
+        return sizeof(struct lys_node_leaflist);
+    case LYS_LIST:
+        return sizeof(struct lys_node_list);
+    case LYS_ANYXML:
+    case LYS_ANYDATA:
+        return sizeof(struct lys_node_anydata);
+    case LYS_CASE:
+        return sizeof(struct lys_node_case);
+    case LYS_NOTIF:
+        return sizeof(struct lys_node_notif);
+    case LYS_RPC:
+    case LYS_ACTION:
+        return sizeof(struct lys_node_rpc_action);
+    case LYS_INPUT:
+    case LYS_OUTPUT:
+        return sizeof(struct lys_node_inout);
+    case LYS_GROUPING:
+        return sizeof(struct lys_node_grp);
+    case LYS_USES:
+        return sizeof(struct lys_node_uses);
+    default:
+        return 0;
+    }
+}
+
+/**
+ * @brief Check whether the content of a complex extension instance substatement is a string (or strings).
+ */
+static int
+snap_substmt_is_str(LY_STMT stmt)
+{
+    switch (stmt) {
+    case LY_STMT_DESCRIPTION:
+    case LY_STMT_REFERENCE:
+    case LY_STMT_UNITS:
+    case LY_STMT_ARGUMENT:
+    case LY_STMT_DEFAULT:
+    case LY_STMT_ERRTAG:
+    case LY_STMT_ERRMSG:
+    case LY_STMT_PREFIX:
+    case LY_STMT_NAMESPACE:
+    case LY_STMT_PRESENCE:
+    case LY_STMT_REVISIONDATE:
+    case LY_STMT_KEY:
+    case LY_STMT_BASE:
+    case LY_STMT_BELONGSTO:
+    case LY_STMT_CONTACT:
+    case LY_STMT_ORGANIZATION:
+    case LY_STMT_PATH:
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+/**
+ * @brief Check whether the content of a complex extension instance substatement is a list of schema nodes.
+ */
+static int
+snap_substmt_is_node(LY_STMT stmt)
+{
+    switch (stmt) {
+    case LY_STMT_ACTION:
+    case LY_STMT_ANYDATA:
+    case LY_STMT_ANYXML:
+    case LY_STMT_CASE:
+    case LY_STMT_CHOICE:
+    case LY_STMT_CONTAINER:
+    case LY_STMT_GROUPING:
+    case LY_STMT_INPUT:
+    case LY_STMT_LEAF:
+    case LY_STMT_LEAFLIST:
+    case LY_STMT_LIST:
+    case LY_STMT_NOTIFICATION:
+    case LY_STMT_OUTPUT:
+    case LY_STMT_RPC:
+    case LY_STMT_USES:
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+/**
+ * @brief Get the number of bytes of the content of a complex extension instance substatement accessed
+ * by the snapshot printer and parser.
+ */
+static size_t
+snap_substmt_size(LY_STMT stmt, int array)
+{
+    if ((stmt == LY_STMT_BELONGSTO) || ((stmt == LY_STMT_ARGUMENT) && array)) {
+        return 2 * sizeof(void *);
+    } else if (stmt == LY_STMT_DIGITS) {
+        return array ? sizeof(void *) : 0;
+    } else if (snap_substmt_is_str(stmt) || snap_substmt_is_node(stmt)) {
+        return sizeof(void *);
+    }
+
+    switch (stmt) {
+    case LY_STMT_MAX:
+    case LY_STMT_MIN:
+    case LY_STMT_POSITION:
+    case LY_STMT_VALUE:
+    case LY_STMT_MODULE:
+    case LY_STMT_UNIQUE:
+    case LY_STMT_TYPE:
+    case LY_STMT_TYPEDEF:
+    case LY_STMT_IFFEATURE:
+    case LY_STMT_LENGTH:
+    case LY_STMT_MUST:
+    case LY_STMT_PATTERN:
+    case LY_STMT_RANGE:
+    case LY_STMT_WHEN:
+    case LY_STMT_REVISION:
+        return sizeof(void *);
+    default:
+        /* scalars stored directly in the content */
+        return 0;
+    }
+}
+
+/*
+ * printer
+ */
+
+/**
+ * @brief Address of a printed object (or a string) and its ID in the snapshot.
+ */
+struct snap_rec {
+    const void *ptr;
+    uint32_t id;
+};
+
+/**
+ * @brief Open-addressing map of the printed addresses to their IDs.
+ */
+struct snap_map {
+    struct snap_rec *recs;
+    uint32_t size;                   /**< always a power of 2 */
+    uint32_t used;
+};
+
+/**
+ * @brief Position of a reference in the printed snapshot to be filled with the ID of the referenced object.
+ */
+struct snap_slot {
+    size_t pos;
+    const void *ptr;
+};
+
+/**
+ * @brief State of a printed snapshot.
+ *
+ * The IDs of the objects are assigned in the order of printing, so the references are filled only at the end, when
+ * all the objects are known. Any error stops the printing - all the following operations are skipped and the error
+ * is returned at the end.
+ */
+struct snap_print {
+    char *buf;
+    size_t len;
+    size_t size;
+    struct snap_map objs;            /**< object address -> its ID */
+    uint32_t obj_count;
+    struct snap_map strs;            /**< dictionary string -> its index in the string table + 1 */
+    struct snap_list str_list;       /**< the string table (struct snap_rec, the ID is the number of references) */
+    struct snap_list slots;          /**< references to fill (struct snap_slot) */
+    int err;
+};
+
+static uint32_t
+snap_map_hash(const void *ptr)
+{
+    uint64_t val = (uintptr_t)ptr;
+
+    /* the lowest bits are the same because of the alignment */
+    val = (val >> 3) * 0x9E3779B97F4A7C15ULL;
+    return (uint32_t)(val >> 32);
+}
+
+/**
+ * @brief Find the record of an address in a map or the free record for it.
+ */
+static struct snap_rec *
+snap_map_find(struct snap_map *map, const void *ptr)
+{
+    uint32_t i;
+
+    if (!map->size) {
+        return NULL;
+    }
+
+    for (i = snap_map_hash(ptr) & (map->size - 1); map->recs[i].ptr && (map->recs[i].ptr != ptr);
+            i = (i + 1) & (map->size - 1));
+    return &map->recs[i];
+}
+
+/**
+ * @brief Insert an address into a map, an already present address keeps its ID.
+ */
+static int
+snap_map_insert(struct snap_map *map, const void *ptr, uint32_t id)
+{
+    struct snap_rec *recs, *rec;
+    uint32_t i, size;
+
+    if ((map->used + 1) * 2 > map->size) {
+        recs = map->recs;
+        size = map->size;
+
+        map->size = size ? size * 2 : 1024;
+        map->recs = calloc(map->size, sizeof *map->recs);
+        if (!map->recs) {
+            LOGMEM;
+            map->recs = recs;
+            map->size = size;
+            return EXIT_FAILURE;
+        }
+        for (i = 0; i < size; ++i) {
+            if (recs[i].ptr) {
+                *snap_map_find(map, recs[i].ptr) = recs[i];
+            }
+        }
+        free(recs);
+    }
+
+    rec = snap_map_find(map, ptr);
+    if (!rec->ptr) {
+        rec->ptr = ptr;
+        rec->id = id;
+        ++map->used;
+    }
+    return EXIT_SUCCESS;
+}
+
+static void
+snap_write(struct snap_print *sp, const void *data, size_t count)
+{
+    char *buf;
+    size_t size;
+
+    if (sp->err) {
+        return;
+    }
+
+    if (sp->len + count > sp->size) {
+        for (size = sp->size ? sp->size : 4096; size < sp->len + count; size <<= 1);
+        buf = realloc(sp->buf, size);
+        if (!buf) {
+            LOGMEM;
+            sp->err = 1;
+            return;
+        }
+        sp->buf = buf;
+        sp->size = size;
+    }
+
+    memcpy(sp->buf + sp->len, data, count);
+    sp->len += count;
+}
+
+/**
+ * @brief Write a number as a variable-length integer (7 bits in a byte, the least significant first).
+ */
+static void
+snap_write_num(struct snap_print *sp, uint64_t num)
+{
+    uint8_t bytes[10];
+    int i = 0;
+
+    while (num > 0x7f) {
+        bytes[i++] = (num & 0x7f) | 0x80;
+        num >>= 7;
+    }
+    bytes[i++] = num;
+
+    snap_write(sp, bytes, i);
+}
+
+/**
+ * @brief Write a string as its index in the string table + 1 (0 for NULL).
+ *
+ * @param[in] sp Printed snapshot.
+ * @param[in] str Dictionary string.
+ * @param[in] counted Whether the reference holds a reference count of the string in the dictionary.
+ */
+static void
+snap_write_str(struct snap_print *sp, const char *str, int counted)
+{
+    struct snap_rec *rec;
+    uint32_t idx;
+
+    if (!str || sp->err) {
+        snap_write_num(sp, 0);
+        return;
+    }
+
+    rec = snap_map_find(&sp->strs, str);
+    if (rec && rec->ptr) {
+        idx = rec->id;
+    } else {
+        rec = snap_list_add(&sp->str_list, sizeof *rec, &sp->err);
+        if (!rec) {
+            return;
+        }
+        rec->ptr = str;
+        idx = sp->str_list.count;
+        if (snap_map_insert(&sp->strs, str, idx)) {
+            sp->err = 1;
+            return;
+        }
+    }
+
+    if (counted) {
+        ((struct snap_rec *)sp->str_list.items)[idx - 1].id++;
+    }
+    snap_write_num(sp, idx);
+}
+
+/**
+ * @brief Write a reference to an object, it is filled at the end of printing.
+ */
+static void
+snap_write_ref(struct snap_print *sp, const void *ptr)
+{
+    struct snap_slot *slot;
+    uint8_t zero[4] = {0, 0, 0, 0};
+
+    if (ptr) {
+        slot = snap_list_add(&sp->slots, sizeof *slot, &sp->err);
+        if (slot) {
+            slot->pos = sp->len;
+            slot->ptr = ptr;
+        }
+    }
+    snap_write(sp, zero, 4);
+}
+
+/**
+ * @brief Assign the next ID to an object that can be referenced.
+ */
+static void
+snap_add_obj(struct snap_print *sp, const void *obj)
+{
+    if (sp->err) {
+        return;
+    }
+
+    if (snap_map_insert(&sp->objs, obj, ++sp->obj_count)) {
+        sp->err = 1;
+    }
+}
+
+typedef void (*snap_print_clb)(struct snap_print *sp, const void *obj);
+
+/**
+ * @brief Print an array of structures - a flag whether it exists, the raw structures and then the pointer members
+ * of each of them. The number of the items is a member of its parent structure.
+ */
+static void
+snap_print_array(struct snap_print *sp, const void *array, uint32_t count, size_t size, snap_print_clb print)
+{
+    uint32_t i;
+
+    if (!array) {
+        snap_write_num(sp, 0);
+        return;
+    }
+
+    snap_write_num(sp, 1);
+    snap_write(sp, array, count * size);
+    for (i = 0; i < count; ++i) {
+        print(sp, (const char *)array + i * size);
+    }
+}
+
+static void
+snap_print_strs(struct snap_print *sp, const char **strs, uint32_t count)
+{
+    uint32_t i;
+
+    if (!strs) {
+        snap_write_num(sp, 0);
+        return;
+    }
+
+    snap_write_num(sp, 1);
+    for (i = 0; i < count; ++i) {
+        snap_write_str(sp, strs[i], 1);
+    }
+}
+
+static void
+snap_print_refs(struct snap_print *sp, void *const *ptrs, uint32_t count)
+{
+    uint32_t i;
+
+    if (!ptrs) {
+        snap_write_num(sp, 0);
+        return;
+    }
+
+    snap_write_num(sp, 1);
+    for (i = 0; i < count; ++i) {
+        snap_write_ref(sp, ptrs[i]);
+    }
+}
+
+static void
+snap_print_set(struct snap_print *sp, const struct ly_set *set)
+{
+    unsigned int i;
+
+    if (!set) {
+        snap_write_num(sp, 0);
+        return;
+    }
+
+    snap_write_num(sp, set->number + 1);
+    for (i = 0; i < set->number; ++i) {
+        snap_write_ref(sp, set->set.g[i]);
+    }
+}
+
+static void snap_print_ext_instance(struct snap_print *sp, const struct lys_ext_instance *ext);
+static void snap_print_siblings(struct snap_print *sp, const struct lys_node *first);
+
+static void
+snap_print_exts(struct snap_print *sp, struct lys_ext_instance **exts, uint8_t size)
+{
+    uint8_t u;
+
+    if (!exts) {
+        snap_write_num(sp, 0);
+        return;
+    }
+
+    snap_write_num(sp, 1);
+    /* the array is referenced by the inherited instances */
+    snap_add_obj(sp, exts);
+    for (u = 0; u < size; ++u) {
+        snap_print_ext_instance(sp, exts[u]);
+    }
+}
+
+static void
+snap_print_restr(struct snap_print *sp, const void *obj)
+{
+    const struct lys_restr *restr = obj;
+
+    snap_add_obj(sp, restr);
+    snap_write_str(sp, restr->expr, 1);
+    snap_write_str(sp, restr->dsc, 1);
+    snap_write_str(sp, restr->ref, 1);
+    snap_write_str(sp, restr->eapptag, 1);
+    snap_write_str(sp, restr->emsg, 1);
+    snap_print_exts(sp, restr->ext, restr->ext_size);
+}
+
+static void
+snap_print_when(struct snap_print *sp, const void *obj)
+{
+    const struct lys_when *when = obj;
+
+    snap_add_obj(sp, when);
+    snap_write_str(sp, when->cond, 1);
+    snap_write_str(sp, when->dsc, 1);
+    snap_write_str(sp, when->ref, 1);
+    snap_print_exts(sp, when->ext, when->ext_size);
+}
+
+static void
+snap_print_iffeature(struct snap_print *sp, const void *obj)
+{
+    const struct lys_iffeature *iff = obj;
+    unsigned int expr_size = 0, feat_size = 0;
+
+    snap_add_obj(sp, iff);
+    resolve_iffeature_getsizes((struct lys_iffeature *)iff, &expr_size, &feat_size);
+    expr_size = expr_size / 4 + (expr_size % 4 ? 1 : 0);
+
+    if (iff->expr) {
+        snap_write_num(sp, expr_size + 1);
+        snap_write(sp, iff->expr, expr_size);
+    } else {
+        snap_write_num(sp, 0);
+    }
+    snap_write_num(sp, feat_size);
+    snap_print_refs(sp, (void *const *)iff->features, feat_size);
+    snap_print_exts(sp, iff->ext, iff->ext_size);
+}
+
+static void
+snap_print_iffeatures(struct snap_print *sp, const struct lys_iffeature *iff, uint8_t size)
+{
+    snap_print_array(sp, iff, size, sizeof *iff, snap_print_iffeature);
+}
+
+static void
+snap_print_unique(struct snap_print *sp, const void *obj)
+{
+    const struct lys_unique *unique = obj;
+
+    snap_add_obj(sp, unique);
+    snap_print_strs(sp, unique->expr, unique->expr_size);
+}
+
+static void
+snap_print_revision(struct snap_print *sp, const void *obj)
+{
+    const struct lys_revision *rev = obj;
+
+    snap_add_obj(sp, rev);
+    snap_write_str(sp, rev->dsc, 1);
+    snap_write_str(sp, rev->ref, 1);
+    snap_print_exts(sp, rev->ext, rev->ext_size);
+}
+
+static void
+snap_print_bit(struct snap_print *sp, const void *obj)
+{
+    const struct lys_type_bit *bit = obj;
+
+    snap_add_obj(sp, bit);
+    snap_write_str(sp, bit->name, 1);
+    snap_write_str(sp, bit->dsc, 1);
+    snap_write_str(sp, bit->ref, 1);
+    snap_print_iffeatures(sp, bit->iffeature, bit->iffeature_size);
+    snap_print_exts(sp, bit->ext, bit->ext_size);
+}
+
+static void
+snap_print_enum(struct snap_print *sp, const void *obj)
+{
+    const struct lys_type_enum *enm = obj;
+
+    snap_add_obj(sp, enm);
+    snap_write_str(sp, enm->name, 1);
+    snap_write_str(sp, enm->dsc, 1);
+    snap_write_str(sp, enm->ref, 1);
+    snap_print_iffeatures(sp, enm->iffeature, enm->iffeature_size);
+    snap_print_exts(sp, enm->ext, enm->ext_size);
+}
+
+static void
+snap_print_type(struct snap_print *sp, const void *obj)
+{
+    const struct lys_type *type = obj;
+
+    snap_add_obj(sp, type);
+    snap_write_str(sp, type->module_name, 1);
+    snap_print_exts(sp, type->ext, type->ext_size);
+    snap_write_ref(sp, type->der);
+    snap_write_ref(sp, type->parent);
+
+    switch (type->base) {
+    case LY_TYPE_BINARY:
+        snap_print_array(sp, type->info.binary.length, 1, sizeof(struct lys_restr), snap_print_restr);
+        break;
+    case LY_TYPE_BITS:
+        snap_print_array(sp, type->info.bits.bit, type->info.bits.count, sizeof *type->info.bits.bit, snap_print_bit);
+        break;
+    case LY_TYPE_DEC64:
+        snap_print_array(sp, type->info.dec64.range, 1, sizeof(struct lys_restr), snap_print_restr);
+        break;
+    case LY_TYPE_ENUM:
+        snap_print_array(sp, type->info.enums.enm, type->info.enums.count, sizeof *type->info.enums.enm,
+                         snap_print_enum);
+        break;
+    case LY_TYPE_IDENT:
+        snap_print_refs(sp, (void *const *)type->info.ident.ref, type->info.ident.count);
+        break;
+    case LY_TYPE_LEAFREF:
+        snap_write_str(sp, type->info.lref.path, 1);
+        snap_write_ref(sp, type->info.lref.target);
+        break;
+    case LY_TYPE_STRING:
+        snap_print_array(sp, type->info.str.length, 1, sizeof(struct lys_restr), snap_print_restr);
+        snap_print_array(sp, type->info.str.patterns, type->info.str.pat_count, sizeof(struct lys_restr),
+                         snap_print_restr);
+        snap_write_num(sp, (type->info.str.pat_count && type->info.str.patterns
+                            && type->info.str.patterns[0].pattern_compiled) ? 1 : 0);
+        break;
+    case LY_TYPE_UNION:
+        snap_print_array(sp, type->info.uni.types, type->info.uni.count, sizeof(struct lys_type), snap_print_type);
+        break;
+    case LY_TYPE_INT8:
+    case LY_TYPE_UINT8:
+    case LY_TYPE_INT16:
+    case LY_TYPE_UINT16:
+    case LY_TYPE_INT32:
+    case LY_TYPE_UINT32:
+    case LY_TYPE_INT64:
+    case LY_TYPE_UINT64:
+        snap_print_array(sp, type->info.num.range, 1, sizeof(struct lys_restr), snap_print_restr);
+        break;
+    default:
+        /* no pointers in the type information */
+        break;
+    }
+}
+
+static void
+snap_print_tpdf(struct snap_print *sp, const void *obj)
+{
+    const struct lys_tpdf *tpdf = obj;
+
+    snap_add_obj(sp, tpdf);
+    snap_write_str(sp, tpdf->name, 1);
+    snap_write_str(sp, tpdf->dsc, 1);
+    snap_write_str(sp, tpdf->ref, 1);
+    snap_write_str(sp, tpdf->units, 1);
+    snap_write_str(sp, tpdf->dflt, 1);
+    snap_print_exts(sp, tpdf->ext, tpdf->ext_size);
+    snap_write_ref(sp, tpdf->module);
+    snap_print_type(sp, &tpdf->type);
+}
+
+static void
+snap_print_ident(struct snap_print *sp, const void *obj)
+{
+    const struct lys_ident *ident = obj;
+
+    snap_add_obj(sp, ident);
+    snap_write_str(sp, ident->name, 1);
+    snap_write_str(sp, ident->dsc, 1);
+    snap_write_str(sp, ident->ref, 1);
+    snap_print_iffeatures(sp, ident->iffeature, ident->iffeature_size);
+    snap_print_exts(sp, ident->ext, ident->ext_size);
+    snap_write_ref(sp, ident->module);
+    snap_print_refs(sp, (void *const *)ident->base, ident->base_size);
+    snap_print_set(sp, ident->der);
+}
+
+static void
+snap_print_feature(struct snap_print *sp, const void *obj)
+{
+    const struct lys_feature *feat = obj;
+
+    snap_add_obj(sp, feat);
+    snap_write_str(sp, feat->name, 1);
+    snap_write_str(sp, feat->dsc, 1);
+    snap_write_str(sp, feat->ref, 1);
+    snap_print_iffeatures(sp, feat->iffeature, feat->iffeature_size);
+    snap_print_exts(sp, feat->ext, feat->ext_size);
+    snap_write_ref(sp, feat->module);
+    snap_print_set(sp, feat->depfeatures);
+}
+
+static void
+snap_print_extdef(struct snap_print *sp, const void *obj)
+{
+    const struct lys_ext *def = obj;
+
+    snap_add_obj(sp, def);
+    snap_write_str(sp, def->name, 1);
+    snap_write_str(sp, def->dsc, 1);
+    snap_write_str(sp, def->ref, 1);
+    snap_write_str(sp, def->argument, 1);
+    snap_print_exts(sp, def->ext, def->ext_size);
+    snap_write_ref(sp, def->module);
+    /* the plugin is found again when loading, just check it is the same kind */
+    snap_write_num(sp, def->plugin ? def->plugin->type + 1 : 0);
+}
+
+static void
+snap_print_import(struct snap_print *sp, const void *obj)
+{
+    const struct lys_import *imp = obj;
+
+    snap_add_obj(sp, imp);
+    snap_write_ref(sp, imp->module);
+    snap_write_str(sp, imp->prefix, 1);
+    snap_write_str(sp, imp->dsc, 1);
+    snap_write_str(sp, imp->ref, 1);
+    snap_print_exts(sp, imp->ext, imp->ext_size);
+}
+
+static void
+snap_print_refine(struct snap_print *sp, const void *obj)
+{
+    const struct lys_refine *rfn = obj;
+
+    snap_add_obj(sp, rfn);
+    snap_write_str(sp, rfn->target_name, 1);
+    snap_write_str(sp, rfn->dsc, 1);
+    snap_write_str(sp, rfn->ref, 1);
+    snap_print_iffeatures(sp, rfn->iffeature, rfn->iffeature_size);
+    snap_print_exts(sp, rfn->ext, rfn->ext_size);
+    snap_write_ref(sp, rfn->module);
+    snap_print_array(sp, rfn->must, rfn->must_size, sizeof *rfn->must, snap_print_restr);
+    snap_print_strs(sp, rfn->dflt, rfn->dflt_size);
+    if (rfn->target_type & LYS_CONTAINER) {
+        snap_write_str(sp, rfn->mod.presence, 1);
+    }
+}
+
+static void
+snap_print_augment(struct snap_print *sp, const void *obj)
+{
+    const struct lys_node_augment *aug = obj;
+
+    snap_add_obj(sp, aug);
+    snap_write_str(sp, aug->target_name, 1);
+    snap_write_str(sp, aug->dsc, 1);
+    snap_write_str(sp, aug->ref, 1);
+    snap_print_iffeatures(sp, aug->iffeature, aug->iffeature_size);
+    snap_print_exts(sp, aug->ext, aug->ext_size);
+    snap_write_ref(sp, aug->module);
+    snap_write_ref(sp, aug->parent);
+    snap_write_ref(sp, aug->child);
+    snap_write_ref(sp, aug->target);
+    snap_print_array(sp, aug->when, 1, sizeof *aug->when, snap_print_when);
+
+    /* children of an applied augment are printed (and owned) by the target */
+    snap_print_siblings(sp, (!aug->target || (aug->flags & LYS_NOTAPPLIED)) ? aug->child : NULL);
+}
+
+static void
+snap_print_deviate(struct snap_print *sp, const void *obj)
+{
+    const struct lys_deviate *dev = obj;
+
+    snap_add_obj(sp, dev);
+    snap_write_str(sp, dev->units, 1);
+    snap_print_strs(sp, dev->dflt, dev->dflt_size);
+    snap_print_exts(sp, dev->ext, dev->ext_size);
+    if (dev->mod == LY_DEVIATE_DEL) {
+        snap_print_array(sp, dev->must, dev->must_size, sizeof *dev->must, snap_print_restr);
+        snap_print_array(sp, dev->unique, dev->unique_size, sizeof *dev->unique, snap_print_unique);
+    } else {
+        /* the added and replaced restrictions belong to the target */
+        snap_write_ref(sp, dev->must);
+        snap_write_ref(sp, dev->unique);
+    }
+    snap_write_ref(sp, dev->type);
+}
+
+static void snap_print_node(struct snap_print *sp, const struct lys_node *node, int shallow);
+
+static void
+snap_print_deviation(struct snap_print *sp, const void *obj)
+{
+    const struct lys_deviation *dev = obj;
+
+    snap_add_obj(sp, dev);
+    snap_write_str(sp, dev->target_name, 1);
+    snap_write_str(sp, dev->dsc, 1);
+    snap_write_str(sp, dev->ref, 1);
+    snap_print_exts(sp, dev->ext, dev->ext_size);
+    snap_print_array(sp, dev->deviate, dev->deviate_size, sizeof *dev->deviate, snap_print_deviate);
+
+    if (!dev->deviate) {
+        snap_write_ref(sp, dev->orig_node);
+    } else if (!dev->orig_node) {
+        snap_write_num(sp, 0);
+    } else {
+        /* the whole removed subtree or only the original node replaced by the deviated one */
+        snap_write_num(sp, 1);
+        snap_print_node(sp, dev->orig_node, dev->deviate[0].mod != LY_DEVIATE_NO);
+    }
+}
+
+/**
+ * @brief Print the content of a substatement of a complex extension instance.
+ */
+static void
+snap_print_substmt(struct snap_print *sp, LY_STMT stmt, int array, void **slot)
+{
+    snap_print_clb print = NULL;
+    size_t size = 0;
+    uint32_t i, n;
+    const char **strs;
+    uint8_t *bytes;
+    uint32_t **nums;
+    void **objs;
+
+    if (snap_substmt_is_str(stmt)) {
+        if (!array) {
+            snap_write_str(sp, ((const char **)slot)[0], 1);
+            if (stmt == LY_STMT_BELONGSTO) {
+                snap_write_str(sp, ((const char **)slot)[1], 1);
+            }
+            return;
+        }
+
+        strs = ((const char ***)slot)[0];
+        for (n = 0; strs && strs[n]; ++n);
+        snap_write_num(sp, strs ? n + 1 : 0);
+        for (i = 0; i < n; ++i) {
+            snap_write_str(sp, strs[i], 1);
+        }
+        if (strs && (stmt == LY_STMT_BELONGSTO)) {
+            for (i = 0; i < n; ++i) {
+                snap_write_str(sp, ((const char ***)slot)[1][i], 1);
+            }
+        } else if (strs && (stmt == LY_STMT_ARGUMENT)) {
+            snap_write(sp, ((uint8_t **)slot)[1], n);
+        }
+        return;
+    } else if (snap_substmt_is_node(stmt)) {
+        snap_write_ref(sp, *slot);
+        snap_print_siblings(sp, *slot);
+        return;
+    }
+
+    switch (stmt) {
+    case LY_STMT_DIGITS:
+        if (array) {
+            bytes = *(uint8_t **)slot;
+            for (n = 0; bytes && bytes[n]; ++n);
+            snap_write_num(sp, bytes ? n + 1 : 0);
+            snap_write(sp, bytes, n);
+        }
+        return;
+    case LY_STMT_MAX:
+    case LY_STMT_MIN:
+    case LY_STMT_POSITION:
+    case LY_STMT_VALUE:
+        if (!array) {
+            nums = (uint32_t **)slot;
+            n = *nums ? 1 : 0;
+            snap_write_num(sp, n);
+        } else {
+            nums = *(uint32_t ***)slot;
+            for (n = 0; nums && nums[n]; ++n);
+            snap_write_num(sp, nums ? n + 1 : 0);
+        }
+        for (i = 0; i < n; ++i) {
+            snap_write_num(sp, *nums[i]);
+        }
+        return;
+    case LY_STMT_MODULE:
+        if (!array) {
+            snap_write_ref(sp, *slot);
+        } else {
+            objs = *(void ***)slot;
+            for (n = 0; objs && objs[n]; ++n);
+            snap_write_num(sp, objs ? n + 1 : 0);
+            for (i = 0; i < n; ++i) {
+                snap_write_ref(sp, objs[i]);
+            }
+        }
+        return;
+    case LY_STMT_UNIQUE:
+        print = snap_print_unique;
+        size = sizeof(struct lys_unique);
+        break;
+    case LY_STMT_TYPE:
+        print = snap_print_type;
+        size = sizeof(struct lys_type);
+        break;
+    case LY_STMT_TYPEDEF:
+        print = snap_print_tpdf;
+        size = sizeof(struct lys_tpdf);
+        break;
+    case LY_STMT_IFFEATURE:
+        print = snap_print_iffeature;
+        size = sizeof(struct lys_iffeature);
+        break;
+    case LY_STMT_LENGTH:
+    case LY_STMT_MUST:
+    case LY_STMT_PATTERN:
+    case LY_STMT_RANGE:
+        print = snap_print_restr;
+        size = sizeof(struct lys_restr);
+        break;
+    case LY_STMT_WHEN:
+        print = snap_print_when;
+        size = sizeof(struct lys_when);
+        break;
+    case LY_STMT_REVISION:
+        print = snap_print_revision;
+        size = sizeof(struct lys_revision);
+        break;
+    default:
+        /* scalars stored directly in the content */
+        return;
+    }
+
+    /* every structure is allocated separately */
+    if (!array) {
+        snap_print_array(sp, *slot, 1, size, print);
+    } else {
+        objs = *(void ***)slot;
+        for (n = 0; objs && objs[n]; ++n);
+        snap_write_num(sp, objs ? n + 1 : 0);
+        for (i = 0; i < n; ++i) {
+            snap_print_array(sp, objs[i], 1, size, print);
+        }
+    }
+}
+
+static void
+snap_print_extcomplex(struct snap_print *sp, const struct lys_ext_instance_complex *ext)
+{
+    const struct lyext_substmt *substmt = ext->substmt;
+    uint32_t i, j, count;
+
+    for (count = 0; substmt && substmt[count].stmt; ++count);
+    snap_write_num(sp, count);
+    for (i = 0; i < count; ++i) {
+        snap_write_num(sp, substmt[i].stmt);
+        snap_write_num(sp, substmt[i].offset);
+        snap_write_num(sp, substmt[i].cardinality);
+    }
+
+    for (i = 0; i < count; ++i) {
+        for (j = 0; (j < i) && (substmt[j].offset != substmt[i].offset); ++j);
+        if (j < i) {
+            /* the content is shared with a previous substatement */
+            continue;
+        }
+        snap_print_substmt(sp, substmt[i].stmt, substmt[i].cardinality >= LY_STMT_CARD_SOME,
+                           (void **)&ext->content[substmt[i].offset]);
+    }
+}
+
+static void
+snap_print_ext_instance(struct snap_print *sp, const struct lys_ext_instance *ext)
+{
+    size_t size;
+
+    if (!ext) {
+        snap_write_num(sp, 0);
+        return;
+    }
+
+    if (ext->flags & LYEXT_OPT_INHERIT) {
+        /* shadow copy of the original instance sharing all its members */
+        snap_write_num(sp, 1);
+        snap_add_obj(sp, ext);
+        snap_write(sp, ext, sizeof *ext);
+        snap_write_ref(sp, ext->def);
+        snap_write_ref(sp, ext->parent);
+        snap_write_ref(sp, ext->ext);
+        snap_write_ref(sp, ext->module);
+        snap_write_str(sp, ext->arg_value, 0);
+        return;
+    }
+
+    if (ext->ext_type == LYEXT_COMPLEX) {
+        size = ((struct lyext_plugin_complex *)ext->def->plugin)->instance_size;
+    } else {
+        size = sizeof *ext;
+    }
+    snap_write_num(sp, 2);
+    snap_write_num(sp, size);
+    snap_add_obj(sp, ext);
+    snap_write(sp, ext, size);
+    snap_write_ref(sp, ext->def);
+    snap_write_ref(sp, ext->parent);
+    snap_write_ref(sp, ext->module);
+    snap_write_str(sp, ext->arg_value, 1);
+    snap_print_exts(sp, ext->ext, ext->ext_size);
+    if (ext->ext_type == LYEXT_COMPLEX) {
+        snap_print_extcomplex(sp, (const struct lys_ext_instance_complex *)ext);
+    }
+}
+
+static void
+snap_print_node(struct snap_print *sp, const struct lys_node *node, int shallow)
+{
+    size_t size;
+
+    size = snap_node_size(node->nodetype);
+    if (!size) {
+        LOGINT;
+        sp->err = 1;
+        return;
+    }
+
+    snap_write_num(sp, node->nodetype);
+    snap_add_obj(sp, node);
+    snap_write(sp, node, size);
+
+    snap_write_str(sp, node->name, 1);
+    if (!(node->nodetype & (LYS_INPUT | LYS_OUTPUT))) {
+        snap_write_str(sp, node->dsc, 1);
+        snap_write_str(sp, node->ref, 1);
+        snap_print_iffeatures(sp, node->iffeature, node->iffeature_size);
+    }
+    snap_print_exts(sp, node->ext, node->ext_size);
+    snap_write_ref(sp, node->module);
+    snap_write_ref(sp, node->parent);
+    snap_write_ref(sp, node->next);
+    snap_write_ref(sp, node->prev);
+    if (node->nodetype & (LYS_LEAF | LYS_LEAFLIST)) {
+        snap_print_set(sp, ((struct lys_node_leaf *)node)->backlinks);
+    } else {
+        snap_write_ref(sp, node->child);
+    }
+
+    switch (node->nodetype) {
+    case LYS_CONTAINER:
+        snap_print_array(sp, ((struct lys_node_container *)node)->when, 1, sizeof(struct lys_when), snap_print_when);
+        snap_print_array(sp, ((struct lys_node_container *)node)->must, ((struct lys_node_container *)node)->must_size,
+                         sizeof(struct lys_restr), snap_print_restr);
+        snap_print_array(sp, ((struct lys_node_container *)node)->tpdf, ((struct lys_node_container *)node)->tpdf_size,
+                         sizeof(struct lys_tpdf), snap_print_tpdf);
+        snap_write_str(sp, ((struct lys_node_container *)node)->presence, 1);
+        break;
+    case LYS_CHOICE:
+        snap_print_array(sp, ((struct lys_node_choice *)node)->when, 1, sizeof(struct lys_when), snap_print_when);
+        snap_write_ref(sp, ((struct lys_node_choice *)node)->dflt);
+        break;
+    case LYS_LEAF:
+        snap_print_array(sp, ((struct lys_node_leaf *)node)->when, 1, sizeof(struct lys_when), snap_print_when);
+        snap_print_array(sp, ((struct lys_node_leaf *)node)->must, ((struct lys_node_leaf *)node)->must_size,
+                         sizeof(struct lys_restr), snap_print_restr);
+        snap_print_type(sp, &((struct lys_node_leaf *)node)->type);
+        snap_write_str(sp, ((struct lys_node_leaf *)node)->units, 1);
+        snap_write_str(sp, ((struct lys_node_leaf *)node)->dflt, 1);
+        break;
+    case LYS_LEAFLIST:
+        snap_print_array(sp, ((struct lys_node_leaflist *)node)->when, 1, sizeof(struct lys_when), snap_print_when);
+        snap_print_array(sp, ((struct lys_node_leaflist *)node)->must, ((struct lys_node_leaflist *)node)->must_size,
+                         sizeof(struct lys_restr), snap_print_restr);
+        snap_print_type(sp, &((struct lys_node_leaflist *)node)->type);
+        snap_write_str(sp, ((struct lys_node_leaflist *)node)->units, 1);
+        snap_print_strs(sp, ((struct lys_node_leaflist *)node)->dflt, ((struct lys_node_leaflist *)node)->dflt_size);
+        break;
+    case LYS_LIST:
+        snap_print_array(sp, ((struct lys_node_list *)node)->when, 1, sizeof(struct lys_when), snap_print_when);
+        snap_print_array(sp, ((struct lys_node_list *)node)->must, ((struct lys_node_list *)node)->must_size,
+                         sizeof(struct lys_restr), snap_print_restr);
+        snap_print_array(sp, ((struct lys_node_list *)node)->tpdf, ((struct lys_node_list *)node)->tpdf_size,
+                         sizeof(struct lys_tpdf), snap_print_tpdf);
+        snap_print_refs(sp, (void *const *)((struct lys_node_list *)node)->keys, ((struct lys_node_list *)node)->keys_size);
+        snap_print_array(sp, ((struct lys_node_list *)node)->unique, ((struct lys_node_list *)node)->unique_size,
+                         sizeof(struct lys_unique), snap_print_unique);
+        snap_write_str(sp, ((struct lys_node_list *)node)->keys_str, 1);
+        break;
+    case LYS_ANYXML:
+    case LYS_ANYDATA:
+        snap_print_array(sp, ((struct lys_node_anydata *)node)->when, 1, sizeof(struct lys_when), snap_print_when);
+        snap_print_array(sp, ((struct lys_node_anydata *)node)->must, ((struct lys_node_anydata *)node)->must_size,
+                         sizeof(struct lys_restr), snap_print_restr);
+        break;
+    case LYS_USES:
+        snap_print_array(sp, ((struct lys_node_uses *)node)->when, 1, sizeof(struct lys_when), snap_print_when);
+        snap_print_array(sp, ((struct lys_node_uses *)node)->refine, ((struct lys_node_uses *)node)->refine_size,
+                         sizeof(struct lys_refine), snap_print_refine);
+        snap_print_array(sp, ((struct lys_node_uses *)node)->augment, ((struct lys_node_uses *)node)->augment_size,
+                         sizeof(struct lys_node_augment), snap_print_augment);
+        snap_write_ref(sp, ((struct lys_node_uses *)node)->grp);
+        break;
+    case LYS_CASE:
+        snap_print_array(sp, ((struct lys_node_case *)node)->when, 1, sizeof(struct lys_when), snap_print_when);
+        break;
+    case LYS_GROUPING:
+        snap_print_array(sp, ((struct lys_node_grp *)node)->tpdf, ((struct lys_node_grp *)node)->tpdf_size,
+                         sizeof(struct lys_tpdf), snap_print_tpdf);
+        break;
+    case LYS_RPC:
+    case LYS_ACTION:
+        snap_print_array(sp, ((struct lys_node_rpc_action *)node)->tpdf, ((struct lys_node_rpc_action *)node)->tpdf_size,
+                         sizeof(struct lys_tpdf), snap_print_tpdf);
+        break;
+    case LYS_INPUT:
+    case LYS_OUTPUT:
+        snap_print_array(sp, ((struct lys_node_inout *)node)->tpdf, ((struct lys_node_inout *)node)->tpdf_size,
+                         sizeof(struct lys_tpdf), snap_print_tpdf);
+        snap_print_array(sp, ((struct lys_node_inout *)node)->must, ((struct lys_node_inout *)node)->must_size,
+                         sizeof(struct lys_restr), snap_print_restr);
+        break;
+    case LYS_NOTIF:
+        snap_print_array(sp, ((struct lys_node_notif *)node)->tpdf, ((struct lys_node_notif *)node)->tpdf_size,
+                         sizeof(struct lys_tpdf), snap_print_tpdf);
+        snap_print_array(sp, ((struct lys_node_notif *)node)->must, ((struct lys_node_notif *)node)->must_size,
+                         sizeof(struct lys_restr), snap_print_restr);
+        break;
+    default:
+        break;
+    }
+
+    snap_print_siblings(sp, (shallow || (node->nodetype & (LYS_LEAF | LYS_LEAFLIST))) ? NULL : node->child);
+}
+
+static void
+snap_print_siblings(struct snap_print *sp, const struct lys_node *first)
+{
+    const struct lys_node *iter;
+    uint32_t count = 0;
+
+    for (iter = first; iter; iter = iter->next) {
+        ++count;
+    }
+
+    snap_write_num(sp, count);
+    for (iter = first; iter && !sp->err; iter = iter->next) {
+        snap_print_node(sp, iter, 0);
+    }
+}
+
+static void
+snap_print_module(struct snap_print *sp, const struct lys_module *mod)
+{
+    uint8_t u;
+
+    snap_add_obj(sp, mod);
+    snap_write(sp, mod, mod->type ? sizeof(struct lys_submodule) : sizeof(struct lys_module));
+
+    snap_write_str(sp, mod->name, 1);
+    snap_write_str(sp, mod->prefix, 1);
+    snap_write_str(sp, mod->dsc, 1);
+    snap_write_str(sp, mod->ref, 1);
+    snap_write_str(sp, mod->org, 1);
+    snap_write_str(sp, mod->contact, 1);
+    snap_write_str(sp, mod->filepath, 1);
+
+    snap_print_array(sp, mod->rev, mod->rev_size, sizeof *mod->rev, snap_print_revision);
+    snap_print_array(sp, mod->imp, mod->imp_size, sizeof *mod->imp, snap_print_import);
+
+    /* submodules are owned by the main module */
+    snap_write_num(sp, mod->inc ? 1 : 0);
+    if (mod->inc) {
+        snap_write(sp, mod->inc, mod->inc_size * sizeof *mod->inc);
+    }
+    for (u = 0; mod->inc && (u < mod->inc_size); ++u) {
+        snap_add_obj(sp, &mod->inc[u]);
+        snap_write_str(sp, mod->inc[u].dsc, 1);
+        snap_write_str(sp, mod->inc[u].ref, 1);
+        snap_print_exts(sp, mod->inc[u].ext, mod->inc[u].ext_size);
+        if (mod->type) {
+            snap_write_ref(sp, mod->inc[u].submodule);
+        } else {
+            snap_write_num(sp, mod->inc[u].submodule ? 1 : 0);
+            if (mod->inc[u].submodule) {
+                snap_print_module(sp, (struct lys_module *)mod->inc[u].submodule);
+            }
+        }
+    }
+
+    snap_print_array(sp, mod->tpdf, mod->tpdf_size, sizeof *mod->tpdf, snap_print_tpdf);
+    snap_print_array(sp, mod->ident, mod->ident_size, sizeof *mod->ident, snap_print_ident);
+    snap_print_array(sp, mod->features, mod->features_size, sizeof *mod->features, snap_print_feature);
+    snap_print_array(sp, mod->augment, mod->augment_size, sizeof *mod->augment, snap_print_augment);
+    snap_print_array(sp, mod->deviation, mod->deviation_size, sizeof *mod->deviation, snap_print_deviation);
+    snap_print_array(sp, mod->extensions, mod->extensions_size, sizeof *mod->extensions, snap_print_extdef);
+    snap_print_exts(sp, mod->ext, mod->ext_size);
+
+    if (mod->type) {
+        snap_write_ref(sp, ((struct lys_submodule *)mod)->belongsto);
+    } else {
+        snap_write_str(sp, mod->ns, 1);
+        snap_write_ref(sp, mod->data);
+        snap_print_siblings(sp, mod->data);
+    }
+}
+
+static void
+snap_print_clean(struct snap_print *sp)
+{
+    free(sp->buf);
+    free(sp->objs.recs);
+    free(sp->strs.recs);
+    free(sp->str_list.items);
+    free(sp->slots.items);
+}
+
+int
+lys_snapshot_print(const struct ly_ctx *ctx, char **data, size_t *size)
+{
+    struct snap_print sp, out;
+    struct snap_slot *slot;
+    struct snap_rec *rec;
+    char header[LYS_SNAPSHOT_HEADER_SIZE] = {0};
+    uint32_t i;
+    int j;
+
+    memset(&sp, 0, sizeof sp);
+    memset(&out, 0, sizeof out);
+
+    /* the built-in types are not part of the snapshot */
+    for (i = 1; i < LY_DATA_TYPE_COUNT; ++i) {
+        snap_add_obj(&sp, ly_types[i]);
+        snap_add_obj(&sp, &ly_types[i]->type);
+    }
+
+    snap_write_num(&sp, ctx->models.used);
+    snap_write_num(&sp, ctx->models.flags);
+    snap_write_num(&sp, ctx->models.module_set_id);
+    for (j = 0; (j < ctx->models.used) && !sp.err; ++j) {
+        snap_print_module(&sp, ctx->models.list[j]);
+    }
+
+    /* fill the references */
+    for (i = 0; (i < sp.slots.count) && !sp.err; ++i) {
+        slot = &((struct snap_slot *)sp.slots.items)[i];
+        rec = snap_map_find(&sp.objs, slot->ptr);
+        if (!rec || !rec->ptr) {
+            LOGERR(LY_EINT, "Schema snapshot failed, a referenced schema object is not part of the context.");
+            sp.err = 1;
+            break;
+        }
+        sp.buf[slot->pos] = rec->id & 0xff;
+        sp.buf[slot->pos + 1] = (rec->id >> 8) & 0xff;
+        sp.buf[slot->pos + 2] = (rec->id >> 16) & 0xff;
+        sp.buf[slot->pos + 3] = (rec->id >> 24) & 0xff;
+    }
+    if (sp.err) {
+        snap_print_clean(&sp);
+        return EXIT_FAILURE;
+    }
+
+    /* header (the length is filled at the end), the string table and the objects */
+    memcpy(header, LYS_SNAPSHOT_MAGIC, 3);
+    header[3] = LYS_SNAPSHOT_VERSION;
+    snap_write(&out, header, LYS_SNAPSHOT_HEADER_SIZE);
+    snap_write_num(&out, sizeof(void *));
+    snap_write_num(&out, LY_VERSION_MAJOR);
+    snap_write_num(&out, LY_VERSION_MINOR);
+    snap_write_num(&out, LY_VERSION_MICRO);
+    snap_write_num(&out, sp.obj_count);
+    snap_write_num(&out, sp.str_list.count);
+    for (i = 0; i < sp.str_list.count; ++i) {
+        rec = &((struct snap_rec *)sp.str_list.items)[i];
+        snap_write_num(&out, rec->id);
+        snap_write_num(&out, strlen(rec->ptr));
+        snap_write(&out, rec->ptr, strlen(rec->ptr));
+    }
+    snap_write(&out, sp.buf, sp.len);
+    snap_print_clean(&sp);
+    if (out.err || (out.len > UINT32_MAX)) {
+        if (!out.err) {
+            LOGERR(LY_EINT, "Schema snapshot failed, the snapshot is too big.");
+        }
+        free(out.buf);
+        return EXIT_FAILURE;
+    }
+
+    out.buf[4] = out.len & 0xff;
+    out.buf[5] = (out.len >> 8) & 0xff;
+    out.buf[6] = (out.len >> 16) & 0xff;
+    out.buf[7] = (out.len >> 24) & 0xff;
+
+    *data = out.buf;
+    *size = out.len;
+    return EXIT_SUCCESS;
+}
+
+/*
+ * parser
+ */
+
+/**
+ * @brief Reference to an object to be filled when all the objects are loaded.
+ */
+struct snap_fix {
+    void **slot;
+    uint32_t id;
+};
+
+/**
+ * @brief Set of references to objects to be created when all the objects are loaded.
+ */
+struct snap_setfix {
+    struct ly_set **slot;
+    size_t pos;                      /**< position of the object IDs in the snapshot */
+    uint32_t count;
+};
+
+/**
+ * @brief Extension definition whose plugin is to be found when all the objects are loaded.
+ */
+struct snap_extdef {
+    struct lys_ext *def;
+    uint64_t plugin_type;            /**< the plugin type + 1 when the snapshot was created, 0 for no plugin */
+};
+
+/**
+ * @brief Complex extension instance to be connected with its plugin when all the objects are loaded.
+ */
+struct snap_complex {
+    struct lys_ext_instance_complex *ext;
+    size_t size;
+    struct lyext_substmt *substmt;   /**< substatements when the snapshot was created */
+};
+
+/**
+ * @brief State of a loaded snapshot.
+ *
+ * The objects are allocated separately exactly as if the modules were parsed, so they are freed the standard way.
+ * The references are filled only at the end when all the objects are known. Any error stops the loading - all
+ * the following operations are skipped (reading zeroes) and all the allocated memory is freed at the end.
+ */
+struct snap_parse {
+    struct ly_ctx *ctx;
+    const char *data;
+    size_t len;
+    size_t pos;
+    const char **strs;               /**< the string table */
+    uint32_t str_count;
+    void **objs;                     /**< loaded objects indexed by their IDs */
+    uint32_t obj_count;
+    uint32_t obj_last;
+    struct snap_list allocs;         /**< all the allocated memory (void *) */
+    struct snap_list fixes;          /**< references to fill (struct snap_fix) */
+    struct snap_list setfixes;       /**< sets to create (struct snap_setfix) */
+    struct snap_list extdefs;        /**< extension definitions (struct snap_extdef) */
+    struct snap_list complexes;      /**< complex extension instances (struct snap_complex) */
+    struct snap_list pattypes;       /**< string types with the precompiled patterns (struct lys_type *) */
+    int err;
+};
+
+static void
+snap_parse_invalid(struct snap_parse *sp)
+{
+    if (!sp->err) {
+        LOGERR(LY_EINVAL, "Invalid or corrupted schema snapshot.");
+        sp->err = 1;
+    }
+}
+
+/**
+ * @brief Check that there are at least the specified number of bytes left.
+ */
+static int
+snap_check(struct snap_parse *sp, uint64_t count)
+{
+    if (sp->err) {
+        return EXIT_FAILURE;
+    }
+    if (count > sp->len - sp->pos) {
+        snap_parse_invalid(sp);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Check that there are at least the specified number of items of a size left.
+ */
+static int
+snap_check_items(struct snap_parse *sp, uint64_t count, size_t size)
+{
+    if (sp->err) {
+        return EXIT_FAILURE;
+    }
+    if (count > (sp->len - sp->pos) / size) {
+        snap_parse_invalid(sp);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+static void
+snap_read(struct snap_parse *sp, void *dst, size_t count)
+{
+    if (snap_check(sp, count)) {
+        memset(dst, 0, count);
+        return;
+    }
+
+    memcpy(dst, sp->data + sp->pos, count);
+    sp->pos += count;
+}
+
+static uint64_t
+snap_read_num(struct snap_parse *sp)
+{
+    uint64_t num = 0;
+    uint8_t byte;
+    int shift = 0;
+
+    do {
+        if (snap_check(sp, 1) || (shift > 63)) {
+            snap_parse_invalid(sp);
+            return 0;
+        }
+        byte = sp->data[sp->pos++];
+        num |= (uint64_t)(byte & 0x7f) << shift;
+        shift += 7;
+    } while (byte & 0x80);
+
+    return num;
+}
+
+static uint32_t
+snap_read_id(struct snap_parse *sp)
+{
+    uint8_t bytes[4];
+
+    snap_read(sp, bytes, 4);
+    return bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | ((uint32_t)bytes[3] << 24);
+}
+
+static const char *
+snap_read_str(struct snap_parse *sp)
+{
+    uint64_t idx;
+
+    idx = snap_read_num(sp);
+    if (!idx || sp->err) {
+        return NULL;
+    } else if (idx > sp->str_count) {
+        snap_parse_invalid(sp);
+        return NULL;
+    }
+    return sp->strs[idx - 1];
+}
+
+/**
+ * @brief Read a reference to an object, it is filled at the end of loading.
+ */
+static void
+snap_read_ref(struct snap_parse *sp, void *slot)
+{
+    struct snap_fix *fix;
+    uint32_t id;
+
+    *(void **)slot = NULL;
+    id = snap_read_id(sp);
+    if (!id || sp->err) {
+        return;
+    } else if (id > sp->obj_count) {
+        snap_parse_invalid(sp);
+        return;
+    }
+
+    fix = snap_list_add(&sp->fixes, sizeof *fix, &sp->err);
+    if (fix) {
+        fix->slot = slot;
+        fix->id = id;
+    }
+}
+
+static void *
+snap_alloc(struct snap_parse *sp, size_t size)
+{
+    void **alloc, *mem;
+
+    alloc = snap_list_add(&sp->allocs, sizeof *alloc, &sp->err);
+    if (!alloc) {
+        return NULL;
+    }
+    mem = calloc(1, size ? size : 1);
+    if (!mem) {
+        LOGMEM;
+        --sp->allocs.count;
+        sp->err = 1;
+        return NULL;
+    }
+    *alloc = mem;
+    return mem;
+}
+
+/**
+ * @brief Assign the next ID to a loaded object that can be referenced.
+ */
+static void
+snap_obj(struct snap_parse *sp, void *obj)
+{
+    if (sp->err) {
+        return;
+    } else if (sp->obj_last == sp->obj_count) {
+        snap_parse_invalid(sp);
+        return;
+    }
+
+    sp->objs[++sp->obj_last] = obj;
+}
+
+typedef void (*snap_parse_clb)(struct snap_parse *sp, void *obj);
+
+/**
+ * @brief Load an array of structures printed by snap_print_array().
+ */
+static void
+snap_parse_array(struct snap_parse *sp, void *array_p, uint32_t count, size_t size, snap_parse_clb parse)
+{
+    char *array;
+    uint32_t i;
+
+    *(void **)array_p = NULL;
+    if (!snap_read_num(sp) || snap_check_items(sp, count, size)) {
+        return;
+    }
+
+    array = snap_alloc(sp, count * size);
+    if (!array) {
+        return;
+    }
+    snap_read(sp, array, count * size);
+    for (i = 0; (i < count) && !sp->err; ++i) {
+        parse(sp, array + i * size);
+    }
+    *(void **)array_p = array;
+}
+
+static void
+snap_parse_strs(struct snap_parse *sp, const char ***strs_p, uint32_t count)
+{
+    const char **strs;
+    uint32_t i;
+
+    *strs_p = NULL;
+    if (!snap_read_num(sp) || snap_check(sp, count)) {
+        return;
+    }
+
+    strs = snap_alloc(sp, count * sizeof *strs);
+    for (i = 0; strs && (i < count); ++i) {
+        strs[i] = snap_read_str(sp);
+    }
+    *strs_p = strs;
+}
+
+static void
+snap_parse_refs(struct snap_parse *sp, void *ptrs_p, uint32_t count)
+{
+    void **ptrs;
+    uint32_t i;
+
+    *(void **)ptrs_p = NULL;
+    if (!snap_read_num(sp) || snap_check_items(sp, count, 4)) {
+        return;
+    }
+
+    ptrs = snap_alloc(sp, count * sizeof *ptrs);
+    for (i = 0; ptrs && (i < count); ++i) {
+        snap_read_ref(sp, &ptrs[i]);
+    }
+    *(void **)ptrs_p = ptrs;
+}
+
+static void
+snap_parse_set(struct snap_parse *sp, struct ly_set **set_p)
+{
+    struct snap_setfix *fix;
+    uint64_t count;
+
+    *set_p = NULL;
+    count = snap_read_num(sp);
+    if (!count || snap_check_items(sp, count - 1, 4)) {
+        return;
+    }
+
+    fix = snap_list_add(&sp->setfixes, sizeof *fix, &sp->err);
+    if (fix) {
+        fix->slot = set_p;
+        fix->pos = sp->pos;
+        fix->count = count - 1;
+    }
+    sp->pos += (count - 1) * 4;
+}
+
+static struct lys_ext_instance *snap_parse_ext_instance(struct snap_parse *sp);
+static void snap_parse_siblings(struct snap_parse *sp);
+
+static void
+snap_parse_exts(struct snap_parse *sp, struct lys_ext_instance ***exts_p, uint8_t size)
+{
+    struct lys_ext_instance **exts;
+    uint8_t u;
+
+    *exts_p = NULL;
+    if (!snap_read_num(sp)) {
+        return;
+    }
+
+    exts = snap_alloc(sp, size * sizeof *exts);
+    snap_obj(sp, exts);
+    for (u = 0; exts && (u < size) && !sp->err; ++u) {
+        exts[u] = snap_parse_ext_instance(sp);
+    }
+    *exts_p = exts;
+}
+
+static void
+snap_parse_restr(struct snap_parse *sp, void *obj)
+{
+    struct lys_restr *restr = obj;
+
+    snap_obj(sp, restr);
+    restr->expr = snap_read_str(sp);
+    restr->dsc = snap_read_str(sp);
+    restr->ref = snap_read_str(sp);
+    restr->eapptag = snap_read_str(sp);
+    restr->emsg = snap_read_str(sp);
+    snap_parse_exts(sp, &restr->ext, restr->ext_size);
+    restr->expr_compiled = NULL;
+    restr->pattern_compiled = NULL;
+}
+
+static void
+snap_parse_when(struct snap_parse *sp, void *obj)
+{
+    struct lys_when *when = obj;
+
+    snap_obj(sp, when);
+    when->cond = snap_read_str(sp);
+    when->dsc = snap_read_str(sp);
+    when->ref = snap_read_str(sp);
+    snap_parse_exts(sp, &when->ext, when->ext_size);
+    when->cond_compiled = NULL;
+}
+
+static void
+snap_parse_iffeature(struct snap_parse *sp, void *obj)
+{
+    struct lys_iffeature *iff = obj;
+    uint64_t size;
+
+    snap_obj(sp, iff);
+    iff->expr = NULL;
+    size = snap_read_num(sp);
+    if (size && !snap_check(sp, size - 1)) {
+        iff->expr = snap_alloc(sp, size - 1);
+        if (iff->expr) {
+            snap_read(sp, iff->expr, size - 1);
+        }
+    }
+    size = snap_read_num(sp);
+    if (size > UINT32_MAX) {
+        snap_parse_invalid(sp);
+    }
+    snap_parse_refs(sp, &iff->features, size);
+    snap_parse_exts(sp, &iff->ext, iff->ext_size);
+}
+
+static void
+snap_parse_iffeatures(struct snap_parse *sp, struct lys_iffeature **iff, uint8_t size)
+{
+    snap_parse_array(sp, iff, size, sizeof **iff, snap_parse_iffeature);
+}
+
+static void
+snap_parse_unique(struct snap_parse *sp, void *obj)
+{
+    struct lys_unique *unique = obj;
+
+    snap_obj(sp, unique);
+    snap_parse_strs(sp, &unique->expr, unique->expr_size);
+}
+
+static void
+snap_parse_revision(struct snap_parse *sp, void *obj)
+{
+    struct lys_revision *rev = obj;
+
+    snap_obj(sp, rev);
+    rev->dsc = snap_read_str(sp);
+    rev->ref = snap_read_str(sp);
+    snap_parse_exts(sp, &rev->ext, rev->ext_size);
+}
+
+static void
+snap_parse_bit(struct snap_parse *sp, void *obj)
+{
+    struct lys_type_bit *bit = obj;
+
+    snap_obj(sp, bit);
+    bit->name = snap_read_str(sp);
+    bit->dsc = snap_read_str(sp);
+    bit->ref = snap_read_str(sp);
+    snap_parse_iffeatures(sp, &bit->iffeature, bit->iffeature_size);
+    snap_parse_exts(sp, &bit->ext, bit->ext_size);
+}
+
+static void
+snap_parse_enum(struct snap_parse *sp, void *obj)
+{
+    struct lys_type_enum *enm = obj;
+
+    snap_obj(sp, enm);
+    enm->name = snap_read_str(sp);
+    enm->dsc = snap_read_str(sp);
+    enm->ref = snap_read_str(sp);
+    snap_parse_iffeatures(sp, &enm->iffeature, enm->iffeature_size);
+    snap_parse_exts(sp, &enm->ext, enm->ext_size);
+}
+
+static void
+snap_parse_type(struct snap_parse *sp, void *obj)
+{
+    struct lys_type *type = obj;
+    struct lys_type **pattype;
+
+    snap_obj(sp, type);
+    type->module_name = snap_read_str(sp);
+    snap_parse_exts(sp, &type->ext, type->ext_size);
+    snap_read_ref(sp, &type->der);
+    snap_read_ref(sp, &type->parent);
+
+    switch (type->base) {
+    case LY_TYPE_BINARY:
+        snap_parse_array(sp, &type->info.binary.length, 1, sizeof(struct lys_restr), snap_parse_restr);
+        break;
+    case LY_TYPE_BITS:
+        snap_parse_array(sp, &type->info.bits.bit, type->info.bits.count, sizeof *type->info.bits.bit, snap_parse_bit);
+        break;
+    case LY_TYPE_DEC64:
+        snap_parse_array(sp, &type->info.dec64.range, 1, sizeof(struct lys_restr), snap_parse_restr);
+        break;
+    case LY_TYPE_ENUM:
+        snap_parse_array(sp, &type->info.enums.enm, type->info.enums.count, sizeof *type->info.enums.enm,
+                         snap_parse_enum);
+        break;
+    case LY_TYPE_IDENT:
+        snap_parse_refs(sp, &type->info.ident.ref, type->info.ident.count);
+        break;
+    case LY_TYPE_LEAFREF:
+        type->info.lref.path = snap_read_str(sp);
+        snap_read_ref(sp, &type->info.lref.target);
+        break;
+    case LY_TYPE_STRING:
+        snap_parse_array(sp, &type->info.str.length, 1, sizeof(struct lys_restr), snap_parse_restr);
+        snap_parse_array(sp, &type->info.str.patterns, type->info.str.pat_count, sizeof(struct lys_restr),
+                         snap_parse_restr);
+        if (snap_read_num(sp)) {
+            /* compiled again at the end */
+            pattype = snap_list_add(&sp->pattypes, sizeof *pattype, &sp->err);
+            if (pattype) {
+                *pattype = type;
+            }
+        }
+        break;
+    case LY_TYPE_UNION:
+        snap_parse_array(sp, &type->info.uni.types, type->info.uni.count, sizeof(struct lys_type), snap_parse_type);
+        break;
+    case LY_TYPE_INT8:
+    case LY_TYPE_UINT8:
+    case LY_TYPE_INT16:
+    case LY_TYPE_UINT16:
+    case LY_TYPE_INT32:
+    case LY_TYPE_UINT32:
+    case LY_TYPE_INT64:
+    case LY_TYPE_UINT64:
+        snap_parse_array(sp, &type->info.num.range, 1, sizeof(struct lys_restr), snap_parse_restr);
+        break;
+    case LY_TYPE_BOOL:
+    case LY_TYPE_EMPTY:
+    case LY_TYPE_INST:
+        break;
+    default:
+        memset(&type->info, 0, sizeof type->info);
+        break;
+    }
+}
+
+static void
+snap_parse_tpdf(struct snap_parse *sp, void *obj)
+{
+    struct lys_tpdf *tpdf = obj;
+
+    snap_obj(sp, tpdf);
+    tpdf->name = snap_read_str(sp);
+    tpdf->dsc = snap_read_str(sp);
+    tpdf->ref = snap_read_str(sp);
+    tpdf->units = snap_read_str(sp);
+    tpdf->dflt = snap_read_str(sp);
+    snap_parse_exts(sp, &tpdf->ext, tpdf->ext_size);
+    snap_read_ref(sp, &tpdf->module);
+    snap_parse_type(sp, &tpdf->type);
+}
+
+static void
+snap_parse_ident(struct snap_parse *sp, void *obj)
+{
+    struct lys_ident *ident = obj;
+
+    snap_obj(sp, ident);
+    ident->name = snap_read_str(sp);
+    ident->dsc = snap_read_str(sp);
+    ident->ref = snap_read_str(sp);
+    snap_parse_iffeatures(sp, &ident->iffeature, ident->iffeature_size);
+    snap_parse_exts(sp, &ident->ext, ident->ext_size);
+    snap_read_ref(sp, &ident->module);
+    snap_parse_refs(sp, &ident->base, ident->base_size);
+    snap_parse_set(sp, &ident->der);
+}
+
+static void
+snap_parse_feature(struct snap_parse *sp, void *obj)
+{
+    struct lys_feature *feat = obj;
+
+    snap_obj(sp, feat);
+    feat->name = snap_read_str(sp);
+    feat->dsc = snap_read_str(sp);
+    feat->ref = snap_read_str(sp);
+    snap_parse_iffeatures(sp, &feat->iffeature, feat->iffeature_size);
+    snap_parse_exts(sp, &feat->ext, feat->ext_size);
+    snap_read_ref(sp, &feat->module);
+    snap_parse_set(sp, &feat->depfeatures);
+}
+
+static void
+snap_parse_extdef(struct snap_parse *sp, void *obj)
+{
+    struct lys_ext *def = obj;
+    struct snap_extdef *rec;
+
+    snap_obj(sp, def);
+    def->name = snap_read_str(sp);
+    def->dsc = snap_read_str(sp);
+    def->ref = snap_read_str(sp);
+    def->argument = snap_read_str(sp);
+    snap_parse_exts(sp, &def->ext, def->ext_size);
+    snap_read_ref(sp, &def->module);
+    def->plugin = NULL;
+
+    rec = snap_list_add(&sp->extdefs, sizeof *rec, &sp->err);
+    if (rec) {
+        rec->def = def;
+        rec->plugin_type = snap_read_num(sp);
+    }
+}
+
+static void
+snap_parse_import(struct snap_parse *sp, void *obj)
+{
+    struct lys_import *imp = obj;
+
+    snap_obj(sp, imp);
+    snap_read_ref(sp, &imp->module);
+    imp->prefix = snap_read_str(sp);
+    imp->dsc = snap_read_str(sp);
+    imp->ref = snap_read_str(sp);
+    snap_parse_exts(sp, &imp->ext, imp->ext_size);
+}
+
+static void
+snap_parse_refine(struct snap_parse *sp, void *obj)
+{
+    struct lys_refine *rfn = obj;
+
+    snap_obj(sp, rfn);
+    rfn->target_name = snap_read_str(sp);
+    rfn->dsc = snap_read_str(sp);
+    rfn->ref = snap_read_str(sp);
+    snap_parse_iffeatures(sp, &rfn->iffeature, rfn->iffeature_size);
+    snap_parse_exts(sp, &rfn->ext, rfn->ext_size);
+    snap_read_ref(sp, &rfn->module);
+    snap_parse_array(sp, &rfn->must, rfn->must_size, sizeof *rfn->must, snap_parse_restr);
+    snap_parse_strs(sp, &rfn->dflt, rfn->dflt_size);
+    if (rfn->target_type & LYS_CONTAINER) {
+        rfn->mod.presence = snap_read_str(sp);
+    }
+}
+
+static void
+snap_parse_augment(struct snap_parse *sp, void *obj)
+{
+    struct lys_node_augment *aug = obj;
+
+    snap_obj(sp, aug);
+    aug->target_name = snap_read_str(sp);
+    aug->dsc = snap_read_str(sp);
+    aug->ref = snap_read_str(sp);
+    snap_parse_iffeatures(sp, &aug->iffeature, aug->iffeature_size);
+    snap_parse_exts(sp, &aug->ext, aug->ext_size);
+    snap_read_ref(sp, &aug->module);
+    snap_read_ref(sp, &aug->parent);
+    snap_read_ref(sp, &aug->child);
+    snap_read_ref(sp, &aug->target);
+    snap_parse_array(sp, &aug->when, 1, sizeof *aug->when, snap_parse_when);
+    aug->priv = NULL;
+
+    snap_parse_siblings(sp);
+}
+
+static void
+snap_parse_deviate(struct snap_parse *sp, void *obj)
+{
+    struct lys_deviate *dev = obj;
+
+    snap_obj(sp, dev);
+    dev->units = snap_read_str(sp);
+    snap_parse_strs(sp, &dev->dflt, dev->dflt_size);
+    snap_parse_exts(sp, &dev->ext, dev->ext_size);
+    if (dev->mod == LY_DEVIATE_DEL) {
+        snap_parse_array(sp, &dev->must, dev->must_size, sizeof *dev->must, snap_parse_restr);
+        snap_parse_array(sp, &dev->unique, dev->unique_size, sizeof *dev->unique, snap_parse_unique);
+    } else {
+        snap_read_ref(sp, &dev->must);
+        snap_read_ref(sp, &dev->unique);
+    }
+    snap_read_ref(sp, &dev->type);
+}
+
+static struct lys_node *snap_parse_node(struct snap_parse *sp);
+
+static void
+snap_parse_deviation(struct snap_parse *sp, void *obj)
+{
+    struct lys_deviation *dev = obj;
+
+    snap_obj(sp, dev);
+    dev->target_name = snap_read_str(sp);
+    dev->dsc = snap_read_str(sp);
+    dev->ref = snap_read_str(sp);
+    snap_parse_exts(sp, &dev->ext, dev->ext_size);
+    snap_parse_array(sp, &dev->deviate, dev->deviate_size, sizeof *dev->deviate, snap_parse_deviate);
+
+    if (!dev->deviate) {
+        snap_read_ref(sp, &dev->orig_node);
+    } else if (snap_read_num(sp)) {
+        dev->orig_node = snap_parse_node(sp);
+    } else {
+        dev->orig_node = NULL;
+    }
+}
+
+/**
+ * @brief Load the content of a substatement of a complex extension instance printed by snap_print_substmt().
+ */
+static void
+snap_parse_substmt(struct snap_parse *sp, LY_STMT stmt, int array, void **slot)
+{
+    snap_parse_clb parse = NULL;
+    size_t size = 0;
+    uint64_t i, n;
+    const char **strs;
+    uint8_t *bytes;
+    uint32_t **nums;
+    void **objs;
+
+    if (snap_substmt_is_str(stmt)) {
+        if (!array) {
+            ((const char **)slot)[0] = snap_read_str(sp);
+            if (stmt == LY_STMT_BELONGSTO) {
+                ((const char **)slot)[1] = snap_read_str(sp);
+            }
+            return;
+        }
+
+        ((void **)slot)[0] = NULL;
+        if ((stmt == LY_STMT_BELONGSTO) || (stmt == LY_STMT_ARGUMENT)) {
+            ((void **)slot)[1] = NULL;
+        }
+        n = snap_read_num(sp);
+        if (!n || snap_check(sp, n - 1)) {
+            return;
+        }
+
+        strs = snap_alloc(sp, n * sizeof *strs);
+        for (i = 0; strs && (i < n - 1); ++i) {
+            strs[i] = snap_read_str(sp);
+        }
+        ((const char ***)slot)[0] = strs;
+        if (stmt == LY_STMT_BELONGSTO) {
+            strs = snap_alloc(sp, n * sizeof *strs);
+            for (i = 0; strs && (i < n - 1); ++i) {
+                strs[i] = snap_read_str(sp);
+            }
+            ((const char ***)slot)[1] = strs;
+        } else if (stmt == LY_STMT_ARGUMENT) {
+            bytes = snap_alloc(sp, n);
+            if (bytes) {
+                snap_read(sp, bytes, n - 1);
+            }
+            ((uint8_t **)slot)[1] = bytes;
+        }
+        return;
+    } else if (snap_substmt_is_node(stmt)) {
+        snap_read_ref(sp, slot);
+        snap_parse_siblings(sp);
+        return;
+    }
+
+    switch (stmt) {
+    case LY_STMT_DIGITS:
+        if (array) {
+            *slot = NULL;
+            n = snap_read_num(sp);
+            if (n && !snap_check(sp, n - 1)) {
+                bytes = snap_alloc(sp, n);
+                if (bytes) {
+                    snap_read(sp, bytes, n - 1);
+                }
+                *slot = bytes;
+            }
+        }
+        return;
+    case LY_STMT_MAX:
+    case LY_STMT_MIN:
+    case LY_STMT_POSITION:
+    case LY_STMT_VALUE:
+        *slot = NULL;
+        n = snap_read_num(sp);
+        if (!array) {
+            if (n > 1) {
+                snap_parse_invalid(sp);
+                return;
+            }
+            nums = (uint32_t **)slot;
+        } else if (!n || snap_check(sp, n - 1)) {
+            return;
+        } else {
+            nums = snap_alloc(sp, n * sizeof *nums);
+            *slot = nums;
+            --n;
+        }
+        for (i = 0; nums && (i < n) && !sp->err; ++i) {
+            nums[i] = snap_alloc(sp, sizeof **nums);
+            if (nums[i]) {
+                *nums[i] = snap_read_num(sp);
+            }
+        }
+        return;
+    case LY_STMT_MODULE:
+        if (!array) {
+            snap_read_ref(sp, slot);
+            return;
+        }
+        *slot = NULL;
+        n = snap_read_num(sp);
+        if (!n || snap_check_items(sp, n - 1, 4)) {
+            return;
+        }
+        objs = snap_alloc(sp, n * sizeof *objs);
+        for (i = 0; objs && (i < n - 1); ++i) {
+            snap_read_ref(sp, &objs[i]);
+        }
+        *slot = objs;
+        return;
+    case LY_STMT_UNIQUE:
+        parse = snap_parse_unique;
+        size = sizeof(struct lys_unique);
+        break;
+    case LY_STMT_TYPE:
+        parse = snap_parse_type;
+        size = sizeof(struct lys_type);
+        break;
+    case LY_STMT_TYPEDEF:
+        parse = snap_parse_tpdf;
+        size = sizeof(struct lys_tpdf);
+        break;
+    case LY_STMT_IFFEATURE:
+        parse = snap_parse_iffeature;
+        size = sizeof(struct lys_iffeature);
+        break;
+    case LY_STMT_LENGTH:
+    case LY_STMT_MUST:
+    case LY_STMT_PATTERN:
+    case LY_STMT_RANGE:
+        parse = snap_parse_restr;
+        size = sizeof(struct lys_restr);
+        break;
+    case LY_STMT_WHEN:
+        parse = snap_parse_when;
+        size = sizeof(struct lys_when);
+        break;
+    case LY_STMT_REVISION:
+        parse = snap_parse_revision;
+        size = sizeof(struct lys_revision);
+        break;
+    default:
+        /* scalars stored directly in the content */
+        return;
+    }
+
+    if (!array) {
+        snap_parse_array(sp, slot, 1, size, parse);
+        return;
+    }
+    *slot = NULL;
+    n = snap_read_num(sp);
+    if (!n || snap_check(sp, n - 1)) {
+        return;
+    }
+    objs = snap_alloc(sp, n * sizeof *objs);
+    for (i = 0; objs && (i < n - 1) && !sp->err; ++i) {
+        snap_parse_array(sp, &objs[i], 1, size, parse);
+    }
+    *slot = objs;
+}
+
+static void
+snap_parse_extcomplex(struct snap_parse *sp, struct lys_ext_instance_complex *ext, size_t size)
+{
+    struct snap_complex *rec;
+    struct lyext_substmt *substmt;
+    uint64_t i, j, count;
+    size_t content = size - offsetof(struct lys_ext_instance_complex, content);
+
+    ext->substmt = NULL;
+    count = snap_read_num(sp);
+    if (snap_check_items(sp, count, 3)) {
+        return;
+    }
+
+    rec = snap_list_add(&sp->complexes, sizeof *rec, &sp->err);
+    if (!rec) {
+        return;
+    }
+    rec->ext = ext;
+    rec->size = size;
+    rec->substmt = substmt = calloc(count + 1, sizeof *substmt);
+    if (!substmt) {
+        LOGMEM;
+        sp->err = 1;
+        return;
+    }
+
+    for (i = 0; i < count; ++i) {
+        substmt[i].stmt = snap_read_num(sp);
+        substmt[i].offset = snap_read_num(sp);
+        substmt[i].cardinality = snap_read_num(sp);
+        if (!substmt[i].stmt || (substmt[i].offset > content)
+                || (content - substmt[i].offset < snap_substmt_size(substmt[i].stmt,
+                                                                     substmt[i].cardinality >= LY_STMT_CARD_SOME))) {
+            snap_parse_invalid(sp);
+            return;
+        }
+    }
+
+    for (i = 0; (i < count) && !sp->err; ++i) {
+        for (j = 0; (j < i) && (substmt[j].offset != substmt[i].offset); ++j);
+        if (j < i) {
+            /* the content is shared with a previous substatement */
+            continue;
+        }
+        snap_parse_substmt(sp, substmt[i].stmt, substmt[i].cardinality >= LY_STMT_CARD_SOME,
+                           (void **)&ext->content[substmt[i].offset]);
+    }
+}
+
+static struct lys_ext_instance *
+snap_parse_ext_instance(struct snap_parse *sp)
+{
+    struct lys_ext_instance *ext;
+    uint64_t size;
+
+    switch (snap_read_num(sp)) {
+    case 0:
+        return NULL;
+    case 1:
+        /* shadow copy of an inherited instance */
+        ext = snap_alloc(sp, sizeof *ext);
+        if (!ext) {
+            return NULL;
+        }
+        snap_obj(sp, ext);
+        snap_read(sp, ext, sizeof *ext);
+        snap_read_ref(sp, &ext->def);
+        snap_read_ref(sp, &ext->parent);
+        snap_read_ref(sp, &ext->ext);
+        snap_read_ref(sp, &ext->module);
+        ext->arg_value = snap_read_str(sp);
+        ext->priv = NULL;
+        return ext;
+    case 2:
+        size = snap_read_num(sp);
+        if ((size < sizeof *ext) || snap_check(sp, size)) {
+            snap_parse_invalid(sp);
+            return NULL;
+        }
+        ext = snap_alloc(sp, size);
+        if (!ext) {
+            return NULL;
+        }
+        snap_obj(sp, ext);
+        snap_read(sp, ext, size);
+        snap_read_ref(sp, &ext->def);
+        snap_read_ref(sp, &ext->parent);
+        snap_read_ref(sp, &ext->module);
+        ext->arg_value = snap_read_str(sp);
+        snap_parse_exts(sp, &ext->ext, ext->ext_size);
+        ext->priv = NULL;
+        if (ext->ext_type == LYEXT_COMPLEX) {
+            if (size < sizeof(struct lys_ext_instance_complex)) {
+                snap_parse_invalid(sp);
+                return ext;
+            }
+            snap_parse_extcomplex(sp, (struct lys_ext_instance_complex *)ext, size);
+        }
+        return ext;
+    default:
+        snap_parse_invalid(sp);
+        return NULL;
+    }
+}
+
+static struct lys_node *
+snap_parse_node(struct snap_parse *sp)
+{
+    struct lys_node *node;
+    LYS_NODE nodetype;
+    size_t size;
+
+    nodetype = snap_read_num(sp);
+    size = snap_node_size(nodetype);
+    if (!size) {
+        snap_parse_invalid(sp);
+        return NULL;
+    }
+
+    node = snap_alloc(sp, size);
+    if (!node) {
+        return NULL;
+    }
+    snap_obj(sp, node);
+    snap_read(sp, node, size);
+    if (node->nodetype != nodetype) {
+        snap_parse_invalid(sp);
+        return node;
+    }
+
+    node->name = snap_read_str(sp);
+    if (!(nodetype & (LYS_INPUT | LYS_OUTPUT))) {
+        node->dsc = snap_read_str(sp);
+        node->ref = snap_read_str(sp);
+        snap_parse_iffeatures(sp, &node->iffeature, node->iffeature_size);
+    }
+    snap_parse_exts(sp, &node->ext, node->ext_size);
+    snap_read_ref(sp, &node->module);
+    snap_read_ref(sp, &node->parent);
+    snap_read_ref(sp, &node->next);
+    snap_read_ref(sp, &node->prev);
+    if (nodetype & (LYS_LEAF | LYS_LEAFLIST)) {
+        snap_parse_set(sp, &((struct lys_node_leaf *)node)->backlinks);
+    } else {
+        snap_read_ref(sp, &node->child);
+    }
+    node->priv = NULL;
+
+    switch (nodetype) {
+    case LYS_CONTAINER:
+        snap_parse_array(sp, &((struct lys_node_container *)node)->when, 1, sizeof(struct lys_when), snap_parse_when);
+        snap_parse_array(sp, &((struct lys_node_container *)node)->must, ((struct lys_node_container *)node)->must_size,
+                         sizeof(struct lys_restr), snap_parse_restr);
+        snap_parse_array(sp, &((struct lys_node_container *)node)->tpdf, ((struct lys_node_container *)node)->tpdf_size,
+                         sizeof(struct lys_tpdf), snap_parse_tpdf);
+        ((struct lys_node_container *)node)->presence = snap_read_str(sp);
+        break;
+    case LYS_CHOICE:
+        snap_parse_array(sp, &((struct lys_node_choice *)node)->when, 1, sizeof(struct lys_when), snap_parse_when);
+        snap_read_ref(sp, &((struct lys_node_choice *)node)->dflt);
+        break;
+    case LYS_LEAF:
+        snap_parse_array(sp, &((struct lys_node_leaf *)node)->when, 1, sizeof(struct lys_when), snap_parse_when);
+        snap_parse_array(sp, &((struct lys_node_leaf *)node)->must, ((struct lys_node_leaf *)node)->must_size,
+                         sizeof(struct lys_restr), snap_parse_restr);
+        snap_parse_type(sp, &((struct lys_node_leaf *)node)->type);
+        ((struct lys_node_leaf *)node)->units = snap_read_str(sp);
+        ((struct lys_node_leaf *)node)->dflt = snap_read_str(sp);
+        break;
+    case LYS_LEAFLIST:
+        snap_parse_array(sp, &((struct lys_node_leaflist *)node)->when, 1, sizeof(struct lys_when), snap_parse_when);
+        snap_parse_array(sp, &((struct lys_node_leaflist *)node)->must, ((struct lys_node_leaflist *)node)->must_size,
+                         sizeof(struct lys_restr), snap_parse_restr);
+        snap_parse_type(sp, &((struct lys_node_leaflist *)node)->type);
+        ((struct lys_node_leaflist *)node)->units = snap_read_str(sp);
+        snap_parse_strs(sp, &((struct lys_node_leaflist *)node)->dflt, ((struct lys_node_leaflist *)node)->dflt_size);
+        break;
+    case LYS_LIST:
+        snap_parse_array(sp, &((struct lys_node_list *)node)->when, 1, sizeof(struct lys_when), snap_parse_when);
+        snap_parse_array(sp, &((struct lys_node_list *)node)->must, ((struct lys_node_list *)node)->must_size,
+                         sizeof(struct lys_restr), snap_parse_restr);
+        snap_parse_array(sp, &((struct lys_node_list *)node)->tpdf, ((struct lys_node_list *)node)->tpdf_size,
+                         sizeof(struct lys_tpdf), snap_parse_tpdf);
+        snap_parse_refs(sp, &((struct lys_node_list *)node)->keys, ((struct lys_node_list *)node)->keys_size);
+        snap_parse_array(sp, &((struct lys_node_list *)node)->unique, ((struct lys_node_list *)node)->unique_size,
+                         sizeof(struct lys_unique), snap_parse_unique);
+        ((struct lys_node_list *)node)->keys_str = snap_read_str(sp);
+        break;
+    case LYS_ANYXML:
+    case LYS_ANYDATA:
+        snap_parse_array(sp, &((struct lys_node_anydata *)node)->when, 1, sizeof(struct lys_when), snap_parse_when);
+        snap_parse_array(sp, &((struct lys_node_anydata *)node)->must, ((struct lys_node_anydata *)node)->must_size,
+                         sizeof(struct lys_restr), snap_parse_restr);
+        break;
+    case LYS_USES:
+        snap_parse_array(sp, &((struct lys_node_uses *)node)->when, 1, sizeof(struct lys_when), snap_parse_when);
+        snap_parse_array(sp, &((struct lys_node_uses *)node)->refine, ((struct lys_node_uses *)node)->refine_size,
+                         sizeof(struct lys_refine), snap_parse_refine);
+        snap_parse_array(sp, &((struct lys_node_uses *)node)->augment, ((struct lys_node_uses *)node)->augment_size,
+                         sizeof(struct lys_node_augment), snap_parse_augment);
+        snap_read_ref(sp, &((struct lys_node_uses *)node)->grp);
+        break;
+    case LYS_CASE:
+        snap_parse_array(sp, &((struct lys_node_case *)node)->when, 1, sizeof(struct lys_when), snap_parse_when);
+        break;
+    case LYS_GROUPING:
+        snap_parse_array(sp, &((struct lys_node_grp *)node)->tpdf, ((struct lys_node_grp *)node)->tpdf_size,
+                         sizeof(struct lys_tpdf), snap_parse_tpdf);
+        break;
+    case LYS_RPC:
+    case LYS_ACTION:
+        snap_parse_array(sp, &((struct lys_node_rpc_action *)node)->tpdf, ((struct lys_node_rpc_action *)node)->tpdf_size,
+                         sizeof(struct lys_tpdf), snap_parse_tpdf);
+        break;
+    case LYS_INPUT:
+    case LYS_OUTPUT:
+        snap_parse_array(sp, &((struct lys_node_inout *)node)->tpdf, ((struct lys_node_inout *)node)->tpdf_size,
+                         sizeof(struct lys_tpdf), snap_parse_tpdf);
+        snap_parse_array(sp, &((struct lys_node_inout *)node)->must, ((struct lys_node_inout *)node)->must_size,
+                         sizeof(struct lys_restr), snap_parse_restr);
+        break;
+    case LYS_NOTIF:
+        snap_parse_array(sp, &((struct lys_node_notif *)node)->tpdf, ((struct lys_node_notif *)node)->tpdf_size,
+                         sizeof(struct lys_tpdf), snap_parse_tpdf);
+        snap_parse_array(sp, &((struct lys_node_notif *)node)->must, ((struct lys_node_notif *)node)->must_size,
+                         sizeof(struct lys_restr), snap_parse_restr);
+        break;
+    default:
+        break;
+    }
+
+    /* the children are connected by the references */
+    snap_parse_siblings(sp);
+    return node;
+}
+
+static void
+snap_parse_siblings(struct snap_parse *sp)
+{
+    uint64_t count, i;
+
+    count = snap_read_num(sp);
+    for (i = 0; (i < count) && !sp->err; ++i) {
+        snap_parse_node(sp);
+    }
+}
+
+static struct lys_module *
+snap_parse_module(struct snap_parse *sp, int submodule)
+{
+    struct lys_module *mod;
+    size_t size;
+    uint8_t u;
+
+    size = submodule ? sizeof(struct lys_submodule) : sizeof(struct lys_module);
+    mod = snap_alloc(sp, size);
+    if (!mod) {
+        return NULL;
+    }
+    snap_obj(sp, mod);
+    snap_read(sp, mod, size);
+    if (mod->type != submodule) {
+        snap_parse_invalid(sp);
+        return mod;
+    }
+    mod->ctx = sp->ctx;
+
+    mod->name = snap_read_str(sp);
+    mod->prefix = snap_read_str(sp);
+    mod->dsc = snap_read_str(sp);
+    mod->ref = snap_read_str(sp);
+    mod->org = snap_read_str(sp);
+    mod->contact = snap_read_str(sp);
+    mod->filepath = snap_read_str(sp);
+
+    snap_parse_array(sp, &mod->rev, mod->rev_size, sizeof *mod->rev, snap_parse_revision);
+    snap_parse_array(sp, &mod->imp, mod->imp_size, sizeof *mod->imp, snap_parse_import);
+
+    mod->inc = NULL;
+    if (snap_read_num(sp) && !snap_check(sp, mod->inc_size * sizeof *mod->inc)) {
+        mod->inc = snap_alloc(sp, mod->inc_size * sizeof *mod->inc);
+        if (mod->inc) {
+            snap_read(sp, mod->inc, mod->inc_size * sizeof *mod->inc);
+        }
+    }
+    for (u = 0; mod->inc && (u < mod->inc_size) && !sp->err; ++u) {
+        snap_obj(sp, &mod->inc[u]);
+        mod->inc[u].dsc = snap_read_str(sp);
+        mod->inc[u].ref = snap_read_str(sp);
+        snap_parse_exts(sp, &mod->inc[u].ext, mod->inc[u].ext_size);
+        if (submodule) {
+            snap_read_ref(sp, &mod->inc[u].submodule);
+        } else if (snap_read_num(sp)) {
+            mod->inc[u].submodule = (struct lys_submodule *)snap_parse_module(sp, 1);
+        } else {
+            mod->inc[u].submodule = NULL;
+        }
+    }
+
+    snap_parse_array(sp, &mod->tpdf, mod->tpdf_size, sizeof *mod->tpdf, snap_parse_tpdf);
+    snap_parse_array(sp, &mod->ident, mod->ident_size, sizeof *mod->ident, snap_parse_ident);
+    snap_parse_array(sp, &mod->features, mod->features_size, sizeof *mod->features, snap_parse_feature);
+    snap_parse_array(sp, &mod->augment, mod->augment_size, sizeof *mod->augment, snap_parse_augment);
+    snap_parse_array(sp, &mod->deviation, mod->deviation_size, sizeof *mod->deviation, snap_parse_deviation);
+    snap_parse_array(sp, &mod->extensions, mod->extensions_size, sizeof *mod->extensions, snap_parse_extdef);
+    snap_parse_exts(sp, &mod->ext, mod->ext_size);
+
+    if (submodule) {
+        snap_read_ref(sp, &((struct lys_submodule *)mod)->belongsto);
+    } else {
+        mod->ns = snap_read_str(sp);
+        snap_read_ref(sp, &mod->data);
+        snap_parse_siblings(sp);
+    }
+
+    return mod;
+}
+
+/**
+ * @brief Finish the loaded objects - fill the references, create the sets, find the extension plugins
+ * and compile the patterns.
+ */
+static int
+snap_parse_finish(struct snap_parse *sp)
+{
+    struct snap_fix *fix;
+    struct snap_setfix *setfix;
+    struct snap_extdef *extdef;
+    struct snap_complex *cplx;
+    struct lyext_plugin_complex *plugin;
+    const char *rev;
+    uint32_t i, j, id;
+
+    for (i = 0; i < sp->fixes.count; ++i) {
+        fix = &((struct snap_fix *)sp->fixes.items)[i];
+        *fix->slot = sp->objs[fix->id];
+    }
+
+    for (i = 0; i < sp->extdefs.count; ++i) {
+        extdef = &((struct snap_extdef *)sp->extdefs.items)[i];
+        rev = extdef->def->module->rev ? extdef->def->module->rev[0].date : NULL;
+        extdef->def->plugin = ext_get_plugin(extdef->def->name, extdef->def->module->name, rev);
+        if ((uint64_t)(extdef->def->plugin ? extdef->def->plugin->type + 1 : 0) != extdef->plugin_type) {
+            LOGERR(LY_EINVAL, "Extension plugin for \"%s:%s\" differs from the one used to create the schema snapshot.",
+                   extdef->def->module->name, extdef->def->name);
+            return EXIT_FAILURE;
+        }
+    }
+
+    for (i = 0; i < sp->complexes.count; ++i) {
+        cplx = &((struct snap_complex *)sp->complexes.items)[i];
+        plugin = (struct lyext_plugin_complex *)cplx->ext->def->plugin;
+        if (plugin && (plugin->type == LYEXT_COMPLEX) && (plugin->instance_size == cplx->size)) {
+            for (j = 0; plugin->substmt[j].stmt && (plugin->substmt[j].stmt == cplx->substmt[j].stmt)
+                    && (plugin->substmt[j].offset == cplx->substmt[j].offset)
+                    && (plugin->substmt[j].cardinality == cplx->substmt[j].cardinality); ++j);
+            if (!plugin->substmt[j].stmt && !cplx->substmt[j].stmt) {
+                cplx->ext->substmt = plugin->substmt;
+                continue;
+            }
+        }
+        LOGERR(LY_EINVAL, "Extension plugin for \"%s:%s\" differs from the one used to create the schema snapshot.",
+               cplx->ext->def->module->name, cplx->ext->def->name);
+        return EXIT_FAILURE;
+    }
+
+    for (i = 0; i < sp->setfixes.count; ++i) {
+        setfix = &((struct snap_setfix *)sp->setfixes.items)[i];
+        *setfix->slot = ly_set_new();
+        if (!*setfix->slot) {
+            return EXIT_FAILURE;
+        }
+        sp->pos = setfix->pos;
+        for (j = 0; j < setfix->count; ++j) {
+            id = snap_read_id(sp);
+            if (!id || (id > sp->obj_count)) {
+                snap_parse_invalid(sp);
+                return EXIT_FAILURE;
+            }
+            if (ly_set_add(*setfix->slot, sp->objs[id], LY_SET_OPT_USEASLIST) == -1) {
+                return EXIT_FAILURE;
+            }
+        }
+    }
+
+    /* the patterns are compiled lazily (again) if it fails */
+    for (i = 0; i < sp->pattypes.count; ++i) {
+        lyp_precompile_type_patterns(((struct lys_type **)sp->pattypes.items)[i]);
+    }
+
+    return EXIT_SUCCESS;
+}
+
+int
+lys_snapshot_parse(struct ly_ctx *ctx, const char *data, size_t size)
+{
+    struct snap_parse sp;
+    struct lys_module **mods = NULL, **list;
+    struct snap_setfix *setfix;
+    uint64_t mod_count = 0, flags, module_set_id, refs, len, i;
+    uint32_t length, u;
+    const char *str;
+    int ret = EXIT_FAILURE;
+
+    memset(&sp, 0, sizeof sp);
+    sp.ctx = ctx;
+    sp.data = data;
+    sp.len = size;
+
+    /* header */
+    if ((size < LYS_SNAPSHOT_HEADER_SIZE) || memcmp(data, LYS_SNAPSHOT_MAGIC, 3)) {
+        LOGERR(LY_EINVAL, "Invalid schema snapshot, wrong magic number.");
+        return EXIT_FAILURE;
+    }
+    if (data[3] != LYS_SNAPSHOT_VERSION) {
+        LOGERR(LY_EINVAL, "Unsupported schema snapshot version %d.", data[3]);
+        return EXIT_FAILURE;
+    }
+    length = (uint8_t)data[4] | ((uint8_t)data[5] << 8) | ((uint8_t)data[6] << 16) | ((uint32_t)(uint8_t)data[7] << 24);
+    if ((length < LYS_SNAPSHOT_HEADER_SIZE) || (length > size)) {
+        LOGERR(LY_EINVAL, "Invalid schema snapshot, wrong length.");
+        return EXIT_FAILURE;
+    }
+    sp.len = length;
+    sp.pos = LYS_SNAPSHOT_HEADER_SIZE;
+
+    if ((snap_read_num(&sp) != sizeof(void *)) || (snap_read_num(&sp) != LY_VERSION_MAJOR)
+            || (snap_read_num(&sp) != LY_VERSION_MINOR) || (snap_read_num(&sp) != LY_VERSION_MICRO)) {
+        if (!sp.err) {
+            LOGERR(LY_EINVAL, "Schema snapshot was created by a different libyang build.");
+        }
+        return EXIT_FAILURE;
+    }
+
+    /* the objects and the string table, each of them takes at least a byte */
+    i = snap_read_num(&sp);
+    if ((i < 2 * (LY_DATA_TYPE_COUNT - 1)) || snap_check(&sp, i - 2 * (LY_DATA_TYPE_COUNT - 1))) {
+        snap_parse_invalid(&sp);
+        return EXIT_FAILURE;
+    }
+    sp.obj_count = i;
+    i = snap_read_num(&sp);
+    if (snap_check(&sp, i)) {
+        return EXIT_FAILURE;
+    }
+    sp.str_count = i;
+
+    sp.objs = malloc((sp.obj_count + 1) * sizeof *sp.objs);
+    sp.strs = malloc((sp.str_count ? sp.str_count : 1) * sizeof *sp.strs);
+    if (!sp.objs || !sp.strs) {
+        LOGMEM;
+        goto cleanup;
+    }
+    for (u = 1; u < LY_DATA_TYPE_COUNT; ++u) {
+        snap_obj(&sp, ly_types[u]);
+        snap_obj(&sp, &ly_types[u]->type);
+    }
+
+    /* strings are put into the dictionary with all their references at once */
+    for (u = 0; (u < sp.str_count) && !sp.err; ++u) {
+        refs = snap_read_num(&sp);
+        len = snap_read_num(&sp);
+        if (snap_check(&sp, len) || (refs > sp.len)) {
+            snap_parse_invalid(&sp);
+            break;
+        }
+        do {
+            str = lydict_insert(ctx, len ? sp.data + sp.pos : "", len);
+        } while (str && (refs-- > 1));
+        if (!str) {
+            sp.err = 1;
+            break;
+        }
+        sp.strs[u] = str;
+        sp.pos += len;
+    }
+
+    /* modules */
+    mod_count = snap_read_num(&sp);
+    flags = snap_read_num(&sp);
+    module_set_id = snap_read_num(&sp);
+    if (!sp.err && ((mod_count < LY_INTERNAL_MODULE_COUNT) || snap_check(&sp, mod_count))) {
+        snap_parse_invalid(&sp);
+    }
+    if (sp.err) {
+        goto cleanup;
+    }
+    mods = calloc(mod_count, sizeof *mods);
+    if (!mods) {
+        LOGMEM;
+        goto cleanup;
+    }
+    for (i = 0; (i < mod_count) && !sp.err; ++i) {
+        mods[i] = snap_parse_module(&sp, 0);
+    }
+    if (!sp.err && (sp.obj_last != sp.obj_count)) {
+        snap_parse_invalid(&sp);
+    }
+    if (sp.err || snap_parse_finish(&sp)) {
+        goto cleanup;
+    }
+
+    /* add the modules into the context */
+    if ((uint64_t)ctx->models.size < mod_count) {
+        list = realloc(ctx->models.list, mod_count * sizeof *list);
+        if (!list) {
+            LOGMEM;
+            goto cleanup;
+        }
+        ctx->models.list = list;
+        ctx->models.size = mod_count;
+    }
+    for (i = 0; i < mod_count; ++i) {
+        if (ly_ctx_mod_index_add(mods[i])) {
+            /* the rest of the modules cannot be freed separately */
+            goto cleanup;
+        }
+        ctx->models.list[ctx->models.used++] = mods[i];
+    }
+    ctx->models.flags |= flags;
+    ctx->models.module_set_id = module_set_id;
+    ret = EXIT_SUCCESS;
+
+cleanup:
+    if (ret && !ctx->models.used) {
+        /* nothing was connected, just free all the memory */
+        for (u = 0; u < sp.setfixes.count; ++u) {
+            setfix = &((struct snap_setfix *)sp.setfixes.items)[u];
+            ly_set_free(*setfix->slot);
+        }
+        for (u = 0; u < sp.pattypes.count; ++u) {
+            lyp_free_type_patterns(((struct lys_type **)sp.pattypes.items)[u]);
+        }
+        for (u = 0; u < sp.allocs.count; ++u) {
+            free(((void **)sp.allocs.items)[u]);
+        }
+    }
+    for (u = 0; u < sp.complexes.count; ++u) {
+        free(((struct snap_complex *)sp.complexes.items)[u].substmt);
+    }
+    free(sp.allocs.items);
+    free(sp.fixes.items);
+    free(sp.setfixes.items);
+    free(sp.extdefs.items);
+    free(sp.complexes.items);
+    free(sp.pattypes.items);
+    free(sp.objs);
+    free(sp.strs);
+    free(mods);
+    return ret;
+}
@@ -37,9 +37,13 @@
 #include "tree_internal.h"
 #include "validation.h"
 #include "xpath.h"
+#include "dict_private.h"
+#include "hash_table.h"
+
+static int ly_set_append(struct ly_set *set, void *node);
 
 /**
- * @brief get the list of \p data's siblings of the given schema
+ * @brief get the list of \p data's siblings of the given schema, \p set must not be created by ly_set_new()
  */
 static int
 lyd_get_node_siblings(const struct lyd_node *data, const struct lys_node *schema, struct ly_set *set)
@@ -57,7 +61,7 @@ lyd_get_node_siblings(const struct lyd_node *data, const struct lys_node *schema
 
     LY_TREE_FOR(data, iter) {
         if (iter->schema == schema) {
-            ly_set_add(set, (void*)iter, LY_SET_OPT_USEASLIST);
+            ly_set_append(set, (void*)iter);
         }
     }
 
@@ -97,10 +101,10 @@ lyd_check_mandatory_data(struct lyd_node *root, struct lyd_node *last_parent,
                 if (!dummy) {
                     return EXIT_FAILURE;
                 }
-                if (!dummy->parent) {
+                if (!dummy->parent && root) {
                     /* connect dummy nodes into the data tree, insert it before the root
                      * to optimize later unlinking (lyd_free()) */
-                    lyd_insert_before(root, dummy);
+                    lyd_insert_nextto(root, dummy, 1, 0);
                 }
                 for (current = dummy; current; current = current->child) {
                     ly_vlog_hide(1);
@@ -108,6 +112,7 @@ lyd_check_mandatory_data(struct lyd_node *root, struct lyd_node *last_parent,
                     ly_vlog_hide(0);
                     if (!state) {
                         /* when evaluates to false */
+                        dummy->validity |= LYD_VAL_INUSE;
                         lyd_free(dummy);
                         ly_err_clean(1);
                         return EXIT_SUCCESS;
@@ -118,6 +123,7 @@ lyd_check_mandatory_data(struct lyd_node *root, struct lyd_node *last_parent,
                         break;
                     }
                 }
+                dummy->validity |= LYD_VAL_INUSE;
                 lyd_free(dummy);
             }
         }
@@ -191,7 +197,8 @@ lyd_check_mandatory_data(struct lyd_node *root, struct lyd_node *last_parent,
  *                 instances of the schema node being checked
  * @param[in] schema The schema node being checked for mandatory nodes
  * @param[in] toplevel, see the \p root parameter description
- * @param[in] options @ref parseroptions to specify the type of the data tree.
+ * @param[in] options @ref parseroptions to specify the type of the data tree, with #LYD_OPT_SHALLOW the subtrees
+ *                 of the present list and container instances are not checked.
  * @return EXIT_SUCCESS or EXIT_FAILURE if there are missing mandatory nodes
  */
 static int
@@ -200,7 +207,7 @@ lyd_check_mandatory_subtree(struct lyd_node *tree, struct lyd_node *subtree, str
 {
     struct lys_node *siter, *siter_prev;
     struct lyd_node *iter;
-    struct ly_set *present = NULL;
+    struct ly_set *present = NULL, present_set = {0, 0, {NULL}};
     unsigned int u;
     int ret = EXIT_FAILURE;
 
@@ -208,10 +215,7 @@ lyd_check_mandatory_subtree(struct lyd_node *tree, struct lyd_node *subtree, str
 
     if (schema->nodetype & (LYS_LEAF | LYS_LIST | LYS_LEAFLIST | LYS_ANYDATA | LYS_CONTAINER)) {
         /* data node */
-        present = ly_set_new();
-        if (!present) {
-            goto error;
-        }
+        present = &present_set;
         if ((toplevel && tree) || (!toplevel && subtree)) {
             if (toplevel) {
                 lyd_get_node_siblings(tree, schema, present);
@@ -238,7 +242,7 @@ lyd_check_mandatory_subtree(struct lyd_node *tree, struct lyd_node *subtree, str
         }
 
         /* go recursively */
-        for (u = 0; u < present->number; u++) {
+        for (u = 0; !(options & LYD_OPT_SHALLOW) && (u < present->number); u++) {
             LY_TREE_FOR(schema->child, siter) {
                 if (lyd_check_mandatory_subtree(tree, present->set.d[u], present->set.d[u], siter, 0, options)) {
                     goto error;
@@ -248,7 +252,8 @@ lyd_check_mandatory_subtree(struct lyd_node *tree, struct lyd_node *subtree, str
         break;
 
     case LYS_CONTAINER:
-        if (present->number || !((struct lys_node_container *)schema)->presence) {
+        if ((present->number && !(options & LYD_OPT_SHALLOW))
+                || (!present->number && !((struct lys_node_container *)schema)->presence)) {
             /* if we have existing or non-presence container, go recursively */
             LY_TREE_FOR(schema->child, siter) {
                 if (lyd_check_mandatory_subtree(tree, present->number ? present->set.d[0] : NULL,
@@ -323,7 +328,7 @@ lyd_check_mandatory_subtree(struct lyd_node *tree, struct lyd_node *subtree, str
     ret = EXIT_SUCCESS;
 
 error:
-    ly_set_free(present);
+    free(present_set.set.g);
     return ret;
 }
 
@@ -394,41 +399,32 @@ lyd_check_mandatory_tree(struct lyd_node *root, struct ly_ctx *ctx, int options)
     return EXIT_SUCCESS;
 }
 
+/**
+ * @brief Parse data from memory.
+ *
+ * @param[in] len Length of \p data, 0 if not known. XML and JSON \p data must always be terminated.
+ */
 static struct lyd_node *
-lyd_parse_(struct ly_ctx *ctx, const struct lyd_node *rpc_act, const char *data, LYD_FORMAT format, int options,
-           const struct lyd_node *data_tree)
+lyd_parse_(struct ly_ctx *ctx, const struct lyd_node *rpc_act, const char *data, size_t len, LYD_FORMAT format,
+           int options, const struct lyd_node *data_tree)
 {
-    struct lyxml_elem *xml;
     struct lyd_node *result = NULL;
-    int xmlopt = LYXML_PARSE_MULTIROOT;
 
     if (!ctx || !data) {
         LOGERR(LY_EINVAL, "%s: Invalid parameter.", __func__);
         return NULL;
     }
 
-    if (options & LYD_OPT_NOSIBLINGS) {
-        xmlopt = 0;
-    }
-
     switch (format) {
     case LYD_XML:
-        xml = lyxml_parse_mem(ctx, data, xmlopt);
-        if (ly_errno) {
-            return NULL;
-        }
-        if (options & LYD_OPT_RPCREPLY) {
-            result = lyd_parse_xml(ctx, &xml, options, rpc_act, data_tree);
-        } else if (options & (LYD_OPT_RPC | LYD_OPT_NOTIF)) {
-            result = lyd_parse_xml(ctx, &xml, options, data_tree);
-        } else {
-            result = lyd_parse_xml(ctx, &xml, options);
-        }
-        lyxml_free_withsiblings(ctx, xml);
+        result = lyd_parse_xml_mem(ctx, data, options, rpc_act, data_tree);
         break;
     case LYD_JSON:
         result = lyd_parse_json(ctx, data, options, rpc_act, data_tree);
         break;
+    case LYD_LYB:
+        result = lyd_parse_lyb(ctx, data, len, options, rpc_act, data_tree);
+        break;
     default:
         /* error */
         return NULL;
@@ -442,46 +438,71 @@ lyd_parse_(struct ly_ctx *ctx, const struct lyd_node *rpc_act, const char *data,
     }
 }
 
-static struct lyd_node *
-lyd_parse_data_(struct ly_ctx *ctx, const char *data, LYD_FORMAT format, int options, va_list ap)
+/**
+ * @brief Check the parser options and get the variable arguments they require.
+ *
+ * @param[in] options Parser options.
+ * @param[in] ap Variable arguments of the parser function.
+ * @param[out] rpc_act Request of the parsed RPC/action reply.
+ * @param[out] data_tree Data tree for RPC/action/notification validation.
+ * @return EXIT_SUCCESS on success, EXIT_FAILURE on error.
+ */
+static int
+lyd_parse_args_(int options, va_list ap, const struct lyd_node **rpc_act, const struct lyd_node **data_tree)
 {
-    const struct lyd_node *rpc_act = NULL, *data_tree = NULL, *iter;
+    const struct lyd_node *iter;
+
+    *rpc_act = NULL;
+    *data_tree = NULL;
 
     if (lyp_check_options(options)) {
         LOGERR(LY_EINVAL, "%s: Invalid options (multiple data type flags set).", __func__);
-        return NULL;
+        return EXIT_FAILURE;
     }
 
     if (options & LYD_OPT_RPCREPLY) {
-        rpc_act = va_arg(ap, const struct lyd_node *);
-        if (!rpc_act || rpc_act->parent || !(rpc_act->schema->nodetype & (LYS_RPC | LYS_LIST | LYS_CONTAINER))) {
+        *rpc_act = va_arg(ap, const struct lyd_node *);
+        if (!(*rpc_act) || (*rpc_act)->parent
+                || !((*rpc_act)->schema->nodetype & (LYS_RPC | LYS_LIST | LYS_CONTAINER))) {
             LOGERR(LY_EINVAL, "%s: invalid variable parameter (const struct lyd_node *rpc_act).", __func__);
-            return NULL;
+            return EXIT_FAILURE;
         }
     }
     if (options & (LYD_OPT_RPC | LYD_OPT_NOTIF | LYD_OPT_RPCREPLY)) {
-        data_tree = va_arg(ap, const struct lyd_node *);
-        if (data_tree) {
-            LY_TREE_FOR(data_tree, iter) {
+        *data_tree = va_arg(ap, const struct lyd_node *);
+        if (*data_tree) {
+            LY_TREE_FOR(*data_tree, iter) {
                 if (iter->parent) {
                     /* a sibling is not top-level */
                     LOGERR(LY_EINVAL, "%s: invalid variable parameter (const struct lyd_node *data_tree).", __func__);
-                    return NULL;
+                    return EXIT_FAILURE;
                 }
             }
 
             /* move it to the beginning */
-            for (; data_tree->prev->next; data_tree = data_tree->prev);
+            for (; (*data_tree)->prev->next; *data_tree = (*data_tree)->prev);
 
             /* LYD_OPT_NOSIBLINGS cannot be set in this case */
             if (options & LYD_OPT_NOSIBLINGS) {
                 LOGERR(LY_EINVAL, "%s: invalid parameter (variable arg const struct lyd_node *data_tree with LYD_OPT_NOSIBLINGS).", __func__);
-                return NULL;
+                return EXIT_FAILURE;
             }
         }
     }
 
-    return lyd_parse_(ctx, rpc_act, data, format, options, data_tree);
+    return EXIT_SUCCESS;
+}
+
+static struct lyd_node *
+lyd_parse_data_(struct ly_ctx *ctx, const char *data, size_t len, LYD_FORMAT format, int options, va_list ap)
+{
+    const struct lyd_node *rpc_act, *data_tree;
+
+    if (lyd_parse_args_(options, ap, &rpc_act, &data_tree)) {
+        return NULL;
+    }
+
+    return lyd_parse_(ctx, rpc_act, data, len, format, options, data_tree);
 }
 
 API struct lyd_node *
@@ -491,142 +512,742 @@ lyd_parse_mem(struct ly_ctx *ctx, const char *data, LYD_FORMAT format, int optio
     struct lyd_node *result;
 
     va_start(ap, options);
-    result = lyd_parse_data_(ctx, data, format, options, ap);
+    result = lyd_parse_data_(ctx, data, 0, format, options, ap);
     va_end(ap);
 
     return result;
 }
 
-static struct lyd_node *
-lyd_parse_fd_(struct ly_ctx *ctx, int fd, LYD_FORMAT format, int options, va_list ap)
+API struct lyd_node *
+lyd_parse_mem_len(struct ly_ctx *ctx, const char *data, size_t len, LYD_FORMAT format, int options, ...)
 {
-    struct lyd_node *ret;
-    size_t length;
-    char *data;
+    va_list ap;
+    struct lyd_node *result;
+    char *str = NULL;
 
-    if (!ctx || (fd == -1)) {
+    if (!ctx || (!data && len)) {
         LOGERR(LY_EINVAL, "%s: Invalid parameter.", __func__);
         return NULL;
     }
 
-    data = lyp_mmap(fd, 0, &length);
-    if (data == MAP_FAILED) {
-        LOGERR(LY_ESYS, "Mapping file descriptor into memory failed (%s()).", __func__);
+    if (!len) {
+        /* no data */
+        data = "";
+    } else if ((format != LYD_LYB) && !memchr(data, '\0', len)) {
+        /* the text parsers need terminated data */
+        str = strndup(data, len);
+        if (!str) {
+            LOGMEM;
+            return NULL;
+        }
+        data = str;
+    }
+
+    va_start(ap, options);
+    result = lyd_parse_data_(ctx, data, len, format, options, ap);
+    va_end(ap);
+
+    free(str);
+    return result;
+}
+
+/**
+ * @brief States of the scanner looking for the ends of the top-level nodes in the pushed data.
+ */
+enum lyd_push_scan {
+    LYD_PUSH_CONTENT = 0,       /**< XML character data, JSON outside strings */
+    LYD_PUSH_TAG,               /**< XML start tag */
+    LYD_PUSH_ENDTAG,            /**< XML end tag */
+    LYD_PUSH_ATTR,              /**< XML attribute value */
+    LYD_PUSH_COMMENT,           /**< XML comment */
+    LYD_PUSH_PI,                /**< XML processing instruction */
+    LYD_PUSH_CDATA,             /**< XML CDATA section */
+    LYD_PUSH_DECL,              /**< XML markup declaration (DOCTYPE) */
+    LYD_PUSH_STRING,            /**< JSON string */
+    LYD_PUSH_ESCAPE             /**< JSON escaped character in a string */
+};
+
+/**
+ * @brief Context of the data being parsed as they are pushed into the parser.
+ *
+ * The received data are buffered only until the end of the current top-level node (XML element, member of the
+ * top-level JSON object) is found by a simple scanner, then the node is parsed and the data are dropped.
+ */
+struct lyd_push_ctx {
+    struct ly_ctx *ctx;
+    LYD_FORMAT format;
+    int options;
+    const struct lyd_node *rpc_act;
+    const struct lyd_node *data_tree;
+    struct lyd_parse_state state;   /**< state of the parsed tree, initiated with the first top-level node */
+    uint8_t started;                /**< some top-level node was parsed, the state is initiated */
+    uint8_t ended;                  /**< JSON only - the top-level end-object was received */
+    uint8_t failed;                 /**< parsing failed, the context can be only freed */
+
+    char *buf;                      /**< buffered data, always terminated by NULL byte */
+    size_t size;                    /**< allocated size of buf */
+    size_t used;                    /**< length of the buffered data */
+    size_t parsed;                  /**< offset of the data not parsed yet */
+    size_t scanned;                 /**< offset of the data not scanned yet */
+
+    enum lyd_push_scan scan;        /**< scanner state */
+    char quote;                     /**< XML attribute value quotation mark */
+    uint32_t depth;                 /**< element (XML) or object/array (JSON) nesting level */
+};
+
+static struct lyd_push_ctx *
+lyd_push_new_(struct ly_ctx *ctx, LYD_FORMAT format, int options, va_list ap)
+{
+    struct lyd_push_ctx *pctx;
+    const struct lyd_node *rpc_act, *data_tree;
+
+    ly_err_clean(1);
+
+    if (!ctx || ((format != LYD_XML) && (format != LYD_JSON))) {
+        LOGERR(LY_EINVAL, "%s: Invalid parameter.", __func__);
         return NULL;
-    } else if (!data) {
-        ly_err_clean(1);
+    }
+    if (lyd_parse_args_(options, ap, &rpc_act, &data_tree)) {
         return NULL;
     }
 
-    ret = lyd_parse_data_(ctx, data, format, options, ap);
-
-    lyp_munmap(data, length);
+    pctx = calloc(1, sizeof *pctx);
+    if (!pctx) {
+        LOGMEM;
+        return NULL;
+    }
+    pctx->ctx = ctx;
+    pctx->format = format;
+    pctx->options = options;
+    pctx->rpc_act = rpc_act;
+    pctx->data_tree = data_tree;
 
-    return ret;
+    return pctx;
 }
 
-API struct lyd_node *
-lyd_parse_fd(struct ly_ctx *ctx, int fd, LYD_FORMAT format, int options, ...)
+API struct lyd_push_ctx *
+lyd_push_new(struct ly_ctx *ctx, LYD_FORMAT format, int options, ...)
 {
-    struct lyd_node *ret;
     va_list ap;
+    struct lyd_push_ctx *pctx;
 
     va_start(ap, options);
-    ret = lyd_parse_fd_(ctx, fd, format, options, ap);
+    pctx = lyd_push_new_(ctx, format, options, ap);
     va_end(ap);
 
-    return ret;
+    return pctx;
 }
 
-API struct lyd_node *
-lyd_parse_path(struct ly_ctx *ctx, const char *path, LYD_FORMAT format, int options, ...)
+/**
+ * @brief Scan the buffered XML data for the end of a top-level element.
+ *
+ * @param[in] pctx Parser context.
+ * @param[out] end Offset right behind the end of the element.
+ * @return 1 if the end was found, 0 if more data are needed.
+ */
+static int
+lyd_push_scan_xml(struct lyd_push_ctx *pctx, size_t *end)
 {
-    int fd;
-    struct lyd_node *ret;
-    va_list ap;
+    const char *buf = pctx->buf;
+    size_t i;
 
-    if (!ctx || !path) {
-        LOGERR(LY_EINVAL, "%s: Invalid parameter.", __func__);
-        return NULL;
+    for (i = pctx->scanned; i < pctx->used; ++i) {
+        switch (pctx->scan) {
+        case LYD_PUSH_CONTENT:
+            if (buf[i] != '<') {
+                break;
+            }
+            /* markup, find out what kind of */
+            if (i + 1 == pctx->used) {
+                goto wait;
+            }
+            if (buf[i + 1] == '/') {
+                pctx->scan = LYD_PUSH_ENDTAG;
+                ++i;
+            } else if (buf[i + 1] == '?') {
+                pctx->scan = LYD_PUSH_PI;
+                ++i;
+            } else if (buf[i + 1] == '!') {
+                if (i + 9 > pctx->used && !strncmp(&buf[i], "<![CDATA[", pctx->used - i)) {
+                    goto wait;
+                } else if (i + 4 > pctx->used && !strncmp(&buf[i], "<!--", pctx->used - i)) {
+                    goto wait;
+                }
+                if (!strncmp(&buf[i], "<!--", 4)) {
+                    pctx->scan = LYD_PUSH_COMMENT;
+                    i += 3;
+                } else if (!strncmp(&buf[i], "<![CDATA[", 9)) {
+                    pctx->scan = LYD_PUSH_CDATA;
+                    i += 8;
+                } else {
+                    pctx->scan = LYD_PUSH_DECL;
+                    ++i;
+                }
+            } else {
+                pctx->scan = LYD_PUSH_TAG;
+            }
+            break;
+        case LYD_PUSH_TAG:
+            if ((buf[i] == '"') || (buf[i] == '\'')) {
+                pctx->quote = buf[i];
+                pctx->scan = LYD_PUSH_ATTR;
+            } else if (buf[i] == '>') {
+                pctx->scan = LYD_PUSH_CONTENT;
+                if (buf[i - 1] != '/') {
+                    ++pctx->depth;
+                } else if (!pctx->depth) {
+                    /* empty top-level element */
+                    goto found;
+                }
+            }
+            break;
+        case LYD_PUSH_ENDTAG:
+            if (buf[i] == '>') {
+                pctx->scan = LYD_PUSH_CONTENT;
+                if (pctx->depth) {
+                    --pctx->depth;
+                }
+                if (!pctx->depth) {
+                    goto found;
+                }
+            }
+            break;
+        case LYD_PUSH_ATTR:
+            if (buf[i] == pctx->quote) {
+                pctx->scan = LYD_PUSH_TAG;
+            }
+            break;
+        case LYD_PUSH_COMMENT:
+        case LYD_PUSH_PI:
+        case LYD_PUSH_CDATA:
+            if (buf[i] != (pctx->scan == LYD_PUSH_COMMENT ? '-' : (pctx->scan == LYD_PUSH_PI ? '?' : ']'))) {
+                break;
+            }
+            if (pctx->scan == LYD_PUSH_PI) {
+                if (i + 2 > pctx->used) {
+                    goto wait;
+                } else if (buf[i + 1] == '>') {
+                    pctx->scan = LYD_PUSH_CONTENT;
+                    ++i;
+                }
+            } else {
+                if (i + 3 > pctx->used) {
+                    goto wait;
+                } else if (buf[i + 1] == buf[i] && buf[i + 2] == '>') {
+                    pctx->scan = LYD_PUSH_CONTENT;
+                    i += 2;
+                }
+            }
+            break;
+        case LYD_PUSH_DECL:
+            if (buf[i] == '>') {
+                pctx->scan = LYD_PUSH_CONTENT;
+            }
+            break;
+        default:
+            LOGINT;
+            break;
+        }
     }
 
-    fd = open(path, O_RDONLY);
-    if (fd == -1) {
-        LOGERR(LY_ESYS, "Failed to open data file \"%s\" (%s).", path, strerror(errno));
-        return NULL;
-    }
+wait:
+    pctx->scanned = i;
+    return 0;
 
-    va_start(ap, options);
-    ret = lyd_parse_fd_(ctx, fd, format, options, ap);
+found:
+    pctx->scanned = *end = i + 1;
+    return 1;
+}
 
-    va_end(ap);
-    close(fd);
+/**
+ * @brief Scan the buffered JSON data for the end of a member of the top-level object.
+ *
+ * @param[in] pctx Parser context.
+ * @param[out] end Offset of the value-separator or end-object following the member.
+ * @return 1 if the end was found, 0 if more data are needed, -1 on error.
+ */
+static int
+lyd_push_scan_json(struct lyd_push_ctx *pctx, size_t *end)
+{
+    const char *buf = pctx->buf;
+    size_t i;
+
+    for (i = pctx->scanned; i < pctx->used; ++i) {
+        switch (pctx->scan) {
+        case LYD_PUSH_CONTENT:
+            if (!pctx->depth) {
+                /* before the top-level begin-object */
+                if ((buf[i] == ' ') || (buf[i] == '\t') || (buf[i] == '\n') || (buf[i] == '\r')) {
+                    break;
+                } else if (buf[i] != '{') {
+                    LOGVAL(LYE_XML_INVAL, LY_VLOG_NONE, NULL, "JSON data (missing top level begin-object)");
+                    return -1;
+                }
+                pctx->parsed = i;
+                pctx->depth = 1;
+                break;
+            }
 
-    return ret;
+            switch (buf[i]) {
+            case '"':
+                pctx->scan = LYD_PUSH_STRING;
+                break;
+            case '{':
+            case '[':
+                ++pctx->depth;
+                break;
+            case '}':
+            case ']':
+                if (!--pctx->depth) {
+                    goto found;
+                }
+                break;
+            case ',':
+                if (pctx->depth == 1) {
+                    goto found;
+                }
+                break;
+            }
+            break;
+        case LYD_PUSH_STRING:
+            if (buf[i] == '\\') {
+                pctx->scan = LYD_PUSH_ESCAPE;
+            } else if (buf[i] == '"') {
+                pctx->scan = LYD_PUSH_CONTENT;
+            }
+            break;
+        case LYD_PUSH_ESCAPE:
+            pctx->scan = LYD_PUSH_STRING;
+            break;
+        default:
+            LOGINT;
+            break;
+        }
+    }
+
+    pctx->scanned = i;
+    return 0;
+
+found:
+    *end = i;
+    pctx->scanned = i + 1;
+    return 1;
 }
 
-static struct lys_node *
-lyd_new_find_schema(struct lyd_node *parent, const struct lys_module *module, int rpc_output)
+/**
+ * @brief Parse the buffered data up to the end of a top-level node.
+ *
+ * @param[in] pctx Parser context.
+ * @param[in] end Offset of the end of the data to parse.
+ * @return EXIT_SUCCESS on success, EXIT_FAILURE on error.
+ */
+static int
+lyd_push_parse(struct lyd_push_ctx *pctx, size_t end)
 {
-    struct lys_node *siblings;
+    const char *data;
+    char c;
+    unsigned int r;
+    int ret;
 
-    if (!parent) {
-        siblings = module->data;
+    if (!pctx->started) {
+        if (lyp_data_parse_init(&pctx->state, pctx->ctx, pctx->options, pctx->rpc_act, pctx->data_tree)) {
+            return EXIT_FAILURE;
+        }
+        pctx->started = 1;
+    }
+
+    /* hide the following data from the parser */
+    c = pctx->buf[end];
+    pctx->buf[end] = '\0';
+    data = &pctx->buf[pctx->parsed];
+
+    if (pctx->format == LYD_XML) {
+        ret = lyd_parse_xml_roots(&pctx->state, &data);
+        pctx->buf[end] = c;
+        if (ret || ly_errno) {
+            return EXIT_FAILURE;
+        }
+        pctx->parsed = data - pctx->buf;
     } else {
-        if (!parent->schema) {
-            return NULL;
+        r = lyd_parse_json_members(&pctx->state, data);
+        pctx->buf[end] = c;
+        if (!r || ly_errno) {
+            return EXIT_FAILURE;
         }
-        siblings = parent->schema->child;
-        if (siblings && (siblings->nodetype == (rpc_output ? LYS_INPUT : LYS_OUTPUT))) {
-            siblings = siblings->next;
+        if ((pctx->parsed + r != end) || (pctx->state.done && (c == ',')) || (!pctx->depth && (c != '}'))) {
+            /* there is something else than separator or the end-object after the member */
+            LOGVAL(LYE_XML_INVAL, LY_VLOG_NONE, NULL, "JSON data (missing top-level end-object)");
+            return EXIT_FAILURE;
         }
-        if (siblings && (siblings->nodetype == (rpc_output ? LYS_OUTPUT : LYS_INPUT))) {
-            siblings = siblings->child;
+        /* the value-separator is parsed as the beginning of the next member */
+        pctx->parsed = end;
+        if (!pctx->depth) {
+            /* the rest of data is not parsed */
+            pctx->ended = 1;
+            pctx->used = pctx->parsed = pctx->scanned = 0;
         }
     }
 
-    return siblings;
+    return EXIT_SUCCESS;
 }
 
-struct lyd_node *
-_lyd_new(struct lyd_node *parent, const struct lys_node *schema, int dflt)
+API int
+lyd_push_data(struct lyd_push_ctx *pctx, const char *data, size_t len)
 {
-    struct lyd_node *ret;
+    size_t end, size;
+    char *buf;
+    int r;
 
-    ret = calloc(1, sizeof *ret);
-    if (!ret) {
-        LOGMEM;
-        return NULL;
+    if (!pctx || (!data && len)) {
+        LOGERR(LY_EINVAL, "%s: Invalid parameter.", __func__);
+        return EXIT_FAILURE;
+    } else if (pctx->failed) {
+        LOGERR(LY_EINVAL, "%s: Parsing the data already failed.", __func__);
+        return EXIT_FAILURE;
     }
-    ret->schema = (struct lys_node *)schema;
-    ret->validity = ly_new_node_validity(schema);
-    if (resolve_applies_when(schema, 0, NULL)) {
-        ret->when_status = LYD_WHEN;
+    ly_err_clean(1);
+
+    if (pctx->ended) {
+        /* data after the top-level JSON object are ignored */
+        return EXIT_SUCCESS;
     }
-    ret->prev = ret;
-    ret->dflt = dflt;
-    if (parent) {
-        if (lyd_insert(parent, ret)) {
-            lyd_free(ret);
-            return NULL;
+
+    if (pctx->used + len + 1 > pctx->size) {
+        /* drop the already parsed data */
+        if (pctx->parsed) {
+            memmove(pctx->buf, &pctx->buf[pctx->parsed], pctx->used - pctx->parsed);
+            pctx->used -= pctx->parsed;
+            pctx->scanned -= pctx->parsed;
+            pctx->parsed = 0;
+        }
+        if (pctx->used + len + 1 > pctx->size) {
+            for (size = pctx->size ? pctx->size : LYD_PUSH_BUF_SIZE; size < pctx->used + len + 1; size <<= 1);
+            buf = realloc(pctx->buf, size);
+            if (!buf) {
+                LOGMEM;
+                pctx->failed = 1;
+                return EXIT_FAILURE;
+            }
+            pctx->buf = buf;
+            pctx->size = size;
         }
     }
-    return ret;
+    memcpy(&pctx->buf[pctx->used], data, len);
+    pctx->used += len;
+    pctx->buf[pctx->used] = '\0';
+
+    /* parse all the complete top-level nodes */
+    while (!pctx->state.done && !pctx->ended) {
+        if (pctx->format == LYD_XML) {
+            r = lyd_push_scan_xml(pctx, &end);
+        } else {
+            r = lyd_push_scan_json(pctx, &end);
+        }
+        if (!r) {
+            break;
+        } else if ((r == -1) || lyd_push_parse(pctx, end)) {
+            pctx->failed = 1;
+            return EXIT_FAILURE;
+        }
+    }
+
+    return EXIT_SUCCESS;
 }
 
 API struct lyd_node *
-lyd_new(struct lyd_node *parent, const struct lys_module *module, const char *name)
+lyd_push_finish(struct lyd_push_ctx *pctx)
 {
-    const struct lys_node *snode = NULL, *siblings;
+    struct lyd_node *result = NULL;
+    const char *data;
+    unsigned int r;
 
-    if ((!parent && !module) || !name) {
-        ly_errno = LY_EINVAL;
+    if (!pctx) {
+        LOGERR(LY_EINVAL, "%s: Invalid parameter.", __func__);
         return NULL;
-    }
-
-    siblings = lyd_new_find_schema(parent, module, 0);
-    if (!siblings) {
-        ly_errno = LY_EINVAL;
+    } else if (pctx->failed) {
+        LOGERR(LY_EINVAL, "%s: Parsing the data already failed.", __func__);
+        lyd_push_free(pctx);
+        return NULL;
+    }
+    ly_err_clean(1);
+
+    data = pctx->buf ? &pctx->buf[pctx->parsed] : "";
+    if (!pctx->started) {
+        /* no top-level node was complete, parse the data at once (there can be even none) */
+        result = lyd_parse_(pctx->ctx, pctx->rpc_act, data, 0, pctx->format, pctx->options, pctx->data_tree);
+        lyd_push_free(pctx);
+        return result;
+    }
+
+    if (pctx->format == LYD_XML) {
+        if (lyd_parse_xml_roots(&pctx->state, &data)) {
+            goto cleanup;
+        }
+        result = lyp_data_parse_finish(&pctx->state);
+    } else {
+        if (!pctx->ended) {
+            /* parse the rest to get the same error as lyd_parse_mem() */
+            if (!pctx->state.done) {
+                r = lyd_parse_json_members(&pctx->state, data);
+                if (!r) {
+                    goto cleanup;
+                }
+            }
+            LOGVAL(LYE_XML_INVAL, LY_VLOG_NONE, NULL, "JSON data (missing top-level end-object)");
+            goto cleanup;
+        }
+        result = lyd_parse_json_finish(&pctx->state);
+    }
+
+    if (ly_errno) {
+        lyd_free_withsiblings(result);
+        result = NULL;
+    }
+
+cleanup:
+    lyd_push_free(pctx);
+    return result;
+}
+
+API void
+lyd_push_free(struct lyd_push_ctx *pctx)
+{
+    if (!pctx) {
+        return;
+    }
+
+    if (pctx->started) {
+        lyp_data_parse_clean(&pctx->state);
+    }
+    free(pctx->buf);
+    free(pctx);
+}
+
+/**
+ * @brief Parse data read from a file descriptor which cannot be mapped into memory.
+ */
+static struct lyd_node *
+lyd_parse_fd_push(struct ly_ctx *ctx, int fd, LYD_FORMAT format, int options, va_list ap)
+{
+    struct lyd_push_ctx *pctx;
+    char buf[LYD_PUSH_BUF_SIZE];
+    ssize_t r;
+    size_t total = 0;
+
+    pctx = lyd_push_new_(ctx, format, options, ap);
+    if (!pctx) {
+        return NULL;
+    }
+
+    while ((r = read(fd, buf, sizeof buf))) {
+        if (r == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            LOGERR(LY_ESYS, "Reading data from the file descriptor failed (%s).", strerror(errno));
+            lyd_push_free(pctx);
+            return NULL;
+        }
+        if (lyd_push_data(pctx, buf, r)) {
+            lyd_push_free(pctx);
+            return NULL;
+        }
+        total += r;
+    }
+
+    if (!total) {
+        /* the same as for an empty file */
+        lyd_push_free(pctx);
+        ly_err_clean(1);
+        return NULL;
+    }
+    return lyd_push_finish(pctx);
+}
+
+/**
+ * @brief Parse LYB data read from a file descriptor which cannot be mapped into memory, the binary data cannot
+ * be pushed by their top-level nodes, so they are read whole.
+ */
+static struct lyd_node *
+lyd_parse_fd_lyb(struct ly_ctx *ctx, int fd, int options, va_list ap)
+{
+    struct lyd_node *ret;
+    char *data = NULL;
+    size_t size = 0, used = 0;
+    ssize_t r;
+
+    do {
+        if (used + LYD_PUSH_BUF_SIZE + 1 > size) {
+            size = size ? size << 1 : LYD_PUSH_BUF_SIZE << 1;
+            data = ly_realloc(data, size);
+            if (!data) {
+                LOGMEM;
+                return NULL;
+            }
+        }
+
+        r = read(fd, &data[used], size - used - 1);
+        if (r == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            LOGERR(LY_ESYS, "Reading data from the file descriptor failed (%s).", strerror(errno));
+            free(data);
+            return NULL;
+        }
+        used += r;
+    } while (r);
+    data[used] = '\0';
+
+    ret = lyd_parse_data_(ctx, data, used, LYD_LYB, options, ap);
+
+    free(data);
+    return ret;
+}
+
+static struct lyd_node *
+lyd_parse_fd_(struct ly_ctx *ctx, int fd, LYD_FORMAT format, int options, va_list ap)
+{
+    struct lyd_node *ret;
+    struct stat sb;
+    size_t length;
+    char *data;
+
+    if (!ctx || (fd == -1)) {
+        LOGERR(LY_EINVAL, "%s: Invalid parameter.", __func__);
+        return NULL;
+    }
+
+    if (fstat(fd, &sb) == -1) {
+        LOGERR(LY_ESYS, "Failed to stat the file descriptor (%s).", strerror(errno));
+        return NULL;
+    }
+    if (!S_ISREG(sb.st_mode)) {
+        /* pipe, socket, ... - parse the data as they are read */
+        if (format == LYD_LYB) {
+            return lyd_parse_fd_lyb(ctx, fd, options, ap);
+        }
+        return lyd_parse_fd_push(ctx, fd, format, options, ap);
+    }
+
+    data = lyp_mmap(fd, 0, &length);
+    if (data == MAP_FAILED) {
+        LOGERR(LY_ESYS, "Mapping file descriptor into memory failed (%s()).", __func__);
+        return NULL;
+    } else if (!data) {
+        ly_err_clean(1);
+        return NULL;
+    }
+
+    ret = lyd_parse_data_(ctx, data, sb.st_size, format, options, ap);
+
+    lyp_munmap(data, length);
+
+    return ret;
+}
+
+API struct lyd_node *
+lyd_parse_fd(struct ly_ctx *ctx, int fd, LYD_FORMAT format, int options, ...)
+{
+    struct lyd_node *ret;
+    va_list ap;
+
+    va_start(ap, options);
+    ret = lyd_parse_fd_(ctx, fd, format, options, ap);
+    va_end(ap);
+
+    return ret;
+}
+
+API struct lyd_node *
+lyd_parse_path(struct ly_ctx *ctx, const char *path, LYD_FORMAT format, int options, ...)
+{
+    int fd;
+    struct lyd_node *ret;
+    va_list ap;
+
+    if (!ctx || !path) {
+        LOGERR(LY_EINVAL, "%s: Invalid parameter.", __func__);
+        return NULL;
+    }
+
+    fd = open(path, O_RDONLY);
+    if (fd == -1) {
+        LOGERR(LY_ESYS, "Failed to open data file \"%s\" (%s).", path, strerror(errno));
+        return NULL;
+    }
+
+    va_start(ap, options);
+    ret = lyd_parse_fd_(ctx, fd, format, options, ap);
+
+    va_end(ap);
+    close(fd);
+
+    return ret;
+}
+
+static struct lys_node *
+lyd_new_find_schema(struct lyd_node *parent, const struct lys_module *module, int rpc_output)
+{
+    struct lys_node *siblings;
+
+    if (!parent) {
+        siblings = module->data;
+    } else {
+        if (!parent->schema) {
+            return NULL;
+        }
+        siblings = parent->schema->child;
+        if (siblings && (siblings->nodetype == (rpc_output ? LYS_INPUT : LYS_OUTPUT))) {
+            siblings = siblings->next;
+        }
+        if (siblings && (siblings->nodetype == (rpc_output ? LYS_OUTPUT : LYS_INPUT))) {
+            siblings = siblings->child;
+        }
+    }
+
+    return siblings;
+}
+
+struct lyd_node *
+_lyd_new(struct lyd_node *parent, const struct lys_node *schema, int dflt)
+{
+    struct lyd_node *ret;
+
+    ret = calloc(1, sizeof *ret);
+    if (!ret) {
+        LOGMEM;
+        return NULL;
+    }
+    ret->schema = (struct lys_node *)schema;
+    ret->validity = ly_new_node_validity(schema);
+    if (resolve_applies_when(schema, 0, NULL)) {
+        ret->when_status = LYD_WHEN;
+    }
+    ret->prev = ret;
+    ret->dflt = dflt;
+    if (parent) {
+        if (lyd_insert(parent, ret)) {
+            lyd_free(ret);
+            return NULL;
+        }
+    }
+    return ret;
+}
+
+API struct lyd_node *
+lyd_new(struct lyd_node *parent, const struct lys_module *module, const char *name)
+{
+    const struct lys_node *snode = NULL, *siblings;
+
+    if ((!parent && !module) || !name) {
+        ly_errno = LY_EINVAL;
+        return NULL;
+    }
+
+    siblings = lyd_new_find_schema(parent, module, 0);
+    if (!siblings) {
+        ly_errno = LY_EINVAL;
         return NULL;
     }
 
@@ -686,6 +1307,8 @@ _lyd_new_leaf(struct lyd_node *parent, const struct lys_node *schema, const char
         lyd_free(ret);
         return NULL;
     }
+    /* the value may have changed into its canonical form */
+    lyd_update_hash(ret);
 
     if (ret->schema->flags & LYS_UNIQUE) {
         /* locate the first parent list */
@@ -760,50 +1383,113 @@ lyd_wd_update_parents(struct lyd_node *node)
 }
 
 
+/**
+ * @brief Mark a data node and all its parents as having a change in their subtree for the incremental validation.
+ *
+ * @param[in] node Data node to mark, can be NULL.
+ */
+static void
+lyd_mark_subtree(struct lyd_node *node)
+{
+    /* all the parents of a marked node are already marked, dummy nodes are not marked at all */
+    for (; node && !(node->validity & (LYD_VAL_SUBTREE | LYD_VAL_INUSE)); node = node->parent) {
+        node->validity |= LYD_VAL_SUBTREE;
+    }
+}
+
+/**
+ * @brief Mark a change of a data node for the incremental validation.
+ *
+ * @param[in] node Changed data node.
+ * @param[in] op Kind of the change as for check_leaf_list_backlinks().
+ */
+static void
+lyd_mark_change(struct lyd_node *node, int op)
+{
+    if (node->validity & LYD_VAL_INUSE) {
+        /* dummy node */
+        return;
+    }
+    if ((op == 1) && (node->validity & LYD_VAL_CHANGED) && node->dflt) {
+        /* default node added by the current validation (and auto-deleted), it was never part of the validated tree */
+        return;
+    }
+
+    if (op != 1) {
+        node->validity |= LYD_VAL_CHANGED;
+        lyd_mark_subtree(node->parent);
+    } else if (node->parent) {
+        node->parent->validity |= LYD_VAL_REMOVED;
+        lyd_mark_subtree(node->parent->parent);
+    } else if (node->next) {
+        node->next->validity |= LYD_VAL_SIBREMOVED;
+    } else if (node->prev != node) {
+        node->prev->validity |= LYD_VAL_SIBREMOVED;
+    }
+}
+
 /* op - 0 add, 1 del, 2 mod (add + del) */
 static void
 check_leaf_list_backlinks(struct lyd_node *node, int op)
 {
-    struct lyd_node *next, *iter;
+    struct lyd_node *next, *iter, *target;
     struct lyd_node_leaf_list *leaf_list;
-    struct ly_set *set, *data;
+    struct lys_node *last_schema = NULL;
+    struct ly_set *set, *data, *lrefs = NULL;
     uint32_t i, j;
 
     assert((op == 0) || (op == 1) || (op == 2));
 
-    /* fix leafrefs */
+    /* collect the leafrefs that can refer to the subtree, their instances are then searched only once */
     LY_TREE_DFS_BEGIN(node, next, iter) {
         /* the node is target of a leafref */
-        if ((iter->schema->nodetype & (LYS_LEAF | LYS_LEAFLIST)) && iter->schema->child) {
+        if ((iter->schema->nodetype & (LYS_LEAF | LYS_LEAFLIST)) && iter->schema->child && (iter->schema != last_schema)) {
+            last_schema = iter->schema;
+            if (!lrefs && !(lrefs = ly_set_new())) {
+                LOGMEM;
+                return;
+            }
             set = (struct ly_set *)iter->schema->child;
             for (i = 0; i < set->number; i++) {
-                data = lyd_find_instance(iter, set->set.s[i]);
-                if (data) {
-                    for (j = 0; j < data->number; j++) {
-                        leaf_list = (struct lyd_node_leaf_list *)data->set.d[j];
-                        if (((op != 0) && (leaf_list->value_type == LY_TYPE_LEAFREF) && (leaf_list->value.leafref == iter))
-                                || ((op != 1) && (leaf_list->value_type & LY_TYPE_LEAFREF_UNRES))) {
-                            /* invalidate the leafref, a change concerning it happened */
-                            leaf_list->validity |= LYD_VAL_LEAFREF;
-                            if (leaf_list->value_type == LY_TYPE_LEAFREF) {
-                                /* remove invalid link */
-                                leaf_list->value.leafref = NULL;
-                            }
-                        }
-                    }
-                    ly_set_free(data);
-                } else {
-                    LOGINT;
-                    return;
-                }
+                ly_set_add(lrefs, set->set.s[i], 0);
             }
         }
         LY_TREE_DFS_END(node, next, iter)
     }
 
-    /* invalidate parent to make sure it will be checked in future validation */
-    if (node->parent) {
-        node->parent->validity = LYD_VAL_MAND;
+    /* fix leafrefs */
+    for (i = 0; lrefs && (i < lrefs->number); i++) {
+        data = lyd_find_instance(node, lrefs->set.s[i]);
+        if (!data) {
+            LOGINT;
+            break;
+        }
+        for (j = 0; j < data->number; j++) {
+            leaf_list = (struct lyd_node_leaf_list *)data->set.d[j];
+            target = NULL;
+            if ((op != 0) && (leaf_list->value_type == LY_TYPE_LEAFREF)) {
+                /* is the target in the subtree */
+                for (target = leaf_list->value.leafref; target && (target != node); target = target->parent);
+            }
+            if (target || ((op != 1) && (leaf_list->value_type & LY_TYPE_LEAFREF_UNRES))) {
+                /* invalidate the leafref, a change concerning it happened */
+                leaf_list->validity |= LYD_VAL_LEAFREF;
+                lyd_mark_subtree(leaf_list->parent);
+                if (leaf_list->value_type == LY_TYPE_LEAFREF) {
+                    /* remove invalid link */
+                    leaf_list->value.leafref = NULL;
+                }
+            }
+        }
+        ly_set_free(data);
+    }
+    ly_set_free(lrefs);
+
+    lyd_mark_change(node, op);
+
+    /* invalidate parent to make sure it will be checked in future validation, dummy nodes were never in the tree */
+    if (node->parent && !(node->validity & LYD_VAL_INUSE)) {
+        node->parent->validity = LYD_VAL_MAND | (node->parent->validity & (LYD_VAL_UNIQUE | LYD_VAL_CHANGES));
     }
 }
 
@@ -849,6 +1535,7 @@ lyd_change_leaf(struct lyd_node_leaf_list *leaf, const char *val_str)
 
     /* value is correct, remove backup */
     lydict_remove(leaf->schema->module->ctx, backup);
+    lyd_update_hash((struct lyd_node *)leaf);
 
     /* clear the default flag, the value is different */
     if (leaf->dflt) {
@@ -1590,21 +2277,15 @@ lyd_new_dummy(struct lyd_node *root, struct lyd_node *parent, const struct lys_n
                 iter = _lyd_new_leaf(parent, spath->set.s[index - 1], value, dflt);
             } else {
                 iter = lyd_create_leaf(spath->set.s[index - 1], value, dflt);
-                if (iter && parent) {
-                    if (lyd_insert(parent, iter)) {
-                        lyd_free(iter);
-                        goto error;
-                    }
-                }
             }
             break;
         case LYS_CONTAINER:
         case LYS_LIST:
-            iter = _lyd_new(parent, spath->set.s[index - 1], dflt);
+            iter = _lyd_new(value ? parent : NULL, spath->set.s[index - 1], dflt);
             break;
         case LYS_ANYXML:
         case LYS_ANYDATA:
-            iter = lyd_create_anydata(parent, spath->set.s[index - 1], "", LYD_ANYDATA_CONSTSTRING);
+            iter = lyd_create_anydata(value ? parent : NULL, spath->set.s[index - 1], "", LYD_ANYDATA_CONSTSTRING);
             break;
         default:
             goto error;
@@ -1613,7 +2294,14 @@ lyd_new_dummy(struct lyd_node *root, struct lyd_node *parent, const struct lys_n
             LOGINT;
             goto error;
         }
-
+        if (!value && parent) {
+            /* only dummy nodes without a value, connect them without marking any change in the data tree */
+            if (lyd_insert_common(parent, NULL, iter, 0)) {
+                lyd_free(iter);
+                goto error;
+            }
+        }
+
         /* we say it is valid and it is dummy */
         iter->validity = LYD_VAL_INUSE;
 
@@ -1780,6 +2468,8 @@ lyd_merge_node_update(struct lyd_node *target, struct lyd_node *source)
 
             src_any->value_type = LYD_ANYDATA_DATATREE;
             src_any->value.tree = NULL;
+
+            lyd_mark_change(target, 2);
         }
     } else {
         /* we have different contexts for the target and source */
@@ -1872,6 +2562,8 @@ lyd_merge_node_update(struct lyd_node *target, struct lyd_node *source)
                     break;
                 }
             }
+
+            lyd_mark_change(target, 2);
         }
     }
 }
@@ -1981,15 +2673,25 @@ lyd_merge_parent_children(struct lyd_node *target, struct lyd_node *source, int
                 goto src_skip;
             }
 
-            LY_TREE_FOR(trg_parent->child, trg_child) {
-                /* schema match, data match? */
-                if (lyd_merge_node_equal(trg_child, src_elem)) {
-                    if (trg_child->schema->nodetype & (LYS_LEAF | LYS_ANYDATA)) {
-                        lyd_merge_node_update(trg_child, src_elem);
+            /* use the children index, if possible (the leaf-list default flag must match, too) */
+            trg_child = NULL;
+            if ((ctx == src_elem->schema->module->ctx)
+                    && (lyd_find_hash_instance(trg_parent, src_elem, &trg_child) > -1)
+                    && (!trg_child || lyd_merge_node_equal(trg_child, src_elem))) {
+                if (trg_child && (trg_child->schema->nodetype & (LYS_LEAF | LYS_ANYDATA))) {
+                    lyd_merge_node_update(trg_child, src_elem);
+                }
+            } else {
+                LY_TREE_FOR(trg_parent->child, trg_child) {
+                    /* schema match, data match? */
+                    if (lyd_merge_node_equal(trg_child, src_elem)) {
+                        if (trg_child->schema->nodetype & (LYS_LEAF | LYS_ANYDATA)) {
+                            lyd_merge_node_update(trg_child, src_elem);
+                        }
+                        break;
+                    } else if (ly_errno) {
+                        return EXIT_FAILURE;
                     }
-                    break;
-                } else if (ly_errno) {
-                    return EXIT_FAILURE;
                 }
             }
 
@@ -2067,66 +2769,109 @@ src_insert:
 static int
 lyd_merge_siblings(struct lyd_node *target, struct lyd_node *source, int options)
 {
-    struct lyd_node *trg, *src, *src_backup, *ins;
+    struct lyd_node *trg, *src, *src_backup, *ins, *ins_first = NULL;
     struct ly_ctx *ctx = target->schema->module->ctx; /* shortcut */
+    struct hash_table *ht;
+    int ret = EXIT_FAILURE;
 
     while (target->prev->next) {
         target = target->prev;
     }
 
+    /* top-level nodes have no parent with the children index, so create a temporary one */
+    ht = lyd_hash_siblings(target);
+
     LY_TREE_FOR_SAFE(source, src_backup, src) {
-        LY_TREE_FOR(target, trg) {
-            /* sibling found, merge it */
-            if (lyd_merge_node_equal(trg, src)) {
-                switch (trg->schema->nodetype) {
-                case LYS_LEAF:
-                case LYS_ANYXML:
-                case LYS_ANYDATA:
-                    lyd_merge_node_update(trg, src);
-                    break;
-                case LYS_LEAFLIST:
-                    /* it's already there, nothing to do */
+        /* use the index, if possible (the leaf-list default flag must match, too) */
+        trg = NULL;
+        if ((ctx != src->schema->module->ctx) || (lyd_find_hash_sibling(ht, src, &trg) == -1)
+                || (trg && !lyd_merge_node_equal(trg, src))) {
+            /* search all the siblings, including the ones to be inserted */
+            LY_TREE_FOR(target, trg) {
+                if (lyd_merge_node_equal(trg, src)) {
                     break;
-                case LYS_LIST:
-                case LYS_CONTAINER:
-                case LYS_NOTIF:
-                case LYS_RPC:
-                case LYS_INPUT:
-                case LYS_OUTPUT:
-                    if (lyd_merge_parent_children(trg, src->child, options)) {
-                        lyd_free_withsiblings(source);
-                        return EXIT_FAILURE;
+                } else if (ly_errno) {
+                    goto cleanup;
+                }
+            }
+            if (!trg) {
+                LY_TREE_FOR(ins_first, trg) {
+                    if (lyd_merge_node_equal(trg, src)) {
+                        break;
+                    } else if (ly_errno) {
+                        goto cleanup;
                     }
-                    break;
-                default:
-                    LOGINT;
+                }
+            }
+        }
+
+        if (trg) {
+            /* sibling found, merge it */
+            switch (trg->schema->nodetype) {
+            case LYS_LEAF:
+            case LYS_ANYXML:
+            case LYS_ANYDATA:
+                lyd_merge_node_update(trg, src);
+                break;
+            case LYS_LEAFLIST:
+                /* it's already there, nothing to do */
+                break;
+            case LYS_LIST:
+            case LYS_CONTAINER:
+            case LYS_NOTIF:
+            case LYS_RPC:
+            case LYS_INPUT:
+            case LYS_OUTPUT:
+                if (lyd_merge_parent_children(trg, src->child, options)) {
                     lyd_free_withsiblings(source);
-                    return EXIT_FAILURE;
+                    goto cleanup;
                 }
                 break;
-            } else if (ly_errno) {
-                return EXIT_FAILURE;
+            default:
+                LOGINT;
+                lyd_free_withsiblings(source);
+                goto cleanup;
             }
+            continue;
         }
 
-        /* sibling not found, insert it */
-        if (!trg) {
-            if (ctx != src->schema->module->ctx) {
-                ins = lyd_dup_to_ctx(src, 1, ctx);
-            } else {
-                lyd_unlink(src);
-                if (src == source) {
-                    /* just so source is not freed, we inserted it and need it further */
-                    source = src_backup;
-                }
-                ins = src;
+        /* sibling not found, insert it, but only after all the siblings are merged since searching
+         * for the last top-level sibling is expensive */
+        if (ctx != src->schema->module->ctx) {
+            ins = lyd_dup_to_ctx(src, 1, ctx);
+        } else {
+            lyd_unlink(src);
+            if (src == source) {
+                /* just so source is not freed, we inserted it and need it further */
+                source = src_backup;
             }
-            lyd_insert_after(target->prev, ins);
+            ins = src;
+        }
+        if (!ins_first) {
+            ins_first = ins;
+        } else {
+            ins->prev = ins_first->prev;
+            ins_first->prev->next = ins;
+            ins_first->prev = ins;
+        }
+        if (ht && lyd_hash_siblings_add(ht, ins)) {
+            /* continue without the index */
+            lyht_free(ht);
+            ht = NULL;
         }
     }
 
+    if (ins_first) {
+        lyd_insert_after(target->prev, ins_first);
+        ins_first = NULL;
+    }
     lyd_free_withsiblings(source);
-    return EXIT_SUCCESS;
+    ret = EXIT_SUCCESS;
+
+cleanup:
+    lyd_free_withsiblings(ins_first);
+    lyht_free(ht);
+    return ret;
 }
 
 API int
@@ -2317,10 +3062,10 @@ lyd_merge_to_ctx(struct lyd_node **trg, const struct lyd_node *src, int options,
                 goto error;
             }
             if (node) {
-                if (lyd_insert_after(node->prev, node2)) {
-                    lyd_free_withsiblings(node);
-                    goto error;
-                }
+                /* copies of valid siblings, just connect them (inserting would search for the first sibling) */
+                node2->prev = node->prev;
+                node->prev->next = node2;
+                node->prev = node2;
             } else {
                 node = node2;
             }
@@ -2339,6 +3084,7 @@ lyd_merge_to_ctx(struct lyd_node **trg, const struct lyd_node *src, int options,
         node2->child = node;
         LY_TREE_FOR(node, node) {
             node->parent = node2;
+            lyd_insert_hash(node);
         }
     } else {
         src_merge_start = node;
@@ -2409,7 +3155,7 @@ lyd_difflist_add(struct lyd_difflist *diff, unsigned int *size, unsigned int ind
 
     if (index + 1 == *size) {
         /* it's time to enlarge */
-        *size = *size + 16;
+        *size = *size * 2;
         new = realloc(diff->type, *size * sizeof *diff->type);
         if (!new) {
             LOGMEM;
@@ -2446,22 +3192,15 @@ lyd_difflist_add(struct lyd_difflist *diff, unsigned int *size, unsigned int ind
     return EXIT_SUCCESS;
 }
 
-struct diff_ordered_dist {
-    struct diff_ordered_dist *next;
-    int dist;
-};
 struct diff_ordered_item {
     struct lyd_node *first;
     struct lyd_node *second;
-    struct diff_ordered_dist *dist;
 };
 struct diff_ordered {
     struct lys_node *schema;
     struct lyd_node *parent;
     unsigned int count;
-    struct diff_ordered_item *items; /* array */
-    struct diff_ordered_dist *dist;  /* linked list (1-way, ring) */
-    struct diff_ordered_dist *dist_last;  /* aux pointer for faster insertion sort */
+    struct diff_ordered_item *items; /* array, in the order of the second tree */
 };
 
 static void
@@ -2470,27 +3209,29 @@ diff_ordset_insert(struct lyd_node *node, struct ly_set *ordset)
     unsigned int i;
     struct diff_ordered *new_ordered, *iter;
 
-    for (i = 0; i < ordset->number; i++) {
-        iter = (struct diff_ordered *)ordset->set.g[i];
+    /* the instances are compared sibling after sibling, so the list is most likely the last one */
+    for (i = ordset->number; i > 0; i--) {
+        iter = (struct diff_ordered *)ordset->set.g[i - 1];
         if (iter->schema == node->schema && iter->parent == node->parent) {
             break;
         }
     }
-    if (i == ordset->number) {
+    if (!i) {
         /* not seen user-ordered list */
         new_ordered = calloc(1, sizeof *new_ordered);
         new_ordered->schema = node->schema;
         new_ordered->parent = node->parent;
 
         ly_set_add(ordset, new_ordered, LY_SET_OPT_USEASLIST);
+        i = ordset->number;
     }
-    ((struct diff_ordered *)ordset->set.g[i])->count++;
+    ((struct diff_ordered *)ordset->set.g[i - 1])->count++;
 }
 
 static void
 diff_ordset_free(struct ly_set *set)
 {
-    unsigned int i, j;
+    unsigned int i;
     struct diff_ordered *ord;
 
     if (!set) {
@@ -2499,9 +3240,6 @@ diff_ordset_free(struct ly_set *set)
 
     for (i = 0; i < set->number; i++) {
         ord = (struct diff_ordered *)set->set.g[i];
-        for (j = 0; j < ord->count; j++) {
-            free(ord->items[j].dist);
-        }
         free(ord->items);
         free(ord);
     }
@@ -2628,85 +3366,207 @@ lyd_diff_equivnode(struct lyd_node *first, struct lyd_node *second)
     return 1;
 }
 
-static int
-lyd_diff_move_preprocess(struct diff_ordered *ordered, struct lyd_node *first, struct lyd_node *second)
+/* @brief find the user-ordered list (ordset record) of a node from the second tree
+ *
+ * @param[in] last Record found the last time, it is checked first since the instances of a list are processed
+ * one after another.
+ * @return found record, NULL if there is none
+ */
+static struct diff_ordered *
+diff_ordset_find(struct ly_set *ordset, struct lyd_node *node, struct diff_ordered **last)
 {
-    struct lyd_node *iter;
-    unsigned int pos = 0;
-    int abs_dist;
-    struct diff_ordered_dist *dist_aux;
-    struct diff_ordered_dist *dist_iter, *dist_last;
-    char *str = NULL;
+    unsigned int i;
+    struct diff_ordered *ordered;
+
+    if (*last && (*last)->schema == node->schema && lyd_diff_equivnode((*last)->parent, node->parent)) {
+        return *last;
+    }
+
+    for (i = ordset->number; i > 0; i--) {
+        ordered = (struct diff_ordered *)ordset->set.g[i - 1];
+        if (ordered->schema == node->schema && lyd_diff_equivnode(ordered->parent, node->parent)) {
+            *last = ordered;
+            return ordered;
+        }
+    }
+
+    return NULL;
+}
 
+static void
+lyd_diff_move_preprocess(struct diff_ordered *ordered, struct lyd_node *first, struct lyd_node *second)
+{
     /* ordered->count was zeroed and now it is incremented with each added
      * item's information, so it is actually position of the second node
      */
+    ordered->items[ordered->count].first = first;
+    ordered->items[ordered->count].second = second;
+    ordered->count++;
+}
+
+/* values_equal_cb of the index of the ordered items by their first node */
+static int
+lyd_diff_move_equal(void *val_searched, void *val_stored, void *UNUSED(cb_data))
+{
+    return ((struct diff_ordered_item *)val_searched)->first == ((struct diff_ordered_item *)val_stored)->first;
+}
+
+static uint32_t
+lyd_diff_move_hash(struct lyd_node *first)
+{
+    return dict_hash_multi(dict_hash_multi(0, (const char *)&first, sizeof first), NULL, 0);
+}
+
+/* @brief detect moved instances of a user-ordered list
+ *
+ * The instances that keep their relative order form the longest increasing subsequence of their positions
+ * in the first tree (taken in the order of the second tree), found by patience sorting. All the other
+ * instances are moved, one after another in the order of the second tree, behind their predecessor
+ * in the second tree. From the several longest subsequences, the one with the instances placed earlier
+ * in the second tree is kept.
+ *
+ * @return EXIT_SUCCESS or EXIT_FAILURE
+ */
+static int
+lyd_diff_move(struct diff_ordered *ordered, struct lyd_difflist *diff, unsigned int *size, unsigned int *i)
+{
+    struct hash_table *ht = NULL;
+    struct diff_ordered_item item_aux, *item;
+    struct lyd_node *iter;
+    unsigned int k, count, *pos = NULL, *len = NULL, *tails = NULL, lo, hi, mid, need, cur;
+    char *str = NULL;
+    int ret = EXIT_FAILURE;
 
-    /* get the position of the first node */
-    for (iter = first->prev; iter->next; iter = iter->prev) {
-        if (!(iter->validity & LYD_VAL_INUSE)) {
-            /* skip deleted nodes */
+    count = ordered->count;
+    if (count < 2) {
+        return EXIT_SUCCESS;
+    }
+
+    pos = malloc(count * sizeof *pos);
+    len = malloc(count * sizeof *len);
+    tails = malloc(count * sizeof *tails);
+    ht = lyht_new(lyd_diff_move_equal, NULL);
+    if (!pos || !len || !tails || !ht) {
+        LOGMEM;
+        goto cleanup;
+    }
+
+    /* get the positions of the items in the first tree */
+    for (k = 0; k < count; k++) {
+        if (lyht_insert(ht, &ordered->items[k], lyd_diff_move_hash(ordered->items[k].first))) {
+            goto cleanup;
+        }
+    }
+    iter = ordered->items[0].first;
+    if (iter->parent) {
+        iter = iter->parent->child;
+    } else {
+        for (; iter->prev->next; iter = iter->prev);
+    }
+    for (k = 0; iter; iter = iter->next) {
+        if (iter->schema != ordered->schema) {
             continue;
         }
-        if (iter->schema == first->schema) {
-            pos++;
+        item_aux.first = iter;
+        if (!lyht_find(ht, &item_aux, lyd_diff_move_hash(iter), (void **)&item)) {
+            pos[item - ordered->items] = k++;
         }
     }
-    if (pos != ordered->count) {
-        LOGDBG(LY_LDGDIFF, "detected moved element \"%s\" from %d to %d (distance %d)",
-               str = lyd_path(first), pos, ordered->count, ordered->count - pos);
-        free(str);
+    if (k != count) {
+        LOGINT;
+        goto cleanup;
     }
 
-    /* store information, count distance */
-    ordered->items[pos].dist = dist_aux = calloc(1, sizeof *dist_aux);
-    ordered->items[pos].dist->dist = ordered->count - pos;
-    abs_dist = abs(ordered->items[pos].dist->dist);
-    ordered->items[pos].first = first;
-    ordered->items[pos].second = second;
-    ordered->count++;
-
-    /* insert sort of distances, higher first */
-    for (dist_iter = ordered->dist, dist_last = NULL;
-            dist_iter;
-            dist_last = dist_iter, dist_iter = dist_iter->next) {
-        if (abs_dist >= abs(dist_iter->dist)) {
-            /* found correct place */
-            dist_aux->next = dist_iter;
-            if (dist_last) {
-                dist_last->next = dist_aux;
+    /* len[k] is the length of the longest increasing subsequence starting with the item k,
+     * tails[l] is the highest position starting such a subsequence of length l + 1 (decreasing with l) */
+    need = 0;
+    for (k = count; k > 0; k--) {
+        lo = 0;
+        hi = need;
+        while (lo < hi) {
+            mid = (lo + hi) / 2;
+            if (tails[mid] > pos[k - 1]) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
             }
-            break;
-        } else if (dist_iter->next == ordered->dist) {
-            /* last item */
-            dist_aux->next = ordered->dist; /* ring list */
-            ordered->dist_last = dist_aux;
-            break;
+        }
+        tails[lo] = pos[k - 1];
+        len[k - 1] = lo + 1;
+        if (lo == need) {
+            need++;
         }
     }
-    if (dist_aux->next == ordered->dist) {
-        if (ordered->dist_last == dist_aux) {
-            /* last item */
-            if (!ordered->dist) {
-                /* the only item */
-                dist_aux->next = dist_aux;
-                ordered->dist = ordered->dist_last = dist_aux;
-            }
-        } else {
-            /* first item */
-            ordered->dist = dist_aux;
-            if (dist_aux->next) {
-                /* more than one item, update the last one's next */
-                ordered->dist_last->next = dist_aux;
-            } else {
-                /* the only item */
-                ordered->dist_last = dist_aux;
-                dist_aux->next = dist_aux; /* ring list */
-            }
+
+    /* store the moves of the items not in the subsequence into the difflist */
+    cur = 0;
+    for (k = 0; k < count; k++) {
+        if (need && (len[k] == need) && (pos[k] >= cur)) {
+            /* item stays, the next one of the subsequence must have a higher position */
+            need--;
+            cur = pos[k] + 1;
+            continue;
+        }
+
+        LOGDBG(LY_LDGDIFF, "detected moved element \"%s\" from %u to %u",
+               str = lyd_path(ordered->items[k].first), pos[k], k);
+        free(str);
+        if (lyd_difflist_add(diff, size, (*i)++, LYD_DIFF_MOVEDAFTER1, ordered->items[k].first,
+                             k ? ordered->items[k - 1].first : NULL)) {
+            goto cleanup;
         }
     }
 
-    return 0;
+    ret = EXIT_SUCCESS;
+
+cleanup:
+    lyht_free(ht);
+    free(pos);
+    free(len);
+    free(tails);
+    return ret;
+}
+
+/* @brief find an instance of a node from the second tree among the siblings in the first tree
+ *
+ * The children index of the parent is used, top-level siblings (and siblings of a parent without the index)
+ * get a separate index for the whole siblings level of the first tree.
+ *
+ * @param[in] first First sibling in the first tree.
+ * @param[in] node Node from the second tree.
+ * @param[in,out] level First sibling of the level indexed the last time.
+ * @param[in,out] level_ht Index of the last indexed level.
+ * @param[out] match Found instance.
+ * @return 1 if found, 0 if not found, -1 if the siblings must be searched sequentially
+ */
+static int
+lyd_diff_find(struct lyd_node *first, struct lyd_node *node, struct lyd_node **level, struct hash_table **level_ht,
+              struct lyd_node **match)
+{
+    struct lyd_node *iter;
+    int i;
+
+    if (!first) {
+        return 0;
+    }
+
+    if (first->parent && first->parent->ht) {
+        return lyd_find_hash_sibling(first->parent->ht, node, match);
+    }
+
+    if (*level != first) {
+        lyht_free(*level_ht);
+        *level_ht = NULL;
+        *level = first;
+
+        /* do not bother with indexing a few siblings */
+        for (i = 0, iter = first; iter && (i < LYD_HT_MIN_CHILDREN); ++i, iter = iter->next);
+        if (i == LYD_HT_MIN_CHILDREN) {
+            *level_ht = lyd_hash_siblings(first);
+        }
+    }
+
+    return lyd_find_hash_sibling(*level_ht, node, match);
 }
 
 static struct lyd_difflist *
@@ -2730,16 +3590,16 @@ lyd_diff(struct lyd_node *first, struct lyd_node *second, int options)
     struct lyd_node *elem1, *elem2, *iter, *aux, *parent = NULL, *next1, *next2;
     struct lyd_difflist *result, *result2 = NULL;
     void *new;
-    unsigned int size, size2, index = 0, index2 = 0, i, j, k;
+    unsigned int size, size2, index = 0, index2 = 0, i;
     struct matchlist_s {
         struct matchlist_s *prev;
         struct ly_set *match;
         unsigned int i;
     } *matchlist = NULL, *mlaux;
     struct ly_set *ordset = NULL;
-    struct diff_ordered *ordered;
-    struct diff_ordered_dist *dist_aux, *dist_iter;
-    struct diff_ordered_item item_aux;
+    struct diff_ordered *ordered, *ordered_last = NULL;
+    struct lyd_node *level = NULL;
+    struct hash_table *level_ht = NULL;
 
     if (!first) {
         /* all nodes in second were created,
@@ -2845,19 +3705,34 @@ lyd_diff(struct lyd_node *first, struct lyd_node *second, int options)
         }
 
         /* search for elem2 instance in the first */
-        LY_TREE_FOR(elem1, iter) {
-            if (iter->schema != elem2->schema) {
-                continue;
-            }
-
+        rc = lyd_diff_find(elem1, elem2, &level, &level_ht, &iter);
+        if (rc == 1) {
             /* elem2 instance found */
             rc = lyd_diff_compare(iter, elem2, result, &size, &index, matchlist->match, ordset, options);
             if (rc == -1) {
                 goto error;
-            } else if (rc == 0) {
-                /* match */
-                break;
-            } /* else, continue */
+            } else if (rc == 1) {
+                /* there is no other instance to try */
+                iter = NULL;
+            }
+        } else if (!rc) {
+            iter = NULL;
+        } else {
+            /* the instances are not indexed */
+            LY_TREE_FOR(elem1, iter) {
+                if (iter->schema != elem2->schema) {
+                    continue;
+                }
+
+                /* elem2 instance found */
+                rc = lyd_diff_compare(iter, elem2, result, &size, &index, matchlist->match, ordset, options);
+                if (rc == -1) {
+                    goto error;
+                } else if (rc == 0) {
+                    /* match */
+                    break;
+                } /* else, continue */
+            }
         }
 
         if (!iter) {
@@ -2909,7 +3784,6 @@ cmp_continue:
                     break;
                 }
                 ordered->items = calloc(ordered->count, sizeof *ordered->items);
-                ordered->dist = NULL;
                 /* zero the count to be used as a node position in lyd_diff_move_preprocess() */
                 ordered->count = 0;
             }
@@ -2943,15 +3817,10 @@ cmp_continue:
 
                 iter->validity &= ~LYD_VAL_INUSE;
                 if ((iter->schema->nodetype & (LYS_LEAFLIST | LYS_LIST)) && (iter->schema->flags & LYS_USERORDERED)) {
-                    for (j = ordset->number; j > 0; j--) {
-                        ordered = (struct diff_ordered *)ordset->set.g[j - 1];
-                        if (ordered->schema != iter->schema || !lyd_diff_equivnode(ordered->parent, iter->parent)) {
-                            continue;
-                        }
-
+                    ordered = diff_ordset_find(ordset, iter, &ordered_last);
+                    if (ordered) {
                         /* store necessary information for move detection */
                         lyd_diff_move_preprocess(ordered, matchlist->match->set.d[matchlist->i], iter);
-                        break;
                     }
                 }
 
@@ -3020,15 +3889,10 @@ cmp_continue:
 
                 iter->validity &= ~LYD_VAL_INUSE;
                 if ((iter->schema->nodetype & (LYS_LEAFLIST | LYS_LIST)) && (iter->schema->flags & LYS_USERORDERED)) {
-                    for (j = ordset->number ; j > 0; j--) {
-                        ordered = (struct diff_ordered *)ordset->set.g[j - 1];
-                        if (ordered->schema != iter->schema || !lyd_diff_equivnode(ordered->parent, iter->parent)) {
-                            continue;
-                        }
-
+                    ordered = diff_ordset_find(ordset, iter, &ordered_last);
+                    if (ordered) {
                         /* store necessary information for move detection */
                         lyd_diff_move_preprocess(ordered, mlaux->match->set.d[mlaux->i], iter);
-                        break;
                     }
                 }
 
@@ -3073,6 +3937,8 @@ cmp_continue:
     ly_set_free(matchlist->match);
     free(matchlist);
     matchlist = NULL;
+    lyht_free(level_ht);
+    level_ht = NULL;
 
 
     /* 2) deleted nodes */
@@ -3118,78 +3984,8 @@ dfs_nextsibling:
 
     /* 3) moved nodes (when user-ordered) */
     for (i = 0; i < ordset->number; i++) {
-        ordered = (struct diff_ordered *)ordset->set.g[i];
-        if (!ordered->dist->dist) {
-            /* the dist list is sorted here, but the biggest dist is 0,
-             * so nothing changed in order of these items between first
-             * and second. We can continue with another user-ordered list.
-             */
-            continue;
-        }
-
-        /* get needed movements
-         * - from the biggest distances try to apply node movements
-         * on first tree node until they will be ordered as in the
-         * second tree - i.e. until there will be no position difference
-         */
-
-        for (dist_iter = ordered->dist; ; dist_iter = dist_iter->next) {
-            /* dist list is sorted at the beginning, since applying a move causes
-             * just a small change in other distances, we assume that the biggest
-             * dist is the next one (note that dist list is implemented as ring
-             * list). This way we avoid sorting distances after each move. The loop
-             * stops when all distances are zero.
-             */
-            dist_aux = dist_iter;
-            while (!dist_iter->dist) {
-                /* no dist, so no move. Try another, but when
-                 * there is no dist at all, stop the loop
-                 */
-                dist_iter = dist_iter->next;
-                if (dist_iter == dist_aux) {
-                    /* all dist we zeroed */
-                    goto movedone;
-                }
-            }
-            /* something to move */
-
-            /* get the item to move */
-            for (k = 0; k < ordered->count; k++) {
-                if (ordered->items[k].dist == dist_iter) {
-                    break;
-                }
-            }
-
-            /* apply the move (distance) */
-            memcpy(&item_aux, &ordered->items[k], sizeof item_aux);
-            if (dist_iter->dist > 0) {
-                /* move to right (other move to left) */
-                while (dist_iter->dist) {
-                    memcpy(&ordered->items[k], &ordered->items[k + 1], sizeof *ordered->items);
-                    ordered->items[k].dist->dist++; /* update moved item distance */
-                    dist_iter->dist--;
-                    k++;
-                }
-            } else {
-                /* move to left (other move to right) */
-                while (dist_iter->dist) {
-                    memcpy(&ordered->items[k], &ordered->items[k - 1], sizeof *ordered->items);
-                    ordered->items[k].dist->dist--; /* update moved item distance */
-                    dist_iter->dist++;
-                    k--;
-                }
-            }
-            memcpy(&ordered->items[k], &item_aux, sizeof *ordered->items);
-
-            /* store the transaction into the difflist */
-            if (lyd_difflist_add(result, &size, index++, LYD_DIFF_MOVEDAFTER1, item_aux.first,
-                                 (k > 0) ? ordered->items[k - 1].first : NULL)) {
-                goto error;
-            }
-            continue;
-
-movedone:
-            break;
+        if (lyd_diff_move((struct diff_ordered *)ordset->set.g[i], result, &size, &index)) {
+            goto error;
         }
     }
 
@@ -3243,6 +4039,7 @@ error:
         free(mlaux);
 
     }
+    lyht_free(level_ht);
     diff_ordset_free(ordset);
 
     lyd_free_diff(result);
@@ -3426,6 +4223,7 @@ lyd_replace(struct lyd_node *orig, struct lyd_node *repl, int destroy)
         if (orig->parent->child == orig) {
             orig->parent->child = repl;
         }
+        lyd_unlink_hash(orig, orig->parent);
         orig->parent = NULL;
     }
 
@@ -3674,6 +4472,9 @@ lyd_insert_common(struct lyd_node *parent, struct lyd_node **sibling, struct lyd
             }
         }
         ins->parent = parent;
+        if (parent) {
+            lyd_insert_hash(ins);
+        }
 
         if (invalidate) {
             check_leaf_list_backlinks(ins, 0);
@@ -3886,6 +4687,15 @@ lyd_insert_nextto(struct lyd_node *sibling, struct lyd_node *node, int before, i
         node->prev = sibling;
     }
 
+    if (sibling->parent) {
+        LY_TREE_FOR(node, next1) {
+            lyd_insert_hash(next1);
+            if (next1 == last) {
+                break;
+            }
+        }
+    }
+
     if (invalidate) {
         LY_TREE_FOR(node, next1) {
             check_leaf_list_backlinks(next1, 0);
@@ -3908,6 +4718,7 @@ error:
         /* there were no siblings */
         orig_parent->child = node;
         node->parent = orig_parent;
+        lyd_insert_hash(node);
     }
     return EXIT_FAILURE;
 }
@@ -3951,23 +4762,6 @@ lys_module_pos(struct lys_module *module)
     return 0;
 }
 
-static int
-lys_module_node_pos_r(struct lys_node *first_sibling, struct lys_node *target, uint32_t *pos)
-{
-    const struct lys_node *next = NULL;
-
-    /* the schema nodes are actually from data, lys_getnext skips non-data schema nodes for us (we know the parent will not be uses) */
-    while ((next = lys_getnext(next, lys_parent(first_sibling), lys_node_module(first_sibling), 0))) {
-        ++(*pos);
-        if (target == next) {
-            return 0;
-        }
-    }
-
-    LOGINT;
-    return 1;
-}
-
 static int
 lyd_node_pos_cmp(const void *item1, const void *item2)
 {
@@ -4004,7 +4798,6 @@ lyd_schema_sort(struct lyd_node *sibling, int recursive)
 {
     uint32_t len, i;
     struct lyd_node *node;
-    struct lys_node *first_ssibling;
     struct lyd_node_pos *array;
 
     if (!sibling) {
@@ -4024,21 +4817,6 @@ lyd_schema_sort(struct lyd_node *sibling, int recursive)
             }
         }
 
-        /* find the data node schema parent */
-        first_ssibling = sibling->schema;
-        while (lys_parent(first_ssibling)
-                && (lys_parent(first_ssibling)->nodetype & (LYS_CHOICE | LYS_CASE | LYS_USES))) {
-            first_ssibling = lys_parent(first_ssibling);
-        }
-        /* find the beginning */
-        if (first_ssibling->parent) {
-            first_ssibling = first_ssibling->parent->child;
-        } else {
-            while (first_ssibling->prev->next) {
-                first_ssibling = first_ssibling->prev;
-            }
-        }
-
         /* count siblings */
         len = 0;
         for (node = sibling; node; node = node->next) {
@@ -4053,8 +4831,8 @@ lyd_schema_sort(struct lyd_node *sibling, int recursive)
 
         /* fill arrays with positions and corresponding nodes */
         for (i = 0, node = sibling; i < len; ++i, node = node->next) {
-            array[i].pos = 0;
-            if (lys_module_node_pos_r(first_ssibling, node->schema, &array[i].pos)) {
+            array[i].pos = lys_node_pos(node->schema);
+            if (!array[i].pos) {
                 free(array);
                 return -1;
             }
@@ -4106,335 +4884,1697 @@ lyd_schema_sort(struct lyd_node *sibling, int recursive)
     return EXIT_SUCCESS;
 }
 
-API int
-lyd_validate(struct lyd_node **node, int options, void *var_arg)
-{
-    struct lyd_node *root, *next1, *next2, *iter, *act_notif = NULL, *to_free = NULL, *data_tree = NULL;
-    struct ly_ctx *ctx = NULL;
-    int ret = EXIT_FAILURE, i;
-    struct unres_data *unres = NULL;
-    struct ly_set *set;
+static int lyd_wd_add_subtree(struct lyd_node **root, struct lyd_node *last_parent, struct lyd_node *subroot,
+                              struct lys_node *schema, int toplevel, int options, struct unres_data *unres);
+static int lyd_wd_add(struct lyd_node **root, struct ly_ctx *ctx, struct unres_data *unres, int options);
 
-    ly_err_clean(1);
+/**
+ * @brief Validate a single data subtree (DFS part of lyd_validate()).
+ *
+ * @param[in] root Root of the subtree, it is freed if it is an empty non-presence container.
+ * @param[in] options Validation options.
+ * @param[in,out] act_notif Nested action/notification found in the data.
+ * @param[in] unres Unres data structure to add the unresolved items into.
+ * @return 0 on success, 1 if \p root was freed, -1 on error.
+ */
+static int
+lyd_validate_subtree(struct lyd_node *root, int options, struct lyd_node **act_notif, struct unres_data *unres)
+{
+    struct lyd_node *next2, *iter, *to_free = NULL;
 
-    if (!node) {
-        ly_errno = LY_EINVAL;
-        return EXIT_FAILURE;
-    }
+    LY_TREE_DFS_BEGIN(root, next2, iter) {
+        if (to_free) {
+            lyd_free(to_free);
+            to_free = NULL;
+        }
 
-    unres = calloc(1, sizeof *unres);
+        if (iter->parent && (iter->schema->nodetype & (LYS_ACTION | LYS_NOTIF))) {
+            if (!(options & LYD_OPT_ACT_NOTIF) || *act_notif) {
+                LOGVAL(LYE_INELEM, LY_VLOG_LYD, iter, iter->schema->name);
+                LOGVAL(LYE_SPEC, LY_VLOG_PREV, NULL, "Unexpected %s node \"%s\".",
+                       (options & LYD_OPT_RPC ? "action" : "notification"), iter->schema->name);
+                return -1;
+            }
+            *act_notif = iter;
+        }
+
+        if (lyv_data_context(iter, options, unres)) {
+            return -1;
+        }
+        if (lyv_data_content(iter, options, unres)) {
+            if (ly_errno) {
+                return -1;
+            } else {
+                /* safe deferred removal */
+                to_free = iter;
+                next2 = NULL;
+                goto nextsiblings;
+            }
+        }
+
+        /* basic validation successful */
+        iter->validity &= ~LYD_VAL_MAND;
+
+        /* where go next? - modified LY_TREE_DFS_END */
+        if (iter->schema->nodetype & (LYS_LEAF | LYS_LEAFLIST | LYS_ANYDATA)) {
+            next2 = NULL;
+        } else {
+            next2 = iter->child;
+
+            /* if we have empty non-dflt and non-presence container, we can remove it */
+            if (!next2 && !iter->dflt && (iter->schema->nodetype == LYS_CONTAINER)
+                    && !((struct lys_node_container *)iter->schema)->presence) {
+                lyd_free(to_free);
+                to_free = iter;
+            }
+        }
+nextsiblings:
+        if (!next2) {
+            /* no children */
+            if (iter == root) {
+                /* we are done */
+                break;
+            }
+            /* try siblings */
+            next2 = iter->next;
+        }
+        while (!next2) {
+            iter = iter->parent;
+
+            /* if we have empty non-dflt and non-presence container, we can remove it */
+            if (to_free && !iter->dflt && !to_free->next && to_free->prev == to_free &&
+                    iter->schema->nodetype == LYS_CONTAINER &&
+                    !((struct lys_node_container *)iter->schema)->presence) {
+                to_free = iter;
+            } else {
+                lyd_free(to_free);
+                to_free = NULL;
+            }
+
+            /* parent is already processed, go to its sibling */
+            if (iter->parent == root->parent) {
+                /* we are done */
+                break;
+            }
+            next2 = iter->next;
+        } /* end of modified LY_TREE_DFS_END */
+    }
+
+    if (to_free) {
+        /* only the root itself can be left */
+        lyd_free(to_free);
+        return 1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Check uniqueness of the top-level lists/leaflists, only the inner instances are checked
+ * in lyv_data_content().
+ *
+ * @param[in] first First top-level node of the data tree.
+ * @return EXIT_SUCCESS or EXIT_FAILURE.
+ */
+static int
+lyd_validate_toplevel_unique(struct lyd_node *first)
+{
+    struct lyd_node *root;
+    struct ly_set *set;
+    unsigned int i;
+
+    set = ly_set_new();
+    if (!set) {
+        return EXIT_FAILURE;
+    }
+    LY_TREE_FOR(first, root) {
+        if (!(root->schema->nodetype & (LYS_LIST | LYS_LEAFLIST)) || !(root->validity & LYD_VAL_UNIQUE)) {
+            continue;
+        }
+
+        /* check each list/leaflist only once */
+        i = set->number;
+        if (ly_set_add(set, root->schema, 0) != (signed)i) {
+            /* already checked */
+            continue;
+        }
+
+        if (lyv_data_unique(root, first)) {
+            ly_set_free(set);
+            return EXIT_FAILURE;
+        }
+    }
+    ly_set_free(set);
+
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Changes of a data tree made since its last validation.
+ */
+struct lyd_val_changes {
+    struct ly_set *changed;     /**< roots of the created, moved and modified subtrees */
+    struct ly_set *touched;     /**< other nodes to validate again (parents of the changes, invalid leafrefs) */
+    struct ly_set *removed;     /**< nodes with a removed child */
+    int toplevel;               /**< a top-level node was changed or removed */
+    int sibremoved;             /**< a top-level node was removed */
+};
+
+/**
+ * @brief Find the changes marked in a data tree and clear their marks.
+ *
+ * Only the subtrees marked with #LYD_VAL_SUBTREE are traversed, the changed subtrees are not entered since
+ * they are validated completely.
+ *
+ * @param[in] first First top-level node of the data tree.
+ * @param[in,out] changes Structure to add the changes into, NULL to clear the marks in the whole data tree.
+ */
+static void
+lyd_val_changes_collect(struct lyd_node *first, struct lyd_val_changes *changes)
+{
+    struct lyd_node *iter;
+    uint8_t validity;
+
+    for (iter = first; iter; ) {
+        validity = iter->validity;
+        if (changes) {
+            iter->validity &= ~(LYD_VAL_SUBTREE | LYD_VAL_REMOVED | LYD_VAL_SIBREMOVED);
+            if (validity & LYD_VAL_CHANGED) {
+                ly_set_add(changes->changed, iter, LY_SET_OPT_USEASLIST);
+                if (!iter->parent) {
+                    changes->toplevel = 1;
+                }
+            } else if (validity & (LYD_VAL_SUBTREE | LYD_VAL_REMOVED | LYD_VAL_LEAFREF)) {
+                ly_set_add(changes->touched, iter, LY_SET_OPT_USEASLIST);
+                if (validity & LYD_VAL_REMOVED) {
+                    ly_set_add(changes->removed, iter, LY_SET_OPT_USEASLIST);
+                }
+            }
+            if (validity & LYD_VAL_SIBREMOVED) {
+                changes->toplevel = 1;
+                changes->sibremoved = 1;
+            }
+        } else {
+            iter->validity &= ~LYD_VAL_CHANGES;
+        }
+
+        /* go into the subtrees with some changes */
+        if ((validity & LYD_VAL_SUBTREE) && (!changes || !(validity & LYD_VAL_CHANGED))
+                && !(iter->schema->nodetype & (LYS_LEAF | LYS_LEAFLIST | LYS_ANYDATA)) && iter->child) {
+            iter = iter->child;
+            continue;
+        }
+        while (iter && !iter->next) {
+            iter = iter->parent;
+        }
+        if (iter) {
+            iter = iter->next;
+        }
+    }
+}
+
+/**
+ * @brief Get all the instances of a schema node in a data subtree.
+ *
+ * @param[in] siblings Children of an instance of \p scope, the top-level nodes if \p scope is NULL.
+ * @param[in] scope Data parent (not necessarily direct) of \p schema, NULL for the whole data tree.
+ * @param[in] schema Schema node of the instances.
+ * @param[in,out] set Set to add the instances into.
+ */
+static void
+lyd_val_instances(struct lyd_node *siblings, const struct lys_node *scope, const struct lys_node *schema,
+                  struct ly_set *set)
+{
+    const struct lys_node *sparent;
+    struct lyd_node *iter;
+    struct ly_set *parents;
+    unsigned int i;
+
+    sparent = lys_data_parent(schema);
+    if (!sparent || (sparent == scope)) {
+        LY_TREE_FOR(siblings, iter) {
+            if (iter->schema == schema) {
+                ly_set_add(set, iter, LY_SET_OPT_USEASLIST);
+            }
+        }
+        return;
+    }
+
+    /* instances of the data parent first */
+    parents = ly_set_new();
+    if (!parents) {
+        return;
+    }
+    lyd_val_instances(siblings, scope, sparent, parents);
+    for (i = 0; i < parents->number; i++) {
+        LY_TREE_FOR(parents->set.d[i]->child, iter) {
+            if (iter->schema == schema) {
+                ly_set_add(set, iter, LY_SET_OPT_USEASLIST);
+            }
+        }
+    }
+    ly_set_free(parents);
+}
+
+/**
+ * @brief Remember a node whose children are to be checked for default and mandatory nodes, every node only once.
+ * The nodes are marked with #LYD_VAL_INUSE until the end of the round.
+ */
+static void
+lyd_val_add_anchor(struct ly_set *anchors, struct lyd_node *node)
+{
+    if (!(node->validity & LYD_VAL_INUSE)) {
+        node->validity |= LYD_VAL_INUSE;
+        ly_set_add(anchors, node, LY_SET_OPT_USEASLIST);
+    }
+}
+
+/**
+ * @brief Add the conditions of all the instances of a dependency record into unres.
+ *
+ * @param[in] first First top-level node of the data tree.
+ * @param[in] parent Instance of the record scope, NULL for the whole data tree.
+ * @param[in] rec Dependency record.
+ * @param[in,out] anchors Nodes whose children are to be checked for default and mandatory nodes.
+ * @param[out] toplevel Set if the top-level nodes are to be checked for default and mandatory nodes.
+ * @param[in] unres Unres data structure to add into.
+ * @return EXIT_SUCCESS or EXIT_FAILURE.
+ */
+static int
+lyd_val_add_rec(struct lyd_node *first, struct lyd_node *parent, const struct ly_dep_rec *rec, struct ly_set *anchors,
+                int *toplevel, struct unres_data *unres)
+{
+    struct ly_set *inst;
+    struct lyd_node *iter;
+    const struct lys_node *sparent;
+    struct lys_type *type;
+    unsigned int i;
+    int r, ret = EXIT_FAILURE;
+
+    inst = ly_set_new();
+    if (!inst) {
+        return EXIT_FAILURE;
+    }
+
+    /* instances with the conditions */
+    if (parent && (parent->schema == rec->node)) {
+        ly_set_add(inst, parent, LY_SET_OPT_USEASLIST);
+    } else {
+        lyd_val_instances(parent ? parent->child : first, parent ? parent->schema : NULL, rec->node, inst);
+    }
+    for (i = 0; i < inst->number; i++) {
+        iter = inst->set.d[i];
+        if ((rec->flags & LY_DEP_WHEN) && (iter->when_status & LYD_WHEN)
+                && (unres_data_add(unres, iter, UNRES_WHEN) == -1)) {
+            goto cleanup;
+        }
+        if (rec->flags & LY_DEP_MUST) {
+            r = resolve_applies_must(iter);
+            if ((r & 0x1) && (unres_data_add(unres, iter, UNRES_MUST) == -1)) {
+                goto cleanup;
+            }
+        }
+        if ((rec->flags & LY_DEP_VALUE) && (iter->schema->nodetype & (LYS_LEAF | LYS_LEAFLIST))) {
+            type = &((struct lys_node_leaf *)iter->schema)->type;
+            if ((type->base == LY_TYPE_UNION) && type->info.uni.has_ptr_type) {
+                if (unres_data_add(unres, iter, UNRES_UNION) == -1) {
+                    goto cleanup;
+                }
+            } else if ((type->base == LY_TYPE_INST) && (unres_data_add(unres, iter, UNRES_INSTID) == -1)) {
+                goto cleanup;
+            }
+        }
+    }
+
+    /* a when condition can also be newly satisfied, so its parents are checked for default and mandatory nodes */
+    if (rec->flags & LY_DEP_WHEN) {
+        sparent = lys_data_parent(rec->node);
+        if (!sparent) {
+            *toplevel = 1;
+        } else if (parent && (parent->schema == sparent)) {
+            lyd_val_add_anchor(anchors, parent);
+        } else {
+            ly_set_clean(inst);
+            lyd_val_instances(parent ? parent->child : first, parent ? parent->schema : NULL, sparent, inst);
+            for (i = 0; i < inst->number; i++) {
+                lyd_val_add_anchor(anchors, inst->set.d[i]);
+            }
+        }
+    }
+    ret = EXIT_SUCCESS;
+
+cleanup:
+    ly_set_free(inst);
+    return ret;
+}
+
+/**
+ * @brief Add the conditions depending on a changed node into unres.
+ *
+ * @param[in] first First top-level node of the data tree.
+ * @param[in] node Changed node or node with a removed child, NULL for a removed top-level node.
+ * @param[in] removed Whether a child of \p node was removed instead of \p node being changed.
+ * @param[in,out] anchors Nodes whose children are to be checked for default and mandatory nodes.
+ * @param[out] toplevel Set if the top-level nodes are to be checked for default and mandatory nodes.
+ * @param[in] unres Unres data structure to add into.
+ * @return EXIT_SUCCESS or EXIT_FAILURE.
+ */
+static int
+lyd_val_add_deps(struct lyd_node *first, struct lyd_node *node, int removed, struct ly_set *anchors, int *toplevel,
+                 struct unres_data *unres)
+{
+    const struct ly_dep_entry *deps;
+    const struct ly_dep_rec *rec;
+    const struct lys_node *siter;
+    struct lyd_node *parent;
+    uint32_t i;
+
+    if (lys_node_deps(first->schema->module->ctx, node ? node->schema : NULL, &deps)) {
+        return EXIT_FAILURE;
+    }
+
+    for (i = 0; deps && (i < deps->count); i++) {
+        rec = deps->recs[i];
+        if (rec->flags & LY_DEP_VALUE) {
+            /* added in every round */
+            continue;
+        }
+
+        parent = NULL;
+        if (node && rec->scope) {
+            for (siter = rec->scope; siter && (siter != node->schema); siter = lys_data_parent(siter));
+            if (siter && (!removed || (rec->scope != node->schema))) {
+                /* all the dependent instances are in the subtree being validated completely */
+                continue;
+            }
+
+            /* the only instance of the scope that can depend on the change */
+            for (parent = node; parent && (parent->schema != rec->scope); parent = parent->parent);
+            if (!parent) {
+                continue;
+            }
+        }
+
+        if (lyd_val_add_rec(first, parent, rec, anchors, toplevel, unres)) {
+            return EXIT_FAILURE;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Add the conditions and values which can depend on any data into unres.
+ */
+static int
+lyd_val_add_values(struct lyd_node *first, struct ly_set *anchors, int *toplevel, struct unres_data *unres)
+{
+    const struct ly_dep_entry *deps;
+    uint32_t i;
+
+    if (lys_node_deps(first->schema->module->ctx, NULL, &deps)) {
+        return EXIT_FAILURE;
+    }
+
+    for (i = 0; deps && (i < deps->count); i++) {
+        if ((deps->recs[i]->flags & LY_DEP_VALUE)
+                && lyd_val_add_rec(first, NULL, deps->recs[i], anchors, toplevel, unres)) {
+            return EXIT_FAILURE;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
+
+static int
+lyd_val_unres_equal(void *val_searched, void *val_stored, void *cb_data)
+{
+    struct unres_data *unres = (struct unres_data *)cb_data;
+    struct lyd_node **node1 = (struct lyd_node **)val_searched, **node2 = (struct lyd_node **)val_stored;
+
+    return (*node1 == *node2) && (unres->type[node1 - unres->node] == unres->type[node2 - unres->node]);
+}
+
+/**
+ * @brief Remove the duplicate items from unres, the same condition can depend on several changes.
+ *
+ * @param[in] unres Unres data structure to compact.
+ * @return EXIT_SUCCESS or EXIT_FAILURE.
+ */
+static int
+lyd_val_unres_dedup(struct unres_data *unres)
+{
+    struct hash_table *ht;
+    uint32_t i, j, hash;
+    void *match;
+
+    if (unres->count < 2) {
+        return EXIT_SUCCESS;
+    }
+
+    ht = lyht_new(lyd_val_unres_equal, unres);
+    if (!ht) {
+        return EXIT_FAILURE;
+    }
+    for (i = 0, j = 0; i < unres->count; i++) {
+        hash = dict_hash_multi(0, (const char *)&unres->node[i], sizeof unres->node[i]);
+        hash = dict_hash_multi(hash, (const char *)&unres->type[i], sizeof unres->type[i]);
+        hash = dict_hash_multi(hash, NULL, 0);
+        if (!lyht_find(ht, &unres->node[i], hash, &match)) {
+            /* duplicate */
+            continue;
+        }
+
+        unres->node[j] = unres->node[i];
+        unres->type[j] = unres->type[i];
+        if (lyht_insert(ht, &unres->node[j], hash)) {
+            lyht_free(ht);
+            return EXIT_FAILURE;
+        }
+        j++;
+    }
+    unres->count = j;
+    lyht_free(ht);
+
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Check the children of a node for mandatory nodes.
+ */
+static int
+lyd_val_mandatory(struct lyd_node *first, struct lyd_node *parent, int options)
+{
+    struct lys_node *siter;
+
+    LY_TREE_FOR(parent->schema->child, siter) {
+        if (lyd_check_mandatory_subtree(first, parent, parent, siter, 0, options)) {
+            return EXIT_FAILURE;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Check whether a node is in a subtree auto-deleted by the incremental validation.
+ */
+static int
+lyd_val_unlinked(struct lyd_node *node, struct ly_set *unlinked)
+{
+    for (; node->parent; node = node->parent);
+    return ly_set_contains(unlinked, node) > -1;
+}
+
+/* a change cascading through more when conditions is rather validated completely */
+#define LYD_VAL_MAX_ROUNDS 32
+
+/**
+ * @brief Validate only the changes of a data tree made since its last validation (#LYD_OPT_INCREMENTAL).
+ *
+ * The changed subtrees are validated completely, their parents and the nodes with any condition whose
+ * data dependencies (found by atomizing the conditions, see lys_node_deps()) intersect with the changes
+ * are added into unres. Default nodes and auto-deleted subtrees are again changes of the data tree,
+ * so it is repeated until there are no new changes.
+ *
+ * @param[in,out] node First top-level node of the data tree, can be changed due to auto-deletion.
+ * @param[in] options Validation options (#LYD_OPT_DATA or #LYD_OPT_CONFIG).
+ * @param[in] unres Empty unres data structure to use.
+ * @return 0 on success, -1 on validation error, 1 if the data tree must be validated completely.
+ */
+static int
+lyd_validate_changes(struct lyd_node **node, int options, struct unres_data *unres)
+{
+    struct lyd_val_changes changes;
+    struct ly_ctx *ctx = (*node)->schema->module->ctx;
+    const struct ly_dep_entry *deps;
+    struct ly_set *anchors = NULL, *subtrees = NULL;
+    struct lyd_node *iter, *next, *act_notif = NULL;
+    uint32_t i, round, start;
+    int toplevel, alltoplevel = 0, r, ret = -1;
+
+    /* build the dependency index first */
+    if (lys_node_deps(ctx, NULL, &deps)) {
+        return 1;
+    }
+
+    memset(&changes, 0, sizeof changes);
+    changes.changed = ly_set_new();
+    changes.touched = ly_set_new();
+    changes.removed = ly_set_new();
+    anchors = ly_set_new();
+    subtrees = ly_set_new();
+    unres->unlinked = ly_set_new();
+    if (!changes.changed || !changes.touched || !changes.removed || !anchors || !subtrees || !unres->unlinked) {
+        goto cleanup;
+    }
+
+    for (round = 0; ; round++) {
+        ly_set_clean(changes.changed);
+        ly_set_clean(changes.touched);
+        ly_set_clean(changes.removed);
+        changes.toplevel = 0;
+        changes.sibremoved = 0;
+        lyd_val_changes_collect(*node, &changes);
+        if (!changes.changed->number && !changes.touched->number && !changes.toplevel) {
+            break;
+        }
+        if (round == LYD_VAL_MAX_ROUNDS) {
+            ret = 1;
+            goto cleanup;
+        }
+        toplevel = changes.toplevel;
+
+        /* nodes around the changes */
+        for (i = 0; i < changes.touched->number; i++) {
+            iter = changes.touched->set.d[i];
+            if (lyv_data_context(iter, options, unres)) {
+                goto cleanup;
+            }
+            if (lyv_data_content(iter, options, unres)) {
+                /* a node to be removed is left for the complete validation */
+                ret = ly_errno ? -1 : 1;
+                goto cleanup;
+            }
+            iter->validity &= ~LYD_VAL_MAND;
+        }
+
+        /* changed subtrees */
+        for (i = 0; i < changes.changed->number; i++) {
+            iter = changes.changed->set.d[i];
+            next = iter->next;
+            r = lyd_validate_subtree(iter, options, &act_notif, unres);
+            if (r == -1) {
+                goto cleanup;
+            } else if (r == 1) {
+                if (*node == iter) {
+                    *node = next;
+                }
+                changes.changed->set.d[i] = NULL;
+            }
+        }
+
+        /* conditions depending on the changes */
+        start = anchors->number;
+        r = EXIT_SUCCESS;
+        for (i = 0; !r && (i < changes.changed->number); i++) {
+            iter = changes.changed->set.d[i];
+            if (!iter) {
+                continue;
+            }
+            if (!iter->parent) {
+                toplevel = 1;
+            } else {
+                lyd_val_add_anchor(anchors, iter->parent);
+            }
+            if (!(iter->schema->nodetype & (LYS_LEAF | LYS_LEAFLIST | LYS_ANYDATA))) {
+                ly_set_add(subtrees, iter, LY_SET_OPT_USEASLIST);
+            }
+            r = lyd_val_add_deps(*node, iter, 0, anchors, &toplevel, unres);
+        }
+        for (i = 0; !r && (i < changes.removed->number); i++) {
+            iter = changes.removed->set.d[i];
+            lyd_val_add_anchor(anchors, iter);
+            r = lyd_val_add_deps(*node, iter, 1, anchors, &toplevel, unres);
+        }
+        if (!r && changes.sibremoved && *node) {
+            r = lyd_val_add_deps(*node, NULL, 1, anchors, &toplevel, unres);
+        }
+        if (!r && *node) {
+            r = lyd_val_add_values(*node, anchors, &toplevel, unres);
+        }
+        for (i = start; i < anchors->number; i++) {
+            anchors->set.d[i]->validity &= ~LYD_VAL_INUSE;
+        }
+        if (r) {
+            goto cleanup;
+        }
+
+        /* default nodes */
+        for (i = 0; i < changes.changed->number; i++) {
+            iter = changes.changed->set.d[i];
+            if (iter && !(iter->schema->nodetype & (LYS_LEAF | LYS_LEAFLIST | LYS_ANYDATA))
+                    && lyd_wd_add_subtree(node, iter, iter, iter->schema, 0, options, unres)) {
+                goto cleanup;
+            }
+        }
+        for (i = start; i < anchors->number; i++) {
+            iter = anchors->set.d[i];
+            if (lyd_wd_add_subtree(node, iter, iter, iter->schema, 0, options | LYD_OPT_SHALLOW, unres)) {
+                goto cleanup;
+            }
+            if (iter->dflt) {
+                lyd_wd_update_parents(iter);
+            }
+        }
+        if (toplevel) {
+            alltoplevel = 1;
+            if (lyd_wd_add(node, ctx, unres, options | LYD_OPT_SHALLOW)) {
+                goto cleanup;
+            }
+        }
+
+        if (lyd_val_unres_dedup(unres) || resolve_unres_data(unres, node, options)) {
+            goto cleanup;
+        }
+        if (!*node) {
+            break;
+        }
+    }
+
+    /* mandatory nodes, the auto-deleted subtrees are freed only after the check */
+    if (!*node) {
+        if (lyd_check_mandatory_tree(NULL, ctx, options)) {
+            goto cleanup;
+        }
+    } else {
+        for (i = 0; i < subtrees->number; i++) {
+            if (!lyd_val_unlinked(subtrees->set.d[i], unres->unlinked)
+                    && lyd_val_mandatory(*node, subtrees->set.d[i], options)) {
+                goto cleanup;
+            }
+        }
+        for (i = 0; i < anchors->number; i++) {
+            if (!lyd_val_unlinked(anchors->set.d[i], unres->unlinked)
+                    && lyd_val_mandatory(*node, anchors->set.d[i], options | LYD_OPT_SHALLOW)) {
+                goto cleanup;
+            }
+        }
+        if (alltoplevel && lyd_check_mandatory_tree(*node, ctx, options | LYD_OPT_SHALLOW)) {
+            goto cleanup;
+        }
+    }
+
+    ret = lyd_validate_toplevel_unique(*node) ? -1 : 0;
+
+cleanup:
+    ly_set_free(changes.changed);
+    ly_set_free(changes.touched);
+    ly_set_free(changes.removed);
+    ly_set_free(anchors);
+    ly_set_free(subtrees);
+    if (unres->unlinked) {
+        for (i = 0; i < unres->unlinked->number; i++) {
+            lyd_free(unres->unlinked->set.d[i]);
+        }
+        ly_set_free(unres->unlinked);
+        unres->unlinked = NULL;
+    }
+    return ret;
+}
+
+API int
+lyd_validate(struct lyd_node **node, int options, void *var_arg)
+{
+    struct lyd_node *root, *next1, *iter, *act_notif = NULL, *data_tree = NULL;
+    struct ly_ctx *ctx = NULL;
+    int ret = EXIT_FAILURE, i, incremental;
+    struct unres_data *unres = NULL;
+
+    ly_err_clean(1);
+
+    if (!node) {
+        ly_errno = LY_EINVAL;
+        return EXIT_FAILURE;
+    }
+
+    unres = calloc(1, sizeof *unres);
     if (!unres) {
         LOGMEM;
         return EXIT_FAILURE;
     }
 
-    data_tree = *node;
+    incremental = options & LYD_OPT_INCREMENTAL;
+    options &= ~LYD_OPT_INCREMENTAL;
+    data_tree = *node;
+
+    if ((!options || (options & (LYD_OPT_DATA | LYD_OPT_CONFIG | LYD_OPT_GET | LYD_OPT_GETCONFIG | LYD_OPT_EDIT))) && !(*node)) {
+        /* get context with schemas from the var_arg */
+        ctx = (struct ly_ctx *)var_arg;
+        if (!ctx) {
+            LOGERR(LY_EINVAL, "%s: invalid variable parameter (struct ly_ctx *ctx).", __func__);
+            goto cleanup;
+        }
+
+        /* LYD_OPT_NOSIBLINGS has no meaning here */
+        options &= ~LYD_OPT_NOSIBLINGS;
+    } else if (options & (LYD_OPT_RPC | LYD_OPT_RPCREPLY | LYD_OPT_NOTIF)) {
+        /* LYD_OPT_NOSIBLINGS cannot be set in this case */
+        if (options & LYD_OPT_NOSIBLINGS) {
+            LOGERR(LY_EINVAL, "%s: invalid parameter (variable arg const struct lyd_node *data_tree with LYD_OPT_NOSIBLINGS).", __func__);
+            goto cleanup;
+        }
+
+        /* get the additional data tree if given */
+        data_tree = (struct lyd_node *)var_arg;
+        if (data_tree) {
+            LY_TREE_FOR(data_tree, iter) {
+                if (iter->parent) {
+                    /* a sibling is not top-level */
+                    LOGERR(LY_EINVAL, "%s: invalid variable parameter (const struct lyd_node *data_tree).", __func__);
+                    goto cleanup;
+                }
+            }
+
+            /* move it to the beginning */
+            for (; data_tree->prev->next; data_tree = data_tree->prev);
+        }
+    }
+
+    if (*node) {
+        if (options & LYD_OPT_NOSIBLINGS) {
+            /* ctx is NULL */
+        } else {
+            ctx = (*node)->schema->module->ctx;
+
+            /* check that the node is the first sibling */
+            while ((*node)->prev->next) {
+                *node = (*node)->prev;
+            }
+        }
+    }
+
+    if ((options & (LYD_OPT_RPC | LYD_OPT_RPCREPLY)) && *node && ((*node)->schema->nodetype != LYS_RPC)) {
+        options |= LYD_OPT_ACT_NOTIF;
+    }
+    if ((options & (LYD_OPT_NOTIF | LYD_OPT_NOTIF_FILTER)) && *node && ((*node)->schema->nodetype != LYS_NOTIF)) {
+        options |= LYD_OPT_ACT_NOTIF;
+    }
+
+    if (incremental && *node && ctx && !(*node)->parent
+            && !(options & ((LYD_OPT_TYPEMASK & ~LYD_OPT_CONFIG) | LYD_OPT_TRUSTED))) {
+        /* validate only the changes made since the last validation */
+        i = lyd_validate_changes(node, options, unres);
+        if (i != 1) {
+            ret = i ? EXIT_FAILURE : EXIT_SUCCESS;
+            goto cleanup;
+        }
+
+        /* too complex changes, validate the whole data tree */
+        unres->count = 0;
+    }
+
+    LY_TREE_FOR_SAFE(*node, next1, root) {
+        i = lyd_validate_subtree(root, options, &act_notif, unres);
+        if (i == -1) {
+            goto cleanup;
+        } else if (i == 1) {
+            /* the root was freed */
+            if ((*node) == root) {
+                *node = next1;
+            }
+            if (data_tree == root) {
+                data_tree = next1;
+            }
+        }
+
+        if (options & LYD_OPT_NOSIBLINGS) {
+            break;
+        }
+
+    }
+
+    if (options & LYD_OPT_ACT_NOTIF) {
+        if (!act_notif) {
+            ly_vecode = LYVE_INELEM;
+            LOGVAL(LYE_SPEC, LY_VLOG_LYD, *node, "Missing %s node.", (options & LYD_OPT_RPC ? "action" : "notification"));
+            goto cleanup;
+        }
+        options &= ~LYD_OPT_ACT_NOTIF;
+    }
+
+    /* check for uniquness of top-level lists/leaflists because
+     * only the inner instances were tested in lyv_data_content() */
+    if (lyd_validate_toplevel_unique(*node)) {
+        goto cleanup;
+    }
+
+    /* add default values, resolve unres and check for mandatory nodes in final tree */
+    if (lyd_defaults_add_unres(node, options, ctx, data_tree, act_notif, unres)) {
+        goto cleanup;
+    }
+    if (act_notif) {
+        if (lyd_check_mandatory_tree(act_notif, ctx, options)) {
+            goto cleanup;
+        }
+    } else {
+        if (lyd_check_mandatory_tree(*node, ctx, options)) {
+            goto cleanup;
+        }
+    }
+
+    ret = EXIT_SUCCESS;
+
+cleanup:
+    if (ret && *node && !(options & ((LYD_OPT_TYPEMASK & ~LYD_OPT_CONFIG) | LYD_OPT_TRUSTED))) {
+        /* invalid data tree, the next incremental validation has to validate all of it */
+        LY_TREE_FOR(*node, iter) {
+            lyd_mark_change(iter, 0);
+        }
+    }
+    if (unres) {
+        free(unres->node);
+        free(unres->type);
+        free(unres);
+    }
+
+    return ret;
+}
+
+API void
+lyd_validation_stats(struct lyd_val_stats *stats)
+{
+    struct ly_err *e = ly_err_location();
+
+    if (stats) {
+        *stats = e->stats;
+    }
+    memset(&e->stats, 0, sizeof e->stats);
+}
+
+API int
+lyd_validate_value(struct lys_node *node, const char *value)
+{
+    struct lyd_node_leaf_list leaf;
+    struct lys_node_leaf *sleaf = (struct lys_node_leaf*)node;
+
+    if (!node || !(node->nodetype & (LYS_LEAF | LYS_LEAFLIST))) {
+        ly_errno = LY_EINVAL;
+        return EXIT_FAILURE;
+    }
+
+    if (!value) {
+        value = "";
+    }
+
+    /* dummy leaf */
+    memset(&leaf, 0, sizeof leaf);
+    leaf.value_str = value;
+
+repeat:
+    leaf.value_type = sleaf->type.base;
+    leaf.schema = node;
+
+    if (leaf.value_type == LY_TYPE_LEAFREF) {
+        if (!sleaf->type.info.lref.target) {
+            return EXIT_FAILURE;
+        }
+        sleaf = sleaf->type.info.lref.target;
+        goto repeat;
+    } else {
+        if (!lyp_parse_value(&sleaf->type, &leaf.value_str, NULL, &leaf, NULL, 0, 0)) {
+            /* the errors may refer to the dummy leaf */
+            ly_err_format();
+            return EXIT_FAILURE;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/* create an attribute copy */
+static struct lyd_attr *
+lyd_dup_attr(struct ly_ctx *ctx, struct lyd_node *parent, struct lyd_attr *attr)
+{
+    struct lyd_attr *ret;
+
+    /* allocate new attr */
+    if (!parent->attr) {
+        parent->attr = malloc(sizeof *parent->attr);
+        ret = parent->attr;
+    } else {
+        for (ret = parent->attr; ret->next; ret = ret->next);
+        ret->next = calloc(1, sizeof *ret);
+        ret = ret->next;
+    }
+    if (!ret) {
+        LOGMEM;
+        return NULL;
+    }
+
+    /* fill new attr except */
+    ret->parent = parent;
+    ret->next = NULL;
+    ret->annotation = attr->annotation;
+    ret->name = lydict_insert(ctx, attr->name, 0);
+    ret->value_str = lydict_insert(ctx, attr->value_str, 0);
+    ret->value_type = attr->value_type;
+    switch (ret->value_type) {
+    case LY_TYPE_BINARY:
+    case LY_TYPE_STRING:
+        /* value_str pointer is shared in these cases */
+        ret->value.string = ret->value_str;
+        break;
+    case LY_TYPE_LEAFREF:
+        ret->value.leafref = NULL;
+        break;
+    case LY_TYPE_INST:
+        ret->value.instance = NULL;
+        break;
+    case LY_TYPE_UNION:
+        /* unresolved union (this must be non-validated tree), duplicate the stored string (duplicated
+         * because of possible change of the value in case of instance-identifier) */
+        ret->value.string = lydict_insert(ctx, attr->value.string, 0);
+        break;
+    case LY_TYPE_ENUM:
+    case LY_TYPE_IDENT:
+    case LY_TYPE_BITS:
+        /* in case of duplicating bits (no matter if in the same context or not) or enum and identityref into
+         * a different context, searching for the type and duplicating the data is almost as same as resolving
+         * the string value, so due to a simplicity, parse the value for the duplicated leaf */
+        lyp_parse_value(*((struct lys_type **)lys_ext_complex_get_substmt(LY_STMT_TYPE, ret->annotation, NULL)),
+                             &ret->value_str, NULL, NULL, ret, 1, 0);
+        break;
+    default:
+        ret->value = attr->value;
+        break;
+    }
+    return ret;
+}
+
+/**
+ * @brief Searched node description for the children index.
+ */
+struct lyd_hash_key {
+    const struct lys_node *schema; /**< schema node of the searched node */
+    const struct lyd_node *node;   /**< data node with the searched keys (value), if set values are not used */
+    const char **values;           /**< searched key values (leaf-list value) */
+    const int *val_lens;           /**< lengths of the values, NULL if they are terminated */
+    const struct lyd_node *skip;   /**< node not to be matched, NULL if any node can match */
+};
+
+/**
+ * @brief Get the value of a list key or leaf-list value of a node.
+ *
+ * @param[in] node List or leaf-list data node.
+ * @param[in] idx Index of the list key.
+ * @return Canonical value, NULL if the key is not instantiated.
+ */
+static const char *
+lyd_hash_value(const struct lyd_node *node, int idx)
+{
+    struct lys_node_list *slist;
+    struct lyd_node *iter;
+    int i;
+
+    if (node->schema->nodetype == LYS_LEAFLIST) {
+        return ((struct lyd_node_leaf_list *)node)->value_str;
+    }
+
+    slist = (struct lys_node_list *)node->schema;
+
+    /* keys are supposed to be the first children in the correct order */
+    for (i = 0, iter = node->child; iter && (i < idx); ++i, iter = iter->next);
+    if (!iter || (iter->schema != (struct lys_node *)slist->keys[idx])) {
+        LY_TREE_FOR(node->child, iter) {
+            if (iter->schema == (struct lys_node *)slist->keys[idx]) {
+                break;
+            }
+        }
+        if (!iter) {
+            return NULL;
+        }
+    }
+
+    return ((struct lyd_node_leaf_list *)iter)->value_str;
+}
+
+/**
+ * @brief Get the number of values identifying an instance of the schema node in the children index.
+ *
+ * @return Number of values, -1 if the instances cannot be indexed (keyless list).
+ */
+static int
+lyd_hash_values_count(const struct lys_node *schema)
+{
+    switch (schema->nodetype) {
+    case LYS_LIST:
+        return ((struct lys_node_list *)schema)->keys_size ? ((struct lys_node_list *)schema)->keys_size : -1;
+    case LYS_LEAFLIST:
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+/**
+ * @brief Compute the hash of a node for the children index.
+ *
+ * @param[in] key Node (or its schema and key values) to hash.
+ * @return Node hash, 0 if the node cannot be indexed.
+ */
+static uint32_t
+lyd_hash_compute(struct lyd_hash_key *key)
+{
+    uint32_t hash;
+    const char *value;
+    int i, count;
+
+    count = lyd_hash_values_count(key->schema);
+    if (count < 0) {
+        return 0;
+    }
+
+    hash = dict_hash_multi(0, (const char *)&key->schema, sizeof key->schema);
+    for (i = 0; i < count; ++i) {
+        value = key->node ? lyd_hash_value(key->node, i) : key->values[i];
+        if (!value) {
+            return 0;
+        }
+        hash = dict_hash_multi(hash, value, (!key->node && key->val_lens) ? (size_t)key->val_lens[i] : strlen(value));
+        /* values separator */
+        hash = dict_hash_multi(hash, "", 1);
+    }
+    hash = dict_hash_multi(hash, NULL, 0);
+
+    /* 0 is reserved for nodes not in the index */
+    return hash ? hash : 1;
+}
+
+static uint32_t
+lyd_hash(struct lyd_node *node)
+{
+    struct lyd_hash_key key;
+
+    memset(&key, 0, sizeof key);
+    key.schema = node->schema;
+    key.node = node;
+
+    return lyd_hash_compute(&key);
+}
+
+/**
+ * @brief Get the hash of a node for the children index, it is the last member of the specific node structure.
+ */
+static uint32_t *
+lyd_hash_ptr(struct lyd_node *node)
+{
+    switch (node->schema->nodetype) {
+    case LYS_LEAF:
+    case LYS_LEAFLIST:
+        return &((struct lyd_node_leaf_list *)node)->hash;
+    case LYS_ANYXML:
+    case LYS_ANYDATA:
+        return &((struct lyd_node_anydata *)node)->hash;
+    default:
+        return &node->hash;
+    }
+}
+
+/* values_equal_cb of the children index */
+static int
+lyd_hash_equal(void *val_searched, void *val_stored, void *UNUSED(cb_data))
+{
+    struct lyd_hash_key *key = (struct lyd_hash_key *)val_searched;
+    struct lyd_node *node = (struct lyd_node *)val_stored;
+    const char *value1, *value2;
+    int i, count;
+
+    if ((node->schema != key->schema) || (node == key->skip)) {
+        return 0;
+    }
+
+    count = lyd_hash_values_count(key->schema);
+    for (i = 0; i < count; ++i) {
+        value1 = lyd_hash_value(node, i);
+        if (!value1) {
+            return 0;
+        }
+        if (key->node) {
+            value2 = lyd_hash_value(key->node, i);
+            if (!value2 || strcmp(value1, value2)) {
+                return 0;
+            }
+        } else if (key->val_lens) {
+            if (strncmp(value1, key->values[i], key->val_lens[i]) || value1[key->val_lens[i]]) {
+                return 0;
+            }
+        } else if (strcmp(value1, key->values[i])) {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+/**
+ * @brief Index of the unique values of the list instances, kept as the callback data of the children index of
+ * their parent. Its records are created by lyd_hash_unique_check() and removed when the instances are unlinked.
+ */
+struct lyd_unique_index {
+    struct hash_table *recs;    /**< records of the list instances, each is stored under its pointer hash and
+                                     the hashes of all its complete unique values */
+    struct ly_set *lists;       /**< schema nodes of the lists and leaf-lists with all their instances checked
+                                     (and indexed), only the instances flagged since then are checked again */
+};
+
+/**
+ * @brief Record of a list instance in the unique index.
+ */
+struct lyd_unique_rec {
+    struct lyd_node *node;      /**< list instance */
+    uint32_t hash[1];           /**< hashes of its values of all the unique statements, 0 if incomplete */
+};
+
+/**
+ * @brief Searched record of the unique index.
+ */
+struct lyd_unique_key {
+    struct lyd_node *node;      /**< list instance */
+    int unique;                 /**< index of the unique statement to match the values of another instance,
+                                     -1 to match the record of the instance itself */
+};
+
+static uint32_t
+lyd_unique_ptr_hash(struct lyd_node *node)
+{
+    return dict_hash_multi(dict_hash_multi(0, (const char *)&node, sizeof node), NULL, 0);
+}
+
+/* values_equal_cb of the unique index */
+static int
+lyd_unique_equal(void *val_searched, void *val_stored, void *UNUSED(cb_data))
+{
+    struct lyd_unique_key *key = (struct lyd_unique_key *)val_searched;
+    struct lyd_unique_rec *rec = (struct lyd_unique_rec *)val_stored;
+
+    if (key->unique == -1) {
+        return rec->node == key->node;
+    }
+
+    return (rec->node != key->node) && (lyd_list_equal(key->node, rec->node, key->unique + 1, 0, 0) == 1);
+}
+
+/**
+ * @brief Compute the hash of the values of a unique statement of a list instance.
+ *
+ * @param[in] node List instance.
+ * @param[in] unique Index of the unique statement.
+ * @param[out] hash Hash of the values, 0 if some value is missing (the instance is not restricted by the statement).
+ * @return EXIT_SUCCESS or EXIT_FAILURE on error.
+ */
+static int
+lyd_unique_hash(struct lyd_node *node, int unique, uint32_t *hash)
+{
+    struct lys_unique *uniq = &((struct lys_node_list *)node->schema)->unique[unique];
+    struct lyd_node *diter;
+    const char *id;
+    int i;
+
+    *hash = dict_hash_multi(0, (const char *)&unique, sizeof unique);
+    for (i = 0; i < uniq->expr_size; i++) {
+        diter = resolve_data_descendant_schema_nodeid(uniq->expr[i], node->child);
+        if (diter) {
+            id = ((struct lyd_node_leaf_list *)diter)->value_str;
+        } else {
+            /* use default value */
+            id = lyd_get_unique_default(uniq->expr[i], node);
+            if (ly_errno) {
+                return EXIT_FAILURE;
+            }
+        }
+        if (!id) {
+            *hash = 0;
+            return EXIT_SUCCESS;
+        }
+        *hash = dict_hash_multi(*hash, id, strlen(id));
+        /* values separator */
+        *hash = dict_hash_multi(*hash, "", 1);
+    }
+    *hash = dict_hash_multi(*hash, NULL, 0);
+
+    /* 0 is reserved for incomplete values */
+    if (!*hash) {
+        *hash = 1;
+    }
+    return EXIT_SUCCESS;
+}
+
+static struct lyd_unique_rec *
+lyd_unique_find(struct lyd_unique_index *index, struct lyd_node *node)
+{
+    struct lyd_unique_key key;
+    struct lyd_unique_rec *rec;
+
+    key.node = node;
+    key.unique = -1;
+    if (lyht_find(index->recs, &key, lyd_unique_ptr_hash(node), (void **)&rec)) {
+        return NULL;
+    }
+
+    return rec;
+}
+
+/**
+ * @brief Remove the record of a list instance from the unique index and free it.
+ */
+static void
+lyd_unique_rec_del(struct lyd_unique_index *index, struct lyd_unique_rec *rec)
+{
+    int i;
 
-    if ((!options || (options & (LYD_OPT_DATA | LYD_OPT_CONFIG | LYD_OPT_GET | LYD_OPT_GETCONFIG | LYD_OPT_EDIT))) && !(*node)) {
-        /* get context with schemas from the var_arg */
-        ctx = (struct ly_ctx *)var_arg;
-        if (!ctx) {
-            LOGERR(LY_EINVAL, "%s: invalid variable parameter (struct ly_ctx *ctx).", __func__);
-            goto cleanup;
+    for (i = 0; i < ((struct lys_node_list *)rec->node->schema)->unique_size; i++) {
+        if (rec->hash[i]) {
+            lyht_remove(index->recs, rec, rec->hash[i]);
         }
+    }
+    lyht_remove(index->recs, rec, lyd_unique_ptr_hash(rec->node));
+    free(rec);
+}
 
-        /* LYD_OPT_NOSIBLINGS has no meaning here */
-        options &= ~LYD_OPT_NOSIBLINGS;
-    } else if (options & (LYD_OPT_RPC | LYD_OPT_RPCREPLY | LYD_OPT_NOTIF)) {
-        /* LYD_OPT_NOSIBLINGS cannot be set in this case */
-        if (options & LYD_OPT_NOSIBLINGS) {
-            LOGERR(LY_EINVAL, "%s: invalid parameter (variable arg const struct lyd_node *data_tree with LYD_OPT_NOSIBLINGS).", __func__);
-            goto cleanup;
-        }
+static void
+lyd_unique_del(struct lyd_node *node, struct lyd_node *parent)
+{
+    struct lyd_unique_index *index;
+    struct lyd_unique_rec *rec;
 
-        /* get the additional data tree if given */
-        data_tree = (struct lyd_node *)var_arg;
-        if (data_tree) {
-            LY_TREE_FOR(data_tree, iter) {
-                if (iter->parent) {
-                    /* a sibling is not top-level */
-                    LOGERR(LY_EINVAL, "%s: invalid variable parameter (const struct lyd_node *data_tree).", __func__);
-                    goto cleanup;
-                }
-            }
+    if (!parent || !parent->ht || !parent->ht->cb_data || (node->schema->nodetype != LYS_LIST)
+            || !((struct lys_node_list *)node->schema)->unique_size) {
+        return;
+    }
 
-            /* move it to the beginning */
-            for (; data_tree->prev->next; data_tree = data_tree->prev);
-        }
+    index = parent->ht->cb_data;
+    rec = lyd_unique_find(index, node);
+    if (rec) {
+        lyd_unique_rec_del(index, rec);
     }
+}
 
-    if (*node) {
-        if (options & LYD_OPT_NOSIBLINGS) {
-            /* ctx is NULL */
-        } else {
-            ctx = (*node)->schema->module->ctx;
+/**
+ * @brief Free the unique index of the children of a node, must be called before its children index is freed.
+ */
+static void
+lyd_unique_free(struct lyd_node *parent)
+{
+    struct lyd_unique_index *index;
+    struct lyd_unique_rec *rec;
+    struct lyd_node *iter;
 
-            /* check that the node is the first sibling */
-            while ((*node)->prev->next) {
-                *node = (*node)->prev;
-            }
+    if (!parent->ht || !parent->ht->cb_data) {
+        return;
+    }
+
+    /* all the records belong to the current children */
+    index = parent->ht->cb_data;
+    LY_TREE_FOR(parent->child, iter) {
+        if ((iter->schema->nodetype == LYS_LIST) && ((struct lys_node_list *)iter->schema)->unique_size
+                && (rec = lyd_unique_find(index, iter))) {
+            free(rec);
         }
     }
+    lyht_free(index->recs);
+    ly_set_free(index->lists);
+    free(index);
+    parent->ht->cb_data = NULL;
+}
 
-    if ((options & (LYD_OPT_RPC | LYD_OPT_RPCREPLY)) && *node && ((*node)->schema->nodetype != LYS_RPC)) {
-        options |= LYD_OPT_ACT_NOTIF;
+/**
+ * @brief Check a list instance against the other indexed instances and (re)index it.
+ *
+ * @return EXIT_SUCCESS, EXIT_FAILURE on a duplicate, -1 on error.
+ */
+static int
+lyd_unique_add(struct lyd_unique_index *index, struct lyd_node *node)
+{
+    struct lys_node_list *slist = (struct lys_node_list *)node->schema;
+    struct lyd_unique_key key;
+    struct lyd_unique_rec *rec, *match;
+    int i;
+
+    rec = lyd_unique_find(index, node);
+    if (rec) {
+        /* the values may have changed */
+        lyd_unique_rec_del(index, rec);
     }
-    if ((options & (LYD_OPT_NOTIF | LYD_OPT_NOTIF_FILTER)) && *node && ((*node)->schema->nodetype != LYS_NOTIF)) {
-        options |= LYD_OPT_ACT_NOTIF;
+
+    rec = malloc(sizeof *rec + (slist->unique_size - 1) * sizeof *rec->hash);
+    if (!rec) {
+        LOGMEM;
+        return -1;
     }
+    rec->node = node;
 
-    LY_TREE_FOR_SAFE(*node, next1, root) {
-        LY_TREE_DFS_BEGIN(root, next2, iter) {
-            if (to_free) {
-                lyd_free(to_free);
-                to_free = NULL;
-            }
+    key.node = node;
+    for (i = 0; i < slist->unique_size; i++) {
+        if (lyd_unique_hash(node, i, &rec->hash[i])) {
+            free(rec);
+            return -1;
+        }
+        if (!rec->hash[i]) {
+            /* skip this unique statement since its values are incomplete */
+            continue;
+        }
 
-            if (iter->parent && (iter->schema->nodetype & (LYS_ACTION | LYS_NOTIF))) {
-                if (!(options & LYD_OPT_ACT_NOTIF) || act_notif) {
-                    LOGVAL(LYE_INELEM, LY_VLOG_LYD, iter, iter->schema->name);
-                    LOGVAL(LYE_SPEC, LY_VLOG_PREV, NULL, "Unexpected %s node \"%s\".",
-                           (options & LYD_OPT_RPC ? "action" : "notification"), iter->schema->name);
-                    goto cleanup;
-                }
-                act_notif = iter;
+        key.unique = i;
+        if (!lyht_find(index->recs, &key, rec->hash[i], (void **)&match)) {
+            /* the error is reported at the later instance in the data, as when checking all of them */
+            if (match->node->validity & LYD_VAL_UNIQUE) {
+                lyd_list_equal(node, match->node, i + 1, 0, 1);
+            } else {
+                lyd_list_equal(match->node, node, i + 1, 0, 1);
             }
+            free(rec);
+            return EXIT_FAILURE;
+        }
+    }
 
-            if (lyv_data_context(iter, options, unres)) {
-                goto cleanup;
-            }
-            if (lyv_data_content(iter, options, unres)) {
-                if (ly_errno) {
-                    goto cleanup;
-                } else {
-                    /* safe deferred removal */
-                    to_free = iter;
-                    next2 = NULL;
-                    goto nextsiblings;
+    /* insert the record */
+    if (lyht_insert(index->recs, rec, lyd_unique_ptr_hash(node))) {
+        free(rec);
+        return -1;
+    }
+    for (i = 0; i < slist->unique_size; i++) {
+        if (rec->hash[i] && lyht_insert(index->recs, rec, rec->hash[i])) {
+            for (--i; i > -1; --i) {
+                if (rec->hash[i]) {
+                    lyht_remove(index->recs, rec, rec->hash[i]);
                 }
             }
+            lyht_remove(index->recs, rec, lyd_unique_ptr_hash(node));
+            free(rec);
+            return -1;
+        }
+    }
 
-            /* basic validation successful */
-            iter->validity &= ~LYD_VAL_MAND;
+    return EXIT_SUCCESS;
+}
 
-            /* where go next? - modified LY_TREE_DFS_END */
-            if (iter->schema->nodetype & (LYS_LEAF | LYS_LEAFLIST | LYS_ANYDATA)) {
-                next2 = NULL;
-            } else {
-                next2 = iter->child;
+int
+lyd_hash_unique_check(struct lyd_node *node)
+{
+    struct lyd_node *parent = node->parent;
+    const struct lys_node *schema = node->schema;
+    struct lyd_unique_index *index;
+    struct lyd_hash_key key;
+    struct lyd_node *iter, *match;
+    uint32_t hash;
+    int r, uniq, all = 0;
+
+    if (!parent || !parent->ht) {
+        return -1;
+    }
 
-                /* if we have empty non-dflt and non-presence container, we can remove it */
-                if (!next2 && !iter->dflt && (iter->schema->nodetype == LYS_CONTAINER)
-                        && !((struct lys_node_container *)iter->schema)->presence) {
-                    lyd_free(to_free);
-                    to_free = iter;
-                }
-            }
-nextsiblings:
-            if (!next2) {
-                /* no children */
-                if (iter == root) {
-                    /* we are done */
-                    break;
-                }
-                /* try siblings */
-                next2 = iter->next;
+    if (!parent->ht->cb_data) {
+        index = calloc(1, sizeof *index);
+        if (!index || !(index->recs = lyht_new(lyd_unique_equal, NULL)) || !(index->lists = ly_set_new())) {
+            LOGMEM;
+            if (index) {
+                lyht_free(index->recs);
             }
-            while (!next2) {
-                iter = iter->parent;
+            free(index);
+            return -1;
+        }
+        parent->ht->cb_data = index;
+    }
+    index = parent->ht->cb_data;
 
-                /* if we have empty non-dflt and non-presence container, we can remove it */
-                if (to_free && !iter->dflt && !to_free->next && to_free->prev == to_free &&
-                        iter->schema->nodetype == LYS_CONTAINER &&
-                        !((struct lys_node_container *)iter->schema)->presence) {
-                    to_free = iter;
-                } else {
-                    lyd_free(to_free);
-                    to_free = NULL;
-                }
+    if (ly_set_contains(index->lists, (void *)schema) == -1) {
+        /* check (and index) all the instances, once */
+        all = 1;
+        node = parent->child;
+        LY_TREE_FOR(node, iter) {
+            if (iter->schema == schema) {
+                iter->validity |= LYD_VAL_UNIQUE;
+            }
+        }
+    }
+    uniq = (schema->nodetype == LYS_LIST) && ((struct lys_node_list *)schema)->unique_size;
 
-                /* parent is already processed, go to its sibling */
-                if (iter->parent == root->parent) {
-                    /* we are done */
-                    break;
-                }
-                next2 = iter->next;
-            } /* end of modified LY_TREE_DFS_END */
+    /* the instances are checked in the data order from the first flagged one, the other instances (including
+     * the ones still to be checked) are found by their keys (value) in the children index and by their unique
+     * values in the unique index */
+    memset(&key, 0, sizeof key);
+    key.schema = schema;
+    LY_TREE_FOR(node, iter) {
+        if ((iter->schema != schema) || !(iter->validity & LYD_VAL_UNIQUE)) {
+            continue;
         }
 
-        if (to_free) {
-            if ((*node) == to_free) {
-                *node = NULL;
+        key.node = key.skip = iter;
+        hash = lyd_hash_compute(&key);
+        if (hash && !lyht_find(parent->ht, &key, hash, (void **)&match)) {
+            if (match->validity & LYD_VAL_UNIQUE) {
+                r = lyd_list_equal(iter, match, 0, 0, 1);
+            } else {
+                r = lyd_list_equal(match, iter, 0, 0, 1);
+            }
+            if (r) {
+                /* instance duplication */
+                return EXIT_FAILURE;
             }
-            lyd_free(to_free);
-            to_free = NULL;
         }
 
-        if (options & LYD_OPT_NOSIBLINGS) {
-            break;
+        if (uniq) {
+            r = lyd_unique_add(index, iter);
+            if (r == -1) {
+                /* check them all again next time */
+                ly_set_rm(index->lists, (void *)schema);
+                return -1;
+            } else if (r) {
+                return EXIT_FAILURE;
+            }
         }
 
+        iter->validity &= ~LYD_VAL_UNIQUE;
     }
 
-    if (options & LYD_OPT_ACT_NOTIF) {
-        if (!act_notif) {
-            ly_vecode = LYVE_INELEM;
-            LOGVAL(LYE_SPEC, LY_VLOG_LYD, *node, "Missing %s node.", (options & LYD_OPT_RPC ? "action" : "notification"));
-            goto cleanup;
-        }
-        options &= ~LYD_OPT_ACT_NOTIF;
+    if (all && (ly_set_add(index->lists, (void *)schema, 0) == -1)) {
+        return EXIT_FAILURE;
     }
 
-    /* check for uniquness of top-level lists/leaflists because
-     * only the inner instances were tested in lyv_data_content() */
-    set = ly_set_new();
-    LY_TREE_FOR(*node, root) {
-        if (!(root->schema->nodetype & (LYS_LIST | LYS_LEAFLIST)) || !(root->validity & LYD_VAL_UNIQUE)) {
-            continue;
-        }
+    return EXIT_SUCCESS;
+}
 
-        /* check each list/leaflist only once */
-        i = set->number;
-        if (ly_set_add(set, root->schema, 0) != i) {
-            /* already checked */
-            continue;
-        }
+/**
+ * @brief Create the children index of a node and add all its current children into it.
+ */
+static void
+lyd_hash_build(struct lyd_node *parent)
+{
+    struct lyd_node *iter;
+    uint32_t *hash;
 
-        if (lyv_data_unique(root, *node)) {
-            ly_set_free(set);
-            goto cleanup;
+    parent->ht = lyht_new(lyd_hash_equal, NULL);
+    if (!parent->ht) {
+        return;
+    }
+
+    LY_TREE_FOR(parent->child, iter) {
+        hash = lyd_hash_ptr(iter);
+        *hash = lyd_hash(iter);
+        if (*hash && lyht_insert(parent->ht, iter, *hash)) {
+            /* no index at all rather than an incomplete one */
+            LY_TREE_FOR(parent->child, iter) {
+                *lyd_hash_ptr(iter) = 0;
+            }
+            lyht_free(parent->ht);
+            parent->ht = NULL;
+            return;
         }
     }
-    ly_set_free(set);
+}
 
-    /* add default values, resolve unres and check for mandatory nodes in final tree */
-    if (lyd_defaults_add_unres(node, options, ctx, data_tree, act_notif, unres)) {
-        goto cleanup;
+/**
+ * @brief Add a node into the children index of its parent.
+ *
+ * @param[in] node Node to add.
+ * @param[in] build Whether to create the index if it does not exist yet and the parent has enough children.
+ */
+static void
+lyd_hash_add(struct lyd_node *node, int build)
+{
+    struct lyd_node *parent = node->parent, *iter;
+    uint32_t *hash = lyd_hash_ptr(node);
+    int i;
+
+    if (!parent || *hash) {
+        return;
     }
-    if (act_notif) {
-        if (lyd_check_mandatory_tree(act_notif, ctx, options)) {
-            goto cleanup;
+
+    if (!parent->ht) {
+        if (build) {
+            for (i = 0, iter = parent->child; iter && (i < LYD_HT_MIN_CHILDREN); ++i, iter = iter->next);
+            if (i == LYD_HT_MIN_CHILDREN) {
+                lyd_hash_build(parent);
+            }
         }
-    } else {
-        if (lyd_check_mandatory_tree(*node, ctx, options)) {
-            goto cleanup;
+        return;
+    }
+
+    *hash = lyd_hash(node);
+    if (*hash && lyht_insert(parent->ht, node, *hash)) {
+        /* the index would be incomplete */
+        lyd_unique_free(parent);
+        LY_TREE_FOR(parent->child, iter) {
+            *lyd_hash_ptr(iter) = 0;
         }
+        lyht_free(parent->ht);
+        parent->ht = NULL;
     }
+}
 
-    ret = EXIT_SUCCESS;
+/**
+ * @brief Remove a node from the children index of its (original) parent.
+ */
+static void
+lyd_hash_del(struct lyd_node *node, struct lyd_node *parent)
+{
+    uint32_t *hash = lyd_hash_ptr(node);
 
-cleanup:
-    if (unres) {
-        free(unres->node);
-        free(unres->type);
-        free(unres);
+    if (*hash && parent && parent->ht) {
+        lyht_remove(parent->ht, node, *hash);
     }
+    *hash = 0;
+}
 
-    return ret;
+/**
+ * @brief Whether the node is a key of the list \p parent.
+ */
+static int
+lyd_hash_is_key(struct lyd_node *node, struct lyd_node *parent)
+{
+    return parent && (parent->schema->nodetype == LYS_LIST) && (node->schema->nodetype == LYS_LEAF)
+            && lys_is_key((struct lys_node_list *)parent->schema, (struct lys_node_leaf *)node->schema);
 }
 
-API int
-lyd_validate_value(struct lys_node *node, const char *value)
+void
+lyd_insert_hash(struct lyd_node *node)
 {
-    struct lyd_node_leaf_list leaf;
-    struct lys_node_leaf *sleaf = (struct lys_node_leaf*)node;
+    struct lyd_node *list;
 
-    if (!node || !(node->nodetype & (LYS_LEAF | LYS_LEAFLIST))) {
-        ly_errno = LY_EINVAL;
-        return EXIT_FAILURE;
+    lyd_hash_add(node, 1);
+
+    if ((node->schema->nodetype & (LYS_LIST | LYS_LEAFLIST)) && node->parent && node->parent->ht
+            && node->parent->ht->cb_data) {
+        /* the new instance is not checked yet (the other ones are) */
+        node->validity |= LYD_VAL_UNIQUE;
     }
 
-    if (!value) {
-        value = "";
+    if (lyd_hash_is_key(node, node->parent)) {
+        /* the list instance hash changes */
+        list = node->parent;
+        lyd_hash_del(list, list->parent);
+        lyd_hash_add(list, 0);
     }
+}
 
-    /* dummy leaf */
-    memset(&leaf, 0, sizeof leaf);
-    leaf.value_str = value;
+void
+lyd_unlink_hash(struct lyd_node *node, struct lyd_node *orig_parent)
+{
+    lyd_unique_del(node, orig_parent);
+    lyd_hash_del(node, orig_parent);
+
+    if (lyd_hash_is_key(node, orig_parent)) {
+        /* the list instance is not complete anymore */
+        lyd_hash_del(orig_parent, orig_parent->parent);
+    }
+}
+
+void
+lyd_update_hash(struct lyd_node *node)
+{
+    if (node->schema->nodetype == LYS_LEAFLIST) {
+        lyd_hash_del(node, node->parent);
+        lyd_hash_add(node, 0);
+    } else if (lyd_hash_is_key(node, node->parent)) {
+        lyd_hash_del(node->parent, node->parent->parent);
+        lyd_hash_add(node->parent, 0);
+    }
+}
+
+int
+lyd_find_hash(const struct lyd_node *parent, const struct lys_node *schema, const char **values, const int *val_lens,
+              struct lyd_node **match)
+{
+    struct lyd_hash_key key;
+    uint32_t hash;
+
+    if (!parent || !parent->ht || (lyd_hash_values_count(schema) < 0)) {
+        return -1;
+    }
+
+    key.schema = schema;
+    key.node = NULL;
+    key.values = values;
+    key.val_lens = val_lens;
+    key.skip = NULL;
+    hash = lyd_hash_compute(&key);
+    if (!hash) {
+        return -1;
+    }
+
+    return lyht_find(parent->ht, &key, hash, (void **)match) ? 0 : 1;
+}
+
+int
+lyd_find_hash_instance(const struct lyd_node *parent, const struct lyd_node *node, struct lyd_node **match)
+{
+    if (!parent) {
+        return -1;
+    }
+
+    return lyd_find_hash_sibling(parent->ht, node, match);
+}
+
+struct hash_table *
+lyd_hash_siblings(struct lyd_node *first)
+{
+    struct hash_table *ht;
+    struct lyd_node *iter;
+
+    ht = lyht_new(lyd_hash_equal, NULL);
+    if (!ht) {
+        return NULL;
+    }
+
+    LY_TREE_FOR(first, iter) {
+        if (lyd_hash_siblings_add(ht, iter)) {
+            lyht_free(ht);
+            return NULL;
+        }
+    }
+
+    return ht;
+}
 
-repeat:
-    leaf.value_type = sleaf->type.base;
-    leaf.schema = node;
+int
+lyd_hash_siblings_add(struct hash_table *ht, struct lyd_node *node)
+{
+    uint32_t hash;
 
-    if (leaf.value_type == LY_TYPE_LEAFREF) {
-        if (!sleaf->type.info.lref.target) {
-            return EXIT_FAILURE;
-        }
-        sleaf = sleaf->type.info.lref.target;
-        goto repeat;
-    } else {
-        if (!lyp_parse_value(&sleaf->type, &leaf.value_str, NULL, &leaf, NULL, 0, 0)) {
-            return EXIT_FAILURE;
-        }
+    hash = lyd_hash(node);
+    if (hash && lyht_insert(ht, node, hash)) {
+        return EXIT_FAILURE;
     }
 
     return EXIT_SUCCESS;
 }
 
-/* create an attribute copy */
-static struct lyd_attr *
-lyd_dup_attr(struct ly_ctx *ctx, struct lyd_node *parent, struct lyd_attr *attr)
+int
+lyd_find_hash_sibling(struct hash_table *ht, const struct lyd_node *node, struct lyd_node **match)
 {
-    struct lyd_attr *ret;
+    struct lyd_hash_key key;
+    uint32_t hash;
 
-    /* allocate new attr */
-    if (!parent->attr) {
-        parent->attr = malloc(sizeof *parent->attr);
-        ret = parent->attr;
-    } else {
-        for (ret = parent->attr; ret->next; ret = ret->next);
-        ret->next = calloc(1, sizeof *ret);
-        ret = ret->next;
-    }
-    if (!ret) {
-        LOGMEM;
-        return NULL;
+    if (!ht || (lyd_hash_values_count(node->schema) < 0)) {
+        return -1;
     }
 
-    /* fill new attr except */
-    ret->parent = parent;
-    ret->next = NULL;
-    ret->annotation = attr->annotation;
-    ret->name = lydict_insert(ctx, attr->name, 0);
-    ret->value_str = lydict_insert(ctx, attr->value_str, 0);
-    ret->value_type = attr->value_type;
-    switch (ret->value_type) {
-    case LY_TYPE_BINARY:
-    case LY_TYPE_STRING:
-        /* value_str pointer is shared in these cases */
-        ret->value.string = ret->value_str;
-        break;
-    case LY_TYPE_LEAFREF:
-        ret->value.leafref = NULL;
-        break;
-    case LY_TYPE_INST:
-        ret->value.instance = NULL;
-        break;
-    case LY_TYPE_UNION:
-        /* unresolved union (this must be non-validated tree), duplicate the stored string (duplicated
-         * because of possible change of the value in case of instance-identifier) */
-        ret->value.string = lydict_insert(ctx, attr->value.string, 0);
-        break;
-    case LY_TYPE_ENUM:
-    case LY_TYPE_IDENT:
-    case LY_TYPE_BITS:
-        /* in case of duplicating bits (no matter if in the same context or not) or enum and identityref into
-         * a different context, searching for the type and duplicating the data is almost as same as resolving
-         * the string value, so due to a simplicity, parse the value for the duplicated leaf */
-        lyp_parse_value(*((struct lys_type **)lys_ext_complex_get_substmt(LY_STMT_TYPE, ret->annotation, NULL)),
-                             &ret->value_str, NULL, NULL, ret, 1, 0);
-        break;
-    default:
-        ret->value = attr->value;
-        break;
+    memset(&key, 0, sizeof key);
+    key.schema = node->schema;
+    key.node = node;
+    hash = lyd_hash_compute(&key);
+    if (!hash) {
+        return -1;
     }
-    return ret;
+
+    return lyht_find(ht, &key, hash, (void **)match) ? 0 : 1;
 }
 
 int
 lyd_unlink_internal(struct lyd_node *node, int permanent)
 {
-    struct lyd_node *iter;
+    struct lyd_node *iter, *parent;
 
     if (!node) {
         ly_errno = LY_EINVAL;
@@ -4466,10 +6606,11 @@ lyd_unlink_internal(struct lyd_node *node, int permanent)
     }
 
     /* unlink from parent */
-    if (node->parent) {
-        if (node->parent->child == node) {
+    parent = node->parent;
+    if (parent) {
+        if (parent->child == node) {
             /* the node is the first child */
-            node->parent->child = node->next;
+            parent->child = node->next;
         }
         node->parent = NULL;
     }
@@ -4477,6 +6618,21 @@ lyd_unlink_internal(struct lyd_node *node, int permanent)
     node->next = NULL;
     node->prev = node;
 
+    if (parent) {
+        lyd_unlink_hash(node, parent);
+
+        if (permanent && ((node->schema->nodetype == LYS_CONTAINER)
+                || ((node->schema->nodetype == LYS_LEAF) && (node->schema->flags & LYS_UNIQUE)))) {
+            /* locate the first parent list, a unique value may have been removed (replaced by its default) */
+            for (iter = parent; iter && iter->schema->nodetype != LYS_LIST; iter = iter->parent);
+
+            /* set flag for future validation */
+            if (iter) {
+                iter->validity |= LYD_VAL_UNIQUE;
+            }
+        }
+    }
+
     return EXIT_SUCCESS;
 }
 
@@ -4620,6 +6776,7 @@ lyd_dup_to_ctx(const struct lyd_node *node, int recursive, struct ly_ctx *ctx)
                  * the string value, so due to a simplicity, parse the value for the duplicated leaf */
                 lyp_parse_value(&((struct lys_node_leaf *)new_leaf->schema)->type, &new_leaf->value_str, NULL,
                                 new_leaf, NULL, 1, node->dflt);
+                lyd_update_hash(new_node);
                 break;
             default:
                 new_leaf->value = ((struct lyd_node_leaf_list *)elem)->value;
@@ -4904,19 +7061,21 @@ lyd_insert_attr(struct lyd_node *parent, const struct lys_module *mod, const cha
     return a;
 }
 
-API void
-lyd_free(struct lyd_node *node)
+/* the leafrefs to the subtree are expected to be already invalidated */
+static void
+lyd_free_r(struct lyd_node *node)
 {
     struct lyd_node *next, *iter;
 
-    if (!node) {
-        return;
-    }
-
     if (!(node->schema->nodetype & (LYS_LEAF | LYS_LEAFLIST | LYS_ANYDATA))) {
+        /* the children index is not needed anymore */
+        lyd_unique_free(node);
+        lyht_free(node->ht);
+        node->ht = NULL;
+
         /* free children */
         LY_TREE_FOR_SAFE(node->child, next, iter) {
-            lyd_free(iter);
+            lyd_free_r(iter);
         }
     } else if (node->schema->nodetype & LYS_ANYDATA) {
         switch (((struct lyd_node_anydata *)node)->value_type) {
@@ -4957,11 +7116,27 @@ lyd_free(struct lyd_node *node)
         lydict_remove(node->schema->module->ctx, ((struct lyd_node_leaf_list *)node)->value_str);
     }
 
-    lyd_unlink(node);
+    lyd_unlink_internal(node, 0);
     lyd_free_attr(node->schema->module->ctx, node, node->attr, 1);
+
+    /* the postponed errors may refer to the node (or its descendants with the parent pointing here) */
+    ly_err_format();
     free(node);
 }
 
+API void
+lyd_free(struct lyd_node *node)
+{
+    if (!node) {
+        return;
+    }
+
+    /* invalidate the leafrefs to the whole subtree at once, not for every freed node separately */
+    check_leaf_list_backlinks(node, 1);
+
+    lyd_free_r(node);
+}
+
 API void
 lyd_free_withsiblings(struct lyd_node *node)
 {
@@ -5382,7 +7557,7 @@ lyd_find_xpath(const struct lyd_node *data, const char *expr)
 {
     struct lyxp_set xp_set;
     struct ly_set *set;
-    uint16_t i;
+    uint32_t i;
 
     if (!data || !expr) {
         ly_errno = LY_EINVAL;
@@ -5523,19 +7698,171 @@ lyd_first_sibling(struct lyd_node *node)
     return start;
 }
 
+/*
+ * Sets created by ly_set_new() with at least this number of objects keep a hash index of them (their indexes
+ * increased by one and hashed as the objects they refer to) once an object is added without LY_SET_OPT_USEASLIST
+ * or removed, smaller sets and sets used only as lists are searched linearly. The other sets are always searched
+ * linearly, there is no way to find out when they are freed.
+ */
+#define LY_SET_INDEX_MIN 32
+
+/* set created by ly_set_new(), the index is hidden behind the public structure */
+struct ly_set_hidden {
+    struct ly_set set;
+    struct hash_table *ht;
+};
+
+/*
+ * registry of the sets created by ly_set_new() and not freed yet, only their hidden part can be accessed,
+ * the sets are stored inverted so that leaked sets are not reachable from here for the memory leak checkers
+ */
+static struct hash_table *ly_set_registry;
+static pthread_mutex_t ly_set_registry_lock = PTHREAD_MUTEX_INITIALIZER;
+
+struct ly_set_search {
+    void **objs;
+    unsigned int number;
+    void *obj;
+};
+
+static int
+ly_set_index_equal(void *val_searched, void *val_stored, void *UNUSED(cb_data))
+{
+    struct ly_set_search *search = (struct ly_set_search *)val_searched;
+    unsigned int i = (uintptr_t)val_stored - 1;
+
+    return (i < search->number) && (search->objs[i] == search->obj);
+}
+
+static uint32_t
+ly_set_index_hash(const void *obj)
+{
+    return dict_hash_multi(dict_hash_multi(0, (const char *)&obj, sizeof obj), NULL, 0);
+}
+
+static int
+ly_set_registry_equal(void *val_searched, void *val_stored, void *UNUSED(cb_data))
+{
+    return (uintptr_t)val_searched == ~(uintptr_t)val_stored;
+}
+
+/*
+ * @brief Get the hidden part of a set created by ly_set_new(), NULL for any other set.
+ */
+static struct ly_set_hidden *
+ly_set_hidden(const struct ly_set *set)
+{
+    void *match;
+
+    pthread_mutex_lock(&ly_set_registry_lock);
+    if (!ly_set_registry || lyht_find(ly_set_registry, (void *)set, ly_set_index_hash(set), &match)) {
+        match = NULL;
+    }
+    pthread_mutex_unlock(&ly_set_registry_lock);
+
+    return match ? (struct ly_set_hidden *)~(uintptr_t)match : NULL;
+}
+
+static void
+ly_set_index_free(struct ly_set_hidden *hidden)
+{
+    lyht_free(hidden->ht);
+    hidden->ht = NULL;
+}
+
+/*
+ * @brief Get the hash index of a set, create it for a big enough set or rebuild it if it does not match the set
+ * number (the set was changed directly, which is not supported, but must not break the search). Without the index
+ * (or on a memory allocation failure), NULL is returned and the set is to be searched linearly.
+ */
+static struct hash_table *
+ly_set_index(struct ly_set_hidden *hidden)
+{
+    struct ly_set *set = &hidden->set;
+    struct hash_table *ht;
+    unsigned int i;
+
+    ht = hidden->ht;
+    if (ht && (ht->used == set->number)) {
+        return ht;
+    }
+
+    ly_set_index_free(hidden);
+    if (set->number < LY_SET_INDEX_MIN) {
+        return NULL;
+    }
+
+    ht = lyht_new(ly_set_index_equal, NULL);
+    if (!ht) {
+        return NULL;
+    }
+    for (i = 0; i < set->number; i++) {
+        if (lyht_insert(ht, (void *)(uintptr_t)(i + 1), ly_set_index_hash(set->set.g[i]))) {
+            lyht_free(ht);
+            return NULL;
+        }
+    }
+    hidden->ht = ht;
+
+    return ht;
+}
+
+static int
+ly_set_index_find(struct hash_table *ht, const struct ly_set *set, void *node)
+{
+    struct ly_set_search search;
+    void *match;
+
+    search.objs = set->set.g;
+    search.number = set->number;
+    search.obj = node;
+    if (lyht_find(ht, &search, ly_set_index_hash(node), &match)) {
+        return -1;
+    }
+
+    return (uintptr_t)match - 1;
+}
+
 API struct ly_set *
 ly_set_new(void)
 {
-    return calloc(1, sizeof(struct ly_set));
+    struct ly_set_hidden *hidden;
+
+    hidden = calloc(1, sizeof *hidden);
+    if (!hidden) {
+        return NULL;
+    }
+
+    pthread_mutex_lock(&ly_set_registry_lock);
+    if (!ly_set_registry) {
+        /* kept for the whole process */
+        ly_set_registry = lyht_new(ly_set_registry_equal, NULL);
+    }
+    if (ly_set_registry) {
+        /* if it fails, the set is just not indexed */
+        lyht_insert(ly_set_registry, (void *)~(uintptr_t)hidden, ly_set_index_hash(&hidden->set));
+    }
+    pthread_mutex_unlock(&ly_set_registry_lock);
+
+    return &hidden->set;
 }
 
 API void
 ly_set_free(struct ly_set *set)
 {
+    struct ly_set_hidden *hidden;
+
     if (!set) {
         return;
     }
 
+    hidden = (struct ly_set_hidden *)set;
+    pthread_mutex_lock(&ly_set_registry_lock);
+    if (ly_set_registry && !lyht_remove(ly_set_registry, (void *)~(uintptr_t)hidden, ly_set_index_hash(set))) {
+        ly_set_index_free(hidden);
+    }
+    pthread_mutex_unlock(&ly_set_registry_lock);
+
     free(set->set.g);
     free(set);
 }
@@ -5543,12 +7870,21 @@ ly_set_free(struct ly_set *set)
 API int
 ly_set_contains(const struct ly_set *set, void *node)
 {
+    struct ly_set_hidden *hidden;
+    struct hash_table *ht;
     unsigned int i;
 
     if (!set) {
         return -1;
     }
 
+    if ((set->number >= LY_SET_INDEX_MIN) && (hidden = ly_set_hidden(set))) {
+        ht = hidden->ht;
+        if (ht && (ht->used == set->number)) {
+            return ly_set_index_find(ht, set, node);
+        }
+    }
+
     for (i = 0; i < set->number; i++) {
         if (set->set.g[i] == node) {
             /* object found */
@@ -5564,52 +7900,119 @@ API struct ly_set *
 ly_set_dup(const struct ly_set *set)
 {
     struct ly_set *new;
+    struct ly_set_hidden *hidden;
 
     if (!set) {
         return NULL;
     }
 
-    new = malloc(sizeof *new);
-    new->number = set->number;
-    new->size = set->size;
-    new->set.g = malloc(new->size * sizeof *(new->set.g));
-    memcpy(new->set.g, set->set.g, new->size * sizeof *(new->set.g));
+    new = ly_set_new();
+    if (!new) {
+        LOGMEM;
+        return NULL;
+    }
+    if (set->size) {
+        new->set.g = malloc(set->size * sizeof *(new->set.g));
+        if (!new->set.g) {
+            LOGMEM;
+            ly_set_free(new);
+            return NULL;
+        }
+        new->size = set->size;
+        new->number = set->number;
+        memcpy(new->set.g, set->set.g, new->number * sizeof *(new->set.g));
+        if ((set->number >= LY_SET_INDEX_MIN) && (hidden = ly_set_hidden(set)) && hidden->ht
+                && (hidden = ly_set_hidden(new))) {
+            ly_set_index(hidden);
+        }
+    }
 
     return new;
 }
 
+/**
+ * @brief Append an object at the end of the set array without searching for it, the index is not updated.
+ *
+ * @return Index of the object in the set, -1 on memory allocation error.
+ */
+static int
+ly_set_append(struct ly_set *set, void *node)
+{
+    unsigned int size;
+    void **new;
+
+    if (set->size == set->number) {
+        /* the array grows geometrically */
+        size = set->size ? set->size * 2 : 8;
+        new = realloc(set->set.g, size * sizeof *(set->set.g));
+        if (!new) {
+            LOGMEM;
+            return -1;
+        }
+        set->size = size;
+        set->set.g = new;
+    }
+
+    set->set.g[set->number++] = node;
+    return set->number - 1;
+}
+
 API int
 ly_set_add(struct ly_set *set, void *node, int options)
 {
+    struct ly_set_hidden *hidden = NULL;
+    struct hash_table *ht = NULL;
     unsigned int i;
-    void **new;
+    int index;
 
     if (!set || !node) {
         ly_errno = LY_EINVAL;
         return -1;
     }
 
-    if (!(options & LY_SET_OPT_USEASLIST)) {
+    if (set->number >= LY_SET_INDEX_MIN) {
+        hidden = ly_set_hidden(set);
+    }
+
+    if (options & LY_SET_OPT_USEASLIST) {
+        /* the index is not created for sets used only as lists, but kept up to date */
+        if (hidden && hidden->ht) {
+            ht = hidden->ht;
+            if (ht->used != set->number) {
+                ly_set_index_free(hidden);
+                ht = NULL;
+            }
+        }
+    } else {
+        if (hidden) {
+            ht = ly_set_index(hidden);
+        }
+
         /* search for duplication */
-        for (i = 0; i < set->number; i++) {
-            if (set->set.g[i] == node) {
+        if (ht) {
+            index = ly_set_index_find(ht, set, node);
+            if (index > -1) {
                 /* already in set */
-                return i;
+                return index;
+            }
+        } else {
+            for (i = 0; i < set->number; i++) {
+                if (set->set.g[i] == node) {
+                    /* already in set */
+                    return i;
+                }
             }
         }
     }
 
-    if (set->size == set->number) {
-        new = realloc(set->set.g, (set->size + 8) * sizeof *(set->set.g));
-        if (!new) {
-            LOGMEM;
-            return -1;
-        }
-        set->size += 8;
-        set->set.g = new;
+    if (ly_set_append(set, node) == -1) {
+        return -1;
     }
 
-    set->set.g[set->number++] = node;
+    if (ht && lyht_insert(ht, (void *)(uintptr_t)set->number, ly_set_index_hash(node))) {
+        /* searched linearly until the index is rebuilt */
+        ly_set_index_free(hidden);
+    }
 
     return set->number - 1;
 }
@@ -5617,11 +8020,33 @@ ly_set_add(struct ly_set *set, void *node, int options)
 API int
 ly_set_rm_index(struct ly_set *set, unsigned int index)
 {
+    struct ly_set_hidden *hidden = NULL;
+    struct hash_table *ht = NULL;
+    void *last;
+
     if (!set || (index + 1) > set->number) {
         ly_errno = LY_EINVAL;
         return EXIT_FAILURE;
     }
 
+    if (set->number >= LY_SET_INDEX_MIN) {
+        hidden = ly_set_hidden(set);
+    }
+    if (hidden) {
+        ht = ly_set_index(hidden);
+    }
+    if (ht) {
+        last = set->set.g[set->number - 1];
+        if ((set->number - 1 < LY_SET_INDEX_MIN)
+                || lyht_remove(ht, (void *)(uintptr_t)(index + 1), ly_set_index_hash(set->set.g[index]))
+                || ((index < set->number - 1)
+                    && (lyht_remove(ht, (void *)(uintptr_t)set->number, ly_set_index_hash(last))
+                        || lyht_insert(ht, (void *)(uintptr_t)(index + 1), ly_set_index_hash(last))))) {
+            /* too small to be indexed or searched linearly until the index is rebuilt */
+            ly_set_index_free(hidden);
+        }
+    }
+
     if (index == set->number - 1) {
         /* removing last item in set */
         set->set.g[index] = NULL;
@@ -5638,7 +8063,7 @@ ly_set_rm_index(struct ly_set *set, unsigned int index)
 API int
 ly_set_rm(struct ly_set *set, void *node)
 {
-    unsigned int i;
+    int index;
 
     if (!set || !node) {
         ly_errno = LY_EINVAL;
@@ -5646,27 +8071,28 @@ ly_set_rm(struct ly_set *set, void *node)
     }
 
     /* get index */
-    for (i = 0; i < set->number; i++) {
-        if (set->set.g[i] == node) {
-            break;
-        }
-    }
-    if (i == set->number) {
+    index = ly_set_contains(set, node);
+    if (index == -1) {
         /* node is not in set */
         ly_errno = LY_EINVAL;
         return EXIT_FAILURE;
     }
 
-    return ly_set_rm_index(set, i);
+    return ly_set_rm_index(set, index);
 }
 
 API int
 ly_set_clean(struct ly_set *set)
 {
+    struct ly_set_hidden *hidden;
+
     if (!set) {
         return EXIT_FAILURE;
     }
 
+    if ((set->number >= LY_SET_INDEX_MIN) && (hidden = ly_set_hidden(set))) {
+        ly_set_index_free(hidden);
+    }
     set->number = 0;
     return EXIT_SUCCESS;
 }
@@ -5839,6 +8265,9 @@ lyd_wd_add_leaf(struct lyd_node **tree, struct lyd_node *last_parent, struct lys
             break;
         }
     }
+    /* mark the new node for the incremental validation */
+    lyd_mark_change(dummy, 0);
+
     /* update parent's default flag if needed */
     lyd_wd_update_parents(dummy);
 
@@ -5936,6 +8365,10 @@ lyd_wd_add_leaflist(struct lyd_node **tree, struct lyd_node *last_parent, struct
                 break;
             }
         }
+        if (dummy->parent) {
+            /* mark the new node for the incremental validation */
+            lyd_mark_change(dummy, 0);
+        }
 
         /* if necessary, remember the created data value in unres */
         if (((struct lyd_node_leaf_list *)current)->value_type == LY_TYPE_LEAFREF) {
@@ -5959,6 +8392,11 @@ lyd_wd_add_leaflist(struct lyd_node **tree, struct lyd_node *last_parent, struct
         *tree = first;
     }
 
+    /* mark the new top-level nodes for the incremental validation */
+    for (current = first; current && !current->parent; current = current->next) {
+        lyd_mark_change(current, 0);
+    }
+
     /* update parent's default flag if needed */
     lyd_wd_update_parents(first);
 
@@ -6004,7 +8442,8 @@ lyd_wd_leaflist_cleanup(struct ly_set *set)
  * @param[in] schema The schema node to be processed
  * @param[in] toplevel Flag for processing top level schema nodes when \p last_parent and \p subroot are consider as
  *                     unknown
- * @param[in] options  Parser options to know the data tree type, see @ref parseroptions.
+ * @param[in] options  Parser options to know the data tree type, see @ref parseroptions, with #LYD_OPT_SHALLOW the
+ *                     subtrees of the present list and container instances are not processed.
  * @param[in] unres    Unresolved data list, the newly added default nodes may need to add some unresolved items
  * @return EXIT_SUCCESS or EXIT_FAILURE
  */
@@ -6012,7 +8451,7 @@ static int
 lyd_wd_add_subtree(struct lyd_node **root, struct lyd_node *last_parent, struct lyd_node *subroot,
                    struct lys_node *schema, int toplevel, int options, struct unres_data *unres)
 {
-    struct ly_set *present = NULL;
+    struct ly_set *present = NULL, present_set = {0, 0, {NULL}};
     struct lys_node *siter, *siter_prev;
     struct lyd_node *iter;
     int i, check_when_must;
@@ -6032,16 +8471,13 @@ lyd_wd_add_subtree(struct lyd_node **root, struct lyd_node *last_parent, struct
 
     if (toplevel && (schema->nodetype & (LYS_LEAF | LYS_LIST | LYS_LEAFLIST | LYS_CONTAINER))) {
         /* search for the schema node instance */
-        present = ly_set_new();
-        if (!present) {
-            goto error;
-        }
+        present = &present_set;
         if ((*root) && lyd_get_node_siblings(*root, schema, present)) {
             /* there are some instances */
             for (i = 0; i < (signed)present->number; i++) {
                 if (schema->nodetype & LYS_LEAFLIST) {
                     lyd_wd_leaflist_cleanup(present);
-                } else if (schema->nodetype != LYS_LEAF) {
+                } else if ((schema->nodetype != LYS_LEAF) && !(options & LYD_OPT_SHALLOW)) {
                     if (lyd_wd_add_subtree(root, present->set.d[i], present->set.d[i], schema, 0, options, unres)) {
                         goto error;
                     }
@@ -6054,7 +8490,7 @@ lyd_wd_add_subtree(struct lyd_node **root, struct lyd_node *last_parent, struct
             }
         }
 
-        ly_set_free(present);
+        free(present_set.set.g);
         return EXIT_SUCCESS;
     }
 
@@ -6126,10 +8562,7 @@ lyd_wd_add_subtree(struct lyd_node **root, struct lyd_node *last_parent, struct
     case LYS_NOTIF:
 
         /* recursion */
-        present = ly_set_new();
-        if (!present) {
-            goto error;
-        }
+        present = &present_set;
         LY_TREE_FOR(schema->child, siter) {
             if (siter->nodetype & (LYS_CHOICE | LYS_USES)) {
                 /* go into without searching for data instance */
@@ -6144,7 +8577,7 @@ lyd_wd_add_subtree(struct lyd_node **root, struct lyd_node *last_parent, struct
                         /* already have some leaflists, check that they are all
                          * default, if not, remove the default leaflists */
                         lyd_wd_leaflist_cleanup(present);
-                    } else if (siter->nodetype != LYS_LEAF) {
+                    } else if ((siter->nodetype != LYS_LEAF) && !(options & LYD_OPT_SHALLOW)) {
                         /* recursion */
                         for (i = 0; i < (signed)present->number; i++) {
                             if (lyd_wd_add_subtree(root, present->set.d[i], present->set.d[i], siter, toplevel, options,
@@ -6180,10 +8613,7 @@ lyd_wd_add_subtree(struct lyd_node **root, struct lyd_node *last_parent, struct
     case LYS_LEAFLIST:
         if (subroot) {
             /* default shortcase of a choice */
-            present = ly_set_new();
-            if (!present) {
-                goto error;
-            }
+            present = &present_set;
             lyd_get_node_siblings(subroot->child, schema, present);
             if (present->number) {
                 /* the shortcase leaf(-list) exists, stop the processing */
@@ -6245,11 +8675,11 @@ lyd_wd_add_subtree(struct lyd_node **root, struct lyd_node *last_parent, struct
         break;
     }
 
-    ly_set_free(present);
+    free(present_set.set.g);
     return EXIT_SUCCESS;
 
 error:
-    ly_set_free(present);
+    free(present_set.set.g);
     return EXIT_FAILURE;
 }
 
@@ -6478,6 +8908,7 @@ lyd_defaults_add_unres(struct lyd_node **root, int options, struct ly_ctx *ctx,
                     data_tree_parent->child->prev = msg_sibling;
                 }
                 msg_sibling->parent = data_tree_parent;
+                lyd_insert_hash(msg_sibling);
             } else {
                 /* last sibling of data_tree_sibling */
                 assert(!data_tree_sibling->parent);
@@ -6504,6 +8935,7 @@ unlink_datatree:
                 data_tree_parent->child->prev->next = NULL;
                 msg_sibling->prev = msg_sibling;
                 msg_sibling->parent = NULL;
+                lyd_unlink_hash(msg_sibling, data_tree_parent);
             } else {
                 assert(data_tree_sibling->prev == msg_sibling);
                 data_tree_sibling->prev = msg_sibling->prev;
@@ -6522,6 +8954,7 @@ unlink_datatree:
                     msg_parent->child->prev = msg_sibling;
                 }
                 msg_sibling->parent = msg_parent;
+                lyd_insert_hash(msg_sibling);
             }
         }
     } else {
@@ -6529,6 +8962,13 @@ unlink_datatree:
         ret = EXIT_SUCCESS;
     }
 
+    if (!ret && *root && !(*root)->parent
+            && !(options & ((LYD_OPT_TYPEMASK & ~LYD_OPT_CONFIG) | LYD_OPT_TRUSTED | LYD_OPT_NOSIBLINGS))) {
+        /* the whole data tree was validated, there are no changes left for the incremental validation */
+        for (msg_sibling = *root; msg_sibling->prev->next; msg_sibling = msg_sibling->prev);
+        lyd_val_changes_collect(msg_sibling, NULL);
+    }
+
     return ret;
 }
 
@@ -40,6 +40,8 @@ typedef enum {
     LYD_UNKNOWN,         /**< unknown format, used as return value in case of error */
     LYD_XML,             /**< XML format of the instance data */
     LYD_JSON,            /**< JSON format of the instance data */
+    LYD_LYB,             /**< LYB format of the instance data, binary and specific to libyang, meant for fast storing and
+                              loading of the data by the same set of schemas */
 } LYD_FORMAT;
 
 /**
@@ -145,6 +147,13 @@ struct lyd_attr {
                                       are checked for this node if flag #LYD_OPT_OBSOLETE is used. */
 #define LYD_VAL_LEAFREF  0x04    /**< Node is a leafref, which needs to be resolved (it is invalid, new possible
                                       resolvent, or something similar) */
+#define LYD_VAL_CHANGED  0x08    /**< Node was created, inserted, moved or its value was changed since the last
+                                      validation, its whole subtree is validated by #LYD_OPT_INCREMENTAL */
+#define LYD_VAL_SUBTREE  0x10    /**< Some node in the subtree of the node has any of the validity flags set, the
+                                      validation with #LYD_OPT_INCREMENTAL goes through the node */
+#define LYD_VAL_REMOVED  0x20    /**< Some child of the node was removed since the last validation */
+#define LYD_VAL_SIBREMOVED 0x40  /**< Some top-level sibling of the top-level node was removed since the last
+                                      validation */
 #define LYD_VAL_INUSE    0x80    /**< Internal flag for note about various processing on data, should be used only
                                       internally and removed before libyang returns the node to the caller */
 /**
@@ -182,6 +191,11 @@ struct lyd_node {
                                           is replaced in those structures. Therefore, be careful with accessing
                                           this member without having information about the node type from the schema's
                                           ::lys_node#nodetype member. */
+    struct hash_table *ht;           /**< index of the children for a fast lookup (and of the unique values of
+                                          their list instances), created only for nodes with many children -
+                                          internal use only, do not use this value! */
+    uint32_t hash;                   /**< hash of the node used by the children index of its parent (0 if the node is
+                                          not indexed) - internal use only, do not use this value! */
 };
 
 /**
@@ -218,6 +232,8 @@ struct lyd_node_leaf_list {
     uint16_t value_type;             /**< type of the value in the node, mainly for union to avoid repeating of type detection,
                                           if (schema->type.base == LY_TYPE_LEAFREF), then value_type may be
                                           (LY_TYPE_LEAFREF_UNRES | leafref target value_type) and (value.leafref == NULL) */
+    uint32_t hash;                   /**< hash of the node used by the children index of its parent (0 if the node is
+                                          not indexed) - internal use only, do not use this value! */
 };
 
 /**
@@ -254,6 +270,8 @@ struct lyd_node_anydata {
         struct lyd_node *tree;       /**< libyang data tree, does not change the root's parent, so it is not possible
                                           to get from the data tree into the anydata/anyxml */
     } value;
+    uint32_t hash;                   /**< hash of the node used by the children index of its parent (0 if the node is
+                                          not indexed) - internal use only, do not use this value! */
 };
 
 /**
@@ -340,6 +358,10 @@ void lyd_free_diff(struct lyd_difflist *diff);
  *        / \
  *       3   4
  *
+ * - The moves (#LYD_DIFF_MOVEDAFTER1) of the instances of a user-ordered (leaf-)list are minimal, the largest group
+ *   of instances keeping their relative order in both trees is not moved at all. The moved instances follow their
+ *   order in the second tree.
+ *
  * To change the first tree into the second one, it is necessary to follow the order of transactions described in
  * the result. Note, that it is not possible just to use the transactions in the reverse order to transform the
  * second tree into the first one. The transactions can be generalized (to be used on a different instance of the
@@ -478,6 +500,13 @@ char *lyd_qualified_path(const struct lyd_node *node);
                                        constrained subtree. */
 #define LYD_OPT_NOEXTDEPS  0x8000 /**< Allow external dependencies (external leafrefs, instance-identifiers, must,
                                        and when) to not be resolved/satisfied during validation. */
+#define LYD_OPT_INCREMENTAL 0x10000 /**< Validate only the changes made since the last successful validation of the
+                                       data tree (with the same data type option). The changes are tracked by the
+                                       @ref validityflags of the nodes, so only the changed subtrees and the nodes
+                                       whose when and must conditions, leafrefs or instance-identifiers can depend on
+                                       them are checked again. The option is applicable only to lyd_validate() with
+                                       #LYD_OPT_DATA and #LYD_OPT_CONFIG, for any other data tree the complete
+                                       validation is done. */
 
 /**@} parseroptions */
 
@@ -489,6 +518,9 @@ char *lyd_qualified_path(const struct lyd_node *node);
  * returned data node is a root of the first tree with other trees connected via the next pointer.
  * This behavior can be changed by #LYD_OPT_NOSIBLINGS option.
  *
+ * The length of #LYD_LYB data is read from their header and cannot be checked, so truncated data are read beyond
+ * their end. Use lyd_parse_mem_len() for LYB data that are not trusted.
+ *
  * @param[in] ctx Context to connect with the data tree being built here.
  * @param[in] data Serialized data in the specified format.
  * @param[in] format Format of the input data to be parsed.
@@ -517,10 +549,30 @@ char *lyd_qualified_path(const struct lyd_node *node);
  */
 struct lyd_node *lyd_parse_mem(struct ly_ctx *ctx, const char *data, LYD_FORMAT format, int options, ...);
 
+/**
+ * @brief Parse (and validate) data of a known length from memory.
+ *
+ * The same as lyd_parse_mem(), but \p data do not have to be terminated and the data are never read beyond
+ * \p len bytes. #LYD_LYB data that are shorter than their header declares are refused.
+ *
+ * @param[in] ctx Context to connect with the data tree being built here.
+ * @param[in] data Serialized data in the specified format.
+ * @param[in] len Length of \p data.
+ * @param[in] format Format of the input data to be parsed.
+ * @param[in] options Parser options, see @ref parseroptions.
+ * @param[in] ... Variable arguments depend on \p options, the same as for lyd_parse_mem().
+ * @return Pointer to the built data tree or NULL in case of empty \p data. To free the returned structure,
+ *         use lyd_free(). In these cases, the function sets #ly_errno to LY_SUCCESS. In case of error,
+ *         #ly_errno contains appropriate error code (see #LY_ERR).
+ */
+struct lyd_node *lyd_parse_mem_len(struct ly_ctx *ctx, const char *data, size_t len, LYD_FORMAT format, int options,
+                                   ...);
+
 /**
  * @brief Read (and validate) data from the given file descriptor.
  *
- * \note Current implementation supports only reading data from standard (disk) file, not from sockets, pipes, etc.
+ * Regular files are mapped into memory, other file descriptors (pipes, sockets, etc.) are read until the end of file
+ * and the data are parsed as they are read (see lyd_push_new()).
  *
  * In case of LY_XML format, the file content is parsed completely. It means that when it contains
  * a non well-formed XML with multiple root elements, all those sibling XML trees are parsed. The
@@ -637,6 +689,65 @@ struct lyd_node *lyd_parse_path(struct ly_ctx *ctx, const char *path, LYD_FORMAT
  */
 struct lyd_node *lyd_parse_xml(struct ly_ctx *ctx, struct lyxml_elem **root, int options,...);
 
+/**
+ * @brief Context of the data being parsed as they are received in chunks, see lyd_push_new().
+ */
+struct lyd_push_ctx;
+
+/**
+ * @brief Create a context for parsing (and validating) data received in chunks of any size.
+ *
+ * The data are passed to the parser by lyd_push_data() and the parsed data tree is returned by lyd_push_finish().
+ * Data nodes are created as soon as the complete top-level elements (#LYD_XML) or members of the top-level object
+ * (#LYD_JSON) are received, so only the currently received top-level node is kept in a buffer. The result (including
+ * the error messages) is the same as if the whole data were parsed by lyd_parse_mem().
+ *
+ * The parser does not stream below the top level. The text of each top-level node is buffered completely until
+ * its end is received, and only then is the node parsed as a whole, by the same parser as in lyd_parse_mem() (for
+ * #LYD_XML directly from the text, without an XML tree). So none of its descendants are created before its end is
+ * received, and the buffer grows with the size of the largest top-level node. The memory is saved only for data with
+ * many top-level nodes. A single big top-level container, an RPC, an action or a notification (each a single
+ * top-level node) is buffered as a whole and needs about the same memory as with lyd_parse_mem().
+ *
+ * @param[in] ctx Context to connect with the data tree being built here.
+ * @param[in] format Format of the input data to be parsed.
+ * @param[in] options Parser options, see @ref parseroptions.
+ * @param[in] ... Variable arguments depend on \p options, the same as for lyd_parse_mem().
+ * @return Created parser context, NULL on error.
+ */
+struct lyd_push_ctx *lyd_push_new(struct ly_ctx *ctx, LYD_FORMAT format, int options, ...);
+
+/**
+ * @brief Pass the next chunk of data to the parser.
+ *
+ * All the complete top-level nodes in the data received so far are parsed. The rest of the data (an incomplete
+ * top-level node of any size) is copied into the buffer of the context and parsed only when the node is complete,
+ * see lyd_push_new(). After an error, the context can only be freed by lyd_push_free().
+ *
+ * @param[in] pctx Parser context.
+ * @param[in] data Chunk of the data, it does not need to be terminated by NULL byte.
+ * @param[in] len Length of \p data.
+ * @return EXIT_SUCCESS on success, EXIT_FAILURE on error (#ly_errno contains appropriate error code).
+ */
+int lyd_push_data(struct lyd_push_ctx *pctx, const char *data, size_t len);
+
+/**
+ * @brief Finish parsing when all the data were passed to the parser. The parser context is freed.
+ *
+ * @param[in] pctx Parser context.
+ * @return Pointer to the built data tree or NULL in case of empty data. To free the returned structure,
+ *         use lyd_free(). In these cases, the function sets #ly_errno to LY_SUCCESS. In case of error,
+ *         #ly_errno contains appropriate error code (see #LY_ERR).
+ */
+struct lyd_node *lyd_push_finish(struct lyd_push_ctx *pctx);
+
+/**
+ * @brief Free the parser context together with all the data parsed so far.
+ *
+ * @param[in] pctx Parser context to free.
+ */
+void lyd_push_free(struct lyd_push_ctx *pctx);
+
 /**
  * @brief Create a new container node in a data tree.
  *
@@ -1061,6 +1172,26 @@ struct lyd_node *lyd_first_sibling(struct lyd_node *node);
  */
 int lyd_validate(struct lyd_node **node, int options, void *var_arg);
 
+/**
+ * @brief Numbers of the data constraints evaluations, see lyd_validation_stats().
+ */
+struct lyd_val_stats {
+    uint32_t when;                   /**< when conditions */
+    uint32_t leafref;                /**< leafrefs */
+    uint32_t other;                  /**< must conditions, instance-identifiers and the other values */
+};
+
+/**
+ * @brief Get the numbers of the evaluations done when resolving the data constraints in the calling thread (by
+ * the data parsers and lyd_validate()) since the previous call of this function, and reset them.
+ *
+ * A when condition referring to a node with a not yet resolved when condition is evaluated again after the
+ * condition of that node is resolved, so the number of the when evaluations may exceed the number of the conditions.
+ *
+ * @param[out] stats Numbers of the evaluations, can be NULL to just reset them.
+ */
+void lyd_validation_stats(struct lyd_val_stats *stats);
+
 /**
  * @brief Check restrictions applicable to the particular leaf/leaf-list on the given string value.
  *
@@ -48,6 +48,16 @@
  */
 #define LYD_OPT_ACT_NOTIF 0x100
 
+/**
+ * @brief internal validation flag for checking only the children of the present data nodes, not their whole subtrees
+ */
+#define LYD_OPT_SHALLOW 0x40000
+
+/**
+ * @brief Validity flags of the changes tracked for the incremental validation (#LYD_OPT_INCREMENTAL)
+ */
+#define LYD_VAL_CHANGES (LYD_VAL_CHANGED | LYD_VAL_SUBTREE | LYD_VAL_REMOVED | LYD_VAL_SIBREMOVED)
+
 /**
  * @brief Internal list of built-in types
  */
@@ -371,6 +381,163 @@ int lyd_insert_common(struct lyd_node *parent, struct lyd_node **sibling, struct
  */
 int lyd_insert_nextto(struct lyd_node *sibling, struct lyd_node *node, int before, int invalidate);
 
+/**
+ * number of children a data node must have to get its children index (hash table) created
+ */
+#define LYD_HT_MIN_CHILDREN 16
+
+/**
+ * initial size of the buffer for the pushed data and size of the chunks read from pipes and sockets
+ */
+#define LYD_PUSH_BUF_SIZE 4096
+
+/**
+ * LYB binary data format - the header (#LYB_MAGIC, #LYB_VERSION and the length of all the data in 4 bytes, little
+ * endian), the table of the modules of the nodes (their count, names and revisions) and the top-level nodes.
+ *
+ * Every node starts with the size of the rest of its subtree in 4 bytes, so it can be skipped, followed by the index
+ * of its module in the table, the index of its schema node among the data siblings from the same module (see
+ * lys_getnext()), the name of the schema node (top-level nodes only), LYB_NODE_* flags, attributes (their count,
+ * module name, name and value) and either the value or the children. Numbers are stored as variable-length integers
+ * (7 bits in a byte, the least significant first), strings as their length + 1 (0 for NULL) and the characters.
+ */
+#define LYB_MAGIC "lyb"
+#define LYB_VERSION 1
+#define LYB_HEADER_SIZE 8
+
+#define LYB_NODE_DFLT 0x01    /**< implicit default node */
+#define LYB_NODE_STRVAL 0x02  /**< the value is stored only as the string and it must be parsed */
+#define LYB_NODE_NOVAL 0x04   /**< edit-config leaf without a value (#LY_TYPE_ERR) */
+
+/**
+ * Schema snapshot - the header (#LYS_SNAPSHOT_MAGIC, #LYS_SNAPSHOT_VERSION and the length of all the data in 4 bytes,
+ * little endian), the pointer size and the libyang version the snapshot was created by, the number of the objects,
+ * the string table (the number of references, length and characters of each string) and all the modules of
+ * the context in their order (including the internal and disabled ones).
+ *
+ * Every schema structure is stored as its raw memory followed by its pointer members - strings as their index
+ * in the table + 1 (0 for NULL), owned structures and arrays recursively and references to other structures as
+ * their ID in 4 bytes (0 for NULL). The IDs are assigned in the order the structures are stored, starting after
+ * the built-in types. Numbers are stored as variable-length integers (7 bits in a byte, the least significant first).
+ * The snapshot can be loaded only by the same libyang build (with the same extension plugins).
+ */
+#define LYS_SNAPSHOT_MAGIC "lys"
+#define LYS_SNAPSHOT_VERSION 1
+#define LYS_SNAPSHOT_HEADER_SIZE 8
+
+/**
+ * @brief Store all the modules of a context into a schema snapshot.
+ *
+ * @param[in] ctx Context to store.
+ * @param[out] data Allocated snapshot.
+ * @param[out] size Size of the snapshot.
+ * @return EXIT_SUCCESS or EXIT_FAILURE.
+ */
+int lys_snapshot_print(const struct ly_ctx *ctx, char **data, size_t *size);
+
+/**
+ * @brief Load all the modules from a schema snapshot into a context.
+ *
+ * @param[in] ctx Context without any modules, not even the internal ones.
+ * @param[in] data Snapshot created by lys_snapshot_print().
+ * @param[in] size Size of the snapshot.
+ * @return EXIT_SUCCESS or EXIT_FAILURE, the context must be destroyed in the latter case.
+ */
+int lys_snapshot_parse(struct ly_ctx *ctx, const char *data, size_t size);
+
+/**
+ * @brief Add a node into the children index of its parent, must be called whenever a node is linked to a parent.
+ * The index is created if the parent has enough children. If the node is a list key, the hash of the list
+ * instance is updated.
+ *
+ * @param[in] node Node just linked to its parent.
+ */
+void lyd_insert_hash(struct lyd_node *node);
+
+/**
+ * @brief Remove a node from the children index of its former parent, must be called whenever a node is unlinked
+ * from a parent. If the node is a list key, the list instance is removed from the index of its parent.
+ *
+ * @param[in] node Node just unlinked from \p orig_parent.
+ * @param[in] orig_parent Former parent of \p node.
+ */
+void lyd_unlink_hash(struct lyd_node *node, struct lyd_node *orig_parent);
+
+/**
+ * @brief Update the children index after the value of a leaf-list or list key changed.
+ *
+ * @param[in] node Leaf or leaf-list node with a changed value.
+ */
+void lyd_update_hash(struct lyd_node *node);
+
+/**
+ * @brief Find a child instance in the children index of a node.
+ *
+ * @param[in] parent Parent of the searched node.
+ * @param[in] schema Schema node of the searched node.
+ * @param[in] values Canonical values of all the keys of a list (in the schema order) or the value of a leaf-list,
+ * NULL for other nodes.
+ * @param[in] val_lens Lengths of \p values, NULL if they are all terminated.
+ * @param[out] match Found node.
+ *
+ * @return 1 if found, 0 if there is no such instance, -1 if the index cannot be used (there is no index or the
+ * nodes are not indexed), the children must be searched sequentially in that case.
+ */
+int lyd_find_hash(const struct lyd_node *parent, const struct lys_node *schema, const char **values,
+                  const int *val_lens, struct lyd_node **match);
+
+/**
+ * @brief Find a child instance matching another node (of the same schema node) in the children index of a node.
+ *
+ * @param[in] parent Parent of the searched node.
+ * @param[in] node Node with the same schema node and values (list keys) as the searched one.
+ * @param[out] match Found node.
+ *
+ * @return 1 if found, 0 if there is no such instance, -1 if the index cannot be used.
+ */
+int lyd_find_hash_instance(const struct lyd_node *parent, const struct lyd_node *node, struct lyd_node **match);
+
+/**
+ * @brief Create a separate index of a list of siblings, for siblings without the children index of their parent
+ * (top-level nodes). The index must be freed with lyht_free() and must not be used after the siblings change.
+ *
+ * @param[in] first First sibling to index.
+ * @return Created index, NULL on error.
+ */
+struct hash_table *lyd_hash_siblings(struct lyd_node *first);
+
+/**
+ * @brief Add a node into an index created by lyd_hash_siblings(), must be called whenever a sibling is added.
+ *
+ * @param[in] ht Index of the siblings.
+ * @param[in] node New sibling.
+ * @return EXIT_SUCCESS or EXIT_FAILURE, the index cannot be used anymore in that case.
+ */
+int lyd_hash_siblings_add(struct hash_table *ht, struct lyd_node *node);
+
+/**
+ * @brief Find a sibling instance matching another node (of the same schema node) in an index of siblings.
+ *
+ * @param[in] ht Children index of the parent or an index created by lyd_hash_siblings(), may be NULL.
+ * @param[in] node Node with the same schema node and values (list keys) as the searched one.
+ * @param[out] match Found node.
+ *
+ * @return 1 if found, 0 if there is no such instance, -1 if the index cannot be used.
+ */
+int lyd_find_hash_sibling(struct hash_table *ht, const struct lyd_node *node, struct lyd_node **match);
+
+/**
+ * @brief Check the uniqueness of the instances of a list or leaf-list flagged with #LYD_VAL_UNIQUE using the
+ * children index of their parent and the unique index kept with it. The unique index is created with the first
+ * check and the instances not flagged are expected to be already indexed in it.
+ *
+ * @param[in] node First instance flagged with #LYD_VAL_UNIQUE, the previous instances are not checked.
+ *
+ * @return EXIT_SUCCESS, EXIT_FAILURE if there are duplicate instances (the error is logged), -1 if the indexes
+ * cannot be used and all the instances must be checked without them.
+ */
+int lyd_hash_unique_check(struct lyd_node *node);
+
 /**
  * @brief Find an import from \p module with matching \p prefix, \p name, or both,
  * \p module itself is also compared.
@@ -429,6 +596,84 @@ int lys_get_sibling(const struct lys_node *siblings, const char *mod_name, int m
 int lys_getnext_data(const struct lys_module *mod, const struct lys_node *parent, const char *name, int nam_len,
                      LYS_NODE type, const struct lys_node **ret);
 
+/**
+ * @brief Get the position of a schema node among all the schema nodes of its possible data siblings
+ * (in the lys_getnext() order, so choices, cases and uses are transparent). The positions are taken from
+ * the context index, which is built for all the data nodes at once if needed and then read without locking.
+ * The positions of the nodes not in the index (in groupings, for instance) are computed by walking their siblings.
+ *
+ * @param[in] node Schema data node.
+ * @return Position starting from 1, 0 on error.
+ */
+uint32_t lys_node_pos(const struct lys_node *node);
+
+/**
+ * @brief Free all the positions stored in the schema nodes positions index of a context.
+ *
+ * @param[in] ctx Context with the index.
+ */
+void lys_pos_index_clean(struct ly_ctx *ctx);
+
+/**
+ * @brief Add a module into the module index of its context.
+ *
+ * @param[in] module Module being added into the context.
+ * @return EXIT_SUCCESS on success, EXIT_FAILURE on memory allocation failure.
+ */
+int ly_ctx_mod_index_add(struct lys_module *module);
+
+/**
+ * @brief Remove a module from the module index of its context.
+ *
+ * @param[in] module Module being removed from the context.
+ */
+void ly_ctx_mod_index_remove(struct lys_module *module);
+
+/**
+ * @brief Iterate over the modules (all the revisions, including the disabled ones) of a context with the given name
+ * or namespace using the context module index.
+ *
+ * @param[in] ctx Context with the index.
+ * @param[in] key Module name or namespace, does not need to be terminated.
+ * @param[in] len Length of \p key.
+ * @param[in] ns Whether \p key is a namespace rather than a name.
+ * @param[in] prev Previously returned module, NULL to get the first one.
+ * @return Next matching module, NULL if there are no more.
+ */
+struct lys_module *ly_ctx_mod_index_next(const struct ly_ctx *ctx, const char *key, size_t len, int ns,
+                                         const struct lys_module *prev);
+
+/**
+ * @brief Get the closest schema parent of a node that can be instantiated in a data tree (choices, cases and uses
+ * are skipped).
+ *
+ * @param[in] node Schema node.
+ * @return Data parent, NULL for a top-level node.
+ */
+const struct lys_node *lys_data_parent(const struct lys_node *node);
+
+struct ly_dep_entry;
+
+/**
+ * @brief Get the when and must conditions whose result can depend on instances of a schema node or any node
+ * in its subtree. The dependencies are taken from the context index, which is built for all the implemented
+ * modules at once if needed.
+ *
+ * @param[in] ctx Context with the index.
+ * @param[in] node Schema data node, NULL for the conditions with the whole data tree scope and the values that can
+ *            refer to any data.
+ * @param[out] deps Dependent conditions, NULL if there are none.
+ * @return EXIT_SUCCESS on success, EXIT_FAILURE on error.
+ */
+int lys_node_deps(struct ly_ctx *ctx, const struct lys_node *node, const struct ly_dep_entry **deps);
+
+/**
+ * @brief Free the dependency index of a context.
+ *
+ * @param[in] ctx Context with the index.
+ */
+void lys_dep_index_clean(struct ly_ctx *ctx);
+
 /**
  * @brief Compare 2 list or leaf-list data nodes if they are the same from the YANG point of view. Logs directly.
  *
@@ -25,6 +25,7 @@
 #include <string.h>
 #include <unistd.h>
 #include <errno.h>
+#include <pthread.h>
 
 #include "common.h"
 #include "context.h"
@@ -345,6 +346,569 @@ repeat:
     }
 }
 
+static int
+lys_pos_equal(void *val_searched, void *val_stored, void *UNUSED(cb_data))
+{
+    return ((struct ly_pos_rec *)val_stored)->node == val_searched;
+}
+
+static uint32_t
+lys_pos_hash(const struct lys_node *node)
+{
+    return dict_hash_multi(dict_hash_multi(0, (const char *)&node, sizeof node), NULL, 0);
+}
+
+void
+lys_pos_index_clean(struct ly_ctx *ctx)
+{
+    struct ly_pos_group *group;
+    struct hash_table *ht;
+
+    /* unpublish the index first */
+    ht = ctx->pos_index.ht;
+    __atomic_store_n(&ctx->pos_index.ht, NULL, __ATOMIC_RELEASE);
+    lyht_free(ht);
+
+    while ((group = ctx->pos_index.groups)) {
+        ctx->pos_index.groups = group->next;
+        free(group->recs);
+        free(group);
+    }
+}
+
+/**
+ * @brief Add positions of all the possible data children of a schema node into the positions index,
+ * recursively for the whole subtree.
+ *
+ * @param[in] index Index to add into.
+ * @param[in] ht Hash table of the index being built.
+ * @param[in] parent Data parent of the children, NULL for the top-level nodes.
+ * @param[in] module Module of the top-level nodes.
+ * @return EXIT_SUCCESS on success, EXIT_FAILURE on error.
+ */
+static int
+lys_pos_index_subtree(struct ly_pos_index *index, struct hash_table *ht, const struct lys_node *parent,
+                      const struct lys_module *module)
+{
+    const struct lys_node *iter;
+    struct ly_pos_group *group;
+    uint32_t count, i;
+
+    count = 0;
+    for (iter = NULL; (iter = lys_getnext(iter, parent, module, 0)); ++count);
+
+    group = malloc(sizeof *group);
+    if (!group) {
+        LOGMEM;
+        return EXIT_FAILURE;
+    }
+    group->recs = malloc(count * sizeof *group->recs);
+    if (count && !group->recs) {
+        LOGMEM;
+        free(group);
+        return EXIT_FAILURE;
+    }
+    group->next = index->groups;
+    index->groups = group;
+
+    for (i = 0, iter = NULL; (i < count) && (iter = lys_getnext(iter, parent, module, 0)); ++i) {
+        group->recs[i].node = iter;
+        group->recs[i].pos = i + 1;
+        if (lyht_insert(ht, &group->recs[i], lys_pos_hash(iter))) {
+            return EXIT_FAILURE;
+        }
+    }
+
+    for (i = 0; i < count; ++i) {
+        iter = group->recs[i].node;
+        if (iter->nodetype & (LYS_RPC | LYS_ACTION)) {
+            /* the data children of the input and output */
+            LY_TREE_FOR(iter->child, iter) {
+                if ((iter->nodetype & (LYS_INPUT | LYS_OUTPUT)) && lys_pos_index_subtree(index, ht, iter, module)) {
+                    return EXIT_FAILURE;
+                }
+            }
+        } else if ((iter->nodetype & (LYS_CONTAINER | LYS_LIST | LYS_NOTIF))
+                && lys_pos_index_subtree(index, ht, iter, module)) {
+            return EXIT_FAILURE;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Get the published positions index of a context, build it first if needed.
+ *
+ * @param[in] ctx Context with the index.
+ * @return Hash table of the index, NULL on error.
+ */
+static struct hash_table *
+lys_pos_index_get(struct ly_ctx *ctx)
+{
+    struct ly_pos_index *index = &ctx->pos_index;
+    struct hash_table *ht;
+    int i;
+
+    pthread_mutex_lock(&index->lock);
+
+    ht = index->ht;
+    if (ht && (index->module_set_id == ctx->models.module_set_id)) {
+        /* built by another thread meanwhile */
+        goto cleanup;
+    }
+
+    /* the positions change with the schemas */
+    lys_pos_index_clean(ctx);
+    ht = lyht_new(lys_pos_equal, NULL);
+    if (!ht) {
+        goto cleanup;
+    }
+    for (i = 0; i < ctx->models.used; i++) {
+        /* skip not implemented and disabled modules */
+        if (!ctx->models.list[i]->implemented || ctx->models.list[i]->disabled) {
+            continue;
+        }
+        if (lys_pos_index_subtree(index, ht, NULL, ctx->models.list[i])) {
+            lyht_free(ht);
+            ht = NULL;
+            lys_pos_index_clean(ctx);
+            goto cleanup;
+        }
+    }
+
+    /* publish the complete index, readers check module_set_id first */
+    __atomic_store_n(&index->module_set_id, ctx->models.module_set_id, __ATOMIC_RELEASE);
+    __atomic_store_n(&index->ht, ht, __ATOMIC_RELEASE);
+
+cleanup:
+    pthread_mutex_unlock(&index->lock);
+    return ht;
+}
+
+uint32_t
+lys_node_pos(const struct lys_node *node)
+{
+    struct ly_ctx *ctx = node->module->ctx;
+    struct ly_pos_index *index = &ctx->pos_index;
+    const struct lys_node *parent, *iter;
+    struct hash_table *ht;
+    struct ly_pos_rec *rec;
+    uint32_t pos;
+
+    /* an index with the current module_set_id cannot be freed without changing the schemas */
+    ht = NULL;
+    if (__atomic_load_n(&index->module_set_id, __ATOMIC_ACQUIRE) == ctx->models.module_set_id) {
+        ht = __atomic_load_n(&index->ht, __ATOMIC_ACQUIRE);
+    }
+    if (!ht) {
+        ht = lys_pos_index_get(ctx);
+    }
+    if (ht && !lyht_find(ht, (void *)node, lys_pos_hash(node), (void **)&rec)) {
+        return rec->pos;
+    }
+
+    /* not indexed, walk the siblings */
+    parent = lys_data_parent(node);
+    for (pos = 1, iter = NULL; (iter = lys_getnext(iter, parent, lys_node_module(node), 0)); ++pos) {
+        if (iter == node) {
+            return pos;
+        }
+    }
+
+    /* not a data node */
+    LOGINT;
+    return 0;
+}
+
+const struct lys_node *
+lys_data_parent(const struct lys_node *node)
+{
+    do {
+        node = lys_parent(node);
+    } while (node && (node->nodetype & (LYS_CHOICE | LYS_CASE | LYS_USES)));
+
+    return node;
+}
+
+static int
+lys_dep_equal(void *val_searched, void *val_stored, void *UNUSED(cb_data))
+{
+    return ((struct ly_dep_entry *)val_stored)->node == val_searched;
+}
+
+void
+lys_dep_index_clean(struct ly_ctx *ctx)
+{
+    struct ly_dep_entry *entry;
+    struct ly_dep_rec *rec;
+
+    while ((entry = ctx->dep_index.entries)) {
+        ctx->dep_index.entries = entry->next;
+        free(entry->recs);
+        free(entry);
+    }
+    while ((rec = ctx->dep_index.recs)) {
+        ctx->dep_index.recs = rec->next;
+        free(rec);
+    }
+    free(ctx->dep_index.global.recs);
+    memset(&ctx->dep_index.global, 0, sizeof ctx->dep_index.global);
+    lyht_free(ctx->dep_index.ht);
+    ctx->dep_index.ht = NULL;
+}
+
+static int
+lys_dep_entry_add(struct ly_dep_entry *entry, struct ly_dep_rec *rec)
+{
+    struct ly_dep_rec **recs;
+
+    if (entry->count && (entry->recs[entry->count - 1] == rec)) {
+        /* already added for another node in the subtree */
+        return EXIT_SUCCESS;
+    }
+
+    if (entry->count == entry->size) {
+        recs = realloc(entry->recs, (entry->size ? entry->size * 2 : 4) * sizeof *recs);
+        if (!recs) {
+            LOGMEM;
+            return EXIT_FAILURE;
+        }
+        entry->recs = recs;
+        entry->size = entry->size ? entry->size * 2 : 4;
+    }
+    entry->recs[entry->count++] = rec;
+
+    return EXIT_SUCCESS;
+}
+
+static uint32_t
+lys_data_depth(const struct lys_node *node)
+{
+    uint32_t depth;
+
+    for (depth = 0; node; node = lys_data_parent(node), ++depth);
+    return depth;
+}
+
+/**
+ * @brief Get the closest common data parent (or self) of 2 schema data nodes.
+ *
+ * @return Common data node, NULL if they are in different top-level subtrees.
+ */
+static const struct lys_node *
+lys_dep_common_parent(const struct lys_node *node1, const struct lys_node *node2)
+{
+    uint32_t depth1, depth2;
+
+    depth1 = lys_data_depth(node1);
+    depth2 = lys_data_depth(node2);
+    for (; depth1 > depth2; node1 = lys_data_parent(node1), --depth1);
+    for (; depth2 > depth1; node2 = lys_data_parent(node2), --depth2);
+    while (node1 != node2) {
+        node1 = lys_data_parent(node1);
+        node2 = lys_data_parent(node2);
+    }
+
+    return node1;
+}
+
+/**
+ * @brief Get all the data nodes an XPath expression depends on, including the arguments of its functions.
+ *
+ * @param[in] expr XPath expression.
+ * @param[in] node Schema node with the expression.
+ * @param[in] options LYXP_SNODE_WHEN or LYXP_SNODE_MUST.
+ * @param[in,out] atoms Set to add the schema data nodes into.
+ * @return EXIT_SUCCESS on success, EXIT_FAILURE if the expression can depend on any data.
+ */
+static int
+lys_dep_atomize_expr(const char *expr, const struct lys_node *node, int options, struct ly_set *atoms)
+{
+    struct lyxp_set set;
+    uint32_t i;
+    int ret;
+
+    /* the targets of dereferenced leafrefs are not known */
+    if (strstr(expr, "deref(")) {
+        return EXIT_FAILURE;
+    }
+
+    memset(&set, 0, sizeof set);
+    ly_vlog_hide(1);
+    ret = lyxp_atomize(expr, node, LYXP_NODE_ELEM, &set, options | LYXP_SNODE_ARGS);
+    ly_vlog_hide(0);
+    if (ret) {
+        free(set.val.snodes);
+        ly_err_clean(1);
+        return EXIT_FAILURE;
+    }
+
+    for (i = 0; i < set.used; ++i) {
+        /* skip the roots of absolute paths */
+        if (set.val.snodes[i].type == LYXP_NODE_ELEM) {
+            ly_set_add(atoms, set.val.snodes[i].snode, 0);
+        }
+    }
+    free(set.val.snodes);
+
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Get all the data nodes the when and must conditions of a schema node depend on.
+ *
+ * @param[in] node Schema node with the conditions.
+ * @param[in,out] atoms Set to add the schema data nodes into.
+ * @param[in,out] flags LY_DEP_* flags to update.
+ * @return EXIT_SUCCESS on success, EXIT_FAILURE if the conditions can depend on any data.
+ */
+static int
+lys_dep_atomize(const struct lys_node *node, struct ly_set *atoms, uint8_t *flags)
+{
+    struct lys_when *when;
+    struct lys_restr *must;
+    uint8_t must_size, i;
+
+    must = NULL;
+    must_size = 0;
+    switch (node->nodetype) {
+    case LYS_CONTAINER:
+        when = ((struct lys_node_container *)node)->when;
+        must = ((struct lys_node_container *)node)->must;
+        must_size = ((struct lys_node_container *)node)->must_size;
+        break;
+    case LYS_LEAF:
+        when = ((struct lys_node_leaf *)node)->when;
+        must = ((struct lys_node_leaf *)node)->must;
+        must_size = ((struct lys_node_leaf *)node)->must_size;
+        break;
+    case LYS_LEAFLIST:
+        when = ((struct lys_node_leaflist *)node)->when;
+        must = ((struct lys_node_leaflist *)node)->must;
+        must_size = ((struct lys_node_leaflist *)node)->must_size;
+        break;
+    case LYS_LIST:
+        when = ((struct lys_node_list *)node)->when;
+        must = ((struct lys_node_list *)node)->must;
+        must_size = ((struct lys_node_list *)node)->must_size;
+        break;
+    case LYS_ANYXML:
+    case LYS_ANYDATA:
+        when = ((struct lys_node_anydata *)node)->when;
+        must = ((struct lys_node_anydata *)node)->must;
+        must_size = ((struct lys_node_anydata *)node)->must_size;
+        break;
+    case LYS_CHOICE:
+        when = ((struct lys_node_choice *)node)->when;
+        break;
+    case LYS_CASE:
+        when = ((struct lys_node_case *)node)->when;
+        break;
+    case LYS_USES:
+        when = ((struct lys_node_uses *)node)->when;
+        break;
+    case LYS_AUGMENT:
+        when = ((struct lys_node_augment *)node)->when;
+        break;
+    default:
+        when = NULL;
+        break;
+    }
+    if (!when && !must_size) {
+        return EXIT_SUCCESS;
+    }
+    if (when) {
+        *flags |= LY_DEP_WHEN;
+    }
+    if (must_size) {
+        *flags |= LY_DEP_MUST;
+    }
+
+    if (when && lys_dep_atomize_expr(when->cond, node, LYXP_SNODE_WHEN, atoms)) {
+        return EXIT_FAILURE;
+    }
+    for (i = 0; i < must_size; ++i) {
+        if (lys_dep_atomize_expr(must[i].expr, node, LYXP_SNODE_MUST, atoms)) {
+            return EXIT_FAILURE;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Add the conditions of a schema data node into the dependency index.
+ *
+ * @param[in] index Index to add into.
+ * @param[in] node Schema data node.
+ * @return EXIT_SUCCESS on success, EXIT_FAILURE on error.
+ */
+static int
+lys_dep_index_node(struct ly_dep_index *index, const struct lys_node *node)
+{
+    const struct lys_node *parent, *iter, *scope;
+    struct ly_dep_entry *entry;
+    struct ly_dep_rec *rec;
+    struct lys_type *type;
+    struct ly_set *atoms;
+    uint32_t i, hash;
+    uint8_t flags = 0;
+    int global = 0, ret = EXIT_FAILURE;
+
+    atoms = ly_set_new();
+    if (!atoms) {
+        return EXIT_FAILURE;
+    }
+
+    /* instance-identifiers can refer to any data */
+    if (node->nodetype & (LYS_LEAF | LYS_LEAFLIST)) {
+        type = &((struct lys_node_leaf *)node)->type;
+        if ((type->base == LY_TYPE_INST) || ((type->base == LY_TYPE_UNION) && type->info.uni.has_ptr_type)) {
+            flags |= LY_DEP_VALUE;
+        }
+    }
+
+    /* conditions of the node and of its parents without data instances (as in resolve_applies_when()) */
+    for (parent = node;
+            parent && ((parent == node) || (parent->nodetype & (LYS_USES | LYS_CHOICE | LYS_CASE)));
+            parent = lys_parent(parent)) {
+        if (lys_dep_atomize(parent, atoms, &flags)) {
+            flags |= LY_DEP_VALUE;
+        }
+        if (parent->parent && (parent->parent->nodetype == LYS_AUGMENT)
+                && lys_dep_atomize(parent->parent, atoms, &flags)) {
+            flags |= LY_DEP_VALUE;
+        }
+    }
+    if (!flags) {
+        ret = EXIT_SUCCESS;
+        goto cleanup;
+    }
+
+    rec = calloc(1, sizeof *rec);
+    if (!rec) {
+        LOGMEM;
+        goto cleanup;
+    }
+    rec->node = node;
+    rec->flags = flags;
+    rec->next = index->recs;
+    index->recs = rec;
+
+    /* the smallest subtree with all the data the conditions depend on */
+    scope = node;
+    for (i = 0; scope && (i < atoms->number); ++i) {
+        scope = lys_dep_common_parent(scope, atoms->set.s[i]);
+    }
+    if (!scope) {
+        global = 1;
+    }
+    rec->scope = scope;
+
+    if ((flags & LY_DEP_VALUE) || global) {
+        if (lys_dep_entry_add(&index->global, rec)) {
+            goto cleanup;
+        }
+    }
+
+    /* the conditions depend on the atoms and so on changes in all their parents subtrees */
+    for (i = 0; i < atoms->number; ++i) {
+        for (iter = atoms->set.s[i]; iter; iter = lys_data_parent(iter)) {
+            hash = lys_pos_hash(iter);
+            if (lyht_find(index->ht, (void *)iter, hash, (void **)&entry)) {
+                entry = calloc(1, sizeof *entry);
+                if (!entry) {
+                    LOGMEM;
+                    goto cleanup;
+                }
+                entry->node = iter;
+                entry->next = index->entries;
+                index->entries = entry;
+                if (lyht_insert(index->ht, entry, hash)) {
+                    goto cleanup;
+                }
+            }
+            if (lys_dep_entry_add(entry, rec)) {
+                goto cleanup;
+            }
+        }
+    }
+    ret = EXIT_SUCCESS;
+
+cleanup:
+    ly_set_free(atoms);
+    return ret;
+}
+
+static int
+lys_dep_index_subtree(struct ly_dep_index *index, const struct lys_node *siblings)
+{
+    const struct lys_node *iter;
+
+    LY_TREE_FOR(siblings, iter) {
+        if (iter->nodetype & (LYS_GROUPING | LYS_RPC | LYS_ACTION | LYS_NOTIF)) {
+            /* no data tree nodes */
+            continue;
+        }
+        if ((iter->nodetype & (LYS_CONTAINER | LYS_LEAF | LYS_LEAFLIST | LYS_LIST | LYS_ANYDATA))
+                && lys_dep_index_node(index, iter)) {
+            return EXIT_FAILURE;
+        }
+        if (!(iter->nodetype & (LYS_LEAF | LYS_LEAFLIST | LYS_ANYDATA)) && lys_dep_index_subtree(index, iter->child)) {
+            return EXIT_FAILURE;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
+
+int
+lys_node_deps(struct ly_ctx *ctx, const struct lys_node *node, const struct ly_dep_entry **deps)
+{
+    struct ly_dep_index *index = &ctx->dep_index;
+    struct ly_dep_entry *entry;
+    int i, ret = EXIT_FAILURE;
+
+    pthread_mutex_lock(&index->lock);
+
+    /* the dependencies change with the schemas */
+    if (index->ht && (index->module_set_id != ctx->models.module_set_id)) {
+        lys_dep_index_clean(ctx);
+    }
+    if (!index->ht) {
+        index->ht = lyht_new(lys_dep_equal, NULL);
+        if (!index->ht) {
+            goto cleanup;
+        }
+        index->module_set_id = ctx->models.module_set_id;
+
+        for (i = 0; i < ctx->models.used; i++) {
+            /* skip not implemented and disabled modules */
+            if (!ctx->models.list[i]->implemented || ctx->models.list[i]->disabled) {
+                continue;
+            }
+            if (lys_dep_index_subtree(index, ctx->models.list[i]->data)) {
+                lys_dep_index_clean(ctx);
+                goto cleanup;
+            }
+        }
+    }
+
+    if (!node) {
+        *deps = index->global.count ? &index->global : NULL;
+    } else if (!lyht_find(index->ht, (void *)node, lys_pos_hash(node), (void **)&entry)) {
+        *deps = entry;
+    } else {
+        *deps = NULL;
+    }
+    ret = EXIT_SUCCESS;
+
+cleanup:
+    pthread_mutex_unlock(&index->lock);
+    return ret;
+}
+
 void
 lys_node_unlink(struct lys_node *node)
 {
@@ -1314,6 +1878,7 @@ lys_restr_free(struct ly_ctx *ctx, struct lys_restr *restr,
     }
 
     lys_extension_instances_free(ctx, restr->ext, restr->ext_size, private_destructor);
+    lyxp_expr_free(restr->expr_compiled);
     lydict_remove(ctx, restr->expr);
     lydict_remove(ctx, restr->dsc);
     lydict_remove(ctx, restr->ref);
@@ -1460,6 +2025,9 @@ type_dup(struct lys_module *mod, struct lys_node *parent, struct lys_type *new,
             }
             new->info.str.patterns = lys_restr_dup(mod, old->info.str.patterns, old->info.str.pat_count, shallow, unres);
             new->info.str.pat_count = old->info.str.pat_count;
+            if (!in_grp && lyp_precompile_type_patterns(new)) {
+                return -1;
+            }
             break;
 
         case LY_TYPE_UNION:
@@ -1908,6 +2476,7 @@ lys_type_free(struct ly_ctx *ctx, struct lys_type *type,
     case LY_TYPE_STRING:
         lys_restr_free(ctx, type->info.str.length, private_destructor);
         free(type->info.str.length);
+        lyp_free_type_patterns(type);
         for (i = 0; i < type->info.str.pat_count; i++) {
             lys_restr_free(ctx, &type->info.str.patterns[i], private_destructor);
         }
@@ -1984,6 +2553,7 @@ lys_when_free(struct ly_ctx *ctx, struct lys_when *w,
     }
 
     lys_extension_instances_free(ctx, w->ext, w->ext_size, private_destructor);
+    lyxp_expr_free(w->cond_compiled);
     lydict_remove(ctx, w->cond);
     lydict_remove(ctx, w->dsc);
     lydict_remove(ctx, w->ref);
@@ -2408,23 +2978,18 @@ lys_node_free(struct lys_node *node, void (*private_destructor)(const struct lys
 API struct lys_module *
 lys_implemented_module(const struct lys_module *mod)
 {
-    struct ly_ctx *ctx;
-    int i;
+    struct lys_module *iter;
 
     if (!mod || mod->implemented) {
         /* invalid argument or the module itself is implemented */
         return (struct lys_module *)mod;
     }
 
-    ctx = mod->ctx;
-    for (i = 0; i < ctx->models.used; i++) {
-        if (!ctx->models.list[i]->implemented) {
-            continue;
-        }
-
-        if (ly_strequal(mod->name, ctx->models.list[i]->name, 1)) {
+    iter = NULL;
+    while ((iter = ly_ctx_mod_index_next(mod->ctx, mod->name, strlen(mod->name), 0, iter))) {
+        if (iter->implemented) {
             /* we have some revision of the module implemented */
-            return ctx->models.list[i];
+            return iter;
         }
     }
 
@@ -2852,9 +3417,15 @@ lys_node_dup_recursion(struct lys_module *module, struct lys_node *parent, const
             goto error;
         }
 
-        /* go recursively */
+        /* go recursively, the uses sharing its grouping gets the nodes directly from the grouping */
         if (!(node->nodetype & (LYS_LEAF | LYS_LEAFLIST))) {
-            LY_TREE_FOR(node->child, iter) {
+            if ((node->nodetype == LYS_USES) && (node->flags & LYS_SHAREDGRP)) {
+                retval->flags &= ~LYS_SHAREDGRP;
+                iter = uses_orig->grp->child;
+            } else {
+                iter = node->child;
+            }
+            LY_TREE_FOR(iter, iter) {
                 if (iter->nodetype & LYS_GROUPING) {
                     /* do not instantiate groupings */
                     continue;
@@ -2911,6 +3482,10 @@ lys_node_dup_recursion(struct lys_module *module, struct lys_node *parent, const
                     }
                     goto error;
                 }
+                if ((ctx->models.flags & LY_CTX_SHAREDGRP) && (lyp_check_mandatory_choice(retval) == -1)) {
+                    /* the default case could include a uses sharing its grouping */
+                    goto error;
+                }
             } else {
                 /* useless to check return value, we don't know whether
                 * there really wasn't any default defined or it just hasn't
@@ -3039,7 +3614,15 @@ lys_node_dup_recursion(struct lys_module *module, struct lys_node *parent, const
                 unique_info->list = (struct lys_node *)list;
                 unique_info->expr = list->unique[i].expr[j];
                 unique_info->trg_type = &list->unique[i].trg_type;
-                unres_schema_dup(module, unres, &list_orig, UNRES_LIST_UNIQ, unique_info);
+                if ((ctx->models.flags & LY_CTX_SHAREDGRP) && !shallow) {
+                    /* the targets could be in a uses sharing its grouping, so they are resolved again in the copy */
+                    list->unique[i].trg_type = 0;
+                    if (unres_schema_add_node(module, unres, unique_info, UNRES_LIST_UNIQ, NULL) == -1) {
+                        goto error;
+                    }
+                } else {
+                    unres_schema_dup(module, unres, &list_orig, UNRES_LIST_UNIQ, unique_info);
+                }
             }
         }
 
@@ -3330,9 +3913,10 @@ lys_free(struct lys_module *module, void (*private_destructor)(const struct lys_
     if (remove_from_ctx && ctx->models.used) {
         for (i = 0; i < ctx->models.used; i++) {
             if (ctx->models.list[i] == module) {
+                ly_ctx_mod_index_remove(module);
                 /* move all the models to not change the order in the list */
                 ctx->models.used--;
-                memmove(&ctx->models.list[i], ctx->models.list[i + 1], (ctx->models.used - i) * sizeof *ctx->models.list);
+                memmove(&ctx->models.list[i], &ctx->models.list[i + 1], (ctx->models.used - i) * sizeof *ctx->models.list);
                 ctx->models.list[ctx->models.used] = NULL;
                 /* we are done */
                 break;
@@ -4386,6 +4970,7 @@ API int
 lys_set_implemented(const struct lys_module *module)
 {
     struct ly_ctx *ctx;
+    struct lys_module *iter;
     struct unres_schema *unres;
     int i, j, k, disabled = 0;
 
@@ -4407,12 +4992,13 @@ lys_set_implemented(const struct lys_module *module)
 
     ctx = module->ctx;
 
-    for (i = 0; i < ctx->models.used; ++i) {
-        if (module == ctx->models.list[i]) {
+    iter = NULL;
+    while ((iter = ly_ctx_mod_index_next(ctx, module->name, strlen(module->name), 0, iter))) {
+        if (module == iter) {
             continue;
         }
 
-        if (!strcmp(module->name, ctx->models.list[i]->name) && ctx->models.list[i]->implemented) {
+        if (iter->implemented) {
             LOGERR(LY_EINVAL, "Module \"%s\" in another revision already implemented.", module->name);
             if (disabled) {
                 /* set it back disabled */
@@ -4463,6 +5049,14 @@ lys_set_implemented(const struct lys_module *module)
     }
     unres_schema_free(NULL, &unres, 0);
 
+    /* the applied augments changed the positions of the augmented nodes' children */
+    pthread_mutex_lock(&ctx->pos_index.lock);
+    lys_pos_index_clean(ctx);
+    pthread_mutex_unlock(&ctx->pos_index.lock);
+    pthread_mutex_lock(&ctx->dep_index.lock);
+    lys_dep_index_clean(ctx);
+    pthread_mutex_unlock(&ctx->dep_index.lock);
+
     return EXIT_SUCCESS;
 
 error:
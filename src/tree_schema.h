@@ -97,6 +97,14 @@ extern "C" {
          (ELEM);                                                              \
          (ELEM) = (NEXT))
 
+/**
+ * @brief Helper macro for #LY_TREE_DFS_END, non-zero if \p START points to a data tree node. struct lyd_node
+ * is as large as struct lyxml_elem, so the offset of their child member is compared as well.
+ */
+#define LY_TREE_DFS_IS_DATA(START)                                            \
+    ((sizeof *(START) == sizeof(struct lyd_node))                             \
+            && ((size_t)((const char *)&(START)->child - (const char *)(START)) == offsetof(struct lyd_node, child)))
+
 /**
  * @ingroup datatree
  * @brief Macro to iterate via all elements in a tree. This is the closing part
@@ -116,7 +124,7 @@ extern "C" {
 #define LY_TREE_DFS_END(START, NEXT, ELEM)                                    \
     /* select element for the next run - children first */                    \
     (NEXT) = (ELEM)->child;                                                   \
-    if (sizeof(typeof(*(START))) == sizeof(struct lyd_node)) {                \
+    if (LY_TREE_DFS_IS_DATA(START)) {                                         \
         /* child exception for leafs, leaflists and anyxml without children */\
         if (((struct lyd_node *)(ELEM))->schema->nodetype & (LYS_LEAF | LYS_LEAFLIST | LYS_ANYDATA)) { \
             (NEXT) = NULL;                                                    \
@@ -1033,6 +1041,7 @@ struct lys_iffeature {
  *       LYS_INCL_STATUS  |x| | | |x| | | | | | | | | | | | | | |
  *                        +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
  *     9 LYS_USERORDERED  | | | |x|x| | | | | | |r| | | | | |r| |
+ *       LYS_SHAREDGRP    | | | | | | | | | | | | |x| | | | | | |
  *       LYS_UNIQUE       | | |x| | | | | | | | |r| | | | | |r| |
  *       LYS_FENABLED     | | | | | | | | | | | |r| | |x| | |r| |
  *                        +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
@@ -1068,6 +1077,9 @@ struct lys_iffeature {
                                           ::lys_node_list and ::lys_node_leaflist */
 #define LYS_FENABLED     0x100       /**< feature enabled flag, applicable only to ::lys_feature */
 #define LYS_UNIQUE       0x100       /**< part of the list's unique, applicable only to ::lys_node_leaf */
+#define LYS_SHAREDGRP    0x100       /**< uses in a grouping without the copy of its grouping's nodes (they are copied
+                                          only when the enclosing grouping is instantiated), applicable only to
+                                          ::lys_node_uses */
 #define LYS_AUTOASSIGNED 0x01        /**< value was auto-assigned, applicable only to
                                           ::lys_type enum and bits flags */
 #define LYS_USESGRP      0x01        /**< flag for resolving uses in groupings, applicable only to ::lys_node_uses */
@@ -1921,6 +1933,10 @@ struct lys_restr {
     const char *emsg;                /**< error-message (optional) */
     struct lys_ext_instance **ext;   /**< array of pointers to the extension instances */
     uint8_t ext_size;                /**< number of elements in #ext array */
+    void *expr_compiled;             /**< internal cache of the compiled XPath expression of a must restriction,
+                                          created with its first evaluation */
+    void *pattern_compiled;          /**< internal cache of the precompiled regular expression of a pattern
+                                          restriction used for data validation */
 };
 
 /**
@@ -1932,6 +1948,8 @@ struct lys_when {
     const char *ref;                 /**< reference (optional) */
     struct lys_ext_instance **ext;   /**< array of pointers to the extension instances */
     uint8_t ext_size;                /**< number of elements in #ext array */
+    void *cond_compiled;             /**< internal cache of the compiled XPath expression of the condition,
+                                          created with its first evaluation */
 };
 
 /**
@@ -51,8 +51,9 @@ lyv_keys(const struct lyd_node *list)
 int
 lyv_data_context(const struct lyd_node *node, int options, struct unres_data *unres)
 {
-    const struct lys_node *siter = NULL;
+    const struct lys_node *siter;
     struct lyd_node_leaf_list *leaf = (struct lyd_node_leaf_list *)node;
+    uint32_t pos, prev_pos;
 
     assert(node);
     assert(unres);
@@ -98,17 +99,22 @@ lyv_data_context(const struct lyd_node *node, int options, struct unres_data *un
     /* check elements order in case of RPC's input and output */
     if (!(options & (LYD_OPT_TRUSTED | LYD_OPT_NOTIF_FILTER)) && (node->validity & LYD_VAL_MAND) && lyp_is_rpc_action(node->schema)) {
         if ((node->prev != node) && node->prev->next) {
-            for (siter = lys_getnext(node->schema, lys_parent(node->schema), lyd_node_module(node), LYS_GETNEXT_PARENTUSES);
-                    siter;
-                    siter = lys_getnext(siter, lys_parent(node->schema), lyd_node_module(node), LYS_GETNEXT_PARENTUSES)) {
-                if (siter == node->prev->schema) {
-                    /* data predecessor has the schema node after
-                     * the schema node of the data node being checked */
-                    LOGVAL(LYE_INORDER, LY_VLOG_LYD, node, node->schema->name, siter->name);
+            pos = lys_node_pos(node->schema);
+            prev_pos = lys_node_pos(node->prev->schema);
+            if (!pos || !prev_pos) {
+                return EXIT_FAILURE;
+            }
+            if (prev_pos > pos) {
+                /* data predecessor has the schema node after the schema node of the data node being checked,
+                 * it matters only if they are in the same schema parent (uses, choice or case included) */
+                for (siter = lys_parent(node->prev->schema);
+                        siter && (siter != lys_parent(node->schema)) && (siter->nodetype & (LYS_USES | LYS_CHOICE | LYS_CASE));
+                        siter = lys_parent(siter));
+                if (siter == lys_parent(node->schema)) {
+                    LOGVAL(LYE_INORDER, LY_VLOG_LYD, node, node->schema->name, node->prev->schema->name);
                     return EXIT_FAILURE;
                 }
             }
-
         }
     }
 
@@ -174,6 +180,15 @@ lyv_data_unique(struct lyd_node *node, struct lyd_node *start)
     struct eq_item *keystable = NULL, **uniquetables = NULL;
     const char *id;
 
+    if (node->parent && node->parent->ht) {
+        /* check only the changed instances using the indexes of the parent */
+        ret = lyd_hash_unique_check(node);
+        if (ret != -1) {
+            return ret;
+        }
+        ret = EXIT_SUCCESS;
+    }
+
     /* get the first list/leaflist instance sibling */
     if (!start) {
         start = lyd_first_sibling(node);
@@ -187,9 +202,6 @@ lyv_data_unique(struct lyd_node *node, struct lyd_node *start)
             continue;
         }
 
-        /* remove the flag */
-        diter->validity &= ~LYD_VAL_UNIQUE;
-
         /* store for comparison */
         ly_set_add(set, diter, LY_SET_OPT_USEASLIST);
     }
@@ -306,6 +318,13 @@ lyv_data_unique(struct lyd_node *node, struct lyd_node *start)
     }
 
 unique_cleanup:
+    if (!ret) {
+        /* remove the flags, the instances are checked again if not unique */
+        for (u = 0; u < set->number; u++) {
+            set->set.d[u]->validity &= ~LYD_VAL_UNIQUE;
+        }
+    }
+
     /* cleanup */
     ly_set_free(set);
     free(keystable);
@@ -370,6 +389,11 @@ lyv_data_content(struct lyd_node *node, int options, struct unres_data *unres)
 
     schema = node->schema; /* shortcut */
 
+    if (!(options & (LYD_OPT_TRUSTED | LYD_OPT_NOTIF_FILTER | LYD_OPT_EDIT | LYD_OPT_GET | LYD_OPT_GETCONFIG))) {
+        /* the node is being validated, it is not a change for the incremental validation anymore */
+        node->validity &= ~LYD_VAL_CHANGES;
+    }
+
     if (node->validity & LYD_VAL_MAND) {
         if (!(options & (LYD_OPT_TRUSTED | LYD_OPT_NOTIF_FILTER))) {
             /* check presence and correct order of all keys in case of list */
@@ -845,20 +845,19 @@ error:
 
 /* logs directly */
 struct lyxml_elem *
-lyxml_parse_elem(struct ly_ctx *ctx, const char *data, unsigned int *len, struct lyxml_elem *parent, int options)
+lyxml_parse_elem_start(struct ly_ctx *ctx, const char *data, unsigned int *len, struct lyxml_elem *parent, int *closed)
 {
     const char *c = data, *start, *e;
-    const char *lws;    /* leading white space for handling mixed content */
     int uc;
-    char *str;
     char prefix[32] = { 0 };
     unsigned int prefix_len = 0;
-    struct lyxml_elem *elem = NULL, *child;
+    struct lyxml_elem *elem = NULL;
     struct lyxml_attr *attr;
     unsigned int size;
-    int nons_flag = 0, closed_flag = 0;
+    int nons_flag = 0;
 
     *len = 0;
+    *closed = 0;
 
     if (*c != '<') {
         return NULL;
@@ -913,181 +912,21 @@ lyxml_parse_elem(struct ly_ctx *ctx, const char *data, unsigned int *len, struct
     elem->name = lydict_insert(ctx, c, e - c);
     c = e;
 
-process:
-    ly_err_clean(1);
-    ign_xmlws(c);
-    if (!strncmp("/>", c, 2)) {
-        /* we are done, it was EmptyElemTag */
-        c += 2;
-        elem->content = lydict_insert(ctx, "", 0);
-        closed_flag = 1;
-    } else if (*c == '>') {
-        /* process element content */
-        c++;
-        lws = NULL;
-
-        while (*c) {
-            if (!strncmp(c, "</", 2)) {
-                if (lws && !elem->child) {
-                    /* leading white spaces were actually content */
-                    goto store_content;
-                }
-
-                /* Etag */
-                c += 2;
-                /* get name and check it */
-                e = c;
-                uc = lyxml_getutf8(e, &size);
-                if (!is_xmlnamestartchar(uc)) {
-                    LOGVAL(LYE_XML_INVAL, LY_VLOG_XML, elem, "NameStartChar of the element");
-                    goto error;
-                }
-                e += size;
-                uc = lyxml_getutf8(e, &size);
-                while (is_xmlnamechar(uc)) {
-                    if (*e == ':') {
-                        /* element in a namespace */
-                        start = e + 1;
-
-                        /* look for the prefix in namespaces */
-                        if (memcmp(prefix, c, e - c)) {
-                            LOGVAL(LYE_SPEC, LY_VLOG_XML, elem,
-                                   "Invalid (different namespaces) opening (%s) and closing element tags.", elem->name);
-                            goto error;
-                        }
-                        c = start;
-                    }
-                    e += size;
-                    uc = lyxml_getutf8(e, &size);
-                }
-                if (!*e) {
-                    LOGVAL(LYE_EOF, LY_VLOG_NONE, NULL);
-                    goto error;
-                }
-
-                /* check that it corresponds to opening tag */
-                size = e - c;
-                str = malloc((size + 1) * sizeof *str);
-                if (!str) {
-                    LOGMEM;
-                    goto error;
-                }
-                memcpy(str, c, e - c);
-                str[e - c] = '\0';
-                if (size != strlen(elem->name) || memcmp(str, elem->name, size)) {
-                    LOGVAL(LYE_SPEC, LY_VLOG_XML, elem,
-                           "Invalid (mixed names) opening (%s) and closing (%s) element tags.", elem->name, str);
-                    free(str);
-                    goto error;
-                }
-                free(str);
-                c = e;
-
-                ign_xmlws(c);
-                if (*c != '>') {
-                    LOGVAL(LYE_SPEC, LY_VLOG_XML, elem, "Data after closing element tag \"%s\".", elem->name);
-                    goto error;
-                }
-                c++;
-                if (!(elem->flags & LYXML_ELEM_MIXED) && !elem->content) {
-                    /* there was no content, but we don't want NULL (only if mixed content) */
-                    elem->content = lydict_insert(ctx, "", 0);
-                }
-                closed_flag = 1;
-                break;
-
-            } else if (!strncmp(c, "<?", 2)) {
-                if (lws) {
-                    /* leading white spaces were only formatting */
-                    lws = NULL;
-                }
-                /* PI - ignore it */
-                c += 2;
-                if (parse_ignore(c, "?>", &size)) {
-                    goto error;
-                }
-                c += size;
-            } else if (!strncmp(c, "<!--", 4)) {
-                if (lws) {
-                    /* leading white spaces were only formatting */
-                    lws = NULL;
-                }
-                /* Comment - ignore it */
-                c += 4;
-                if (parse_ignore(c, "-->", &size)) {
-                    goto error;
-                }
-                c += size;
-            } else if (!strncmp(c, "<![CDATA[", 9)) {
-                /* CDSect */
-                goto store_content;
-            } else if (*c == '<') {
-                if (lws) {
-                    if (elem->flags & LYXML_ELEM_MIXED) {
-                        /* we have a mixed content */
-                        goto store_content;
-                    } else {
-                        /* leading white spaces were only formatting */
-                        lws = NULL;
-                    }
-                }
-                if (elem->content) {
-                    /* we have a mixed content */
-                    if (options & LYXML_PARSE_NOMIXEDCONTENT) {
-                        LOGVAL(LYE_XML_INVAL, LY_VLOG_XML, elem, "XML element with mixed content");
-                        goto error;
-                    }
-                    child = calloc(1, sizeof *child);
-                    if (!child) {
-                        LOGMEM;
-                        goto error;
-                    }
-                    child->content = elem->content;
-                    elem->content = NULL;
-                    lyxml_add_child(ctx, elem, child);
-                    elem->flags |= LYXML_ELEM_MIXED;
-                }
-                child = lyxml_parse_elem(ctx, c, &size, elem, options);
-                if (!child) {
-                    goto error;
-                }
-                c += size;      /* move after processed child element */
-            } else if (is_xmlws(*c)) {
-                lws = c;
-                ign_xmlws(c);
-            } else {
-store_content:
-                /* store text content */
-                if (lws) {
-                    /* process content including the leading white spaces */
-                    c = lws;
-                    lws = NULL;
-                }
-                elem->content = lydict_insert_zc(ctx, parse_text(c, '<', &size));
-                if (ly_errno) {
-                    goto error;
-                }
-                c += size;      /* move after processed text content */
-
-                if (elem->child) {
-                    /* we have a mixed content */
-                    if (options & LYXML_PARSE_NOMIXEDCONTENT) {
-                        LOGVAL(LYE_XML_INVAL, LY_VLOG_XML, elem, "XML element with mixed content");
-                        goto error;
-                    }
-                    child = calloc(1, sizeof *child);
-                    if (!child) {
-                        LOGMEM;
-                        goto error;
-                    }
-                    child->content = elem->content;
-                    elem->content = NULL;
-                    lyxml_add_child(ctx, elem, child);
-                    elem->flags |= LYXML_ELEM_MIXED;
-                }
-            }
+    while (1) {
+        ly_err_clean(1);
+        ign_xmlws(c);
+        if (!strncmp("/>", c, 2)) {
+            /* we are done, it was EmptyElemTag */
+            c += 2;
+            elem->content = lydict_insert(ctx, "", 0);
+            *closed = 1;
+            break;
+        } else if (*c == '>') {
+            /* the element content follows */
+            c++;
+            break;
         }
-    } else {
+
         /* process attribute */
         attr = parse_attr(ctx, c, &size, elem);
         if (!attr) {
@@ -1110,22 +949,13 @@ store_content:
                 elem->ns = (struct lyxml_ns *)attr;
             }
         }
-
-        /* go back to finish element processing */
-        goto process;
-    }
-
-    *len = c - data;
-
-    if (!closed_flag) {
-        LOGVAL(LYE_XML_MISS, LY_VLOG_XML, elem, "closing element tag", elem->name);
-        goto error;
     }
 
     if (!elem->ns && !nons_flag && parent) {
         elem->ns = lyxml_get_ns(parent, prefix_len ? prefix : NULL);
     }
 
+    *len = c - data;
     return elem;
 
 error:
@@ -1134,49 +964,307 @@ error:
     return NULL;
 }
 
+/* logs directly, data points after "</" */
+static int
+parse_elem_end(struct lyxml_elem *elem, const char *data, unsigned int *len)
+{
+    const char *c = data, *e;
+    int uc;
+    unsigned int size;
+
+    /* get name and check it */
+    e = c;
+    uc = lyxml_getutf8(e, &size);
+    if (!is_xmlnamestartchar(uc)) {
+        LOGVAL(LYE_XML_INVAL, LY_VLOG_XML, elem, "NameStartChar of the element");
+        return EXIT_FAILURE;
+    }
+    e += size;
+    uc = lyxml_getutf8(e, &size);
+    while (is_xmlnamechar(uc)) {
+        if (*e == ':') {
+            /* element in a namespace, the prefix must be the same as in the opening tag */
+            if (elem->ns && (!elem->ns->prefix || strncmp(elem->ns->prefix, c, e - c) || elem->ns->prefix[e - c])) {
+                LOGVAL(LYE_SPEC, LY_VLOG_XML, elem,
+                       "Invalid (different namespaces) opening (%s) and closing element tags.", elem->name);
+                return EXIT_FAILURE;
+            }
+            c = e + 1;
+        }
+        e += size;
+        uc = lyxml_getutf8(e, &size);
+    }
+    if (!*e) {
+        LOGVAL(LYE_EOF, LY_VLOG_NONE, NULL);
+        return EXIT_FAILURE;
+    }
+
+    /* check that it corresponds to opening tag */
+    if (strncmp(elem->name, c, e - c) || elem->name[e - c]) {
+        LOGVAL(LYE_SPEC, LY_VLOG_XML, elem, "Invalid (mixed names) opening (%s) and closing (%.*s) element tags.",
+               elem->name, (int)(e - c), c);
+        return EXIT_FAILURE;
+    }
+    c = e;
+
+    ign_xmlws(c);
+    if (*c != '>') {
+        LOGVAL(LYE_SPEC, LY_VLOG_XML, elem, "Data after closing element tag \"%s\".", elem->name);
+        return EXIT_FAILURE;
+    }
+    c++;
+
+    *len = c - data;
+    return EXIT_SUCCESS;
+}
+
 /* logs directly */
-API struct lyxml_elem *
-lyxml_parse_mem(struct ly_ctx *ctx, const char *data, int options)
+int
+lyxml_parse_elem_content(struct ly_ctx *ctx, const char *data, unsigned int *len, struct lyxml_elem *elem, int options)
 {
     const char *c = data;
-    unsigned int len;
-    struct lyxml_elem *root, *first = NULL, *next;
+    const char *lws;    /* leading white space for handling mixed content */
+    struct lyxml_elem *child;
+    unsigned int size;
 
-    ly_err_clean(1);
+    *len = 0;
+    lws = NULL;
 
-    if (!ctx) {
-        LOGERR(LY_EINVAL, "%s: Invalid parameter.", __func__);
+    while (*c) {
+        if (!strncmp(c, "</", 2)) {
+            if (lws && !elem->child) {
+                /* leading white spaces were actually content */
+                goto store_content;
+            }
+
+            /* Etag */
+            c += 2;
+            if (parse_elem_end(elem, c, &size)) {
+                return EXIT_FAILURE;
+            }
+            c += size;
+
+            if (!(elem->flags & LYXML_ELEM_MIXED) && !elem->content) {
+                /* there was no content, but we don't want NULL (only if mixed content) */
+                elem->content = lydict_insert(ctx, "", 0);
+            }
+            *len = c - data;
+            return EXIT_SUCCESS;
+
+        } else if (!strncmp(c, "<?", 2)) {
+            if (lws) {
+                /* leading white spaces were only formatting */
+                lws = NULL;
+            }
+            /* PI - ignore it */
+            c += 2;
+            if (parse_ignore(c, "?>", &size)) {
+                return EXIT_FAILURE;
+            }
+            c += size;
+        } else if (!strncmp(c, "<!--", 4)) {
+            if (lws) {
+                /* leading white spaces were only formatting */
+                lws = NULL;
+            }
+            /* Comment - ignore it */
+            c += 4;
+            if (parse_ignore(c, "-->", &size)) {
+                return EXIT_FAILURE;
+            }
+            c += size;
+        } else if (!strncmp(c, "<![CDATA[", 9)) {
+            /* CDSect */
+            goto store_content;
+        } else if (*c == '<') {
+            if (lws) {
+                if (elem->flags & LYXML_ELEM_MIXED) {
+                    /* we have a mixed content */
+                    goto store_content;
+                } else {
+                    /* leading white spaces were only formatting */
+                    lws = NULL;
+                }
+            }
+            if (elem->content) {
+                /* we have a mixed content */
+                if (options & LYXML_PARSE_NOMIXEDCONTENT) {
+                    LOGVAL(LYE_XML_INVAL, LY_VLOG_XML, elem, "XML element with mixed content");
+                    return EXIT_FAILURE;
+                }
+                child = calloc(1, sizeof *child);
+                if (!child) {
+                    LOGMEM;
+                    return EXIT_FAILURE;
+                }
+                child->content = elem->content;
+                elem->content = NULL;
+                lyxml_add_child(ctx, elem, child);
+                elem->flags |= LYXML_ELEM_MIXED;
+            }
+            child = lyxml_parse_elem(ctx, c, &size, elem, options);
+            if (!child) {
+                return EXIT_FAILURE;
+            }
+            c += size;      /* move after processed child element */
+        } else if (is_xmlws(*c)) {
+            lws = c;
+            ign_xmlws(c);
+        } else {
+store_content:
+            /* store text content */
+            if (lws) {
+                /* process content including the leading white spaces */
+                c = lws;
+                lws = NULL;
+            }
+            elem->content = lydict_insert_zc(ctx, parse_text(c, '<', &size));
+            if (ly_errno) {
+                return EXIT_FAILURE;
+            }
+            c += size;      /* move after processed text content */
+
+            if (elem->child) {
+                /* we have a mixed content */
+                if (options & LYXML_PARSE_NOMIXEDCONTENT) {
+                    LOGVAL(LYE_XML_INVAL, LY_VLOG_XML, elem, "XML element with mixed content");
+                    return EXIT_FAILURE;
+                }
+                child = calloc(1, sizeof *child);
+                if (!child) {
+                    LOGMEM;
+                    return EXIT_FAILURE;
+                }
+                child->content = elem->content;
+                elem->content = NULL;
+                lyxml_add_child(ctx, elem, child);
+                elem->flags |= LYXML_ELEM_MIXED;
+            }
+        }
+    }
+
+    LOGVAL(LYE_XML_MISS, LY_VLOG_XML, elem, "closing element tag", elem->name);
+    return EXIT_FAILURE;
+}
+
+/* logs directly */
+int
+lyxml_parse_elem_next(const char *data, unsigned int *len, struct lyxml_elem *elem)
+{
+    const char *c = data;
+    char *str;
+    unsigned int size;
+
+    *len = 0;
+
+    while (1) {
+        ign_xmlws(c);
+        if (!*c) {
+            LOGVAL(LYE_XML_MISS, LY_VLOG_XML, elem, "closing element tag", elem->name);
+            return -1;
+        } else if (!strncmp(c, "</", 2)) {
+            /* Etag */
+            c += 2;
+            if (parse_elem_end(elem, c, &size)) {
+                return -1;
+            }
+            *len = (c + size) - data;
+            return 0;
+        } else if (!strncmp(c, "<?", 2)) {
+            /* PI - ignore it */
+            c += 2;
+            if (parse_ignore(c, "?>", &size)) {
+                return -1;
+            }
+            c += size;
+        } else if (!strncmp(c, "<!--", 4)) {
+            /* Comment - ignore it */
+            c += 4;
+            if (parse_ignore(c, "-->", &size)) {
+                return -1;
+            }
+            c += size;
+        } else if ((*c == '<') && strncmp(c, "<![CDATA[", 9)) {
+            /* child element */
+            *len = c - data;
+            return 1;
+        } else {
+            /* text content (or CDSect), it is not stored */
+            str = parse_text(c, '<', &size);
+            if (!str) {
+                return -1;
+            }
+            free(str);
+            *len = (c + size) - data;
+            return 2;
+        }
+    }
+}
+
+/* logs directly */
+struct lyxml_elem *
+lyxml_parse_elem(struct ly_ctx *ctx, const char *data, unsigned int *len, struct lyxml_elem *parent, int options)
+{
+    const char *c = data;
+    struct lyxml_elem *elem;
+    unsigned int size;
+    int closed;
+
+    elem = lyxml_parse_elem_start(ctx, c, &size, parent, &closed);
+    if (!elem) {
+        *len = size;
         return NULL;
     }
+    c += size;
+
+    if (!closed) {
+        if (lyxml_parse_elem_content(ctx, c, &size, elem, options)) {
+            lyxml_free(ctx, elem);
+            *len = 0;
+            return NULL;
+        }
+        c += size;
+    }
+
+    *len = c - data;
+    return elem;
+}
+
+/* logs directly */
+int
+lyxml_parse_misc(const char *data, unsigned int *len)
+{
+    const char *c = data;
+    unsigned int size;
+
+    *len = 0;
 
-repeat:
-    /* process document */
     while (1) {
         if (!*c) {
             /* eof */
-            return first;
+            break;
         } else if (is_xmlws(*c)) {
             /* skip whitespaces */
             ign_xmlws(c);
         } else if (!strncmp(c, "<?", 2)) {
             /* XMLDecl or PI - ignore it */
             c += 2;
-            if (parse_ignore(c, "?>", &len)) {
-                return NULL;
+            if (parse_ignore(c, "?>", &size)) {
+                return EXIT_FAILURE;
             }
-            c += len;
+            c += size;
         } else if (!strncmp(c, "<!--", 4)) {
             /* Comment - ignore it */
             c += 2;
-            if (parse_ignore(c, "-->", &len)) {
-                return NULL;
+            if (parse_ignore(c, "-->", &size)) {
+                return EXIT_FAILURE;
             }
-            c += len;
+            c += size;
         } else if (!strncmp(c, "<!", 2)) {
             /* DOCTYPE */
             /* TODO - standalone ignore counting < and > */
             LOGERR(LY_EINVAL, "DOCTYPE not supported in XML documents.");
-            return NULL;
+            return EXIT_FAILURE;
         } else if (*c == '<') {
             /* element - process it in next loop to strictly follow XML
              * format
@@ -1184,10 +1272,45 @@ repeat:
             break;
         } else {
             LOGVAL(LYE_XML_INCHAR, LY_VLOG_NONE, NULL, c);
-            return NULL;
+            return EXIT_FAILURE;
         }
     }
 
+    *len = c - data;
+    return EXIT_SUCCESS;
+}
+
+/* logs directly */
+API struct lyxml_elem *
+lyxml_parse_mem(struct ly_ctx *ctx, const char *data, int options)
+{
+    const char *c = data;
+    unsigned int len;
+    struct lyxml_elem *root, *first = NULL, *next;
+
+    ly_err_clean(1);
+
+    if (!ctx) {
+        LOGERR(LY_EINVAL, "%s: Invalid parameter.", __func__);
+        return NULL;
+    }
+
+repeat:
+    /* process document */
+    if (lyxml_parse_misc(c, &len)) {
+        if (first) {
+            LY_TREE_FOR_SAFE(first, next, root) {
+                lyxml_free(ctx, root);
+            }
+        }
+        return NULL;
+    }
+    c += len;
+    if (!*c) {
+        /* eof */
+        return first;
+    }
+
     root = lyxml_parse_elem(ctx, c, &len, NULL, options);
     if (!root) {
         if (first) {
@@ -1265,6 +1388,7 @@ int
 lyxml_dump_text(struct lyout *out, const char *text)
 {
     unsigned int i, n;
+    size_t len;
 
     if (!text) {
         return 0;
@@ -1273,21 +1397,24 @@ lyxml_dump_text(struct lyout *out, const char *text)
     for (i = n = 0; text[i]; i++) {
         switch (text[i]) {
         case '&':
-            n += ly_print(out, "&amp;");
+            n += ly_write(out, "&amp;", 5);
             break;
         case '<':
-            n += ly_print(out, "&lt;");
+            n += ly_write(out, "&lt;", 4);
             break;
         case '>':
             /* not needed, just for readability */
-            n += ly_print(out, "&gt;");
+            n += ly_write(out, "&gt;", 4);
             break;
         case '"':
-            n += ly_print(out, "&quot;");
+            n += ly_write(out, "&quot;", 6);
             break;
         default:
-            ly_write(out, &text[i], 1);
-            n++;
+            /* print all the characters not to be escaped at once */
+            len = strcspn(&text[i], "&<>\"");
+            ly_write(out, &text[i], len);
+            n += len;
+            i += len - 1;
         }
     }
 
@@ -1428,38 +1555,54 @@ API int
 lyxml_print_file(FILE *stream, const struct lyxml_elem *elem, int options)
 {
     struct lyout out;
+    int r;
 
     if (!stream || !elem) {
         return 0;
     }
 
+    memset(&out, 0, sizeof out);
     out.type = LYOUT_STREAM;
     out.method.f = stream;
 
     if (options & LYXML_PRINT_SIBLINGS) {
-        return dump_siblings(&out, elem, options);
+        r = dump_siblings(&out, elem, options);
     } else {
-        return dump_elem(&out, elem, 0, options, 1);
+        r = dump_elem(&out, elem, 0, options, 1);
     }
+
+    if (ly_print_clean(&out)) {
+        LOGERR(LY_ESYS, "Writing the printed XML failed.");
+        r = 0;
+    }
+    return r;
 }
 
 API int
 lyxml_print_fd(int fd, const struct lyxml_elem *elem, int options)
 {
     struct lyout out;
+    int r;
 
     if (fd < 0 || !elem) {
         return 0;
     }
 
+    memset(&out, 0, sizeof out);
     out.type = LYOUT_FD;
     out.method.fd = fd;
 
     if (options & LYXML_PRINT_SIBLINGS) {
-        return dump_siblings(&out, elem, options);
+        r = dump_siblings(&out, elem, options);
     } else {
-        return dump_elem(&out, elem, 0, options, 1);
+        r = dump_elem(&out, elem, 0, options, 1);
     }
+
+    if (ly_print_clean(&out)) {
+        LOGERR(LY_ESYS, "Writing the printed XML failed.");
+        r = 0;
+    }
+    return r;
 }
 
 API int
@@ -1472,10 +1615,8 @@ lyxml_print_mem(char **strp, const struct lyxml_elem *elem, int options)
         return 0;
     }
 
+    memset(&out, 0, sizeof out);
     out.type = LYOUT_MEMORY;
-    out.method.mem.buf = NULL;
-    out.method.mem.len = 0;
-    out.method.mem.size = 0;
 
     if (options & LYXML_PRINT_SIBLINGS) {
         r = dump_siblings(&out, elem, options);
@@ -1483,7 +1624,7 @@ lyxml_print_mem(char **strp, const struct lyxml_elem *elem, int options)
         r = dump_elem(&out, elem, 0, options, 1);
     }
 
-    *strp = out.method.mem.buf;
+    *strp = out.buf;
     return r;
 }
 
@@ -1491,18 +1632,26 @@ API int
 lyxml_print_clb(ssize_t (*writeclb)(void *arg, const void *buf, size_t count), void *arg, const struct lyxml_elem *elem, int options)
 {
     struct lyout out;
+    int r;
 
     if (!writeclb || !elem) {
         return 0;
     }
 
+    memset(&out, 0, sizeof out);
     out.type = LYOUT_CALLBACK;
     out.method.clb.f = writeclb;
     out.method.clb.arg = arg;
 
     if (options & LYXML_PRINT_SIBLINGS) {
-        return dump_siblings(&out, elem, options);
+        r = dump_siblings(&out, elem, options);
     } else {
-        return dump_elem(&out, elem, 0, options, 1);
+        r = dump_elem(&out, elem, 0, options, 1);
+    }
+
+    if (ly_print_clean(&out)) {
+        LOGERR(LY_ESYS, "Writing the printed XML failed.");
+        r = 0;
     }
+    return r;
 }
@@ -201,7 +201,7 @@ struct lyxml_elem *lyxml_parse_path(struct ly_ctx *ctx, const char *filename, in
  * @param[in] stream IO stream to print out the tree.
  * @param[in] elem Root element of the XML tree to print
  * @param[in] options Dump options, see @ref xmldumpoptions.
- * @return number of printed characters.
+ * @return number of printed characters, 0 if writing the output failed.
  */
 int lyxml_print_file(FILE * stream, const struct lyxml_elem *elem, int options);
 
@@ -213,7 +213,7 @@ int lyxml_print_file(FILE * stream, const struct lyxml_elem *elem, int options);
  * @param[in] fd File descriptor to print out the tree.
  * @param[in] elem Root element of the XML tree to print
  * @param[in] options Dump options, see @ref xmldumpoptions.
- * @return number of printed characters.
+ * @return number of printed characters, 0 if writing the output failed.
  */
 int lyxml_print_fd(int fd, const struct lyxml_elem *elem, int options);
 
@@ -239,7 +239,7 @@ int lyxml_print_mem(char **strp, const struct lyxml_elem *elem, int options);
  * @param[in] arg Optional caller-specific argument to be passed to the \p writeclb callback.
  * @param[in] elem Root element of the XML tree to print
  * @param[in] options Dump options, see @ref xmldumpoptions.
- * @return number of printed characters.
+ * @return number of printed characters, 0 if writing the output failed.
  */
 int lyxml_print_clb(ssize_t (*writeclb)(void *arg, const void *buf, size_t count), void *arg, const struct lyxml_elem *elem, int options);
 
@@ -126,6 +126,71 @@ void lyxml_unlink_elem(struct ly_ctx *ctx, struct lyxml_elem *elem, int copy_ns)
  */
 int lyxml_getutf8(const char *buf, unsigned int *read);
 
+/**
+ * @brief Parse an XML element including all its content.
+ *
+ * @param[in] ctx libyang context to use.
+ * @param[in] data Pointer to the beginning of the element ('<').
+ * @param[out] len Number of processed characters of \p data.
+ * @param[in] parent Parent element to add the parsed element to, NULL for a root.
+ * @param[in] options Parser options, see @ref xmlreadoptions.
+ * @return Parsed element, NULL on error.
+ */
+struct lyxml_elem *lyxml_parse_elem(struct ly_ctx *ctx, const char *data, unsigned int *len, struct lyxml_elem *parent,
+                                    int options);
+
+/**
+ * @brief Parse only the start tag of an XML element (its name, namespace, and attributes) so that its content
+ * can be processed separately, either by lyxml_parse_elem_content() or sequentially with lyxml_parse_elem_next().
+ *
+ * @param[in] ctx libyang context to use.
+ * @param[in] data Pointer to the beginning of the element ('<').
+ * @param[out] len Number of processed characters of \p data.
+ * @param[in] parent Parent element to add the parsed element to, NULL for a root. Only the ancestors are needed
+ * to resolve the namespaces, the parent does not have to hold its previous children.
+ * @param[out] closed Set if the element was an empty-element tag and so it has no content.
+ * @return Parsed element, NULL on error.
+ */
+struct lyxml_elem *lyxml_parse_elem_start(struct ly_ctx *ctx, const char *data, unsigned int *len,
+                                          struct lyxml_elem *parent, int *closed);
+
+/**
+ * @brief Parse the content of an XML element including its end tag, the start tag
+ * was parsed by lyxml_parse_elem_start().
+ *
+ * @param[in] ctx libyang context to use.
+ * @param[in] data Pointer to the content of \p elem.
+ * @param[out] len Number of processed characters of \p data.
+ * @param[in] elem Element to store the content into.
+ * @param[in] options Parser options, see @ref xmlreadoptions.
+ * @return EXIT_SUCCESS on success, EXIT_FAILURE on error.
+ */
+int lyxml_parse_elem_content(struct ly_ctx *ctx, const char *data, unsigned int *len, struct lyxml_elem *elem,
+                             int options);
+
+/**
+ * @brief Move to the next child element in the content of an XML element without storing anything. Whitespaces,
+ * comments, and processing instructions are skipped, text content is parsed, but dropped.
+ *
+ * @param[in] data Pointer into the content of \p elem.
+ * @param[out] len Number of processed characters of \p data.
+ * @param[in] elem Element whose content is being parsed.
+ * @return 1 if a child element starts at \p data + \p len, 2 if text content was skipped, 0 if the end tag
+ * of \p elem was parsed, -1 on error.
+ */
+int lyxml_parse_elem_next(const char *data, unsigned int *len, struct lyxml_elem *elem);
+
+/**
+ * @brief Skip everything that can appear in an XML document outside the elements (whitespaces, XML declaration,
+ * comments, and processing instructions).
+ *
+ * @param[in] data XML data to skip in.
+ * @param[out] len Number of skipped characters, \p data + \p len is either the beginning of an element or
+ * the end of \p data.
+ * @return EXIT_SUCCESS on success, EXIT_FAILURE on error.
+ */
+int lyxml_parse_misc(const char *data, unsigned int *len);
+
 /**
  * @brief Dump XML text. Converts special characters to their equivalent
  * starting with '&'.
@@ -779,31 +779,125 @@ set_remove_node(struct lyxp_set *set, uint32_t idx)
 }
 
 /**
- * @brief Check for duplicates in a node set.
+ * @brief Hash table callback for matching the nodes of a node set.
+ */
+static int
+set_dup_node_equal(void *val_searched, void *val_stored, void *UNUSED(cb_data))
+{
+    struct lyxp_set_nodes *item1 = val_searched, *item2 = val_stored;
+
+    return (item1->node == item2->node) && (item1->type == item2->type);
+}
+
+static uint32_t
+set_dup_node_hash(const void *node, enum lyxp_node_type node_type)
+{
+    uint32_t hash;
+
+    hash = dict_hash_multi(0, (const char *)&node, sizeof node);
+    hash = dict_hash_multi(hash, (const char *)&node_type, sizeof node_type);
+    return dict_hash_multi(hash, NULL, 0);
+}
+
+/**
+ * @brief Add a node of a node set into an index for checking duplicates. The node
+ *        must not be moved in the set memory while the index is used.
+ *
+ * @param[in] ht Index of the nodes, NULL if not used.
+ * @param[in] item Set node to add.
+ *
+ * @return EXIT_SUCCESS on success, -1 on error.
+ */
+static int
+set_dup_node_add(struct hash_table *ht, struct lyxp_set_nodes *item)
+{
+    if (ht && lyht_insert(ht, item, set_dup_node_hash(item->node, item->type))) {
+        LOGMEM;
+        return -1;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Check for a duplicate in an index of (some) set nodes.
  *
- * @param[in] set Set to check.
- * @param[in] node Node to look for in \p set.
+ * @param[in] ht Index of the nodes, NULL if not used.
+ * @param[in] node Node to look for.
  * @param[in] node_type Type of \p node.
- * @param[in] skip_idx Index from \p set to skip.
  *
- * @return Position of the duplicate or -1 if there is none.
+ * @return 1 if \p node is in the index, 0 otherwise.
+ */
+static int
+set_dup_node_check(struct hash_table *ht, const void *node, enum lyxp_node_type node_type)
+{
+    struct lyxp_set_nodes item, *match;
+
+    if (!ht) {
+        return 0;
+    }
+
+    item.node = (struct lyd_node *)node;
+    item.type = node_type;
+    return !lyht_find(ht, &item, set_dup_node_hash(node, node_type), (void **)&match);
+}
+
+/**
+ * @brief Create an index of all the nodes in a node set for checking duplicates in constant time.
+ *
+ * @param[in] set Set to index, its nodes must not be moved while the index is used.
+ * @param[out] ht Index of the nodes, NULL if \p set has a single node.
+ *
+ * @return EXIT_SUCCESS on success, -1 on error.
  */
 static int
-set_dup_node_check(struct lyxp_set *set, void *node, enum lyxp_node_type node_type, int skip_idx)
+set_dup_node_index(struct lyxp_set *set, struct hash_table **ht)
 {
     uint32_t i;
 
-    for (i = 0; i < set->used; ++i) {
-        if ((skip_idx > -1) && (i == (unsigned)skip_idx)) {
-            continue;
-        }
+    *ht = NULL;
+    if (set->used < 2) {
+        return EXIT_SUCCESS;
+    }
 
-        if ((set->val.nodes[i].node == node) && (set->val.nodes[i].type == node_type)) {
-            return i;
+    *ht = lyht_new(set_dup_node_equal, NULL);
+    if (!*ht) {
+        LOGMEM;
+        return -1;
+    }
+    for (i = 0; i < set->used; ++i) {
+        if (set_dup_node_add(*ht, &set->val.nodes[i])) {
+            lyht_free(*ht);
+            *ht = NULL;
+            return -1;
         }
     }
 
-    return -1;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Replace the nodes of a node set with the nodes of another set. Empty \p nodes
+ *        change \p set into LYXP_SET_EMPTY. Context position aware.
+ *
+ * @param[in] set Set to use.
+ * @param[in] nodes Set with the new nodes, it is spent.
+ */
+static void
+set_replace_nodes(struct lyxp_set *set, struct lyxp_set *nodes)
+{
+    assert((set->type == LYXP_SET_NODE_SET) && ((nodes->type == LYXP_SET_NODE_SET) || (nodes->type == LYXP_SET_EMPTY)));
+
+    free(set->val.nodes);
+    if (nodes->type == LYXP_SET_EMPTY) {
+        /* this changes it to LYXP_SET_EMPTY */
+        memset(set, 0, sizeof *set);
+    } else {
+        set->val.nodes = nodes->val.nodes;
+        set->used = nodes->used;
+        set->size = nodes->size;
+    }
+    memset(nodes, 0, sizeof *nodes);
 }
 
 static int
@@ -905,13 +999,13 @@ set_insert_node(struct lyxp_set *set, const void *node, uint32_t pos, enum lyxp_
         /* not an empty set */
         if (set->used == set->size) {
 
-            /* set is full */
-            set->val.nodes = ly_realloc(set->val.nodes, (set->size + LYXP_SET_SIZE_STEP) * sizeof *set->val.nodes);
+            /* set is full, grow it proportionally, large sets are created node by node */
+            set->val.nodes = ly_realloc(set->val.nodes, (set->size * 2 + LYXP_SET_SIZE_STEP) * sizeof *set->val.nodes);
             if (!set->val.nodes) {
                 LOGMEM;
                 return;
             }
-            set->size += LYXP_SET_SIZE_STEP;
+            set->size = set->size * 2 + LYXP_SET_SIZE_STEP;
         }
 
         if (idx > set->used) {
@@ -987,159 +1081,155 @@ retry:
 }
 
 /**
- * @brief Get unique \p node position in the data.
+ * @brief Get the data node of a node set item whose position the item has.
  *
- * @param[in] node Node to find.
- * @param[in] node_type Node type of \p node.
- * @param[in] root Root node.
- * @param[in] root_type Type of the XPath \p root node.
- * @param[in] prev Node that we think is before \p node in DFS from \p root. Can optionally
- * be used to increase efficiency and start the DFS from this node.
- * @param[in] prev_pos Node \p prev position. Optional, but must be set if \p prev is set.
+ * @param[in] item Set item.
+ * @param[in] root Context root node.
+ * @param[out] node Data node, NULL for the root items with the position 0.
  *
- * @return Node position.
+ * @return EXIT_SUCCESS on success, -1 on error.
  */
-static uint32_t
-get_node_pos(const struct lyd_node *node, enum lyxp_node_type node_type, const struct lyd_node *root,
-             enum lyxp_node_type root_type, const struct lyd_node **prev, uint32_t *prev_pos)
+static int
+set_pos_node(struct lyxp_set_nodes *item, const struct lyd_node *root, const struct lyd_node **node)
 {
-    const struct lyd_node *next, *elem, *top_sibling;
-    uint32_t pos = 1;
-
-    assert(prev && prev_pos && !root->prev->next);
-
-    if ((node_type == LYXP_NODE_ROOT) || (node_type == LYXP_NODE_ROOT_CONFIG)) {
-        return 0;
-    }
-
-    if (*prev) {
-        /* start from the previous element instead from the root */
-        elem = next = *prev;
-        pos = *prev_pos;
-        for (top_sibling = elem; top_sibling->parent; top_sibling = top_sibling->parent);
-        goto dfs_search;
-    }
-
-    LY_TREE_FOR(root, top_sibling) {
-        /* TREE DFS */
-        LY_TREE_DFS_BEGIN(top_sibling, next, elem) {
-dfs_search:
-            if ((root_type == LYXP_NODE_ROOT_CONFIG) && (elem->schema->flags & LYS_CONFIG_R)) {
-                goto skip_children;
-            }
-
-            if (elem == node) {
-                break;
-            }
-            ++pos;
-
-            /* TREE DFS END */
-            /* select element for the next run - children first */
-            next = elem->child;
-            /* child exception for lyd_node_leaf and lyd_node_leaflist, but not the root */
-            if (elem->schema->nodetype & (LYS_LEAF | LYS_LEAFLIST | LYS_ANYDATA)) {
-                next = NULL;
-            }
-            if (!next) {
-skip_children:
-                /* no children */
-                if (elem == top_sibling) {
-                    /* we are done, root has no children */
-                    elem = NULL;
-                    break;
-                }
-                /* try siblings */
-                next = elem->next;
-            }
-            while (!next) {
-                /* no siblings, go back through parents */
-                if (elem->parent == top_sibling->parent) {
-                    /* we are done, no next element to process */
-                    elem = NULL;
-                    break;
-                }
-                /* parent is already processed, go to its sibling */
-                elem = elem->parent;
-                next = elem->next;
-            }
-        }
-
-        /* node found */
-        if (elem) {
-            break;
+    switch (item->type) {
+    case LYXP_NODE_ATTR:
+        *node = lyd_attr_parent(root, (struct lyd_attr *)item->node);
+        if (!*node) {
+            LOGINT;
+            return -1;
         }
+        break;
+    case LYXP_NODE_ELEM:
+    case LYXP_NODE_TEXT:
+        *node = item->node;
+        break;
+    default:
+        /* all roots have position 0 */
+        *node = NULL;
+        break;
     }
 
-    if (!elem) {
-        if (!(*prev)) {
-            /* we went from root and failed to find it, cannot be */
-            LOGINT;
-            return 0;
-        } else {
-            /* node is before prev, we assumed otherwise :( */
-            //LOGDBG(LY_LDGXPATH, "get_node_pos optimalization fail.");
-
-            *prev = NULL;
-            *prev_pos = 0;
+    return EXIT_SUCCESS;
+}
 
-            elem = next = top_sibling = root;
-            pos = 1;
-            goto dfs_search;
-        }
-    }
+/**
+ * @brief Get the lowest common ancestor (or self) of 2 data nodes.
+ *
+ * @return Common ancestor, NULL if the nodes are in different top-level subtrees.
+ */
+static const struct lyd_node *
+get_common_ancestor(const struct lyd_node *node1, const struct lyd_node *node2)
+{
+    const struct lyd_node *iter;
+    int depth1 = 0, depth2 = 0;
 
-    /*if (*prev) {
-        LOGDBG(LY_LDGXPATH, "get_node_pos optimalization success.");
-    }*/
+    for (iter = node1; iter->parent; iter = iter->parent, ++depth1);
+    for (iter = node2; iter->parent; iter = iter->parent, ++depth2);
 
-    /* remember the last found node for next time */
-    *prev = node;
-    *prev_pos = pos;
+    for (; depth1 > depth2; node1 = node1->parent, --depth1);
+    for (; depth2 > depth1; node2 = node2->parent, --depth2);
+    while (node1 != node2) {
+        node1 = node1->parent;
+        node2 = node2->parent;
+    }
 
-    return pos;
+    return node1;
 }
 
 /**
- * @brief Assign (fill) missing node positions.
+ * @brief Assign (fill) the positions of all the nodes in one or two sets. The positions
+ *        are relative to each other, only in the subtree of the nodes' common ancestor,
+ *        so they are always assigned again to all the nodes.
  *
  * @param[in] set Set to fill positions in.
+ * @param[in] set2 Optional second set to fill positions in, comparable with \p set.
  * @param[in] root Context root node.
- * @param[in] root_type Context root type.
  *
  * @return 0 on success, -1 on error.
  */
 static int
-set_assign_pos(struct lyxp_set *set, const struct lyd_node *root, enum lyxp_node_type root_type)
+set_assign_pos(struct lyxp_set *set, struct lyxp_set *set2, const struct lyd_node *root)
 {
-    const struct lyd_node *prev = NULL, *tmp_node;
-    uint32_t i, tmp_pos = 0;
+    struct lyxp_set *sets[2] = {set, set2};
+    struct lyxp_set_nodes *item, item_aux, *match, *pos_items = NULL;
+    const struct lyd_node **nodes = NULL, *ancestor = NULL, *top, *next, *elem;
+    struct hash_table *ht = NULL;
+    uint32_t i, j, k, count, distinct = 0, found = 0, pos = 0;
+    int ret = -1;
+
+    count = set->used + (set2 ? set2->used : 0);
+    nodes = malloc(count * sizeof *nodes);
+    pos_items = malloc(count * sizeof *pos_items);
+    ht = lyht_new(set_dup_node_equal, NULL);
+    if (!nodes || !pos_items || !ht) {
+        LOGMEM;
+        goto cleanup;
+    }
 
-    for (i = 0; i < set->used; ++i) {
-        if (!set->val.nodes[i].pos) {
-            tmp_node = NULL;
-            switch (set->val.nodes[i].type) {
-            case LYXP_NODE_ATTR:
-                tmp_node = lyd_attr_parent(root, set->val.attrs[i].attr);
-                if (!tmp_node) {
-                    LOGINT;
-                    return -1;
-                }
-                /* fallthrough */
-            case LYXP_NODE_ELEM:
-            case LYXP_NODE_TEXT:
-                if (!tmp_node) {
-                    tmp_node = set->val.nodes[i].node;
+    /* get the distinct data nodes and their common ancestor */
+    for (i = 0, k = 0; i < 2; ++i) {
+        for (j = 0; sets[i] && (j < sets[i]->used); ++j, ++k) {
+            if (set_pos_node(&sets[i]->val.nodes[j], root, &nodes[k])) {
+                goto cleanup;
+            }
+            if (!nodes[k] || set_dup_node_check(ht, nodes[k], LYXP_NODE_ELEM)) {
+                continue;
+            }
+
+            item = &pos_items[distinct];
+            item->node = (struct lyd_node *)nodes[k];
+            item->type = LYXP_NODE_ELEM;
+            item->pos = 0;
+            if (set_dup_node_add(ht, item)) {
+                goto cleanup;
+            }
+            ancestor = distinct ? (ancestor ? get_common_ancestor(ancestor, nodes[k]) : NULL) : nodes[k];
+            ++distinct;
+        }
+    }
+
+    /* number the nodes in the document order, only as far as needed */
+    for (top = ancestor ? ancestor : root; top && (found < distinct); top = ancestor ? NULL : top->next) {
+        LY_TREE_DFS_BEGIN(top, next, elem) {
+            ++pos;
+            item_aux.node = (struct lyd_node *)elem;
+            item_aux.type = LYXP_NODE_ELEM;
+            if (!lyht_find(ht, &item_aux, set_dup_node_hash(elem, LYXP_NODE_ELEM), (void **)&match)) {
+                match->pos = pos;
+                if (++found == distinct) {
+                    break;
                 }
-                set->val.nodes[i].pos = get_node_pos(tmp_node, set->val.nodes[i].type, root, root_type, &prev, &tmp_pos);
-                break;
-            default:
-                /* all roots have position 0 */
-                break;
             }
+            LY_TREE_DFS_END(top, next, elem);
         }
     }
+    if (found < distinct) {
+        /* the node was not found in the data tree, cannot be */
+        LOGINT;
+        goto cleanup;
+    }
 
-    return 0;
+    /* fill the positions */
+    for (i = 0, k = 0; i < 2; ++i) {
+        for (j = 0; sets[i] && (j < sets[i]->used); ++j, ++k) {
+            if (!nodes[k]) {
+                sets[i]->val.nodes[j].pos = 0;
+                continue;
+            }
+            item_aux.node = (struct lyd_node *)nodes[k];
+            item_aux.type = LYXP_NODE_ELEM;
+            lyht_find(ht, &item_aux, set_dup_node_hash(nodes[k], LYXP_NODE_ELEM), (void **)&match);
+            sets[i]->val.nodes[j].pos = match->pos;
+        }
+    }
+    ret = 0;
+
+cleanup:
+    lyht_free(ht);
+    free(nodes);
+    free(pos_items);
+    return ret;
 }
 
 /**
@@ -1280,7 +1370,7 @@ set_sort(struct lyxp_set *set, const struct lyd_node *cur_node, int options)
     root = moveto_get_root(cur_node, options, &root_type);
 
     /* fill positions */
-    if (set_assign_pos(set, root, root_type)) {
+    if (set_assign_pos(set, NULL, root)) {
         return -1;
     }
 
@@ -1369,8 +1459,9 @@ set_sorted_dup_node_clean(struct lyxp_set *set)
 static int
 set_sorted_merge(struct lyxp_set *trg, struct lyxp_set *src, struct lyd_node *cur_node, int options)
 {
-    uint32_t i, j, count, dup_count;
+    uint32_t i, j, count;
     int cmp;
+    struct lyxp_set_nodes *nodes;
     const struct lyd_node *root;
     enum lyxp_node_type root_type;
 
@@ -1391,7 +1482,7 @@ set_sorted_merge(struct lyxp_set *trg, struct lyxp_set *src, struct lyd_node *cu
     root = moveto_get_root(cur_node, options, &root_type);
 
     /* fill positions */
-    if (set_assign_pos(trg, root, root_type) || set_assign_pos(src, root, root_type)) {
+    if (set_assign_pos(trg, src, root)) {
         return -1;
     }
 
@@ -1404,65 +1495,37 @@ set_sorted_merge(struct lyxp_set *trg, struct lyxp_set *src, struct lyd_node *cu
 
     /* make memory for the merge (duplicates are not detected yet, so space
      * will likely be wasted on them, too bad) */
-    if (trg->size - trg->used < src->used) {
-        trg->size = trg->used + src->used;
-
-        trg->val.nodes = ly_realloc(trg->val.nodes, trg->size * sizeof *trg->val.nodes);
-        if (!trg->val.nodes) {
-            LOGMEM;
-            return -1;
-        }
+    nodes = malloc((trg->used + src->used) * sizeof *nodes);
+    if (!nodes) {
+        LOGMEM;
+        return -1;
     }
 
     i = 0;
     j = 0;
     count = 0;
-    dup_count = 0;
-    do {
+    while ((i < src->used) && (j < trg->used)) {
         cmp = set_sort_compare(&src->val.nodes[i], &trg->val.nodes[j], root);
         if (!cmp) {
-            if (!count) {
-                /* duplicate, just skip it */
-                ++i;
-                ++j;
-            } else {
-                /* we are copying something already, so let's copy the duplicate too,
-                 * we are hoping that afterwards there are some more nodes to
-                 * copy and this way we can copy them all together */
-                ++count;
-                ++dup_count;
-                ++i;
-                ++j;
-            }
-        } else if (cmp < 0) {
-            /* inserting src node into trg, just remember it for now */
-            ++count;
+            /* duplicate, just skip it */
             ++i;
-        } else if (count) {
-copy_nodes:
-            /* time to actually copy the nodes, we have found the largest block of nodes */
-            memmove(&trg->val.nodes[j + (count - dup_count)],
-                    &trg->val.nodes[j],
-                    (trg->used - j) * sizeof *trg->val.nodes);
-            memcpy(&trg->val.nodes[j - dup_count], &src->val.nodes[i - count], count * sizeof *src->val.nodes);
-
-            trg->used += count - dup_count;
-            /* do not change i, except the copying above, we are basically doing exactly what is in the else branch below */
-            j += count - dup_count;
-
-            count = 0;
-            dup_count = 0;
+        } else if (cmp < 0) {
+            nodes[count++] = src->val.nodes[i++];
         } else {
-            ++j;
+            nodes[count++] = trg->val.nodes[j++];
         }
-    } while ((i < src->used) && (j < trg->used));
-
-    if ((i < src->used) || count) {
-        /* loop ended, but we need to copy something at trg end */
-        count += src->used - i;
-        i = src->used;
-        goto copy_nodes;
     }
+    for (; i < src->used; ++i) {
+        nodes[count++] = src->val.nodes[i];
+    }
+    for (; j < trg->used; ++j) {
+        nodes[count++] = trg->val.nodes[j];
+    }
+
+    free(trg->val.nodes);
+    trg->val.nodes = nodes;
+    trg->size = trg->used + src->used;
+    trg->used = count;
 
 #ifndef NDEBUG
     LOGDBG(LY_LDGXPATH, "MERGE result");
@@ -1570,9 +1633,12 @@ exp_repeat_peek(struct lyxp_expr *exp, uint16_t exp_idx)
         return 0;
     }
 
-    for (i = 0; exp->repeat[exp_idx][i + 1]; ++i);
+    for (i = 0; exp->repeat[exp_idx][i]; ++i);
+    if (i <= exp->repeat_pop[exp_idx]) {
+        return 0;
+    }
 
-    return exp->repeat[exp_idx][i];
+    return exp->repeat[exp_idx][i - 1 - exp->repeat_pop[exp_idx]];
 }
 
 /**
@@ -1584,16 +1650,12 @@ exp_repeat_peek(struct lyxp_expr *exp, uint16_t exp_idx)
 static void
 exp_repeat_pop(struct lyxp_expr *exp, uint16_t exp_idx)
 {
-    uint16_t i;
-
     if (!exp->repeat[exp_idx]) {
         LOGINT;
         return;
     }
 
-    for (i = 0; exp->repeat[exp_idx][i + 1]; ++i);
-
-    exp->repeat[exp_idx][i] = 0;
+    ++exp->repeat_pop[exp_idx];
 }
 
 /**
@@ -2941,7 +3003,8 @@ static int
 xpath_derived_from(struct lyxp_set **args, uint16_t UNUSED(arg_count), struct lyd_node *cur_node, struct lys_module *local_mod,
                    struct lyxp_set *set, int options)
 {
-    uint16_t i, j;
+    uint32_t i;
+    uint16_t j;
     struct lyd_node_leaf_list *leaf;
     struct lys_node_leaf *sleaf;
 
@@ -2993,7 +3056,8 @@ static int
 xpath_derived_from_or_self(struct lyxp_set **args, uint16_t UNUSED(arg_count), struct lyd_node *cur_node,
                            struct lys_module *local_mod, struct lyxp_set *set, int options)
 {
-    uint16_t i, j;
+    uint32_t i;
+    uint16_t j;
     struct lyd_node_leaf_list *leaf;
     struct lys_node_leaf *sleaf;
 
@@ -3643,7 +3707,7 @@ xpath_re_match(struct lyxp_set **args, uint16_t UNUSED(arg_count), struct lyd_no
     } else {
         set_fill_boolean(set, 1);
     }
-    free(precomp);
+    pcre_free(precomp);
 
     return EXIT_SUCCESS;
 }
@@ -3938,7 +4002,7 @@ xpath_sum(struct lyxp_set **args, uint16_t UNUSED(arg_count), struct lyd_node *c
 {
     long double num;
     char *str;
-    uint16_t i;
+    uint32_t i;
     struct lyxp_set set_item;
 
     set_fill_number(set, 0);
@@ -4190,14 +4254,11 @@ moveto_resolve_model(const char *mod_name_ns, uint16_t mod_nam_ns_len, struct ly
         }
     }
 
-    for (i = 0; i < ctx->models.used; ++i) {
-        if (!ctx->models.list[i]->implemented || ctx->models.list[i]->disabled) {
-            /* skip not implemented or disabled modules */
-            continue;
-        }
-        str = (is_name ? ctx->models.list[i]->name : ctx->models.list[i]->ns);
-        if (!strncmp(str, mod_name_ns, mod_nam_ns_len) && !str[mod_nam_ns_len]) {
-            return ctx->models.list[i];
+    mod = NULL;
+    while ((mod = ly_ctx_mod_index_next(ctx, mod_name_ns, mod_nam_ns_len, !is_name, mod))) {
+        if (mod->implemented && !mod->disabled) {
+            /* not implemented or disabled modules are skipped */
+            return mod;
         }
     }
 
@@ -4340,6 +4401,7 @@ moveto_node_check(struct lyd_node *node, enum lyxp_node_type root_type, const ch
 
     /* when check */
     if ((options & LYXP_WHEN) && !LYD_WHEN_DONE(node->when_status)) {
+        ly_err_location()->inwhen = node;
         return EXIT_FAILURE;
     }
 
@@ -4385,66 +4447,309 @@ moveto_snode_check(const struct lys_node *node, enum lyxp_node_type root_type, c
 }
 
 /**
- * @brief Add \p node into \p set as a part of NameTest processing.
+ * @brief Find the only child instance of a container, leaf, or anydata in the children index of \p parent.
  *
- * @param[in] node Node to add.
- * @param[in] pos Node sort position.
- * @param[in,out] set Set to use.
- * @param[in] i Desired index of \p node in \p set.
- * @param[in,out] replaced Whether the node in \p set has already been replaced.
+ * @param[in] parent Parent data node.
+ * @param[in] node_name Dictionary name of the child.
+ * @param[in] moveto_mod Module of the child.
+ * @param[out] match Found child.
+ *
+ * @return 1 if found, 0 if there is no such child, -1 if the children must be searched sequentially.
  */
-static void
-moveto_node_add(struct lyxp_set *set, struct lyd_node *node, uint32_t pos, uint32_t i, int *replaced)
+static int
+moveto_node_hash(struct lyd_node *parent, const char *node_name, struct lys_module *moveto_mod, struct lyd_node **match)
 {
-    if (!(*replaced)) {
-        set->val.nodes[i].node = node;
-        set->val.nodes[i].type = LYXP_NODE_ELEM;
-        set->val.nodes[i].pos = pos;
-        *replaced = 1;
-    } else {
-        set_insert_node(set, node, pos, LYXP_NODE_ELEM, i);
+    const struct lys_node *snode = NULL;
+
+    if (!parent->ht || !moveto_mod || !strcmp(node_name, "*")) {
+        return -1;
+    }
+
+    while ((snode = lys_getnext(snode, parent->schema, NULL, 0))) {
+        if (ly_strequal(snode->name, node_name, 1) && (lys_node_module(snode) == moveto_mod)) {
+            break;
+        }
+    }
+    if (!snode || !(snode->nodetype & (LYS_CONTAINER | LYS_LEAF | LYS_ANYDATA))) {
+        /* lists and leaf-lists can have several instances */
+        return -1;
     }
+
+    return lyd_find_hash(parent, snode, NULL, NULL, match);
 }
 
 /**
- * @brief Move context \p set to a node. Handles '/' and '*', 'NAME', 'PREFIX:*', or 'PREFIX:NAME'.
- *        Result is LYXP_SET_NODE_SET (or LYXP_SET_EMPTY). Context position aware.
+ * @brief Get the key values of a list instance from the predicates following its NameTest if they compare
+ *        each key with a literal, '[KEY = 'value']' for all the keys in any order and nothing else.
  *
- * @param[in,out] set Set to use.
- * @param[in] cur_node Original context node.
- * @param[in] qname Qualified node name to move to.
- * @param[in] qname_len Length of \p qname.
- * @param[in] options Whether to apply data node access restrictions defined for 'when' and 'must' evaluation.
+ * @param[in] exp Parsed XPath expression.
+ * @param[in] exp_idx Position of the first predicate in \p exp.
+ * @param[in] slist List schema node.
+ * @param[out] values Key values in the order of the list keys, not terminated.
+ * @param[out] val_lens Lengths of \p values.
  *
- * @return EXIT_SUCCESS on success, EXIT_FAILURE on unresolved when, -1 on error.
+ * @return 1 if the predicates are key predicates, 0 if they must be evaluated.
  */
 static int
-moveto_node(struct lyxp_set *set, struct lyd_node *cur_node, const char *qname, uint16_t qname_len, int options)
+moveto_node_keys_get(struct lyxp_expr *exp, uint16_t exp_idx, const struct lys_node_list *slist, const char **values,
+                     int *val_lens)
 {
-    uint32_t i;
-    int replaced, pref_len, ret;
-    const char *ptr, *name_dict = NULL; /* optimalization - so we can do (==) instead (!strncmp(...)) in moveto_node_check() */
-    struct lys_module *moveto_mod;
-    struct lyd_node *sub;
-    struct ly_ctx *ctx;
-    enum lyxp_node_type root_type;
+    const char *qname, *ptr;
+    uint16_t qname_len;
+    int i, k;
 
-    if (!set || (set->type == LYXP_SET_EMPTY)) {
-        return EXIT_SUCCESS;
+    for (k = 0; k < slist->keys_size; ++k) {
+        values[k] = NULL;
     }
 
-    assert(cur_node);
+    for (i = 0; i < slist->keys_size; ++i, exp_idx += 5) {
+        if ((exp->used < exp_idx + 5) || (exp->tokens[exp_idx] != LYXP_TOKEN_BRACK1)
+                || (exp->tokens[exp_idx + 1] != LYXP_TOKEN_NAMETEST)
+                || (exp->tokens[exp_idx + 2] != LYXP_TOKEN_OPERATOR_COMP) || (exp->tok_len[exp_idx + 2] != 1)
+                || (exp->expr[exp->expr_pos[exp_idx + 2]] != '=') || (exp->tokens[exp_idx + 3] != LYXP_TOKEN_LITERAL)
+                || (exp->tokens[exp_idx + 4] != LYXP_TOKEN_BRACK2)) {
+            return 0;
+        }
 
-    if (set->type != LYXP_SET_NODE_SET) {
-        LOGVAL(LYE_XPATH_INOP_1, LY_VLOG_NONE, NULL, "path operator", print_set_type(set));
-        return -1;
+        /* key name */
+        qname = &exp->expr[exp->expr_pos[exp_idx + 1]];
+        qname_len = exp->tok_len[exp_idx + 1];
+        if ((ptr = strnchr(qname, ':', qname_len))) {
+            if (moveto_resolve_model(qname, ptr - qname, slist->module->ctx, NULL, 1)
+                    != lys_node_module((struct lys_node *)slist)) {
+                return 0;
+            }
+            qname_len -= (ptr - qname) + 1;
+            qname = ptr + 1;
+        }
+        for (k = 0; k < slist->keys_size; ++k) {
+            if (!strncmp(slist->keys[k]->name, qname, qname_len) && !slist->keys[k]->name[qname_len]) {
+                break;
+            }
+        }
+        if ((k == slist->keys_size) || values[k]) {
+            return 0;
+        }
+
+        /* the string value of these keys is not always their canonical value */
+        switch (slist->keys[k]->type.base) {
+        case LY_TYPE_EMPTY:
+        case LY_TYPE_IDENT:
+        case LY_TYPE_LEAFREF:
+        case LY_TYPE_UNION:
+            return 0;
+        default:
+            break;
+        }
+
+        /* literal without the quotes */
+        values[k] = &exp->expr[exp->expr_pos[exp_idx + 3] + 1];
+        val_lens[k] = exp->tok_len[exp_idx + 3] - 2;
     }
 
-    ctx = cur_node->schema->module->ctx;
-    moveto_get_root(cur_node, options, &root_type);
+    return 1;
+}
 
-    /* prefix */
-    if ((ptr = strnchr(qname, ':', qname_len))) {
+/**
+ * @brief Check whether a list instance has the key values.
+ */
+static int
+moveto_node_keys_equal(struct lyd_node *node, const struct lys_node_list *slist, const char **values,
+                       const int *val_lens)
+{
+    struct lyd_node *key;
+    const char *value;
+    int k;
+
+    for (k = 0; k < slist->keys_size; ++k) {
+        LY_TREE_FOR(node->child, key) {
+            if (key->schema == (struct lys_node *)slist->keys[k]) {
+                break;
+            }
+        }
+        if (!key) {
+            return 0;
+        }
+
+        value = ((struct lyd_node_leaf_list *)key)->value_str;
+        if (!value || strncmp(value, values[k], val_lens[k]) || value[val_lens[k]]) {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+/**
+ * @brief Move context \p set to the list instances selected by the key predicates following the NameTest.
+ *        Handles 'NAME' or 'PREFIX:NAME' of a list followed by '[KEY = 'value']' for each of its keys, the
+ *        instances are found in the children index of the context nodes instead of evaluating the predicates.
+ *        Result is LYXP_SET_NODE_SET (or LYXP_SET_EMPTY). Context position aware.
+ *
+ * @param[in,out] set Set to use.
+ * @param[in] cur_node Original context node.
+ * @param[in] exp Parsed XPath expression.
+ * @param[in] exp_idx Position of the NameTest in \p exp.
+ * @param[in] options Whether to apply data node access restrictions defined for 'when' and 'must' evaluation.
+ * @param[out] pred_count Number of the predicates already applied, 0 if the step must be evaluated generally
+ *             (\p set is not changed then).
+ *
+ * @return EXIT_SUCCESS on success, EXIT_FAILURE on unresolved when, -1 on error.
+ */
+static int
+moveto_node_keys(struct lyxp_set *set, struct lyd_node *cur_node, struct lyxp_expr *exp, uint16_t exp_idx,
+                 int options, uint16_t *pred_count)
+{
+    uint32_t i;
+    uint16_t qname_len;
+    int ret, val_lens[256];
+    const char *qname, *ptr, *values[256];
+    const struct lys_node *sparent, *snode, *iter;
+    struct lys_node_list *slist;
+    struct lys_module *moveto_mod;
+    struct lyd_node *node, *sub;
+    struct lyxp_set children;
+    enum lyxp_node_type root_type;
+
+    *pred_count = 0;
+    if ((set->type != LYXP_SET_NODE_SET) || (exp->used <= exp_idx + 1)
+            || (exp->tokens[exp_idx + 1] != LYXP_TOKEN_BRACK1)) {
+        return EXIT_SUCCESS;
+    }
+
+    qname = &exp->expr[exp->expr_pos[exp_idx]];
+    qname_len = exp->tok_len[exp_idx];
+    if ((ptr = strnchr(qname, ':', qname_len))) {
+        moveto_mod = moveto_resolve_model(qname, ptr - qname, cur_node->schema->module->ctx, NULL, 1);
+        if (!moveto_mod) {
+            return EXIT_SUCCESS;
+        }
+        qname_len -= (ptr - qname) + 1;
+        qname = ptr + 1;
+    } else {
+        moveto_mod = NULL;
+    }
+
+    /* all the context nodes must be instances of the same schema node (or the root) */
+    sparent = NULL;
+    for (i = 0; i < set->used; ++i) {
+        if ((set->val.nodes[i].type == LYXP_NODE_ROOT_CONFIG) || (set->val.nodes[i].type == LYXP_NODE_ROOT)) {
+            iter = NULL;
+        } else if (set->val.nodes[i].type == LYXP_NODE_ELEM) {
+            iter = set->val.nodes[i].node->schema;
+        } else {
+            return EXIT_SUCCESS;
+        }
+        if (i && (iter != sparent)) {
+            return EXIT_SUCCESS;
+        }
+        sparent = iter;
+    }
+    if (!sparent && !moveto_mod) {
+        return EXIT_SUCCESS;
+    }
+
+    /* the list */
+    snode = NULL;
+    iter = NULL;
+    while ((iter = lys_getnext(iter, sparent, sparent ? NULL : moveto_mod, 0))) {
+        if (!strncmp(iter->name, qname, qname_len) && !iter->name[qname_len]
+                && (!moveto_mod || (lys_node_module(iter) == moveto_mod))) {
+            if (snode) {
+                /* nodes from several modules */
+                return EXIT_SUCCESS;
+            }
+            snode = iter;
+        }
+    }
+    if (!snode || (snode->nodetype != LYS_LIST) || !((struct lys_node_list *)snode)->keys_size) {
+        return EXIT_SUCCESS;
+    }
+    slist = (struct lys_node_list *)snode;
+
+    /* its keys */
+    if (!moveto_node_keys_get(exp, exp_idx + 1, slist, values, val_lens)) {
+        return EXIT_SUCCESS;
+    }
+
+    moveto_get_root(cur_node, options, &root_type);
+
+    /* the matching instances are collected into a new set, the nodes are replaced by them */
+    memset(&children, 0, sizeof children);
+    for (i = 0; i < set->used; ++i) {
+        node = set->val.nodes[i].node;
+        if (!sparent || !(node->validity & LYD_VAL_INUSE)) {
+            ret = sparent ? lyd_find_hash(node, snode, values, val_lens, &sub) : -1;
+            if (ret == 1) {
+                ret = moveto_node_check(sub, root_type, snode->name, NULL, options);
+                if (!ret) {
+                    set_insert_node(&children, sub, 0, LYXP_NODE_ELEM, children.used);
+                } else if (ret == EXIT_FAILURE) {
+                    free(children.val.nodes);
+                    return EXIT_FAILURE;
+                }
+            } else if (ret == -1) {
+                LY_TREE_FOR(sparent ? node->child : node, sub) {
+                    if ((sub->schema != snode) || !moveto_node_keys_equal(sub, slist, values, val_lens)) {
+                        continue;
+                    }
+                    ret = moveto_node_check(sub, root_type, snode->name, NULL, options);
+                    if (!ret) {
+                        set_insert_node(&children, sub, 0, LYXP_NODE_ELEM, children.used);
+                    } else if (ret == EXIT_FAILURE) {
+                        free(children.val.nodes);
+                        return EXIT_FAILURE;
+                    }
+                }
+            }
+        }
+    }
+
+    set_replace_nodes(set, &children);
+    *pred_count = slist->keys_size;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Move context \p set to a node. Handles '/' and '*', 'NAME', 'PREFIX:*', or 'PREFIX:NAME'.
+ *        Result is LYXP_SET_NODE_SET (or LYXP_SET_EMPTY). Context position aware.
+ *
+ * @param[in,out] set Set to use.
+ * @param[in] cur_node Original context node.
+ * @param[in] qname Qualified node name to move to.
+ * @param[in] qname_len Length of \p qname.
+ * @param[in] options Whether to apply data node access restrictions defined for 'when' and 'must' evaluation.
+ *
+ * @return EXIT_SUCCESS on success, EXIT_FAILURE on unresolved when, -1 on error.
+ */
+static int
+moveto_node(struct lyxp_set *set, struct lyd_node *cur_node, const char *qname, uint16_t qname_len, int options)
+{
+    uint32_t i;
+    int pref_len, ret;
+    const char *ptr, *name_dict = NULL; /* optimalization - so we can do (==) instead (!strncmp(...)) in moveto_node_check() */
+    struct lys_module *moveto_mod;
+    struct lyd_node *sub;
+    struct lyxp_set children;
+    struct ly_ctx *ctx;
+    enum lyxp_node_type root_type;
+
+    if (!set || (set->type == LYXP_SET_EMPTY)) {
+        return EXIT_SUCCESS;
+    }
+
+    assert(cur_node);
+
+    if (set->type != LYXP_SET_NODE_SET) {
+        LOGVAL(LYE_XPATH_INOP_1, LY_VLOG_NONE, NULL, "path operator", print_set_type(set));
+        return -1;
+    }
+
+    ctx = cur_node->schema->module->ctx;
+    moveto_get_root(cur_node, options, &root_type);
+
+    /* prefix */
+    if ((ptr = strnchr(qname, ':', qname_len))) {
         pref_len = ptr - qname;
         moveto_mod = moveto_resolve_model(qname, pref_len, ctx, NULL, 1);
         if (!moveto_mod) {
@@ -4460,19 +4765,17 @@ moveto_node(struct lyxp_set *set, struct lyd_node *cur_node, const char *qname,
     /* name */
     name_dict = lydict_insert(ctx, qname, qname_len);
 
-    for (i = 0; i < set->used; ) {
-        replaced = 0;
-
+    /* the matching children are collected into a new set, the nodes are replaced by them */
+    memset(&children, 0, sizeof children);
+    for (i = 0; i < set->used; ++i) {
         if ((set->val.nodes[i].type == LYXP_NODE_ROOT_CONFIG) || (set->val.nodes[i].type == LYXP_NODE_ROOT)) {
             LY_TREE_FOR(set->val.nodes[i].node, sub) {
                 ret = moveto_node_check(sub, root_type, name_dict, moveto_mod, options);
                 if (!ret) {
                     /* pos filled later */
-                    moveto_node_add(set, sub, 0, i, &replaced);
-                    ++i;
+                    set_insert_node(&children, sub, 0, LYXP_NODE_ELEM, children.used);
                 } else if (ret == EXIT_FAILURE) {
-                    lydict_remove(ctx, name_dict);
-                    return EXIT_FAILURE;
+                    goto cleanup;
                 }
             }
 
@@ -4480,26 +4783,34 @@ moveto_node(struct lyxp_set *set, struct lyd_node *cur_node, const char *qname,
         } else if (!(set->val.nodes[i].node->validity & LYD_VAL_INUSE)
                 && !(set->val.nodes[i].node->schema->nodetype & (LYS_LEAF | LYS_LEAFLIST | LYS_ANYDATA))) {
 
-            LY_TREE_FOR(set->val.nodes[i].node->child, sub) {
+            ret = moveto_node_hash(set->val.nodes[i].node, name_dict, moveto_mod, &sub);
+            if (ret == 1) {
                 ret = moveto_node_check(sub, root_type, name_dict, moveto_mod, options);
                 if (!ret) {
-                    moveto_node_add(set, sub, 0, i, &replaced);
-                    ++i;
+                    set_insert_node(&children, sub, 0, LYXP_NODE_ELEM, children.used);
                 } else if (ret == EXIT_FAILURE) {
-                    lydict_remove(ctx, name_dict);
-                    return EXIT_FAILURE;
+                    goto cleanup;
+                }
+            } else if (ret == -1) {
+                LY_TREE_FOR(set->val.nodes[i].node->child, sub) {
+                    ret = moveto_node_check(sub, root_type, name_dict, moveto_mod, options);
+                    if (!ret) {
+                        set_insert_node(&children, sub, 0, LYXP_NODE_ELEM, children.used);
+                    } else if (ret == EXIT_FAILURE) {
+                        goto cleanup;
+                    }
                 }
             }
         }
-
-        if (!replaced) {
-            /* no match */
-            set_remove_node(set, i);
-        }
     }
-    lydict_remove(ctx, name_dict);
 
-    return EXIT_SUCCESS;
+    set_replace_nodes(set, &children);
+    ret = EXIT_SUCCESS;
+
+cleanup:
+    free(children.val.nodes);
+    lydict_remove(ctx, name_dict);
+    return ret;
 }
 
 static int
@@ -4630,9 +4941,11 @@ moveto_node_alldesc(struct lyxp_set *set, struct lyd_node *cur_node, const char
                     int options)
 {
     uint32_t i;
-    int pref_len, all = 0, replace, match, ret;
+    int pref_len, all = 0, match, ret;
     struct lyd_node *next, *elem, *start;
     struct lys_module *moveto_mod;
+    struct lyxp_set matches;
+    struct hash_table *ht = NULL;
     enum lyxp_node_type root_type;
 
     if (!set || (set->type == LYXP_SET_EMPTY)) {
@@ -4662,7 +4975,7 @@ moveto_node_alldesc(struct lyxp_set *set, struct lyd_node *cur_node, const char
 
     /* replace the original nodes (and throws away all text and attr nodes, root is replaced by a child) */
     ret = moveto_node(set, cur_node, "*", 1, options);
-    if (ret) {
+    if (ret || (set->type == LYXP_SET_EMPTY)) {
         return ret;
     }
 
@@ -4670,16 +4983,26 @@ moveto_node_alldesc(struct lyxp_set *set, struct lyd_node *cur_node, const char
         all = 1;
     }
 
-    /* this loop traverses all the nodes in the set and addds/keeps only
+    /* the nodes in the set are traversed separately, so their subtrees are skipped when found
+     * in the subtree of a preceding node */
+    if (set_dup_node_index(set, &ht)) {
+        return -1;
+    }
+
+    /* this loop traverses all the nodes in the set and collects only
      * those that match qname */
-    for (i = 0; i < set->used; ) {
+    memset(&matches, 0, sizeof matches);
+    for (i = 0; i < set->used; ++i) {
         /* TREE DFS */
         start = set->val.nodes[i].node;
-        replace = 0;
         for (elem = next = start; elem; elem = next) {
 
             /* dummy and context check */
             if ((elem->validity & LYD_VAL_INUSE) || ((root_type == LYXP_NODE_ROOT_CONFIG) && (elem->schema->flags & LYS_CONFIG_R))) {
+                if (elem == start) {
+                    /* keep it */
+                    set_insert_node(&matches, start, set->val.nodes[i].pos, LYXP_NODE_ELEM, matches.used);
+                }
                 goto skip_children;
             }
 
@@ -4697,25 +5020,19 @@ moveto_node_alldesc(struct lyxp_set *set, struct lyd_node *cur_node, const char
 
             /* when check */
             if ((options & LYXP_WHEN) && !LYD_WHEN_DONE(elem->when_status)) {
-                return EXIT_FAILURE;
+                ly_err_location()->inwhen = elem;
+                ret = EXIT_FAILURE;
+                goto cleanup;
             }
 
-            if (match && (elem != start)) {
-                if (set_dup_node_check(set, elem, LYXP_NODE_ELEM, i) > -1) {
+            if (match && (elem == start)) {
+                set_insert_node(&matches, start, set->val.nodes[i].pos, LYXP_NODE_ELEM, matches.used);
+            } else if (match) {
+                if (set_dup_node_check(ht, elem, LYXP_NODE_ELEM)) {
                     /* we'll process it later */
                     goto skip_children;
-                } else if (replace) {
-                    set->val.nodes[i].node = elem;
-                    assert(set->val.nodes[i].type == LYXP_NODE_ELEM);
-                    set->val.nodes[i].pos = 0;
-                    replace = 0;
-                } else {
-                    set_insert_node(set, elem, 0, LYXP_NODE_ELEM, i + 1);
-                    ++i;
                 }
-            } else if (!match && (elem == start)) {
-                /* we need to replace a node that is already in the set */
-                replace = 1;
+                set_insert_node(&matches, elem, 0, LYXP_NODE_ELEM, matches.used);
             }
 
             /* TREE DFS NEXT ELEM */
@@ -4745,15 +5062,15 @@ skip_children:
                 next = elem->next;
             }
         }
-
-        if (replace) {
-            set_remove_node(set, i);
-        } else {
-            ++i;
-        }
     }
 
-    return EXIT_SUCCESS;
+    set_replace_nodes(set, &matches);
+    ret = EXIT_SUCCESS;
+
+cleanup:
+    free(matches.val.nodes);
+    lyht_free(ht);
+    return ret;
 }
 
 static int
@@ -5149,8 +5466,11 @@ moveto_attr_alldesc(struct lyxp_set *set, struct lyd_node *cur_node, const char
 static int
 moveto_self(struct lyxp_set *set, struct lyd_node *cur_node, int all_desc, int options)
 {
-    struct lyd_node *sub;
-    uint32_t i, cont_i;
+    struct lyd_node *start, *next, *elem;
+    struct lyxp_set desc;
+    struct hash_table *ht = NULL;
+    uint32_t i;
+    int ret;
     enum lyxp_node_type root_type;
 
     if (!set || (set->type == LYXP_SET_EMPTY)) {
@@ -5169,9 +5489,16 @@ moveto_self(struct lyxp_set *set, struct lyd_node *cur_node, int all_desc, int o
 
     moveto_get_root(cur_node, options, &root_type);
 
-    /* add all the children, they get added recursively */
+    /* the nodes in the set are traversed separately, so their subtrees are skipped when found
+     * in the subtree of a preceding node */
+    if (set_dup_node_index(set, &ht)) {
+        return -1;
+    }
+
+    /* add all the nodes followed by their descendants */
+    memset(&desc, 0, sizeof desc);
     for (i = 0; i < set->used; ++i) {
-        cont_i = 0;
+        set_insert_node(&desc, set->val.nodes[i].node, set->val.nodes[i].pos, set->val.nodes[i].type, desc.used);
 
         /* do not touch attributes and text nodes */
         if ((set->val.nodes[i].type == LYXP_NODE_TEXT) || (set->val.nodes[i].type == LYXP_NODE_ATTR)) {
@@ -5179,42 +5506,80 @@ moveto_self(struct lyxp_set *set, struct lyd_node *cur_node, int all_desc, int o
         }
 
         /* skip anydata/anyxml and dummy nodes */
-        if ((set->val.nodes[i].node->schema->nodetype & LYS_ANYDATA) || (set->val.nodes[i].node->validity & LYD_VAL_INUSE)) {
+        start = set->val.nodes[i].node;
+        if ((start->schema->nodetype & LYS_ANYDATA) || (start->validity & LYD_VAL_INUSE)) {
             continue;
         }
 
-        /* add all the children ... */
-        if (!(set->val.nodes[i].node->schema->nodetype & (LYS_LEAF | LYS_LEAFLIST))) {
-            LY_TREE_FOR(set->val.nodes[i].node->child, sub) {
+        /* TREE DFS */
+        for (elem = next = start; elem; elem = next) {
+            if (elem != start) {
                 /* context check */
-                if ((root_type == LYXP_NODE_ROOT_CONFIG) && (sub->schema->flags & LYS_CONFIG_R)) {
-                    continue;
+                if ((root_type == LYXP_NODE_ROOT_CONFIG) && (elem->schema->flags & LYS_CONFIG_R)) {
+                    goto skip_children;
                 }
 
                 /* when check */
-                if ((options & LYXP_WHEN) && !LYD_WHEN_DONE(sub->when_status)) {
-                    return EXIT_FAILURE;
+                if ((options & LYXP_WHEN) && !LYD_WHEN_DONE(elem->when_status)) {
+                    ly_err_location()->inwhen = elem;
+                    ret = EXIT_FAILURE;
+                    goto cleanup;
                 }
 
-                if (set_dup_node_check(set, sub, LYXP_NODE_ELEM, -1) == -1) {
-                    set_insert_node(set, sub, 0, LYXP_NODE_ELEM, i + cont_i + 1);
-                    ++cont_i;
+                if (set_dup_node_check(ht, elem, LYXP_NODE_ELEM)) {
+                    /* we'll process it later */
+                    goto skip_children;
+                }
+                set_insert_node(&desc, elem, 0, LYXP_NODE_ELEM, desc.used);
+
+                if ((elem->schema->nodetype & LYS_ANYDATA) || (elem->validity & LYD_VAL_INUSE)) {
+                    goto skip_children;
                 }
             }
 
-        /* ... or add their text node, ... */
-        } else {
-            /* ... but only non-empty */
-            sub = set->val.nodes[i].node;
-            if (((struct lyd_node_leaf_list *)sub)->value_str) {
-                if (set_dup_node_check(set, sub, LYXP_NODE_TEXT, -1) == -1) {
-                    set_insert_node(set, sub, set->val.nodes[i].pos, LYXP_NODE_TEXT, i + 1);
+            /* add all the children ... */
+            if (!(elem->schema->nodetype & (LYS_LEAF | LYS_LEAFLIST))) {
+                next = elem->child;
+
+            /* ... or add their text node, ... */
+            } else {
+                /* ... but only non-empty */
+                if (((struct lyd_node_leaf_list *)elem)->value_str && !set_dup_node_check(ht, elem, LYXP_NODE_TEXT)) {
+                    set_insert_node(&desc, elem, (elem == start) ? set->val.nodes[i].pos : 0, LYXP_NODE_TEXT, desc.used);
                 }
+                next = NULL;
+            }
+
+            /* TREE DFS NEXT ELEM */
+            if (!next) {
+skip_children:
+                /* no children, so try siblings, but only if it's not the start */
+                if (elem != start) {
+                    next = elem->next;
+                } else {
+                    break;
+                }
+            }
+            while (!next) {
+                /* no siblings, go back through the parents */
+                if (elem->parent == start) {
+                    /* we are done, no next element to process */
+                    break;
+                }
+                /* parent is already processed, go to its sibling */
+                elem = elem->parent;
+                next = elem->next;
             }
         }
     }
 
-    return EXIT_SUCCESS;
+    set_replace_nodes(set, &desc);
+    ret = EXIT_SUCCESS;
+
+cleanup:
+    free(desc.val.nodes);
+    lyht_free(ht);
+    return ret;
 }
 
 static int
@@ -5290,8 +5655,9 @@ static int
 moveto_parent(struct lyxp_set *set, struct lyd_node *cur_node, int all_desc, int options)
 {
     int ret;
-    uint32_t i;
+    uint32_t i, j;
     struct lyd_node *node, *new_node;
+    struct hash_table *ht = NULL;
     const struct lyd_node *root;
     enum lyxp_node_type root_type, new_type;
 
@@ -5314,7 +5680,17 @@ moveto_parent(struct lyxp_set *set, struct lyd_node *cur_node, int all_desc, int
 
     root = moveto_get_root(cur_node, options, &root_type);
 
-    for (i = 0; i < set->used; ) {
+    /* the parents already in the set */
+    if (set->used > 1) {
+        ht = lyht_new(set_dup_node_equal, NULL);
+        if (!ht) {
+            LOGMEM;
+            return -1;
+        }
+    }
+
+    /* the parents are moved to the beginning of the set */
+    for (i = 0, j = 0; i < set->used; ++i) {
         node = set->val.nodes[i].node;
 
         if (set->val.nodes[i].type == LYXP_NODE_ELEM) {
@@ -5325,17 +5701,19 @@ moveto_parent(struct lyxp_set *set, struct lyd_node *cur_node, int all_desc, int
             new_node = (struct lyd_node *)lyd_attr_parent(root, set->val.attrs[i].attr);
             if (!new_node) {
                 LOGINT;
-                return -1;
+                ret = -1;
+                goto cleanup;
             }
         } else {
             /* root does not have a parent */
-            set_remove_node(set, i);
             continue;
         }
 
         /* when check */
         if ((options & LYXP_WHEN) && new_node && !LYD_WHEN_DONE(new_node->when_status)) {
-            return EXIT_FAILURE;
+            ly_err_location()->inwhen = new_node;
+            ret = EXIT_FAILURE;
+            goto cleanup;
         }
 
         /* node already there can also be the root */
@@ -5369,16 +5747,27 @@ moveto_parent(struct lyxp_set *set, struct lyd_node *cur_node, int all_desc, int
 
         assert((new_type == LYXP_NODE_ELEM) || ((new_type == root_type) && (new_node == root)));
 
-        if (set_dup_node_check(set, new_node, new_type, -1) > -1) {
-            set_remove_node(set, i);
-        } else {
-            set->val.nodes[i].node = new_node;
-            set->val.nodes[i].type = new_type;
-            set->val.nodes[i].pos = 0;
+        if (!set_dup_node_check(ht, new_node, new_type)) {
+            set->val.nodes[j].node = new_node;
+            set->val.nodes[j].type = new_type;
+            set->val.nodes[j].pos = 0;
+            if (set_dup_node_add(ht, &set->val.nodes[j])) {
+                ret = -1;
+                goto cleanup;
+            }
 
-            ++i;
+            ++j;
         }
     }
+    lyht_free(ht);
+    ht = NULL;
+
+    set->used = j;
+    if (!set->used) {
+        free(set->val.nodes);
+        /* this changes it to LYXP_SET_EMPTY */
+        memset(set, 0, sizeof *set);
+    }
 
 #ifndef NDEBUG
     if (set_sort(set, cur_node, options) > 1) {
@@ -5390,6 +5779,10 @@ moveto_parent(struct lyxp_set *set, struct lyd_node *cur_node, int all_desc, int
 #endif
 
     return EXIT_SUCCESS;
+
+cleanup:
+    lyht_free(ht);
+    return ret;
 }
 
 static int
@@ -5853,9 +6246,9 @@ eval_predicate(struct lyxp_expr *exp, uint16_t *exp_idx, struct lyd_node *cur_no
                struct lyxp_set *set, int options)
 {
     int ret;
-    uint16_t i, j, orig_exp, brack2_exp;
-    uint32_t orig_pos, orig_size, pred_in_ctx;
-    uint8_t **pred_repeat, rep_size;
+    uint16_t orig_exp, brack2_exp;
+    uint32_t i, j, orig_pos, orig_size, pred_in_ctx;
+    uint8_t *pred_repeat_pop;
     struct lyxp_set set2;
 
     /* '[' */
@@ -5881,31 +6274,17 @@ eval_predicate(struct lyxp_expr *exp, uint16_t *exp_idx, struct lyd_node *cur_no
         /* find the predicate end */
         for (brack2_exp = orig_exp; exp->tokens[brack2_exp] != LYXP_TOKEN_BRACK2; ++brack2_exp);
 
-        /* copy predicate repeats, since they get deleted each time (probably not an ideal solution) */
-        pred_repeat = calloc(brack2_exp - orig_exp, sizeof *pred_repeat);
-        if (!pred_repeat) {
+        /* remember the predicate repeat state, the repeats are popped during each evaluation */
+        pred_repeat_pop = malloc((brack2_exp - orig_exp) * sizeof *pred_repeat_pop);
+        if (!pred_repeat_pop) {
             LOGMEM;
             return -1;
         }
-        for (j = 0; j < brack2_exp - orig_exp; ++j) {
-            if (exp->repeat[orig_exp + j]) {
-                for (rep_size = 0; exp->repeat[orig_exp + j][rep_size]; ++rep_size);
-                ++rep_size;
-                pred_repeat[j] = malloc(rep_size * sizeof **pred_repeat);
-                if (!pred_repeat[j]) {
-                    LOGMEM;
-                    for (i = 0; i < j; ++i) {
-                        free(pred_repeat[j]);
-                    }
-                    free(pred_repeat);
-                    return -1;
-                }
-                memcpy(pred_repeat[j], exp->repeat[orig_exp + j], rep_size * sizeof **pred_repeat);
-            }
-        }
+        memcpy(pred_repeat_pop, exp->repeat_pop + orig_exp, (brack2_exp - orig_exp) * sizeof *pred_repeat_pop);
 
+        /* the nodes satisfying the predicate are moved to the beginning of the set */
         orig_size = set->used;
-        for (i = 0, orig_pos = 1; i < set->used; ++orig_pos) {
+        for (i = 0, j = 0, orig_pos = 1; i < orig_size; ++i, ++orig_pos) {
             set2.type = LYXP_SET_EMPTY;
             set_insert_node(&set2, set->val.nodes[i].node, set->val.nodes[i].pos, set->val.nodes[i].type, 0);
             /* remember the node context position for position() and context size for last() */
@@ -5913,21 +6292,12 @@ eval_predicate(struct lyxp_expr *exp, uint16_t *exp_idx, struct lyd_node *cur_no
             set2.ctx_size = orig_size;
             *exp_idx = orig_exp;
 
-            /* replace repeats */
-            for (j = 0; j < brack2_exp - orig_exp; ++j) {
-                if (pred_repeat[j]) {
-                    for (rep_size = 0; pred_repeat[j][rep_size]; ++rep_size);
-                    ++rep_size;
-                    memcpy(exp->repeat[orig_exp + j], pred_repeat[j], rep_size * sizeof **pred_repeat);
-                }
-            }
+            /* restore repeats */
+            memcpy(exp->repeat_pop + orig_exp, pred_repeat_pop, (brack2_exp - orig_exp) * sizeof *pred_repeat_pop);
 
             ret = eval_expr(exp, exp_idx, cur_node, local_mod, &set2, options);
             if (ret) {
-                for (j = 0; j < brack2_exp - orig_exp; ++j) {
-                    free(pred_repeat[j]);
-                }
-                free(pred_repeat);
+                free(pred_repeat_pop);
                 lyxp_set_cast(&set2, LYXP_SET_EMPTY, cur_node, local_mod, options);
                 return ret;
             }
@@ -5944,17 +6314,18 @@ eval_predicate(struct lyxp_expr *exp, uint16_t *exp_idx, struct lyd_node *cur_no
 
             /* predicate satisfied or not? */
             if (set2.val.bool) {
-                ++i;
-            } else {
-                set_remove_node(set, i);
+                set->val.nodes[j++] = set->val.nodes[i];
             }
         }
 
-        /* free predicate repeats */
-        for (j = 0; j < brack2_exp - orig_exp; ++j) {
-            free(pred_repeat[j]);
+        free(pred_repeat_pop);
+
+        set->used = j;
+        if (!set->used) {
+            free(set->val.nodes);
+            /* this changes it to LYXP_SET_EMPTY */
+            memset(set, 0, sizeof *set);
         }
-        free(pred_repeat);
 
     } else if (set->type == LYXP_SET_SNODE_SET) {
         orig_exp = *exp_idx;
@@ -5962,28 +6333,13 @@ eval_predicate(struct lyxp_expr *exp, uint16_t *exp_idx, struct lyd_node *cur_no
         /* find the predicate end */
         for (brack2_exp = orig_exp; exp->tokens[brack2_exp] != LYXP_TOKEN_BRACK2; ++brack2_exp);
 
-        /* copy predicate repeats, since they get deleted each time (probably not an ideal solution) */
-        pred_repeat = calloc(brack2_exp - orig_exp, sizeof *pred_repeat);
-        if (!pred_repeat) {
+        /* remember the predicate repeat state, the repeats are popped during each evaluation */
+        pred_repeat_pop = malloc((brack2_exp - orig_exp) * sizeof *pred_repeat_pop);
+        if (!pred_repeat_pop) {
             LOGMEM;
             return -1;
         }
-        for (j = 0; j < brack2_exp - orig_exp; ++j) {
-            if (exp->repeat[orig_exp + j]) {
-                for (rep_size = 0; exp->repeat[orig_exp + j][rep_size]; ++rep_size);
-                ++rep_size;
-                pred_repeat[j] = malloc(rep_size * sizeof **pred_repeat);
-                if (!pred_repeat[j]) {
-                    LOGMEM;
-                    for (i = 0; i < j; ++i) {
-                        free(pred_repeat[j]);
-                    }
-                    free(pred_repeat);
-                    return -1;
-                }
-                memcpy(pred_repeat[j], exp->repeat[orig_exp + j], rep_size * sizeof **pred_repeat);
-            }
-        }
+        memcpy(pred_repeat_pop, exp->repeat_pop + orig_exp, (brack2_exp - orig_exp) * sizeof *pred_repeat_pop);
 
         /* set special in_ctx to all the valid snodes */
         pred_in_ctx = set_snode_new_in_ctx(set);
@@ -5997,21 +6353,12 @@ eval_predicate(struct lyxp_expr *exp, uint16_t *exp_idx, struct lyd_node *cur_no
 
             *exp_idx = orig_exp;
 
-            /* replace repeats */
-            for (j = 0; j < brack2_exp - orig_exp; ++j) {
-                if (pred_repeat[j]) {
-                    for (rep_size = 0; pred_repeat[j][rep_size]; ++rep_size);
-                    ++rep_size;
-                    memcpy(exp->repeat[orig_exp + j], pred_repeat[j], rep_size * sizeof **pred_repeat);
-                }
-            }
+            /* restore repeats */
+            memcpy(exp->repeat_pop + orig_exp, pred_repeat_pop, (brack2_exp - orig_exp) * sizeof *pred_repeat_pop);
 
             ret = eval_expr(exp, exp_idx, cur_node, local_mod, set, options);
             if (ret) {
-                for (j = 0; j < brack2_exp - orig_exp; ++j) {
-                    free(pred_repeat[j]);
-                }
-                free(pred_repeat);
+                free(pred_repeat_pop);
                 return ret;
             }
 
@@ -6027,11 +6374,7 @@ eval_predicate(struct lyxp_expr *exp, uint16_t *exp_idx, struct lyd_node *cur_no
             }
         }
 
-        /* free predicate repeats */
-        for (j = 0; j < brack2_exp - orig_exp; ++j) {
-            free(pred_repeat[j]);
-        }
-        free(pred_repeat);
+        free(pred_repeat_pop);
     } else {
         set2.type = LYXP_SET_EMPTY;
         set_fill_set(&set2, set);
@@ -6077,6 +6420,7 @@ eval_relative_location_path(struct lyxp_expr *exp, uint16_t *exp_idx, struct lyd
                             int all_desc, struct lyxp_set *set, int options)
 {
     int attr_axis, ret;
+    uint16_t key_preds;
 
     goto step;
     do {
@@ -6134,7 +6478,23 @@ step:
             /* fall through */
         case LYXP_TOKEN_NAMETEST:
         case LYXP_TOKEN_NODETYPE:
-            ret = eval_node_test(exp, exp_idx, cur_node, local_mod, attr_axis, all_desc, set, options);
+            key_preds = 0;
+            if (set && !attr_axis && !all_desc && (exp->tokens[*exp_idx] == LYXP_TOKEN_NAMETEST)) {
+                /* list instances selected by all their keys are found in the children index */
+                ret = moveto_node_keys(set, cur_node, exp, *exp_idx, options, &key_preds);
+                if (ret) {
+                    return ret;
+                }
+            }
+            if (key_preds) {
+                /* only skip the NameTest and the key predicates, they were applied */
+                ret = eval_node_test(exp, exp_idx, cur_node, local_mod, 0, 0, NULL, options);
+                for (; !ret && key_preds; --key_preds) {
+                    ret = eval_predicate(exp, exp_idx, cur_node, local_mod, NULL, options);
+                }
+            } else {
+                ret = eval_node_test(exp, exp_idx, cur_node, local_mod, attr_axis, all_desc, set, options);
+            }
             if (ret) {
                 return ret;
             }
@@ -6434,7 +6794,15 @@ eval_function_call(struct lyxp_expr *exp, uint16_t *exp_idx, struct lyd_node *cu
                print_token(exp->tokens[*exp_idx]), exp->expr_pos[*exp_idx]);
     ++(*exp_idx);
 
-    if (set) {
+    if (set && (options & LYXP_SNODE_ALL) && (xpath_func != &xpath_deref)) {
+        /* only the atoms of the arguments are relevant */
+        set_snode_clear_ctx(set);
+        for (i = 0; i < arg_count; ++i) {
+            set_snode_clear_ctx(args[i]);
+            set_snode_merge(set, args[i]);
+        }
+        rc = EXIT_SUCCESS;
+    } else if (set) {
         /* evaluate function */
         rc = xpath_func(args, arg_count, cur_node, local_mod, set, options);
     } else {
@@ -6553,7 +6921,8 @@ eval_path_expr(struct lyxp_expr *exp, uint16_t *exp_idx, struct lyd_node *cur_no
                 /* the only function returning node-set - thus relevant */
                 if ((exp->tok_len[*exp_idx] == 7) && !strncmp(&exp->expr[exp->expr_pos[*exp_idx]], "current", 7)) {
                     xpath_current(NULL, 0, cur_node, local_mod, set, options);
-                } else if ((exp->tok_len[*exp_idx] == 5) && !strncmp(&exp->expr[exp->expr_pos[*exp_idx]], "deref", 5)) {
+                } else if (((exp->tok_len[*exp_idx] == 5) && !strncmp(&exp->expr[exp->expr_pos[*exp_idx]], "deref", 5))
+                        || (options & LYXP_SNODE_ARGS)) {
                     ret = eval_function_call(exp, exp_idx, cur_node, local_mod, set, options);
                     if (ret) {
                         return ret;
@@ -7321,50 +7690,155 @@ eval_expr(struct lyxp_expr *exp, uint16_t *exp_idx, struct lyd_node *cur_node, s
     return EXIT_SUCCESS;
 }
 
-int
-lyxp_eval(const char *expr, const struct lyd_node *cur_node, enum lyxp_node_type cur_node_type,
-          const struct lys_module *local_mod, struct lyxp_set *set, int options)
+/**
+ * @brief Evaluate a whole parsed expression. The expression itself is not modified,
+ * all the evaluation state (popped repeats) is kept in a private copy of it.
+ *
+ * @param[in] exp Parsed XPath expression.
+ * @param[in] cur_node Start node for the expression.
+ * @param[in] local_mod Local module relative to the expression.
+ * @param[in,out] set Context and result set.
+ * @param[in] options Whether to apply data node access restrictions defined for 'when' and 'must' evaluation.
+ *
+ * @return EXIT_SUCCESS on success, EXIT_FAILURE on unresolved when dependency, -1 on error.
+ */
+static int
+eval_expr_start(struct lyxp_expr *exp, struct lyd_node *cur_node, struct lys_module *local_mod, struct lyxp_set *set,
+                int options)
 {
-    struct lyxp_expr *exp;
+    struct lyxp_expr eval_exp;
     uint16_t exp_idx = 0;
-    int rc = -1;
+    int rc;
 
-    if (!expr || !set) {
-        ly_errno = LY_EINVAL;
-        return EXIT_FAILURE;
+    memcpy(&eval_exp, exp, sizeof eval_exp);
+    eval_exp.repeat_pop = calloc(exp->used ? exp->used : 1, sizeof *eval_exp.repeat_pop);
+    if (!eval_exp.repeat_pop) {
+        LOGMEM;
+        return -1;
     }
 
+    rc = eval_expr(&eval_exp, &exp_idx, cur_node, local_mod, set, options);
+
+    free(eval_exp.repeat_pop);
+    return rc;
+}
+
+struct lyxp_expr *
+lyxp_compile_expr(const char *expr)
+{
+    struct lyxp_expr *exp;
+    uint16_t exp_idx = 0;
+
     exp = lyxp_parse_expr(expr);
     if (!exp) {
-        rc = -1;
-        goto finish;
+        return NULL;
     }
 
-    rc = reparse_expr(exp, &exp_idx);
-    if (rc) {
-        goto finish;
+    if (reparse_expr(exp, &exp_idx)) {
+        goto error;
     } else if (exp->used > exp_idx) {
         LOGVAL(LYE_XPATH_INTOK, LY_VLOG_NONE, NULL, "Unknown", &exp->expr[exp->expr_pos[exp_idx]]);
         LOGVAL(LYE_SPEC, LY_VLOG_NONE, NULL, "Unparsed characters \"%s\" left at the end of an XPath expression.",
                &exp->expr[exp->expr_pos[exp_idx]]);
-        rc = -1;
-        goto finish;
+        goto error;
     }
 
     print_expr_struct_debug(exp);
 
-    exp_idx = 0;
+    return exp;
+
+error:
+    lyxp_expr_free(exp);
+    return NULL;
+}
+
+struct lyxp_expr *
+lyxp_get_compiled_expr(const char *expr, void **cache)
+{
+    struct lyxp_expr *exp, *expected = NULL;
+
+    exp = __atomic_load_n((struct lyxp_expr **)cache, __ATOMIC_ACQUIRE);
+    if (exp) {
+        return exp;
+    }
+
+    exp = lyxp_compile_expr(expr);
+    if (!exp) {
+        return NULL;
+    }
+
+    /* another thread may have compiled the expression in the meantime, use only one of them */
+    if (!__atomic_compare_exchange_n((struct lyxp_expr **)cache, &expected, exp, 0, __ATOMIC_ACQ_REL,
+                                     __ATOMIC_ACQUIRE)) {
+        lyxp_expr_free(exp);
+        exp = __atomic_load_n((struct lyxp_expr **)cache, __ATOMIC_ACQUIRE);
+    }
+
+    return exp;
+}
+
+int
+lyxp_eval_compiled(struct lyxp_expr *exp, const struct lyd_node *cur_node, enum lyxp_node_type cur_node_type,
+                   const struct lys_module *local_mod, struct lyxp_set *set, int options)
+{
+    int rc;
+
+    if (!exp || !set) {
+        ly_errno = LY_EINVAL;
+        return EXIT_FAILURE;
+    }
+
     memset(set, 0, sizeof *set);
     if (cur_node) {
         set_insert_node(set, (struct lyd_node *)cur_node, 0, cur_node_type, 0);
     }
 
-    rc = eval_expr(exp, &exp_idx, (struct lyd_node *)cur_node, (struct lys_module *)local_mod, set, options);
+    rc = eval_expr_start(exp, (struct lyd_node *)cur_node, (struct lys_module *)local_mod, set, options);
     if ((rc == -1) && cur_node) {
         LOGPATH(LY_VLOG_LYD, cur_node);
     }
 
-finish:
+    return rc;
+}
+
+int
+lyxp_eval_cached(const char *expr, void **cache, const struct lyd_node *cur_node, enum lyxp_node_type cur_node_type,
+                 const struct lys_module *local_mod, struct lyxp_set *set, int options)
+{
+    struct lyxp_expr *exp;
+
+    if (!expr || !cache || !set) {
+        ly_errno = LY_EINVAL;
+        return EXIT_FAILURE;
+    }
+
+    exp = lyxp_get_compiled_expr(expr, cache);
+    if (!exp) {
+        return -1;
+    }
+
+    return lyxp_eval_compiled(exp, cur_node, cur_node_type, local_mod, set, options);
+}
+
+int
+lyxp_eval(const char *expr, const struct lyd_node *cur_node, enum lyxp_node_type cur_node_type,
+          const struct lys_module *local_mod, struct lyxp_set *set, int options)
+{
+    struct lyxp_expr *exp;
+    int rc;
+
+    if (!expr || !set) {
+        ly_errno = LY_EINVAL;
+        return EXIT_FAILURE;
+    }
+
+    exp = lyxp_compile_expr(expr);
+    if (!exp) {
+        return -1;
+    }
+
+    rc = lyxp_eval_compiled(exp, cur_node, cur_node_type, local_mod, set, options);
+
     lyxp_expr_free(exp);
     return rc;
 }
@@ -7688,7 +8162,7 @@ lyxp_atomize(const char *expr, const struct lys_node *cur_snode, enum lyxp_node_
     set->type = LYXP_SET_SNODE_SET;
     set_snode_insert_node(set, ctx_snode, ctx_snode_type);
 
-    rc = eval_expr(exp, &exp_idx, (struct lyd_node *)ctx_snode, lys_node_module(ctx_snode), set, options);
+    rc = eval_expr_start(exp, (struct lyd_node *)ctx_snode, lys_node_module(ctx_snode), set, options);
 
 finish:
     lyxp_expr_free(exp);
@@ -113,6 +113,8 @@ struct lyxp_expr {
     uint8_t *tok_len;        /* array of token lengths in expr */
     uint8_t **repeat;        /* array of the operator token indices that succeed this expression ended with 0,
                                 more in the comment after this declaration */
+    uint8_t *repeat_pop;     /* evaluation state - number of repeats already popped for each token, the parsed
+                                expression itself is never modified by an evaluation so it can be shared */
     uint16_t used;           /* used array items */
     uint16_t size;           /* allocated array items */
 
@@ -217,6 +219,38 @@ struct lyxp_set {
 int lyxp_eval(const char *expr, const struct lyd_node *cur_node, enum lyxp_node_type cur_node_type,
               const struct lys_module *local_mod, struct lyxp_set *set, int options);
 
+/**
+ * @brief Evaluate the already compiled XPath expression \p exp on data, see lyxp_eval() for the details.
+ *
+ * @param[in] exp Compiled XPath expression to evaluate, see lyxp_compile_expr().
+ * @param[in] cur_node Current (context) data node.
+ * @param[in] cur_node_type Current (context) data node type.
+ * @param[in] local_mod Local module relative to the \p exp.
+ * @param[out] set Result set.
+ * @param[in] options Whether to apply some evaluation restrictions.
+ *
+ * @return EXIT_SUCCESS on success, EXIT_FAILURE on unresolved when dependency, -1 on error.
+ */
+int lyxp_eval_compiled(struct lyxp_expr *exp, const struct lyd_node *cur_node, enum lyxp_node_type cur_node_type,
+                       const struct lys_module *local_mod, struct lyxp_set *set, int options);
+
+/**
+ * @brief Evaluate the XPath expression \p expr on data compiling it only once, the compiled expression is kept
+ * in \p cache (such as lys_when::cond_compiled) for all the following evaluations. See lyxp_eval() for the details.
+ *
+ * @param[in] expr XPath expression to evaluate.
+ * @param[in,out] cache Cache of the compiled \p expr, see lyxp_get_compiled_expr().
+ * @param[in] cur_node Current (context) data node.
+ * @param[in] cur_node_type Current (context) data node type.
+ * @param[in] local_mod Local module relative to the \p expr.
+ * @param[out] set Result set.
+ * @param[in] options Whether to apply some evaluation restrictions.
+ *
+ * @return EXIT_SUCCESS on success, EXIT_FAILURE on unresolved when dependency, -1 on error.
+ */
+int lyxp_eval_cached(const char *expr, void **cache, const struct lyd_node *cur_node, enum lyxp_node_type cur_node_type,
+                     const struct lys_module *local_mod, struct lyxp_set *set, int options);
+
 /**
  * @brief Get all the partial XPath nodes (atoms) that are required for \p expr to be evaluated.
  *
@@ -243,6 +277,7 @@ int lyxp_atomize(const char *expr, const struct lys_node *cur_snode, enum lyxp_n
 #define LYXP_SNODE_MUST 0x08
 #define LYXP_SNODE_WHEN 0x10
 #define LYXP_SNODE_OUTPUT 0x20
+#define LYXP_SNODE_ARGS 0x40     /* atomize also the arguments of all the functions */
 
 #define LYXP_SNODE_ALL 0x1C
 
@@ -303,6 +338,27 @@ void lyxp_set_free(struct lyxp_set *set);
  */
 struct lyxp_expr *lyxp_parse_expr(const char *expr);
 
+/**
+ * @brief Parse an XPath expression and check its syntax so that it is ready for (repeated) evaluation
+ *        using lyxp_eval_compiled(). Logs directly.
+ *
+ * @param[in] expr XPath expression to compile. It is duplicated.
+ *
+ * @return Compiled expression or NULL on error.
+ */
+struct lyxp_expr *lyxp_compile_expr(const char *expr);
+
+/**
+ * @brief Get the compiled XPath expression stored in a schema cache (such as lys_when::cond_compiled), compile
+ *        and store it there on its first use. Thread-safe, logs directly.
+ *
+ * @param[in] expr XPath expression to compile if not yet in \p cache.
+ * @param[in,out] cache Cache of the compiled \p expr, freed with the schema structure holding it.
+ *
+ * @return Compiled expression (do not free) or NULL on error.
+ */
+struct lyxp_expr *lyxp_get_compiled_expr(const char *expr, void **cache);
+
 /**
  * @brief Frees a parsed XPath expression. \p expr should not be used afterwards.
  *
@@ -204,12 +204,62 @@ test_lydict_remove(void **state)
     lydict_remove(ctx, str);
 }
 
+static void
+test_lydict_resize(void **state)
+{
+    (void) state; /* unused */
+    char buf[32];
+    const char **strings;
+    const char *str;
+    int i, count = 100000;
+
+    strings = malloc(count * sizeof *strings);
+    if (!strings) {
+        fail();
+    }
+
+    /* grow the dictionary well over its initial size */
+    for (i = 0; i < count; i++) {
+        sprintf(buf, "dict-value-%d", i);
+        strings[i] = lydict_insert(ctx, buf, 0);
+        assert_ptr_not_equal(strings[i], NULL);
+        assert_string_equal(strings[i], buf);
+    }
+
+    /* all the values must be found during and after the rehashing */
+    for (i = 0; i < count; i++) {
+        sprintf(buf, "dict-value-%d", i);
+        str = lydict_insert(ctx, buf, 0);
+        assert_ptr_equal(str, strings[i]);
+    }
+
+    /* remove the second references and then most of the values to shrink the dictionary */
+    for (i = 0; i < count; i++) {
+        lydict_remove(ctx, strings[i]);
+    }
+    for (i = 0; i < count - 10; i++) {
+        lydict_remove(ctx, strings[i]);
+    }
+
+    /* the remaining values must still be there */
+    for (i = count - 10; i < count; i++) {
+        sprintf(buf, "dict-value-%d", i);
+        str = lydict_insert(ctx, buf, 0);
+        assert_ptr_equal(str, strings[i]);
+        lydict_remove(ctx, str);
+        lydict_remove(ctx, str);
+    }
+
+    free(strings);
+}
+
 int main(void)
 {
     const struct CMUnitTest tests[] = {
         cmocka_unit_test_setup_teardown(test_lydict_insert, setup_f, teardown_f),
         cmocka_unit_test_setup_teardown(test_lydict_insert_zc, setup_f, teardown_f),
         cmocka_unit_test_setup_teardown(test_lydict_remove, setup_f, teardown_f),
+        cmocka_unit_test_setup_teardown(test_lydict_resize, setup_f, teardown_f),
     };
 
     return cmocka_run_group_tests(tests, NULL, NULL);
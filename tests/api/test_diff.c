@@ -345,7 +345,7 @@ test_move2(void **state)
 
     assert_int_equal(diff->type[0], LYD_DIFF_MOVEDAFTER1);
     assert_ptr_not_equal(diff->first[0], NULL);
-    assert_string_equal((str = lyd_path(diff->first[0])), "/defaults:df/llist[.='2']");
+    assert_string_equal((str = lyd_path(diff->first[0])), "/defaults:df/llist[.='3']");
     free(str);
     assert_ptr_not_equal(diff->second[0], NULL);
     assert_string_equal((str = lyd_path(diff->second[0])), "/defaults:df/llist[.='4']");
@@ -353,10 +353,10 @@ test_move2(void **state)
 
     assert_int_equal(diff->type[1], LYD_DIFF_MOVEDAFTER1);
     assert_ptr_not_equal(diff->first[1], NULL);
-    assert_string_equal((str = lyd_path(diff->first[1])), "/defaults:df/llist[.='4']");
+    assert_string_equal((str = lyd_path(diff->first[1])), "/defaults:df/llist[.='2']");
     free(str);
     assert_ptr_not_equal(diff->second[1], NULL);
-    assert_string_equal((str = lyd_path(diff->second[1])), "/defaults:df/llist[.='1']");
+    assert_string_equal((str = lyd_path(diff->second[1])), "/defaults:df/llist[.='3']");
     free(str);
 
     assert_int_equal(diff->type[2], LYD_DIFF_END);
@@ -404,6 +404,70 @@ test_move3(void **state)
     lyd_free_diff(diff);
 }
 
+static void
+test_move4(void **state)
+{
+    struct state *st = (*state);
+    char xml1[1024], xml2[1024], *str;
+    int i, len1, len2;
+    struct lyd_difflist *diff;
+
+    /* enough instances to be indexed, 1 moved behind 10, 20 deleted and 21 created */
+    len1 = sprintf(xml1, "<df xmlns=\"urn:libyang:tests:defaults\">");
+    len2 = sprintf(xml2, "<df xmlns=\"urn:libyang:tests:defaults\">");
+    for (i = 1; i <= 20; i++) {
+        len1 += sprintf(xml1 + len1, "<llist>%d</llist>", i);
+        if (i > 1 && i < 20) {
+            len2 += sprintf(xml2 + len2, "<llist>%d</llist>", i);
+        }
+        if (i == 10) {
+            len2 += sprintf(xml2 + len2, "<llist>1</llist>");
+        }
+    }
+    sprintf(xml1 + len1, "</df>");
+    sprintf(xml2 + len2, "<llist>21</llist></df>");
+
+    assert_ptr_not_equal((st->first = lyd_parse_mem(st->ctx, xml1, LYD_XML, LYD_OPT_CONFIG)), NULL);
+    assert_ptr_not_equal((st->second = lyd_parse_mem(st->ctx, xml2, LYD_XML, LYD_OPT_CONFIG)), NULL);
+
+    assert_ptr_not_equal((diff = lyd_diff(st->first, st->second, 0)), NULL);
+    assert_ptr_not_equal(diff->type, NULL);
+
+    assert_int_equal(diff->type[0], LYD_DIFF_DELETED);
+    assert_ptr_not_equal(diff->first[0], NULL);
+    assert_string_equal((str = lyd_path(diff->first[0])), "/defaults:df/llist[.='20']");
+    free(str);
+    assert_ptr_equal(diff->second[0], NULL);
+
+    assert_int_equal(diff->type[1], LYD_DIFF_MOVEDAFTER1);
+    assert_ptr_not_equal(diff->first[1], NULL);
+    assert_string_equal((str = lyd_path(diff->first[1])), "/defaults:df/llist[.='1']");
+    free(str);
+    assert_ptr_not_equal(diff->second[1], NULL);
+    assert_string_equal((str = lyd_path(diff->second[1])), "/defaults:df/llist[.='10']");
+    free(str);
+
+    assert_int_equal(diff->type[2], LYD_DIFF_CREATED);
+    assert_ptr_not_equal(diff->first[2], NULL);
+    assert_string_equal((str = lyd_path(diff->first[2])), "/defaults:df");
+    free(str);
+    assert_ptr_not_equal(diff->second[2], NULL);
+    assert_string_equal((str = lyd_path(diff->second[2])), "/defaults:df/llist[.='21']");
+    free(str);
+
+    assert_int_equal(diff->type[3], LYD_DIFF_MOVEDAFTER2);
+    assert_ptr_not_equal(diff->first[3], NULL);
+    assert_string_equal((str = lyd_path(diff->first[3])), "/defaults:df/llist[.='19']");
+    free(str);
+    assert_ptr_not_equal(diff->second[3], NULL);
+    assert_string_equal((str = lyd_path(diff->second[3])), "/defaults:df/llist[.='21']");
+    free(str);
+
+    assert_int_equal(diff->type[4], LYD_DIFF_END);
+
+    lyd_free_diff(diff);
+}
+
 static void
 test_mix1(void **state)
 {
@@ -572,6 +636,7 @@ int main(void)
                     cmocka_unit_test_setup_teardown(test_move1, setup_f, teardown_f),
                     cmocka_unit_test_setup_teardown(test_move2, setup_f, teardown_f),
                     cmocka_unit_test_setup_teardown(test_move3, setup_f, teardown_f),
+                    cmocka_unit_test_setup_teardown(test_move4, setup_f, teardown_f),
                     cmocka_unit_test_setup_teardown(test_mix1, setup_f, teardown_f),
                     cmocka_unit_test_setup_teardown(test_mix2, setup_f, teardown_f),
                     cmocka_unit_test_setup_teardown(test_wd1, setup_f, teardown_f), };
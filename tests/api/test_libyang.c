@@ -233,6 +233,66 @@ test_ly_ctx_set_searchdir(void **state)
     ly_ctx_destroy(ctx, NULL);
 }
 
+static void
+write_module(const char *dir, const char *file, const char *name, const char *revision)
+{
+    char path[PATH_MAX];
+    FILE *f;
+
+    sprintf(path, "%s/%s", dir, file);
+    f = fopen(path, "w");
+    assert_ptr_not_equal(f, NULL);
+    fprintf(f, "module %s { namespace urn:%s; prefix p; revision %s; }", name, name, revision);
+    fclose(f);
+}
+
+static void
+test_ly_ctx_refresh_searchdirs(void **state)
+{
+    const struct lys_module *mod;
+    char dir[] = "/tmp/libyang-searchdir-XXXXXX", path[PATH_MAX];
+    const char *files[] = {"a@2017-01-01.yang", "b@2017-01-01.yang", "b@2018-01-01.yang", "c@2018-01-01.yang", NULL};
+    int i;
+    (void) state; /* unused */
+
+    assert_ptr_not_equal(mkdtemp(dir), NULL);
+    write_module(dir, files[0], "a", "2017-01-01");
+    write_module(dir, files[1], "b", "2017-01-01");
+
+    ctx = ly_ctx_new(dir);
+    assert_ptr_not_equal(ctx, NULL);
+    mod = ly_ctx_load_module(ctx, "a", NULL);
+    assert_ptr_not_equal(mod, NULL);
+
+    /* the files added later are found even though the directory was already indexed */
+    write_module(dir, files[3], "c", "2018-01-01");
+    mod = ly_ctx_load_module(ctx, "c", NULL);
+    assert_ptr_not_equal(mod, NULL);
+    write_module(dir, files[2], "b", "2018-01-01");
+    mod = ly_ctx_load_module(ctx, "b", "2018-01-01");
+    assert_ptr_not_equal(mod, NULL);
+    assert_string_equal(mod->rev[0].date, "2018-01-01");
+    ly_ctx_destroy(ctx, NULL);
+
+    /* a new revision of an indexed module is found after refreshing */
+    sprintf(path, "%s/%s", dir, files[2]);
+    unlink(path);
+    ctx = ly_ctx_new(dir);
+    assert_ptr_not_equal(ctx, NULL);
+    assert_ptr_not_equal(ly_ctx_load_module(ctx, "a", NULL), NULL);
+    write_module(dir, files[2], "b", "2018-01-01");
+    ly_ctx_refresh_searchdirs(ctx);
+    mod = ly_ctx_load_module(ctx, "b", NULL);
+    assert_ptr_not_equal(mod, NULL);
+    assert_string_equal(mod->rev[0].date, "2018-01-01");
+
+    for (i = 0; files[i]; i++) {
+        sprintf(path, "%s/%s", dir, files[i]);
+        unlink(path);
+    }
+    rmdir(dir);
+}
+
 static void
 test_ly_ctx_set_searchdir_invalid(void **state)
 {
@@ -554,6 +614,8 @@ test_ly_ctx_remove_module(void **state)
     setid = ctx->models.module_set_id;
     assert_int_equal(modules_count, ctx->models.used);
     assert_int_equal(dict_used, ctx->dict.used);
+    assert_ptr_equal(ly_ctx_get_module(ctx, "x", NULL), NULL);
+    assert_ptr_equal(ly_ctx_get_module(ctx, "y", NULL), NULL);
 
     /* add a module again ... */
     mod = ly_ctx_load_module(ctx, "y", NULL);
@@ -562,6 +624,8 @@ test_ly_ctx_remove_module(void **state)
     setid = ctx->models.module_set_id;
     assert_int_equal(modules_count + 2, ctx->models.used);
     assert_int_not_equal(dict_used, ctx->dict.used);
+    assert_ptr_equal(ly_ctx_get_module(ctx, "y", NULL), mod);
+    assert_ptr_equal(ly_ctx_get_module_by_ns(ctx, mod->ns, NULL), mod);
     /* ... now remove the loaded module, the imported module is supposed to be removed because it is not
      * used in any other module */
     ly_ctx_remove_module(mod, NULL);
@@ -585,7 +649,10 @@ test_ly_ctx_remove_module(void **state)
     setid = ctx->models.module_set_id;
     assert_int_equal(modules_count + 1, ctx->models.used);
     assert_int_not_equal(dict_used, ctx->dict.used);
+    assert_ptr_equal(ly_ctx_get_module(ctx, "y", NULL), NULL);
+    assert_ptr_not_equal(ly_ctx_get_module(ctx, "x", NULL), NULL);
     ly_ctx_clean(ctx, NULL);
+    assert_ptr_equal(ly_ctx_get_module(ctx, "x", NULL), NULL);
 
     /* add a module again ... */
     mod = ly_ctx_load_module(ctx, "y", NULL);
@@ -644,6 +711,7 @@ test_ly_ctx_remove_module2(void **state)
     mod = ly_ctx_get_module(ctx, "y", NULL);
     assert_ptr_not_equal(mod, NULL);
     assert_int_equal(ly_ctx_remove_module(mod, NULL), 0);
+    assert_ptr_equal(ly_ctx_get_module_by_ns(ctx, "uri:y", NULL), NULL);
 
     /* ... make sure that x is still present ... */
     mod = ly_ctx_get_module(ctx, "x", NULL);
@@ -999,6 +1067,71 @@ test_ly_set_rm_index(void **state)
     ly_set_free(set);
 }
 
+static void
+test_ly_set_index(void **state)
+{
+    (void) state; /* unused */
+    struct ly_set *set, *dup, stack;
+    char objs[1000];
+    int i;
+
+    set = ly_set_new();
+    if (!set) {
+        fail();
+    }
+
+    /* big enough to be indexed */
+    for (i = 0; i < 1000; i++) {
+        assert_int_equal(ly_set_add(set, &objs[i], 0), i);
+    }
+    for (i = 0; i < 1000; i++) {
+        assert_int_equal(ly_set_add(set, &objs[i], 0), i);
+        assert_int_equal(ly_set_contains(set, &objs[i]), i);
+    }
+    assert_int_equal(set->number, 1000);
+
+    /* the last object is moved to the removed one */
+    assert_int_equal(ly_set_rm(set, &objs[10]), 0);
+    assert_int_equal(ly_set_rm_index(set, 20), 0);
+    assert_int_equal(ly_set_rm_index(set, set->number - 1), 0);
+    assert_int_equal(set->number, 997);
+    assert_int_equal(ly_set_contains(set, &objs[10]), -1);
+    assert_int_equal(ly_set_contains(set, &objs[20]), -1);
+    assert_int_equal(ly_set_contains(set, &objs[997]), -1);
+    assert_int_equal(ly_set_contains(set, &objs[999]), 10);
+    assert_int_equal(ly_set_contains(set, &objs[998]), 20);
+    assert_int_equal(ly_set_add(set, &objs[997], 0), 997);
+
+    dup = ly_set_dup(set);
+    if (!dup) {
+        fail();
+    }
+    assert_int_equal(dup->number, 998);
+    for (i = 0; i < 998; i++) {
+        assert_int_equal(ly_set_contains(dup, dup->set.g[i]), i);
+    }
+    ly_set_free(dup);
+
+    assert_int_equal(ly_set_clean(set), 0);
+    assert_int_equal(ly_set_contains(set, &objs[0]), -1);
+    assert_int_equal(ly_set_add(set, &objs[0], 0), 0);
+    assert_int_equal(ly_set_add(set, &objs[0], LY_SET_OPT_USEASLIST), 1);
+    assert_int_equal(set->number, 2);
+
+    ly_set_free(set);
+
+    /* set not allocated by ly_set_new() is searched linearly and its array can be freed directly */
+    memset(&stack, 0, sizeof stack);
+    for (i = 0; i < 1000; i++) {
+        assert_int_equal(ly_set_add(&stack, &objs[i], 0), i);
+    }
+    assert_int_equal(ly_set_add(&stack, &objs[500], 0), 500);
+    assert_int_equal(ly_set_contains(&stack, &objs[500]), 500);
+    assert_int_equal(ly_set_rm(&stack, &objs[500]), 0);
+    assert_int_equal(ly_set_contains(&stack, &objs[999]), 500);
+    free(stack.set.g);
+}
+
 static void
 test_ly_set_free(void **state)
 {
@@ -1119,6 +1252,7 @@ int main(void)
         cmocka_unit_test(test_ly_ctx_get_searchdir),
         cmocka_unit_test(test_ly_ctx_set_searchdir),
         cmocka_unit_test(test_ly_ctx_set_searchdir_invalid),
+        cmocka_unit_test_teardown(test_ly_ctx_refresh_searchdirs, teardown_f),
         cmocka_unit_test_setup_teardown(test_ly_ctx_info, setup_f, teardown_f),
         cmocka_unit_test_setup_teardown(test_ly_ctx_get_module, setup_f, teardown_f),
         cmocka_unit_test_setup_teardown(test_ly_ctx_get_module_older, setup_f, teardown_f),
@@ -1137,6 +1271,7 @@ int main(void)
         cmocka_unit_test_setup_teardown(test_ly_set_add, setup_f, teardown_f),
         cmocka_unit_test_setup_teardown(test_ly_set_rm, setup_f, teardown_f),
         cmocka_unit_test_setup_teardown(test_ly_set_rm_index, setup_f, teardown_f),
+        cmocka_unit_test_setup_teardown(test_ly_set_index, setup_f, teardown_f),
         cmocka_unit_test_setup_teardown(test_ly_set_free, setup_f, teardown_f),
         cmocka_unit_test(test_ly_verb),
         cmocka_unit_test(test_ly_get_log_clb),
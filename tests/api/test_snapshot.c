@@ -0,0 +1,403 @@
+/**
+ * @file test_snapshot.c
+ * @brief Cmocka tests for the schema snapshots of contexts.
+ *
+ * Copyright (c) 2017 CESNET, z.s.p.o.
+ *
+ * This source code is licensed under BSD 3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/BSD-3-Clause
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include "../config.h"
+#include "../../src/libyang.h"
+
+struct state {
+    struct ly_ctx *ctx;
+    struct ly_ctx *snap;
+    char *data;
+    size_t size;
+    struct lyd_node *dt1;
+    struct lyd_node *dt2;
+    char *str1;
+    char *str2;
+};
+
+static const char *schema_snap =
+"module snap {\n"
+"  yang-version 1.1;\n"
+"  namespace \"urn:snap\";\n"
+"  prefix s;\n"
+"  import ext-def { prefix e; }\n"
+"  feature f1;\n"
+"  feature f2 { if-feature \"f1 and not f3\"; }\n"
+"  feature f3;\n"
+"  identity base;\n"
+"  identity id1 { base base; }\n"
+"  identity id2 { base id1; if-feature f1; }\n"
+"  typedef percent { type decimal64 { fraction-digits 2; range \"0..100\"; } units \"%\"; default \"1.5\"; }\n"
+"  typedef name { type string { length \"1..32\"; pattern \"[a-z][a-z0-9]*\"; } }\n"
+"  typedef mixed {\n"
+"    type union {\n"
+"      type int8 { range \"-10..10\"; }\n"
+"      type enumeration { enum one { value 1; } enum two { if-feature f1; } }\n"
+"      type bits { bit b0; bit b1 { position 5; } }\n"
+"      type identityref { base base; }\n"
+"    }\n"
+"  }\n"
+"  grouping item {\n"
+"    leaf name { type name; }\n"
+"    leaf value { type mixed; }\n"
+"    container opts { leaf p { type percent; } }\n"
+"  }\n"
+"  container top {\n"
+"    e:a;\n"
+"    e:b \"top\";\n"
+"    list item {\n"
+"      key name;\n"
+"      unique \"value\";\n"
+"      ordered-by user;\n"
+"      uses item {\n"
+"        refine opts { presence \"refined\"; description \"refined opts\"; }\n"
+"        refine value { must \". != 'two'\"; }\n"
+"        augment opts { leaf extra { type string; default \"x\"; } }\n"
+"      }\n"
+"      action reset {\n"
+"        input { leaf delay { type uint16; } }\n"
+"        output { leaf done { type boolean; } }\n"
+"      }\n"
+"    }\n"
+"    leaf ref { type leafref { path \"../item/name\"; } }\n"
+"    leaf-list tags { type string; default \"a\"; default \"b\"; }\n"
+"    choice ch {\n"
+"      default c1;\n"
+"      case c1 { leaf c1 { type boolean; default true; } }\n"
+"      leaf c2 { type instance-identifier; }\n"
+"      anyxml any;\n"
+"    }\n"
+"    leaf feat { if-feature \"f1 or f2\"; type uint64; when \"../ref\"; }\n"
+"    leaf dev { type string; must \". != 'no'\"; }\n"
+"  }\n"
+"  augment \"/s:top/s:ch\" { case c3 { leaf c3 { type binary { length \"1..8\"; } } } }\n"
+"  rpc run { input { leaf cmd { type string; mandatory true; } } }\n"
+"  notification done { leaf status { type int32; } }\n"
+"  anydata blob;\n"
+"  e:complex {\n"
+"    description \"complex\";\n"
+"    max-elements 2;\n"
+"    unique \"e\";\n"
+"    leaf e { type string; }\n"
+"    type string;\n"
+"    must \"1\";\n"
+"    when \"1\";\n"
+"  }\n"
+"}\n";
+
+static const char *schema_snap_dev =
+"module snap-dev {\n"
+"  namespace \"urn:snap-dev\";\n"
+"  prefix sd;\n"
+"  import snap { prefix s; }\n"
+"  deviation /s:top/s:tags { deviate replace { type string { length \"1..5\"; } } }\n"
+"  deviation /s:blob { deviate not-supported; }\n"
+"  deviation /s:top/s:dev { deviate delete { must \". != 'no'\"; } }\n"
+"  deviation /s:top/s:dev { deviate add { default \"yes\"; } }\n"
+"}\n";
+
+static const char *schema_snap_off =
+"module snap-off {\n"
+"  namespace \"urn:snap-off\";\n"
+"  prefix so;\n"
+"  leaf off { type string; }\n"
+"}\n";
+
+static const char *data_snap =
+"<top xmlns=\"urn:snap\">"
+"<item><name>a</name><value>one</value><opts><p>2.5</p></opts></item>"
+"<item><name>b1</name><value xmlns:s=\"urn:snap\">s:id2</value></item>"
+"<item><name>c</name><value>b0 b1</value></item>"
+"<ref>b1</ref><tags>x</tags><c3>aGVsbG8=</c3><feat>5</feat>"
+"</top>";
+
+static const char *data_ietf =
+"<interfaces xmlns=\"urn:ietf:params:xml:ns:yang:ietf-interfaces\">"
+"<interface><name>eth0</name><type xmlns:ianaift=\"urn:ietf:params:xml:ns:yang:iana-if-type\">ianaift:ethernetCsmacd</type>"
+"<ipv4 xmlns=\"urn:ietf:params:xml:ns:yang:ietf-ip\"><address><ip>192.168.0.1</ip><prefix-length>24</prefix-length></address></ipv4>"
+"</interface></interfaces>"
+"<system xmlns=\"urn:ietf:params:xml:ns:yang:ietf-system\"><hostname>snap</hostname>"
+"<authentication><user><name>admin</name></user></authentication></system>";
+
+static int
+setup_f(void **state)
+{
+    struct state *st;
+    const struct lys_module *mod;
+
+    (*state) = st = calloc(1, sizeof *st);
+    if (!st) {
+        fprintf(stderr, "Memory allocation error");
+        return -1;
+    }
+
+    /* libyang context */
+    st->ctx = ly_ctx_new(TESTS_DIR"/schema/yang/ietf");
+    if (!st->ctx) {
+        fprintf(stderr, "Failed to create context.\n");
+        goto error;
+    }
+    ly_ctx_set_searchdir(st->ctx, TESTS_DIR"/schema/yang/files");
+    ly_ctx_set_searchdir(st->ctx, TESTS_DIR"/data/files");
+
+    /* schemas with submodules, groupings, augments, identities, features, leafrefs and inherited extensions */
+    if (!ly_ctx_load_module(st->ctx, "ietf-ip", NULL) || !ly_ctx_load_module(st->ctx, "ietf-system", NULL)
+            || !ly_ctx_load_module(st->ctx, "ietf-snmp", NULL) || !ly_ctx_load_module(st->ctx, "ietf-ipfix-psamp", NULL)
+            || !ly_ctx_load_module(st->ctx, "ietf-netconf", NULL)
+            || !ly_ctx_load_module(st->ctx, "iana-if-type", NULL)) {
+        fprintf(stderr, "Failed to load the ietf modules.\n");
+        goto error;
+    }
+    lys_features_enable(ly_ctx_get_module(st->ctx, "ietf-system", NULL), "*");
+
+    /* all the kinds of types and statements */
+    mod = lys_parse_path(st->ctx, TESTS_DIR"/data/files/all.yang", LYS_IN_YANG);
+    if (!mod) {
+        fprintf(stderr, "Failed to load data model \"all\".\n");
+        goto error;
+    }
+    lys_features_enable(mod, "*");
+
+    /* deviations, extension instances and nodes of all the kinds */
+    mod = lys_parse_mem(st->ctx, schema_snap, LYS_IN_YANG);
+    if (!mod || !lys_parse_mem(st->ctx, schema_snap_dev, LYS_IN_YANG)) {
+        fprintf(stderr, "Failed to load data model \"snap\".\n");
+        goto error;
+    }
+    lys_features_enable(mod, "f1");
+
+    /* disabled module */
+    mod = lys_parse_mem(st->ctx, schema_snap_off, LYS_IN_YANG);
+    if (!mod || lys_set_disabled(mod)) {
+        fprintf(stderr, "Failed to load data model \"snap-off\".\n");
+        goto error;
+    }
+
+    return 0;
+
+error:
+    ly_ctx_destroy(st->ctx, NULL);
+    free(st);
+    (*state) = NULL;
+
+    return -1;
+}
+
+static int
+teardown_f(void **state)
+{
+    struct state *st = (*state);
+
+    lyd_free_withsiblings(st->dt1);
+    lyd_free_withsiblings(st->dt2);
+    free(st->str1);
+    free(st->str2);
+    free(st->data);
+    ly_ctx_destroy(st->snap, NULL);
+    ly_ctx_destroy(st->ctx, NULL);
+    free(st);
+    (*state) = NULL;
+
+    return 0;
+}
+
+static void
+compare_module(struct state *st, const struct lys_module *mod1, const struct lys_module *mod2)
+{
+    LYS_OUTFORMAT formats[] = {LYS_OUT_YANG, LYS_OUT_YIN, LYS_OUT_TREE, LYS_OUT_INFO};
+    unsigned int i;
+
+    assert_ptr_not_equal(mod2, NULL);
+    assert_ptr_not_equal(mod1, mod2);
+    assert_string_equal(mod1->name, mod2->name);
+    assert_int_equal(mod1->implemented, mod2->implemented);
+    assert_int_equal(mod1->disabled, mod2->disabled);
+    assert_int_equal(mod1->deviated, mod2->deviated);
+
+    for (i = 0; i < sizeof formats / sizeof *formats; ++i) {
+        assert_int_equal(lys_print_mem(&st->str1, mod1, formats[i], NULL), 0);
+        assert_int_equal(lys_print_mem(&st->str2, mod2, formats[i], NULL), 0);
+        assert_string_equal(st->str1, st->str2);
+        free(st->str1);
+        st->str1 = NULL;
+        free(st->str2);
+        st->str2 = NULL;
+    }
+}
+
+static void
+compare_ctx(struct state *st)
+{
+    const struct lys_module *mod;
+    uint32_t idx1 = 0, idx2 = 0, count = 0;
+
+    while ((mod = ly_ctx_get_module_iter(st->ctx, &idx1))) {
+        compare_module(st, mod, ly_ctx_get_module_iter(st->snap, &idx2));
+        ++count;
+    }
+    assert_ptr_equal(ly_ctx_get_module_iter(st->snap, &idx2), NULL);
+    assert_int_not_equal(count, 0);
+
+    idx1 = idx2 = 0;
+    count = 0;
+    while ((mod = ly_ctx_get_disabled_module_iter(st->ctx, &idx1))) {
+        compare_module(st, mod, ly_ctx_get_disabled_module_iter(st->snap, &idx2));
+        ++count;
+    }
+    assert_ptr_equal(ly_ctx_get_disabled_module_iter(st->snap, &idx2), NULL);
+    assert_int_not_equal(count, 0);
+
+    /* yang library data, including the module-set-id */
+    st->dt1 = ly_ctx_info(st->ctx);
+    st->dt2 = ly_ctx_info(st->snap);
+    assert_ptr_not_equal(st->dt1, NULL);
+    assert_ptr_not_equal(st->dt2, NULL);
+    lyd_print_mem(&st->str1, st->dt1, LYD_XML, LYP_WITHSIBLINGS);
+    lyd_print_mem(&st->str2, st->dt2, LYD_XML, LYP_WITHSIBLINGS);
+    assert_string_equal(st->str1, st->str2);
+    free(st->str1);
+    st->str1 = NULL;
+    free(st->str2);
+    st->str2 = NULL;
+    lyd_free_withsiblings(st->dt1);
+    st->dt1 = NULL;
+    lyd_free_withsiblings(st->dt2);
+    st->dt2 = NULL;
+}
+
+static void
+compare_data(struct state *st, const char *data)
+{
+    st->dt1 = lyd_parse_mem(st->ctx, data, LYD_XML, LYD_OPT_CONFIG);
+    st->dt2 = lyd_parse_mem(st->snap, data, LYD_XML, LYD_OPT_CONFIG);
+    assert_ptr_not_equal(st->dt1, NULL);
+    assert_ptr_not_equal(st->dt2, NULL);
+
+    lyd_print_mem(&st->str1, st->dt1, LYD_JSON, LYP_WITHSIBLINGS | LYP_WD_ALL);
+    lyd_print_mem(&st->str2, st->dt2, LYD_JSON, LYP_WITHSIBLINGS | LYP_WD_ALL);
+    assert_string_equal(st->str1, st->str2);
+
+    free(st->str1);
+    st->str1 = NULL;
+    free(st->str2);
+    st->str2 = NULL;
+    lyd_free_withsiblings(st->dt1);
+    st->dt1 = NULL;
+    lyd_free_withsiblings(st->dt2);
+    st->dt2 = NULL;
+}
+
+static void
+test_snapshot_mem(void **state)
+{
+    struct state *st = (*state);
+    const struct lys_module *mod;
+
+    assert_int_equal(ly_ctx_print_snapshot_mem(st->ctx, &st->data, &st->size), 0);
+    assert_ptr_not_equal(st->data, NULL);
+
+    st->snap = ly_ctx_new_snapshot_mem(TESTS_DIR"/schema/yang/ietf", st->data, st->size, 0);
+    assert_ptr_not_equal(st->snap, NULL);
+    compare_ctx(st);
+
+    /* the same data are accepted and rejected by both the contexts (without "all" requiring its data) */
+    assert_int_equal(lys_set_disabled(ly_ctx_get_module(st->ctx, "all", NULL)), 0);
+    assert_int_equal(lys_set_disabled(ly_ctx_get_module(st->snap, "all", NULL)), 0);
+    compare_data(st, data_ietf);
+    compare_data(st, data_snap);
+    assert_ptr_equal(lyd_parse_mem(st->snap, "<top xmlns=\"urn:snap\"><tags>toolong</tags></top>", LYD_XML,
+                                   LYD_OPT_CONFIG), NULL);
+    assert_ptr_equal(lyd_parse_mem(st->snap, "<top xmlns=\"urn:snap\"><item><name>1a</name></item></top>", LYD_XML,
+                                   LYD_OPT_CONFIG), NULL);
+
+    /* the loaded context can be changed as usual */
+    mod = ly_ctx_get_module(st->snap, "snap", NULL);
+    assert_ptr_not_equal(mod, NULL);
+    assert_int_equal(lys_features_state(mod, "f1"), 1);
+    assert_int_equal(lys_features_state(mod, "f2"), 0);
+    assert_int_equal(lys_features_disable(mod, "f1"), 0);
+    assert_ptr_equal(lyd_parse_mem(st->snap, data_snap, LYD_XML, LYD_OPT_CONFIG), NULL);
+    assert_ptr_not_equal(ly_ctx_load_module(st->snap, "ietf-netconf-monitoring", NULL), NULL);
+    ly_ctx_clean(st->snap, NULL);
+}
+
+static void
+test_snapshot_path(void **state)
+{
+    struct state *st = (*state);
+    char path[] = "/tmp/libyang-snapshot-XXXXXX";
+    int fd;
+
+    fd = mkstemp(path);
+    assert_int_not_equal(fd, -1);
+    close(fd);
+
+    assert_int_equal(ly_ctx_print_snapshot_path(st->ctx, path), 0);
+    st->snap = ly_ctx_new_snapshot_path(TESTS_DIR"/schema/yang/ietf", path, 0);
+    unlink(path);
+    assert_ptr_not_equal(st->snap, NULL);
+    compare_ctx(st);
+
+    /* snapshot of a loaded snapshot */
+    ly_ctx_destroy(st->ctx, NULL);
+    st->ctx = st->snap;
+    assert_int_equal(ly_ctx_print_snapshot_mem(st->ctx, &st->data, &st->size), 0);
+    st->snap = ly_ctx_new_snapshot_mem(NULL, st->data, st->size, 0);
+    assert_ptr_not_equal(st->snap, NULL);
+    compare_ctx(st);
+    assert_int_equal(lys_set_disabled(ly_ctx_get_module(st->ctx, "all", NULL)), 0);
+    assert_int_equal(lys_set_disabled(ly_ctx_get_module(st->snap, "all", NULL)), 0);
+    compare_data(st, data_snap);
+}
+
+static void
+test_snapshot_invalid(void **state)
+{
+    struct state *st = (*state);
+
+    assert_int_equal(ly_ctx_print_snapshot_mem(st->ctx, &st->data, &st->size), 0);
+
+    /* truncated */
+    assert_ptr_equal(ly_ctx_new_snapshot_mem(NULL, st->data, st->size - 1, 0), NULL);
+    assert_ptr_equal(ly_ctx_new_snapshot_mem(NULL, st->data, 10, 0), NULL);
+
+    /* wrong version and pointer size */
+    ++st->data[3];
+    assert_ptr_equal(ly_ctx_new_snapshot_mem(NULL, st->data, st->size, 0), NULL);
+    --st->data[3];
+    st->data[8] = ~st->data[8];
+    assert_ptr_equal(ly_ctx_new_snapshot_mem(NULL, st->data, st->size, 0), NULL);
+    st->data[8] = ~st->data[8];
+
+    /* wrong magic */
+    st->data[0] = 'x';
+    assert_ptr_equal(ly_ctx_new_snapshot_mem(NULL, st->data, st->size, 0), NULL);
+    assert_ptr_equal(ly_ctx_new_snapshot_path(NULL, TESTS_DIR"/data/files/all.yang", 0), NULL);
+}
+
+int main(void)
+{
+    const struct CMUnitTest tests[] = {
+                    cmocka_unit_test_setup_teardown(test_snapshot_mem, setup_f, teardown_f),
+                    cmocka_unit_test_setup_teardown(test_snapshot_path, setup_f, teardown_f),
+                    cmocka_unit_test_setup_teardown(test_snapshot_invalid, setup_f, teardown_f), };
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
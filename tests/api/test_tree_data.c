@@ -23,6 +23,8 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <fcntl.h>
+#include <errno.h>
+#include <signal.h>
 #include <sys/mman.h>
 #include <unistd.h>
 #include <string.h>
@@ -872,6 +874,70 @@ test_lyd_schema_sort(void **state)
     lyd_free_withsiblings(root);
 }
 
+static void
+test_lyd_schema_sort_modules(void **state)
+{
+    (void) state; /* unused */
+    const char *base = "module pos-base {namespace urn:pos-base; prefix pb;"
+                       "container c {leaf a {type string;} leaf z {type string;}}}";
+    const char *aug1 = "module pos-aug {namespace urn:pos-aug; prefix pa; import pos-base {prefix pb;}"
+                       "augment /pb:c {leaf p {type string;} leaf q {type string;}}}";
+    const char *aug2 = "module pos-aug {namespace urn:pos-aug; prefix pa; import pos-base {prefix pb;}"
+                       "augment /pb:c {leaf q {type string;} leaf p {type string;}}}";
+    const struct lys_module *mod_base, *mod_aug;
+    struct lyd_node *cont, *node;
+
+    mod_base = lys_parse_mem(ctx, base, LYS_IN_YANG);
+    assert_non_null(mod_base);
+
+    /* the augment nodes follow the nodes of the augmented module */
+    mod_aug = lys_parse_mem(ctx, aug1, LYS_IN_YANG);
+    assert_non_null(mod_aug);
+    cont = lyd_new(NULL, mod_base, "c");
+    assert_non_null(cont);
+    assert_non_null(lyd_new_leaf(cont, mod_aug, "q", "q"));
+    assert_non_null(lyd_new_leaf(cont, NULL, "z", "z"));
+    assert_non_null(lyd_new_leaf(cont, mod_aug, "p", "p"));
+    assert_non_null(lyd_new_leaf(cont, NULL, "a", "a"));
+    assert_int_equal(lyd_schema_sort(cont, 1), 0);
+    node = cont->child;
+    assert_string_equal(node->schema->name, "a");
+    assert_string_equal(node->next->schema->name, "z");
+    assert_string_equal(node->next->next->schema->name, "p");
+    assert_string_equal(node->next->next->next->schema->name, "q");
+    lyd_free(cont);
+
+    /* the positions of the new augment nodes are not taken from the removed module */
+    assert_int_equal(ly_ctx_remove_module(mod_aug, NULL), 0);
+    mod_aug = lys_parse_mem(ctx, aug2, LYS_IN_YANG);
+    assert_non_null(mod_aug);
+    cont = lyd_new(NULL, mod_base, "c");
+    assert_non_null(cont);
+    assert_non_null(lyd_new_leaf(cont, mod_aug, "p", "p"));
+    assert_non_null(lyd_new_leaf(cont, NULL, "z", "z"));
+    assert_non_null(lyd_new_leaf(cont, mod_aug, "q", "q"));
+    assert_non_null(lyd_new_leaf(cont, NULL, "a", "a"));
+    assert_int_equal(lyd_schema_sort(cont, 1), 0);
+    node = cont->child;
+    assert_string_equal(node->schema->name, "a");
+    assert_string_equal(node->next->schema->name, "z");
+    assert_string_equal(node->next->next->schema->name, "q");
+    assert_string_equal(node->next->next->next->schema->name, "p");
+    lyd_free(cont);
+
+    assert_int_equal(ly_ctx_remove_module(mod_aug, NULL), 0);
+    cont = lyd_new(NULL, mod_base, "c");
+    assert_non_null(cont);
+    assert_non_null(lyd_new_leaf(cont, NULL, "z", "z"));
+    assert_non_null(lyd_new_leaf(cont, NULL, "a", "a"));
+    assert_int_equal(lyd_schema_sort(cont, 1), 0);
+    node = cont->child;
+    assert_string_equal(node->schema->name, "a");
+    assert_string_equal(node->next->schema->name, "z");
+    assert_null(node->next->next);
+    lyd_free(cont);
+}
+
 static void
 test_lyd_find_xpath(void **state)
 {
@@ -1486,6 +1552,37 @@ test_lyd_print_clb_json(void **state)
     free(buf);
 }
 
+static ssize_t
+failing_lyd_print_clb(void *arg, const void *buf, size_t count)
+{
+    (void)arg;
+    (void)buf;
+    (void)count;
+
+    errno = ENOSPC;
+    return -1;
+}
+
+static void
+test_lyd_print_clb_fail(void **state)
+{
+    (void) state; /* unused */
+    int fd[2];
+
+    /* the data are small enough to be written only by the final flush */
+    assert_int_not_equal(lyd_print_clb(failing_lyd_print_clb, NULL, root, LYD_XML, 0), 0);
+    assert_int_equal(ly_errno, LY_ESYS);
+    assert_int_not_equal(lyd_print_clb(failing_lyd_print_clb, NULL, root, LYD_JSON, LYP_FORMAT), 0);
+
+    /* nobody reads the pipe */
+    assert_int_equal(pipe(fd), 0);
+    close(fd[0]);
+    signal(SIGPIPE, SIG_IGN);
+    assert_int_not_equal(lyd_print_fd(fd[1], root, LYD_XML, 0), 0);
+    close(fd[1]);
+    signal(SIGPIPE, SIG_DFL);
+}
+
 static void
 test_lyd_path(void **state)
 {
@@ -1577,6 +1674,7 @@ int main(void)
         cmocka_unit_test_setup_teardown(test_lyd_insert_before, setup_f, teardown_f),
         cmocka_unit_test_setup_teardown(test_lyd_insert_after, setup_f, teardown_f),
         cmocka_unit_test_setup_teardown(test_lyd_schema_sort, setup_f, teardown_f),
+        cmocka_unit_test_setup_teardown(test_lyd_schema_sort_modules, setup_f, teardown_f),
         cmocka_unit_test_setup_teardown(test_lyd_find_xpath, setup_f, teardown_f),
         cmocka_unit_test_setup_teardown(test_lyd_find_instance, setup_f, teardown_f),
         cmocka_unit_test_setup_teardown(test_lyd_validate, setup_f, teardown_f),
@@ -1597,6 +1695,7 @@ int main(void)
         cmocka_unit_test_setup_teardown(test_lyd_print_clb_xml, setup_f, teardown_f),
         cmocka_unit_test_setup_teardown(test_lyd_print_clb_xml_format, setup_f, teardown_f),
         cmocka_unit_test_setup_teardown(test_lyd_print_clb_json, setup_f, teardown_f),
+        cmocka_unit_test_setup_teardown(test_lyd_print_clb_fail, setup_f, teardown_f),
         cmocka_unit_test_setup_teardown(test_lyd_path, setup_f, teardown_f),
         cmocka_unit_test_setup_teardown(test_lyd_qualified_path, setup_f, teardown_f),
         cmocka_unit_test_setup_teardown(test_lyd_leaf_type, setup_f2, teardown_f2),
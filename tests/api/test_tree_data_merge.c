@@ -308,6 +308,72 @@ test_merge4(void **state)
     free(printed);
 }
 
+static void
+test_merge_toplevel(void **state)
+{
+    struct state *st = (*state);
+    const char *sch =
+        "module T {"
+            "namespace \"urn:T\";"
+            "prefix T;"
+            "list item {"
+                "key name;"
+                "leaf name {type string;}"
+                "leaf value {type string;}"
+            "}"
+            "leaf-list num {type uint32;}"
+        "}";
+    struct lyd_node *iter;
+    struct ly_set *set;
+    char trg[2048], src[2048];
+    int i, trg_len = 0, src_len = 0, count = 0;
+
+    assert_ptr_not_equal(lys_parse_mem(st->ctx1, sch, LYS_IN_YANG), NULL);
+
+    /* enough top-level siblings to be indexed, half of the source ones are in the target */
+    for (i = 0; i < 20; i++) {
+        trg_len += sprintf(trg + trg_len, "<item xmlns=\"urn:T\"><name>i%d</name><value>t</value></item>"
+                           "<num xmlns=\"urn:T\">%d</num>", i, i);
+        src_len += sprintf(src + src_len, "<item xmlns=\"urn:T\"><name>i%d</name><value>s</value></item>"
+                           "<num xmlns=\"urn:T\">%d</num>", i + 10, i + 10);
+    }
+
+    st->source = lyd_parse_mem(st->ctx1, src, LYD_XML, LYD_OPT_CONFIG);
+    assert_ptr_not_equal(st->source, NULL);
+
+    st->target = lyd_parse_mem(st->ctx1, trg, LYD_XML, LYD_OPT_CONFIG);
+    assert_ptr_not_equal(st->target, NULL);
+
+    /* merge them */
+    assert_int_equal(lyd_merge(st->target, st->source, 0), 0);
+    assert_int_equal(lyd_merge(st->target, st->source, LYD_OPT_DESTRUCT), 0);
+    st->source = NULL;
+    assert_int_equal(lyd_validate(&st->target, LYD_OPT_CONFIG, NULL), 0);
+
+    /* check the result */
+    LY_TREE_FOR(st->target, iter) {
+        count++;
+    }
+    assert_int_equal(count, 60);
+
+    set = lyd_find_xpath(st->target, "/T:item[name='i5']/value");
+    assert_ptr_not_equal(set, NULL);
+    assert_int_equal(set->number, 1);
+    assert_string_equal(((struct lyd_node_leaf_list *)set->set.d[0])->value_str, "t");
+    ly_set_free(set);
+
+    set = lyd_find_xpath(st->target, "/T:item[name='i15']/value");
+    assert_ptr_not_equal(set, NULL);
+    assert_int_equal(set->number, 1);
+    assert_string_equal(((struct lyd_node_leaf_list *)set->set.d[0])->value_str, "s");
+    ly_set_free(set);
+
+    set = lyd_find_xpath(st->target, "/T:item[name='i29']");
+    assert_ptr_not_equal(set, NULL);
+    assert_int_equal(set->number, 1);
+    ly_set_free(set);
+}
+
 static void
 test_merge_dflt1(void **state)
 {
@@ -496,6 +562,7 @@ int main(void)
                     cmocka_unit_test_setup_teardown(test_merge2, setup_dflt, teardown_dflt),
                     cmocka_unit_test_setup_teardown(test_merge3, setup_dflt, teardown_dflt),
                     cmocka_unit_test_setup_teardown(test_merge4, setup_dflt, teardown_dflt),
+                    cmocka_unit_test_setup_teardown(test_merge_toplevel, setup_dflt, teardown_dflt),
                     cmocka_unit_test_setup_teardown(test_merge_dflt1, setup_dflt, teardown_dflt),
                     cmocka_unit_test_setup_teardown(test_merge_dflt2, setup_dflt, teardown_dflt),
                     cmocka_unit_test_setup_teardown(test_merge_to_trgctx1, setup_mctx, teardown_mctx),
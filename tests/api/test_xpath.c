@@ -246,6 +246,9 @@ static void
 test_advanced(void **state)
 {
     struct state *st = (*state);
+    const char *ips[] = {"10.0.0.1", "172.0.0.1", "2001:abcd:ef01:2345:6789:0:1:1",
+                         "10.0.0.5", "172.0.0.5", "2001:abcd:ef01:2345:6789:0:1:5"};
+    unsigned int i;
 
     st->set = lyd_find_xpath(st->dt, "/ietf-interfaces:interfaces/interface[name='iface1']/ietf-ip:ipv4/*[ip]");
     assert_ptr_not_equal(st->set, NULL);
@@ -282,6 +285,16 @@ test_advanced(void **state)
     assert_int_equal(st->set->number, 12);
     ly_set_free(st->set);
     st->set = NULL;
+
+    /* parents of nodes from both interfaces merged in the document order */
+    st->set = lyd_find_xpath(st->dt, "//ietf-ip:prefix-length/.. | //ietf-ip:netmask/..");
+    assert_ptr_not_equal(st->set, NULL);
+    assert_int_equal(st->set->number, 6);
+    for (i = 0; i < st->set->number; i++) {
+        assert_string_equal(((struct lyd_node_leaf_list *)st->set->set.d[i]->child)->value_str, ips[i]);
+    }
+    ly_set_free(st->set);
+    st->set = NULL;
 }
 
 static void
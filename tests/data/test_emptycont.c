@@ -129,13 +129,39 @@ test_parse_autodel3(void **state)
     assert_string_equal(st->xml, "<topleaf xmlns=\"urn:libyang:tests:emptycont\">X</topleaf>");
 }
 
+static void
+test_validate_first(void **state)
+{
+    struct state *st = (*state);
+    const char *sch = "module emptycont2 {namespace urn:libyang:tests:emptycont2; prefix ec2;"
+                      "container top {leaf a {type string;}} leaf topleaf {type string;}}";
+    const struct lys_module *mod;
+    struct lyd_node *node;
+
+    mod = lys_parse_mem(st->ctx, sch, LYS_IN_YANG);
+    assert_ptr_not_equal(mod, NULL);
+
+    /* the removed empty container is the first top-level node */
+    st->dt = lyd_new(NULL, mod, "top");
+    assert_ptr_not_equal(st->dt, NULL);
+    node = lyd_new_leaf(NULL, mod, "topleaf", "X");
+    assert_ptr_not_equal(node, NULL);
+    assert_int_equal(lyd_insert_after(st->dt, node), 0);
+
+    assert_int_equal(lyd_validate(&st->dt, LYD_OPT_CONFIG, NULL), 0);
+    assert_ptr_equal(st->dt, node);
+    lyd_print_mem(&(st->xml), st->dt, LYD_XML, 0);
+    assert_string_equal(st->xml, "<topleaf xmlns=\"urn:libyang:tests:emptycont2\">X</topleaf>");
+}
+
 int main(void)
 {
     const struct CMUnitTest tests[] = {
                     cmocka_unit_test_setup_teardown(test_parse, setup_f, teardown_f),
                     cmocka_unit_test_setup_teardown(test_parse_autodel1, setup_f, teardown_f),
                     cmocka_unit_test_setup_teardown(test_parse_autodel2, setup_f, teardown_f),
-                    cmocka_unit_test_setup_teardown(test_parse_autodel3, setup_f, teardown_f), };
+                    cmocka_unit_test_setup_teardown(test_parse_autodel3, setup_f, teardown_f),
+                    cmocka_unit_test_setup_teardown(test_validate_first, setup_f, teardown_f), };
 
     return cmocka_run_group_tests(tests, NULL, NULL);
 }
@@ -0,0 +1,319 @@
+/**
+ * @file test_incremental.c
+ * @brief Cmocka tests for the incremental validation of changed data trees.
+ *
+ * Copyright (c) 2017 CESNET, z.s.p.o.
+ *
+ * This source code is licensed under BSD 3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/BSD-3-Clause
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <setjmp.h>
+#include <string.h>
+#include <cmocka.h>
+
+#include "../config.h"
+#include "../../src/libyang.h"
+
+struct state {
+    struct ly_ctx *ctx;
+    struct lyd_node *dt;
+    struct lyd_node *dt2;
+    char *str1;
+    char *str2;
+};
+
+static const char *schema =
+"module inc {"
+"  yang-version 1.1;"
+"  namespace \"urn:libyang:tests:incremental\";"
+"  prefix i;"
+"  container top {"
+"    leaf limit { type uint32; default 10; }"
+"    list item {"
+"      key name;"
+"      unique port;"
+"      leaf name { type string; }"
+"      leaf value { type uint32; must \". <= /top/limit\"; }"
+"      leaf port { type uint16; }"
+"      leaf ref { type leafref { path \"/top/item/name\"; } }"
+"      container opt {"
+"        when \"../value > 5\";"
+"        leaf x { type string; default \"dx\"; }"
+"      }"
+"    }"
+"  }"
+"  container extra {"
+"    presence p;"
+"    leaf flag { type boolean; when \"/top/limit > 5\"; }"
+"    leaf m { type string; mandatory true; }"
+"    leaf items { type uint32; must \". >= count(/top/item)\"; }"
+"  }"
+"}";
+
+static const char *data =
+"<top xmlns=\"urn:libyang:tests:incremental\">"
+"<item><name>a</name><value>3</value><port>1</port></item>"
+"<item><name>b</name><value>4</value><port>2</port><ref>a</ref></item>"
+"</top>"
+"<extra xmlns=\"urn:libyang:tests:incremental\"><flag>true</flag><m>v</m></extra>";
+
+static int
+setup_f(void **state)
+{
+    struct state *st;
+
+    (*state) = st = calloc(1, sizeof *st);
+    if (!st) {
+        fprintf(stderr, "Memory allocation error");
+        return -1;
+    }
+
+    /* libyang context */
+    st->ctx = ly_ctx_new(NULL);
+    if (!st->ctx) {
+        fprintf(stderr, "Failed to create context.\n");
+        return -1;
+    }
+
+    /* schema */
+    if (!lys_parse_mem(st->ctx, schema, LYS_IN_YANG)) {
+        fprintf(stderr, "Failed to load data model.\n");
+        return -1;
+    }
+
+    /* data */
+    st->dt = lyd_parse_mem(st->ctx, data, LYD_XML, LYD_OPT_CONFIG);
+    if (!st->dt) {
+        fprintf(stderr, "Failed to parse data.\n");
+        return -1;
+    }
+
+    return 0;
+}
+
+static int
+teardown_f(void **state)
+{
+    struct state *st = (*state);
+
+    lyd_free_withsiblings(st->dt);
+    lyd_free_withsiblings(st->dt2);
+    ly_ctx_destroy(st->ctx, NULL);
+    free(st->str1);
+    free(st->str2);
+    free(st);
+    (*state) = NULL;
+
+    return 0;
+}
+
+static struct lyd_node *
+find(struct lyd_node *root, const char *path)
+{
+    struct ly_set *set;
+    struct lyd_node *node;
+
+    set = lyd_find_xpath(root, path);
+    assert_ptr_not_equal(set, NULL);
+    assert_int_equal(set->number, 1);
+    node = set->set.d[0];
+    ly_set_free(set);
+
+    return node;
+}
+
+/* validate the changed tree incrementally and its copy completely, the results must be the same */
+static int
+validate(struct state *st)
+{
+    struct lyd_node *iter, *dup;
+    int ret, ret2;
+
+    lyd_free_withsiblings(st->dt2);
+    st->dt2 = NULL;
+    LY_TREE_FOR(st->dt, iter) {
+        dup = lyd_dup(iter, 1);
+        assert_ptr_not_equal(dup, NULL);
+        if (st->dt2) {
+            assert_int_equal(lyd_insert_after(st->dt2->prev, dup), 0);
+        } else {
+            st->dt2 = dup;
+        }
+    }
+
+    ret = lyd_validate(&st->dt, LYD_OPT_CONFIG | LYD_OPT_INCREMENTAL, NULL);
+    ret2 = lyd_validate(&st->dt2, LYD_OPT_CONFIG, NULL);
+    assert_int_equal(ret, ret2);
+
+    if (!ret) {
+        free(st->str1);
+        free(st->str2);
+        lyd_print_mem(&st->str1, st->dt, LYD_XML, LYP_WITHSIBLINGS | LYP_WD_ALL);
+        lyd_print_mem(&st->str2, st->dt2, LYD_XML, LYP_WITHSIBLINGS | LYP_WD_ALL);
+        assert_string_equal(st->str1, st->str2);
+    }
+
+    return ret;
+}
+
+static void
+test_unchanged(void **state)
+{
+    struct state *st = (*state);
+
+    assert_int_equal(validate(st), 0);
+    assert_int_equal(validate(st), 0);
+}
+
+static void
+test_dummy(void **state)
+{
+    struct state *st = (*state);
+    const char *sch = "module inc2 {namespace urn:libyang:tests:incremental2; prefix i2;"
+                      "container c {leaf enable {type boolean;}"
+                      "leaf x {when \"../enable = 'true'\"; type string; mandatory true;}}}";
+    struct lyd_node *node;
+
+    assert_ptr_not_equal(lys_parse_mem(st->ctx, sch, LYS_IN_YANG), NULL);
+    node = lyd_new_path(st->dt, NULL, "/inc2:c/enable", "false", 0, 0);
+    assert_ptr_not_equal(node, NULL);
+    assert_int_equal(validate(st), 0);
+
+    /* the dummy node checking the when of the mandatory leaf does not mark the container changed */
+    assert_int_equal(node->validity, LYD_VAL_OK);
+}
+
+static void
+test_must(void **state)
+{
+    struct state *st = (*state);
+
+    /* the must of the items depends on the changed leaf */
+    assert_int_equal(lyd_change_leaf((struct lyd_node_leaf_list *)find(st->dt, "/inc:top/limit"), "3"), 0);
+    assert_int_not_equal(validate(st), 0);
+
+    /* invalid data are validated again as a whole */
+    assert_int_equal(lyd_change_leaf((struct lyd_node_leaf_list *)find(st->dt, "/inc:top/limit"), "4"), 0);
+    assert_int_equal(validate(st), 0);
+
+    /* the nodes in a function argument */
+    assert_ptr_not_equal(lyd_new_path(st->dt, NULL, "/inc:extra/items", "2", 0, 0), NULL);
+    assert_int_equal(validate(st), 0);
+    assert_ptr_not_equal(lyd_new_path(st->dt, NULL, "/inc:top/item[name='c']/port", "3", 0, 0), NULL);
+    assert_int_not_equal(validate(st), 0);
+
+    /* the changed leaf itself */
+    assert_int_equal(lyd_change_leaf((struct lyd_node_leaf_list *)find(st->dt, "/inc:top/item[name='a']/value"), "5"), 0);
+    assert_int_not_equal(validate(st), 0);
+}
+
+static void
+test_when(void **state)
+{
+    struct state *st = (*state);
+
+    /* the when condition is now true, so the container is added with its default leaf */
+    assert_int_equal(lyd_change_leaf((struct lyd_node_leaf_list *)find(st->dt, "/inc:top/item[name='a']/value"), "7"), 0);
+    assert_int_equal(validate(st), 0);
+    find(st->dt, "/inc:top/item[name='a']/opt/x");
+
+    /* and auto-deleted again */
+    assert_int_equal(lyd_change_leaf((struct lyd_node_leaf_list *)find(st->dt, "/inc:top/item[name='a']/value"), "1"), 0);
+    assert_int_equal(validate(st), 0);
+
+    /* a when condition in another subtree */
+    assert_int_equal(lyd_change_leaf((struct lyd_node_leaf_list *)find(st->dt, "/inc:top/limit"), "5"), 0);
+    assert_int_equal(validate(st), 0);
+    assert_string_equal(st->str1, "<top xmlns=\"urn:libyang:tests:incremental\">"
+                        "<item><name>a</name><value>1</value><port>1</port></item>"
+                        "<item><name>b</name><value>4</value><port>2</port><ref>a</ref></item><limit>5</limit></top>"
+                        "<extra xmlns=\"urn:libyang:tests:incremental\"><m>v</m></extra>");
+}
+
+static void
+test_mandatory(void **state)
+{
+    struct state *st = (*state);
+
+    lyd_free(find(st->dt, "/inc:extra/m"));
+    assert_int_not_equal(validate(st), 0);
+
+    assert_ptr_not_equal(lyd_new_path(st->dt, NULL, "/inc:extra/m", "w", 0, 0), NULL);
+    assert_int_equal(validate(st), 0);
+}
+
+static void
+test_unique(void **state)
+{
+    struct state *st = (*state);
+
+    assert_int_equal(lyd_change_leaf((struct lyd_node_leaf_list *)find(st->dt, "/inc:top/item[name='b']/port"), "1"), 0);
+    assert_int_not_equal(validate(st), 0);
+
+    assert_ptr_not_equal(lyd_new_path(st->dt, NULL, "/inc:top/item[name='c']/port", "1", 0, 0), NULL);
+    assert_int_equal(lyd_change_leaf((struct lyd_node_leaf_list *)find(st->dt, "/inc:top/item[name='b']/port"), "3"), 0);
+    assert_int_not_equal(validate(st), 0);
+
+    assert_int_equal(lyd_change_leaf((struct lyd_node_leaf_list *)find(st->dt, "/inc:top/item[name='c']/port"), "4"), 0);
+    assert_int_equal(validate(st), 0);
+}
+
+static void
+test_leafref(void **state)
+{
+    struct state *st = (*state);
+
+    /* the target of the leafref is removed */
+    lyd_free(find(st->dt, "/inc:top/item[name='a']"));
+    assert_int_not_equal(validate(st), 0);
+
+    /* and created again */
+    assert_ptr_not_equal(lyd_new_path(st->dt, NULL, "/inc:top/item[name='a']/value", "2", 0, 0), NULL);
+    assert_int_equal(validate(st), 0);
+
+    /* the leafref itself */
+    assert_int_equal(lyd_change_leaf((struct lyd_node_leaf_list *)find(st->dt, "/inc:top/item[name='b']/ref"), "x"), 0);
+    assert_int_not_equal(validate(st), 0);
+}
+
+static void
+test_toplevel(void **state)
+{
+    struct state *st = (*state);
+    struct lyd_node *node;
+
+    /* removed top-level node */
+    node = find(st->dt, "/inc:extra");
+    lyd_free(node);
+    assert_int_equal(validate(st), 0);
+
+    /* removed first top-level node with a default value */
+    node = find(st->dt, "/inc:top");
+    lyd_free(node);
+    st->dt = NULL;
+    assert_ptr_not_equal(st->dt = lyd_new_path(NULL, st->ctx, "/inc:extra/m", "v", 0, 0), NULL);
+    assert_int_equal(validate(st), 0);
+    find(st->dt, "/inc:top/limit");
+}
+
+int
+main(void)
+{
+    const struct CMUnitTest tests[] = {
+                    cmocka_unit_test_setup_teardown(test_unchanged, setup_f, teardown_f),
+                    cmocka_unit_test_setup_teardown(test_dummy, setup_f, teardown_f),
+                    cmocka_unit_test_setup_teardown(test_must, setup_f, teardown_f),
+                    cmocka_unit_test_setup_teardown(test_when, setup_f, teardown_f),
+                    cmocka_unit_test_setup_teardown(test_mandatory, setup_f, teardown_f),
+                    cmocka_unit_test_setup_teardown(test_unique, setup_f, teardown_f),
+                    cmocka_unit_test_setup_teardown(test_leafref, setup_f, teardown_f),
+                    cmocka_unit_test_setup_teardown(test_toplevel, setup_f, teardown_f), };
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
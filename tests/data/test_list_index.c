@@ -0,0 +1,285 @@
+/**
+ * @file test_list_index.c
+ * @brief Cmocka tests for the index of list and leaf-list instances in data trees.
+ *
+ * Copyright (c) 2017 CESNET, z.s.p.o.
+ *
+ * This source code is licensed under BSD 3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/BSD-3-Clause
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <setjmp.h>
+#include <string.h>
+#include <cmocka.h>
+
+#include "../config.h"
+#include "../../src/libyang.h"
+
+/* enough instances for the children index to be created */
+#define ENTRIES 100
+
+struct state {
+    struct ly_ctx *ctx;
+    struct lyd_node *dt;
+};
+
+static const char *schema =
+"module list-index {"
+"  namespace \"urn:libyang:tests:list-index\";"
+"  prefix li;"
+"  container cont {"
+"    list l {"
+"      key \"k1 k2\";"
+"      leaf k1 { type string; }"
+"      leaf k2 { type uint8; }"
+"      leaf value { type string; }"
+"    }"
+"    leaf-list ll { type string; }"
+"    leaf ref {"
+"      type leafref { path \"../l[k1 = current()/../ref-k1][k2 = current()/../ref-k2]/value\"; }"
+"    }"
+"    leaf ref-k1 { type string; }"
+"    leaf ref-k2 { type uint8; }"
+"    leaf iid { type instance-identifier; }"
+"  }"
+"}";
+
+static int
+setup_f(void **state)
+{
+    struct state *st;
+    char path[64], value[16];
+    int i;
+
+    (*state) = st = calloc(1, sizeof *st);
+    if (!st) {
+        fprintf(stderr, "Memory allocation error");
+        return -1;
+    }
+
+    /* libyang context */
+    st->ctx = ly_ctx_new(NULL);
+    if (!st->ctx) {
+        fprintf(stderr, "Failed to create context.\n");
+        return -1;
+    }
+
+    /* schema */
+    if (!lys_parse_mem(st->ctx, schema, LYS_IN_YANG)) {
+        fprintf(stderr, "Failed to load data model.\n");
+        return -1;
+    }
+
+    /* data */
+    st->dt = lyd_new_path(NULL, st->ctx, "/list-index:cont", NULL, 0, 0);
+    if (!st->dt) {
+        fprintf(stderr, "Failed to create data.\n");
+        return -1;
+    }
+    for (i = 0; i < ENTRIES; i++) {
+        sprintf(path, "/list-index:cont/l[k1='e%d'][k2='%d']/value", i, i % 10);
+        sprintf(value, "v%d", i);
+        if (!lyd_new_path(st->dt, NULL, path, value, 0, 0)) {
+            fprintf(stderr, "Failed to create data.\n");
+            return -1;
+        }
+        sprintf(path, "/list-index:cont/ll[.='e%d']", i);
+        if (!lyd_new_path(st->dt, NULL, path, NULL, 0, 0)) {
+            fprintf(stderr, "Failed to create data.\n");
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+static int
+teardown_f(void **state)
+{
+    struct state *st = (*state);
+
+    lyd_free_withsiblings(st->dt);
+    ly_ctx_destroy(st->ctx, NULL);
+    free(st);
+    (*state) = NULL;
+
+    return 0;
+}
+
+static struct lyd_node *
+find_one(struct lyd_node *dt, const char *path)
+{
+    struct ly_set *set;
+    struct lyd_node *node = NULL;
+
+    set = lyd_find_xpath(dt, path);
+    if (set && (set->number == 1)) {
+        node = set->set.d[0];
+    }
+    ly_set_free(set);
+    return node;
+}
+
+static void
+test_lookup(void **state)
+{
+    struct state *st = (*state);
+    struct lyd_node *node;
+
+    /* existing entries are found and updated instead of created */
+    node = lyd_new_path(st->dt, NULL, "/list-index:cont/l[k1='e42'][k2='2']/value", "new", 0, LYD_PATH_OPT_UPDATE);
+    assert_ptr_not_equal(node, NULL);
+    assert_string_equal(((struct lyd_node_leaf_list *)node)->value_str, "new");
+    assert_ptr_equal(find_one(st->dt, "/list-index:cont/l[k1='e42'][k2='2']/value"), node);
+
+    /* wrong value of the second key means a new entry */
+    node = lyd_new_path(st->dt, NULL, "/list-index:cont/l[k1='e42'][k2='3']", NULL, 0, 0);
+    assert_ptr_not_equal(node, NULL);
+    assert_ptr_equal(node->parent, st->dt);
+
+    /* existing leaf-list instance */
+    node = lyd_new_path(st->dt, NULL, "/list-index:cont/ll", "e7", 0, 0);
+    assert_ptr_equal(node, NULL);
+    node = lyd_new_path(st->dt, NULL, "/list-index:cont/ll", "e1000", 0, 0);
+    assert_ptr_not_equal(node, NULL);
+}
+
+static void
+test_unlink_change(void **state)
+{
+    struct state *st = (*state);
+    struct lyd_node *node;
+
+    /* removed entry can be created again */
+    node = find_one(st->dt, "/list-index:cont/l[k1='e10'][k2='0']");
+    assert_ptr_not_equal(node, NULL);
+    lyd_free(node);
+    assert_ptr_equal(find_one(st->dt, "/list-index:cont/l[k1='e10'][k2='0']"), NULL);
+    node = lyd_new_path(st->dt, NULL, "/list-index:cont/l[k1='e10'][k2='0']/value", "again", 0, 0);
+    assert_ptr_not_equal(node, NULL);
+
+    /* changed leaf-list value */
+    node = find_one(st->dt, "/list-index:cont/ll[.='e20']");
+    assert_ptr_not_equal(node, NULL);
+    assert_int_equal(lyd_change_leaf((struct lyd_node_leaf_list *)node, "changed"), 0);
+    assert_ptr_equal(lyd_new_path(st->dt, NULL, "/list-index:cont/ll", "changed", 0, 0), NULL);
+    assert_ptr_not_equal(lyd_new_path(st->dt, NULL, "/list-index:cont/ll", "e20", 0, 0), NULL);
+
+    /* moved instances */
+    node = find_one(st->dt, "/list-index:cont/l[k1='e30'][k2='0']");
+    assert_ptr_not_equal(node, NULL);
+    assert_int_equal(lyd_insert_after(st->dt->child, node), 0);
+    node = lyd_new_path(st->dt, NULL, "/list-index:cont/l[k1='e30'][k2='0']/value", "moved", 0, LYD_PATH_OPT_UPDATE);
+    assert_ptr_not_equal(node, NULL);
+    assert_ptr_equal(node->parent->prev, st->dt->child);
+}
+
+static void
+test_merge(void **state)
+{
+    struct state *st = (*state);
+    struct lyd_node *src, *node;
+
+    src = lyd_new_path(NULL, st->ctx, "/list-index:cont/l[k1='e50'][k2='0']/value", "merged", 0, 0);
+    assert_ptr_not_equal(src, NULL);
+    assert_ptr_not_equal(lyd_new_path(src, NULL, "/list-index:cont/l[k1='e500'][k2='0']/value", "added", 0, 0), NULL);
+
+    assert_int_equal(lyd_merge(st->dt, src, LYD_OPT_DESTRUCT), 0);
+
+    node = find_one(st->dt, "/list-index:cont/l[k1='e50'][k2='0']/value");
+    assert_ptr_not_equal(node, NULL);
+    assert_string_equal(((struct lyd_node_leaf_list *)node)->value_str, "merged");
+    node = find_one(st->dt, "/list-index:cont/l[k1='e500'][k2='0']/value");
+    assert_ptr_not_equal(node, NULL);
+    assert_string_equal(((struct lyd_node_leaf_list *)node)->value_str, "added");
+}
+
+static void
+test_leafref(void **state)
+{
+    struct state *st = (*state);
+    struct lyd_node *node;
+
+    assert_ptr_not_equal(lyd_new_path(st->dt, NULL, "/list-index:cont/ref-k1", "e63", 0, 0), NULL);
+    assert_ptr_not_equal(lyd_new_path(st->dt, NULL, "/list-index:cont/ref-k2", "3", 0, 0), NULL);
+
+    /* the referenced entry has a different value */
+    node = lyd_new_path(st->dt, NULL, "/list-index:cont/ref", "v64", 0, 0);
+    assert_ptr_not_equal(node, NULL);
+    assert_int_not_equal(lyd_validate(&st->dt, LYD_OPT_CONFIG, NULL), 0);
+
+    assert_int_equal(lyd_change_leaf((struct lyd_node_leaf_list *)node, "v63"), 0);
+    assert_int_equal(lyd_validate(&st->dt, LYD_OPT_CONFIG, NULL), 0);
+}
+
+static void
+test_xpath_keys(void **state)
+{
+    struct state *st = (*state);
+    struct lyd_node *node;
+    struct ly_set *set;
+
+    /* keys in any order, with a prefix, or in double quotes */
+    node = find_one(st->dt, "/list-index:cont/l[k2='2'][k1='e42']/value");
+    assert_ptr_not_equal(node, NULL);
+    assert_string_equal(((struct lyd_node_leaf_list *)node)->value_str, "v42");
+    assert_ptr_equal(find_one(st->dt, "/list-index:cont/l[list-index:k1 = \"e42\"][k2 = '2']/value"), node);
+
+    /* other predicates are evaluated on the found instance */
+    assert_ptr_equal(find_one(st->dt, "/list-index:cont/l[k1='e42'][k2='2'][1]/value"), node);
+    assert_ptr_equal(find_one(st->dt, "/list-index:cont/l[k1='e42'][k2=2]/value"), node);
+    set = lyd_find_xpath(st->dt, "/list-index:cont/l[k1='e42'][k2='2'][2]");
+    assert_ptr_not_equal(set, NULL);
+    assert_int_equal(set->number, 0);
+    ly_set_free(set);
+
+    /* wrong value of the second key */
+    assert_ptr_equal(find_one(st->dt, "/list-index:cont/l[k1='e42'][k2='3']"), NULL);
+
+    /* relative to a list instance */
+    node = find_one(node->parent, "../l[k1='e43'][k2='3']/value");
+    assert_ptr_not_equal(node, NULL);
+    assert_string_equal(((struct lyd_node_leaf_list *)node)->value_str, "v43");
+}
+
+static void
+test_instid(void **state)
+{
+    struct state *st = (*state);
+    struct lyd_node *node;
+
+    node = lyd_new_path(st->dt, NULL, "/list-index:cont/iid",
+                        "/list-index:cont/list-index:l[list-index:k1='e42'][list-index:k2='2']/list-index:value", 0, 0);
+    assert_ptr_not_equal(node, NULL);
+    assert_int_equal(lyd_validate(&st->dt, LYD_OPT_CONFIG, NULL), 0);
+
+    /* wrong value of the second key */
+    assert_int_equal(lyd_change_leaf((struct lyd_node_leaf_list *)node,
+                                     "/list-index:cont/list-index:l[list-index:k1='e42'][list-index:k2='3']"), 0);
+    assert_int_not_equal(lyd_validate(&st->dt, LYD_OPT_CONFIG, NULL), 0);
+
+    /* leaf-list instance */
+    assert_int_equal(lyd_change_leaf((struct lyd_node_leaf_list *)node, "/list-index:cont/list-index:ll[.='e7']"), 0);
+    assert_int_equal(lyd_validate(&st->dt, LYD_OPT_CONFIG, NULL), 0);
+    assert_int_equal(lyd_change_leaf((struct lyd_node_leaf_list *)node, "/list-index:cont/list-index:ll[.='e1000']"), 0);
+    assert_int_not_equal(lyd_validate(&st->dt, LYD_OPT_CONFIG, NULL), 0);
+}
+
+int
+main(void)
+{
+    const struct CMUnitTest tests[] = {
+                    cmocka_unit_test_setup_teardown(test_lookup, setup_f, teardown_f),
+                    cmocka_unit_test_setup_teardown(test_unlink_change, setup_f, teardown_f),
+                    cmocka_unit_test_setup_teardown(test_merge, setup_f, teardown_f),
+                    cmocka_unit_test_setup_teardown(test_leafref, setup_f, teardown_f),
+                    cmocka_unit_test_setup_teardown(test_xpath_keys, setup_f, teardown_f),
+                    cmocka_unit_test_setup_teardown(test_instid, setup_f, teardown_f), };
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,403 @@
+/**
+ * @file test_lyb.c
+ * @brief Cmocka tests for storing and loading data trees in the LYB format.
+ *
+ * Copyright (c) 2017 CESNET, z.s.p.o.
+ *
+ * This source code is licensed under BSD 3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/BSD-3-Clause
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <setjmp.h>
+#include <string.h>
+#include <unistd.h>
+#include <cmocka.h>
+
+#include "../config.h"
+#include "../../src/libyang.h"
+
+struct state {
+    struct ly_ctx *ctx;
+    struct lyd_node *dt;
+    struct lyd_node *dt2;
+    char *lyb;
+    char *str1;
+    char *str2;
+};
+
+static const char *schema =
+"module lyb {"
+"  yang-version 1.1;"
+"  namespace \"urn:libyang:tests:lyb\";"
+"  prefix l;"
+"  import ietf-yang-metadata { prefix md; }"
+"  md:annotation note { type string; }"
+"  identity base;"
+"  identity derived { base base; }"
+"  typedef percent { type uint8 { range \"0..100\"; } }"
+"  container top {"
+"    leaf i8 { type int8; }"
+"    leaf i64 { type int64; }"
+"    leaf u16 { type uint16; default 80; }"
+"    leaf p { type percent; }"
+"    leaf d { type decimal64 { fraction-digits 2; } }"
+"    leaf b { type boolean; }"
+"    leaf e { type empty; }"
+"    leaf en { type enumeration { enum one; enum two; enum three; } }"
+"    leaf bi { type bits { bit a; bit b; bit c; bit d; bit e; bit f; bit g; bit h; bit i; } }"
+"    leaf s { type string { pattern \"[a-z]*\"; } }"
+"    leaf bin { type binary; }"
+"    leaf id { type identityref { base base; } }"
+"    leaf ref { type leafref { path \"../item/name\"; } }"
+"    leaf inst { type instance-identifier; }"
+"    leaf un { type union { type int8; type string; } }"
+"    choice ch { leaf c1 { type string; } leaf c2 { type string; } }"
+"    anydata any;"
+"    list item {"
+"      key \"name id\";"
+"      leaf name { type string; }"
+"      leaf id { type uint32; }"
+"      leaf-list tag { type string; ordered-by user; }"
+"    }"
+"  }"
+"  rpc act {"
+"    input { leaf x { type string; } }"
+"    output { leaf y { type string; } }"
+"  }"
+"  notification ev { leaf z { type string; } }"
+"}";
+
+static const char *schema_aug =
+"module lyb-aug {"
+"  namespace \"urn:libyang:tests:lyb-aug\";"
+"  prefix a;"
+"  import lyb { prefix l; }"
+"  augment /l:top { leaf extra { type string; } }"
+"  leaf other { type string; }"
+"}";
+
+static const char *data =
+"<top xmlns=\"urn:libyang:tests:lyb\" xmlns:l=\"urn:libyang:tests:lyb\">"
+"<i8>-5</i8><i64>-9000000000</i64><p>42</p><d>3.14</d><b>true</b><e/><en>three</en><bi>a c i</bi>"
+"<s xmlns:l=\"urn:libyang:tests:lyb\" l:note=\"lower case\">abc</s><bin>aGVsbG8=</bin><id>l:derived</id><ref>b</ref>"
+"<inst>/l:top/l:item[l:name='a'][l:id='1']/l:tag[.='x']</inst><un></un><c2></c2>"
+"<any><free xmlns=\"urn:free\">content</free></any>"
+"<item><name>a</name><id>1</id><tag>x</tag><tag>w</tag></item>"
+"<item><name>b</name><id>2</id></item>"
+"<extra xmlns=\"urn:libyang:tests:lyb-aug\">added</extra>"
+"</top>"
+"<other xmlns=\"urn:libyang:tests:lyb-aug\">value</other>";
+
+static int
+setup_f(void **state)
+{
+    struct state *st;
+
+    (*state) = st = calloc(1, sizeof *st);
+    if (!st) {
+        fprintf(stderr, "Memory allocation error");
+        return -1;
+    }
+
+    /* libyang context */
+    st->ctx = ly_ctx_new(TESTS_DIR"/schema/yang/ietf/");
+    if (!st->ctx) {
+        fprintf(stderr, "Failed to create context.\n");
+        return -1;
+    }
+
+    /* schemas */
+    if (!lys_parse_mem(st->ctx, schema, LYS_IN_YANG) || !lys_parse_mem(st->ctx, schema_aug, LYS_IN_YANG)) {
+        fprintf(stderr, "Failed to load data models.\n");
+        return -1;
+    }
+
+    /* data */
+    st->dt = lyd_parse_mem(st->ctx, data, LYD_XML, LYD_OPT_CONFIG);
+    if (!st->dt) {
+        fprintf(stderr, "Failed to parse data.\n");
+        return -1;
+    }
+
+    return 0;
+}
+
+static int
+teardown_f(void **state)
+{
+    struct state *st = (*state);
+
+    lyd_free_withsiblings(st->dt);
+    lyd_free_withsiblings(st->dt2);
+    ly_ctx_destroy(st->ctx, NULL);
+    free(st->lyb);
+    free(st->str1);
+    free(st->str2);
+    free(st);
+    (*state) = NULL;
+
+    return 0;
+}
+
+/* print both trees in the format and compare them */
+static void
+compare(struct state *st, LYD_FORMAT format, int options)
+{
+    free(st->str1);
+    free(st->str2);
+    st->str1 = st->str2 = NULL;
+
+    assert_int_equal(lyd_print_mem(&st->str1, st->dt, format, options), 0);
+    assert_int_equal(lyd_print_mem(&st->str2, st->dt2, format, options), 0);
+    assert_ptr_not_equal(st->str1, NULL);
+    assert_ptr_not_equal(st->str2, NULL);
+    assert_string_equal(st->str1, st->str2);
+}
+
+static void
+test_values(void **state)
+{
+    struct state *st = (*state);
+    struct lyd_node_leaf_list *leaf;
+    struct ly_set *set;
+
+    assert_int_equal(lyd_print_mem(&st->lyb, st->dt, LYD_LYB, LYP_WITHSIBLINGS), 0);
+    assert_int_equal(memcmp(st->lyb, "lyb", 3), 0);
+    st->dt2 = lyd_parse_mem(st->ctx, st->lyb, LYD_LYB, LYD_OPT_CONFIG);
+    assert_ptr_not_equal(st->dt2, NULL);
+
+    compare(st, LYD_XML, LYP_WITHSIBLINGS);
+    compare(st, LYD_JSON, LYP_WITHSIBLINGS);
+    compare(st, LYD_XML, LYP_WITHSIBLINGS | LYP_WD_ALL_TAG);
+
+    /* the values in their stored form */
+    set = lyd_find_xpath(st->dt2, "/lyb:top/bi");
+    assert_int_equal(set->number, 1);
+    leaf = (struct lyd_node_leaf_list *)set->set.d[0];
+    assert_int_equal(leaf->value_type, LY_TYPE_BITS);
+    assert_ptr_not_equal(leaf->value.bit[0], NULL);
+    assert_ptr_equal(leaf->value.bit[1], NULL);
+    assert_string_equal(leaf->value.bit[8]->name, "i");
+    ly_set_free(set);
+
+    set = lyd_find_xpath(st->dt2, "/lyb:top/i64");
+    assert_int_equal(set->number, 1);
+    leaf = (struct lyd_node_leaf_list *)set->set.d[0];
+    assert_true(leaf->value.int64 == -9000000000LL);
+    ly_set_free(set);
+
+    set = lyd_find_xpath(st->dt2, "/lyb:top/ref");
+    assert_int_equal(set->number, 1);
+    leaf = (struct lyd_node_leaf_list *)set->set.d[0];
+    assert_int_equal(leaf->value_type, LY_TYPE_LEAFREF);
+    assert_string_equal(((struct lyd_node_leaf_list *)leaf->value.leafref)->value_str, "b");
+    ly_set_free(set);
+
+    set = lyd_find_xpath(st->dt2, "/lyb:top/u16");
+    assert_int_equal(set->number, 1);
+    assert_int_equal(set->set.d[0]->dflt, 1);
+    ly_set_free(set);
+
+    /* the annotation */
+    set = lyd_find_xpath(st->dt2, "/lyb:top/s");
+    assert_int_equal(set->number, 1);
+    assert_ptr_not_equal(set->set.d[0]->attr, NULL);
+    assert_string_equal(set->set.d[0]->attr->value_str, "lower case");
+    ly_set_free(set);
+}
+
+static void
+test_nosiblings(void **state)
+{
+    struct state *st = (*state);
+
+    /* only the first top-level node */
+    assert_int_equal(lyd_print_mem(&st->lyb, st->dt, LYD_LYB, 0), 0);
+    st->dt2 = lyd_parse_mem(st->ctx, st->lyb, LYD_LYB, LYD_OPT_CONFIG);
+    assert_ptr_not_equal(st->dt2, NULL);
+    assert_ptr_equal(st->dt2->next, NULL);
+    assert_string_equal(st->dt2->schema->name, "top");
+
+    /* empty data tree */
+    free(st->lyb);
+    assert_int_equal(lyd_print_mem(&st->lyb, NULL, LYD_LYB, 0), 0);
+    assert_int_equal(memcmp(st->lyb, "lyb", 3), 0);
+    lyd_free_withsiblings(st->dt2);
+    st->dt2 = lyd_parse_mem(st->ctx, st->lyb, LYD_LYB, LYD_OPT_CONFIG);
+    assert_ptr_not_equal(st->dt2, NULL);
+    assert_string_equal(st->dt2->schema->name, "top");
+    assert_int_equal(st->dt2->dflt, 1);
+}
+
+static void
+test_unknown(void **state)
+{
+    struct state *st = (*state);
+    struct ly_ctx *ctx;
+    struct lyd_node *dt;
+    char *str;
+
+    assert_int_equal(lyd_print_mem(&st->lyb, st->dt, LYD_LYB, LYP_WITHSIBLINGS), 0);
+
+    /* the augment module is not in the other context */
+    ctx = ly_ctx_new(TESTS_DIR"/schema/yang/ietf/");
+    assert_ptr_not_equal(ctx, NULL);
+    assert_ptr_not_equal(lys_parse_mem(ctx, schema, LYS_IN_YANG), NULL);
+
+    /* the nodes are skipped */
+    dt = lyd_parse_mem(ctx, st->lyb, LYD_LYB, LYD_OPT_CONFIG);
+    assert_ptr_not_equal(dt, NULL);
+    assert_ptr_equal(dt->next, NULL);
+    assert_int_equal(lyd_print_mem(&str, dt, LYD_XML, LYP_WITHSIBLINGS), 0);
+    assert_ptr_equal(strstr(str, "extra"), NULL);
+    free(str);
+    lyd_free_withsiblings(dt);
+
+    /* or refused */
+    dt = lyd_parse_mem(ctx, st->lyb, LYD_LYB, LYD_OPT_CONFIG | LYD_OPT_STRICT);
+    assert_ptr_equal(dt, NULL);
+    assert_int_equal(ly_errno, LY_EVALID);
+
+    ly_ctx_destroy(ctx, NULL);
+}
+
+static void
+test_invalid(void **state)
+{
+    struct state *st = (*state);
+    struct ly_set *set;
+    uint32_t len;
+
+    /* the data are validated, the leafref target is missing */
+    set = lyd_find_xpath(st->dt, "/lyb:top/item[name='b']");
+    assert_int_equal(set->number, 1);
+    lyd_free(set->set.d[0]);
+    ly_set_free(set);
+    assert_int_equal(lyd_print_mem(&st->lyb, st->dt, LYD_LYB, LYP_WITHSIBLINGS), 0);
+    assert_ptr_equal(lyd_parse_mem(st->ctx, st->lyb, LYD_LYB, LYD_OPT_CONFIG), NULL);
+    assert_int_equal(ly_errno, LY_EVALID);
+
+    /* truncated data */
+    memcpy(&len, &st->lyb[4], 4);
+    len -= 3;
+    memcpy(&st->lyb[4], &len, 4);
+    assert_ptr_equal(lyd_parse_mem(st->ctx, st->lyb, LYD_LYB, LYD_OPT_CONFIG), NULL);
+    assert_int_equal(ly_errno, LY_EVALID);
+
+    /* not LYB */
+    assert_ptr_equal(lyd_parse_mem(st->ctx, data, LYD_LYB, LYD_OPT_CONFIG), NULL);
+    assert_int_equal(ly_errno, LY_EVALID);
+}
+
+static void
+test_rpc(void **state)
+{
+    struct state *st = (*state);
+    struct lyd_node *rpc, *reply;
+
+    rpc = lyd_parse_mem(st->ctx, "<act xmlns=\"urn:libyang:tests:lyb\"><x>in</x></act>", LYD_XML, LYD_OPT_RPC, NULL);
+    assert_ptr_not_equal(rpc, NULL);
+    assert_int_equal(lyd_print_mem(&st->lyb, rpc, LYD_LYB, 0), 0);
+    st->dt2 = lyd_parse_mem(st->ctx, st->lyb, LYD_LYB, LYD_OPT_RPC, NULL);
+    assert_ptr_not_equal(st->dt2, NULL);
+    lyd_free_withsiblings(st->dt);
+    st->dt = rpc;
+    compare(st, LYD_XML, 0);
+
+    /* reply, only the output is printed */
+    reply = lyd_parse_mem(st->ctx, "<y xmlns=\"urn:libyang:tests:lyb\">out</y>", LYD_XML, LYD_OPT_RPCREPLY, rpc, NULL);
+    assert_ptr_not_equal(reply, NULL);
+    free(st->lyb);
+    assert_int_equal(lyd_print_mem(&st->lyb, reply, LYD_LYB, LYP_NETCONF), 0);
+    lyd_free_withsiblings(st->dt2);
+    st->dt2 = lyd_parse_mem(st->ctx, st->lyb, LYD_LYB, LYD_OPT_RPCREPLY, rpc, NULL);
+    assert_ptr_not_equal(st->dt2, NULL);
+    st->dt = reply;
+    compare(st, LYD_XML, 0);
+    lyd_free_withsiblings(rpc);
+    lyd_free_withsiblings(reply);
+
+    /* notification */
+    st->dt = lyd_parse_mem(st->ctx, "<ev xmlns=\"urn:libyang:tests:lyb\"><z>note</z></ev>", LYD_XML, LYD_OPT_NOTIF, NULL);
+    assert_ptr_not_equal(st->dt, NULL);
+    free(st->lyb);
+    assert_int_equal(lyd_print_mem(&st->lyb, st->dt, LYD_LYB, 0), 0);
+    lyd_free_withsiblings(st->dt2);
+    st->dt2 = lyd_parse_mem(st->ctx, st->lyb, LYD_LYB, LYD_OPT_NOTIF, NULL);
+    assert_ptr_not_equal(st->dt2, NULL);
+    compare(st, LYD_XML, 0);
+
+    /* the notification is not expected */
+    assert_ptr_equal(lyd_parse_mem(st->ctx, st->lyb, LYD_LYB, LYD_OPT_CONFIG), NULL);
+}
+
+static void
+test_fd(void **state)
+{
+    struct state *st = (*state);
+    int fd[2];
+
+    /* the data are read from a pipe */
+    assert_int_equal(pipe(fd), 0);
+    assert_int_equal(lyd_print_fd(fd[1], st->dt, LYD_LYB, LYP_WITHSIBLINGS), 0);
+    close(fd[1]);
+    st->dt2 = lyd_parse_fd(st->ctx, fd[0], LYD_LYB, LYD_OPT_CONFIG);
+    close(fd[0]);
+    assert_ptr_not_equal(st->dt2, NULL);
+
+    compare(st, LYD_XML, LYP_WITHSIBLINGS);
+}
+
+static void
+test_truncated(void **state)
+{
+    struct state *st = (*state);
+    char *data;
+    uint32_t len, i;
+    FILE *f;
+
+    assert_int_equal(lyd_print_mem(&st->lyb, st->dt, LYD_LYB, LYP_WITHSIBLINGS), 0);
+    memcpy(&len, &st->lyb[4], 4);
+    st->dt2 = lyd_parse_mem_len(st->ctx, st->lyb, len, LYD_LYB, LYD_OPT_CONFIG);
+    assert_ptr_not_equal(st->dt2, NULL);
+    compare(st, LYD_XML, LYP_WITHSIBLINGS);
+
+    /* the truncated data are copied so that reading beyond them is detected */
+    for (i = 1; i < len; i += (i < 16 ? 1 : 7)) {
+        data = malloc(i);
+        assert_ptr_not_equal(data, NULL);
+        memcpy(data, st->lyb, i);
+        assert_ptr_equal(lyd_parse_mem_len(st->ctx, data, i, LYD_LYB, LYD_OPT_CONFIG), NULL);
+        assert_int_equal(ly_errno, LY_EVALID);
+        free(data);
+    }
+
+    /* truncated file */
+    f = tmpfile();
+    assert_ptr_not_equal(f, NULL);
+    assert_int_equal(fwrite(st->lyb, 1, len - 1, f), len - 1);
+    assert_int_equal(fflush(f), 0);
+    assert_ptr_equal(lyd_parse_fd(st->ctx, fileno(f), LYD_LYB, LYD_OPT_CONFIG), NULL);
+    assert_int_equal(ly_errno, LY_EVALID);
+    fclose(f);
+}
+
+int
+main(void)
+{
+    const struct CMUnitTest tests[] = {
+                    cmocka_unit_test_setup_teardown(test_values, setup_f, teardown_f),
+                    cmocka_unit_test_setup_teardown(test_nosiblings, setup_f, teardown_f),
+                    cmocka_unit_test_setup_teardown(test_unknown, setup_f, teardown_f),
+                    cmocka_unit_test_setup_teardown(test_invalid, setup_f, teardown_f),
+                    cmocka_unit_test_setup_teardown(test_rpc, setup_f, teardown_f),
+                    cmocka_unit_test_setup_teardown(test_fd, setup_f, teardown_f),
+                    cmocka_unit_test_setup_teardown(test_truncated, setup_f, teardown_f), };
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
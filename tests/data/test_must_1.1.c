@@ -14,6 +14,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <setjmp.h>
 #include <cmocka.h>
 
@@ -180,13 +181,99 @@ test_notif(void **state)
     assert_int_equal(lyd_validate(&(st->dt), LYD_OPT_NOTIF, NULL), 0);
 }
 
+static char *
+threads_data(int must_fail, int inst_fail)
+{
+    char *xml;
+    int i, j, len = 0;
+
+    xml = malloc(2 * 100 * 128 + 256);
+    assert_ptr_not_equal(xml, NULL);
+
+    /* the failing items are in the second subtree */
+    for (j = 0; j < 2; j++) {
+        len += sprintf(xml + len, "<%s xmlns=\"urn:libyang:tests:must-threads\" xmlns:t=\"urn:libyang:tests:must-threads\">",
+                       j ? "b" : "a");
+        for (i = 0; i < 100; i++) {
+            len += sprintf(xml + len, "<item><name>i%d</name><value>%d</value><ref>/t:%s/t:item[t:name='i%d']</ref></item>",
+                           i, (j && (i == must_fail)) ? 1 : 2, (j && (i == inst_fail)) ? "c" : "a", i);
+        }
+        len += sprintf(xml + len, "</%s>", j ? "b" : "a");
+    }
+
+    return xml;
+}
+
+static void
+test_threads(void **state)
+{
+    struct state *st = (struct state *)*state;
+    const char *sch = "module must-threads {"
+                      "  yang-version 1.1;"
+                      "  namespace \"urn:libyang:tests:must-threads\";"
+                      "  prefix t;"
+                      "  grouping items {"
+                      "    list item {"
+                      "      key name;"
+                      "      must \"value mod 2 = 0\";"
+                      "      leaf name { type string; }"
+                      "      leaf value { type uint8; must \". < 10\"; }"
+                      "      leaf ref { type instance-identifier; }"
+                      "    }"
+                      "  }"
+                      "  container a { uses items; }"
+                      "  container b { uses items; }"
+                      "  container c { presence p; }"
+                      "}";
+    /* failed must and instance-identifier indexes in the second subtree */
+    const int fails[][2] = {{-1, -1}, {10, -1}, {-1, 20}, {10, 20}, {30, 20}};
+    char *xml, msg[1024], path[1024];
+    unsigned int i, threads;
+
+    st->mod = lys_parse_mem(st->ctx, sch, LYS_IN_YANG);
+    assert_ptr_not_equal(st->mod, NULL);
+
+    assert_int_equal(ly_ctx_get_validation_threads(st->ctx), 1);
+
+    for (i = 0; i < sizeof fails / sizeof *fails; i++) {
+        xml = threads_data(fails[i][0], fails[i][1]);
+        for (threads = 1; threads <= 4; threads += 3) {
+            ly_ctx_set_validation_threads(st->ctx, threads);
+            assert_int_equal(ly_ctx_get_validation_threads(st->ctx), threads);
+
+            st->dt = lyd_parse_mem(st->ctx, xml, LYD_XML, LYD_OPT_CONFIG);
+            if ((fails[i][0] == -1) && (fails[i][1] == -1)) {
+                assert_ptr_not_equal(st->dt, NULL);
+                assert_int_equal(lyd_validate(&st->dt, LYD_OPT_CONFIG, NULL), 0);
+                lyd_free_withsiblings(st->dt);
+                st->dt = NULL;
+                continue;
+            }
+            assert_ptr_equal(st->dt, NULL);
+
+            /* the same error as without the threads */
+            if (threads == 1) {
+                strcpy(msg, ly_errmsg());
+                strcpy(path, ly_errpath());
+            } else {
+                assert_string_equal(ly_errmsg(), msg);
+                assert_string_equal(ly_errpath(), path);
+            }
+        }
+        free(xml);
+    }
+    ly_ctx_set_validation_threads(st->ctx, 0);
+    assert_int_equal(ly_ctx_get_validation_threads(st->ctx), 1);
+}
+
 int main(void)
 {
     const struct CMUnitTest tests[] = {
                     cmocka_unit_test_setup_teardown(test_dependency_rpc, setup_f, teardown_f),
                     cmocka_unit_test_setup_teardown(test_dependency_action, setup_f, teardown_f),
                     cmocka_unit_test_setup_teardown(test_inout, setup_f, teardown_f),
-                    cmocka_unit_test_setup_teardown(test_notif, setup_f, teardown_f)
+                    cmocka_unit_test_setup_teardown(test_notif, setup_f, teardown_f),
+                    cmocka_unit_test_setup_teardown(test_threads, setup_f, teardown_f)
     };
 
     return cmocka_run_group_tests(tests, NULL, NULL);
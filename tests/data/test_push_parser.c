@@ -0,0 +1,307 @@
+/**
+ * @file test_push_parser.c
+ * @brief Cmocka tests for parsing data received in chunks.
+ *
+ * Copyright (c) 2017 CESNET, z.s.p.o.
+ *
+ * This source code is licensed under BSD 3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/BSD-3-Clause
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <setjmp.h>
+#include <string.h>
+#include <unistd.h>
+#include <cmocka.h>
+
+#include "../config.h"
+#include "../../src/libyang.h"
+
+/* number of random chunk sizes tried for each document */
+#define ITERATIONS 20
+
+struct state {
+    struct ly_ctx *ctx;
+    struct lyd_node *dt;
+    char *str1;
+    char *str2;
+};
+
+static const char *schema =
+"module push {"
+"  yang-version 1.1;"
+"  namespace \"urn:libyang:tests:push\";"
+"  prefix p;"
+"  container cont {"
+"    list l {"
+"      key k;"
+"      leaf k { type string; }"
+"      leaf value { type string; }"
+"    }"
+"    leaf-list ll { type int8; }"
+"    action act {"
+"      input { leaf in { type string; } }"
+"    }"
+"  }"
+"  container other {"
+"    leaf ref { type leafref { path \"/cont/l/k\"; } }"
+"    leaf dflt { type string; default \"x\"; }"
+"  }"
+"}";
+
+static const char *xml_data =
+"<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+"<!-- the first tree -->\n"
+"<cont xmlns=\"urn:libyang:tests:push\">\n"
+"  <l><k>a</k><value><![CDATA[<not/> an </element>]]></value></l>\n"
+"  <l><k>b</k><!-- <l> --><value>x &lt;&gt; y</value></l>\n"
+"  <l xmlns:p=\"urn:libyang:tests:push\"><k>c</k><value>'/>'</value></l>\n"
+"  <ll>1</ll><ll>2</ll>\n"
+"</cont>\n"
+"<?pi data?>\n"
+"<p:other xmlns:p=\"urn:libyang:tests:push\"><p:ref>b</p:ref></p:other>\n";
+
+static const char *json_data =
+" {\n"
+"  \"push:cont\": {\n"
+"    \"l\": [\n"
+"      {\"k\": \"a\", \"value\": \"{[\\\"}\\\",]\"},\n"
+"      {\"k\": \"b\", \"value\": \"\\\\\"},\n"
+"      {\"k\": \"c\", \"value\": \"x, y\"}\n"
+"    ],\n"
+"    \"ll\": [1, 2]\n"
+"  },\n"
+"  \"push:other\": {\"ref\": \"b\"}\n"
+"}\n";
+
+static const char *xml_action =
+"<action xmlns=\"urn:ietf:params:xml:ns:yang:1\">"
+"<cont xmlns=\"urn:libyang:tests:push\"><act><in>value</in></act></cont>"
+"</action>";
+
+static const char *json_action =
+"{\"yang:action\": {\"push:cont\": {\"act\": {\"in\": \"value\"}}}}";
+
+static int
+setup_f(void **state)
+{
+    struct state *st;
+
+    (*state) = st = calloc(1, sizeof *st);
+    if (!st) {
+        fprintf(stderr, "Memory allocation error");
+        return -1;
+    }
+
+    /* libyang context */
+    st->ctx = ly_ctx_new(NULL);
+    if (!st->ctx) {
+        fprintf(stderr, "Failed to create context.\n");
+        return -1;
+    }
+
+    /* schema */
+    if (!lys_parse_mem(st->ctx, schema, LYS_IN_YANG)) {
+        fprintf(stderr, "Failed to load data model.\n");
+        return -1;
+    }
+
+    srand(1);
+    return 0;
+}
+
+static int
+teardown_f(void **state)
+{
+    struct state *st = (*state);
+
+    lyd_free_withsiblings(st->dt);
+    ly_ctx_destroy(st->ctx, NULL);
+    free(st->str1);
+    free(st->str2);
+    free(st);
+    (*state) = NULL;
+
+    return 0;
+}
+
+/* push the data in chunks of the given size, 0 for random sizes */
+static struct lyd_node *
+push(struct ly_ctx *ctx, const char *data, LYD_FORMAT format, int options, size_t chunk)
+{
+    struct lyd_push_ctx *pctx;
+    size_t len, i, n;
+
+    /* no data tree for the RPC validation */
+    pctx = lyd_push_new(ctx, format, options, NULL);
+    assert_ptr_not_equal(pctx, NULL);
+
+    len = strlen(data);
+    for (i = 0; i < len; i += n) {
+        n = chunk ? chunk : (size_t)(rand() % 16) + 1;
+        if (n > len - i) {
+            n = len - i;
+        }
+        if (lyd_push_data(pctx, &data[i], n)) {
+            lyd_push_free(pctx);
+            return NULL;
+        }
+    }
+
+    return lyd_push_finish(pctx);
+}
+
+/* check that pushing the data gives the same tree as parsing them at once */
+static void
+check_push(struct state *st, const char *data, LYD_FORMAT format, int options)
+{
+    int i;
+
+    st->dt = lyd_parse_mem(st->ctx, data, format, options, NULL);
+    assert_ptr_not_equal(st->dt, NULL);
+    lyd_print_mem(&st->str1, st->dt, LYD_XML, LYP_WITHSIBLINGS | LYP_WD_ALL);
+    lyd_free_withsiblings(st->dt);
+    st->dt = NULL;
+
+    for (i = 0; i <= ITERATIONS; i++) {
+        /* byte by byte first, then random chunks */
+        st->dt = push(st->ctx, data, format, options, i ? 0 : 1);
+        assert_ptr_not_equal(st->dt, NULL);
+
+        /* the same tree including the default nodes */
+        lyd_print_mem(&st->str2, st->dt, LYD_XML, LYP_WITHSIBLINGS | LYP_WD_ALL);
+        assert_string_equal(st->str1, st->str2);
+        free(st->str2);
+        st->str2 = NULL;
+        lyd_free_withsiblings(st->dt);
+        st->dt = NULL;
+    }
+}
+
+static void
+test_xml(void **state)
+{
+    check_push(*state, xml_data, LYD_XML, LYD_OPT_CONFIG);
+}
+
+static void
+test_json(void **state)
+{
+    check_push(*state, json_data, LYD_JSON, LYD_OPT_CONFIG);
+}
+
+static void
+test_action(void **state)
+{
+    check_push(*state, xml_action, LYD_XML, LYD_OPT_RPC);
+    free(((struct state *)*state)->str1);
+    ((struct state *)*state)->str1 = NULL;
+    check_push(*state, json_action, LYD_JSON, LYD_OPT_RPC);
+}
+
+static void
+test_nosiblings(void **state)
+{
+    struct state *st = (*state);
+
+    st->dt = push(st->ctx, xml_data, LYD_XML, LYD_OPT_CONFIG | LYD_OPT_NOSIBLINGS, 0);
+    assert_ptr_not_equal(st->dt, NULL);
+    assert_string_equal(st->dt->schema->name, "cont");
+    assert_ptr_equal(st->dt->next, NULL);
+}
+
+static void
+test_empty(void **state)
+{
+    struct state *st = (*state);
+
+    /* only the default nodes */
+    st->dt = push(st->ctx, "  <!-- nothing -->  ", LYD_XML, LYD_OPT_CONFIG, 1);
+    assert_int_equal(ly_errno, LY_SUCCESS);
+    lyd_free_withsiblings(st->dt);
+    st->dt = push(st->ctx, " \n ", LYD_JSON, LYD_OPT_CONFIG, 1);
+    assert_int_equal(ly_errno, LY_SUCCESS);
+}
+
+static void
+test_errors(void **state)
+{
+    struct state *st = (*state);
+    struct lyd_push_ctx *pctx;
+    char *data;
+    size_t len;
+
+    /* truncated data */
+    data = strdup(xml_data);
+    assert_ptr_not_equal(data, NULL);
+    len = strlen(data);
+    data[len - 10] = '\0';
+    st->dt = push(st->ctx, data, LYD_XML, LYD_OPT_CONFIG, 0);
+    assert_ptr_equal(st->dt, NULL);
+    assert_int_not_equal(ly_errno, LY_SUCCESS);
+    free(data);
+
+    data = strdup(json_data);
+    assert_ptr_not_equal(data, NULL);
+    len = strlen(data);
+    data[len - 3] = '\0';
+    st->dt = push(st->ctx, data, LYD_JSON, LYD_OPT_CONFIG, 0);
+    assert_ptr_equal(st->dt, NULL);
+    assert_int_not_equal(ly_errno, LY_SUCCESS);
+    free(data);
+
+    /* invalid data are reported as soon as they are received */
+    pctx = lyd_push_new(st->ctx, LYD_XML, LYD_OPT_CONFIG);
+    assert_ptr_not_equal(pctx, NULL);
+    assert_int_equal(lyd_push_data(pctx, "<cont xmlns=\"urn:libyang:tests:push\"><ll>1</ll>", 47), 0);
+    assert_int_not_equal(lyd_push_data(pctx, "<ll>x</ll></cont><other", 23), 0);
+    assert_int_not_equal(lyd_push_data(pctx, "/>", 2), 0);
+    assert_ptr_equal(lyd_push_finish(pctx), NULL);
+
+    pctx = lyd_push_new(st->ctx, LYD_JSON, LYD_OPT_CONFIG);
+    assert_ptr_not_equal(pctx, NULL);
+    assert_int_not_equal(lyd_push_data(pctx, "  [", 3), 0);
+    lyd_push_free(pctx);
+
+    /* the leafref target is missing */
+    st->dt = push(st->ctx, "{\"push:other\": {\"ref\": \"z\"}}", LYD_JSON, LYD_OPT_CONFIG, 1);
+    assert_ptr_equal(st->dt, NULL);
+    assert_int_equal(ly_errno, LY_EVALID);
+}
+
+static void
+test_pipe(void **state)
+{
+    struct state *st = (*state);
+    int fd[2];
+
+    /* the data fit into the pipe buffer */
+    assert_int_equal(pipe(fd), 0);
+    assert_int_equal(write(fd[1], xml_data, strlen(xml_data)), strlen(xml_data));
+    close(fd[1]);
+
+    st->dt = lyd_parse_fd(st->ctx, fd[0], LYD_XML, LYD_OPT_CONFIG);
+    close(fd[0]);
+    assert_ptr_not_equal(st->dt, NULL);
+    assert_string_equal(st->dt->schema->name, "cont");
+    assert_string_equal(st->dt->next->schema->name, "other");
+}
+
+int
+main(void)
+{
+    const struct CMUnitTest tests[] = {
+                    cmocka_unit_test_setup_teardown(test_xml, setup_f, teardown_f),
+                    cmocka_unit_test_setup_teardown(test_json, setup_f, teardown_f),
+                    cmocka_unit_test_setup_teardown(test_action, setup_f, teardown_f),
+                    cmocka_unit_test_setup_teardown(test_nosiblings, setup_f, teardown_f),
+                    cmocka_unit_test_setup_teardown(test_empty, setup_f, teardown_f),
+                    cmocka_unit_test_setup_teardown(test_errors, setup_f, teardown_f),
+                    cmocka_unit_test_setup_teardown(test_pipe, setup_f, teardown_f), };
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
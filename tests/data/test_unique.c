@@ -143,6 +143,116 @@ test_un_empty(void **state)
     assert_ptr_not_equal(st->dt, NULL);
 }
 
+static struct lyd_node_leaf_list *
+find_leaf(struct lyd_node *root, const char *path)
+{
+    struct ly_set *set;
+    struct lyd_node *node;
+
+    set = lyd_find_xpath(root, path);
+    assert_ptr_not_equal(set, NULL);
+    assert_int_equal(set->number, 1);
+    node = set->set.d[0];
+    ly_set_free(set);
+
+    return (struct lyd_node_leaf_list *)node;
+}
+
+static void
+test_un_many(void **state)
+{
+    struct state *st = (*state);
+    char xml[2048];
+    int i, len;
+
+    /* enough instances to be indexed */
+    len = sprintf(xml, "<un xmlns=\"urn:libyang:tests:unique\">");
+    for (i = 0; i < 20; i++) {
+        len += sprintf(xml + len, "<list><name>x%d</name><value>%d</value><a>%d</a></list>", i, i, i);
+    }
+    sprintf(xml + len, "</un>");
+
+    st->dt = lyd_parse_mem(st->ctx, xml, LYD_XML, LYD_OPT_CONFIG);
+    assert_ptr_not_equal(st->dt, NULL);
+    assert_int_equal(lyd_validate(&st->dt, LYD_OPT_CONFIG, NULL), 0);
+
+    /* changed values */
+    assert_int_equal(lyd_change_leaf(find_leaf(st->dt, "/unique:un/list[name='x15']/value"), "3"), 0);
+    assert_int_equal(lyd_validate(&st->dt, LYD_OPT_CONFIG, NULL), 0);
+    assert_int_equal(lyd_change_leaf(find_leaf(st->dt, "/unique:un/list[name='x15']/a"), "3"), 0);
+    assert_int_not_equal(lyd_validate(&st->dt, LYD_OPT_CONFIG, NULL), 0);
+    assert_int_equal(ly_vecode, LYVE_NOUNIQ);
+    assert_string_equal(ly_errmsg(), "Unique data leaf(s) \"value a\" not satisfied in \"/unique:un/list[name='x3']\" and \"/unique:un/list[name='x15']\".");
+
+    /* swapped values */
+    assert_int_equal(lyd_change_leaf(find_leaf(st->dt, "/unique:un/list[name='x3']/a"), "15"), 0);
+    assert_int_equal(lyd_change_leaf(find_leaf(st->dt, "/unique:un/list[name='x3']/value"), "15"), 0);
+    assert_int_equal(lyd_validate(&st->dt, LYD_OPT_CONFIG | LYD_OPT_INCREMENTAL, NULL), 0);
+
+    /* removed value replaced by its default */
+    assert_int_equal(lyd_change_leaf(find_leaf(st->dt, "/unique:un/list[name='x7']/a"), "42"), 0);
+    assert_int_equal(lyd_change_leaf(find_leaf(st->dt, "/unique:un/list[name='x8']/value"), "7"), 0);
+    assert_int_equal(lyd_validate(&st->dt, LYD_OPT_CONFIG | LYD_OPT_INCREMENTAL, NULL), 0);
+    lyd_free((struct lyd_node *)find_leaf(st->dt, "/unique:un/list[name='x8']/a"));
+    assert_int_not_equal(lyd_validate(&st->dt, LYD_OPT_CONFIG | LYD_OPT_INCREMENTAL, NULL), 0);
+    assert_int_equal(ly_vecode, LYVE_NOUNIQ);
+
+    /* removed duplicate instance */
+    lyd_free(find_leaf(st->dt, "/unique:un/list[name='x7']/a")->parent);
+    assert_int_equal(lyd_validate(&st->dt, LYD_OPT_CONFIG | LYD_OPT_INCREMENTAL, NULL), 0);
+
+    /* new instance */
+    assert_ptr_not_equal(lyd_new_path(st->dt, NULL, "/unique:un/list[name='y']/value", "8", 0, 0), NULL);
+    assert_int_equal(lyd_validate(&st->dt, LYD_OPT_CONFIG, NULL), 0);
+    assert_ptr_not_equal(lyd_new_path(st->dt, NULL, "/unique:un/list[name='z']/value", "7", 0, 0), NULL);
+    assert_int_not_equal(lyd_validate(&st->dt, LYD_OPT_CONFIG, NULL), 0);
+    assert_int_equal(ly_vecode, LYVE_NOUNIQ);
+}
+
+static void
+test_un_revalidate(void **state)
+{
+    struct state *st = (*state);
+
+    st->dt = lyd_new_path(NULL, st->ctx, "/unique:un/list[name='x']/value", "1", 0, 0);
+    assert_ptr_not_equal(st->dt, NULL);
+    assert_ptr_not_equal(lyd_new_path(st->dt, NULL, "/unique:un/list[name='x']/a", "1", 0, 0), NULL);
+    assert_ptr_not_equal(lyd_new_path(st->dt, NULL, "/unique:un/list[name='y']/value", "1", 0, 0), NULL);
+    assert_ptr_not_equal(lyd_new_path(st->dt, NULL, "/unique:un/list[name='y']/a", "1", 0, 0), NULL);
+
+    /* the failed check does not make the instances unique */
+    assert_int_not_equal(lyd_validate(&st->dt, LYD_OPT_CONFIG, NULL), 0);
+    assert_int_equal(ly_vecode, LYVE_NOUNIQ);
+    assert_int_not_equal(lyd_validate(&st->dt, LYD_OPT_CONFIG, NULL), 0);
+    assert_int_equal(ly_vecode, LYVE_NOUNIQ);
+
+    assert_int_equal(lyd_change_leaf(find_leaf(st->dt, "/unique:un/list[name='y']/a"), "2"), 0);
+    assert_int_equal(lyd_validate(&st->dt, LYD_OPT_CONFIG, NULL), 0);
+}
+
+static void
+test_un_child_added(void **state)
+{
+    struct state *st = (*state);
+    const char *sch = "module unique3 {namespace urn:libyang:tests:unique3; prefix un3;"
+                      "container c {list l {key k; unique v; leaf k {type string;} leaf v {type string;}"
+                      "leaf w {type string;}}}}";
+    struct lyd_node *node;
+
+    assert_ptr_not_equal(lys_parse_mem(st->ctx, sch, LYS_IN_YANG), NULL);
+    st->dt = lyd_new_path(NULL, st->ctx, "/unique3:c/l[k='a']/v", "x", 0, 0);
+    assert_ptr_not_equal(st->dt, NULL);
+    assert_ptr_not_equal(lyd_new_path(st->dt, NULL, "/unique3:c/l[k='b']/v", "y", 0, 0), NULL);
+    assert_int_equal(lyd_validate(&st->dt, LYD_OPT_CONFIG, NULL), 0);
+
+    /* the changed instance is checked even after another child is added into it */
+    node = (struct lyd_node *)find_leaf(st->dt, "/unique3:c/l[k='b']/v");
+    assert_int_equal(lyd_change_leaf((struct lyd_node_leaf_list *)node, "x"), 0);
+    assert_ptr_not_equal(lyd_new_leaf(node->parent, NULL, "w", "1"), NULL);
+    assert_int_not_equal(lyd_validate(&st->dt, LYD_OPT_CONFIG, NULL), 0);
+    assert_int_equal(ly_vecode, LYVE_NOUNIQ);
+}
+
 static void
 test_schema_inpath(void **state)
 {
@@ -169,6 +279,9 @@ int main(void)
                     cmocka_unit_test_setup_teardown(test_un_correct, setup_f, teardown_f),
                     cmocka_unit_test_setup_teardown(test_un_defaults, setup_f, teardown_f),
                     cmocka_unit_test_setup_teardown(test_un_empty, setup_f, teardown_f),
+                    cmocka_unit_test_setup_teardown(test_un_many, setup_f, teardown_f),
+                    cmocka_unit_test_setup_teardown(test_un_revalidate, setup_f, teardown_f),
+                    cmocka_unit_test_setup_teardown(test_un_child_added, setup_f, teardown_f),
                     cmocka_unit_test_setup_teardown(test_schema_inpath, setup_f, teardown_f),
     };
 
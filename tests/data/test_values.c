@@ -344,6 +344,75 @@ test_validate_value(void **state)
     assert_int_equal(lyd_validate_value(c, "alfa "), EXIT_FAILURE);
 }
 
+static int union_clb_count;
+
+static void
+union_clb(LY_LOG_LEVEL level, const char *msg, const char *path)
+{
+    (void)level;
+    (void)msg;
+    (void)path;
+    ++union_clb_count;
+}
+
+/*
+ * the errors of the union member types are only stored, the final error must still have its message and path
+ */
+static void
+test_union_errors(void **state)
+{
+    struct state *st = (*state);
+    void (*prev_clb)(LY_LOG_LEVEL, const char *, const char *);
+    const char *yang = "module x {"
+                    "  namespace urn:x;"
+                    "  prefix x;"
+                    "  list l {"
+                    "    key k;"
+                    "    leaf k { type string; }"
+                    "    leaf-list u {"
+                    "      type union {"
+                    "        type int8 { range 1..5 { error-message \"out of range\"; } }"
+                    "        type string { pattern '[a-z]+-[0-9]+' { error-app-tag \"no-match\"; } }"
+                    "        type enumeration { enum one; }"
+                    "      }"
+                    "    }"
+                    "    leaf r { type leafref { path ../u; } }"
+                    "  }"
+                    "}";
+
+    assert_ptr_not_equal(lys_parse_mem(st->ctx, yang, LYS_IN_YANG), NULL);
+
+    prev_clb = ly_get_log_clb();
+    ly_set_log_clb(union_clb, 1);
+    union_clb_count = 0;
+
+    /* the value matches only the last member types, no error is printed */
+    st->dt = lyd_parse_mem(st->ctx, "<l xmlns=\"urn:x\"><k>a</k><u>one</u><u>abc-1</u><r>one</r></l>",
+                           LYD_XML, LYD_OPT_CONFIG);
+    assert_ptr_not_equal(st->dt, NULL);
+    assert_int_equal(union_clb_count, 0);
+    lyd_free_withsiblings(st->dt);
+
+    /* the value matches none of them */
+    st->dt = lyd_parse_mem(st->ctx, "<l xmlns=\"urn:x\"><k>a</k><u>one</u><u>10</u></l>", LYD_XML, LYD_OPT_CONFIG);
+    assert_ptr_equal(st->dt, NULL);
+    assert_int_equal(union_clb_count, 1);
+    assert_int_equal(ly_vecode, LYVE_INVAL);
+    assert_string_equal(ly_errmsg(), "Invalid value \"10\" in \"u\" element.");
+    assert_string_equal(ly_errpath(), "/x:l[k='a']/u[.='10']");
+    assert_string_equal(ly_errapptag(), "");
+
+    /* error of the leafref to a union value found during the validation */
+    union_clb_count = 0;
+    st->dt = lyd_parse_mem(st->ctx, "<l xmlns=\"urn:x\"><k>a</k><u>3</u><r>4</r></l>", LYD_XML, LYD_OPT_CONFIG);
+    assert_ptr_equal(st->dt, NULL);
+    assert_int_not_equal(union_clb_count, 0);
+    assert_int_equal(ly_vecode, LYVE_NOLEAFREF);
+    assert_string_equal(ly_errpath(), "/x:l[k='a']/r");
+
+    ly_set_log_clb(prev_clb, 1);
+}
+
 int main(void)
 {
     const struct CMUnitTest tests[] = {
@@ -352,7 +421,8 @@ int main(void)
                     cmocka_unit_test_setup_teardown(test_xmltojson_identityref2, setup_f, teardown_f),
                     cmocka_unit_test_setup_teardown(test_xmltojson_instanceid, setup_f, teardown_f),
                     cmocka_unit_test_setup_teardown(test_canonical, setup_f, teardown_f),
-                    cmocka_unit_test_setup_teardown(test_validate_value, setup_f, teardown_f),};
+                    cmocka_unit_test_setup_teardown(test_validate_value, setup_f, teardown_f),
+                    cmocka_unit_test_setup_teardown(test_union_errors, setup_f, teardown_f),};
 
     return cmocka_run_group_tests(tests, NULL, NULL);
 }
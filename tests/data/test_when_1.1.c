@@ -234,6 +234,53 @@ test_unlink_all(void **state)
     assert_string_equal(st->xml, "<a xmlns=\"urn:libyang:tests:when-unlinkall\">val_a</a>");
 }
 
+static void
+test_dependency_chain(void **state)
+{
+    struct state *st = (struct state *)*state;
+    struct lyd_val_stats stats;
+    const char *schema =
+    "module when-chain {"
+    "  yang-version 1.1;"
+    "  namespace \"urn:libyang:tests:when-chain\";"
+    "  prefix wc;"
+    "  container top {"
+    "    leaf a { type string; when \"../b\"; }"
+    "    leaf b { type string; when \"../c\"; }"
+    "    leaf c { type string; when \"../d = 'x'\"; }"
+    "    leaf d { type string; }"
+    "  }"
+    "}";
+
+    /* schema */
+    st->mod = lys_parse_mem(st->ctx, schema, LYS_IN_YANG);
+    assert_ptr_not_equal(st->mod, NULL);
+
+    /* every condition depends on the following sibling */
+    lyd_validation_stats(NULL);
+    st->dt = lyd_parse_mem(st->ctx, "<top xmlns=\"urn:libyang:tests:when-chain\"><a>a</a><b>b</b><c>c</c><d>x</d></top>",
+                           LYD_XML, LYD_OPT_CONFIG);
+    assert_ptr_not_equal(st->dt, NULL);
+    lyd_print_mem(&(st->xml), st->dt, LYD_XML, LYP_WITHSIBLINGS);
+    assert_string_equal(st->xml, "<top xmlns=\"urn:libyang:tests:when-chain\"><a>a</a><b>b</b><c>c</c><d>x</d></top>");
+
+    /* a and b are evaluated again only after the condition they refer to is resolved */
+    lyd_validation_stats(&stats);
+    assert_int_equal(stats.when, 5);
+    assert_int_equal(stats.leafref, 0);
+    lyd_validation_stats(&stats);
+    assert_int_equal(stats.when, 0);
+    lyd_free_withsiblings(st->dt);
+    free(st->xml);
+
+    /* the whole chain is auto-deleted */
+    st->dt = lyd_parse_mem(st->ctx, "<top xmlns=\"urn:libyang:tests:when-chain\"><a>a</a><b>b</b><c>c</c><d>y</d></top>",
+                           LYD_XML, LYD_OPT_CONFIG);
+    assert_ptr_not_equal(st->dt, NULL);
+    lyd_print_mem(&(st->xml), st->dt, LYD_XML, LYP_WITHSIBLINGS);
+    assert_string_equal(st->xml, "<top xmlns=\"urn:libyang:tests:when-chain\"><d>y</d></top>");
+}
+
 int main(void)
 {
     const struct CMUnitTest tests[] = {
@@ -244,7 +291,8 @@ int main(void)
                     cmocka_unit_test_setup_teardown(test_dummy, setup_f, teardown_f),
                     cmocka_unit_test_setup_teardown(test_dependency_autodel, setup_f, teardown_f),
                     cmocka_unit_test_setup_teardown(test_dependency_circular, setup_f, teardown_f),
-                    cmocka_unit_test_setup_teardown(test_unlink_all, setup_f, teardown_f)
+                    cmocka_unit_test_setup_teardown(test_unlink_all, setup_f, teardown_f),
+                    cmocka_unit_test_setup_teardown(test_dependency_chain, setup_f, teardown_f)
     };
 
     return cmocka_run_group_tests(tests, NULL, NULL);
@@ -0,0 +1,255 @@
+/**
+ * @file test_xml_stream.c
+ * @brief Cmocka tests for parsing XML data directly, without the XML tree.
+ *
+ * Copyright (c) 2017 CESNET, z.s.p.o.
+ *
+ * This source code is licensed under BSD 3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/BSD-3-Clause
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <setjmp.h>
+#include <string.h>
+#include <cmocka.h>
+
+#include "../config.h"
+#include "../../src/libyang.h"
+
+struct state {
+    struct ly_ctx *ctx;
+    struct lyd_node *dt;
+    struct lyd_node *dt2;
+    char *str1;
+    char *str2;
+};
+
+static const char *schema =
+"module stream {"
+"  yang-version 1.1;"
+"  namespace \"urn:libyang:tests:stream\";"
+"  prefix s;"
+"  container c {"
+"    list l {"
+"      key k;"
+"      leaf k { type string; }"
+"      leaf-list ll { type int8; }"
+"      container in {"
+"        leaf v { type string; }"
+"        anydata any;"
+"      }"
+"      action act {"
+"        input { leaf i { type string; } }"
+"      }"
+"    }"
+"    container empty {"
+"      presence p;"
+"    }"
+"  }"
+"  rpc r {"
+"    input { leaf x { type string; } }"
+"  }"
+"}";
+
+static const char *schema_aug =
+"module stream-aug {"
+"  namespace \"urn:libyang:tests:stream-aug\";"
+"  prefix sa;"
+"  import stream { prefix s; }"
+"  augment /s:c/s:l/s:in { leaf a { type string; } }"
+"}";
+
+static const char *action =
+"<action xmlns=\"urn:ietf:params:xml:ns:yang:1\">"
+"<c xmlns=\"urn:libyang:tests:stream\"><l><k>a</k><act><i>1</i></act></l></c>"
+"</action>";
+
+static int
+setup_f(void **state)
+{
+    struct state *st;
+
+    (*state) = st = calloc(1, sizeof *st);
+    if (!st) {
+        fprintf(stderr, "Memory allocation error");
+        return -1;
+    }
+
+    /* libyang context */
+    st->ctx = ly_ctx_new(NULL);
+    if (!st->ctx) {
+        fprintf(stderr, "Failed to create context.\n");
+        return -1;
+    }
+
+    /* schemas */
+    if (!lys_parse_mem(st->ctx, schema, LYS_IN_YANG) || !lys_parse_mem(st->ctx, schema_aug, LYS_IN_YANG)) {
+        fprintf(stderr, "Failed to load data model.\n");
+        return -1;
+    }
+
+    return 0;
+}
+
+static int
+teardown_f(void **state)
+{
+    struct state *st = (*state);
+
+    lyd_free_withsiblings(st->dt);
+    lyd_free_withsiblings(st->dt2);
+    ly_ctx_destroy(st->ctx, NULL);
+    free(st->str1);
+    free(st->str2);
+    free(st);
+    (*state) = NULL;
+
+    return 0;
+}
+
+/* parse the data directly and from the XML tree, the results must be the same */
+static struct lyd_node *
+parse(struct state *st, const char *data, int options)
+{
+    struct lyxml_elem *xml;
+    int ret, vecode;
+
+    lyd_free_withsiblings(st->dt);
+    lyd_free_withsiblings(st->dt2);
+    st->dt = lyd_parse_mem(st->ctx, data, LYD_XML, options, NULL);
+    vecode = ly_vecode;
+    ret = ly_errno;
+
+    xml = lyxml_parse_mem(st->ctx, data, LYXML_PARSE_MULTIROOT);
+    if (xml) {
+        st->dt2 = lyd_parse_xml(st->ctx, &xml, options, NULL);
+        lyxml_free_withsiblings(st->ctx, xml);
+    } else {
+        st->dt2 = NULL;
+    }
+    assert_int_equal(ret, ly_errno);
+    assert_int_equal(vecode, ly_vecode);
+
+    if (st->dt) {
+        assert_ptr_not_equal(st->dt2, NULL);
+        free(st->str1);
+        free(st->str2);
+        lyd_print_mem(&st->str1, st->dt, LYD_XML, LYP_WITHSIBLINGS);
+        lyd_print_mem(&st->str2, st->dt2, LYD_XML, LYP_WITHSIBLINGS);
+        assert_string_equal(st->str1, st->str2);
+    } else {
+        assert_ptr_equal(st->dt2, NULL);
+    }
+
+    return st->dt;
+}
+
+static void
+test_inner_nodes(void **state)
+{
+    struct state *st = (*state);
+
+    /* namespaces declared in the ancestors, comments, whitespaces and empty inner nodes between the children */
+    assert_ptr_not_equal(parse(st, "<?xml version=\"1.0\"?>\n"
+                               "<s:c xmlns:s=\"urn:libyang:tests:stream\" xmlns:sa=\"urn:libyang:tests:stream-aug\">\n"
+                               "  <!-- first -->\n"
+                               "  <s:l><s:k>a</s:k><s:ll>1</s:ll><s:ll>2</s:ll>\n"
+                               "    <s:in><s:v><![CDATA[<x>]]></s:v><sa:a>y</sa:a></s:in>\n"
+                               "  </s:l>\n"
+                               "  <s:l><s:in/><s:k>b</s:k></s:l>\n"
+                               "  <s:empty></s:empty>\n"
+                               "</s:c>", LYD_OPT_CONFIG), NULL);
+    assert_string_equal(st->str1, "<c xmlns=\"urn:libyang:tests:stream\">"
+                        "<l><k>a</k><ll>1</ll><ll>2</ll><in><v>&lt;x&gt;</v><a xmlns=\"urn:libyang:tests:stream-aug\">y</a></in></l>"
+                        "<l><k>b</k></l><empty/></c>");
+
+    /* anydata keeps the XML tree */
+    assert_ptr_not_equal(parse(st, "<c xmlns=\"urn:libyang:tests:stream\"><l><k>a</k><in><any><x><y>1</y></x></any></in></l></c>",
+                               LYD_OPT_CONFIG), NULL);
+    assert_string_equal(st->str1, "<c xmlns=\"urn:libyang:tests:stream\"><l><k>a</k><in><any>"
+                        "<x xmlns=\"urn:libyang:tests:stream\"><y>1</y></x></any></in></l></c>");
+
+    /* a container with mixed content is ignored, the same as when parsed from the XML tree */
+    assert_ptr_not_equal(parse(st, "<c xmlns=\"urn:libyang:tests:stream\"><l><k>a</k><in><v>x</v>text</in></l></c>",
+                               LYD_OPT_CONFIG), NULL);
+    assert_string_equal(st->str1, "<c xmlns=\"urn:libyang:tests:stream\"><l><k>a</k></l></c>");
+}
+
+static void
+test_inner_errors(void **state)
+{
+    struct state *st = (*state);
+
+    /* unknown inner node */
+    assert_ptr_equal(parse(st, "<c xmlns=\"urn:libyang:tests:stream\"><l><k>a</k><in><u/></in></l></c>",
+                           LYD_OPT_CONFIG | LYD_OPT_STRICT), NULL);
+    assert_int_equal(ly_vecode, LYVE_INELEM);
+
+    /* wrong end tag */
+    assert_ptr_equal(parse(st, "<c xmlns=\"urn:libyang:tests:stream\"><l><k>a</k></in></c>", LYD_OPT_CONFIG), NULL);
+
+    /* unterminated inner node */
+    assert_ptr_equal(parse(st, "<c xmlns=\"urn:libyang:tests:stream\"><l><k>a</k>", LYD_OPT_CONFIG), NULL);
+}
+
+static void
+test_trailing_garbage(void **state)
+{
+    struct state *st = (*state);
+
+    assert_ptr_equal(parse(st, "<c xmlns=\"urn:libyang:tests:stream\"/>garbage", LYD_OPT_CONFIG), NULL);
+    assert_int_equal(ly_vecode, LYVE_XML_INCHAR);
+
+    assert_ptr_equal(parse(st, "<r xmlns=\"urn:libyang:tests:stream\"><x>1</x></r> garbage", LYD_OPT_RPC), NULL);
+    assert_int_equal(ly_vecode, LYVE_XML_INCHAR);
+}
+
+static void
+test_trailing_action(void **state)
+{
+    struct state *st = (*state);
+    struct lyd_push_ctx *pctx;
+    char data[512];
+
+    /* just comments after the action */
+    sprintf(data, "%s <!-- comment --> ", action);
+    st->dt = lyd_parse_mem(st->ctx, data, LYD_XML, LYD_OPT_RPC, NULL);
+    assert_ptr_not_equal(st->dt, NULL);
+    lyd_free_withsiblings(st->dt);
+
+    sprintf(data, "%s garbage", action);
+    st->dt = lyd_parse_mem(st->ctx, data, LYD_XML, LYD_OPT_RPC, NULL);
+    assert_ptr_equal(st->dt, NULL);
+    assert_int_equal(ly_vecode, LYVE_XML_INCHAR);
+
+    /* another element */
+    sprintf(data, "%s<r xmlns=\"urn:libyang:tests:stream\"/>", action);
+    st->dt = lyd_parse_mem(st->ctx, data, LYD_XML, LYD_OPT_RPC, NULL);
+    assert_ptr_equal(st->dt, NULL);
+    assert_int_equal(ly_vecode, LYVE_XML_INVAL);
+
+    /* pushed after the action was parsed */
+    pctx = lyd_push_new(st->ctx, LYD_XML, LYD_OPT_RPC, NULL);
+    assert_ptr_not_equal(pctx, NULL);
+    assert_int_equal(lyd_push_data(pctx, action, strlen(action)), 0);
+    assert_int_equal(lyd_push_data(pctx, "<r", 2), 0);
+    st->dt = lyd_push_finish(pctx);
+    assert_ptr_equal(st->dt, NULL);
+    assert_int_equal(ly_vecode, LYVE_XML_INVAL);
+}
+
+int
+main(void)
+{
+    const struct CMUnitTest tests[] = {
+                    cmocka_unit_test_setup_teardown(test_inner_nodes, setup_f, teardown_f),
+                    cmocka_unit_test_setup_teardown(test_inner_errors, setup_f, teardown_f),
+                    cmocka_unit_test_setup_teardown(test_trailing_garbage, setup_f, teardown_f),
+                    cmocka_unit_test_setup_teardown(test_trailing_action, setup_f, teardown_f), };
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,99 @@
+/**
+ * @file dict.c
+ * @brief performance test - interning and releasing strings in the dictionary.
+ *
+ * Copyright (c) 2017 CESNET, z.s.p.o.
+ *
+ * This source code is licensed under BSD 3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/BSD-3-Clause
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/resource.h>
+
+#include <libyang/libyang.h>
+
+static double
+elapsed(struct timespec *start, struct timespec *end)
+{
+    return (end->tv_sec - start->tv_sec) + (end->tv_nsec - start->tv_nsec) / 1e9;
+}
+
+static void
+report(const char *what, unsigned long ops, struct timespec *start, struct timespec *end)
+{
+    double secs = elapsed(start, end);
+
+    printf("%-24s: %8.3f s, %10.0f ops/s\n", what, secs, ops / secs);
+}
+
+int
+main(int argc, char *argv[])
+{
+    unsigned long i, count = 10000000;
+    char buf[32];
+    const char **strings;
+    struct ly_ctx *ctx;
+    struct timespec start, end;
+    struct rusage usage;
+
+    if (argc > 1) {
+        count = strtoul(argv[1], NULL, 10);
+    }
+
+    strings = malloc(count * sizeof *strings);
+    if (!strings) {
+        fprintf(stderr, "Memory allocation failed.\n");
+        return 1;
+    }
+
+    ctx = ly_ctx_new(NULL);
+    if (!ctx) {
+        fprintf(stderr, "Failed to create context.\n");
+        free(strings);
+        return 1;
+    }
+
+    printf("strings                 : %lu\n", count);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < count; i++) {
+        sprintf(buf, "value-%lu", i);
+        strings[i] = lydict_insert(ctx, buf, 0);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    report("insert (new)", count, &start, &end);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < count; i++) {
+        sprintf(buf, "value-%lu", i);
+        if (lydict_insert(ctx, buf, 0) != strings[i]) {
+            fprintf(stderr, "Dictionary returned a different string for \"%s\".\n", buf);
+            break;
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    report("insert (existing)", count, &start, &end);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < count; i++) {
+        lydict_remove(ctx, strings[i]);
+        lydict_remove(ctx, strings[i]);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    report("remove", 2 * count, &start, &end);
+
+    getrusage(RUSAGE_SELF, &usage);
+    printf("peak RSS                : %ld kB\n", usage.ru_maxrss);
+
+    ly_ctx_destroy(ctx, NULL);
+    free(strings);
+
+    return 0;
+}
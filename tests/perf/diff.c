@@ -0,0 +1,149 @@
+/**
+ * @file diff.c
+ * @brief performance test - comparing two large data trees differing in a few list entries.
+ *
+ * Copyright (c) 2017 CESNET, z.s.p.o.
+ *
+ * This source code is licensed under BSD 3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/BSD-3-Clause
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <libyang/libyang.h>
+
+static const char *schema =
+"module diff-perf {"
+"  namespace \"urn:libyang:performance:diff\";"
+"  prefix dp;"
+"  container top {"
+"    list item {"
+"      key name;"
+"      leaf name { type string; }"
+"      leaf value { type uint32; }"
+"      leaf port { type uint32; }"
+"    }"
+"    list rule {"
+"      key id;"
+"      ordered-by user;"
+"      leaf id { type uint32; }"
+"      leaf action { type string; }"
+"    }"
+"  }"
+"}";
+
+static double
+elapsed(struct timespec *start, struct timespec *end)
+{
+    return (end->tv_sec - start->tv_sec) + (end->tv_nsec - start->tv_nsec) / 1e9;
+}
+
+/* variant 1 changes 5 values, deletes 2 and creates 2 items and moves 3 rules */
+static char *
+generate(int count, int variant)
+{
+    char *data;
+    size_t used;
+    int i, rules = count / 10;
+
+    data = malloc(256 + count * 96 + rules * 64);
+    if (!data) {
+        return NULL;
+    }
+
+    used = sprintf(data, "<top xmlns=\"urn:libyang:performance:diff\">");
+    for (i = 0; i < count; i++) {
+        if (variant && ((i == count / 3) || (i == count / 2))) {
+            continue;
+        }
+        used += sprintf(data + used, "<item><name>i%d</name><value>%d</value><port>%d</port></item>",
+                        i, (variant && !(i % (count / 5))) ? i + 1 : i, i);
+    }
+    if (variant) {
+        used += sprintf(data + used, "<item><name>n1</name><value>1</value></item><item><name>n2</name></item>");
+    }
+    for (i = 0; i < rules; i++) {
+        if (variant && ((i == 1) || (i == rules / 2) || (i == rules - 2))) {
+            continue;
+        }
+        used += sprintf(data + used, "<rule><id>%d</id><action>a%d</action></rule>", i, i % 3);
+        if (variant && (i == rules - 1)) {
+            used += sprintf(data + used, "<rule><id>%d</id><action>a%d</action></rule>", rules / 2, (rules / 2) % 3);
+            used += sprintf(data + used, "<rule><id>%d</id><action>a%d</action></rule>", rules - 2, (rules - 2) % 3);
+        } else if (variant && (i == 2)) {
+            used += sprintf(data + used, "<rule><id>%d</id><action>a%d</action></rule>", 1, 1);
+        }
+    }
+    sprintf(data + used, "</top>");
+
+    return data;
+}
+
+int
+main(int argc, char *argv[])
+{
+    int i, count = 250000, ret = 1;
+    char *data1 = NULL, *data2 = NULL;
+    struct ly_ctx *ctx = NULL;
+    struct lyd_node *first = NULL, *second = NULL;
+    struct lyd_difflist *diff;
+    struct timespec start, end;
+
+    if (argc > 1) {
+        count = atoi(argv[1]);
+    }
+    if (count < 20) {
+        count = 20;
+    }
+
+    ctx = ly_ctx_new(NULL);
+    if (!ctx) {
+        fprintf(stderr, "Failed to create context.\n");
+        goto cleanup;
+    }
+    if (!lys_parse_mem(ctx, schema, LYS_IN_YANG)) {
+        fprintf(stderr, "Failed to load data model.\n");
+        goto cleanup;
+    }
+
+    data1 = generate(count, 0);
+    data2 = generate(count, 1);
+    if (!data1 || !data2) {
+        fprintf(stderr, "Memory allocation error.\n");
+        goto cleanup;
+    }
+    first = lyd_parse_mem(ctx, data1, LYD_XML, LYD_OPT_CONFIG);
+    second = lyd_parse_mem(ctx, data2, LYD_XML, LYD_OPT_CONFIG);
+    if (!first || !second) {
+        fprintf(stderr, "Failed to parse data.\n");
+        goto cleanup;
+    }
+
+    printf("comparing two trees with %d list entries (%d nodes)\n", count + count / 10, count * 4 + count / 10 * 3);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    diff = lyd_diff(first, second, 0);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    if (!diff) {
+        fprintf(stderr, "Failed to compare data.\n");
+        goto cleanup;
+    }
+    for (i = 0; diff->type[i] != LYD_DIFF_END; i++);
+    lyd_free_diff(diff);
+
+    printf("%-12s: %8.3f s, %d differences\n", "diff", elapsed(&start, &end), i);
+    ret = 0;
+
+cleanup:
+    lyd_free_withsiblings(first);
+    lyd_free_withsiblings(second);
+    ly_ctx_destroy(ctx, NULL);
+    free(data1);
+    free(data2);
+    return ret;
+}
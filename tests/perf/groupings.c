@@ -0,0 +1,214 @@
+/**
+ * @file groupings.c
+ * @brief performance test - loading modules with groupings reused in the OpenConfig style with copying the nested
+ * groupings and with sharing them.
+ *
+ * Copyright (c) 2017 CESNET, z.s.p.o.
+ *
+ * This source code is licensed under BSD 3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/BSD-3-Clause
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include <libyang/libyang.h>
+
+static double
+elapsed(struct timespec *start, struct timespec *end)
+{
+    return (end->tv_sec - start->tv_sec) + (end->tv_nsec - start->tv_nsec) / 1e9;
+}
+
+static long
+rss_kb(void)
+{
+    char line[256];
+    long rss = 0;
+    FILE *f;
+
+    f = fopen("/proc/self/status", "r");
+    if (!f) {
+        return 0;
+    }
+    while (fgets(line, sizeof line, f)) {
+        if (!strncmp(line, "VmRSS:", 6)) {
+            rss = atol(line + 6);
+            break;
+        }
+    }
+    fclose(f);
+    return rss;
+}
+
+/* common types and the config/state groupings used by all the other modules */
+static const char *types =
+"module oc-types {"
+"  namespace \"urn:libyang:performance:groupings:types\";"
+"  prefix oct;"
+"  identity protocol;"
+"  identity static { base protocol; }"
+"  identity dynamic { base protocol; }"
+"  typedef ip-address { type union {"
+"    type string { pattern '([0-9]{1,3}\\.){3}[0-9]{1,3}'; }"
+"    type string { pattern '[0-9a-fA-F:\\.]*'; }"
+"  } }"
+"  typedef admin-state { type enumeration { enum UP; enum DOWN; enum TESTING; } }"
+"  typedef counter { type uint64; units packets; }"
+"  grouping counters {"
+"    leaf in-pkts { type counter; }"
+"    leaf in-octets { type counter; }"
+"    leaf in-errors { type counter; }"
+"    leaf in-discards { type counter; }"
+"    leaf out-pkts { type counter; }"
+"    leaf out-octets { type counter; }"
+"    leaf out-errors { type counter; }"
+"    leaf out-discards { type counter; }"
+"    leaf last-clear { type string; }"
+"  }"
+"  grouping entry-config {"
+"    leaf name { type string { length \"1..64\"; } }"
+"    leaf description { type string; }"
+"    leaf enabled { type boolean; default true; }"
+"    leaf mtu { type uint16 { range \"68..9216\"; } }"
+"    leaf address { type ip-address; }"
+"    leaf prefix-length { type uint8 { range \"0..32\"; } must \". > 0 or ../address\"; }"
+"    leaf protocol { type identityref { base protocol; } }"
+"    leaf admin { type admin-state; default UP; }"
+"    leaf-list tags { type string; }"
+"  }"
+"  grouping entry-state {"
+"    leaf oper-status { type enumeration { enum UP; enum DOWN; enum DORMANT; enum UNKNOWN; } }"
+"    leaf last-change { type uint64; }"
+"    container counters { uses counters; }"
+"  }"
+"}";
+
+static int
+load(struct ly_ctx *ctx, int modules, int lists, int depth)
+{
+    char *schema, *ptr;
+    int i, j, d;
+
+    if (!lys_parse_mem(ctx, types, LYS_IN_YANG)) {
+        fprintf(stderr, "Failed to load data model \"oc-types\".\n");
+        return 1;
+    }
+
+    schema = malloc(4096 + lists * depth * 1024);
+    if (!schema) {
+        return 1;
+    }
+    for (i = 0; i < modules; i++) {
+        ptr = schema + sprintf(schema, "module oc%d {"
+                               "  namespace \"urn:libyang:performance:groupings:%d\";"
+                               "  prefix oc%d;"
+                               "  import oc-types { prefix oct; }", i, i, i);
+
+        /* every list entry has the config and state containers using the groupings, nested several levels deep */
+        for (d = 0; d < depth; d++) {
+            ptr += sprintf(ptr, "  grouping level%d-top {"
+                           "    list entry { key name;"
+                           "      leaf name { type leafref { path \"../config/name\"; } }"
+                           "      container config { uses oct:entry-config; }"
+                           "      container state { config false; uses oct:entry-config; uses oct:entry-state; }", d);
+            if (d) {
+                ptr += sprintf(ptr, "      container sub { uses level%d-top; }", d - 1);
+            }
+            ptr += sprintf(ptr, "    }"
+                           "  }");
+        }
+        ptr += sprintf(ptr, "  container top {");
+        for (j = 0; j < lists; j++) {
+            ptr += sprintf(ptr, "    container c%d { uses level%d-top; }", j, depth - 1);
+        }
+        sprintf(ptr, "  }"
+                "}");
+
+        if (!lys_parse_mem(ctx, schema, LYS_IN_YANG)) {
+            fprintf(stderr, "Failed to load data model %d.\n", i);
+            free(schema);
+            return 1;
+        }
+    }
+
+    free(schema);
+    return 0;
+}
+
+/* measured in a separate process so that the memory of one context does not distort the other */
+static int
+measure(int options, int modules, int lists, int depth)
+{
+    int status;
+    long rss_start, rss_end;
+    pid_t pid;
+    struct ly_ctx *ctx;
+    struct timespec start, end;
+
+    pid = fork();
+    if (pid == -1) {
+        fprintf(stderr, "Failed to fork.\n");
+        return 1;
+    } else if (pid) {
+        if ((waitpid(pid, &status, 0) == -1) || !WIFEXITED(status)) {
+            return 1;
+        }
+        return WEXITSTATUS(status);
+    }
+
+    rss_start = rss_kb();
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    ctx = ly_ctx_new_opts(NULL, options);
+    if (!ctx) {
+        fprintf(stderr, "Failed to create context.\n");
+        exit(1);
+    }
+    if (load(ctx, modules, lists, depth)) {
+        ly_ctx_destroy(ctx, NULL);
+        exit(1);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    rss_end = rss_kb();
+
+    printf("loading %d modules with %d lists of %d levels %s the nested groupings: %8.3f s, %ld kB\n",
+           modules, lists, depth, (options & LY_CTX_SHARE_GROUPINGS) ? "sharing" : "copying",
+           elapsed(&start, &end), rss_end - rss_start);
+    fflush(stdout);
+
+    ly_ctx_destroy(ctx, NULL);
+    exit(0);
+}
+
+int
+main(int argc, char *argv[])
+{
+    int modules = 20, lists = 10, depth = 3;
+
+    if (argc > 1) {
+        modules = atoi(argv[1]);
+    }
+    if (argc > 2) {
+        lists = atoi(argv[2]);
+    }
+    if (argc > 3) {
+        depth = atoi(argv[3]);
+    }
+    if ((modules < 1) || (lists < 1) || (depth < 1)) {
+        fprintf(stderr, "Invalid arguments.\n");
+        return 1;
+    }
+
+    if (measure(0, modules, lists, depth) || measure(LY_CTX_SHARE_GROUPINGS, modules, lists, depth)) {
+        return 1;
+    }
+
+    return 0;
+}
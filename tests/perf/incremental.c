@@ -0,0 +1,145 @@
+/**
+ * @file incremental.c
+ * @brief performance test - validating single leaf edits of a large data tree completely and incrementally.
+ *
+ * Copyright (c) 2017 CESNET, z.s.p.o.
+ *
+ * This source code is licensed under BSD 3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/BSD-3-Clause
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <libyang/libyang.h>
+
+static const char *schema =
+"module incremental-perf {"
+"  namespace \"urn:libyang:performance:incremental\";"
+"  prefix ip;"
+"  container top {"
+"    list item {"
+"      key name;"
+"      unique port;"
+"      leaf name { type string; }"
+"      leaf value { type uint32; must \". < ../port + 1000000\"; }"
+"      leaf port { type uint32; }"
+"      leaf ref { type leafref { path \"../../item/name\"; } }"
+"      container opt {"
+"        when \"../value > 5\";"
+"        leaf x { type string; default \"x\"; }"
+"      }"
+"    }"
+"  }"
+"}";
+
+static double
+elapsed(struct timespec *start, struct timespec *end)
+{
+    return (end->tv_sec - start->tv_sec) + (end->tv_nsec - start->tv_nsec) / 1e9;
+}
+
+static int
+edit(struct ly_ctx *ctx, const char *data, int count, int edits, int options, const char *desc)
+{
+    struct lyd_node *root;
+    struct ly_set *set;
+    struct timespec start, end;
+    double secs = 0;
+    char path[64];
+    int i, ret = 1;
+
+    root = lyd_parse_mem(ctx, data, LYD_XML, LYD_OPT_CONFIG);
+    if (!root) {
+        fprintf(stderr, "Failed to parse data.\n");
+        return 1;
+    }
+
+    for (i = 0; i < edits; i++) {
+        /* switch the when condition of a list entry on and off */
+        sprintf(path, "/incremental-perf:top/item[name='i%d']/value", (i / 2 * 7919) % count);
+        set = lyd_find_xpath(root, path);
+        if (!set || (set->number != 1)) {
+            fprintf(stderr, "Failed to find \"%s\".\n", path);
+            ly_set_free(set);
+            goto cleanup;
+        }
+        if (lyd_change_leaf((struct lyd_node_leaf_list *)set->set.d[0], i % 2 ? "3" : "7")) {
+            fprintf(stderr, "Failed to change \"%s\".\n", path);
+            ly_set_free(set);
+            goto cleanup;
+        }
+        ly_set_free(set);
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        if (lyd_validate(&root, options, NULL)) {
+            fprintf(stderr, "Failed to validate data.\n");
+            goto cleanup;
+        }
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        secs += elapsed(&start, &end);
+    }
+
+    printf("%-12s: %8.3f s, %10.6f s per edit\n", desc, secs, secs / edits);
+    ret = 0;
+
+cleanup:
+    lyd_free_withsiblings(root);
+    return ret;
+}
+
+int
+main(int argc, char *argv[])
+{
+    int i, count = 10000, edits = 100, ret = 1;
+    size_t used;
+    char *data = NULL;
+    struct ly_ctx *ctx = NULL;
+
+    if (argc > 1) {
+        count = atoi(argv[1]);
+    }
+    if (argc > 2) {
+        edits = atoi(argv[2]);
+    }
+
+    data = malloc(256 + count * 128);
+    if (!data) {
+        fprintf(stderr, "Memory allocation error.\n");
+        goto cleanup;
+    }
+
+    ctx = ly_ctx_new(NULL);
+    if (!ctx) {
+        fprintf(stderr, "Failed to create context.\n");
+        goto cleanup;
+    }
+    if (!lys_parse_mem(ctx, schema, LYS_IN_YANG)) {
+        fprintf(stderr, "Failed to load data model.\n");
+        goto cleanup;
+    }
+
+    used = sprintf(data, "<top xmlns=\"urn:libyang:performance:incremental\">");
+    for (i = 0; i < count; i++) {
+        used += sprintf(data + used, "<item><name>i%d</name><value>3</value><port>%d</port><ref>i%d</ref></item>",
+                        i, i, (i + 1) % count);
+    }
+    sprintf(data + used, "</top>");
+
+    printf("validating %d single leaf edits of %d list entries\n", edits, count);
+    if (edit(ctx, data, count, edits, LYD_OPT_CONFIG, "complete")
+            || edit(ctx, data, count, edits, LYD_OPT_CONFIG | LYD_OPT_INCREMENTAL, "incremental")) {
+        goto cleanup;
+    }
+    ret = 0;
+
+cleanup:
+    ly_ctx_destroy(ctx, NULL);
+    free(data);
+    return ret;
+}
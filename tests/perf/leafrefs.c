@@ -0,0 +1,119 @@
+/**
+ * @file leafrefs.c
+ * @brief performance test - validating many leafrefs referring to the entries of a single large list.
+ *
+ * Copyright (c) 2017 CESNET, z.s.p.o.
+ *
+ * This source code is licensed under BSD 3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/BSD-3-Clause
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <libyang/libyang.h>
+
+static const char *schema =
+"module lref-perf {"
+"  namespace \"urn:libyang:performance:leafrefs\";"
+"  prefix lp;"
+"  container interfaces {"
+"    list interface {"
+"      key name;"
+"      leaf name { type string; }"
+"    }"
+"  }"
+"  container bindings {"
+"    list binding {"
+"      key id;"
+"      leaf id { type uint32; }"
+"      leaf interface { type leafref { path \"/interfaces/interface/name\"; } }"
+"    }"
+"  }"
+"}";
+
+static double
+elapsed(struct timespec *start, struct timespec *end)
+{
+    return (end->tv_sec - start->tv_sec) + (end->tv_nsec - start->tv_nsec) / 1e9;
+}
+
+int
+main(int argc, char *argv[])
+{
+    int i, interfaces = 50000, bindings = 200000, ret = 1;
+    char path[96], value[32];
+    struct ly_ctx *ctx = NULL;
+    struct lyd_node *data = NULL;
+    struct timespec start, end;
+    double secs;
+
+    if (argc > 1) {
+        interfaces = atoi(argv[1]);
+    }
+    if (argc > 2) {
+        bindings = atoi(argv[2]);
+    }
+
+    ctx = ly_ctx_new(NULL);
+    if (!ctx) {
+        fprintf(stderr, "Failed to create context.\n");
+        return 1;
+    }
+    if (!lys_parse_mem(ctx, schema, LYS_IN_YANG)) {
+        fprintf(stderr, "Failed to load data model.\n");
+        goto cleanup;
+    }
+
+    printf("%d interfaces, %d leafrefs to them\n", interfaces, bindings);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    data = lyd_new_path(NULL, ctx, "/lref-perf:interfaces", NULL, 0, 0);
+    if (!data) {
+        fprintf(stderr, "Failed to create the interfaces.\n");
+        goto cleanup;
+    }
+    for (i = 0; i < interfaces; i++) {
+        sprintf(path, "/lref-perf:interfaces/interface[name='eth%d']", i);
+        if (!lyd_new_path(data, ctx, path, NULL, 0, 0)) {
+            fprintf(stderr, "Failed to create interface %d.\n", i);
+            goto cleanup;
+        }
+    }
+    for (i = 0; i < bindings; i++) {
+        sprintf(path, "/lref-perf:bindings/binding[id='%d']/interface", i);
+        sprintf(value, "eth%d", (int)(((long long)i * 7919) % interfaces));
+        if (!lyd_new_path(data, ctx, path, value, 0, 0)) {
+            fprintf(stderr, "Failed to create binding %d.\n", i);
+            goto cleanup;
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    printf("creating data   : %8.3f s\n", elapsed(&start, &end));
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    if (lyd_validate(&data, LYD_OPT_CONFIG, NULL)) {
+        fprintf(stderr, "Failed to validate data.\n");
+        goto cleanup;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    secs = elapsed(&start, &end);
+    printf("validation      : %8.3f s, %10.0f leafrefs/s\n", secs, bindings / secs);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    lyd_free_withsiblings(data);
+    data = NULL;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    printf("freeing data    : %8.3f s\n", elapsed(&start, &end));
+    ret = 0;
+
+cleanup:
+    lyd_free_withsiblings(data);
+    ly_ctx_destroy(ctx, NULL);
+    return ret;
+}
@@ -0,0 +1,135 @@
+/**
+ * @file lists.c
+ * @brief performance test - inserting and looking up list entries by their keys.
+ *
+ * Copyright (c) 2017 CESNET, z.s.p.o.
+ *
+ * This source code is licensed under BSD 3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/BSD-3-Clause
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <libyang/libyang.h>
+
+static const char *schema =
+"module list-perf {"
+"  namespace \"urn:libyang:performance:lists\";"
+"  prefix lp;"
+"  container entries {"
+"    list entry {"
+"      key name;"
+"      leaf name { type string; }"
+"      leaf value { type uint32; }"
+"    }"
+"  }"
+"}";
+
+static double
+elapsed(struct timespec *start, struct timespec *end)
+{
+    return (end->tv_sec - start->tv_sec) + (end->tv_nsec - start->tv_nsec) / 1e9;
+}
+
+int
+main(int argc, char *argv[])
+{
+    int i, count = 1000000, ret = 1;
+    char path[64], value[16];
+    struct ly_ctx *ctx = NULL;
+    struct lyd_node *data = NULL, *node;
+    struct ly_set *set;
+    struct timespec start, end;
+    double secs;
+
+    if (argc > 1) {
+        count = atoi(argv[1]);
+    }
+
+    ctx = ly_ctx_new(NULL);
+    if (!ctx) {
+        fprintf(stderr, "Failed to create context.\n");
+        return 1;
+    }
+    if (!lys_parse_mem(ctx, schema, LYS_IN_YANG)) {
+        fprintf(stderr, "Failed to load data model.\n");
+        goto cleanup;
+    }
+
+    data = lyd_new_path(NULL, ctx, "/list-perf:entries", NULL, 0, 0);
+    if (!data) {
+        fprintf(stderr, "Failed to create the container.\n");
+        goto cleanup;
+    }
+
+    /* every new entry is looked up first, so this is quadratic without the children index */
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < count; i++) {
+        sprintf(path, "/list-perf:entries/entry[name='e%d']/value", i);
+        sprintf(value, "%d", i);
+        if (!lyd_new_path(data, NULL, path, value, 0, 0)) {
+            fprintf(stderr, "Failed to create entry %d.\n", i);
+            goto cleanup;
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    secs = elapsed(&start, &end);
+    printf("entries   : %d\n", count);
+    printf("insert    : %.3f s (%.3f us per entry)\n", secs, secs * 1e6 / count);
+
+    /* look up the entries in a different order and update their values */
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < count; i++) {
+        sprintf(path, "/list-perf:entries/entry[name='e%d']/value", (int)(((long long)i * 7919) % count));
+        sprintf(value, "%d", i + 1);
+        node = lyd_new_path(data, NULL, path, value, 0, LYD_PATH_OPT_UPDATE);
+        if (!node || (node->schema->nodetype != LYS_LEAF)) {
+            fprintf(stderr, "Failed to update entry %d.\n", i);
+            goto cleanup;
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    secs = elapsed(&start, &end);
+    printf("lookup    : %.3f s (%.3f us per entry)\n", secs, secs * 1e6 / count);
+
+    /* find the entries by XPath */
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < count; i++) {
+        sprintf(path, "/list-perf:entries/entry[name='e%d']", (int)(((long long)i * 7919) % count));
+        set = lyd_find_xpath(data, path);
+        if (!set || (set->number != 1)) {
+            fprintf(stderr, "Failed to find entry %d.\n", i);
+            ly_set_free(set);
+            goto cleanup;
+        }
+        ly_set_free(set);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    secs = elapsed(&start, &end);
+    printf("xpath     : %.3f s (%.3f us per entry)\n", secs, secs * 1e6 / count);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    if (lyd_validate(&data, LYD_OPT_CONFIG, NULL)) {
+        fprintf(stderr, "Failed to validate data.\n");
+        goto cleanup;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    printf("validate  : %.3f s\n", elapsed(&start, &end));
+    ret = 0;
+
+cleanup:
+    lyd_free_withsiblings(data);
+    ly_ctx_destroy(ctx, NULL);
+
+    return ret;
+}
@@ -0,0 +1,178 @@
+/**
+ * @file lyb.c
+ * @brief performance test - storing and loading data trees in the XML, JSON and LYB formats.
+ *
+ * Copyright (c) 2017 CESNET, z.s.p.o.
+ *
+ * This source code is licensed under BSD 3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/BSD-3-Clause
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <libyang/libyang.h>
+
+static const char *schema =
+"module lyb-perf {"
+"  namespace \"urn:libyang:performance:lyb\";"
+"  prefix lp;"
+"  typedef state { type enumeration { enum up; enum down; enum testing; } }"
+"  container interfaces {"
+"    list interface {"
+"      key name;"
+"      leaf name { type string; }"
+"      leaf description { type string; }"
+"      leaf mtu { type uint16 { range \"68..9000\"; } }"
+"      leaf speed { type uint64; }"
+"      leaf enabled { type boolean; }"
+"      leaf state { type state; }"
+"      leaf-list address { type string { pattern \"[0-9.]+\"; } }"
+"    }"
+"  }"
+"}";
+
+static const char *
+format_name(LYD_FORMAT format)
+{
+    switch (format) {
+    case LYD_XML:
+        return "XML";
+    case LYD_JSON:
+        return "JSON";
+    case LYD_LYB:
+        return "LYB";
+    default:
+        return "?";
+    }
+}
+
+static double
+elapsed(struct timespec *start, struct timespec *end)
+{
+    return (end->tv_sec - start->tv_sec) + (end->tv_nsec - start->tv_nsec) / 1e9;
+}
+
+static int
+run(struct ly_ctx *ctx, struct lyd_node *data, LYD_FORMAT format, int iterations)
+{
+    struct timespec start, end;
+    struct lyd_node *loaded;
+    char *str = NULL;
+    size_t size;
+    double store, load;
+    int i;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < iterations; i++) {
+        free(str);
+        if (lyd_print_mem(&str, data, format, LYP_WITHSIBLINGS) || !str) {
+            fprintf(stderr, "Failed to store data in %s.\n", format_name(format));
+            return 1;
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    store = elapsed(&start, &end);
+    if (format == LYD_LYB) {
+        /* the total length is stored in the LYB header after the magic and the version */
+        size = (unsigned char)str[4] | ((unsigned char)str[5] << 8) | ((unsigned char)str[6] << 16)
+               | ((size_t)(unsigned char)str[7] << 24);
+    } else {
+        size = strlen(str);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < iterations; i++) {
+        loaded = lyd_parse_mem(ctx, str, format, LYD_OPT_CONFIG);
+        if (!loaded) {
+            fprintf(stderr, "Failed to load data in %s.\n", format_name(format));
+            free(str);
+            return 1;
+        }
+        lyd_free_withsiblings(loaded);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    load = elapsed(&start, &end);
+    free(str);
+
+    printf("%-4s: %9zu bytes, store %8.3f s, load (with validation) %8.3f s\n", format_name(format), size,
+           store / iterations, load / iterations);
+    return 0;
+}
+
+int
+main(int argc, char *argv[])
+{
+    int i, count = 10000, iterations = 5, ret = 1;
+    char path[96], value[64];
+    struct ly_ctx *ctx = NULL;
+    struct lyd_node *data = NULL;
+    char *states[] = {"up", "down", "testing"};
+
+    if (argc > 1) {
+        count = atoi(argv[1]);
+    }
+    if (argc > 2) {
+        iterations = atoi(argv[2]);
+    }
+
+    ctx = ly_ctx_new(NULL);
+    if (!ctx) {
+        fprintf(stderr, "Failed to create context.\n");
+        return 1;
+    }
+    if (!lys_parse_mem(ctx, schema, LYS_IN_YANG)) {
+        fprintf(stderr, "Failed to load data model.\n");
+        goto cleanup;
+    }
+
+    data = lyd_new_path(NULL, ctx, "/lyb-perf:interfaces", NULL, 0, 0);
+    if (!data) {
+        fprintf(stderr, "Failed to create the container.\n");
+        goto cleanup;
+    }
+    for (i = 0; i < count; i++) {
+        sprintf(path, "/lyb-perf:interfaces/interface[name='eth%d']/description", i);
+        sprintf(value, "interface %d description", i);
+        if (!lyd_new_path(data, NULL, path, value, 0, 0)) {
+            fprintf(stderr, "Failed to create entry %d.\n", i);
+            goto cleanup;
+        }
+        sprintf(path, "/lyb-perf:interfaces/interface[name='eth%d']/mtu", i);
+        sprintf(value, "%d", 1000 + i % 1000);
+        lyd_new_path(data, NULL, path, value, 0, 0);
+        sprintf(path, "/lyb-perf:interfaces/interface[name='eth%d']/speed", i);
+        sprintf(value, "%llu", 1000000000ULL * (i % 100));
+        lyd_new_path(data, NULL, path, value, 0, 0);
+        sprintf(path, "/lyb-perf:interfaces/interface[name='eth%d']/enabled", i);
+        lyd_new_path(data, NULL, path, i % 2 ? "true" : "false", 0, 0);
+        sprintf(path, "/lyb-perf:interfaces/interface[name='eth%d']/state", i);
+        lyd_new_path(data, NULL, path, states[i % 3], 0, 0);
+        sprintf(path, "/lyb-perf:interfaces/interface[name='eth%d']/address", i);
+        sprintf(value, "10.%d.%d.1", (i >> 8) & 0xff, i & 0xff);
+        lyd_new_path(data, NULL, path, value, 0, 0);
+        sprintf(value, "10.%d.%d.2", (i >> 8) & 0xff, i & 0xff);
+        lyd_new_path(data, NULL, path, value, 0, 0);
+    }
+    if (lyd_validate(&data, LYD_OPT_CONFIG, NULL)) {
+        fprintf(stderr, "Failed to validate data.\n");
+        goto cleanup;
+    }
+
+    printf("storing and loading a tree with %d list entries, average of %d runs\n", count, iterations);
+    if (run(ctx, data, LYD_XML, iterations) || run(ctx, data, LYD_JSON, iterations)
+            || run(ctx, data, LYD_LYB, iterations)) {
+        goto cleanup;
+    }
+    ret = 0;
+
+cleanup:
+    lyd_free_withsiblings(data);
+    ly_ctx_destroy(ctx, NULL);
+    return ret;
+}
@@ -0,0 +1,160 @@
+/**
+ * @file merge.c
+ * @brief performance test - merging large lists into a data tree.
+ *
+ * Copyright (c) 2017 CESNET, z.s.p.o.
+ *
+ * This source code is licensed under BSD 3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/BSD-3-Clause
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <libyang/libyang.h>
+
+static const char *schema =
+"module merge-perf {"
+"  namespace \"urn:libyang:performance:merge\";"
+"  prefix mp;"
+"  container top {"
+"    list item {"
+"      key name;"
+"      leaf name { type string; }"
+"      leaf value { type uint32; }"
+"    }"
+"  }"
+"  list entry {"
+"    key name;"
+"    leaf name { type string; }"
+"    leaf value { type uint32; }"
+"  }"
+"}";
+
+static double
+elapsed(struct timespec *start, struct timespec *end)
+{
+    return (end->tv_sec - start->tv_sec) + (end->tv_nsec - start->tv_nsec) / 1e9;
+}
+
+/* entries from offset to offset + count, either in the container or top-level */
+static char *
+generate(int offset, int count, int toplevel)
+{
+    char *data;
+    size_t used = 0;
+    int i;
+
+    data = malloc(256 + count * 96);
+    if (!data) {
+        return NULL;
+    }
+
+    if (toplevel) {
+        for (i = offset; i < offset + count; i++) {
+            used += sprintf(data + used, "<entry xmlns=\"urn:libyang:performance:merge\"><name>e%d</name>"
+                            "<value>%d</value></entry>", i, offset);
+        }
+    } else {
+        used = sprintf(data, "<top xmlns=\"urn:libyang:performance:merge\">");
+        for (i = offset; i < offset + count; i++) {
+            used += sprintf(data + used, "<item><name>i%d</name><value>%d</value></item>", i, offset);
+        }
+        sprintf(data + used, "</top>");
+    }
+
+    return data;
+}
+
+static int
+merge(struct ly_ctx *ctx, int count, int toplevel, int options, const char *desc)
+{
+    char *data1, *data2;
+    struct lyd_node *target = NULL, *source = NULL, *iter;
+    struct timespec start, end;
+    int ret = 1, entries;
+
+    /* half of the source entries are already in the target */
+    data1 = generate(0, count, toplevel);
+    data2 = generate(count / 2, count, toplevel);
+    if (!data1 || !data2) {
+        fprintf(stderr, "Memory allocation error.\n");
+        goto cleanup;
+    }
+    target = lyd_parse_mem(ctx, data1, LYD_XML, LYD_OPT_CONFIG);
+    source = lyd_parse_mem(ctx, data2, LYD_XML, LYD_OPT_CONFIG);
+    if (!target || !source) {
+        fprintf(stderr, "Failed to parse data.\n");
+        goto cleanup;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    if (lyd_merge(target, source, options)) {
+        fprintf(stderr, "Failed to merge data.\n");
+        goto cleanup;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    if (options & LYD_OPT_DESTRUCT) {
+        source = NULL;
+    }
+
+    entries = 0;
+    LY_TREE_FOR(toplevel ? target : target->child, iter) {
+        if (iter->schema->nodetype == LYS_LIST) {
+            entries++;
+        }
+    }
+    if (entries != count + count / 2) {
+        fprintf(stderr, "Unexpected number of merged entries %d.\n", entries);
+        goto cleanup;
+    }
+
+    printf("%-24s: %8.3f s\n", desc, elapsed(&start, &end));
+    ret = 0;
+
+cleanup:
+    lyd_free_withsiblings(target);
+    lyd_free_withsiblings(source);
+    free(data1);
+    free(data2);
+    return ret;
+}
+
+int
+main(int argc, char *argv[])
+{
+    int count = 100000, ret = 1;
+    struct ly_ctx *ctx = NULL;
+
+    if (argc > 1) {
+        count = atoi(argv[1]);
+    }
+
+    ctx = ly_ctx_new(NULL);
+    if (!ctx) {
+        fprintf(stderr, "Failed to create context.\n");
+        goto cleanup;
+    }
+    if (!lys_parse_mem(ctx, schema, LYS_IN_YANG)) {
+        fprintf(stderr, "Failed to load data model.\n");
+        goto cleanup;
+    }
+
+    printf("merging %d list entries into %d entries\n", count, count);
+    if (merge(ctx, count, 0, 0, "list")
+            || merge(ctx, count, 0, LYD_OPT_DESTRUCT, "list (destruct)")
+            || merge(ctx, count, 1, 0, "top-level list")
+            || merge(ctx, count, 1, LYD_OPT_DESTRUCT, "top-level list (destruct)")) {
+        goto cleanup;
+    }
+    ret = 0;
+
+cleanup:
+    ly_ctx_destroy(ctx, NULL);
+    return ret;
+}
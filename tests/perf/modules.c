@@ -0,0 +1,171 @@
+/**
+ * @file modules.c
+ * @brief performance test - parsing data of many modules loaded in a single context.
+ *
+ * Copyright (c) 2017 CESNET, z.s.p.o.
+ *
+ * This source code is licensed under BSD 3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/BSD-3-Clause
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <libyang/libyang.h>
+
+static double
+elapsed(struct timespec *start, struct timespec *end)
+{
+    return (end->tv_sec - start->tv_sec) + (end->tv_nsec - start->tv_nsec) / 1e9;
+}
+
+static char *
+print_data(int modules, int entries, int json)
+{
+    char *data, *ptr;
+    int i, j;
+
+    data = malloc((size_t)modules * entries * 192 + 16);
+    if (!data) {
+        return NULL;
+    }
+    ptr = data;
+    if (json) {
+        ptr += sprintf(ptr, "{");
+    }
+    for (i = 0; i < modules; i++) {
+        if (json) {
+            ptr += sprintf(ptr, "%s\"mod%d:cont\":{\"item\":[", i ? "," : "", i);
+        } else {
+            ptr += sprintf(ptr, "<cont xmlns=\"urn:libyang:performance:modules:%d\">", i);
+        }
+        for (j = 0; j < entries; j++) {
+            /* the identity of the next module and the leaf augmented by it */
+            if (json) {
+                ptr += sprintf(ptr, "%s{\"name\":\"n%d\",\"ref\":\"mod%d:id\"", j ? "," : "", j, (i + 1) % modules);
+                if (i + 1 < modules) {
+                    ptr += sprintf(ptr, ",\"mod%d:extra\":\"e%d\"", i + 1, j);
+                }
+                ptr += sprintf(ptr, "}");
+            } else {
+                ptr += sprintf(ptr, "<item><name>n%d</name><ref xmlns:m=\"urn:libyang:performance:modules:%d\">m:id</ref>",
+                               j, (i + 1) % modules);
+                if (i + 1 < modules) {
+                    ptr += sprintf(ptr, "<extra xmlns=\"urn:libyang:performance:modules:%d\">e%d</extra>", i + 1, j);
+                }
+                ptr += sprintf(ptr, "</item>");
+            }
+        }
+        ptr += sprintf(ptr, json ? "]}" : "</cont>");
+    }
+    if (json) {
+        ptr += sprintf(ptr, "}");
+    }
+
+    return data;
+}
+
+static int
+run(struct ly_ctx *ctx, const char *data, LYD_FORMAT format, int iterations)
+{
+    struct timespec start, end;
+    struct lyd_node *tree;
+    int i;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < iterations; i++) {
+        tree = lyd_parse_mem(ctx, data, format, LYD_OPT_CONFIG);
+        if (!tree) {
+            fprintf(stderr, "Failed to parse %s data.\n", format == LYD_XML ? "XML" : "JSON");
+            return 1;
+        }
+        lyd_free_withsiblings(tree);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    printf("%-4s: %8.3f s\n", format == LYD_XML ? "XML" : "JSON", elapsed(&start, &end) / iterations);
+    return 0;
+}
+
+int
+main(int argc, char *argv[])
+{
+    int i, modules = 400, entries = 20, iterations = 5, ret = 1;
+    char schema[1024], *ptr;
+    char *xml = NULL, *json = NULL;
+    struct ly_ctx *ctx = NULL;
+    struct timespec start, end;
+
+    if (argc > 1) {
+        modules = atoi(argv[1]);
+    }
+    if (argc > 2) {
+        entries = atoi(argv[2]);
+    }
+    if (modules < 1) {
+        modules = 1;
+    }
+
+    ctx = ly_ctx_new(NULL);
+    if (!ctx) {
+        fprintf(stderr, "Failed to create context.\n");
+        return 1;
+    }
+
+    /* every module augments the list of the previous one and uses the identity base of the first one */
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < modules; i++) {
+        ptr = schema + sprintf(schema, "module mod%d {"
+                               "  namespace \"urn:libyang:performance:modules:%d\";"
+                               "  prefix m%d;", i, i, i);
+        if (i) {
+            ptr += sprintf(ptr, "  import mod0 { prefix m0; }");
+        }
+        if (i > 1) {
+            ptr += sprintf(ptr, "  import mod%d { prefix m%d; }", i - 1, i - 1);
+        }
+        ptr += sprintf(ptr, "  identity %s;"
+                       "  identity id { base m0:base; }"
+                       "  container cont {"
+                       "    list item {"
+                       "      key name;"
+                       "      leaf name { type string; }"
+                       "      leaf ref { type identityref { base m0:base; } }"
+                       "    }"
+                       "  }", i ? "own" : "base");
+        if (i) {
+            ptr += sprintf(ptr, "  augment /m%d:cont/m%d:item { leaf extra { type string; } }", i - 1, i - 1);
+        }
+        sprintf(ptr, "}");
+        if (!lys_parse_mem(ctx, schema, LYS_IN_YANG)) {
+            fprintf(stderr, "Failed to load data model %d.\n", i);
+            goto cleanup;
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    printf("loading %d modules: %8.3f s\n", modules, elapsed(&start, &end));
+
+    xml = print_data(modules, entries, 0);
+    json = print_data(modules, entries, 1);
+    if (!xml || !json) {
+        fprintf(stderr, "Memory allocation failed.\n");
+        goto cleanup;
+    }
+
+    printf("parsing data of %d modules with %d list entries each, average of %d runs\n", modules, entries, iterations);
+    if (run(ctx, xml, LYD_XML, iterations) || run(ctx, json, LYD_JSON, iterations)) {
+        goto cleanup;
+    }
+    ret = 0;
+
+cleanup:
+    free(xml);
+    free(json);
+    ly_ctx_destroy(ctx, NULL);
+    return ret;
+}
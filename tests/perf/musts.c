@@ -0,0 +1,123 @@
+/**
+ * @file musts.c
+ * @brief performance test - validating data restricted by must and when conditions.
+ *
+ * Copyright (c) 2017 CESNET, z.s.p.o.
+ *
+ * This source code is licensed under BSD 3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/BSD-3-Clause
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <libyang/libyang.h>
+
+#define CONDITIONS 3
+
+static const char *schema =
+"module must-perf {"
+"  namespace \"urn:libyang:performance:must\";"
+"  prefix mp;"
+"  container interfaces {"
+"    list interface {"
+"      key name;"
+"      leaf name { type string; }"
+"      leaf type { type string; }"
+"      leaf mtu {"
+"        type uint16;"
+"        must \". >= 68 and . <= 9000\";"
+"      }"
+"      leaf vlan {"
+"        when \"../type = 'vlan'\";"
+"        type uint16;"
+"        must \"../mtu < 9000 or . > 1\";"
+"      }"
+"    }"
+"  }"
+"}";
+
+static double
+elapsed(struct timespec *start, struct timespec *end)
+{
+    return (end->tv_sec - start->tv_sec) + (end->tv_nsec - start->tv_nsec) / 1e9;
+}
+
+int
+main(int argc, char *argv[])
+{
+    int i, count = 10000, rounds = 5, ret = 1;
+    size_t used = 0;
+    char *xml = NULL;
+    struct ly_ctx *ctx = NULL;
+    struct lyd_node *data = NULL;
+    struct timespec start, end;
+    double secs;
+
+    if (argc > 1) {
+        count = atoi(argv[1]);
+    }
+    if (argc > 2) {
+        rounds = atoi(argv[2]);
+    }
+
+    ctx = ly_ctx_new(NULL);
+    if (!ctx) {
+        fprintf(stderr, "Failed to create context.\n");
+        return 1;
+    }
+    if (!lys_parse_mem(ctx, schema, LYS_IN_YANG)) {
+        fprintf(stderr, "Failed to load data model.\n");
+        goto cleanup;
+    }
+
+    xml = malloc(128 + count * 128);
+    if (!xml) {
+        goto cleanup;
+    }
+    used += sprintf(xml, "<interfaces xmlns=\"urn:libyang:performance:must\">");
+    for (i = 0; i < count; i++) {
+        used += sprintf(xml + used, "<interface><name>eth%d</name><type>vlan</type><mtu>%d</mtu><vlan>%d</vlan>"
+                        "</interface>", i, 1000 + i % 8000, 1 + i % 4094);
+    }
+    sprintf(xml + used, "</interfaces>");
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    data = lyd_parse_mem(ctx, xml, LYD_XML, LYD_OPT_CONFIG | LYD_OPT_STRICT);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    if (!data) {
+        fprintf(stderr, "Failed to load data.\n");
+        goto cleanup;
+    }
+
+    secs = elapsed(&start, &end);
+    printf("entries          : %d\n", count);
+    printf("conditions       : %d\n", count * CONDITIONS);
+    printf("parse + validate : %.3f s\n", secs);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < rounds; i++) {
+        if (lyd_validate(&data, LYD_OPT_CONFIG, NULL)) {
+            fprintf(stderr, "Failed to validate data.\n");
+            goto cleanup;
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    secs = elapsed(&start, &end) / rounds;
+    printf("revalidate       : %.3f s\n", secs);
+    printf("per condition    : %.3f us\n", secs * 1e6 / (count * CONDITIONS));
+    ret = 0;
+
+cleanup:
+    free(xml);
+    lyd_free_withsiblings(data);
+    ly_ctx_destroy(ctx, NULL);
+
+    return ret;
+}
@@ -0,0 +1,140 @@
+/**
+ * @file ordering.c
+ * @brief performance test - ordering and validating data of a schema node with many children.
+ *
+ * Copyright (c) 2017 CESNET, z.s.p.o.
+ *
+ * This source code is licensed under BSD 3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/BSD-3-Clause
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <libyang/libyang.h>
+
+static double
+elapsed(struct timespec *start, struct timespec *end)
+{
+    return (end->tv_sec - start->tv_sec) + (end->tv_nsec - start->tv_nsec) / 1e9;
+}
+
+/* children of both the container and the RPC input, some of them in a grouping and a choice */
+static int
+print_children(char *str, int count)
+{
+    int i, used;
+
+    used = sprintf(str, "uses g; choice ch {leaf c1 {type string;} leaf c2 {type string;}}");
+    for (i = 0; i < count; i++) {
+        used += sprintf(str + used, "leaf l%d {type uint32;}", i);
+    }
+    return used;
+}
+
+int
+main(int argc, char *argv[])
+{
+    int i, count = 500, iterations = 200, ret = 1;
+    size_t used;
+    char *schema = NULL, *rpc = NULL, name[16], value[16];
+    struct ly_ctx *ctx = NULL;
+    const struct lys_module *mod;
+    struct lyd_node *data = NULL, *node;
+    struct timespec start, end;
+    double secs;
+
+    if (argc > 1) {
+        count = atoi(argv[1]);
+    }
+    if (argc > 2) {
+        iterations = atoi(argv[2]);
+    }
+
+    schema = malloc(256 + 2 * (128 + count * 32));
+    rpc = malloc(128 + count * 32);
+    if (!schema || !rpc) {
+        fprintf(stderr, "Memory allocation error.\n");
+        goto cleanup;
+    }
+    used = sprintf(schema, "module order-perf {namespace \"urn:libyang:performance:ordering\"; prefix op;"
+                   "grouping g {leaf g1 {type string;} leaf g2 {type string;}}");
+    used += sprintf(schema + used, "container c {");
+    used += print_children(schema + used, count);
+    used += sprintf(schema + used, "} rpc r {input {");
+    used += print_children(schema + used, count);
+    sprintf(schema + used, "}}}");
+
+    /* every input child is checked against its predecessor */
+    used = sprintf(rpc, "<r xmlns=\"urn:libyang:performance:ordering\">");
+    for (i = 0; i < count; i++) {
+        used += sprintf(rpc + used, "<l%d>%d</l%d>", i, i, i);
+    }
+    sprintf(rpc + used, "</r>");
+
+    ctx = ly_ctx_new(NULL);
+    if (!ctx) {
+        fprintf(stderr, "Failed to create context.\n");
+        goto cleanup;
+    }
+    mod = lys_parse_mem(ctx, schema, LYS_IN_YANG);
+    if (!mod) {
+        fprintf(stderr, "Failed to load data model.\n");
+        goto cleanup;
+    }
+
+    data = lyd_new(NULL, mod, "c");
+    if (!data) {
+        fprintf(stderr, "Failed to create the container.\n");
+        goto cleanup;
+    }
+
+    /* children created in the reverse schema order, the positions are looked up by every sort anyway */
+    for (i = count - 1; i > -1; i--) {
+        sprintf(name, "l%d", i);
+        sprintf(value, "%d", i);
+        if (!lyd_new_leaf(data, mod, name, value)) {
+            fprintf(stderr, "Failed to create leaf \"%s\".\n", name);
+            goto cleanup;
+        }
+    }
+
+    printf("ordering and validating %d children of a container and an RPC input, %d times\n", count, iterations);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < iterations; i++) {
+        if (lyd_schema_sort(data->child, 1)) {
+            fprintf(stderr, "Failed to sort data.\n");
+            goto cleanup;
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    secs = elapsed(&start, &end);
+    printf("lyd_schema_sort()    : %8.3f s, %10.0f children/s\n", secs, (double)count * iterations / secs);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < iterations; i++) {
+        node = lyd_parse_mem(ctx, rpc, LYD_XML, LYD_OPT_RPC, NULL);
+        if (!node) {
+            fprintf(stderr, "Failed to parse the RPC.\n");
+            goto cleanup;
+        }
+        lyd_free(node);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    secs = elapsed(&start, &end);
+    printf("RPC input validation : %8.3f s, %10.0f children/s\n", secs, (double)count * iterations / secs);
+    ret = 0;
+
+cleanup:
+    lyd_free(data);
+    ly_ctx_destroy(ctx, NULL);
+    free(schema);
+    free(rpc);
+    return ret;
+}
@@ -0,0 +1,154 @@
+/**
+ * @file parallel.c
+ * @brief performance test - validating must conditions of several top-level subtrees by several threads.
+ *
+ * Copyright (c) 2017 CESNET, z.s.p.o.
+ *
+ * This source code is licensed under BSD 3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/BSD-3-Clause
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <libyang/libyang.h>
+
+#define SUBTREES 4
+
+static const char *schema =
+"module parallel-perf {"
+"  namespace \"urn:libyang:performance:parallel\";"
+"  prefix pp;"
+"  grouping items {"
+"    list item {"
+"      key name;"
+"      must \"starts-with(name, 'i') and string-length(name) < 16\";"
+"      leaf name { type string; }"
+"      leaf mtu { type uint16; must \". >= 68 and . <= 9000 and . mod 2 = 0\"; }"
+"      leaf peer { type string; must \". != ../name and starts-with(., 'i')\"; }"
+"      leaf descr { type string; must \"contains(., ../name) or not(../peer)\"; }"
+"    }"
+"  }"
+"  container interfaces { uses items; }"
+"  container routing { uses items; }"
+"  container system { uses items; }"
+"  container users { uses items; }"
+"}";
+
+static const char *subtrees[SUBTREES] = {"interfaces", "routing", "system", "users"};
+
+static double
+elapsed(struct timespec *start, struct timespec *end)
+{
+    return (end->tv_sec - start->tv_sec) + (end->tv_nsec - start->tv_nsec) / 1e9;
+}
+
+static char *
+gen_data(int count, int invalid)
+{
+    char *data;
+    size_t used = 0;
+    int i, j;
+
+    data = malloc(256 * SUBTREES + count * 192);
+    if (!data) {
+        return NULL;
+    }
+
+    for (j = 0; j < SUBTREES; j++) {
+        used += sprintf(data + used, "<%s xmlns=\"urn:libyang:performance:parallel\">", subtrees[j]);
+        for (i = 0; i < count / SUBTREES; i++) {
+            used += sprintf(data + used, "<item><name>i%d</name><mtu>%d</mtu><peer>i%d</peer>"
+                            "<descr>item i%d</descr></item>", i, (invalid && (j == SUBTREES - 1) && (i == count / SUBTREES / 2))
+                            ? 9002 : 1500, (i + 1) % (count / SUBTREES), i);
+        }
+        used += sprintf(data + used, "</%s>", subtrees[j]);
+    }
+
+    return data;
+}
+
+int
+main(int argc, char *argv[])
+{
+    int count = 100000, max_threads = 8, rounds = 5, threads, i, ret = 1;
+    char *data = NULL, *invalid = NULL, *errmsg = NULL;
+    struct ly_ctx *ctx = NULL;
+    struct lyd_node *root = NULL;
+    struct timespec start, end;
+    double secs;
+
+    if (argc > 1) {
+        count = atoi(argv[1]);
+    }
+    if (argc > 2) {
+        max_threads = atoi(argv[2]);
+    }
+
+    data = gen_data(count, 0);
+    invalid = gen_data(count, 1);
+    if (!data || !invalid) {
+        fprintf(stderr, "Memory allocation error.\n");
+        goto cleanup;
+    }
+
+    ctx = ly_ctx_new(NULL);
+    if (!ctx) {
+        fprintf(stderr, "Failed to create context.\n");
+        goto cleanup;
+    }
+    ly_verb(LY_LLSILENT);
+    if (!lys_parse_mem(ctx, schema, LYS_IN_YANG)) {
+        fprintf(stderr, "Failed to load data model.\n");
+        goto cleanup;
+    }
+
+    root = lyd_parse_mem(ctx, data, LYD_XML, LYD_OPT_CONFIG);
+    if (!root) {
+        fprintf(stderr, "Failed to parse data.\n");
+        goto cleanup;
+    }
+
+    printf("validating %d list entries with %d must conditions in %d top-level subtrees %d times\n",
+           count, count * 4, SUBTREES, rounds);
+    for (threads = 1; threads <= max_threads; threads *= 2) {
+        ly_ctx_set_validation_threads(ctx, threads);
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (i = 0; i < rounds; i++) {
+            if (lyd_validate(&root, LYD_OPT_CONFIG, NULL)) {
+                fprintf(stderr, "Failed to validate data.\n");
+                goto cleanup;
+            }
+        }
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        secs = elapsed(&start, &end);
+        printf("%2d thread(s): %8.3f s, %8.3f s per validation\n", threads, secs, secs / rounds);
+
+        /* the same error must be reported */
+        if (lyd_parse_mem(ctx, invalid, LYD_XML, LYD_OPT_CONFIG)) {
+            fprintf(stderr, "Invalid data validated.\n");
+            goto cleanup;
+        }
+        if (!errmsg) {
+            errmsg = strdup(ly_errmsg());
+        } else if (strcmp(errmsg, ly_errmsg())) {
+            fprintf(stderr, "Different error \"%s\" reported instead of \"%s\".\n", ly_errmsg(), errmsg);
+            goto cleanup;
+        }
+    }
+    ret = 0;
+
+cleanup:
+    lyd_free_withsiblings(root);
+    ly_ctx_destroy(ctx, NULL);
+    free(data);
+    free(invalid);
+    free(errmsg);
+    return ret;
+}
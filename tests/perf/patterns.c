@@ -0,0 +1,108 @@
+/**
+ * @file patterns.c
+ * @brief performance test - validating string values restricted by patterns.
+ *
+ * Copyright (c) 2017 CESNET, z.s.p.o.
+ *
+ * This source code is licensed under BSD 3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/BSD-3-Clause
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <libyang/libyang.h>
+
+#define PATTERN_LEAVES 4
+
+static const char *schema =
+"module pattern-perf {"
+"  namespace \"urn:libyang:performance:pattern\";"
+"  prefix pp;"
+"  import ietf-inet-types { prefix inet; }"
+"  container addresses {"
+"    list entry {"
+"      key name;"
+"      leaf name { type string { pattern '[a-z]+[0-9]+'; } }"
+"      leaf v4 { type inet:ipv4-address; }"
+"      leaf v6 { type inet:ipv6-address; }"
+"      leaf host { type inet:host; }"
+"    }"
+"  }"
+"}";
+
+static double
+elapsed(struct timespec *start, struct timespec *end)
+{
+    return (end->tv_sec - start->tv_sec) + (end->tv_nsec - start->tv_nsec) / 1e9;
+}
+
+int
+main(int argc, char *argv[])
+{
+    int i, count = 100000, ret = 1;
+    size_t size, used = 0;
+    char *xml = NULL;
+    struct ly_ctx *ctx = NULL;
+    struct lyd_node *data = NULL;
+    struct timespec start, end;
+    double secs;
+
+    if (argc > 1) {
+        count = atoi(argv[1]);
+    }
+
+    ctx = ly_ctx_new(NULL);
+    if (!ctx) {
+        fprintf(stderr, "Failed to create context.\n");
+        return 1;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    if (!lys_parse_mem(ctx, schema, LYS_IN_YANG)) {
+        fprintf(stderr, "Failed to load data model.\n");
+        goto cleanup;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    printf("schema load      : %.3f ms\n", elapsed(&start, &end) * 1e3);
+
+    size = 256 + count * 256;
+    xml = malloc(size);
+    if (!xml) {
+        goto cleanup;
+    }
+    used += sprintf(xml, "<addresses xmlns=\"urn:libyang:performance:pattern\">");
+    for (i = 0; i < count; i++) {
+        used += sprintf(xml + used, "<entry><name>e%d</name><v4>10.%d.%d.%d</v4><v6>2001:db8::%x</v6>"
+                        "<host>host%d.example.com</host></entry>",
+                        i, (i >> 16) & 0xff, (i >> 8) & 0xff, i & 0xff, i & 0xffff, i);
+    }
+    sprintf(xml + used, "</addresses>");
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    data = lyd_parse_mem(ctx, xml, LYD_XML, LYD_OPT_CONFIG | LYD_OPT_STRICT);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    if (!data) {
+        fprintf(stderr, "Failed to load data.\n");
+        goto cleanup;
+    }
+
+    secs = elapsed(&start, &end);
+    printf("entries          : %d\n", count);
+    printf("pattern leaves   : %d\n", count * PATTERN_LEAVES);
+    printf("parse + validate : %.3f s\n", secs);
+    printf("per leaf         : %.3f us\n", secs * 1e6 / (count * PATTERN_LEAVES));
+    ret = 0;
+
+cleanup:
+    free(xml);
+    lyd_free_withsiblings(data);
+    ly_ctx_destroy(ctx, NULL);
+
+    return ret;
+}
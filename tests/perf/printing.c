@@ -0,0 +1,151 @@
+/**
+ * @file printing.c
+ * @brief performance test - printing data trees into memory and into a file descriptor.
+ *
+ * Copyright (c) 2017 CESNET, z.s.p.o.
+ *
+ * This source code is licensed under BSD 3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/BSD-3-Clause
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include <libyang/libyang.h>
+
+static const char *schema =
+"module print-perf {"
+"  namespace \"urn:libyang:performance:printing\";"
+"  prefix pp;"
+"  container interfaces {"
+"    list interface {"
+"      key name;"
+"      leaf name { type string; }"
+"      leaf description { type string; }"
+"      leaf mtu { type uint16; }"
+"      leaf enabled { type boolean; }"
+"    }"
+"  }"
+"}";
+
+static double
+elapsed(struct timespec *start, struct timespec *end)
+{
+    return (end->tv_sec - start->tv_sec) + (end->tv_nsec - start->tv_nsec) / 1e9;
+}
+
+static int
+run(struct lyd_node *data, LYD_FORMAT format, int fd, int iterations)
+{
+    struct timespec start, end;
+    struct stat st;
+    char *str = NULL;
+    size_t size = 0;
+    double secs;
+    int i;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < iterations; i++) {
+        if (fd > -1) {
+            if (lseek(fd, 0, SEEK_SET) || ftruncate(fd, 0) || lyd_print_fd(fd, data, format, LYP_WITHSIBLINGS | LYP_FORMAT)) {
+                fprintf(stderr, "Failed to print data.\n");
+                return 1;
+            }
+        } else {
+            if (lyd_print_mem(&str, data, format, LYP_WITHSIBLINGS | LYP_FORMAT) || !str) {
+                fprintf(stderr, "Failed to print data.\n");
+                return 1;
+            }
+            size = strlen(str);
+            free(str);
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    if (fd > -1) {
+        if (fstat(fd, &st)) {
+            return 1;
+        }
+        size = st.st_size;
+    }
+
+    secs = elapsed(&start, &end);
+    printf("%-4s %-6s: %8.3f s, %8.1f MB/s\n", format == LYD_XML ? "XML" : "JSON", fd > -1 ? "fd" : "memory",
+           secs, (double)size * iterations / secs / (1024 * 1024));
+    return 0;
+}
+
+int
+main(int argc, char *argv[])
+{
+    int i, count = 10000, iterations = 20, fd = -1, ret = 1;
+    char path[96], value[64], file[] = "/tmp/printing-XXXXXX";
+    struct ly_ctx *ctx = NULL;
+    struct lyd_node *data = NULL;
+
+    if (argc > 1) {
+        count = atoi(argv[1]);
+    }
+    if (argc > 2) {
+        iterations = atoi(argv[2]);
+    }
+
+    ctx = ly_ctx_new(NULL);
+    if (!ctx) {
+        fprintf(stderr, "Failed to create context.\n");
+        return 1;
+    }
+    if (!lys_parse_mem(ctx, schema, LYS_IN_YANG)) {
+        fprintf(stderr, "Failed to load data model.\n");
+        goto cleanup;
+    }
+
+    data = lyd_new_path(NULL, ctx, "/print-perf:interfaces", NULL, 0, 0);
+    if (!data) {
+        fprintf(stderr, "Failed to create the container.\n");
+        goto cleanup;
+    }
+    for (i = 0; i < count; i++) {
+        sprintf(path, "/print-perf:interfaces/interface[name='eth%d']/description", i);
+        sprintf(value, "interface <%d> & \"quoted\" description", i);
+        if (!lyd_new_path(data, NULL, path, value, 0, 0)) {
+            fprintf(stderr, "Failed to create entry %d.\n", i);
+            goto cleanup;
+        }
+        sprintf(path, "/print-perf:interfaces/interface[name='eth%d']/mtu", i);
+        sprintf(value, "%d", 1000 + i % 1000);
+        lyd_new_path(data, NULL, path, value, 0, 0);
+        sprintf(path, "/print-perf:interfaces/interface[name='eth%d']/enabled", i);
+        lyd_new_path(data, NULL, path, i % 2 ? "true" : "false", 0, 0);
+    }
+
+    fd = mkstemp(file);
+    if (fd == -1) {
+        fprintf(stderr, "Failed to create a temporary file.\n");
+        goto cleanup;
+    }
+    unlink(file);
+
+    printf("printing a tree with %d list entries %d times\n", count, iterations);
+    if (run(data, LYD_XML, -1, iterations) || run(data, LYD_XML, fd, iterations)
+            || run(data, LYD_JSON, -1, iterations) || run(data, LYD_JSON, fd, iterations)) {
+        goto cleanup;
+    }
+    ret = 0;
+
+cleanup:
+    if (fd > -1) {
+        close(fd);
+    }
+    lyd_free(data);
+    ly_ctx_destroy(ctx, NULL);
+    return ret;
+}
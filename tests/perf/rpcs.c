@@ -0,0 +1,118 @@
+/**
+ * @file rpcs.c
+ * @brief performance test - parsing and freeing small RPCs.
+ *
+ * Copyright (c) 2017 CESNET, z.s.p.o.
+ *
+ * This source code is licensed under BSD 3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/BSD-3-Clause
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <libyang/libyang.h>
+
+static const char *schema =
+"module rpcs-perf {"
+"  namespace \"urn:libyang:performance:rpcs\";"
+"  prefix rp;"
+"  rpc edit {"
+"    input {"
+"      leaf target { type string; }"
+"      leaf operation { type enumeration { enum merge; enum replace; } }"
+"      container config {"
+"        list item {"
+"          key name;"
+"          leaf name { type string; }"
+"          leaf value { type uint32; }"
+"          leaf enabled { type boolean; }"
+"        }"
+"      }"
+"    }"
+"  }"
+"}";
+
+static const char *rpc =
+"<edit xmlns=\"urn:libyang:performance:rpcs\">"
+"<target>running</target><operation>merge</operation>"
+"<config>"
+"<item><name>a</name><value>1</value><enabled>true</enabled></item>"
+"<item><name>b</name><value>2</value><enabled>false</enabled></item>"
+"<item><name>c</name><value>3</value><enabled>true</enabled></item>"
+"</config>"
+"</edit>";
+
+static double
+elapsed(struct timespec *start, struct timespec *end)
+{
+    return (end->tv_sec - start->tv_sec) + (end->tv_nsec - start->tv_nsec) / 1e9;
+}
+
+int
+main(int argc, char *argv[])
+{
+    int count = 10000, i, ret = 1;
+    struct ly_ctx *ctx;
+    struct lyd_node **nodes = NULL;
+    struct timespec start, end;
+    double parse, free_;
+
+    if (argc > 1) {
+        count = atoi(argv[1]);
+    }
+
+    ctx = ly_ctx_new(NULL);
+    if (!ctx) {
+        fprintf(stderr, "Failed to create context.\n");
+        return 1;
+    }
+    if (!lys_parse_mem(ctx, schema, LYS_IN_YANG)) {
+        fprintf(stderr, "Failed to load data model.\n");
+        goto cleanup;
+    }
+    nodes = calloc(count, sizeof *nodes);
+    if (!nodes) {
+        fprintf(stderr, "Memory allocation error.\n");
+        goto cleanup;
+    }
+
+    /* keep all the RPCs so that parsing and freeing are measured separately */
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < count; i++) {
+        nodes[i] = lyd_parse_mem(ctx, rpc, LYD_XML, LYD_OPT_RPC, NULL);
+        if (!nodes[i]) {
+            fprintf(stderr, "Failed to parse the RPC.\n");
+            goto cleanup;
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    parse = elapsed(&start, &end);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < count; i++) {
+        lyd_free_withsiblings(nodes[i]);
+        nodes[i] = NULL;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    free_ = elapsed(&start, &end);
+
+    printf("parse: %8.3f s, %10.0f RPCs/s\n", parse, count / parse);
+    printf("free : %8.3f s, %10.0f RPCs/s (%.1f %% of the total)\n", free_, count / free_, 100 * free_ / (parse + free_));
+    ret = 0;
+
+cleanup:
+    if (nodes) {
+        for (i = 0; i < count; i++) {
+            lyd_free_withsiblings(nodes[i]);
+        }
+        free(nodes);
+    }
+    ly_ctx_destroy(ctx, NULL);
+    return ret;
+}
@@ -0,0 +1,144 @@
+/**
+ * @file searchdir.c
+ * @brief performance test - loading many interdependent modules found in the search directories.
+ *
+ * Copyright (c) 2017 CESNET, z.s.p.o.
+ *
+ * This source code is licensed under BSD 3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/BSD-3-Clause
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <limits.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include <libyang/libyang.h>
+
+#define DIRS 10
+
+static double
+elapsed(struct timespec *start, struct timespec *end)
+{
+    return (end->tv_sec - start->tv_sec) + (end->tv_nsec - start->tv_nsec) / 1e9;
+}
+
+static void
+remove_files(const char *root, int count)
+{
+    char path[PATH_MAX];
+    int i;
+
+    for (i = 0; i < count; i++) {
+        sprintf(path, "%s/dir%d/mod%d@2017-01-01.yang", root, i % DIRS, i);
+        unlink(path);
+        sprintf(path, "%s/dir%d/mod%d-sub.yang", root, i % DIRS, i);
+        unlink(path);
+    }
+    for (i = 0; i < DIRS; i++) {
+        sprintf(path, "%s/dir%d", root, i);
+        rmdir(path);
+    }
+    rmdir(root);
+}
+
+static int
+write_files(const char *root, int count)
+{
+    char path[PATH_MAX];
+    FILE *f;
+    int i;
+
+    for (i = 0; i < DIRS; i++) {
+        sprintf(path, "%s/dir%d", root, i);
+        if (mkdir(path, 0700)) {
+            return 1;
+        }
+    }
+
+    /* every module includes a submodule and imports the previous 2 modules */
+    for (i = 0; i < count; i++) {
+        sprintf(path, "%s/dir%d/mod%d@2017-01-01.yang", root, i % DIRS, i);
+        f = fopen(path, "w");
+        if (!f) {
+            return 1;
+        }
+        fprintf(f, "module mod%d { namespace \"urn:libyang:performance:searchdir:%d\"; prefix m;", i, i);
+        if (i > 0) {
+            fprintf(f, " import mod%d { prefix i1; }", i - 1);
+        }
+        if (i > 1) {
+            fprintf(f, " import mod%d { prefix i2; }", i - 2);
+        }
+        fprintf(f, " include mod%d-sub; revision 2017-01-01; leaf l { type string; } }", i);
+        fclose(f);
+
+        sprintf(path, "%s/dir%d/mod%d-sub.yang", root, i % DIRS, i);
+        f = fopen(path, "w");
+        if (!f) {
+            return 1;
+        }
+        fprintf(f, "submodule mod%d-sub { belongs-to mod%d { prefix m; } leaf s { type string; } }", i, i);
+        fclose(f);
+    }
+
+    return 0;
+}
+
+int
+main(int argc, char *argv[])
+{
+    int i, count = 500, ret = 1;
+    char root[] = "/tmp/libyang-searchdir-XXXXXX", name[32];
+    struct ly_ctx *ctx = NULL;
+    struct timespec start, end;
+
+    if (argc > 1) {
+        count = atoi(argv[1]);
+    }
+
+    if (!mkdtemp(root)) {
+        fprintf(stderr, "Failed to create a temporary directory.\n");
+        return 1;
+    }
+    if (write_files(root, count)) {
+        fprintf(stderr, "Failed to write the modules.\n");
+        goto cleanup;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    ctx = ly_ctx_new(root);
+    if (!ctx) {
+        fprintf(stderr, "Failed to create context.\n");
+        goto cleanup;
+    }
+    for (i = 0; i < count; i += 10) {
+        sprintf(name, "mod%d", i);
+        if (!ly_ctx_load_module(ctx, name, NULL)) {
+            fprintf(stderr, "Failed to load module %s.\n", name);
+            goto cleanup;
+        }
+    }
+    /* the last one imports all the remaining modules */
+    sprintf(name, "mod%d", count - 1);
+    if (!ly_ctx_load_module(ctx, name, NULL)) {
+        fprintf(stderr, "Failed to load module %s.\n", name);
+        goto cleanup;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    printf("loading %d modules with submodules from %d search subdirectories: %8.3f s\n", count, DIRS,
+           elapsed(&start, &end));
+    ret = 0;
+
+cleanup:
+    ly_ctx_destroy(ctx, NULL);
+    remove_files(root, count);
+    return ret;
+}
@@ -0,0 +1,147 @@
+/**
+ * @file sets.c
+ * @brief performance test - building sets of data nodes with checking the duplicates.
+ *
+ * Copyright (c) 2017 CESNET, z.s.p.o.
+ *
+ * This source code is licensed under BSD 3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/BSD-3-Clause
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <libyang/libyang.h>
+
+static const char *schema =
+"module sets-perf {"
+"  namespace \"urn:libyang:performance:sets\";"
+"  prefix sp;"
+"  container top {"
+"    list item {"
+"      key name;"
+"      leaf name { type string; }"
+"      leaf value { type uint32; }"
+"      leaf port { type uint32; }"
+"    }"
+"  }"
+"}";
+
+static double
+elapsed(struct timespec *start, struct timespec *end)
+{
+    return (end->tv_sec - start->tv_sec) + (end->tv_nsec - start->tv_nsec) / 1e9;
+}
+
+int
+main(int argc, char *argv[])
+{
+    int i, count = 250000, ret = 1;
+    unsigned int u, number;
+    char value[16];
+    struct ly_ctx *ctx = NULL;
+    const struct lys_module *mod;
+    struct lyd_node *root = NULL, *item, *next, *elem;
+    struct ly_set *nodes = NULL, *set = NULL;
+    struct timespec start, end;
+
+    if (argc > 1) {
+        count = atoi(argv[1]);
+    }
+
+    ctx = ly_ctx_new(NULL);
+    if (!ctx) {
+        fprintf(stderr, "Failed to create context.\n");
+        goto cleanup;
+    }
+    mod = lys_parse_mem(ctx, schema, LYS_IN_YANG);
+    if (!mod) {
+        fprintf(stderr, "Failed to load data model.\n");
+        goto cleanup;
+    }
+
+    root = lyd_new(NULL, mod, "top");
+    for (i = 0; root && (i < count); i++) {
+        sprintf(value, "%d", i);
+        item = lyd_new(root, NULL, "item");
+        if (!item || !lyd_new_leaf(item, NULL, "name", value) || !lyd_new_leaf(item, NULL, "value", value)
+                || !lyd_new_leaf(item, NULL, "port", value)) {
+            break;
+        }
+    }
+    if (i < count) {
+        fprintf(stderr, "Failed to create data.\n");
+        goto cleanup;
+    }
+
+    /* all the nodes in the document order */
+    nodes = ly_set_new();
+    set = ly_set_new();
+    if (!nodes || !set) {
+        fprintf(stderr, "Memory allocation error.\n");
+        goto cleanup;
+    }
+    LY_TREE_DFS_BEGIN(root, next, elem) {
+        if (ly_set_add(nodes, elem, LY_SET_OPT_USEASLIST) == -1) {
+            fprintf(stderr, "Failed to add a node.\n");
+            goto cleanup;
+        }
+        LY_TREE_DFS_END(root, next, elem);
+    }
+    number = nodes->number;
+
+    printf("building sets of %u nodes\n", number);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (u = 0; u < number; u++) {
+        if (ly_set_add(set, nodes->set.d[u], 0) == -1) {
+            fprintf(stderr, "Failed to add a node.\n");
+            goto cleanup;
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    printf("%-24s: %8.3f s\n", "adding unique", elapsed(&start, &end));
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (u = 0; u < number; u++) {
+        if ((unsigned int)ly_set_add(set, nodes->set.d[number - u - 1], 0) != number - u - 1) {
+            fprintf(stderr, "Duplicate node not found.\n");
+            goto cleanup;
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    printf("%-24s: %8.3f s\n", "adding duplicates", elapsed(&start, &end));
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (u = 0; u < number; u += 2) {
+        if (ly_set_rm(set, nodes->set.d[u])) {
+            fprintf(stderr, "Failed to remove a node.\n");
+            goto cleanup;
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    printf("%-24s: %8.3f s\n", "removing every other", elapsed(&start, &end));
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (u = 0; u < number; u++) {
+        if ((ly_set_contains(set, nodes->set.d[u]) == -1) != !(u % 2)) {
+            fprintf(stderr, "Unexpected set content.\n");
+            goto cleanup;
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    printf("%-24s: %8.3f s\n", "looking up", elapsed(&start, &end));
+    ret = 0;
+
+cleanup:
+    ly_set_free(nodes);
+    ly_set_free(set);
+    lyd_free(root);
+    ly_ctx_destroy(ctx, NULL);
+    return ret;
+}
@@ -0,0 +1,170 @@
+/**
+ * @file snapshot.c
+ * @brief performance test - creating a context with many modules by parsing them and from a schema snapshot.
+ *
+ * Copyright (c) 2017 CESNET, z.s.p.o.
+ *
+ * This source code is licensed under BSD 3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/BSD-3-Clause
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <limits.h>
+#include <unistd.h>
+
+#include <libyang/libyang.h>
+
+static double
+elapsed(struct timespec *start, struct timespec *end)
+{
+    return (end->tv_sec - start->tv_sec) + (end->tv_nsec - start->tv_nsec) / 1e9;
+}
+
+static void
+remove_files(const char *root, int count)
+{
+    char path[PATH_MAX];
+    int i;
+
+    for (i = 0; i < count; i++) {
+        sprintf(path, "%s/mod%d.yang", root, i);
+        unlink(path);
+    }
+    sprintf(path, "%s/snapshot", root);
+    unlink(path);
+    rmdir(root);
+}
+
+static int
+write_files(const char *root, int count)
+{
+    char path[PATH_MAX];
+    FILE *f;
+    int i;
+
+    /* every module uses the groupings and identities of the first one and augments the previous one */
+    for (i = 0; i < count; i++) {
+        sprintf(path, "%s/mod%d.yang", root, i);
+        f = fopen(path, "w");
+        if (!f) {
+            return 1;
+        }
+        fprintf(f, "module mod%d { namespace \"urn:libyang:performance:snapshot:%d\"; prefix m%d;", i, i, i);
+        if (i) {
+            fprintf(f, " import mod0 { prefix m0; }");
+        }
+        if (i > 1) {
+            fprintf(f, " import mod%d { prefix m%d; }", i - 1, i - 1);
+        }
+        if (!i) {
+            fprintf(f, " identity base;"
+                    " typedef addr { type string { pattern '[0-9]{1,3}(\\.[0-9]{1,3}){3}'; } }"
+                    " grouping stats { container stats { config false;"
+                    "   leaf in { type uint64; } leaf out { type uint64; } leaf errors { type uint32; } } }"
+                    " grouping entry { leaf name { type string { length \"1..64\"; } } leaf address { type addr; }"
+                    "   leaf enabled { type boolean; default true; } leaf mtu { type uint16 { range \"68..9000\"; } }"
+                    "   leaf kind { type identityref { base base; } } uses stats; }");
+        }
+        fprintf(f, " identity id%d { base m0:base; }", i);
+        fprintf(f, " feature f; container cont { list item { key name; unique address;"
+                " uses m0:entry; leaf ref { type leafref { path \"../name\"; } }"
+                " leaf extra { if-feature f; when \"../enabled = 'true'\"; type int32; must \". > 0\"; } } }");
+        if (i) {
+            fprintf(f, " augment /m%d:cont/m%d:item { leaf aug%d { type string; } }", i - 1, i - 1, i);
+        }
+        fprintf(f, " rpc reset { input { leaf name { type string; } } } notification changed { uses m0:entry; } }");
+        fclose(f);
+    }
+
+    return 0;
+}
+
+static struct ly_ctx *
+load_modules(const char *root, int count)
+{
+    struct ly_ctx *ctx;
+    const struct lys_module *mod;
+    char name[32];
+    int i;
+
+    ctx = ly_ctx_new(root);
+    if (!ctx) {
+        return NULL;
+    }
+    for (i = 0; i < count; i++) {
+        sprintf(name, "mod%d", i);
+        mod = ly_ctx_load_module(ctx, name, NULL);
+        if (!mod || lys_features_enable(mod, "f")) {
+            fprintf(stderr, "Failed to load module %s.\n", name);
+            ly_ctx_destroy(ctx, NULL);
+            return NULL;
+        }
+    }
+
+    return ctx;
+}
+
+int
+main(int argc, char *argv[])
+{
+    int count = 400, ret = 1;
+    char root[] = "/tmp/libyang-snapshot-XXXXXX", path[PATH_MAX];
+    struct ly_ctx *ctx = NULL;
+    struct timespec start, end;
+
+    if (argc > 1) {
+        count = atoi(argv[1]);
+    }
+    if (count < 1) {
+        count = 1;
+    }
+
+    if (!mkdtemp(root)) {
+        fprintf(stderr, "Failed to create a temporary directory.\n");
+        return 1;
+    }
+    sprintf(path, "%s/snapshot", root);
+    if (write_files(root, count)) {
+        fprintf(stderr, "Failed to write the modules.\n");
+        goto cleanup;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    ctx = load_modules(root, count);
+    if (!ctx) {
+        goto cleanup;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    printf("creating a context with %d modules by parsing them: %8.3f s\n", count, elapsed(&start, &end));
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    if (ly_ctx_print_snapshot_path(ctx, path)) {
+        fprintf(stderr, "Failed to store the schema snapshot.\n");
+        goto cleanup;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    printf("storing the schema snapshot: %8.3f s\n", elapsed(&start, &end));
+    ly_ctx_destroy(ctx, NULL);
+    ctx = NULL;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    ctx = ly_ctx_new_snapshot_path(root, path, 0);
+    if (!ctx) {
+        fprintf(stderr, "Failed to load the schema snapshot.\n");
+        goto cleanup;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    printf("creating a context with %d modules from the snapshot: %8.3f s\n", count, elapsed(&start, &end));
+    ret = 0;
+
+cleanup:
+    ly_ctx_destroy(ctx, NULL);
+    remove_files(root, count);
+    return ret;
+}
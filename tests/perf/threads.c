@@ -0,0 +1,163 @@
+/**
+ * @file threads.c
+ * @brief performance test - parsing data in several threads using a single context.
+ *
+ * Copyright (c) 2017 CESNET, z.s.p.o.
+ *
+ * This source code is licensed under BSD 3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/BSD-3-Clause
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+
+#include <libyang/libyang.h>
+
+#define ENTRIES 200
+
+static const char *schema =
+"module thread-perf {"
+"  namespace \"urn:libyang:performance:threads\";"
+"  prefix tp;"
+"  container interfaces {"
+"    list interface {"
+"      key name;"
+"      leaf name { type string; }"
+"      leaf description { type string; }"
+"      leaf mtu { type uint16; }"
+"      leaf enabled { type boolean; }"
+"    }"
+"  }"
+"}";
+
+struct thread_arg {
+    struct ly_ctx *ctx;
+    int id;
+    int iterations;
+    int failed;
+};
+
+static double
+elapsed(struct timespec *start, struct timespec *end)
+{
+    return (end->tv_sec - start->tv_sec) + (end->tv_nsec - start->tv_nsec) / 1e9;
+}
+
+static void *
+parse_thread(void *arg)
+{
+    struct thread_arg *targ = (struct thread_arg *)arg;
+    struct lyd_node *data;
+    char *xml;
+    size_t used = 0;
+    int i;
+
+    xml = malloc(128 + ENTRIES * 256);
+    if (!xml) {
+        targ->failed = 1;
+        return NULL;
+    }
+
+    /* every thread works with its own strings */
+    used += sprintf(xml, "<interfaces xmlns=\"urn:libyang:performance:threads\">");
+    for (i = 0; i < ENTRIES; i++) {
+        used += sprintf(xml + used, "<interface><name>eth%d-%d</name><description>thread %d interface %d</description>"
+                        "<mtu>%d</mtu><enabled>true</enabled></interface>", targ->id, i, targ->id, i, 1000 + i);
+    }
+    sprintf(xml + used, "</interfaces>");
+
+    for (i = 0; i < targ->iterations; i++) {
+        data = lyd_parse_mem(targ->ctx, xml, LYD_XML, LYD_OPT_CONFIG | LYD_OPT_STRICT);
+        if (!data) {
+            targ->failed = 1;
+            break;
+        }
+        lyd_free_withsiblings(data);
+    }
+
+    free(xml);
+    return NULL;
+}
+
+static int
+run(int options, int threads, int iterations)
+{
+    struct ly_ctx *ctx;
+    pthread_t *tids;
+    struct thread_arg *args;
+    struct timespec start, end;
+    double secs;
+    int i, ret = 1;
+
+    ctx = ly_ctx_new_opts(NULL, options);
+    if (!ctx) {
+        fprintf(stderr, "Failed to create context.\n");
+        return 1;
+    }
+    if (!lys_parse_mem(ctx, schema, LYS_IN_YANG)) {
+        fprintf(stderr, "Failed to load data model.\n");
+        ly_ctx_destroy(ctx, NULL);
+        return 1;
+    }
+
+    tids = malloc(threads * sizeof *tids);
+    args = calloc(threads, sizeof *args);
+    if (!tids || !args) {
+        goto cleanup;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < threads; i++) {
+        args[i].ctx = ctx;
+        args[i].id = i;
+        args[i].iterations = iterations;
+        pthread_create(&tids[i], NULL, parse_thread, &args[i]);
+    }
+    for (i = 0; i < threads; i++) {
+        pthread_join(tids[i], NULL);
+        if (args[i].failed) {
+            fprintf(stderr, "Thread %d failed to parse data.\n", i);
+            goto cleanup;
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    secs = elapsed(&start, &end);
+    printf("%-10s %2d thread(s): %8.3f s, %10.0f trees/s\n", options & LY_CTX_CONCURRENT_DICT ? "concurrent" : "default",
+           threads, secs, threads * iterations / secs);
+    ret = 0;
+
+cleanup:
+    free(tids);
+    free(args);
+    ly_ctx_destroy(ctx, NULL);
+    return ret;
+}
+
+int
+main(int argc, char *argv[])
+{
+    int threads = 8, iterations = 200, t;
+
+    if (argc > 1) {
+        threads = atoi(argv[1]);
+    }
+    if (argc > 2) {
+        iterations = atoi(argv[2]);
+    }
+
+    printf("parsing trees with %d list entries, %d trees per thread\n", ENTRIES, iterations);
+    for (t = 1; t <= threads; t *= 2) {
+        if (run(0, t, iterations) || run(LY_CTX_CONCURRENT_DICT, t, iterations)) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,125 @@
+/**
+ * @file unions.c
+ * @brief performance test - parsing and validating list entries with leaves of union types with many member types.
+ *
+ * Copyright (c) 2017 CESNET, z.s.p.o.
+ *
+ * This source code is licensed under BSD 3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/BSD-3-Clause
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <libyang/libyang.h>
+
+/* the values mostly match only the last member types, so all the previous ones fail first */
+static const char *schema =
+"module unions-perf {"
+"  namespace \"urn:libyang:performance:unions\";"
+"  prefix unp;"
+"  typedef value {"
+"    type union {"
+"      type int8;"
+"      type uint16 { range \"1000..2000\"; }"
+"      type int64 { range \"-5..-1\"; }"
+"      type decimal64 { fraction-digits 2; }"
+"      type boolean;"
+"      type enumeration { enum none; enum all; enum default; }"
+"      type bits { bit one; bit two; bit three; }"
+"      type string { pattern '[0-9a-f]{8}'; }"
+"      type string { length \"1..4\"; }"
+"      type string { pattern '[a-z]+-[0-9]+'; }"
+"    }"
+"  }"
+"  container top {"
+"    list group {"
+"      key name;"
+"      leaf name { type string; }"
+"      list item {"
+"        key \"id kind\";"
+"        leaf id { type uint32; }"
+"        leaf kind { type string; }"
+"        leaf first { type value; }"
+"        leaf second { type value; }"
+"        leaf-list others { type value; }"
+"      }"
+"    }"
+"  }"
+"}";
+
+static double
+elapsed(struct timespec *start, struct timespec *end)
+{
+    return (end->tv_sec - start->tv_sec) + (end->tv_nsec - start->tv_nsec) / 1e9;
+}
+
+int
+main(int argc, char *argv[])
+{
+    int count = 50000, i, used, ret = 1;
+    char *data = NULL;
+    struct ly_ctx *ctx = NULL;
+    struct lyd_node *root = NULL;
+    struct timespec start, end;
+
+    if (argc > 1) {
+        count = atoi(argv[1]);
+    }
+    if (count < 1) {
+        count = 1;
+    }
+
+    data = malloc(256 + count * 256);
+    if (!data) {
+        fprintf(stderr, "Memory allocation error.\n");
+        return 1;
+    }
+
+    ctx = ly_ctx_new(NULL);
+    if (!ctx) {
+        fprintf(stderr, "Failed to create context.\n");
+        goto cleanup;
+    }
+    if (!lys_parse_mem(ctx, schema, LYS_IN_YANG)) {
+        fprintf(stderr, "Failed to load data model.\n");
+        goto cleanup;
+    }
+
+    used = sprintf(data, "<top xmlns=\"urn:libyang:performance:unions\"><group><name>g</name>");
+    for (i = 0; i < count; i++) {
+        used += sprintf(data + used, "<item><id>%d</id><kind>entry</kind><first>value-%d</first><second>%s</second>"
+                        "<others>item-%d</others><others>other-%d</others></item>",
+                        i, i, (i % 10) ? "other-0" : "true", i, i);
+    }
+    sprintf(data + used, "</group></top>");
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    root = lyd_parse_mem(ctx, data, LYD_XML, LYD_OPT_CONFIG);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    if (!root) {
+        fprintf(stderr, "Failed to parse data.\n");
+        goto cleanup;
+    }
+    printf("parsing %d list entries with 4 union values each: %8.3f s\n", count, elapsed(&start, &end));
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    if (lyd_validate(&root, LYD_OPT_CONFIG, NULL)) {
+        fprintf(stderr, "Failed to validate data.\n");
+        goto cleanup;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    printf("validating them again: %8.3f s\n", elapsed(&start, &end));
+    ret = 0;
+
+cleanup:
+    lyd_free_withsiblings(root);
+    ly_ctx_destroy(ctx, NULL);
+    free(data);
+    return ret;
+}
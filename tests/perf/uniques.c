@@ -0,0 +1,142 @@
+/**
+ * @file uniques.c
+ * @brief performance test - adding list entries with unique values one by one into a large list.
+ *
+ * Copyright (c) 2017 CESNET, z.s.p.o.
+ *
+ * This source code is licensed under BSD 3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/BSD-3-Clause
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <libyang/libyang.h>
+
+static const char *schema =
+"module uniques-perf {"
+"  namespace \"urn:libyang:performance:uniques\";"
+"  prefix up;"
+"  container top {"
+"    list item {"
+"      key name;"
+"      unique port;"
+"      unique \"addr/ip addr/port\";"
+"      leaf name { type string; }"
+"      leaf port { type uint32; }"
+"      container addr {"
+"        leaf ip { type string; }"
+"        leaf port { type uint16; default 80; }"
+"      }"
+"    }"
+"  }"
+"}";
+
+static double
+elapsed(struct timespec *start, struct timespec *end)
+{
+    return (end->tv_sec - start->tv_sec) + (end->tv_nsec - start->tv_nsec) / 1e9;
+}
+
+static int
+add(struct ly_ctx *ctx, const char *data, int count, int adds, int options, const char *desc)
+{
+    struct lyd_node *root;
+    struct timespec start, end;
+    double secs = 0;
+    char path[64], value[32];
+    int i, ret = 1;
+
+    root = lyd_parse_mem(ctx, data, LYD_XML, LYD_OPT_CONFIG);
+    if (!root) {
+        fprintf(stderr, "Failed to parse data.\n");
+        return 1;
+    }
+
+    for (i = count; i < count + adds; i++) {
+        /* a new list entry with all its unique values */
+        sprintf(path, "/uniques-perf:top/item[name='i%d']/port", i);
+        sprintf(value, "%d", i);
+        if (!lyd_new_path(root, NULL, path, value, 0, 0)) {
+            fprintf(stderr, "Failed to create \"%s\".\n", path);
+            goto cleanup;
+        }
+        sprintf(path, "/uniques-perf:top/item[name='i%d']/addr/ip", i);
+        sprintf(value, "10.%d.%d.%d", (i >> 16) & 0xff, (i >> 8) & 0xff, i & 0xff);
+        if (!lyd_new_path(root, NULL, path, value, 0, 0)) {
+            fprintf(stderr, "Failed to create \"%s\".\n", path);
+            goto cleanup;
+        }
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        if (lyd_validate(&root, options, NULL)) {
+            fprintf(stderr, "Failed to validate data.\n");
+            goto cleanup;
+        }
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        secs += elapsed(&start, &end);
+    }
+
+    printf("%-12s: %8.3f s, %10.6f s per entry\n", desc, secs, secs / adds);
+    ret = 0;
+
+cleanup:
+    lyd_free_withsiblings(root);
+    return ret;
+}
+
+int
+main(int argc, char *argv[])
+{
+    int i, count = 10000, adds = 100, ret = 1;
+    size_t used;
+    char *data = NULL;
+    struct ly_ctx *ctx = NULL;
+
+    if (argc > 1) {
+        count = atoi(argv[1]);
+    }
+    if (argc > 2) {
+        adds = atoi(argv[2]);
+    }
+
+    data = malloc(256 + count * 128);
+    if (!data) {
+        fprintf(stderr, "Memory allocation error.\n");
+        goto cleanup;
+    }
+
+    ctx = ly_ctx_new(NULL);
+    if (!ctx) {
+        fprintf(stderr, "Failed to create context.\n");
+        goto cleanup;
+    }
+    if (!lys_parse_mem(ctx, schema, LYS_IN_YANG)) {
+        fprintf(stderr, "Failed to load data model.\n");
+        goto cleanup;
+    }
+
+    used = sprintf(data, "<top xmlns=\"urn:libyang:performance:uniques\">");
+    for (i = 0; i < count; i++) {
+        used += sprintf(data + used, "<item><name>i%d</name><port>%d</port><addr><ip>10.%d.%d.%d</ip></addr></item>",
+                        i, i, (i >> 16) & 0xff, (i >> 8) & 0xff, i & 0xff);
+    }
+    sprintf(data + used, "</top>");
+
+    printf("adding %d list entries with unique values one by one to %d list entries\n", adds, count);
+    if (add(ctx, data, count, adds, LYD_OPT_CONFIG, "complete")
+            || add(ctx, data, count, adds, LYD_OPT_CONFIG | LYD_OPT_INCREMENTAL, "incremental")) {
+        goto cleanup;
+    }
+    ret = 0;
+
+cleanup:
+    ly_ctx_destroy(ctx, NULL);
+    free(data);
+    return ret;
+}
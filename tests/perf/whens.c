@@ -0,0 +1,116 @@
+/**
+ * @file whens.c
+ * @brief performance test - resolving a chain of when conditions depending on each other.
+ *
+ * Copyright (c) 2017 CESNET, z.s.p.o.
+ *
+ * This source code is licensed under BSD 3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/BSD-3-Clause
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <libyang/libyang.h>
+
+static double
+elapsed(struct timespec *start, struct timespec *end)
+{
+    return (end->tv_sec - start->tv_sec) + (end->tv_nsec - start->tv_nsec) / 1e9;
+}
+
+static int
+parse(struct ly_ctx *ctx, const char *data, const char *desc, int count)
+{
+    struct lyd_node *node;
+    struct timespec start, end;
+    struct lyd_val_stats stats;
+    double secs;
+
+    lyd_validation_stats(NULL);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    node = lyd_parse_mem(ctx, data, LYD_XML, LYD_OPT_CONFIG);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    lyd_validation_stats(&stats);
+    if (!node) {
+        fprintf(stderr, "Failed to parse the %s.\n", desc);
+        return 1;
+    }
+    lyd_free_withsiblings(node);
+
+    secs = elapsed(&start, &end);
+    printf("%-16s: %8.3f s, %10.0f nodes/s, %u when and %u other evaluations\n", desc, secs, (double)count / secs,
+           stats.when, stats.leafref + stats.other);
+    return 0;
+}
+
+int
+main(int argc, char *argv[])
+{
+    int i, count = 2000, ret = 1;
+    size_t used;
+    char *schema = NULL, *data = NULL;
+    struct ly_ctx *ctx = NULL;
+
+    if (argc > 1) {
+        count = atoi(argv[1]);
+    }
+
+    schema = malloc(256 + count * 64);
+    data = malloc(256 + count * 32);
+    if (!schema || !data) {
+        fprintf(stderr, "Memory allocation error.\n");
+        goto cleanup;
+    }
+
+    /* every leaf depends on the following sibling */
+    used = sprintf(schema, "module when-perf {namespace \"urn:libyang:performance:whens\"; prefix wp;"
+                   "container c {presence p;");
+    for (i = 0; i < count - 1; i++) {
+        used += sprintf(schema + used, "leaf l%d {type string; when \"../l%d\";}", i, i + 1);
+    }
+    sprintf(schema + used, "leaf l%d {type string;}}}", count - 1);
+
+    ctx = ly_ctx_new(NULL);
+    if (!ctx) {
+        fprintf(stderr, "Failed to create context.\n");
+        goto cleanup;
+    }
+    if (!lys_parse_mem(ctx, schema, LYS_IN_YANG)) {
+        fprintf(stderr, "Failed to load data model.\n");
+        goto cleanup;
+    }
+
+    printf("resolving a chain of when conditions of %d sibling leaves\n", count);
+
+    used = sprintf(data, "<c xmlns=\"urn:libyang:performance:whens\">");
+    for (i = 0; i < count; i++) {
+        used += sprintf(data + used, "<l%d>v</l%d>", i, i);
+    }
+    sprintf(data + used, "</c>");
+    if (parse(ctx, data, "all true", count)) {
+        goto cleanup;
+    }
+
+    /* without the last leaf, all the others are auto-deleted one by one */
+    used = sprintf(data, "<c xmlns=\"urn:libyang:performance:whens\">");
+    for (i = 0; i < count - 1; i++) {
+        used += sprintf(data + used, "<l%d>v</l%d>", i, i);
+    }
+    sprintf(data + used, "</c>");
+    if (parse(ctx, data, "all auto-deleted", count)) {
+        goto cleanup;
+    }
+    ret = 0;
+
+cleanup:
+    ly_ctx_destroy(ctx, NULL);
+    free(schema);
+    free(data);
+    return ret;
+}
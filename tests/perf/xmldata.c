@@ -0,0 +1,149 @@
+/**
+ * @file xmldata.c
+ * @brief performance test - parsing a large XML datastore dump directly and through the XML tree.
+ *
+ * Copyright (c) 2017 CESNET, z.s.p.o.
+ *
+ * This source code is licensed under BSD 3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/BSD-3-Clause
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+#include <libyang/libyang.h>
+
+static const char *schema =
+"module xml-perf {"
+"  namespace \"urn:libyang:performance:xml\";"
+"  prefix xp;"
+"  container interfaces {"
+"    list interface {"
+"      key name;"
+"      leaf name { type string; }"
+"      leaf description { type string; }"
+"      leaf enabled { type boolean; }"
+"      leaf mtu { type uint16; }"
+"      container statistics {"
+"        leaf in-octets { type uint64; }"
+"        leaf out-octets { type uint64; }"
+"        leaf in-errors { type uint32; }"
+"      }"
+"    }"
+"  }"
+"}";
+
+static double
+elapsed(struct timespec *start, struct timespec *end)
+{
+    return (end->tv_sec - start->tv_sec) + (end->tv_nsec - start->tv_nsec) / 1e9;
+}
+
+static long
+max_rss(void)
+{
+    struct rusage usage;
+
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+/* parse the data in a child process to get its own peak memory usage */
+static int
+run(struct ly_ctx *ctx, const char *xml, int dom)
+{
+    struct lyxml_elem *xmltree;
+    struct lyd_node *data = NULL;
+    struct timespec start, end;
+    long rss;
+    pid_t pid;
+    int status;
+
+    pid = fork();
+    if (pid == -1) {
+        return 1;
+    } else if (pid) {
+        waitpid(pid, &status, 0);
+        return !WIFEXITED(status) || WEXITSTATUS(status);
+    }
+
+    rss = max_rss();
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    if (dom) {
+        xmltree = lyxml_parse_mem(ctx, xml, LYXML_PARSE_MULTIROOT);
+        if (xmltree) {
+            data = lyd_parse_xml(ctx, &xmltree, LYD_OPT_CONFIG | LYD_OPT_STRICT);
+            lyxml_free_withsiblings(ctx, xmltree);
+        }
+    } else {
+        data = lyd_parse_mem(ctx, xml, LYD_XML, LYD_OPT_CONFIG | LYD_OPT_STRICT);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    if (!data) {
+        fprintf(stderr, "Failed to parse data.\n");
+        exit(1);
+    }
+
+    printf("%-10s: %8.3f s, peak memory %8ld kB\n", dom ? "XML tree" : "direct", elapsed(&start, &end),
+           max_rss() - rss);
+    lyd_free_withsiblings(data);
+    exit(0);
+}
+
+int
+main(int argc, char *argv[])
+{
+    int i, count = 100000, ret = 1;
+    size_t used = 0;
+    char *xml = NULL;
+    struct ly_ctx *ctx = NULL;
+
+    if (argc > 1) {
+        count = atoi(argv[1]);
+    }
+
+    ctx = ly_ctx_new(NULL);
+    if (!ctx) {
+        fprintf(stderr, "Failed to create context.\n");
+        return 1;
+    }
+    if (!lys_parse_mem(ctx, schema, LYS_IN_YANG)) {
+        fprintf(stderr, "Failed to load data model.\n");
+        goto cleanup;
+    }
+
+    xml = malloc(128 + count * 384);
+    if (!xml) {
+        goto cleanup;
+    }
+    used += sprintf(xml, "<interfaces xmlns=\"urn:libyang:performance:xml\">\n");
+    for (i = 0; i < count; i++) {
+        used += sprintf(xml + used, "  <interface>\n    <name>eth%d</name>\n    <description>interface number %d"
+                        "</description>\n    <enabled>%s</enabled>\n    <mtu>%d</mtu>\n    <statistics>\n"
+                        "      <in-octets>%d</in-octets>\n      <out-octets>%d</out-octets>\n"
+                        "      <in-errors>%d</in-errors>\n    </statistics>\n  </interface>\n",
+                        i, i, i % 2 ? "true" : "false", 1000 + i % 8000, i * 17, i * 13, i % 7);
+    }
+    sprintf(xml + used, "</interfaces>\n");
+
+    printf("entries   : %d (%.1f MB of XML)\n", count, used / 1048576.0);
+    fflush(stdout);
+    if (run(ctx, xml, 1) || run(ctx, xml, 0)) {
+        goto cleanup;
+    }
+    ret = 0;
+
+cleanup:
+    free(xml);
+    ly_ctx_destroy(ctx, NULL);
+
+    return ret;
+}
@@ -0,0 +1,108 @@
+/**
+ * @file xpath.c
+ * @brief performance test - evaluating XPath expressions with node-sets sorted in the document order.
+ *
+ * Copyright (c) 2017 CESNET, z.s.p.o.
+ *
+ * This source code is licensed under BSD 3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/BSD-3-Clause
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <libyang/libyang.h>
+
+static const char *schema =
+"module xpath-perf {"
+"  namespace \"urn:libyang:performance:xpath\";"
+"  prefix xp;"
+"  container top {"
+"    list item {"
+"      key name;"
+"      leaf name { type string; }"
+"      leaf value { type uint32; }"
+"      leaf port { type uint32; }"
+"    }"
+"  }"
+"}";
+
+static const char *exprs[] = {
+    "/xpath-perf:top//value",
+    "/xpath-perf:top/item//port",
+    "/xpath-perf:top//name | /xpath-perf:top//port",
+    "/xpath-perf:top//value/..",
+    "/xpath-perf:top/item[count(name | port[. mod 2 = 1]) = 2]",
+    NULL
+};
+
+static double
+elapsed(struct timespec *start, struct timespec *end)
+{
+    return (end->tv_sec - start->tv_sec) + (end->tv_nsec - start->tv_nsec) / 1e9;
+}
+
+int
+main(int argc, char *argv[])
+{
+    int i, count = 250000, ret = 1;
+    char value[16];
+    struct ly_ctx *ctx = NULL;
+    const struct lys_module *mod;
+    struct lyd_node *root = NULL, *item;
+    struct ly_set *set;
+    struct timespec start, end;
+
+    if (argc > 1) {
+        count = atoi(argv[1]);
+    }
+
+    ctx = ly_ctx_new(NULL);
+    if (!ctx) {
+        fprintf(stderr, "Failed to create context.\n");
+        goto cleanup;
+    }
+    mod = lys_parse_mem(ctx, schema, LYS_IN_YANG);
+    if (!mod) {
+        fprintf(stderr, "Failed to load data model.\n");
+        goto cleanup;
+    }
+
+    root = lyd_new(NULL, mod, "top");
+    for (i = 0; root && (i < count); i++) {
+        sprintf(value, "%d", i);
+        item = lyd_new(root, NULL, "item");
+        if (!item || !lyd_new_leaf(item, NULL, "name", value) || !lyd_new_leaf(item, NULL, "value", value)
+                || !lyd_new_leaf(item, NULL, "port", value)) {
+            break;
+        }
+    }
+    if (i < count) {
+        fprintf(stderr, "Failed to create data.\n");
+        goto cleanup;
+    }
+
+    printf("evaluating XPath expressions on %d list entries (%d nodes)\n", count, 1 + count * 4);
+    for (i = 0; exprs[i]; i++) {
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        set = lyd_find_xpath(root, exprs[i]);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        if (!set) {
+            fprintf(stderr, "Failed to evaluate \"%s\".\n", exprs[i]);
+            goto cleanup;
+        }
+        printf("%-56s: %8.3f s, %d nodes\n", exprs[i], elapsed(&start, &end), set->number);
+        ly_set_free(set);
+    }
+    ret = 0;
+
+cleanup:
+    lyd_free(root);
+    ly_ctx_destroy(ctx, NULL);
+    return ret;
+}
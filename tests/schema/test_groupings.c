@@ -0,0 +1,301 @@
+/**
+ * \file test_groupings.c
+ * \brief libyang tests - instantiating groupings with and without sharing the nested groupings
+ *
+ * Copyright (c) 2017 CESNET, z.s.p.o.
+ *
+ * This source code is licensed under BSD 3-Clause License (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://opensource.org/licenses/BSD-3-Clause
+ */
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <cmocka.h>
+
+#include "../../src/libyang.h"
+#include "../config.h"
+
+struct state {
+    struct ly_ctx *ctx;
+    struct ly_ctx *shared;
+    struct lyd_node *dt;
+    char *str1;
+    char *str2;
+};
+
+static const char *schema =
+"module a {"
+"  namespace \"urn:a\";"
+"  prefix a;"
+"  grouping counters {"
+"    leaf in { type uint32; }"
+"    leaf out { type uint32; default 0; }"
+"  }"
+"  grouping entry {"
+"    leaf name { type string; }"
+"    leaf addr { type string; }"
+"    container state { config false; uses counters; }"
+"  }"
+"  grouping item {"
+"    container items {"
+"      list item {"
+"        key name;"
+"        unique addr;"
+"        uses entry;"
+"        choice kind {"
+"          default plain;"
+"          case plain { uses counters; }"
+"          case ref { leaf target { type leafref { path \"../name\"; } } }"
+"        }"
+"      }"
+"    }"
+"  }"
+"  grouping top {"
+"    uses item;"
+"  }"
+"  container c {"
+"    uses top {"
+"      refine \"items/item/addr\" { mandatory true; }"
+"      augment \"items/item/state\" { leaf extra { type string; } }"
+"    }"
+"  }"
+"  container d { uses top; }"
+"}";
+
+static const char *data =
+"<c xmlns=\"urn:a\"><items>"
+  "<item><name>x</name><addr>1</addr></item>"
+  "<item><name>y</name><addr>2</addr><target>y</target></item>"
+"</items></c>"
+"<d xmlns=\"urn:a\"><items>"
+  "<item><name>z</name><in>5</in></item>"
+"</items></d>";
+
+static int
+setup_f(void **state)
+{
+    struct state *st;
+
+    (*state) = st = calloc(1, sizeof *st);
+    if (!st) {
+        fprintf(stderr, "Memory allocation error");
+        return -1;
+    }
+
+    st->ctx = ly_ctx_new(NULL);
+    st->shared = ly_ctx_new_opts(NULL, LY_CTX_SHARE_GROUPINGS);
+    if (!st->ctx || !st->shared) {
+        fprintf(stderr, "Failed to create context.\n");
+        return -1;
+    }
+
+    return 0;
+}
+
+static int
+teardown_f(void **state)
+{
+    struct state *st = (*state);
+
+    lyd_free_withsiblings(st->dt);
+    ly_ctx_destroy(st->ctx, NULL);
+    ly_ctx_destroy(st->shared, NULL);
+    free(st->str1);
+    free(st->str2);
+    free(st);
+    (*state) = NULL;
+
+    return 0;
+}
+
+static const struct lys_node *
+get_grouping(const struct lys_module *mod, const char *name)
+{
+    const struct lys_node *node;
+
+    LY_TREE_FOR(mod->data, node) {
+        if ((node->nodetype == LYS_GROUPING) && !strcmp(node->name, name)) {
+            return node;
+        }
+    }
+
+    return NULL;
+}
+
+static void
+test_instantiate(void **state)
+{
+    struct state *st = (*state);
+    const struct lys_module *mod, *mod_shared;
+    const struct lys_node *grp;
+
+    mod = lys_parse_mem(st->ctx, schema, LYS_IN_YANG);
+    assert_ptr_not_equal(mod, NULL);
+    mod_shared = lys_parse_mem(st->shared, schema, LYS_IN_YANG);
+    assert_ptr_not_equal(mod_shared, NULL);
+
+    /* the uses in groupings are not instantiated in the shared context */
+    grp = get_grouping(mod, "entry");
+    assert_ptr_not_equal(grp, NULL);
+    assert_string_equal(grp->child->prev->child->name, "counters");
+    assert_ptr_not_equal(grp->child->prev->child->child, NULL);
+    grp = get_grouping(mod_shared, "entry");
+    assert_ptr_not_equal(grp, NULL);
+    assert_string_equal(grp->child->prev->child->name, "counters");
+    assert_ptr_equal(grp->child->prev->child->child, NULL);
+    assert_true(grp->child->prev->child->flags & LYS_SHAREDGRP);
+
+    /* but the data tree is the same */
+    assert_int_equal(lys_print_mem(&st->str1, mod, LYS_OUT_TREE, NULL), 0);
+    assert_int_equal(lys_print_mem(&st->str2, mod_shared, LYS_OUT_TREE, NULL), 0);
+    assert_string_equal(st->str1, st->str2);
+    free(st->str1);
+    free(st->str2);
+    st->str1 = st->str2 = NULL;
+
+    assert_int_equal(lys_print_mem(&st->str1, mod, LYS_OUT_YANG, NULL), 0);
+    assert_int_equal(lys_print_mem(&st->str2, mod_shared, LYS_OUT_YANG, NULL), 0);
+    assert_string_equal(st->str1, st->str2);
+}
+
+static void
+test_data(void **state)
+{
+    struct state *st = (*state);
+    const char *dup;
+
+    assert_ptr_not_equal(lys_parse_mem(st->ctx, schema, LYS_IN_YANG), NULL);
+    assert_ptr_not_equal(lys_parse_mem(st->shared, schema, LYS_IN_YANG), NULL);
+
+    st->dt = lyd_parse_mem(st->ctx, data, LYD_XML, LYD_OPT_CONFIG);
+    assert_ptr_not_equal(st->dt, NULL);
+    assert_int_equal(lyd_print_mem(&st->str1, st->dt, LYD_XML, LYP_WITHSIBLINGS | LYP_WD_ALL), 0);
+    lyd_free_withsiblings(st->dt);
+
+    st->dt = lyd_parse_mem(st->shared, data, LYD_XML, LYD_OPT_CONFIG);
+    assert_ptr_not_equal(st->dt, NULL);
+    assert_int_equal(lyd_print_mem(&st->str2, st->dt, LYD_XML, LYP_WITHSIBLINGS | LYP_WD_ALL), 0);
+    lyd_free_withsiblings(st->dt);
+    st->dt = NULL;
+
+    assert_string_equal(st->str1, st->str2);
+    /* default of the default case from the shared grouping */
+    assert_ptr_not_equal(strstr(st->str2, "<out>0</out>"), NULL);
+
+    /* unique with the target from the shared grouping */
+    dup = "<d xmlns=\"urn:a\"><items>"
+            "<item><name>x</name><addr>1</addr></item>"
+            "<item><name>y</name><addr>1</addr></item>"
+          "</items></d>";
+    st->dt = lyd_parse_mem(st->shared, dup, LYD_XML, LYD_OPT_CONFIG);
+    assert_ptr_equal(st->dt, NULL);
+    assert_int_equal(ly_vecode, LYVE_NOUNIQ);
+
+    /* refine and augment through the shared grouping */
+    st->dt = lyd_parse_mem(st->shared, "<c xmlns=\"urn:a\"><items><item><name>x</name></item></items></c>",
+                           LYD_XML, LYD_OPT_CONFIG);
+    assert_ptr_equal(st->dt, NULL);
+    assert_int_equal(ly_vecode, LYVE_MISSELEM);
+    assert_ptr_not_equal(ly_ctx_get_node(st->shared, NULL, "/a:c/items/item/state/extra"), NULL);
+    assert_ptr_equal(ly_ctx_get_node(st->shared, NULL, "/a:d/items/item/state/extra"), NULL);
+}
+
+static void
+test_snapshot(void **state)
+{
+    struct state *st = (*state);
+    struct ly_ctx *snap;
+    char *snapshot;
+    size_t size;
+
+    assert_ptr_not_equal(lys_parse_mem(st->shared, schema, LYS_IN_YANG), NULL);
+    assert_int_equal(ly_ctx_print_snapshot_mem(st->shared, &snapshot, &size), 0);
+    snap = ly_ctx_new_snapshot_mem(NULL, snapshot, size, 0);
+    free(snapshot);
+    assert_ptr_not_equal(snap, NULL);
+
+    st->dt = lyd_parse_mem(snap, data, LYD_XML, LYD_OPT_CONFIG);
+    assert_ptr_not_equal(st->dt, NULL);
+    lyd_free_withsiblings(st->dt);
+    st->dt = NULL;
+
+    /* the groupings are still shared when instantiated in the restored context */
+    assert_ptr_not_equal(lys_parse_mem(snap, "module b { namespace urn:b; prefix b; import a { prefix a; }"
+                                             "  container e { uses a:top; } }", LYS_IN_YANG), NULL);
+    assert_ptr_not_equal(ly_ctx_get_node(snap, NULL, "/b:e/items/item/state/out"), NULL);
+    ly_ctx_destroy(snap, NULL);
+}
+
+static void
+test_postponed_errors(void **state)
+{
+    struct state *st = (*state);
+    const char *unique =
+"module u {"
+"  namespace urn:u;"
+"  prefix u;"
+"  grouping leaves { leaf k { type string; } leaf x { type string; } }"
+"  grouping g { list l { key k; unique missing; uses leaves; } }"
+"%s"
+"}";
+    const char *mandatory =
+"module m {"
+"  namespace urn:m;"
+"  prefix m;"
+"  grouping mand { leaf mand { type string; mandatory true; } }"
+"  grouping g { choice ch { default a; case a { uses mand; } case b { leaf b { type string; } } } }"
+"%s"
+"}";
+    const char *names =
+"module n {"
+"  namespace urn:n;"
+"  prefix n;"
+"  grouping x { leaf x { type string; } }"
+"  grouping g { leaf x { type string; } uses x; }"
+"%s"
+"}";
+    char buf[512];
+
+    /* errors in unused groupings are not detected until the grouping is instantiated */
+    sprintf(buf, unique, "");
+    assert_ptr_equal(lys_parse_mem(st->ctx, buf, LYS_IN_YANG), NULL);
+    assert_ptr_not_equal(lys_parse_mem(st->shared, buf, LYS_IN_YANG), NULL);
+    sprintf(buf, mandatory, "");
+    assert_ptr_equal(lys_parse_mem(st->ctx, buf, LYS_IN_YANG), NULL);
+    assert_ptr_not_equal(lys_parse_mem(st->shared, buf, LYS_IN_YANG), NULL);
+    sprintf(buf, names, "");
+    assert_ptr_equal(lys_parse_mem(st->ctx, buf, LYS_IN_YANG), NULL);
+    assert_ptr_not_equal(lys_parse_mem(st->shared, buf, LYS_IN_YANG), NULL);
+
+    /* but they are when it is */
+    ly_ctx_destroy(st->shared, NULL);
+    st->shared = ly_ctx_new_opts(NULL, LY_CTX_SHARE_GROUPINGS);
+    assert_ptr_not_equal(st->shared, NULL);
+
+    sprintf(buf, unique, "container c { uses g; }");
+    assert_ptr_equal(lys_parse_mem(st->shared, buf, LYS_IN_YANG), NULL);
+    sprintf(buf, mandatory, "container c { uses g; }");
+    assert_ptr_equal(lys_parse_mem(st->shared, buf, LYS_IN_YANG), NULL);
+    sprintf(buf, names, "container c { uses g; }");
+    assert_ptr_equal(lys_parse_mem(st->shared, buf, LYS_IN_YANG), NULL);
+}
+
+int
+main(void)
+{
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test_setup_teardown(test_instantiate, setup_f, teardown_f),
+        cmocka_unit_test_setup_teardown(test_data, setup_f, teardown_f),
+        cmocka_unit_test_setup_teardown(test_snapshot, setup_f, teardown_f),
+        cmocka_unit_test_setup_teardown(test_postponed_errors, setup_f, teardown_f),
+    };
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
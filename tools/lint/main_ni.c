@@ -34,7 +34,7 @@ help(int shortout)
     fprintf(stdout, "Usage:\n");
     fprintf(stdout, "    yanglint [options] [-f { yang | yin | tree }] <file>...\n");
     fprintf(stdout, "        Validates the YANG module in <file>, and all its dependencies.\n\n");
-    fprintf(stdout, "    yanglint [options] [-f { xml | json }] <schema>... <file>...\n");
+    fprintf(stdout, "    yanglint [options] [-f { xml | json | lyb }] <schema>... <file>...\n");
     fprintf(stdout, "        Validates the YANG modeled data in <file> according to the <schema>.\n\n");
     fprintf(stdout, "    yanglint\n");
     fprintf(stdout, "        Starts interactive mode with more features.\n\n");
@@ -59,7 +59,7 @@ help(int shortout)
         "  -f FORMAT, --format=FORMAT\n"
         "                        Convert to FORMAT. Supported formats: \n"
         "                        tree, yin, yang for schemas,\n"
-        "                        xml, json for data.\n\n"
+        "                        xml, json, lyb for data.\n\n"
         "  -i, --allimplemented  Make all the imported modules implemented.\n\n"
         "  -o OUTFILE, --output=OUTFILE\n"
         "                        Write the output to OUTFILE instead of stdout.\n\n"
@@ -241,6 +241,9 @@ main_ni(int argc, char* argv[])
             } else if (!strcasecmp(optarg, "json")) {
                 outformat_s = 0;
                 outformat_d = LYD_JSON;
+            } else if (!strcasecmp(optarg, "lyb")) {
+                outformat_s = 0;
+                outformat_d = LYD_LYB;
             } else {
                 fprintf(stderr, "yanglint error: unknown output format %s\n", optarg);
                 help(1);
@@ -473,6 +476,9 @@ main_ni(int argc, char* argv[])
             } else if (!strcmp(ptr, "json")) {
                 informat_s = 0;
                 informat_d = LYD_JSON;
+            } else if (!strcmp(ptr, "lyb")) {
+                informat_s = 0;
+                informat_d = LYD_LYB;
             } else {
                 fprintf(stderr, "yanglint error: input file in an unknown format \"%s\".\n", ptr);
                 goto cleanup;